@@ -1,5 +1,6 @@
 //!MAGPIE EFFECT
 //!VERSION 4
+//!CAPABILITY FP16
 
 #include "StubDefs.hlsli"
 //!PARAMETER
@@ -49,78 +50,82 @@ SamplerState sam;
 //!IN INPUT
 //!OUT OUTPUT
 
-// 预计算常量
-static const float3 lumWeights = float3(0.299f, 0.587f, 0.114f);
+// 预计算常量。颜色运算使用 MF 类型，支持 FP16 时为半精度；纹理坐标始终使用 float
+static const MF3 lumWeights = MF3(0.299, 0.587, 0.114);
 
 // 从4个核心参数智能推导其他参数
-float GetBParameter() {
-    return 0.25f + paramDetail * 0.25f;
+MF GetBParameter() {
+    return 0.25 + (MF)paramDetail * 0.25;
 }
 
-float GetCParameter() {
-    return 0.5f - paramDetail * 0.3f;
+MF GetCParameter() {
+    return 0.5 - (MF)paramDetail * 0.3;
 }
 
-float GetLowFreqBoost() {
-    return 0.9f + paramDetail * 0.2f;
+MF GetLowFreqBoost() {
+    return 0.9 + (MF)paramDetail * 0.2;
 }
 
-float GetMidFreqBoost() {
-    return 1.2f + paramSharpness * 0.6f;
+MF GetMidFreqBoost() {
+    return 1.2 + (MF)paramSharpness * 0.6;
 }
 
-float GetHighFreqBoost() {
-    return 2.0f + paramSharpness * 1.2f;
+MF GetHighFreqBoost() {
+    return 2.0 + (MF)paramSharpness * 1.2;
 }
 
-float GetEdgeThreshold() {
-    return 0.02f + paramAAStrength * 0.02f;
+MF GetEdgeThreshold() {
+    return 0.02 + (MF)paramAAStrength * 0.02;
 }
 
-float GetNoiseThreshold() {
-    return 0.01f + paramDenoise * 0.02f;
+MF GetNoiseThreshold() {
+    return 0.01 + (MF)paramDenoise * 0.02;
 }
 
-float GetSpatialNoiseReduction() {
-    return paramDenoise * 0.8f;
+MF GetSpatialNoiseReduction() {
+    return (MF)paramDenoise * 0.8;
+}
+
+MF3 SampleInput(float2 uv) {
+    return (MF3)INPUT.SampleLevel(sam, uv, 0).rgb;
 }
 
 // 高质量双线性插值 + 锐化模拟
-float3 HighQualityBilinear(float2 uv, float2 texelSize) {
+MF3 HighQualityBilinear(float2 uv, float2 texelSize) {
     float2 pixelPos = uv / texelSize;
     float2 pixelCenter = floor(pixelPos - 0.5f) + 0.5f;
     float2 subPixel = pixelPos - pixelCenter;
     
     // 双线性权重
-    float2 w = subPixel;
-    float2 w1 = 1.0f - w;
+    MF2 w = (MF2)subPixel;
+    MF2 w1 = 1.0 - w;
     
-    float4 weights = float4(w1.x * w1.y, w.x * w1.y, w1.x * w.y, w.x * w.y);
+    MF4 weights = MF4(w1.x * w1.y, w.x * w1.y, w1.x * w.y, w.x * w.y);
     
     float2 baseUV = pixelCenter * texelSize;
-    float3 samples[4] = {
-        INPUT.SampleLevel(sam, baseUV, 0).rgb,
-        INPUT.SampleLevel(sam, baseUV + float2(texelSize.x, 0), 0).rgb,
-        INPUT.SampleLevel(sam, baseUV + float2(0, texelSize.y), 0).rgb,
-        INPUT.SampleLevel(sam, baseUV + texelSize, 0).rgb
+    MF3 samples[4] = {
+        SampleInput(baseUV),
+        SampleInput(baseUV + float2(texelSize.x, 0)),
+        SampleInput(baseUV + float2(0, texelSize.y)),
+        SampleInput(baseUV + texelSize)
     };
     
-    float3 bilinearResult = 0;
+    MF3 bilinearResult = 0;
     [unroll]
     for (int i = 0; i < 4; i++) {
         bilinearResult += samples[i] * weights[i];
     }
     
     // 锐化模拟补偿
-    float3 laplacian = 4.0f * bilinearResult - 
-                      (samples[0] + samples[1] + samples[2] + samples[3]) * 0.25f;
-    return bilinearResult + laplacian * (paramSharpness * 0.1f);
+    MF3 laplacian = 4.0 * bilinearResult - 
+                   (samples[0] + samples[1] + samples[2] + samples[3]) * 0.25;
+    return bilinearResult + laplacian * ((MF)paramSharpness * 0.1);
 }
 
 // 3x3邻域采样结构
 struct Neighborhood3x3 {
-    float3 samples[9];
-    float luminances[9];
+    MF3 samples[9];
+    MF luminances[9];
     float2 texelSize;
     float2 centerUV;
 };
@@ -139,7 +144,7 @@ Neighborhood3x3 Get3x3Neighborhood(float2 uv, float2 texelSize) {
     
     [unroll]
     for (int i = 0; i < 9; i++) {
-        n.samples[i] = INPUT.SampleLevel(sam, uv + offsets[i] * texelSize, 0).rgb;
+        n.samples[i] = SampleInput(uv + offsets[i] * texelSize);
         n.luminances[i] = dot(n.samples[i], lumWeights);
     }
     
@@ -147,36 +152,35 @@ Neighborhood3x3 Get3x3Neighborhood(float2 uv, float2 texelSize) {
 }
 
 // 共享采样计算梯度
-float2 CalculateGradientFromNeighborhood(const Neighborhood3x3 n) {
+MF2 CalculateGradientFromNeighborhood(const Neighborhood3x3 n) {
     // Sobel X
-    float gradX = (-n.luminances[0] - 2.0f * n.luminances[3] - n.luminances[6] + 
-                   n.luminances[2] + 2.0f * n.luminances[5] + n.luminances[8]);
+    MF gradX = (-n.luminances[0] - 2.0 * n.luminances[3] - n.luminances[6] + 
+                n.luminances[2] + 2.0 * n.luminances[5] + n.luminances[8]);
     
     // Sobel Y  
-    float gradY = (-n.luminances[0] - 2.0f * n.luminances[1] - n.luminances[2] + 
-                   n.luminances[6] + 2.0f * n.luminances[7] + n.luminances[8]);
+    MF gradY = (-n.luminances[0] - 2.0 * n.luminances[1] - n.luminances[2] + 
+                n.luminances[6] + 2.0 * n.luminances[7] + n.luminances[8]);
     
-    float2 gradient = float2(gradX, gradY);
-    float gradLength = length(gradient);
+    MF2 gradient = MF2(gradX, gradY);
     
     // 简化的振铃保护（clamp代替条件分支）
-    return clamp(gradient, -0.15f, 0.15f);
+    return clamp(gradient, -0.15, 0.15);
 }
 
 // 共享采样计算拉普拉斯
-float3 CalculateLaplacianFromNeighborhood(const Neighborhood3x3 n) {
-    return 4.0f * n.samples[4] - (n.samples[1] + n.samples[3] + n.samples[5] + n.samples[7]);
+MF3 CalculateLaplacianFromNeighborhood(const Neighborhood3x3 n) {
+    return 4.0 * n.samples[4] - (n.samples[1] + n.samples[3] + n.samples[5] + n.samples[7]);
 }
 
 // 共享采样计算高斯模糊
-float3 CalculateGaussianFromNeighborhood(const Neighborhood3x3 n) {
-    static const float weights[9] = {
-        1.0f/16.0f, 2.0f/16.0f, 1.0f/16.0f,
-        2.0f/16.0f, 4.0f/16.0f, 2.0f/16.0f,
-        1.0f/16.0f, 2.0f/16.0f, 1.0f/16.0f
+MF3 CalculateGaussianFromNeighborhood(const Neighborhood3x3 n) {
+    static const MF weights[9] = {
+        1.0/16.0, 2.0/16.0, 1.0/16.0,
+        2.0/16.0, 4.0/16.0, 2.0/16.0,
+        1.0/16.0, 2.0/16.0, 1.0/16.0
     };
     
-    float3 result = 0;
+    MF3 result = 0;
     [unroll]
     for (int i = 0; i < 9; i++) {
         result += n.samples[i] * weights[i];
@@ -185,13 +189,13 @@ float3 CalculateGaussianFromNeighborhood(const Neighborhood3x3 n) {
 }
 
 // 共享采样双边滤波
-float3 CalculateBilateralFromNeighborhood(const Neighborhood3x3 n) {
-    float centerLum = n.luminances[4];
-    float noiseThreshold = GetNoiseThreshold();
-    float sigmaColor = noiseThreshold * noiseThreshold * 2.0f;
+MF3 CalculateBilateralFromNeighborhood(const Neighborhood3x3 n) {
+    MF centerLum = n.luminances[4];
+    MF noiseThreshold = GetNoiseThreshold();
+    MF sigmaColor = noiseThreshold * noiseThreshold * 2.0;
     
-    float3 filtered = n.samples[4];
-    float totalWeight = 1.0f;
+    MF3 filtered = n.samples[4];
+    MF totalWeight = 1.0;
     
     // 只采样4个方向的对称点
     int indices[4] = {1, 3, 5, 7}; // 上下左右
@@ -199,11 +203,11 @@ float3 CalculateBilateralFromNeighborhood(const Neighborhood3x3 n) {
     [unroll]
     for (int i = 0; i < 4; i++) {
         int idx = indices[i];
-        float colorDiff = abs(n.luminances[idx] - centerLum);
-        float colorWeight = exp(-colorDiff * colorDiff / sigmaColor);
+        MF colorDiff = abs(n.luminances[idx] - centerLum);
+        MF colorWeight = exp(-colorDiff * colorDiff / sigmaColor);
         
-        float spatialWeight = 0.2f;
-        float weight = spatialWeight * colorWeight;
+        MF spatialWeight = 0.2;
+        MF weight = spatialWeight * colorWeight;
         
         filtered += n.samples[idx] * weight;
         totalWeight += weight;
@@ -213,20 +217,20 @@ float3 CalculateBilateralFromNeighborhood(const Neighborhood3x3 n) {
 }
 
 // 噪声检测（基于邻域方差）
-float DetectNoiseFromNeighborhood(const Neighborhood3x3 n) {
-    float3 center = n.samples[4];
-    float3 gaussian = CalculateGaussianFromNeighborhood(n);
+MF DetectNoiseFromNeighborhood(const Neighborhood3x3 n) {
+    MF3 center = n.samples[4];
+    MF3 gaussian = CalculateGaussianFromNeighborhood(n);
     
-    float3 noise = abs(center - gaussian);
-    float noiseEnergy = length(noise);
+    MF3 noise = abs(center - gaussian);
+    MF noiseEnergy = length(noise);
     
-    float2 gradient = CalculateGradientFromNeighborhood(n);
-    float gradMagnitude = length(gradient);
-    float edgeMask = saturate(gradMagnitude * 2.0f);
+    MF2 gradient = CalculateGradientFromNeighborhood(n);
+    MF gradMagnitude = length(gradient);
+    MF edgeMask = saturate(gradMagnitude * 2.0);
     
-    float adjustedNoise = noiseEnergy * (1.0f - edgeMask * 0.2f);
+    MF adjustedNoise = noiseEnergy * (1.0 - edgeMask * 0.2);
     
-    return saturate(adjustedNoise - GetNoiseThreshold()) / (1.0f - GetNoiseThreshold());
+    return saturate(adjustedNoise - GetNoiseThreshold()) / (1.0 - GetNoiseThreshold());
 }
 
 // 主像素着色器：优化版本
@@ -237,54 +241,54 @@ float4 Pass1(float2 pos) {
     Neighborhood3x3 neighborhood = Get3x3Neighborhood(pos, inputPt);
     
     // 高质量插值
-    float3 baseColor = HighQualityBilinear(pos, inputPt);
+    MF3 baseColor = HighQualityBilinear(pos, inputPt);
     
     // 从共享采样计算所有需要的值
-    float2 gradient = CalculateGradientFromNeighborhood(neighborhood);
-    float gradMagnitude = length(gradient);
-    float2 edgeDirection = normalize(gradient);
-    if (gradMagnitude < 0.001f) edgeDirection = float2(1, 0);
+    MF2 gradient = CalculateGradientFromNeighborhood(neighborhood);
+    MF gradMagnitude = length(gradient);
+    float2 edgeDirection = normalize((float2)gradient);
+    if (gradMagnitude < 0.001) edgeDirection = float2(1, 0);
     
-    float3 laplacian = CalculateLaplacianFromNeighborhood(neighborhood);
-    float3 gaussian = CalculateGaussianFromNeighborhood(neighborhood);
+    MF3 laplacian = CalculateLaplacianFromNeighborhood(neighborhood);
+    MF3 gaussian = CalculateGaussianFromNeighborhood(neighborhood);
     
     // 频率分离
-    float3 lowFreq = gaussian;
-    float3 midFreq = baseColor - lowFreq;
-    float3 highFreq = laplacian;
+    MF3 lowFreq = gaussian;
+    MF3 midFreq = baseColor - lowFreq;
+    MF3 highFreq = laplacian;
     
     // 频率增强
-    float3 enhanced = lowFreq * GetLowFreqBoost() + 
-                     midFreq * GetMidFreqBoost() + 
-                     highFreq * GetHighFreqBoost() * 0.3f; // 拉普拉斯已包含高频信息
+    MF3 enhanced = lowFreq * GetLowFreqBoost() + 
+                  midFreq * GetMidFreqBoost() + 
+                  highFreq * GetHighFreqBoost() * 0.3; // 拉普拉斯已包含高频信息
     
     // 自适应去噪
-    float noiseLevel = DetectNoiseFromNeighborhood(neighborhood);
-    float3 denoised = enhanced;
-    if (noiseLevel > 0.05f) {
-        float3 bilateral = CalculateBilateralFromNeighborhood(neighborhood);
-        float reductionStrength = GetSpatialNoiseReduction() * noiseLevel;
+    MF noiseLevel = DetectNoiseFromNeighborhood(neighborhood);
+    MF3 denoised = enhanced;
+    if (noiseLevel > 0.05) {
+        MF3 bilateral = CalculateBilateralFromNeighborhood(neighborhood);
+        MF reductionStrength = GetSpatialNoiseReduction() * noiseLevel;
         denoised = lerp(enhanced, bilateral, reductionStrength);
     } else {
         denoised = enhanced;
     }
     
     // 抗锯齿（简化版本，基于梯度方向）
-    float3 aaResult = denoised;
+    MF3 aaResult = denoised;
     if (gradMagnitude > GetEdgeThreshold()) {
-        float3 edgeSamples[4] = {
-            INPUT.SampleLevel(sam, pos + edgeDirection * inputPt * 0.5f, 0).rgb,
-            INPUT.SampleLevel(sam, pos - edgeDirection * inputPt * 0.5f, 0).rgb,
-            INPUT.SampleLevel(sam, pos + float2(-edgeDirection.y, edgeDirection.x) * inputPt * 0.5f, 0).rgb,
-            INPUT.SampleLevel(sam, pos + float2(edgeDirection.y, -edgeDirection.x) * inputPt * 0.5f, 0).rgb
+        MF3 edgeSamples[4] = {
+            SampleInput(pos + edgeDirection * inputPt * 0.5f),
+            SampleInput(pos - edgeDirection * inputPt * 0.5f),
+            SampleInput(pos + float2(-edgeDirection.y, edgeDirection.x) * inputPt * 0.5f),
+            SampleInput(pos + float2(edgeDirection.y, -edgeDirection.x) * inputPt * 0.5f)
         };
         
-        float3 aaAvg = (edgeSamples[0] + edgeSamples[1] + edgeSamples[2] + edgeSamples[3]) * 0.25f;
-        aaResult = lerp(denoised, aaAvg, paramAAStrength * 0.6f);
+        MF3 aaAvg = (edgeSamples[0] + edgeSamples[1] + edgeSamples[2] + edgeSamples[3]) * 0.25;
+        aaResult = lerp(denoised, aaAvg, (MF)paramAAStrength * 0.6);
     }
     
     // 自适应锐化
-    float3 sharpened = aaResult + laplacian * paramSharpness * 0.15f;
+    MF3 sharpened = aaResult + laplacian * (MF)paramSharpness * 0.15;
     
     // 最终输出
     return float4(saturate(sharpened), 1.0);
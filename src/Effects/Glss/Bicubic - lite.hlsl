@@ -1,5 +1,6 @@
 //!MAGPIE EFFECT
 //!VERSION 4
+//!CAPABILITY FP16
 
 #include "StubDefs.hlsli"
 //!PARAMETER
@@ -49,8 +50,8 @@ SamplerState sam;
 //!IN INPUT
 //!OUT OUTPUT
 
-// 预计算常量
-static const float3 lumWeights = float3(0.299f, 0.587f, 0.114f);
+// 预计算常量。颜色运算使用 MF 类型，支持 FP16 时为半精度；纹理坐标始终使用 float
+static const MF3 lumWeights = MF3(0.299, 0.587, 0.114);
 
 // 从4个核心参数智能推导其他参数
 float GetBParameter() {
@@ -61,28 +62,28 @@ float GetCParameter() {
     return 0.5f - paramDetail * 0.3f;
 }
 
-float GetLowFreqBoost() {
-    return 0.9f + paramDetail * 0.2f;
+MF GetLowFreqBoost() {
+    return 0.9 + (MF)paramDetail * 0.2;
 }
 
-float GetMidFreqBoost() {
-    return 1.2f + paramSharpness * 0.6f;
+MF GetMidFreqBoost() {
+    return 1.2 + (MF)paramSharpness * 0.6;
 }
 
-float GetHighFreqBoost() {
-    return 2.0f + paramSharpness * 1.2f;
+MF GetHighFreqBoost() {
+    return 2.0 + (MF)paramSharpness * 1.2;
 }
 
-float GetEdgeThreshold() {
-    return 0.02f + paramAAStrength * 0.02f;
+MF GetEdgeThreshold() {
+    return 0.02 + (MF)paramAAStrength * 0.02;
 }
 
-float GetNoiseThreshold() {
-    return 0.01f + paramDenoise * 0.02f;
+MF GetNoiseThreshold() {
+    return 0.01 + (MF)paramDenoise * 0.02;
 }
 
-float GetSpatialNoiseReduction() {
-    return paramDenoise * 0.8f;
+MF GetSpatialNoiseReduction() {
+    return (MF)paramDenoise * 0.8;
 }
 
 // 简化的Bicubic Weight Function
@@ -111,6 +112,10 @@ float4 weight4(float x) {
     );
 }
 
+MF3 SampleInput(float2 uv) {
+    return (MF3)INPUT.SampleLevel(sam, uv, 0).rgb;
+}
+
 // 简化的3x3高斯核
 static const float2 g_simpleGaussianOffsets[9] = {
     float2(-1, -1), float2(0, -1), float2(1, -1),
@@ -118,20 +123,20 @@ static const float2 g_simpleGaussianOffsets[9] = {
     float2(-1, 1), float2(0, 1), float2(1, 1)
 };
 
-static const float g_simpleGaussianWeights[9] = {
-    1.0f/16.0f, 2.0f/16.0f, 1.0f/16.0f,
-    2.0f/16.0f, 4.0f/16.0f, 2.0f/16.0f,
-    1.0f/16.0f, 2.0f/16.0f, 1.0f/16.0f
+static const MF g_simpleGaussianWeights[9] = {
+    1.0/16.0, 2.0/16.0, 1.0/16.0,
+    2.0/16.0, 4.0/16.0, 2.0/16.0,
+    1.0/16.0, 2.0/16.0, 1.0/16.0
 };
 
 // 简化的高斯模糊 - 3x3核
-float3 SimpleGaussianBlur(float2 uv, float2 texelSize, float scale = 1.0f) {
-    float3 result = 0;
+MF3 SimpleGaussianBlur(float2 uv, float2 texelSize, float scale = 1.0f) {
+    MF3 result = 0;
     float2 scaledOffset = texelSize * scale;
     
     [unroll]
     for (int i = 0; i < 9; i++) {
-        float3 sample = INPUT.SampleLevel(sam, uv + g_simpleGaussianOffsets[i] * scaledOffset, 0).rgb;
+        MF3 sample = SampleInput(uv + g_simpleGaussianOffsets[i] * scaledOffset);
         result += sample * g_simpleGaussianWeights[i];
     }
     
@@ -139,57 +144,49 @@ float3 SimpleGaussianBlur(float2 uv, float2 texelSize, float scale = 1.0f) {
 }
 
 // 简化的拉普拉斯滤波 - 3x3
-float3 SimpleLaplacianFilter(float2 uv, float2 texelSize) {
-    float3 center = INPUT.SampleLevel(sam, uv, 0).rgb;
-    float3 up = INPUT.SampleLevel(sam, uv + float2(0, -texelSize.y), 0).rgb;
-    float3 down = INPUT.SampleLevel(sam, uv + float2(0, texelSize.y), 0).rgb;
-    float3 left = INPUT.SampleLevel(sam, uv + float2(-texelSize.x, 0), 0).rgb;
-    float3 right = INPUT.SampleLevel(sam, uv + float2(texelSize.x, 0), 0).rgb;
+MF3 SimpleLaplacianFilter(float2 uv, float2 texelSize) {
+    MF3 center = SampleInput(uv);
+    MF3 up = SampleInput(uv + float2(0, -texelSize.y));
+    MF3 down = SampleInput(uv + float2(0, texelSize.y));
+    MF3 left = SampleInput(uv + float2(-texelSize.x, 0));
+    MF3 right = SampleInput(uv + float2(texelSize.x, 0));
     
-    return 4.0f * center - (up + down + left + right);
+    return 4.0 * center - (up + down + left + right);
 }
 
 // 简化的梯度计算 - 3x3 Sobel
-float2 CalculateSimpleGradient(float2 uv, float2 texelSize) {
-    float3 tl = INPUT.SampleLevel(sam, uv + float2(-texelSize.x, -texelSize.y), 0).rgb;
-    float3 tm = INPUT.SampleLevel(sam, uv + float2(0, -texelSize.y), 0).rgb;
-    float3 tr = INPUT.SampleLevel(sam, uv + float2(texelSize.x, -texelSize.y), 0).rgb;
-    float3 ml = INPUT.SampleLevel(sam, uv + float2(-texelSize.x, 0), 0).rgb;
-    float3 mr = INPUT.SampleLevel(sam, uv + float2(texelSize.x, 0), 0).rgb;
-    float3 bl = INPUT.SampleLevel(sam, uv + float2(-texelSize.x, texelSize.y), 0).rgb;
-    float3 bm = INPUT.SampleLevel(sam, uv + float2(0, texelSize.y), 0).rgb;
-    float3 br = INPUT.SampleLevel(sam, uv + float2(texelSize.x, texelSize.y), 0).rgb;
-    
-    float tl_lum = dot(tl, lumWeights);
-    float tm_lum = dot(tm, lumWeights);
-    float tr_lum = dot(tr, lumWeights);
-    float ml_lum = dot(ml, lumWeights);
-    float mr_lum = dot(mr, lumWeights);
-    float bl_lum = dot(bl, lumWeights);
-    float bm_lum = dot(bm, lumWeights);
-    float br_lum = dot(br, lumWeights);
+MF2 CalculateSimpleGradient(float2 uv, float2 texelSize) {
+    MF tl_lum = dot(SampleInput(uv + float2(-texelSize.x, -texelSize.y)), lumWeights);
+    MF tm_lum = dot(SampleInput(uv + float2(0, -texelSize.y)), lumWeights);
+    MF tr_lum = dot(SampleInput(uv + float2(texelSize.x, -texelSize.y)), lumWeights);
+    MF ml_lum = dot(SampleInput(uv + float2(-texelSize.x, 0)), lumWeights);
+    MF mr_lum = dot(SampleInput(uv + float2(texelSize.x, 0)), lumWeights);
+    MF bl_lum = dot(SampleInput(uv + float2(-texelSize.x, texelSize.y)), lumWeights);
+    MF bm_lum = dot(SampleInput(uv + float2(0, texelSize.y)), lumWeights);
+    MF br_lum = dot(SampleInput(uv + float2(texelSize.x, texelSize.y)), lumWeights);
     
-    float gradX = (-tl_lum - 2.0f * ml_lum - bl_lum + tr_lum + 2.0f * mr_lum + br_lum);
-    float gradY = (-tl_lum - 2.0f * tm_lum - tr_lum + bl_lum + 2.0f * bm_lum + br_lum);
+    MF gradX = (-tl_lum - 2.0 * ml_lum - bl_lum + tr_lum + 2.0 * mr_lum + br_lum);
+    MF gradY = (-tl_lum - 2.0 * tm_lum - tr_lum + bl_lum + 2.0 * bm_lum + br_lum);
     
-    float2 gradient = float2(gradX, gradY);
-    float gradLength = length(gradient);
+    MF2 gradient = MF2(gradX, gradY);
+    MF gradLength = length(gradient);
     
     // 振铃保护
-    if (gradLength > 0.15f) {
-        gradient = normalize(gradient) * min(gradLength, 0.15f);
+    if (gradLength > 0.15) {
+        gradient = normalize(gradient) * min(gradLength, 0.15);
     }
     
     return gradient;
 }
 
 // 简化的双边滤波器 - 3x3核
-float3 SimpleBilateralFilter(float2 uv, float2 texelSize) {
-    float3 center = INPUT.SampleLevel(sam, uv, 0).rgb;
-    float centerLum = dot(center, lumWeights);
+MF3 SimpleBilateralFilter(float2 uv, float2 texelSize) {
+    MF3 center = SampleInput(uv);
+    MF centerLum = dot(center, lumWeights);
     
-    float3 filtered = center;
-    float totalWeight = 1.0f;
+    MF3 filtered = center;
+    MF totalWeight = 1.0;
+    const MF noiseThreshold = GetNoiseThreshold();
     
     // 4个方向的邻近采样
     float2 offsets[4] = {float2(1, 0), float2(0, 1), float2(1, 1), float2(-1, 1)};
@@ -197,24 +194,24 @@ float3 SimpleBilateralFilter(float2 uv, float2 texelSize) {
     [unroll]
     for (int i = 0; i < 4; i++) {
         float2 offset = offsets[i] * texelSize;
-        float3 sample = INPUT.SampleLevel(sam, uv + offset, 0).rgb;
-        float sampleLum = dot(sample, lumWeights);
+        MF3 sample = SampleInput(uv + offset);
+        MF sampleLum = dot(sample, lumWeights);
         
-        float colorDiff = abs(sampleLum - centerLum);
-        float colorWeight = exp(-colorDiff * colorDiff / (2.0f * GetNoiseThreshold() * GetNoiseThreshold()));
+        MF colorDiff = abs(sampleLum - centerLum);
+        MF colorWeight = exp(-colorDiff * colorDiff / (2.0 * noiseThreshold * noiseThreshold));
         
-        float weight = 0.2f * colorWeight;
+        MF weight = 0.2 * colorWeight;
         filtered += sample * weight;
         totalWeight += weight;
         
         // 对称采样
-        float3 sample2 = INPUT.SampleLevel(sam, uv - offset, 0).rgb;
-        float sample2Lum = dot(sample2, lumWeights);
+        MF3 sample2 = SampleInput(uv - offset);
+        MF sample2Lum = dot(sample2, lumWeights);
         
-        float colorDiff2 = abs(sample2Lum - centerLum);
-        float colorWeight2 = exp(-colorDiff2 * colorDiff2 / (2.0f * GetNoiseThreshold() * GetNoiseThreshold()));
+        MF colorDiff2 = abs(sample2Lum - centerLum);
+        MF colorWeight2 = exp(-colorDiff2 * colorDiff2 / (2.0 * noiseThreshold * noiseThreshold));
         
-        float weight2 = 0.2f * colorWeight2;
+        MF weight2 = 0.2 * colorWeight2;
         filtered += sample2 * weight2;
         totalWeight += weight2;
     }
@@ -223,29 +220,29 @@ float3 SimpleBilateralFilter(float2 uv, float2 texelSize) {
 }
 
 // 简化的噪声检测
-float DetectNoise(float2 uv, float2 texelSize) {
-    float3 center = INPUT.SampleLevel(sam, uv, 0).rgb;
-    float3 blurred = SimpleGaussianBlur(uv, texelSize, 1.0f);
+MF DetectNoise(float2 uv, float2 texelSize) {
+    MF3 center = SampleInput(uv);
+    MF3 blurred = SimpleGaussianBlur(uv, texelSize, 1.0f);
     
-    float3 noise = abs(center - blurred);
-    float noiseEnergy = length(noise);
+    MF3 noise = abs(center - blurred);
+    MF noiseEnergy = length(noise);
     
-    float2 gradient = CalculateSimpleGradient(uv, texelSize);
-    float gradMagnitude = length(gradient);
-    float edgeMask = saturate(gradMagnitude * 2.0f);
+    MF2 gradient = CalculateSimpleGradient(uv, texelSize);
+    MF gradMagnitude = length(gradient);
+    MF edgeMask = saturate(gradMagnitude * 2.0);
     
-    float adjustedNoise = noiseEnergy * (1.0f - edgeMask * 0.2f);
+    MF adjustedNoise = noiseEnergy * (1.0 - edgeMask * 0.2);
     
-    return saturate(adjustedNoise - GetNoiseThreshold()) / (1.0f - GetNoiseThreshold());
+    return saturate(adjustedNoise - GetNoiseThreshold()) / (1.0 - GetNoiseThreshold());
 }
 
 // 简化的自适应去噪
-float3 SimpleAdaptiveDenoise(float2 uv, float2 texelSize, float3 color) {
-    float noiseLevel = DetectNoise(uv, texelSize);
+MF3 SimpleAdaptiveDenoise(float2 uv, float2 texelSize, MF3 color) {
+    MF noiseLevel = DetectNoise(uv, texelSize);
     
-    if (noiseLevel > 0.05f) {
-        float3 denoised = SimpleBilateralFilter(uv, texelSize);
-        float reductionStrength = GetSpatialNoiseReduction() * noiseLevel;
+    if (noiseLevel > 0.05) {
+        MF3 denoised = SimpleBilateralFilter(uv, texelSize);
+        MF reductionStrength = GetSpatialNoiseReduction() * noiseLevel;
         return lerp(color, denoised, reductionStrength);
     }
     
@@ -253,8 +250,8 @@ float3 SimpleAdaptiveDenoise(float2 uv, float2 texelSize, float3 color) {
 }
 
 // 简化的抗锯齿 - 4方向采样
-float3 SimpleAA(float2 uv, float2 texelSize, float2 edgeDir) {
-    float3 center = INPUT.SampleLevel(sam, uv, 0).rgb;
+MF3 SimpleAA(float2 uv, float2 texelSize, float2 edgeDir) {
+    MF3 center = SampleInput(uv);
     
     // 4方向采样
     float2 directions[4] = {
@@ -264,26 +261,26 @@ float3 SimpleAA(float2 uv, float2 texelSize, float2 edgeDir) {
         float2(edgeDir.y, -edgeDir.x)
     };
     
-    float3 samples[4];
+    MF3 samples[4];
     [unroll]
     for (int i = 0; i < 4; i++) {
-        samples[i] = INPUT.SampleLevel(sam, uv + directions[i] * texelSize * 0.5f, 0).rgb;
+        samples[i] = SampleInput(uv + directions[i] * texelSize * 0.5f);
     }
     
-    float3 aaResult = (samples[0] + samples[1] + samples[2] + samples[3]) * 0.25f;
+    MF3 aaResult = (samples[0] + samples[1] + samples[2] + samples[3]) * 0.25;
     
-    return lerp(center, aaResult, paramAAStrength * 0.6f);
+    return lerp(center, aaResult, (MF)paramAAStrength * 0.6);
 }
 
 // 简化的自适应锐化
-float3 SimpleAdaptiveSharpen(float2 uv, float2 texelSize, float3 baseColor) {
-    float3 laplacian = SimpleLaplacianFilter(uv, texelSize);
-    float3 sharpened = baseColor + laplacian * paramSharpness * 0.3f;
+MF3 SimpleAdaptiveSharpen(float2 uv, float2 texelSize, MF3 baseColor) {
+    MF3 laplacian = SimpleLaplacianFilter(uv, texelSize);
+    MF3 sharpened = baseColor + laplacian * (MF)paramSharpness * 0.3;
     
     // 振铃控制
-    float3 diff = sharpened - baseColor;
-    float maxSharpen = 0.1f;
-    float3 clampedDiff = clamp(diff, -maxSharpen, maxSharpen);
+    MF3 diff = sharpened - baseColor;
+    MF maxSharpen = 0.1;
+    MF3 clampedDiff = clamp(diff, -maxSharpen, maxSharpen);
     
     return clamp(clampedDiff + baseColor, 0, 1);
 }
@@ -301,58 +298,58 @@ float4 Pass1(float2 pos) {
     float4 rowWeights = weight4(1.0f - subPixel.x);
     float4 colWeights = weight4(1.0f - subPixel.y);
 
-    rowWeights /= dot(rowWeights, 1.0f);
-    colWeights /= dot(colWeights, 1.0f);
+    const MF4 normRowWeights = MF4(rowWeights / dot(rowWeights, 1.0f));
+    const MF4 normColWeights = MF4(colWeights / dot(colWeights, 1.0f));
 
     float2 baseUV = pixelCenter * inputPt;
-    float3 samples[4][4];
+    MF3 samples[4][4];
     [unroll]
     for (int j = 0; j < 4; j++) {
         [unroll]
         for (int i = 0; i < 4; i++) {
             float2 offset = float2((i - 1) * inputPt.x, (j - 1) * inputPt.y);
-            samples[j][i] = INPUT.SampleLevel(sam, baseUV + offset, 0).rgb;
+            samples[j][i] = SampleInput(baseUV + offset);
         }
     }
 
-    float3 bicubicResult = 0;
+    MF3 bicubicResult = 0;
     [unroll]
     for (int j = 0; j < 4; j++) {
-        float3 rowResult = 0;
+        MF3 rowResult = 0;
         [unroll]
         for (int i = 0; i < 4; i++) {
-            rowResult += samples[j][i] * rowWeights[i];
+            rowResult += samples[j][i] * normRowWeights[i];
         }
-        bicubicResult += rowResult * colWeights[j];
+        bicubicResult += rowResult * normColWeights[j];
     }
 
     // 简化的梯度计算
-    float2 simpleGradient = CalculateSimpleGradient(pos, inputPt);
-    float gradientMagnitude = length(simpleGradient);
-    float2 edgeDirection = normalize(simpleGradient);
-    if (gradientMagnitude < 0.001f) edgeDirection = float2(1, 0);
+    MF2 simpleGradient = CalculateSimpleGradient(pos, inputPt);
+    MF gradientMagnitude = length(simpleGradient);
+    float2 edgeDirection = normalize((float2)simpleGradient);
+    if (gradientMagnitude < 0.001) edgeDirection = float2(1, 0);
     
     // 简化的频率增强
-    float3 lowFreq = SimpleGaussianBlur(pos, inputPt, 1.5f);
-    float3 midFreq = SimpleGaussianBlur(pos, inputPt, 0.8f) - lowFreq;
-    float3 highFreq = bicubicResult - SimpleGaussianBlur(pos, inputPt, 0.5f);
+    MF3 lowFreq = SimpleGaussianBlur(pos, inputPt, 1.5f);
+    MF3 midFreq = SimpleGaussianBlur(pos, inputPt, 0.8f) - lowFreq;
+    MF3 highFreq = bicubicResult - SimpleGaussianBlur(pos, inputPt, 0.5f);
     
-    float3 enhanced = lowFreq * GetLowFreqBoost() * 0.9f + 
-                     midFreq * GetMidFreqBoost() * 1.0f + 
-                     highFreq * GetHighFreqBoost() * 1.2f;
+    MF3 enhanced = lowFreq * GetLowFreqBoost() * 0.9 + 
+                  midFreq * GetMidFreqBoost() * 1.0 + 
+                  highFreq * GetHighFreqBoost() * 1.2;
     
     // 简化的自适应去噪
-    float3 denoised = SimpleAdaptiveDenoise(pos, inputPt, enhanced);
+    MF3 denoised = SimpleAdaptiveDenoise(pos, inputPt, enhanced);
 
     // 简化的抗锯齿
-    float3 aaResult = SimpleAA(pos, inputPt, edgeDirection);
-    float3 antiAliased = lerp(denoised, aaResult, saturate(gradientMagnitude * 3.0f) * paramAAStrength);
+    MF3 aaResult = SimpleAA(pos, inputPt, edgeDirection);
+    MF3 antiAliased = lerp(denoised, aaResult, saturate(gradientMagnitude * 3.0) * (MF)paramAAStrength);
 
     // 简化的自适应锐化
-    float3 sharpened = SimpleAdaptiveSharpen(pos, inputPt, antiAliased);
+    MF3 sharpened = SimpleAdaptiveSharpen(pos, inputPt, antiAliased);
     
     // 最终输出
-    float3 finalColor = sharpened;
+    MF3 finalColor = sharpened;
     
     return float4(saturate(finalColor), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,365 @@
+// Glss 的多通道实现，效果和 Bicubic.hlsl 相同
+// 原实现为每个输出像素重复计算输入邻域的 7x7 梯度和拉普拉斯，每个像素需要约 300 次纹理读取。
+// 此实现先在输入分辨率上为每个纹素计算一次这些特征，再在输出分辨率上重建。分析通道为计算着色器，
+// 每个线程组把块和边缘读入共享内存一次，盒式求和拆分为水平和竖直两趟。线性的特征（梯度、拉普拉斯）
+// 经双线性插值后和原实现相同，非线性的特征（纹理复杂度、梯度一致性）为近似值。
+// 原实现中去噪、频率融合和形态学抗锯齿的结果没有被使用（锐化只基于输入颜色），因此这里不再计算它们。
+// Denoise、AA Strength 和 Detail 参数仍然保留，以便和 Bicubic.hlsl 共用参数。
+
+//!MAGPIE EFFECT
+//!VERSION 4
+//!CAPABILITY FP16
+
+#include "StubDefs.hlsli"
+//!PARAMETER
+//!LABEL Sharpness
+//!DEFAULT 1.8
+//!MIN 0
+//!MAX 3
+//!STEP 0.01
+float paramSharpness;
+
+// 不起作用，只为和 Bicubic.hlsl 共用参数
+//!PARAMETER
+//!LABEL Denoise
+//!DEFAULT 0.4
+//!MIN 0
+//!MAX 1
+//!STEP 0.01
+float paramDenoise;
+
+// 不起作用，只为和 Bicubic.hlsl 共用参数
+//!PARAMETER
+//!LABEL AA Strength
+//!DEFAULT 0.6
+//!MIN 0
+//!MAX 1
+//!STEP 0.01
+float paramAAStrength;
+
+// 不起作用，只为和 Bicubic.hlsl 共用参数
+//!PARAMETER
+//!LABEL Detail
+//!DEFAULT 0.8
+//!MIN 0
+//!MAX 1
+//!STEP 0.01
+float paramDetail;
+
+//!PARAMETER
+//!LABEL Softness
+//!DEFAULT 0.3
+//!MIN 0
+//!MAX 1
+//!STEP 0.01
+float paramSoftness;
+
+//!TEXTURE
+Texture2D INPUT;
+
+//!TEXTURE
+Texture2D OUTPUT;
+
+// x: 亮度梯度 X，y: 亮度梯度 Y，z: 纹理复杂度，w: 梯度一致性
+//!TEXTURE
+//!WIDTH INPUT_WIDTH
+//!HEIGHT INPUT_HEIGHT
+//!FORMAT R16G16B16A16_FLOAT
+Texture2D glssFeatures;
+
+// 用于锐化的多尺度拉普拉斯组合
+//!TEXTURE
+//!WIDTH INPUT_WIDTH
+//!HEIGHT INPUT_HEIGHT
+//!FORMAT R16G16B16A16_FLOAT
+Texture2D glssSharpen;
+
+// rgb: 柔化使用的 3x3 邻域加权和，a: 不使用
+//!TEXTURE
+//!WIDTH INPUT_WIDTH
+//!HEIGHT INPUT_HEIGHT
+//!FORMAT R16G16B16A16_FLOAT
+Texture2D glssSoft;
+
+//!SAMPLER
+//!FILTER LINEAR
+SamplerState sam;
+
+//!SAMPLER
+//!FILTER POINT
+SamplerState sam1;
+
+//!COMMON
+
+static const float3 lumWeights = float3(0.299f, 0.587f, 0.114f);
+
+
+//!PASS 1
+//!DESC Analysis
+//!IN INPUT
+//!OUT glssFeatures, glssSharpen, glssSoft
+//!BLOCK_SIZE 16
+//!NUM_THREADS 64
+
+// 7x7 Sobel算子，和 Bicubic.hlsl 相同
+static const float g_sobelX[49] = {
+    -1, -4, -5, -6, -5, -4, -1,
+    -4, -16, -20, -24, -20, -16, -4,
+    -5, -20, -25, -30, -25, -20, -5,
+    -6, -24, -30, 0, -30, -24, -6,
+    -5, -20, -25, -30, -25, -20, -5,
+    -4, -16, -20, -24, -20, -16, -4,
+    -1, -4, -5, -6, -5, -4, -1
+};
+
+static const float g_sobelY[49] = {
+    -1, -4, -5, -6, -5, -4, -1,
+    -4, -16, -20, -24, -20, -16, -4,
+    -5, -20, -25, -30, -25, -20, -5,
+    -6, -24, -30, 0, -30, -24, -6,
+    -5, -20, -25, -30, -25, -20, -5,
+    -4, -16, -20, -24, -20, -16, -4,
+    -1, -4, -5, -6, -5, -4, -1
+};
+
+// 7x7 Scharr算子
+static const float g_scharrX[49] = {
+    -1, -4, -5, 0, 5, 4, 1,
+    -6, -24, -30, 0, 30, 24, 6,
+    -15, -60, -75, 0, 75, 60, 15,
+    -20, -80, -100, 0, 100, 80, 20,
+    -15, -60, -75, 0, 75, 60, 15,
+    -6, -24, -30, 0, 30, 24, 6,
+    -1, -4, -5, 0, 5, 4, 1
+};
+
+static const float g_scharrY[49] = {
+    -1, -6, -15, -20, -15, -6, -1,
+    -4, -24, -60, -80, -60, -24, -4,
+    -5, -30, -75, -100, -75, -30, -5,
+    0, 0, 0, 0, 0, 0, 0,
+    5, 30, 75, 100, 75, 30, 5,
+    4, 24, 60, 80, 60, 24, 4,
+    1, 6, 15, 20, 15, 6, 1
+};
+
+// 所有特征的半径都不超过 3，因此读取块和四周 3 个像素的边缘即可
+#define SH_PIXELS_X (MP_BLOCK_WIDTH + 6)
+#define SH_PIXELS_Y (MP_BLOCK_HEIGHT + 6)
+
+// 颜色只参与少量加减，可以使用 MF 存储。亮度要乘以最大 100 的算子系数，求和也可能很大，
+// 半精度会损失过多精度，因此亮度和求和的中间结果始终使用 float
+groupshared MF3 shPixels[SH_PIXELS_Y][SH_PIXELS_X];
+groupshared float shLuma[SH_PIXELS_Y][SH_PIXELS_X];
+// 水平方向求和的中间结果
+groupshared float3 shSum7H[SH_PIXELS_Y][MP_BLOCK_WIDTH];
+groupshared float3 shSum5H[SH_PIXELS_Y][MP_BLOCK_WIDTH];
+// 在 shLuma 上双线性插值，pos 为 shLuma 中的坐标
+float SampleLumaBilinear(float2 pos) {
+    const float2 base = floor(pos);
+    const float2 f = pos - base;
+    const uint2 p0 = (uint2)clamp(base, 0, float2(SH_PIXELS_X - 1, SH_PIXELS_Y - 1));
+    const uint2 p1 = min(p0 + 1, uint2(SH_PIXELS_X - 1, SH_PIXELS_Y - 1));
+
+    return lerp(
+        lerp(shLuma[p0.y][p0.x], shLuma[p0.y][p1.x], f.x),
+        lerp(shLuma[p1.y][p0.x], shLuma[p1.y][p1.x], f.x),
+        f.y
+    );
+}
+
+void Pass1(uint2 blockStart, uint3 threadId) {
+    const float2 inputPt = GetInputPt();
+    const uint2 inputSize = GetInputSize();
+    uint i;
+
+    for (i = threadId.x * 2; i < SH_PIXELS_X * SH_PIXELS_Y / 2; i += MP_NUM_THREADS_X * 2) {
+        const uint2 pos = uint2(i % SH_PIXELS_X, i / SH_PIXELS_X * 2);
+        const float2 tpos = (blockStart + pos - 2.5f) * inputPt;
+
+        const float4 sr = INPUT.GatherRed(sam1, tpos);
+        const float4 sg = INPUT.GatherGreen(sam1, tpos);
+        const float4 sb = INPUT.GatherBlue(sam1, tpos);
+
+        // w z
+        // x y
+        shPixels[pos.y][pos.x] = MF3(sr.w, sg.w, sb.w);
+        shPixels[pos.y][pos.x + 1] = MF3(sr.z, sg.z, sb.z);
+        shPixels[pos.y + 1][pos.x] = MF3(sr.x, sg.x, sb.x);
+        shPixels[pos.y + 1][pos.x + 1] = MF3(sr.y, sg.y, sb.y);
+
+        shLuma[pos.y][pos.x] = dot(float3(sr.w, sg.w, sb.w), lumWeights);
+        shLuma[pos.y][pos.x + 1] = dot(float3(sr.z, sg.z, sb.z), lumWeights);
+        shLuma[pos.y + 1][pos.x] = dot(float3(sr.x, sg.x, sb.x), lumWeights);
+        shLuma[pos.y + 1][pos.x + 1] = dot(float3(sr.y, sg.y, sb.y), lumWeights);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // 水平方向的盒式求和
+    for (i = threadId.x; i < SH_PIXELS_Y * MP_BLOCK_WIDTH; i += MP_NUM_THREADS_X) {
+        const uint2 pos = uint2(i % MP_BLOCK_WIDTH, i / MP_BLOCK_WIDTH);
+
+        float3 sum7 = 0;
+        float3 sum5 = 0;
+        [unroll]
+        for (uint k = 0; k < 7; ++k) {
+            const float3 texel = shPixels[pos.y][pos.x + k];
+            sum7 += texel;
+            if (k >= 1 && k <= 5) {
+                sum5 += texel;
+            }
+        }
+
+        shSum7H[pos.y][pos.x] = sum7;
+        shSum5H[pos.y][pos.x] = sum5;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    for (i = threadId.x; i < MP_BLOCK_WIDTH * MP_BLOCK_HEIGHT; i += MP_NUM_THREADS_X) {
+        const uint2 pos = uint2(i % MP_BLOCK_WIDTH, i / MP_BLOCK_WIDTH);
+        const uint2 destPos = blockStart + pos;
+
+        if (destPos.x >= inputSize.x || destPos.y >= inputSize.y) {
+            continue;
+        }
+
+        // 中心在 shPixels 中的坐标
+        const uint2 c = pos + 3;
+        const float3 center = shPixels[c.y][c.x];
+        const float centerLum = shLuma[c.y][c.x];
+
+        // 混合 7x7 Sobel 和 Scharr 梯度，同时计算纹理复杂度
+        float sobelX = 0, sobelY = 0, scharrX = 0, scharrY = 0;
+        float variance = 0;
+        [unroll]
+        for (int j = 0; j < 49; ++j) {
+            const float l = shLuma[pos.y + j / 7][pos.x + j % 7];
+            sobelX += l * g_sobelX[j];
+            sobelY += l * g_sobelY[j];
+            scharrX += l * g_scharrX[j];
+            scharrY += l * g_scharrY[j];
+            variance += (l - centerLum) * (l - centerLum);
+        }
+
+        const float2 gradient = lerp(float2(sobelX, sobelY) / 120.0f, float2(scharrX, scharrY) / 480.0f, 0.5f);
+        const float complexity = sqrt(variance / 49.0f);
+
+        // 方向场：原始方向和相距 2 个像素的 8 个邻域的 3x3 Sobel 方向的混合
+        float2 directionField = float2(1, 0);
+        if (length(gradient) >= 0.001f) {
+            const float2 dir = normalize(gradient);
+
+            float2 avgDir = 0;
+            float count = 0;
+
+            [unroll]
+            for (int dy = -1; dy <= 1; dy++) {
+                [unroll]
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (dx == 0 && dy == 0) {
+                        continue;
+                    }
+
+                    const uint cx = c.x + dx * 2;
+                    const uint cy = c.y + dy * 2;
+                    float2 neighborGrad = float2(
+                        -shLuma[cy - 1][cx - 1] - 2 * shLuma[cy][cx - 1] - shLuma[cy + 1][cx - 1]
+                        + shLuma[cy - 1][cx + 1] + 2 * shLuma[cy][cx + 1] + shLuma[cy + 1][cx + 1],
+                        -shLuma[cy - 1][cx - 1] - 2 * shLuma[cy - 1][cx] - shLuma[cy - 1][cx + 1]
+                        + shLuma[cy + 1][cx - 1] + 2 * shLuma[cy + 1][cx] + shLuma[cy + 1][cx + 1]
+                    ) / 4.0f;
+
+                    if (length(neighborGrad) > 0.01f) {
+                        avgDir += normalize(neighborGrad);
+                        count += 1.0f;
+                    }
+                }
+            }
+
+            if (count > 0) {
+                avgDir = normalize(avgDir / count);
+                directionField = lerp(dir, avgDir, 0.3f);
+            } else {
+                directionField = dir;
+            }
+        }
+
+        // 梯度一致性：正交方向和梯度方向上亮度变化之比。偏移不超过 3 个像素，仍在共享内存内
+        const float2 alongOffset = directionField * 3.0f;
+        const float2 orthoOffset = float2(-directionField.y, directionField.x) * 3.0f;
+        const float alongChange =
+            abs(SampleLumaBilinear(c + alongOffset) - centerLum) +
+            abs(SampleLumaBilinear(c - alongOffset) - centerLum);
+        const float orthoChange =
+            abs(SampleLumaBilinear(c + orthoOffset) - centerLum) +
+            abs(SampleLumaBilinear(c - orthoOffset) - centerLum);
+        const float coherence = saturate(orthoChange / (alongChange + 0.001f));
+
+        // 竖直方向的盒式求和
+        float3 sum7x7 = 0;
+        float3 sum5x5 = 0;
+        [unroll]
+        for (uint k = 0; k < 7; ++k) {
+            sum7x7 += shSum7H[pos.y + k][pos.x];
+            if (k >= 1 && k <= 5) {
+                sum5x5 += shSum5H[pos.y + k][pos.x];
+            }
+        }
+
+        const float3 sumCross = shPixels[c.y - 1][c.x] + shPixels[c.y + 1][c.x]
+            + shPixels[c.y][c.x - 1] + shPixels[c.y][c.x + 1];
+        const float3 sumDiagonal = shPixels[c.y - 1][c.x - 1] + shPixels[c.y - 1][c.x + 1]
+            + shPixels[c.y + 1][c.x - 1] + shPixels[c.y + 1][c.x + 1];
+
+        // 3x3、5x5 和 7x7 拉普拉斯
+        const float3 ultraFineDetails = 4.0f * center - sumCross;
+        const float3 fineDetails = (25.0f * center - sum5x5) / 24.0f;
+        const float3 mediumDetails = (49.0f * center - sum7x7) / 48.0f;
+
+        glssFeatures[destPos] = MF4(gradient, complexity, coherence);
+        glssSharpen[destPos] = MF4(mediumDetails * 0.3f + fineDetails * 0.4f + ultraFineDetails * 0.3f, 0);
+        glssSoft[destPos] = MF4(sumCross * 0.1f + sumDiagonal * 0.05f, 0);
+    }
+}
+
+
+//!PASS 2
+//!DESC Reconstruction
+//!STYLE PS
+//!IN INPUT, glssFeatures, glssSharpen, glssSoft
+//!OUT OUTPUT
+
+float4 Pass2(float2 pos) {
+    const MF3 center = (MF3)INPUT.SampleLevel(sam, pos, 0).rgb;
+
+    // 梯度特征。梯度是线性的，插值后和原实现相同
+    const MF4 features = (MF4)glssFeatures.SampleLevel(sam, pos, 0);
+    const MF2 gradient = features.xy;
+    const MF complexity = features.z;
+    const MF coherence = features.w;
+    const MF edgeStrength = max(abs(gradient.x), abs(gradient.y));
+    const MF confidence = saturate(length(gradient) * 5.0) * coherence * (1.0 - saturate(complexity * 2.0));
+
+    // 自适应锐化
+    MF adaptiveSharp = (MF)paramSharpness;
+    adaptiveSharp = lerp(adaptiveSharp * 0.3, adaptiveSharp, confidence);
+    adaptiveSharp = lerp(adaptiveSharp, adaptiveSharp * 0.5, complexity);
+    adaptiveSharp = lerp(adaptiveSharp, adaptiveSharp * 1.5, edgeStrength);
+    adaptiveSharp = lerp(adaptiveSharp * 0.5, adaptiveSharp, coherence);
+
+    // 振铃控制
+    const MF3 diff = (MF3)glssSharpen.SampleLevel(sam, pos, 0).rgb * adaptiveSharp;
+    const MF maxSharpen = 0.15 + confidence * 0.1;
+    const MF3 sharpened = clamp(clamp(diff, -maxSharpen, maxSharpen) + center, 0, 1);
+
+    // 柔化
+    MF3 finalColor = sharpened;
+    if (paramSoftness > 0.0f) {
+        const MF3 softResult = (sharpened + (MF3)glssSoft.SampleLevel(sam, pos, 0).rgb) / 1.6;
+        finalColor = lerp(sharpened, softResult, (MF)paramSoftness * 0.5);
+    }
+
+    return float4(saturate(finalColor), 1.0);
+}
@@ -13,6 +13,7 @@
 #include "shaders/SimpleVS.h"
 #include "Win32Helper.h"
 #include <DirectXMath.h>
+#include <rapidhash.h>
 
 using namespace DirectX;
 
@@ -550,23 +551,38 @@ const CursorDrawer::_CursorInfo* CursorDrawer::_ResolveCursor(HCURSOR hCursor) n
 
 	{
 		const bool isMonochrome = cursorInfo.type == _CursorType::Monochrome;
+		const DXGI_FORMAT format = isMonochrome ? DXGI_FORMAT_R8G8_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+		const UINT texHeight = iconInfo.hbmColor ? bmp.bmHeight : bmp.bmHeight / 2;
 		const D3D11_SUBRESOURCE_DATA initData{
 			.pSysMem = pixels.get(),
 			.SysMemPitch = UINT(bmp.bmWidth * (isMonochrome ? 2 : 4))
 		};
-		cursorTexture = DirectXHelper::CreateTexture2D(
-			d3dDevice,
-			isMonochrome ? DXGI_FORMAT_R8G8_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM,
-			bmp.bmWidth,
-			iconInfo.hbmColor ? bmp.bmHeight : bmp.bmHeight / 2,
-			D3D11_BIND_SHADER_RESOURCE,
-			D3D11_USAGE_IMMUTABLE,
-			0,
-			&initData
+
+		// 形状相同的光标可能有不同的句柄，因此以纹理内容为键在设备上缓存，缩放结束时丢弃
+		const uint64_t contentHash = rapidhash_withSeed(
+			pixels.get(),
+			(size_t)initData.SysMemPitch * texHeight,
+			((uint64_t)bmp.bmWidth << 32) | ((uint64_t)texHeight << 8) | format
 		);
+		cursorTexture.copy_from(_deviceResources->GetCachedTexture(contentHash));
+
 		if (!cursorTexture) {
-			Logger::Get().Error("创建光标纹理失败");
-			return nullptr;
+			cursorTexture = DirectXHelper::CreateTexture2D(
+				d3dDevice,
+				format,
+				bmp.bmWidth,
+				texHeight,
+				D3D11_BIND_SHADER_RESOURCE,
+				D3D11_USAGE_IMMUTABLE,
+				0,
+				&initData
+			);
+			if (!cursorTexture) {
+				Logger::Get().Error("创建光标纹理失败");
+				return nullptr;
+			}
+
+			_deviceResources->CacheTexture(contentHash, cursorTexture.get(), TextureCacheScope::Session);
 		}
 	}
 
@@ -0,0 +1,772 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#else
+// 其他平台上没有 dxgiformat.h，这里定义解析 DDS 文件用到的格式，值和 DXGI 相同
+enum DXGI_FORMAT {
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_TYPELESS = 1,
+	DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+	DXGI_FORMAT_R32G32B32A32_UINT = 3,
+	DXGI_FORMAT_R32G32B32A32_SINT = 4,
+	DXGI_FORMAT_R32G32B32_TYPELESS = 5,
+	DXGI_FORMAT_R32G32B32_FLOAT = 6,
+	DXGI_FORMAT_R32G32B32_UINT = 7,
+	DXGI_FORMAT_R32G32B32_SINT = 8,
+	DXGI_FORMAT_R16G16B16A16_TYPELESS = 9,
+	DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+	DXGI_FORMAT_R16G16B16A16_UNORM = 11,
+	DXGI_FORMAT_R16G16B16A16_UINT = 12,
+	DXGI_FORMAT_R16G16B16A16_SNORM = 13,
+	DXGI_FORMAT_R16G16B16A16_SINT = 14,
+	DXGI_FORMAT_R32G32_TYPELESS = 15,
+	DXGI_FORMAT_R32G32_FLOAT = 16,
+	DXGI_FORMAT_R32G32_UINT = 17,
+	DXGI_FORMAT_R32G32_SINT = 18,
+	DXGI_FORMAT_R32G8X24_TYPELESS = 19,
+	DXGI_FORMAT_D32_FLOAT_S8X24_UINT = 20,
+	DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS = 21,
+	DXGI_FORMAT_X32_TYPELESS_G8X24_UINT = 22,
+	DXGI_FORMAT_R10G10B10A2_TYPELESS = 23,
+	DXGI_FORMAT_R10G10B10A2_UNORM = 24,
+	DXGI_FORMAT_R10G10B10A2_UINT = 25,
+	DXGI_FORMAT_R11G11B10_FLOAT = 26,
+	DXGI_FORMAT_R8G8B8A8_TYPELESS = 27,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+	DXGI_FORMAT_R8G8B8A8_UINT = 30,
+	DXGI_FORMAT_R8G8B8A8_SNORM = 31,
+	DXGI_FORMAT_R8G8B8A8_SINT = 32,
+	DXGI_FORMAT_R16G16_TYPELESS = 33,
+	DXGI_FORMAT_R16G16_FLOAT = 34,
+	DXGI_FORMAT_R16G16_UNORM = 35,
+	DXGI_FORMAT_R16G16_UINT = 36,
+	DXGI_FORMAT_R16G16_SNORM = 37,
+	DXGI_FORMAT_R16G16_SINT = 38,
+	DXGI_FORMAT_R32_TYPELESS = 39,
+	DXGI_FORMAT_D32_FLOAT = 40,
+	DXGI_FORMAT_R32_FLOAT = 41,
+	DXGI_FORMAT_R32_UINT = 42,
+	DXGI_FORMAT_R32_SINT = 43,
+	DXGI_FORMAT_R24G8_TYPELESS = 44,
+	DXGI_FORMAT_D24_UNORM_S8_UINT = 45,
+	DXGI_FORMAT_R24_UNORM_X8_TYPELESS = 46,
+	DXGI_FORMAT_X24_TYPELESS_G8_UINT = 47,
+	DXGI_FORMAT_R8G8_TYPELESS = 48,
+	DXGI_FORMAT_R8G8_UNORM = 49,
+	DXGI_FORMAT_R8G8_UINT = 50,
+	DXGI_FORMAT_R8G8_SNORM = 51,
+	DXGI_FORMAT_R8G8_SINT = 52,
+	DXGI_FORMAT_R16_TYPELESS = 53,
+	DXGI_FORMAT_R16_FLOAT = 54,
+	DXGI_FORMAT_D16_UNORM = 55,
+	DXGI_FORMAT_R16_UNORM = 56,
+	DXGI_FORMAT_R16_UINT = 57,
+	DXGI_FORMAT_R16_SNORM = 58,
+	DXGI_FORMAT_R16_SINT = 59,
+	DXGI_FORMAT_R8_TYPELESS = 60,
+	DXGI_FORMAT_R8_UNORM = 61,
+	DXGI_FORMAT_R8_UINT = 62,
+	DXGI_FORMAT_R8_SNORM = 63,
+	DXGI_FORMAT_R8_SINT = 64,
+	DXGI_FORMAT_A8_UNORM = 65,
+	DXGI_FORMAT_R1_UNORM = 66,
+	DXGI_FORMAT_R9G9B9E5_SHAREDEXP = 67,
+	DXGI_FORMAT_R8G8_B8G8_UNORM = 68,
+	DXGI_FORMAT_G8R8_G8B8_UNORM = 69,
+	DXGI_FORMAT_BC1_TYPELESS = 70,
+	DXGI_FORMAT_BC1_UNORM = 71,
+	DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+	DXGI_FORMAT_BC2_TYPELESS = 73,
+	DXGI_FORMAT_BC2_UNORM = 74,
+	DXGI_FORMAT_BC2_UNORM_SRGB = 75,
+	DXGI_FORMAT_BC3_TYPELESS = 76,
+	DXGI_FORMAT_BC3_UNORM = 77,
+	DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+	DXGI_FORMAT_BC4_TYPELESS = 79,
+	DXGI_FORMAT_BC4_UNORM = 80,
+	DXGI_FORMAT_BC4_SNORM = 81,
+	DXGI_FORMAT_BC5_TYPELESS = 82,
+	DXGI_FORMAT_BC5_UNORM = 83,
+	DXGI_FORMAT_BC5_SNORM = 84,
+	DXGI_FORMAT_B5G6R5_UNORM = 85,
+	DXGI_FORMAT_B5G5R5A1_UNORM = 86,
+	DXGI_FORMAT_B8G8R8A8_UNORM = 87,
+	DXGI_FORMAT_B8G8R8X8_UNORM = 88,
+	DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM = 89,
+	DXGI_FORMAT_B8G8R8A8_TYPELESS = 90,
+	DXGI_FORMAT_B8G8R8A8_UNORM_SRGB = 91,
+	DXGI_FORMAT_B8G8R8X8_TYPELESS = 92,
+	DXGI_FORMAT_B8G8R8X8_UNORM_SRGB = 93,
+	DXGI_FORMAT_BC6H_TYPELESS = 94,
+	DXGI_FORMAT_BC6H_UF16 = 95,
+	DXGI_FORMAT_BC6H_SF16 = 96,
+	DXGI_FORMAT_BC7_TYPELESS = 97,
+	DXGI_FORMAT_BC7_UNORM = 98,
+	DXGI_FORMAT_BC7_UNORM_SRGB = 99,
+	DXGI_FORMAT_AYUV = 100,
+	DXGI_FORMAT_Y410 = 101,
+	DXGI_FORMAT_Y416 = 102,
+	DXGI_FORMAT_NV12 = 103,
+	DXGI_FORMAT_P010 = 104,
+	DXGI_FORMAT_P016 = 105,
+	DXGI_FORMAT_420_OPAQUE = 106,
+	DXGI_FORMAT_YUY2 = 107,
+	DXGI_FORMAT_Y210 = 108,
+	DXGI_FORMAT_Y216 = 109,
+	DXGI_FORMAT_NV11 = 110,
+	DXGI_FORMAT_AI44 = 111,
+	DXGI_FORMAT_IA44 = 112,
+	DXGI_FORMAT_P8 = 113,
+	DXGI_FORMAT_A8P8 = 114,
+	DXGI_FORMAT_B4G4R4A4_UNORM = 115,
+	DXGI_FORMAT_P208 = 130,
+	DXGI_FORMAT_V208 = 131,
+	DXGI_FORMAT_V408 = 132,
+	DXGI_FORMAT_FORCE_UINT = 0xffffffff
+};
+#endif
+
+#include "DDS.h"
+
+///////////////////////////////////////////////////////////////////////
+// 
+// 解析 DDS 文件头的代码来自 https://github.com/microsoft/DirectXTK
+// 
+///////////////////////////////////////////////////////////////////////
+
+namespace Magpie {
+
+// 解析结果，描述文件中的二维纹理
+struct DDSTextureInfo {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t mipCount = 0;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	// 纹理数据在文件中的偏移
+	size_t dataOffset = 0;
+	// 从 dataOffset 到文件末尾的字节数，不保证足够容纳所有 mip
+	size_t dataSize = 0;
+};
+
+#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+
+// DDS 文件头的解析和格式计算，不依赖 Windows 和 Direct3D，可以独立测试。
+// 文件来自磁盘，内容不可信，所有函数都必须能处理任意输入。
+struct DDSFormat {
+	// 和 D3D11_REQ_MIP_LEVELS 以及 D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION 相同
+	static constexpr uint32_t MAX_MIP_LEVELS = 15;
+	static constexpr uint32_t MAX_TEXTURE_DIMENSION = 16384;
+
+	// 验证文件头并解析出二维纹理的信息。不支持体积纹理、立方体贴图、纹理数组和视频格式
+	static bool ParseHeader(const uint8_t* data, size_t size, DDSTextureInfo& info) noexcept {
+		// Need at least enough data to fill the header and magic number to be a valid DDS
+		if (size < DDS_MIN_HEADER_SIZE) {
+			return false;
+		}
+
+		// DDS files always start with the same magic number ("DDS ")
+		uint32_t magic;
+		std::memcpy(&magic, data, sizeof(magic));
+		if (magic != DDS_MAGIC) {
+			return false;
+		}
+
+		DDS_HEADER header;
+		std::memcpy(&header, data + sizeof(uint32_t), sizeof(header));
+
+		// Verify header to validate DDS file
+		if (header.size != sizeof(DDS_HEADER) ||
+			header.ddspf.size != sizeof(DDS_PIXELFORMAT)) {
+			return false;
+		}
+
+		DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+		size_t dataOffset = DDS_MIN_HEADER_SIZE;
+
+		// Check for DX10 extension
+		if ((header.ddspf.flags & DDS_FOURCC) &&
+			(MAKEFOURCC('D', 'X', '1', '0') == header.ddspf.fourCC)) {
+			// Must be long enough for both headers and magic value
+			if (size < DDS_DX10_HEADER_SIZE) {
+				return false;
+			}
+
+			DDS_HEADER_DXT10 d3d10ext;
+			std::memcpy(&d3d10ext, data + DDS_MIN_HEADER_SIZE, sizeof(d3d10ext));
+			dataOffset = DDS_DX10_HEADER_SIZE;
+
+			if (d3d10ext.arraySize != 1 || d3d10ext.resourceDimension != DDS_DIMENSION_TEXTURE2D ||
+				(d3d10ext.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)) {
+				return false;
+			}
+
+			switch (d3d10ext.dxgiFormat) {
+			case DXGI_FORMAT_AI44:
+			case DXGI_FORMAT_IA44:
+			case DXGI_FORMAT_P8:
+			case DXGI_FORMAT_A8P8:
+				// 不支持视频格式
+				return false;
+			default:
+				format = d3d10ext.dxgiFormat;
+				break;
+			}
+		} else {
+			// Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
+			if ((header.flags & DDS_HEADER_FLAGS_VOLUME) || (header.caps2 & DDS_CUBEMAP)) {
+				return false;
+			}
+
+			format = GetDXGIFormat(header.ddspf);
+		}
+
+		if (BitsPerPixel(format) == 0) {
+			return false;
+		}
+
+		const uint32_t mipCount = std::max(header.mipMapCount, 1u);
+
+		// Bound sizes (for security purposes we don't trust DDS file metadata larger than the Direct3D hardware requirements)
+		if (mipCount > MAX_MIP_LEVELS || header.width == 0 || header.height == 0 ||
+			header.width > MAX_TEXTURE_DIMENSION || header.height > MAX_TEXTURE_DIMENSION) {
+			return false;
+		}
+
+		info.width = header.width;
+		info.height = header.height;
+		info.mipCount = mipCount;
+		info.format = format;
+		info.dataOffset = dataOffset;
+		info.dataSize = size - dataOffset;
+		return true;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// Return the BPP for a particular format
+	//--------------------------------------------------------------------------------------
+	static size_t BitsPerPixel(DXGI_FORMAT fmt) noexcept {
+		switch (fmt) {
+		case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		case DXGI_FORMAT_R32G32B32A32_UINT:
+		case DXGI_FORMAT_R32G32B32A32_SINT:
+			return 128;
+
+		case DXGI_FORMAT_R32G32B32_TYPELESS:
+		case DXGI_FORMAT_R32G32B32_FLOAT:
+		case DXGI_FORMAT_R32G32B32_UINT:
+		case DXGI_FORMAT_R32G32B32_SINT:
+			return 96;
+
+		case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+		case DXGI_FORMAT_R16G16B16A16_UINT:
+		case DXGI_FORMAT_R16G16B16A16_SNORM:
+		case DXGI_FORMAT_R16G16B16A16_SINT:
+		case DXGI_FORMAT_R32G32_TYPELESS:
+		case DXGI_FORMAT_R32G32_FLOAT:
+		case DXGI_FORMAT_R32G32_UINT:
+		case DXGI_FORMAT_R32G32_SINT:
+		case DXGI_FORMAT_R32G8X24_TYPELESS:
+		case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+		case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+		case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+		case DXGI_FORMAT_Y416:
+		case DXGI_FORMAT_Y210:
+		case DXGI_FORMAT_Y216:
+			return 64;
+
+		case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+		case DXGI_FORMAT_R10G10B10A2_UINT:
+		case DXGI_FORMAT_R11G11B10_FLOAT:
+		case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_R8G8B8A8_UINT:
+		case DXGI_FORMAT_R8G8B8A8_SNORM:
+		case DXGI_FORMAT_R8G8B8A8_SINT:
+		case DXGI_FORMAT_R16G16_TYPELESS:
+		case DXGI_FORMAT_R16G16_FLOAT:
+		case DXGI_FORMAT_R16G16_UNORM:
+		case DXGI_FORMAT_R16G16_UINT:
+		case DXGI_FORMAT_R16G16_SNORM:
+		case DXGI_FORMAT_R16G16_SINT:
+		case DXGI_FORMAT_R32_TYPELESS:
+		case DXGI_FORMAT_D32_FLOAT:
+		case DXGI_FORMAT_R32_FLOAT:
+		case DXGI_FORMAT_R32_UINT:
+		case DXGI_FORMAT_R32_SINT:
+		case DXGI_FORMAT_R24G8_TYPELESS:
+		case DXGI_FORMAT_D24_UNORM_S8_UINT:
+		case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+		case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+		case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+		case DXGI_FORMAT_R8G8_B8G8_UNORM:
+		case DXGI_FORMAT_G8R8_G8B8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:
+		case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		case DXGI_FORMAT_AYUV:
+		case DXGI_FORMAT_Y410:
+		case DXGI_FORMAT_YUY2:
+			return 32;
+
+		case DXGI_FORMAT_P010:
+		case DXGI_FORMAT_P016:
+		case DXGI_FORMAT_V408:
+			return 24;
+
+		case DXGI_FORMAT_R8G8_TYPELESS:
+		case DXGI_FORMAT_R8G8_UNORM:
+		case DXGI_FORMAT_R8G8_UINT:
+		case DXGI_FORMAT_R8G8_SNORM:
+		case DXGI_FORMAT_R8G8_SINT:
+		case DXGI_FORMAT_R16_TYPELESS:
+		case DXGI_FORMAT_R16_FLOAT:
+		case DXGI_FORMAT_D16_UNORM:
+		case DXGI_FORMAT_R16_UNORM:
+		case DXGI_FORMAT_R16_UINT:
+		case DXGI_FORMAT_R16_SNORM:
+		case DXGI_FORMAT_R16_SINT:
+		case DXGI_FORMAT_B5G6R5_UNORM:
+		case DXGI_FORMAT_B5G5R5A1_UNORM:
+		case DXGI_FORMAT_A8P8:
+		case DXGI_FORMAT_B4G4R4A4_UNORM:
+		case DXGI_FORMAT_P208:
+		case DXGI_FORMAT_V208:
+			return 16;
+
+		case DXGI_FORMAT_NV12:
+		case DXGI_FORMAT_420_OPAQUE:
+		case DXGI_FORMAT_NV11:
+			return 12;
+
+		case DXGI_FORMAT_R8_TYPELESS:
+		case DXGI_FORMAT_R8_UNORM:
+		case DXGI_FORMAT_R8_UINT:
+		case DXGI_FORMAT_R8_SNORM:
+		case DXGI_FORMAT_R8_SINT:
+		case DXGI_FORMAT_A8_UNORM:
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC6H_TYPELESS:
+		case DXGI_FORMAT_BC6H_UF16:
+		case DXGI_FORMAT_BC6H_SF16:
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+		case DXGI_FORMAT_AI44:
+		case DXGI_FORMAT_IA44:
+		case DXGI_FORMAT_P8:
+			return 8;
+
+		case DXGI_FORMAT_R1_UNORM:
+			return 1;
+
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC4_SNORM:
+			return 4;
+
+		default:
+			return 0;
+		}
+	}
+
+	//--------------------------------------------------------------------------------------
+	// Get surface information for a particular format
+	//--------------------------------------------------------------------------------------
+	static bool GetSurfaceInfo(
+		size_t width,
+		size_t height,
+		DXGI_FORMAT fmt,
+		size_t* outNumBytes,
+		size_t* outRowBytes,
+		size_t* outNumRows
+	) noexcept {
+		uint64_t numBytes = 0;
+		uint64_t rowBytes = 0;
+		uint64_t numRows = 0;
+
+		bool bc = false;
+		bool packed = false;
+		bool planar = false;
+		size_t bpe = 0;
+		switch (fmt) {
+		case DXGI_FORMAT_UNKNOWN:
+			return false;
+
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC4_SNORM:
+			bc = true;
+			bpe = 8;
+			break;
+
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC6H_TYPELESS:
+		case DXGI_FORMAT_BC6H_UF16:
+		case DXGI_FORMAT_BC6H_SF16:
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			bc = true;
+			bpe = 16;
+			break;
+
+		case DXGI_FORMAT_R8G8_B8G8_UNORM:
+		case DXGI_FORMAT_G8R8_G8B8_UNORM:
+		case DXGI_FORMAT_YUY2:
+			packed = true;
+			bpe = 4;
+			break;
+
+		case DXGI_FORMAT_Y210:
+		case DXGI_FORMAT_Y216:
+			packed = true;
+			bpe = 8;
+			break;
+
+		case DXGI_FORMAT_NV12:
+		case DXGI_FORMAT_420_OPAQUE:
+			if ((height % 2) != 0) {
+				// Requires a height alignment of 2.
+				return false;
+			}
+			planar = true;
+			bpe = 2;
+			break;
+
+		case DXGI_FORMAT_P208:
+			planar = true;
+			bpe = 2;
+			break;
+
+		case DXGI_FORMAT_P010:
+		case DXGI_FORMAT_P016:
+			if ((height % 2) != 0) {
+				// Requires a height alignment of 2.
+				return false;
+			}
+			planar = true;
+			bpe = 4;
+			break;
+
+		default:
+			break;
+		}
+
+		if (bc) {
+			uint64_t numBlocksWide = 0;
+			if (width > 0) {
+				numBlocksWide = std::max<uint64_t>(1u, (uint64_t(width) + 3u) / 4u);
+			}
+			uint64_t numBlocksHigh = 0;
+			if (height > 0) {
+				numBlocksHigh = std::max<uint64_t>(1u, (uint64_t(height) + 3u) / 4u);
+			}
+			rowBytes = numBlocksWide * bpe;
+			numRows = numBlocksHigh;
+			numBytes = rowBytes * numBlocksHigh;
+		} else if (packed) {
+			rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
+			numRows = uint64_t(height);
+			numBytes = rowBytes * height;
+		} else if (fmt == DXGI_FORMAT_NV11) {
+			rowBytes = ((uint64_t(width) + 3u) >> 2) * 4u;
+			numRows = uint64_t(height) * 2u; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+			numBytes = rowBytes * numRows;
+		} else if (planar) {
+			rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
+			numBytes = (rowBytes * uint64_t(height)) + ((rowBytes * uint64_t(height) + 1u) >> 1);
+			numRows = height + ((uint64_t(height) + 1u) >> 1);
+		} else {
+			const size_t bpp = BitsPerPixel(fmt);
+			if (!bpp) {
+				return false;
+			}
+
+			rowBytes = (uint64_t(width) * bpp + 7u) / 8u; // round up to nearest byte
+			numRows = uint64_t(height);
+			numBytes = rowBytes * height;
+		}
+
+		if (outNumBytes) {
+			*outNumBytes = static_cast<size_t>(numBytes);
+		}
+		if (outRowBytes) {
+			*outRowBytes = static_cast<size_t>(rowBytes);
+		}
+		if (outNumRows) {
+			*outNumRows = static_cast<size_t>(numRows);
+		}
+
+		return true;
+	}
+
+	static DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf) noexcept {
+		if (ddpf.flags & DDS_RGB) {
+			// Note that sRGB formats are written using the "DX10" extended header
+
+			switch (ddpf.RGBBitCount) {
+			case 32:
+				if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) {
+					return DXGI_FORMAT_R8G8B8A8_UNORM;
+				}
+
+				if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)) {
+					return DXGI_FORMAT_B8G8R8A8_UNORM;
+				}
+
+				if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0)) {
+					return DXGI_FORMAT_B8G8R8X8_UNORM;
+				}
+
+				// No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0) aka D3DFMT_X8B8G8R8
+
+				// Note that many common DDS reader/writers (including D3DX) swap the
+				// the RED/BLUE masks for 10:10:10:2 formats. We assume
+				// below that the 'backwards' header mask is being used since it is most
+				// likely written by D3DX. The more robust solution is to use the 'DX10'
+				// header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+				// For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+				if (ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000)) {
+					return DXGI_FORMAT_R10G10B10A2_UNORM;
+				}
+
+				// No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+				if (ISBITMASK(0x0000ffff, 0xffff0000, 0, 0)) {
+					return DXGI_FORMAT_R16G16_UNORM;
+				}
+
+				if (ISBITMASK(0xffffffff, 0, 0, 0)) {
+					// Only 32-bit color channel format in D3D9 was R32F
+					return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+				}
+				break;
+
+			case 24:
+				// No 24bpp DXGI formats aka D3DFMT_R8G8B8
+				break;
+
+			case 16:
+				if (ISBITMASK(0x7c00, 0x03e0, 0x001f, 0x8000)) {
+					return DXGI_FORMAT_B5G5R5A1_UNORM;
+				}
+				if (ISBITMASK(0xf800, 0x07e0, 0x001f, 0)) {
+					return DXGI_FORMAT_B5G6R5_UNORM;
+				}
+
+				// No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0) aka D3DFMT_X1R5G5B5
+
+				if (ISBITMASK(0x0f00, 0x00f0, 0x000f, 0xf000)) {
+					return DXGI_FORMAT_B4G4R4A4_UNORM;
+				}
+
+				// NVTT versions 1.x wrote this as RGB instead of LUMINANCE
+				if (ISBITMASK(0x00ff, 0, 0, 0xff00)) {
+					return DXGI_FORMAT_R8G8_UNORM;
+				}
+				if (ISBITMASK(0xffff, 0, 0, 0)) {
+					return DXGI_FORMAT_R16_UNORM;
+				}
+
+				// No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0) aka D3DFMT_X4R4G4B4
+
+				// No 3:3:2:8 or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_A8P8, etc.
+				break;
+
+			case 8:
+				// NVTT versions 1.x wrote this as RGB instead of LUMINANCE
+				if (ISBITMASK(0xff, 0, 0, 0)) {
+					return DXGI_FORMAT_R8_UNORM;
+				}
+
+				// No 3:3:2 or paletted DXGI formats aka D3DFMT_R3G3B2, D3DFMT_P8
+				break;
+
+			default:
+				return DXGI_FORMAT_UNKNOWN;
+			}
+		} else if (ddpf.flags & DDS_LUMINANCE) {
+			switch (ddpf.RGBBitCount) {
+			case 16:
+				if (ISBITMASK(0xffff, 0, 0, 0)) {
+					return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+				}
+				if (ISBITMASK(0x00ff, 0, 0, 0xff00)) {
+					return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+				}
+				break;
+
+			case 8:
+				if (ISBITMASK(0xff, 0, 0, 0)) {
+					return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+				}
+
+				// No DXGI format maps to ISBITMASK(0x0f,0,0,0xf0) aka D3DFMT_A4L4
+
+				if (ISBITMASK(0x00ff, 0, 0, 0xff00)) {
+					return DXGI_FORMAT_R8G8_UNORM; // Some DDS writers assume the bitcount should be 8 instead of 16
+				}
+				break;
+
+			default:
+				return DXGI_FORMAT_UNKNOWN;
+			}
+		} else if (ddpf.flags & DDS_ALPHA) {
+			if (8 == ddpf.RGBBitCount) {
+				return DXGI_FORMAT_A8_UNORM;
+			}
+		} else if (ddpf.flags & DDS_BUMPDUDV) {
+			switch (ddpf.RGBBitCount) {
+			case 32:
+				if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) {
+					return DXGI_FORMAT_R8G8B8A8_SNORM; // D3DX10/11 writes this out as DX10 extension
+				}
+				if (ISBITMASK(0x0000ffff, 0xffff0000, 0, 0)) {
+					return DXGI_FORMAT_R16G16_SNORM; // D3DX10/11 writes this out as DX10 extension
+				}
+
+				// No DXGI format maps to ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
+				break;
+
+			case 16:
+				if (ISBITMASK(0x00ff, 0xff00, 0, 0)) {
+					return DXGI_FORMAT_R8G8_SNORM; // D3DX10/11 writes this out as DX10 extension
+				}
+				break;
+
+			default:
+				return DXGI_FORMAT_UNKNOWN;
+			}
+
+			// No DXGI format maps to DDPF_BUMPLUMINANCE aka D3DFMT_L6V5U5, D3DFMT_X8L8V8U8
+		} else if (ddpf.flags & DDS_FOURCC) {
+			if (MAKEFOURCC('D', 'X', 'T', '1') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC1_UNORM;
+			}
+			if (MAKEFOURCC('D', 'X', 'T', '3') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC2_UNORM;
+			}
+			if (MAKEFOURCC('D', 'X', 'T', '5') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC3_UNORM;
+			}
+
+			// While pre-multiplied alpha isn't directly supported by the DXGI formats,
+			// they are basically the same as these BC formats so they can be mapped
+			if (MAKEFOURCC('D', 'X', 'T', '2') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC2_UNORM;
+			}
+			if (MAKEFOURCC('D', 'X', 'T', '4') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC3_UNORM;
+			}
+
+			if (MAKEFOURCC('A', 'T', 'I', '1') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC4_UNORM;
+			}
+			if (MAKEFOURCC('B', 'C', '4', 'U') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC4_UNORM;
+			}
+			if (MAKEFOURCC('B', 'C', '4', 'S') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC4_SNORM;
+			}
+
+			if (MAKEFOURCC('A', 'T', 'I', '2') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC5_UNORM;
+			}
+			if (MAKEFOURCC('B', 'C', '5', 'U') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC5_UNORM;
+			}
+			if (MAKEFOURCC('B', 'C', '5', 'S') == ddpf.fourCC) {
+				return DXGI_FORMAT_BC5_SNORM;
+			}
+
+			// BC6H and BC7 are written using the "DX10" extended header
+
+			if (MAKEFOURCC('R', 'G', 'B', 'G') == ddpf.fourCC) {
+				return DXGI_FORMAT_R8G8_B8G8_UNORM;
+			}
+			if (MAKEFOURCC('G', 'R', 'G', 'B') == ddpf.fourCC) {
+				return DXGI_FORMAT_G8R8_G8B8_UNORM;
+			}
+
+			if (MAKEFOURCC('Y', 'U', 'Y', '2') == ddpf.fourCC) {
+				return DXGI_FORMAT_YUY2;
+			}
+
+			// Check for D3DFORMAT enums being set here
+			switch (ddpf.fourCC) {
+			case 36: // D3DFMT_A16B16G16R16
+				return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+			case 110: // D3DFMT_Q16W16V16U16
+				return DXGI_FORMAT_R16G16B16A16_SNORM;
+
+			case 111: // D3DFMT_R16F
+				return DXGI_FORMAT_R16_FLOAT;
+
+			case 112: // D3DFMT_G16R16F
+				return DXGI_FORMAT_R16G16_FLOAT;
+
+			case 113: // D3DFMT_A16B16G16R16F
+				return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+			case 114: // D3DFMT_R32F
+				return DXGI_FORMAT_R32_FLOAT;
+
+			case 115: // D3DFMT_G32R32F
+				return DXGI_FORMAT_R32G32_FLOAT;
+
+			case 116: // D3DFMT_A32B32G32R32F
+				return DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+			// No DXGI format maps to D3DFMT_CxV8U8
+
+			default:
+				return DXGI_FORMAT_UNKNOWN;
+			}
+		}
+
+		return DXGI_FORMAT_UNKNOWN;
+	}
+};
+
+#undef ISBITMASK
+
+}
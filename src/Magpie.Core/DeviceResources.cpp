@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "DeviceResources.h"
+#include "DDSFormat.h"
 #include "DirectXHelper.h"
 #include "Logger.h"
 #include "ScalingOptions.h"
@@ -8,6 +9,205 @@
 
 namespace Magpie {
 
+// 纹理缓存的大小上限
+static constexpr size_t MAX_TEXTURE_CACHE_SIZE = 128 * 1024 * 1024;
+// 保留的设备空闲超过此时间后释放
+static constexpr std::chrono::milliseconds POOLED_DEVICE_IDLE_TIMEOUT = std::chrono::minutes(2);
+
+// 缩放结束后设备不会被销毁，而是放入此池中供下次缩放重用，设备上缓存的纹理也因此得以保留。
+// 前台和后台各保留一个设备，空闲超时或没有启用自动缩放时释放。
+struct PooledDevice {
+	winrt::com_ptr<IDXGIFactory7> dxgiFactory;
+	winrt::com_ptr<IDXGIAdapter4> graphicsAdapter;
+	winrt::com_ptr<ID3D11Device5> d3dDevice;
+	winrt::com_ptr<ID3D11DeviceContext4> d3dDC;
+	TextureCache textureCache;
+	std::chrono::steady_clock::time_point pooledTime;
+	LUID adapterLuid{};
+	UINT createDeviceFlags = 0;
+	bool isFP16Supported = false;
+};
+
+// ScalingRuntime 退出缩放线程前调用 ReleasePooledDevices 清空此池，析构时不再持有设备
+struct DevicePool {
+	wil::srwlock lock;
+	// 第一个为后台设备，第二个为前台设备
+	std::optional<PooledDevice> devices[2];
+};
+
+static DevicePool& GetDevicePool() noexcept {
+	static DevicePool pool;
+	return pool;
+}
+
+static size_t GetTextureSize(ID3D11Texture2D* texture) noexcept {
+	D3D11_TEXTURE2D_DESC desc;
+	texture->GetDesc(&desc);
+
+	size_t result = 0;
+	size_t width = desc.Width;
+	size_t height = desc.Height;
+	for (UINT i = 0; i < desc.MipLevels; ++i) {
+		size_t numBytes = 0;
+		DDSFormat::GetSurfaceInfo(width, height, desc.Format, &numBytes, nullptr, nullptr);
+		result += numBytes;
+
+		width = std::max<size_t>(width >> 1, 1);
+		height = std::max<size_t>(height >> 1, 1);
+	}
+
+	return result * desc.ArraySize;
+}
+
+ID3D11Texture2D* TextureCache::Get(uint64_t contentHash) noexcept {
+	auto it = _index.find(contentHash);
+	if (it == _index.end()) {
+		return nullptr;
+	}
+
+	// 移到最前
+	_entries.splice(_entries.begin(), _entries, it->second);
+	return it->second->texture.get();
+}
+
+void TextureCache::Put(uint64_t contentHash, ID3D11Texture2D* texture, TextureCacheScope scope) noexcept {
+	if (auto it = _index.find(contentHash); it != _index.end()) {
+		_Erase(it->second);
+	}
+
+	const size_t size = GetTextureSize(texture);
+	if (size > MAX_TEXTURE_CACHE_SIZE) {
+		return;
+	}
+
+	_Entry& entry = _entries.emplace_front();
+	entry.contentHash = contentHash;
+	entry.texture.copy_from(texture);
+	entry.size = size;
+	entry.scope = scope;
+	_index.emplace(contentHash, _entries.begin());
+	_totalSize += size;
+
+	// 淘汰最久未使用的纹理
+	while (_totalSize > MAX_TEXTURE_CACHE_SIZE) {
+		_Erase(std::prev(_entries.end()));
+	}
+}
+
+void TextureCache::ClearSessionEntries() noexcept {
+	for (auto it = _entries.begin(); it != _entries.end();) {
+		auto next = std::next(it);
+		if (it->scope == TextureCacheScope::Session) {
+			_Erase(it);
+		}
+		it = next;
+	}
+}
+
+void TextureCache::_Erase(std::list<_Entry>::iterator it) noexcept {
+	_totalSize -= it->size;
+	_index.erase(it->contentHash);
+	_entries.erase(it);
+}
+
+static LUID GetAdapterLuid(IDXGIAdapter1* adapter) noexcept {
+	DXGI_ADAPTER_DESC1 desc;
+	HRESULT hr = adapter->GetDesc1(&desc);
+	if (FAILED(hr)) {
+		Logger::Get().ComError("GetDesc1 失败", hr);
+		return {};
+	}
+	return desc.AdapterLuid;
+}
+
+DeviceResources::~DeviceResources() noexcept {
+	if (!_d3dDevice) {
+		return;
+	}
+
+	// 设备已丢失则无法重用，缓存的纹理随之丢弃
+	HRESULT hr = _d3dDevice->GetDeviceRemovedReason();
+	if (FAILED(hr)) {
+		Logger::Get().ComWarn("设备已丢失", hr);
+		return;
+	}
+
+	// 光标纹理只在本次缩放中有用
+	_textureCache.ClearSessionEntries();
+
+	// 解除所有绑定，使缩放时创建的资源可以释放
+	_d3dDC->ClearState();
+	_d3dDC->Flush();
+
+	const LUID adapterLuid = GetAdapterLuid(_graphicsAdapter.get());
+	PooledDevice pooledDevice{
+		.dxgiFactory = std::move(_dxgiFactory),
+		.graphicsAdapter = std::move(_graphicsAdapter),
+		.d3dDevice = std::move(_d3dDevice),
+		.d3dDC = std::move(_d3dDC),
+		.textureCache = std::move(_textureCache),
+		.pooledTime = std::chrono::steady_clock::now(),
+		.adapterLuid = adapterLuid,
+		.createDeviceFlags = _createDeviceFlags,
+		.isFP16Supported = _isFP16Supported
+	};
+
+	// 被替换的设备在释放锁之后销毁
+	std::optional<PooledDevice> oldDevice(std::move(pooledDevice));
+	{
+		DevicePool& pool = GetDevicePool();
+		auto lk = pool.lock.lock_exclusive();
+		std::swap(pool.devices[_isForeground], oldDevice);
+	}
+}
+
+void DeviceResources::ReleasePooledDevices() noexcept {
+	std::optional<PooledDevice> devices[2];
+	{
+		DevicePool& pool = GetDevicePool();
+		auto lk = pool.lock.lock_exclusive();
+		devices[0] = std::exchange(pool.devices[0], std::nullopt);
+		devices[1] = std::exchange(pool.devices[1], std::nullopt);
+	}
+
+	if (devices[0] || devices[1]) {
+		Logger::Get().Info("已释放保留的 D3D 设备");
+	}
+}
+
+DWORD DeviceResources::ReleaseIdlePooledDevices() noexcept {
+	using namespace std::chrono;
+
+	const steady_clock::time_point now = steady_clock::now();
+	std::optional<PooledDevice> expiredDevices[2];
+	DWORD result = INFINITE;
+	{
+		DevicePool& pool = GetDevicePool();
+		auto lk = pool.lock.lock_exclusive();
+
+		for (int i = 0; i < 2; ++i) {
+			if (!pool.devices[i]) {
+				continue;
+			}
+
+			const auto idleTime = now - pool.devices[i]->pooledTime;
+			if (idleTime >= POOLED_DEVICE_IDLE_TIMEOUT) {
+				expiredDevices[i] = std::exchange(pool.devices[i], std::nullopt);
+			} else {
+				// 向上取整
+				const auto rest = ceil<milliseconds>(POOLED_DEVICE_IDLE_TIMEOUT - idleTime);
+				result = std::min(result, (DWORD)rest.count());
+			}
+		}
+	}
+
+	if (expiredDevices[0] || expiredDevices[1]) {
+		Logger::Get().Info("已释放空闲的 D3D 设备");
+	}
+
+	return result;
+}
+
 bool DeviceResources::Initialize(bool isForeground) noexcept {
 #ifdef _DEBUG
 	UINT flag = DXGI_CREATE_FACTORY_DEBUG;
@@ -29,7 +229,7 @@ bool DeviceResources::Initialize(bool isForeground) noexcept {
 	}
 
 	_isTearingSupported = supportTearing;
-	Logger::Get().Info(fmt::format("可变刷新率支持: {}", supportTearing ? "是" : "否"));
+	Logger::Get().Info("可变刷新率支持: {}", supportTearing ? "是" : "否");
 
 	if (!_ObtainAdapterAndDevice(ScalingWindow::Get().Options().graphicsCardId, isForeground)) {
 		Logger::Get().Error("找不到可用的图形适配器");
@@ -184,6 +384,13 @@ bool DeviceResources::_TryCreateD3DDevice(const winrt::com_ptr<IDXGIAdapter1>& a
 	}
 #endif
 
+	_createDeviceFlags = createDeviceFlags;
+	_isForeground = isForeground;
+
+	if (_TryReusePooledDevice(adapter)) {
+		return true;
+	}
+
 	winrt::com_ptr<ID3D11Device> d3dDevice;
 	winrt::com_ptr<ID3D11DeviceContext> d3dDC;
 	D3D_FEATURE_LEVEL featureLevel;
@@ -217,7 +424,7 @@ bool DeviceResources::_TryCreateD3DDevice(const winrt::com_ptr<IDXGIAdapter1>& a
 		fl = "未知";
 		break;
 	}
-	Logger::Get().Info(fmt::format("已创建 D3D 设备\n\t功能级别: {}", fl));
+	Logger::Get().Info("已创建 D3D 设备\n\t功能级别: {}", fl);
 
 	_d3dDevice = d3dDevice.try_as<ID3D11Device5>();
 	if (!_d3dDevice) {
@@ -250,4 +457,50 @@ bool DeviceResources::_TryCreateD3DDevice(const winrt::com_ptr<IDXGIAdapter1>& a
 	return true;
 }
 
+bool DeviceResources::_TryReusePooledDevice(const winrt::com_ptr<IDXGIAdapter1>& adapter) noexcept {
+	std::optional<PooledDevice> pooledDevice;
+	{
+		DevicePool& pool = GetDevicePool();
+		auto lk = pool.lock.lock_exclusive();
+		pooledDevice = std::move(pool.devices[_isForeground]);
+		pool.devices[_isForeground].reset();
+	}
+
+	if (!pooledDevice) {
+		return false;
+	}
+
+	// 不满足重用条件的设备直接丢弃
+	const LUID adapterLuid = GetAdapterLuid(adapter.get());
+	if (pooledDevice->adapterLuid.LowPart != adapterLuid.LowPart
+		|| pooledDevice->adapterLuid.HighPart != adapterLuid.HighPart
+		|| pooledDevice->createDeviceFlags != _createDeviceFlags) {
+		return false;
+	}
+
+	// 显卡配置变化后旧的 DXGI 工厂不再可用
+	if (!pooledDevice->dxgiFactory->IsCurrent()) {
+		Logger::Get().Info("DXGI 工厂已过时，不再重用设备");
+		return false;
+	}
+
+	HRESULT hr = pooledDevice->d3dDevice->GetDeviceRemovedReason();
+	if (FAILED(hr)) {
+		Logger::Get().ComWarn("设备已丢失，不再重用", hr);
+		return false;
+	}
+
+	// 交换链等必须由设备所属的工厂创建
+	_dxgiFactory = std::move(pooledDevice->dxgiFactory);
+	_graphicsAdapter = std::move(pooledDevice->graphicsAdapter);
+	_d3dDevice = std::move(pooledDevice->d3dDevice);
+	_d3dDC = std::move(pooledDevice->d3dDC);
+	_textureCache = std::move(pooledDevice->textureCache);
+	_isFP16Supported = pooledDevice->isFP16Supported;
+
+	Logger::Get().Info("已重用 D3D 设备，缓存了 {} 个纹理 ({} KiB)",
+		_textureCache.Count(), _textureCache.Size() / 1024);
+	return true;
+}
+
 }
@@ -1,14 +1,52 @@
 #pragma once
 #include "ScalingOptions.h"
 #include <parallel_hashmap/phmap.h>
+#include <list>
 
 namespace Magpie {
 
+enum class TextureCacheScope {
+	// 设备重用时仍然保留，如效果的 //!SOURCE 纹理
+	Device,
+	// 缩放结束时丢弃，如光标纹理
+	Session
+};
+
+// 不可变纹理的缓存，以内容的哈希为键。总大小超过上限时淘汰最久未使用的纹理。
+// 缓存的纹理可能被多个对象共享，不能修改。
+class TextureCache {
+public:
+	ID3D11Texture2D* Get(uint64_t contentHash) noexcept;
+	void Put(uint64_t contentHash, ID3D11Texture2D* texture, TextureCacheScope scope) noexcept;
+
+	// 丢弃所有 TextureCacheScope::Session 的纹理
+	void ClearSessionEntries() noexcept;
+
+	uint32_t Count() const noexcept { return (uint32_t)_entries.size(); }
+	size_t Size() const noexcept { return _totalSize; }
+
+private:
+	struct _Entry {
+		uint64_t contentHash = 0;
+		winrt::com_ptr<ID3D11Texture2D> texture;
+		size_t size = 0;
+		TextureCacheScope scope = TextureCacheScope::Device;
+	};
+
+	void _Erase(std::list<_Entry>::iterator it) noexcept;
+
+	// 最近使用的在前
+	std::list<_Entry> _entries;
+	phmap::flat_hash_map<uint64_t, std::list<_Entry>::iterator> _index;
+	size_t _totalSize = 0;
+};
+
 class DeviceResources {
 public:
 	DeviceResources() = default;
 	DeviceResources(const DeviceResources&) = delete;
 	DeviceResources(DeviceResources&&) = default;
+	~DeviceResources() noexcept;
 
 	bool Initialize(bool isForeground) noexcept;
 
@@ -22,9 +60,23 @@ public:
 
 	ID3D11SamplerState* GetSampler(D3D11_FILTER filterMode, D3D11_TEXTURE_ADDRESS_MODE addressMode) noexcept;
 
+	// 设备会在多次缩放间重用，TextureCacheScope::Device 的纹理也随之保留，设备丢失时一并丢弃
+	ID3D11Texture2D* GetCachedTexture(uint64_t contentHash) noexcept {
+		return _textureCache.Get(contentHash);
+	}
+	void CacheTexture(uint64_t contentHash, ID3D11Texture2D* texture, TextureCacheScope scope) noexcept {
+		_textureCache.Put(contentHash, texture, scope);
+	}
+
+	// 释放所有为重用而保留的设备
+	static void ReleasePooledDevices() noexcept;
+	// 释放空闲超时的设备，返回距离下一个设备超时的毫秒数，没有保留的设备时返回 INFINITE
+	static DWORD ReleaseIdlePooledDevices() noexcept;
+
 private:
 	bool _ObtainAdapterAndDevice(GraphicsCardId graphicsCardId, bool isForeground) noexcept;
 	bool _TryCreateD3DDevice(const winrt::com_ptr<IDXGIAdapter1>& adapter, bool isForeground) noexcept;
+	bool _TryReusePooledDevice(const winrt::com_ptr<IDXGIAdapter1>& adapter) noexcept;
 
 	winrt::com_ptr<IDXGIFactory7> _dxgiFactory;
 	winrt::com_ptr<IDXGIAdapter4> _graphicsAdapter;
@@ -36,6 +88,11 @@ private:
 		winrt::com_ptr<ID3D11SamplerState>
 	> _samMap;
 
+	TextureCache _textureCache;
+
+	UINT _createDeviceFlags = 0;
+	bool _isForeground = false;
+
 	bool _isTearingSupported = false;
 	bool _isFP16Supported = false;
 };
@@ -12,7 +12,7 @@ bool DirectXHelper::CompileComputeShader(
 	ID3DBlob** blob,
 	const char* sourceName,
 	ID3DInclude* include,
-	const std::vector<std::pair<std::string, std::string>>& macros,
+	const D3D_SHADER_MACRO* macros,
 	bool warningsAreErrors
 ) {
 	winrt::com_ptr<ID3DBlob> errorMsgs = nullptr;
@@ -28,13 +28,7 @@ bool DirectXHelper::CompileComputeShader(
 	flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
 #endif
 
-	std::unique_ptr<D3D_SHADER_MACRO[]> mc(new D3D_SHADER_MACRO[macros.size() + 1]);
-	for (UINT i = 0; i < macros.size(); ++i) {
-		mc[i] = { macros[i].first.c_str(), macros[i].second.c_str() };
-	}
-	mc[macros.size()] = { nullptr,nullptr };
-
-	HRESULT hr = D3DCompile(hlsl.data(), hlsl.size(), sourceName, mc.get(), include,
+	HRESULT hr = D3DCompile(hlsl.data(), hlsl.size(), sourceName, macros, include,
 		entryPoint, "cs_5_0", flags, 0, blob, errorMsgs.put());
 	if (FAILED(hr)) {
 		if (errorMsgs) {
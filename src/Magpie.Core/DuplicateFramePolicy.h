@@ -0,0 +1,290 @@
+#pragma once
+#include "FrameTraceFormat.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace Magpie {
+
+// 检查重复帧的策略。比较和保存帧的操作由调用者提供，因此可以脱离 GPU 回放轨迹，见 tools/FrameSimulator。
+// 只由头文件实现，无需 Windows 也可以使用。
+//
+// 动态检测时学习源窗口内容变化的节奏，只在必要时检查：
+// 1. 用指数移动平均跟踪帧到达的间隔，以及两次内容变化的间隔和它的平均偏差。
+// 2. 内容几乎每帧都变化（如游戏）时预测每帧都是新帧，跳过检查。
+// 3. 内容周期性变化（如 144Hz 下播放 24fps 的视频）时预测下一次变化的时间，在此之前到达的帧
+//    预测为重复帧，不经检查便丢弃，只检查预期变化附近的帧。
+// 4. 其他情况检查每一帧。
+// 预测的帧每隔若干帧检查一次，确认预测正确则逐渐增加间隔，一旦预测错误便重新学习。
+// 未经检查便丢弃的帧最多连续 MAX_UNCHECKED_DROPS 个，因此预测错误时新内容最多推迟这么多帧显示。
+class DuplicateFramePolicy {
+public:
+	DuplicateFramePolicy() = default;
+
+	DuplicateFramePolicy(const DuplicateFramePolicy&) = delete;
+	DuplicateFramePolicy(DuplicateFramePolicy&&) = delete;
+
+	// alwaysCheck 为 true 时每一帧都检查，否则动态检测。collectStatistics 为 true 时
+	// 预测的帧也会比较，用于统计预测错误，但不影响行为
+	void Initialize(bool alwaysCheck, bool collectStatistics) noexcept {
+		_alwaysCheck = alwaysCheck;
+		_collectStatistics = collectStatistics;
+	}
+
+	// 已保存过上一帧时，每个新帧到达后调用，now 为到达的时间。isDuplicate() 比较此帧和保存的帧，
+	// savePrev() 保存此帧。返回 true 表示此帧应当丢弃。
+	template <typename IsDuplicateFn, typename SavePrevFn>
+	bool OnNewFrame(
+		std::chrono::nanoseconds now,
+		IsDuplicateFn&& isDuplicate,
+		SavePrevFn&& savePrev,
+		FrameTraceDecision& decision
+	) noexcept {
+		if (_alwaysCheck) {
+			// 总是检查重复帧
+			if (isDuplicate()) {
+				decision = FrameTraceDecision::Duplicate;
+				return true;
+			} else {
+				decision = FrameTraceDecision::New;
+				savePrev();
+				return false;
+			}
+		}
+
+		_UpdateArrivalInterval(now);
+		_hasUncheckedFrame = false;
+
+		const _Prediction prediction = _Predict(now);
+
+		if (prediction == _Prediction::Unknown || _predictedCount >= _verifyInterval ||
+			(prediction == _Prediction::Duplicate && _uncheckedDropCount >= MAX_UNCHECKED_DROPS)) {
+			_predictedCount = 0;
+			_uncheckedDropCount = 0;
+			if (prediction != _Prediction::Unknown) {
+				++_verifications.second;
+			}
+
+			if (isDuplicate()) {
+				decision = FrameTraceDecision::Duplicate;
+				if (prediction == _Prediction::New) {
+					++_verifications.first;
+					_Reset();
+				} else if (prediction == _Prediction::Duplicate) {
+					_OnVerified();
+				}
+				_isLastFrameSkipped = false;
+				return true;
+			} else {
+				decision = FrameTraceDecision::New;
+				if (prediction == _Prediction::Duplicate) {
+					// 可能是此帧或之前丢弃的帧变化了，无论哪种都是预测错误
+					++_verifications.first;
+					_Reset();
+				} else if (prediction == _Prediction::New) {
+					_OnVerified();
+				}
+				_OnContentChanged(now);
+				_isLastFrameSkipped = false;
+				savePrev();
+				return false;
+			}
+		}
+
+		++_predictedCount;
+
+		if (prediction == _Prediction::New) {
+			// 跳过检查，视为新帧
+			_isLastFrameSkipped = true;
+
+			if (_collectStatistics) {
+				if (isDuplicate()) {
+					decision = FrameTraceDecision::Mispredicted;
+					++_statistics.first;
+				} else {
+					savePrev();
+				}
+				++_statistics.second;
+			} else if (_predictedCount == _verifyInterval) {
+				// 下一帧将检查重复帧，需要保存此帧
+				savePrev();
+			}
+
+			return false;
+		} else {
+			// 预测为重复帧，不经检查便丢弃。保存的帧始终是最后渲染的帧，因此不保存此帧
+			decision = FrameTraceDecision::PredictedDuplicate;
+			_hasUncheckedFrame = true;
+			++_uncheckedDropCount;
+
+			if (_collectStatistics) {
+				if (!isDuplicate()) {
+					decision = FrameTraceDecision::MispredictedDuplicate;
+					++_statistics.first;
+				}
+				++_statistics.second;
+			}
+
+			return true;
+		}
+	}
+
+	// 没有新帧时调用。上一帧未经检查便被丢弃，而之后长时间没有新帧到达时检查它，以免内容在变化后
+	// 停止更新时错过最后一次变化。返回 true 表示它是新帧，应当渲染。
+	template <typename IsDuplicateFn, typename SavePrevFn>
+	bool OnIdle(
+		std::chrono::nanoseconds now,
+		IsDuplicateFn&& isDuplicate,
+		SavePrevFn&& savePrev,
+		FrameTraceDecision& decision
+	) noexcept {
+		if (!_hasUncheckedFrame || (double)(now - _lastArrivalTime).count() < 2 * _arrivalInterval) {
+			return false;
+		}
+
+		_hasUncheckedFrame = false;
+		_uncheckedDropCount = 0;
+		++_verifications.second;
+
+		if (isDuplicate()) {
+			decision = FrameTraceDecision::Duplicate;
+			return false;
+		}
+
+		// 预测错误
+		decision = FrameTraceDecision::New;
+		++_verifications.first;
+		_Reset();
+		_hasLastChange = false;
+		savePrev();
+		return true;
+	}
+
+	// (预测错误帧数, 总计预测帧数)，只在 collectStatistics 为 true 时统计
+	std::pair<uint32_t, uint32_t> Statistics() const noexcept {
+		return _statistics;
+	}
+
+	// (预测错误次数, 验证次数)。验证是对预测的帧的抽样检查，总是统计，因此不启用 collectStatistics
+	// 也可以估计预测错误的比例
+	std::pair<uint32_t, uint32_t> VerificationStatistics() const noexcept {
+		return _verifications;
+	}
+
+private:
+	enum class _Prediction {
+		// 需要检查
+		Unknown,
+		New,
+		Duplicate
+	};
+
+	// 平滑系数和 FramePacer 相同
+	static constexpr double MEAN_GAIN = 1.0 / 8;
+	static constexpr double DEVIATION_GAIN = 1.0 / 4;
+	// 学习到这么多次内容变化后才开始预测
+	static constexpr uint32_t MIN_CHANGE_SAMPLES = 8;
+	// 内容变化的间隔小于帧间隔的这么多倍时视为每帧都变化
+	static constexpr double CONTINUOUS_FACTOR = 1.25;
+	// 平均偏差超过变化间隔的这么多分之一时视为没有周期
+	static constexpr double PERIODIC_DEVIATION_RATIO = 4;
+	// 预期变化之前开始检查的时间为平均偏差的这么多倍再加上一个帧间隔
+	static constexpr double WINDOW_DEVIATION_FACTOR = 2;
+	// 连续预测的帧数上限，超过则检查一帧以验证预测
+	static constexpr uint16_t MAX_VERIFY_INTERVAL = 16;
+	// 连续不经检查便丢弃的帧数上限
+	static constexpr uint16_t MAX_UNCHECKED_DROPS = 1;
+
+	void _UpdateArrivalInterval(std::chrono::nanoseconds now) noexcept {
+		if (_hasLastArrival) {
+			const double sample = (double)(now - _lastArrivalTime).count();
+			_arrivalInterval = _arrivalInterval == 0 ? sample : _arrivalInterval + (sample - _arrivalInterval) * MEAN_GAIN;
+		}
+
+		_lastArrivalTime = now;
+		_hasLastArrival = true;
+	}
+
+	_Prediction _Predict(std::chrono::nanoseconds now) const noexcept {
+		if (_changeSampleCount < MIN_CHANGE_SAMPLES || _arrivalInterval <= 0) {
+			return _Prediction::Unknown;
+		}
+
+		if (_changeInterval < CONTINUOUS_FACTOR * _arrivalInterval) {
+			return _Prediction::New;
+		}
+
+		if (_changeDeviation * PERIODIC_DEVIATION_RATIO > _changeInterval) {
+			return _Prediction::Unknown;
+		}
+
+		// 预期的下一次变化之前留出余量，用于应对到达时间的波动
+		const double windowStart = (double)_lastChangeTime.count() + _changeInterval -
+			WINDOW_DEVIATION_FACTOR * _changeDeviation - _arrivalInterval;
+		return (double)now.count() < windowStart ? _Prediction::Duplicate : _Prediction::Unknown;
+	}
+
+	void _OnContentChanged(std::chrono::nanoseconds now) noexcept {
+		// 上一帧跳过了检查时内容可能在那时已经变化，无法得知准确的间隔
+		if (_hasLastChange && !_isLastFrameSkipped) {
+			const double sample = (double)(now - _lastChangeTime).count();
+			if (_changeSampleCount == 0) {
+				_changeInterval = sample;
+				_changeDeviation = sample / 2;
+			} else {
+				_changeDeviation += (std::abs(sample - _changeInterval) - _changeDeviation) * DEVIATION_GAIN;
+				_changeInterval += (sample - _changeInterval) * MEAN_GAIN;
+			}
+
+			if (_changeSampleCount < MIN_CHANGE_SAMPLES) {
+				++_changeSampleCount;
+			}
+		}
+
+		_lastChangeTime = now;
+		_hasLastChange = true;
+	}
+
+	void _OnVerified() noexcept {
+		if (_verifyInterval < MAX_VERIFY_INTERVAL) {
+			// 增加下一次连续预测的帧数
+			++_verifyInterval;
+		}
+	}
+
+	// 预测错误，重新学习
+	void _Reset() noexcept {
+		_changeSampleCount = 0;
+		_verifyInterval = 1;
+		_predictedCount = 0;
+	}
+
+	std::pair<uint32_t, uint32_t> _statistics;
+	std::pair<uint32_t, uint32_t> _verifications;
+
+	std::chrono::nanoseconds _lastArrivalTime{};
+	std::chrono::nanoseconds _lastChangeTime{};
+	// 以下单位均为纳秒
+	double _arrivalInterval = 0;
+	double _changeInterval = 0;
+	double _changeDeviation = 0;
+	uint32_t _changeSampleCount = 0;
+
+	// 距上一次检查连续预测的帧数
+	uint16_t _predictedCount = 0;
+	uint16_t _verifyInterval = 1;
+	// 上一次检查之后未经检查便丢弃的帧数
+	uint16_t _uncheckedDropCount = 0;
+
+	bool _hasLastArrival = false;
+	bool _hasLastChange = false;
+	bool _isLastFrameSkipped = false;
+	// 上一帧预测为重复帧而未经检查
+	bool _hasUncheckedFrame = false;
+
+	bool _alwaysCheck = false;
+	bool _collectStatistics = false;
+};
+
+}
@@ -143,7 +143,7 @@ bool EffectCacheManager::_LoadFromMemCache(const std::wstring& cacheFileName, st
 
 		desc = cacheItem.effectDesc;
 		cacheItem.lastAccess = ++_lastAccess;
-		Logger::Get().Info(StrHelper::Concat("已读取缓存 ", StrHelper::UTF16ToUTF8(cacheFileName)));
+		Logger::Get().Info("已读取缓存 {}", cacheFileName);
 		return true;
 	}
 	return false;
@@ -168,14 +168,15 @@ bool EffectCacheManager::Load(
 		return false;
 	}
 
-	std::vector<BYTE> buf;
-	if (!Win32Helper::ReadFile(cacheFileName.c_str(), buf) || buf.empty()) {
+	// 直接从映射中反序列化
+	MappedFile cacheFile;
+	if (!Win32Helper::MapFile(cacheFileName.c_str(), cacheFile) || cacheFile.Size() == 0) {
 		return false;
 	}
 
 	std::string cachedKey;
 	try {
-		yas::mem_istream mi(buf.data(), buf.size());
+		yas::mem_istream mi(cacheFile.Data().data(), cacheFile.Size());
 		yas::binary_iarchive<yas::mem_istream, yas::binary> ia(mi);
 
 		uint32_t cacheVersion;
@@ -200,7 +201,7 @@ bool EffectCacheManager::Load(
 
 	_AddToMemCache(cacheFileName, cachedKey, desc);
 
-	Logger::Get().Info(StrHelper::Concat("已读取缓存 ", StrHelper::UTF16ToUTF8(cacheFileName)));
+	Logger::Get().Info("已读取缓存 {}", cacheFileName);
 	return true;
 }
 
@@ -302,7 +303,7 @@ void EffectCacheManager::Save(
 
 	_AddToMemCache(cacheFileName, key, desc);
 
-	Logger::Get().Info(StrHelper::Concat("已保存缓存 ", StrHelper::UTF16ToUTF8(cacheFileName)));
+	Logger::Get().Info("已保存缓存 {}", cacheFileName);
 }
 
 uint64_t EffectCacheManager::GetHash(std::string_view key) {
@@ -7,6 +7,7 @@
 #include "EffectHelper.h"
 #include "Logger.h"
 #include "StrHelper.h"
+#include "ThreadPool.h"
 #include "Win32Helper.h"
 #include <bit>	// std::has_single_bit
 #include <bitset>
@@ -20,10 +21,10 @@ static const char* META_INDICATOR = "//!";
 
 class PassInclude : public ID3DInclude {
 public:
-	PassInclude(std::wstring_view localDir) : _localDir(localDir) {}
+	PassInclude(std::wstring_view localDir, EffectIncludeCache& cache) : _localDir(localDir), _cache(cache) {}
 
-	PassInclude(const PassInclude&) = default;
-	PassInclude(PassInclude&&) = default;
+	PassInclude(const PassInclude&) = delete;
+	PassInclude(PassInclude&&) = delete;
 
 	HRESULT CALLBACK Open(
 		D3D_INCLUDE_TYPE /*IncludeType*/,
@@ -34,29 +35,51 @@ public:
 	) noexcept override {
 		std::wstring relativePath = StrHelper::Concat(_localDir, StrHelper::UTF8ToUTF16(pFileName));
 
-		std::string file;
-		if (!Win32Helper::ReadTextFile(relativePath.c_str(), file)) {
+		std::string_view content;
+		if (!_cache.Get(relativePath, content)) {
 			return E_FAIL;
 		}
 
-		char* result = new char[file.size()];
-		std::memcpy(result, file.data(), file.size());
-
-		*ppData = result;
-		*pBytes = (UINT)file.size();
-
+		// 编译器可以处理 CRLF，也不要求以空字符结尾，因此直接使用映射的内容
+		*ppData = content.empty() ? "" : content.data();
+		*pBytes = (UINT)content.size();
 		return S_OK;
 	}
 
-	HRESULT CALLBACK Close(LPCVOID pData) noexcept override {
-		delete[](char*)pData;
+	HRESULT CALLBACK Close(LPCVOID /*pData*/) noexcept override {
+		// 内容由 EffectIncludeCache 管理
 		return S_OK;
 	}
 
 private:
 	std::wstring _localDir;
+	EffectIncludeCache& _cache;
 };
 
+bool EffectIncludeCache::Get(std::wstring_view path, std::string_view& content) noexcept {
+	// 如 effects\Anime4K\..\StubDefs.hlsli 和 effects\StubDefs.hlsli 是同一个文件
+	std::wstring normalizedPath = std::filesystem::path(path).lexically_normal().native();
+
+	{
+		auto lk = _lock.lock_shared();
+		if (auto it = _files.find(normalizedPath); it != _files.end()) {
+			content = it->second.Text();
+			return true;
+		}
+	}
+
+	auto lk = _lock.lock_exclusive();
+	// 可能已被其他线程读取
+	auto [it, inserted] = _files.try_emplace(std::move(normalizedPath));
+	if (inserted && !Win32Helper::MapFile(it->first.c_str(), it->second)) {
+		_files.erase(it);
+		return false;
+	}
+
+	content = it->second.Text();
+	return true;
+}
+
 static uint32_t RemoveComments(std::string& source) noexcept {
 	// 确保以换行符结尾
 	if (source.back() != '\n') {
@@ -1097,7 +1120,7 @@ static uint32_t ResolvePasses(SmallVector<std::string_view>& blocks, EffectDesc&
 				StrHelper::Trim(val);
 				passDesc.desc = val;
 			} else {
-				Logger::Get().Warn(fmt::format("解析通道 {} 时遇到未知指令: {}", i + 1, t));
+				Logger::Get().Warn("解析通道 {} 时遇到未知指令: {}", i + 1, t);
 			}
 		}
 
@@ -1124,79 +1147,37 @@ static uint32_t ResolvePasses(SmallVector<std::string_view>& blocks, EffectDesc&
 	return 0;
 }
 
-static uint32_t GeneratePassSource(
+// 所有通道共用的代码和宏，每个效果只生成一次。通道的源码由 declarations、通道的纹理和采样器声明、
+// functions、通道的代码和入口依次组成
+struct PassPrelude {
+	// 常量缓冲区
+	std::string declarations;
+	// 内置函数和 COMMON 块
+	std::string functions;
+	// 和通道无关的内置宏
+	std::vector<std::pair<std::string, std::string>> macros;
+};
+
+static void GeneratePassPrelude(
 	const EffectDesc& desc,
-	uint32_t passIdx,
-	std::string_view cbHlsl,
+	std::string&& cbHlsl,
 	const SmallVector<std::string_view>& commonBlocks,
-	std::string_view passBlock,
-	std::string& result,
-	std::vector<std::pair<std::string, std::string>>& macros
+	PassPrelude& prelude
 ) noexcept {
-	const EffectPassDesc& passDesc = desc.passes[(size_t)passIdx - 1];
-
-	{
-		// 估算需要的空间
-		size_t reservedSize = 2048 + cbHlsl.size() + passBlock.size();
-		for (std::string_view commonBlock : commonBlocks) {
-			reservedSize += commonBlock.size();
-		}
-
-		result.reserve(reservedSize);
-	}
-
 	// 常量缓冲区
-	result.append(cbHlsl);
+	prelude.declarations = std::move(cbHlsl);
 
 	if (desc.flags & EffectFlags::UseDynamic) {
-		result.append("cbuffer __CB2 : register(b1) { uint __frameCount; };\n\n");
-	}
-
-	////////////////////////////////////////////////////////////////////////////////////////////////////////
-	//
-	// SRV、UAV 和采样器
-	// 
-	////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	// SRV
-	for (uint32_t i = 0, end = (uint32_t)passDesc.inputs.size(); i < end; ++i) {
-		auto& texDesc = desc.textures[passDesc.inputs[i]];
-		result.append(fmt::format("Texture2D<{}> {} : register(t{});\n",
-			EffectHelper::FORMAT_DESCS[(uint32_t)texDesc.format].srvTexelType, texDesc.name, i));
-	}
-
-	// UAV
-	for (uint32_t i = 0, end = (uint32_t)passDesc.outputs.size(); i < end; ++i) {
-		auto& texDesc = desc.textures[passDesc.outputs[i]];
-		result.append(fmt::format("RWTexture2D<{}> {} : register(u{});\n",
-			EffectHelper::FORMAT_DESCS[(uint32_t)texDesc.format].uavTexelType, texDesc.name, i));
-	}
-
-
-	if (!desc.samplers.empty()) {
-		// 采样器
-		for (uint32_t i = 0, end = (uint32_t)desc.samplers.size(); i < end; ++i) {
-			result.append(fmt::format("SamplerState {} : register(s{});\n", desc.samplers[i].name, i));
-		}
+		prelude.declarations.append("cbuffer __CB2 : register(b1) { uint __frameCount; };\n\n");
 	}
 
-	result.push_back('\n');
-
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//
 	// 内置宏
 	// 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
+	std::vector<std::pair<std::string, std::string>>& macros = prelude.macros;
 	macros.reserve(64);
-	macros.emplace_back("MP_BLOCK_WIDTH", std::to_string(passDesc.blockSize.first));
-	macros.emplace_back("MP_BLOCK_HEIGHT", std::to_string(passDesc.blockSize.second));
-	macros.emplace_back("MP_NUM_THREADS_X", std::to_string(passDesc.numThreads[0]));
-	macros.emplace_back("MP_NUM_THREADS_Y", std::to_string(passDesc.numThreads[1]));
-	macros.emplace_back("MP_NUM_THREADS_Z", std::to_string(passDesc.numThreads[2]));
-
-	if (passDesc.flags & EffectPassFlags::PSStyle) {
-		macros.emplace_back("MP_PS_STYLE", "");
-	}
 
 	if (desc.flags & EffectFlags::InlineParams) {
 		macros.emplace_back("MP_INLINE_PARAMS", "");
@@ -1236,6 +1217,18 @@ static uint32_t GeneratePassSource(
 	// 内置函数
 	// 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
+	std::string& result = prelude.functions;
+
+	{
+		// 估算需要的空间
+		size_t reservedSize = 4096;
+		for (std::string_view commonBlock : commonBlocks) {
+			reservedSize += commonBlock.size() + 1;
+		}
+
+		result.reserve(reservedSize);
+	}
+
 	result.append(R"(uint __Bfe(uint src, uint off, uint bits) { uint mask = (1u << bits) - 1; return (src >> off) & mask; }
 uint __BfiM(uint src, uint ins, uint bits) { uint mask = (1u << bits) - 1; return (ins & mask) | (src & (~mask)); }
 uint2 Rmp8x8(uint a) { return uint2(__Bfe(a, 1u, 3u), __BfiM(__Bfe(a, 3u, 3u), a, 1u)); }
@@ -1331,6 +1324,71 @@ MF4 MulAdd(MF4 x, MF4x4 y, MF4 a) {
 		result.append(commonBlock);
 		result.push_back('\n');
 	}
+}
+
+static uint32_t GeneratePassSource(
+	const EffectDesc& desc,
+	uint32_t passIdx,
+	const PassPrelude& prelude,
+	std::string_view passBlock,
+	std::string& result,
+	std::vector<std::pair<std::string, std::string>>& macros
+) noexcept {
+	const EffectPassDesc& passDesc = desc.passes[(size_t)passIdx - 1];
+
+	// 估算需要的空间
+	result.reserve(2048 + prelude.declarations.size() + prelude.functions.size() + passBlock.size());
+
+	result.append(prelude.declarations);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//
+	// SRV、UAV 和采样器
+	// 
+	////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	// SRV
+	for (uint32_t i = 0, end = (uint32_t)passDesc.inputs.size(); i < end; ++i) {
+		auto& texDesc = desc.textures[passDesc.inputs[i]];
+		result.append(fmt::format("Texture2D<{}> {} : register(t{});\n",
+			EffectHelper::FORMAT_DESCS[(uint32_t)texDesc.format].srvTexelType, texDesc.name, i));
+	}
+
+	// UAV
+	for (uint32_t i = 0, end = (uint32_t)passDesc.outputs.size(); i < end; ++i) {
+		auto& texDesc = desc.textures[passDesc.outputs[i]];
+		result.append(fmt::format("RWTexture2D<{}> {} : register(u{});\n",
+			EffectHelper::FORMAT_DESCS[(uint32_t)texDesc.format].uavTexelType, texDesc.name, i));
+	}
+
+
+	if (!desc.samplers.empty()) {
+		// 采样器
+		for (uint32_t i = 0, end = (uint32_t)desc.samplers.size(); i < end; ++i) {
+			result.append(fmt::format("SamplerState {} : register(s{});\n", desc.samplers[i].name, i));
+		}
+	}
+
+	result.push_back('\n');
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//
+	// 内置宏
+	// 
+	////////////////////////////////////////////////////////////////////////////////////////////////////////
+	macros.reserve(8);
+	macros.emplace_back("MP_BLOCK_WIDTH", std::to_string(passDesc.blockSize.first));
+	macros.emplace_back("MP_BLOCK_HEIGHT", std::to_string(passDesc.blockSize.second));
+	macros.emplace_back("MP_NUM_THREADS_X", std::to_string(passDesc.numThreads[0]));
+	macros.emplace_back("MP_NUM_THREADS_Y", std::to_string(passDesc.numThreads[1]));
+	macros.emplace_back("MP_NUM_THREADS_Z", std::to_string(passDesc.numThreads[2]));
+
+	if (passDesc.flags & EffectPassFlags::PSStyle) {
+		macros.emplace_back("MP_PS_STYLE", "");
+	}
+
+	// 内置函数和 COMMON 块
+	result.append(prelude.functions);
 
 	result.append(passBlock);
 	if (result.back() == '\n') {
@@ -1463,7 +1521,8 @@ static uint32_t CompilePasses(
 	uint32_t flags,
 	const SmallVector<std::string_view>& commonBlocks,
 	const SmallVector<std::string_view>& passBlocks,
-	const phmap::flat_hash_map<std::string, float>* inlineParams
+	const phmap::flat_hash_map<std::string, float>* inlineParams,
+	EffectIncludeCache* includeCache
 ) noexcept {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//
@@ -1546,17 +1605,29 @@ static uint32_t CompilePasses(
 		}
 	}
 
+	PassPrelude prelude;
+	GeneratePassPrelude(desc, std::move(cbHlsl), commonBlocks, prelude);
+
+	// 没有指定缓存时只在通道间共用包含文件
+	std::optional<EffectIncludeCache> localIncludeCache;
+	if (!includeCache) {
+		includeCache = &localIncludeCache.emplace();
+	}
+
 	size_t delimPos = desc.name.find_last_of('\\');
 	PassInclude passInclude(delimPos == std::string::npos 
 		? L"effects\\"
-		: L"effects\\" + StrHelper::UTF8ToUTF16(std::string_view(desc.name.c_str(), delimPos + 1)));
+		: L"effects\\" + StrHelper::UTF8ToUTF16(std::string_view(desc.name.c_str(), delimPos + 1)), *includeCache);
 
-	// 并行生成代码和编译
-	Win32Helper::RunParallel([&](uint32_t id) {
+	// 并行生成代码和编译，任何通道失败时取消尚未开始的通道。可能在编译效果的任务中执行，
+	// 此时通道和其他效果共用线程池
+	TaskGroup passGroup(TaskPriority::Interactive);
+	ThreadPool::Get().ParallelFor(passGroup, (uint32_t)passBlocks.size(), 1, [&](uint32_t id) {
 		std::string source;
-		std::vector<std::pair<std::string, std::string>> macros;
-		if (GeneratePassSource(desc, id + 1, cbHlsl, commonBlocks, passBlocks[id], source, macros)) {
-			Logger::Get().Error(fmt::format("生成 Pass{} 失败", id + 1));
+		std::vector<std::pair<std::string, std::string>> passMacros;
+		if (GeneratePassSource(desc, id + 1, prelude, passBlocks[id], source, passMacros)) {
+			Logger::Get().Error("生成 Pass{} 失败", id + 1);
+			passGroup.Cancel();
 			return;
 		}
 
@@ -1566,16 +1637,28 @@ static uint32_t CompilePasses(
 				: fmt::format(L"{}_Pass{}.hlsl", sourcesPathName, id + 1);
 
 			if (!Win32Helper::WriteTextFile(fileName.c_str(), source)) {
-				Logger::Get().Error(fmt::format("保存 Pass{} 源码失败", id + 1));
+				Logger::Get().Error("保存 Pass{} 源码失败", id + 1);
 			}
 		}
 
+		// 共用的宏无需复制，只需引用
+		SmallVector<D3D_SHADER_MACRO> macros;
+		macros.reserve(passMacros.size() + prelude.macros.size() + 1);
+		for (const auto& [name, definition] : passMacros) {
+			macros.push_back({ name.c_str(), definition.c_str() });
+		}
+		for (const auto& [name, definition] : prelude.macros) {
+			macros.push_back({ name.c_str(), definition.c_str() });
+		}
+		macros.push_back({ nullptr, nullptr });
+
 		if (!DirectXHelper::CompileComputeShader(source, "__M", desc.passes[id].cso.put(),
-			fmt::format("{}_Pass{}.hlsl", desc.name, id + 1).c_str(), &passInclude, macros, flags & EffectCompilerFlags::WarningsAreErrors)
+			fmt::format("{}_Pass{}.hlsl", desc.name, id + 1).c_str(), &passInclude, macros.data(), flags & EffectCompilerFlags::WarningsAreErrors)
 		) {
-			Logger::Get().Error(fmt::format("编译 Pass{} 失败", id + 1));
+			Logger::Get().Error("编译 Pass{} 失败", id + 1);
+			passGroup.Cancel();
 		}
-	}, (uint32_t)passBlocks.size());
+	});
 
 	// 检查编译结果
 	for (const EffectPassDesc& d : desc.passes) {
@@ -1602,7 +1685,8 @@ static std::string ReadEffectSource(const std::wstring& effectName) noexcept {
 uint32_t EffectCompiler::Compile(
 	EffectDesc& desc,
 	uint32_t flags,
-	const phmap::flat_hash_map<std::string, float>* inlineParams
+	const phmap::flat_hash_map<std::string, float>* inlineParams,
+	EffectIncludeCache* includeCache
 ) noexcept {
 	bool noCompile = flags & EffectCompilerFlags::NoCompile;
 	bool noCache = noCompile || (flags & EffectCompilerFlags::NoCache);
@@ -1759,7 +1843,7 @@ uint32_t EffectCompiler::Compile(
 	desc.params.clear();
 	for (size_t i = 0; i < paramBlocks.size(); ++i) {
 		if (ResolveParameter(paramBlocks[i], desc)) {
-			Logger::Get().Error(fmt::format("解析 Parameter#{} 块失败", i + 1));
+			Logger::Get().Error("解析 Parameter#{} 块失败", i + 1);
 			return 1;
 		}
 	}
@@ -1782,7 +1866,7 @@ uint32_t EffectCompiler::Compile(
 
 	for (size_t i = 0; i < textureBlocks.size(); ++i) {
 		if (ResolveTexture(textureBlocks[i], desc)) {
-			Logger::Get().Error(fmt::format("解析 Texture#{} 块失败", i + 1));
+			Logger::Get().Error("解析 Texture#{} 块失败", i + 1);
 			return 1;
 		}
 	}
@@ -1791,7 +1875,7 @@ uint32_t EffectCompiler::Compile(
 		desc.samplers.clear();
 		for (size_t i = 0; i < samplerBlocks.size(); ++i) {
 			if (ResolveSampler(samplerBlocks[i], desc)) {
-				Logger::Get().Error(fmt::format("解析 Sampler#{} 块失败", i + 1));
+				Logger::Get().Error("解析 Sampler#{} 块失败", i + 1);
 				return 1;
 			}
 		}
@@ -1826,7 +1910,7 @@ uint32_t EffectCompiler::Compile(
 	if (!noCompile) {
 		for (size_t i = 0; i < commonBlocks.size(); ++i) {
 			if (ResolveCommon(commonBlocks[i])) {
-				Logger::Get().Error(fmt::format("解析 Common#{} 块失败", i + 1));
+				Logger::Get().Error("解析 Common#{} 块失败", i + 1);
 				return 1;
 			}
 		}
@@ -1837,7 +1921,7 @@ uint32_t EffectCompiler::Compile(
 			return 1;
 		}
 
-		if (CompilePasses(desc, flags, commonBlocks, passBlocks, inlineParams)) {
+		if (CompilePasses(desc, flags, commonBlocks, passBlocks, inlineParams, includeCache)) {
 			Logger::Get().Error("编译着色器失败");
 			return 1;
 		}
@@ -15,11 +15,27 @@
 namespace Magpie {
 
 EffectDrawer::~EffectDrawer() {
-	// [0] 为输入，由前一个 EffectDrawer 管理
-	const uint32_t textureCount = (uint32_t)_textures.size();
-	for (uint32_t i = 1; i < textureCount; ++i) {
-		_descriptorStore->RemoveCache(_textures[i].get());
+	_RemoveTexturesFromCache();
+}
+
+EffectDrawer& EffectDrawer::operator=(EffectDrawer&& other) noexcept {
+	if (this == &other) {
+		return *this;
 	}
+
+	_RemoveTexturesFromCache();
+
+	_d3dDC = other._d3dDC;
+	_descriptorStore = other._descriptorStore;
+	_samplers = std::move(other._samplers);
+	_textures = std::move(other._textures);
+	_srvs = std::move(other._srvs);
+	_uavs = std::move(other._uavs);
+	_constantBuffer = std::move(other._constantBuffer);
+	_shaders = std::move(other._shaders);
+	_dispatches = std::move(other._dispatches);
+
+	return *this;
 }
 
 bool EffectDrawer::Initialize(
@@ -54,7 +70,7 @@ bool EffectDrawer::Initialize(
 		);
 
 		if (!_samplers[i]) {
-			Logger::Get().Error(fmt::format("创建采样器 {} 失败", samDesc.name));
+			Logger::Get().Error("创建采样器 {} 失败", samDesc.name);
 			return false;
 		}
 	}
@@ -89,9 +105,9 @@ bool EffectDrawer::Initialize(
 				? StrHelper::Concat("effects\\", texDesc.source)
 				: StrHelper::Concat("effects\\", std::string_view(desc.name.c_str(), delimPos + 1), texDesc.source);
 			_textures[i] = TextureHelper::LoadTexture(
-				StrHelper::UTF8ToUTF16(texPath).c_str(), deviceResources.GetD3DDevice());
+				StrHelper::UTF8ToUTF16(texPath).c_str(), deviceResources);
 			if (!_textures[i]) {
-				Logger::Get().Error(fmt::format("加载纹理 {} 失败", texDesc.source));
+				Logger::Get().Error("加载纹理 {} 失败", texDesc.source);
 				return false;
 			}
 
@@ -112,7 +128,7 @@ bool EffectDrawer::Initialize(
 				_exprParser.SetExpr(texDesc.sizeExpr.second);
 				texSize.cy = std::lround(_exprParser.Eval());
 			} catch (const mu::ParserError& e) {
-				Logger::Get().Error(fmt::format("计算中间纹理尺寸 {} 失败: {}", e.GetExpr(), e.GetMsg()));
+				Logger::Get().Error("计算中间纹理尺寸 {} 失败: {}", e.GetExpr(), e.GetMsg());
 				return false;
 			}
 
@@ -249,7 +265,7 @@ bool EffectDrawer::ResizeTextures(
 			_exprParser.SetExpr(sizeExpr.second);
 			texSize.cy = std::lround(_exprParser.Eval());
 		} catch (const mu::ParserError& e) {
-			Logger::Get().Error(fmt::format("计算中间纹理尺寸 {} 失败: {}", e.GetExpr(), e.GetMsg()));
+			Logger::Get().Error("计算中间纹理尺寸 {} 失败: {}", e.GetExpr(), e.GetMsg());
 			return false;
 		}
 
@@ -297,6 +313,25 @@ bool EffectDrawer::ResizeTextures(
 	return true;
 }
 
+bool EffectDrawer::ReplaceInputTexture(const EffectDesc& desc, ID3D11Texture2D* inputTexture) noexcept {
+	_textures[0].copy_from(inputTexture);
+
+	if (!_UpdatePassResources(desc)) {
+		Logger::Get().Error("_UpdatePassResources 失败");
+		return false;
+	}
+
+	return true;
+}
+
+void EffectDrawer::_RemoveTexturesFromCache() noexcept {
+	// [0] 为输入，由前一个 EffectDrawer 管理
+	const uint32_t textureCount = (uint32_t)_textures.size();
+	for (uint32_t i = 1; i < textureCount; ++i) {
+		_descriptorStore->RemoveCache(_textures[i].get());
+	}
+}
+
 SIZE EffectDrawer::_CalcOutputSize(
 	const EffectDesc& desc,
 	const EffectOption& option,
@@ -363,7 +398,7 @@ SIZE EffectDrawer::_CalcOutputSize(
 			_exprParser.SetExpr(outputSizeExpr.second);
 			outputSize.cy = std::lround(_exprParser.Eval());
 		} catch (const mu::ParserError& e) {
-			Logger::Get().Error(fmt::format("计算输出尺寸 {} 失败: {}", e.GetExpr(), e.GetMsg()));
+			Logger::Get().Error("计算输出尺寸 {} 失败: {}", e.GetExpr(), e.GetMsg());
 			return {};
 		}
 	}
@@ -479,7 +514,7 @@ bool EffectDrawer::_UpdateConstants(
 					value = it->second;
 
 					if (value < constant.minValue || value > constant.maxValue) {
-						Logger::Get().Error(fmt::format("参数 {} 的值非法", paramDesc.name));
+						Logger::Get().Error("参数 {} 的值非法", paramDesc.name);
 						return false;
 					}
 				}
@@ -25,6 +25,8 @@ public:
 
 	~EffectDrawer();
 
+	EffectDrawer& operator=(EffectDrawer&& other) noexcept;
+
 	bool Initialize(
 		const EffectDesc& desc,
 		const EffectOption& option,
@@ -44,6 +46,9 @@ public:
 		ID3D11Texture2D** inOutTexture
 	) noexcept;
 
+	// 前一个 EffectDrawer 被替换后调用，新输入的尺寸和格式必须和原来相同
+	bool ReplaceInputTexture(const EffectDesc& desc, ID3D11Texture2D* inputTexture) noexcept;
+
 	ID3D11Texture2D* GetOutputTexture() const noexcept {
 		return _textures[1].get();
 	}
@@ -53,6 +58,8 @@ public:
 	}
 
 private:
+	void _RemoveTexturesFromCache() noexcept;
+
 	SIZE _CalcOutputSize(
 		const EffectDesc& desc,
 		const EffectOption& option,
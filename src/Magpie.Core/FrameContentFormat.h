@@ -0,0 +1,215 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Magpie {
+
+struct FrameContentHeader {
+	uint32_t magic = 0;
+	uint16_t version = 0;
+	uint16_t tileSize = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+// 帧内容文件格式。和帧轨迹文件同名，扩展名为 .mpfc，保存录制期间显示的每一帧，供 ReplayFrameSource 回放。
+// 像素格式为 BGRA8，帧被分为 tileSize x tileSize 的块，每帧只保存和上一帧相比发生变化的块，
+// 第一帧保存所有块。所有字段均为小端序，保留字段为 0。只由头文件实现，无需 Windows 也可以使用。
+//
+// 文件头：magic(4) version(2) tileSize(2) width(4) height(4) 保留(16)
+// 帧：    arrivalTime(8) tileCount(4) 保留(4)，之后是 tileCount 个块
+// 块：    tileX(2) tileY(2) 像素，逐行紧密排列，右侧和底部的块被裁剪到帧的边界
+//
+// arrivalTime 和帧轨迹文件中对应记录的 arrivalTime 相同。
+struct FrameContentFormat {
+	// "MPFC"
+	static constexpr uint32_t MAGIC = 0x4346504D;
+	static constexpr uint16_t VERSION = 1;
+
+	static constexpr size_t HEADER_SIZE = 32;
+	static constexpr size_t FRAME_HEADER_SIZE = 16;
+	static constexpr size_t TILE_HEADER_SIZE = 4;
+
+	static constexpr uint16_t DEFAULT_TILE_SIZE = 64;
+	// 限制尺寸使块坐标可以用 16 位保存，也防止损坏的文件导致分配过多内存
+	static constexpr uint32_t MAX_SIZE = 16384;
+
+	static void WriteHeader(const FrameContentHeader& header, uint8_t* data) noexcept {
+		_Store(data, MAGIC);
+		_Store(data + 4, VERSION);
+		_Store(data + 6, header.tileSize);
+		_Store(data + 8, header.width);
+		_Store(data + 12, header.height);
+		// 保留字段
+		_Store(data + 16, uint64_t(0));
+		_Store(data + 24, uint64_t(0));
+	}
+
+	// 文件过小、magic 不匹配、版本不受支持或尺寸无效时返回 false
+	static bool ReadHeader(const uint8_t* data, size_t size, FrameContentHeader& header) noexcept {
+		if (size < HEADER_SIZE) {
+			return false;
+		}
+
+		header.magic = _Load<uint32_t>(data);
+		header.version = _Load<uint16_t>(data + 4);
+		if (header.magic != MAGIC || header.version == 0 || header.version > VERSION) {
+			return false;
+		}
+
+		header.tileSize = _Load<uint16_t>(data + 6);
+		header.width = _Load<uint32_t>(data + 8);
+		header.height = _Load<uint32_t>(data + 12);
+		return header.tileSize != 0 && header.width != 0 && header.height != 0 &&
+			header.width <= MAX_SIZE && header.height <= MAX_SIZE;
+	}
+
+	// 将 frame 中和 prevFrame 不同的块编码为一帧追加到 result 末尾，prevFrame 为空时编码所有块。
+	// 两帧都是紧密排列的 BGRA8 像素，尺寸由 header 指定。返回编码的块数
+	static uint32_t EncodeFrame(
+		const FrameContentHeader& header,
+		uint64_t arrivalTime,
+		const uint8_t* frame,
+		const uint8_t* prevFrame,
+		std::vector<uint8_t>& result
+	) {
+		const size_t frameOffset = result.size();
+		result.resize(frameOffset + FRAME_HEADER_SIZE);
+
+		const size_t pitch = (size_t)header.width * 4;
+		uint32_t tileCount = 0;
+
+		for (uint32_t y = 0; y < header.height; y += header.tileSize) {
+			const uint32_t tileHeight = _TileExtent(y, header.tileSize, header.height);
+
+			for (uint32_t x = 0; x < header.width; x += header.tileSize) {
+				const size_t rowSize = (size_t)_TileExtent(x, header.tileSize, header.width) * 4;
+				const size_t tileOffset = y * pitch + (size_t)x * 4;
+
+				if (prevFrame) {
+					bool isChanged = false;
+					for (uint32_t i = 0; i < tileHeight; ++i) {
+						const size_t offset = tileOffset + i * pitch;
+						if (std::memcmp(frame + offset, prevFrame + offset, rowSize) != 0) {
+							isChanged = true;
+							break;
+						}
+					}
+
+					if (!isChanged) {
+						continue;
+					}
+				}
+
+				size_t pos = result.size();
+				result.resize(pos + TILE_HEADER_SIZE + rowSize * tileHeight);
+				_Store(result.data() + pos, uint16_t(x / header.tileSize));
+				_Store(result.data() + pos + 2, uint16_t(y / header.tileSize));
+				pos += TILE_HEADER_SIZE;
+
+				for (uint32_t i = 0; i < tileHeight; ++i) {
+					std::memcpy(result.data() + pos, frame + tileOffset + i * pitch, rowSize);
+					pos += rowSize;
+				}
+
+				++tileCount;
+			}
+		}
+
+		uint8_t* frameHeader = result.data() + frameOffset;
+		_Store(frameHeader, arrivalTime);
+		_Store(frameHeader + 8, tileCount);
+		// 保留字段
+		_Store(frameHeader + 12, uint32_t(0));
+
+		return tileCount;
+	}
+
+	// 读取 data 开头的帧的到达时间，数据不完整时返回 false
+	static bool PeekArrivalTime(const uint8_t* data, size_t size, uint64_t& arrivalTime) noexcept {
+		if (size < FRAME_HEADER_SIZE) {
+			return false;
+		}
+
+		arrivalTime = _Load<uint64_t>(data);
+		return true;
+	}
+
+	// 解码 data 开头的帧，将其中的块写入 frame。每写入一个块便调用 onTile(left, top, width, height)，
+	// 单位为像素，可用于只上传变化的部分。返回这一帧占用的字节数，数据不完整或无效时返回 0，
+	// 此时 frame 可能已被部分修改。
+	template <typename OnTileFn>
+	static size_t DecodeFrame(
+		const FrameContentHeader& header,
+		const uint8_t* data,
+		size_t size,
+		uint8_t* frame,
+		OnTileFn&& onTile
+	) noexcept {
+		if (size < FRAME_HEADER_SIZE) {
+			return 0;
+		}
+
+		const uint32_t tileCount = _Load<uint32_t>(data + 8);
+		const uint32_t tileCountX = (header.width + header.tileSize - 1) / header.tileSize;
+		const uint32_t tileCountY = (header.height + header.tileSize - 1) / header.tileSize;
+		const size_t pitch = (size_t)header.width * 4;
+
+		size_t pos = FRAME_HEADER_SIZE;
+		for (uint32_t i = 0; i < tileCount; ++i) {
+			if (size - pos < TILE_HEADER_SIZE) {
+				return 0;
+			}
+
+			const uint32_t tileX = _Load<uint16_t>(data + pos);
+			const uint32_t tileY = _Load<uint16_t>(data + pos + 2);
+			if (tileX >= tileCountX || tileY >= tileCountY) {
+				return 0;
+			}
+			pos += TILE_HEADER_SIZE;
+
+			const uint32_t left = tileX * header.tileSize;
+			const uint32_t top = tileY * header.tileSize;
+			const uint32_t tileWidth = _TileExtent(left, header.tileSize, header.width);
+			const uint32_t tileHeight = _TileExtent(top, header.tileSize, header.height);
+			const size_t rowSize = (size_t)tileWidth * 4;
+			if (size - pos < rowSize * tileHeight) {
+				return 0;
+			}
+
+			for (uint32_t j = 0; j < tileHeight; ++j) {
+				std::memcpy(frame + (top + j) * pitch + (size_t)left * 4, data + pos, rowSize);
+				pos += rowSize;
+			}
+
+			onTile(left, top, tileWidth, tileHeight);
+		}
+
+		return pos;
+	}
+
+private:
+	static uint32_t _TileExtent(uint32_t start, uint32_t tileSize, uint32_t size) noexcept {
+		return size - start < tileSize ? size - start : tileSize;
+	}
+
+	template <typename T>
+	static void _Store(uint8_t* data, T value) noexcept {
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			data[i] = uint8_t(value >> (i * 8));
+		}
+	}
+
+	template <typename T>
+	static T _Load(const uint8_t* data) noexcept {
+		T value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			value |= T(data[i]) << (i * 8);
+		}
+		return value;
+	}
+};
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace Magpie {
+
+// 即时渲染（just-in-time）的时序模型。根据最近几帧捕获和渲染的耗时预测下一帧的耗时，推迟开始
+// 工作的时间使渲染恰好在下一次合成前完成，从而缩短从捕获到显示的延迟。
+// 不调用任何系统 API，时间均为 steady_clock 纪元以来的时长，因此可以用模拟的时钟驱动。
+// 只由头文件实现，tools/FrameSimulator 无需 Windows 也可以使用。
+class FramePacer {
+public:
+	FramePacer() = default;
+
+	FramePacer(const FramePacer&) = delete;
+	FramePacer(FramePacer&&) = delete;
+
+	// safetyMargin 为完成工作到合成之间预留的时间，用于前端呈现和线程调度
+	void Initialize(std::chrono::nanoseconds safetyMargin) noexcept {
+		_safetyMargin = safetyMargin;
+		_mean = 0;
+		_deviation = 0;
+		_sampleCount = 0;
+		_composeTime = {};
+		_refreshPeriod = {};
+	}
+
+	// 记录一帧从开始捕获到渲染完成的耗时
+	void AddSample(std::chrono::nanoseconds workTime) noexcept {
+		const double sample = (double)workTime.count();
+
+		if (_sampleCount == 0) {
+			_mean = sample;
+			_deviation = sample / 2;
+		} else {
+			// 错过合成的代价是整整一个刷新间隔，因此超出预测时立即提高均值，回落时则缓慢收敛
+			const bool exceeded = sample > _mean + DEVIATION_FACTOR * _deviation;
+
+			_deviation += (std::abs(sample - _mean) - _deviation) * DEVIATION_GAIN;
+			_mean = exceeded ? sample : _mean + (sample - _mean) * MEAN_GAIN;
+		}
+
+		if (_sampleCount < MIN_SAMPLE_COUNT) {
+			++_sampleCount;
+		}
+	}
+
+	// composeTime 为任意一次合成的时间，之后的合成以 refreshPeriod 为间隔
+	void SetCompositionTiming(std::chrono::nanoseconds composeTime, std::chrono::nanoseconds refreshPeriod) noexcept {
+		_composeTime = composeTime;
+		_refreshPeriod = refreshPeriod;
+	}
+
+	// 下一帧应开始工作的时间，不早于 now。信息不足或预测的耗时超过刷新间隔时返回 now
+	std::chrono::nanoseconds NextWorkStart(std::chrono::nanoseconds now) const noexcept {
+		if (!IsReady()) {
+			return now;
+		}
+
+		const std::chrono::nanoseconds budget = PredictedWorkTime() + _safetyMargin;
+		if (budget >= _refreshPeriod) {
+			// 一个刷新间隔内无法完成，推迟只会增加延迟
+			return now;
+		}
+
+		// 某次合成对应的最晚开始时间，将它移到 now 之后的第一个刷新间隔内。这个时间之前开始的工作
+		// 赶得上同一次合成，之后开始的只能赶上下一次合成。
+		std::chrono::nanoseconds offset = (_composeTime - budget - now) % _refreshPeriod;
+		if (offset.count() < 0) {
+			offset += _refreshPeriod;
+		}
+
+		return now + offset;
+	}
+
+	// 预测的耗时，包括应对波动的余量
+	std::chrono::nanoseconds PredictedWorkTime() const noexcept {
+		return std::chrono::nanoseconds(std::llround(_mean + DEVIATION_FACTOR * _deviation));
+	}
+
+	bool IsReady() const noexcept {
+		return _sampleCount >= MIN_SAMPLE_COUNT && _refreshPeriod.count() > 0;
+	}
+
+private:
+	// 均值和平均偏差的平滑系数，和 RFC 6298 相同
+	static constexpr double MEAN_GAIN = 1.0 / 8;
+	static constexpr double DEVIATION_GAIN = 1.0 / 4;
+	// 预测值为均值加上若干倍平均偏差
+	static constexpr double DEVIATION_FACTOR = 4;
+	// 样本太少时预测不可靠，此时不推迟工作
+	static constexpr uint32_t MIN_SAMPLE_COUNT = 8;
+
+	// 和 TCP 估计往返时间的方法相同 (RFC 6298)，分别用指数移动平均跟踪耗时的均值和平均偏差
+	double _mean = 0;
+	double _deviation = 0;
+	uint32_t _sampleCount = 0;
+
+	std::chrono::nanoseconds _safetyMargin{};
+	std::chrono::nanoseconds _composeTime{};
+	std::chrono::nanoseconds _refreshPeriod{};
+};
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace Magpie {
+
+// 帧签名的 CPU 实现，和 shaders/DuplicateFrameCS.hlsl 的计算方法相同，用于验证着色器和哈希的碰撞特性。
+// 只由头文件实现，无需 Windows 也可以使用。
+//
+// 帧被分为 32x32 的块，每个块的签名是块内每个像素的 64 位哈希之和（两个 32 位分量分别求和）。
+// 像素的哈希由位置和 RGB 分量的位模式依次经过 MurmurHash3 的 fmix32 得到，fmix32 是双射，
+// 因此只有一个像素变化时签名必定变化；多个像素同时变化时发生碰撞的概率约为 2^-64。
+// 比较签名代替比较整个纹理，无需保存上一帧的副本，比较结果也给出了发生变化的块。
+struct FrameSignature {
+	static constexpr uint32_t TILE_SIZE = 32;
+
+	static constexpr uint32_t Mix(uint32_t x) noexcept {
+		x ^= x >> 16;
+		x *= 0x85ebca6bu;
+		x ^= x >> 13;
+		x *= 0xc2b2ae35u;
+		x ^= x >> 16;
+		return x;
+	}
+
+	// 返回值的低 32 位和高 32 位分别对应着色器中的两个分量
+	static constexpr uint64_t HashTexel(uint32_t x, uint32_t y, uint32_t r, uint32_t g, uint32_t b) noexcept {
+		const uint32_t pos = x | (y << 16);
+		uint32_t h0 = 0x9e3779b9u ^ pos;
+		uint32_t h1 = 0x7f4a7c15u ^ pos;
+		h0 = Mix(h0 ^ r);
+		h1 = Mix(h1 ^ r);
+		h0 = Mix(h0 ^ g);
+		h1 = Mix(h1 ^ g);
+		h0 = Mix(h0 ^ b);
+		h1 = Mix(h1 ^ b);
+		return h0 | ((uint64_t)h1 << 32);
+	}
+
+	// 两个分量分别以 2^32 为模相加
+	static constexpr uint64_t Combine(uint64_t a, uint64_t b) noexcept {
+		const uint32_t lo = (uint32_t)a + (uint32_t)b;
+		const uint32_t hi = (uint32_t)(a >> 32) + (uint32_t)(b >> 32);
+		return lo | ((uint64_t)hi << 32);
+	}
+
+	static constexpr uint32_t TileCount(uint32_t size) noexcept {
+		return (size + TILE_SIZE - 1) / TILE_SIZE;
+	}
+
+	// rgba 为按行排列的像素，每个像素四个 float，和着色器读取到的值相同。签名按行排列
+	static void Compute(const float* rgba, uint32_t width, uint32_t height, std::vector<uint64_t>& signatures) noexcept {
+		const uint32_t tileCountX = TileCount(width);
+		signatures.assign((size_t)tileCountX * TileCount(height), 0);
+
+		for (uint32_t y = 0; y < height; ++y) {
+			uint64_t* tileRow = signatures.data() + (size_t)(y / TILE_SIZE) * tileCountX;
+			const float* row = rgba + (size_t)y * width * 4;
+			for (uint32_t x = 0; x < width; ++x) {
+				const float* pixel = row + (size_t)x * 4;
+				uint64_t& signature = tileRow[x / TILE_SIZE];
+				signature = Combine(signature, HashTexel(x, y,
+					std::bit_cast<uint32_t>(pixel[0]),
+					std::bit_cast<uint32_t>(pixel[1]),
+					std::bit_cast<uint32_t>(pixel[2])
+				));
+			}
+		}
+	}
+};
+
+}
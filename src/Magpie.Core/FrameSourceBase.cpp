@@ -1,8 +1,11 @@
 #include "pch.h"
 #include "FrameSourceBase.h"
 #include "BackendDescriptorStore.h"
+#include "CommonSharedConstants.h"
 #include "DeviceResources.h"
 #include "DirectXHelper.h"
+#include "FrameSignature.h"
+#include "FrameTraceRecorder.h"
 #include "Logger.h"
 #include "ScalingOptions.h"
 #include "ScalingWindow.h"
@@ -12,16 +15,15 @@
 
 namespace Magpie {
 
-static constexpr uint16_t INITIAL_CHECK_COUNT = 16;
-static constexpr uint16_t INITIAL_SKIP_COUNT = 1;
-static constexpr uint16_t MAX_SKIP_COUNT = 16;
-
-FrameSourceBase::FrameSourceBase() noexcept :
-	_nextSkipCount(INITIAL_SKIP_COUNT), _framesLeft(INITIAL_CHECK_COUNT) {}
-
 FrameSourceBase::~FrameSourceBase() noexcept {
 	const HWND hwndSrc = ScalingWindow::Get().SrcTracker().Handle();
 
+	if (_dupFrameCS &&
+		ScalingWindow::Get().Options().duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Dynamic) {
+		const auto [mispredicted, verified] = _duplicateFramePolicy.VerificationStatistics();
+		Logger::Get().Info("动态检测共验证 {} 次，预测错误 {} 次", verified, mispredicted);
+	}
+
 	// 还原窗口圆角
 	if (_roundCornerDisabled) {
 		_roundCornerDisabled = false;
@@ -53,108 +55,196 @@ bool FrameSourceBase::Initialize(DeviceResources& deviceResources, BackendDescri
 		return false;
 	}
 
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	_duplicateFramePolicy.Initialize(
+		options.duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Always,
+		options.IsStatisticsForDynamicDetectionEnabled()
+	);
+
+	if (options.IsFrameTraceRecordingEnabled()) {
+		if (!_InitFrameTraceRecorder()) {
+			// 录制失败不影响缩放
+			Logger::Get().Error("_InitFrameTraceRecorder 失败");
+			_traceRecorder.reset();
+		}
+	}
+
 	return true;
 }
 
 FrameSourceState FrameSourceBase::Update() noexcept {
 	const FrameSourceState state = _Update();
+	if (state == FrameSourceState::Waiting) {
+		const FrameSourceState result = _CheckForUncheckedFrame();
+		if (result == FrameSourceState::NewFrame && _traceRecorder) {
+			// 显示的是之前未经检查便丢弃的帧，它的记录已经写入
+			_RecordFrameContent();
+		}
+		return result;
+	}
+	if (state != FrameSourceState::NewFrame) {
+		return state;
+	}
+
+	_isSignatureUpToDate = false;
+
+	if (!_traceRecorder) {
+		FrameTraceDecision decision;
+		return _CheckForDuplicateFrame(decision);
+	}
+
+	const auto arrivalTime = std::chrono::steady_clock::now();
+	FrameTraceDecision decision = FrameTraceDecision::NotChecked;
+	FrameSourceState result;
+	const uint32_t checkDuration = Measure([&]() {
+		result = _CheckForDuplicateFrame(decision);
+	});
+	// 预测的帧只在统计时比较，此时的用时不代表检查的开销
+	const bool isPredicted = decision == FrameTraceDecision::NotChecked ||
+		decision == FrameTraceDecision::Mispredicted ||
+		decision == FrameTraceDecision::PredictedDuplicate ||
+		decision == FrameTraceDecision::MispredictedDuplicate;
+	_traceRecorder->Record(arrivalTime, decision, isPredicted ? 0 : checkDuration);
+	_lastArrivalTime = arrivalTime;
+
+	if (result == FrameSourceState::NewFrame) {
+		_RecordFrameContent();
+	}
+
+	return result;
+}
+
+FrameSourceState FrameSourceBase::_CheckForDuplicateFrame(FrameTraceDecision& decision) noexcept {
+	decision = FrameTraceDecision::NotChecked;
 
 	const ScalingOptions& options = ScalingWindow::Get().Options();
 	const auto duplicateFrameDetectionMode = options.duplicateFrameDetectionMode;
-	if (state != FrameSourceState::NewFrame || options.Is3DGameMode() ||
-		duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Never) {
-		return state;
+	if (options.Is3DGameMode() || duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Never) {
+		return FrameSourceState::NewFrame;
 	}
 
-	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
-
-	if (!_prevFrame) {
+	if (!_dupFrameCS) {
 		if (_InitCheckingForDuplicateFrame()) {
-			d3dDC->CopyResource(_prevFrame.get(), _output.get());
+			_SavePrevFrame();
 		} else {
 			Logger::Get().Error("_InitCheckingForDuplicateFrame 失败");
-			_prevFrame = nullptr;
-			_prevFrameSrv = nullptr;
+			_dupFrameCS = nullptr;
 		}
 
 		return FrameSourceState::NewFrame;
 	}
 
-	if (duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Always) {
-		// 总是检查重复帧
-		if (_IsDuplicateFrame()) {
-			return FrameSourceState::Waiting;
-		} else {
-			d3dDC->CopyResource(_prevFrame.get(), _output.get());
-			return FrameSourceState::NewFrame;
-		}
-	}
+	const bool isDuplicate = _duplicateFramePolicy.OnNewFrame(
+		std::chrono::steady_clock::now().time_since_epoch(),
+		[this]() { return _IsDuplicateFrame(); },
+		[this]() { _SavePrevFrame(); },
+		decision
+	);
 
-	///////////////////////////////////////////////
-	//
-	// 动态检查重复帧，见 #787
-	//
-	///////////////////////////////////////////////
+	_UpdateStatistics();
 
-	const bool isStatisticsEnabled = options.IsStatisticsForDynamicDetectionEnabled();
+	return isDuplicate ? FrameSourceState::Waiting : FrameSourceState::NewFrame;
+}
 
-	if (_isCheckingForDuplicateFrame) {
-		if (--_framesLeft == 0) {
-			_isCheckingForDuplicateFrame = false;
-			_framesLeft = _nextSkipCount;
-			if (_nextSkipCount < MAX_SKIP_COUNT) {
-				// 增加下一次连续跳过检查的帧数
-				++_nextSkipCount;
-			}
-		}
+FrameSourceState FrameSourceBase::_CheckForUncheckedFrame() noexcept {
+	if (!_dupFrameCS) {
+		return FrameSourceState::Waiting;
+	}
 
-		if (_IsDuplicateFrame()) {
-			_isCheckingForDuplicateFrame = true;
-			_framesLeft = INITIAL_CHECK_COUNT;
-			_nextSkipCount = INITIAL_SKIP_COUNT;
-			return FrameSourceState::Waiting;
-		} else {
-			if (_isCheckingForDuplicateFrame || isStatisticsEnabled) {
-				d3dDC->CopyResource(_prevFrame.get(), _output.get());
-			}
-			return FrameSourceState::NewFrame;
-		}
-	} else {
-		if (--_framesLeft == 0) {
-			_isCheckingForDuplicateFrame = true;
-			// 第 2 次连续检查 10 帧，之后逐渐减少，从第 16 次开始只连续检查 2 帧
-			_framesLeft = uint32_t((-4 * (int)_nextSkipCount + 78) / 7);
-			
-			if (!isStatisticsEnabled) {
-				// 下一帧将检查重复帧，需要复制此帧
-				d3dDC->CopyResource(_prevFrame.get(), _output.get());
-			}
-		}
+	FrameTraceDecision decision;
+	const bool isNewFrame = _duplicateFramePolicy.OnIdle(
+		std::chrono::steady_clock::now().time_since_epoch(),
+		[this]() { return _IsDuplicateFrame(); },
+		[this]() { _SavePrevFrame(); },
+		decision
+	);
 
-		if (isStatisticsEnabled) {
-			const bool isDuplicate = _IsDuplicateFrame();
-			if (!isDuplicate) {
-				d3dDC->CopyResource(_prevFrame.get(), _output.get());
-			}
-
-			std::pair<uint32_t, uint32_t> statistics = _statistics.load(std::memory_order_relaxed);
-			if (isDuplicate) {
-				// 预测错误
-				++statistics.first;
-			}
-			// 总帧数
-			++statistics.second;
-			_statistics.store(statistics, std::memory_order_relaxed);
-		}
+	_UpdateStatistics();
 
-		return FrameSourceState::NewFrame;
-	}
+	return isNewFrame ? FrameSourceState::NewFrame : FrameSourceState::Waiting;
+}
+
+void FrameSourceBase::_UpdateStatistics() noexcept {
+	// 不启用统计时以抽样验证的结果估计预测错误的比例，它不需要额外比较
+	_statistics.store(ScalingWindow::Get().Options().IsStatisticsForDynamicDetectionEnabled()
+		? _duplicateFramePolicy.Statistics() : _duplicateFramePolicy.VerificationStatistics(),
+		std::memory_order_relaxed);
 }
 
 std::pair<uint32_t, uint32_t> FrameSourceBase::GetStatisticsForDynamicDetection() const noexcept {
 	return _statistics.load(std::memory_order_relaxed);
 }
 
+bool FrameSourceBase::_InitFrameTraceRecorder() noexcept {
+	if (!Win32Helper::CreateDir(CommonSharedConstants::TRACES_DIR)) {
+		Logger::Get().Error("CreateDir 失败");
+		return false;
+	}
+
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+
+	D3D11_TEXTURE2D_DESC td;
+	_output->GetDesc(&td);
+
+	const FrameTraceHeader header{
+		.captureMethod = (uint16_t)options.captureMethod,
+		.width = td.Width,
+		.height = td.Height,
+		.duplicateFrameDetectionMode = (uint32_t)options.duplicateFrameDetectionMode,
+		.minFrameRate = options.minFrameRate,
+		.maxFrameRate = options.maxFrameRate.value_or(0.0f)
+	};
+
+	SYSTEMTIME st;
+	GetLocalTime(&st);
+	const std::wstring fileName = fmt::format(
+		L"{}\\Magpie_{:04}{:02}{:02}_{:02}{:02}{:02}.mpft",
+		CommonSharedConstants::TRACES_DIR,
+		st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond
+	);
+
+	_traceRecorder = std::make_unique<FrameTraceRecorder>();
+	if (!_traceRecorder->Initialize(fileName, header, options.IsFrameContentRecordingEnabled())) {
+		return false;
+	}
+
+	if (options.IsFrameContentRecordingEnabled()) {
+		td.Usage = D3D11_USAGE_STAGING;
+		td.BindFlags = 0;
+		td.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		td.MiscFlags = 0;
+
+		HRESULT hr = _deviceResources->GetD3DDevice()->CreateTexture2D(&td, nullptr, _contentStagingTexture.put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateTexture2D 失败", hr);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FrameSourceBase::_RecordFrameContent() noexcept {
+	if (!_contentStagingTexture || !_traceRecorder->IsRecordingContent()) {
+		return;
+	}
+
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+	d3dDC->CopyResource(_contentStagingTexture.get(), _output.get());
+
+	// 等待 GPU 完成复制，录制帧内容只用于诊断，可以接受这个开销。编码和写入在写入线程中进行
+	D3D11_MAPPED_SUBRESOURCE ms;
+	HRESULT hr = d3dDC->Map(_contentStagingTexture.get(), 0, D3D11_MAP_READ, 0, &ms);
+	if (FAILED(hr)) {
+		Logger::Get().ComError("Map 失败", hr);
+		return;
+	}
+
+	_traceRecorder->RecordContent(_lastArrivalTime, (const uint8_t*)ms.pData, ms.RowPitch);
+
+	d3dDC->Unmap(_contentStagingTexture.get(), 0);
+}
+
 void FrameSourceBase::_DisableRoundCornerInWin11() noexcept {
 	if (Win32Helper::GetOSVersion().IsWin10()) {
 		return;
@@ -251,25 +341,38 @@ bool FrameSourceBase::_InitCheckingForDuplicateFrame() {
 	D3D11_TEXTURE2D_DESC td;
 	_output->GetDesc(&td);
 
-	_prevFrame = DirectXHelper::CreateTexture2D(
-		d3dDevice, td.Format, td.Width, td.Height, D3D11_BIND_SHADER_RESOURCE);
-	if (!_prevFrame) {
-		return false;
-	}
+	_dispatchCount.first = FrameSignature::TileCount(td.Width);
+	_dispatchCount.second = FrameSignature::TileCount(td.Height);
 
-	HRESULT hr = d3dDevice->CreateShaderResourceView(_prevFrame.get(), nullptr, _prevFrameSrv.put());
-	if (FAILED(hr)) {
-		Logger::Get().ComError("CreateShaderResourceView 失败", hr);
-		return false;
+	// 每个块的签名占两个 uint
+	const uint32_t signatureElementCount = _dispatchCount.first * _dispatchCount.second * 2;
+	D3D11_BUFFER_DESC bd{
+		.ByteWidth = signatureElementCount * 4,
+		.Usage = D3D11_USAGE_DEFAULT,
+		.BindFlags = D3D11_BIND_UNORDERED_ACCESS
+	};
+	for (uint32_t i = 0; i < 2; ++i) {
+		HRESULT hr = d3dDevice->CreateBuffer(&bd, nullptr, _signatureBuffers[i].put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateBuffer 失败", hr);
+			return false;
+		}
+
+		_signatureBufferUavs[i] = _descriptorStore->GetUnorderedAccessView(
+			_signatureBuffers[i].get(), signatureElementCount, DXGI_FORMAT_R32_UINT);
+		if (!_signatureBufferUavs[i]) {
+			Logger::Get().Error("GetUnorderedAccessView 失败");
+			return false;
+		}
 	}
 
-	D3D11_BUFFER_DESC bd{
+	bd = {
 		.ByteWidth = 4,
 		.Usage = D3D11_USAGE_DEFAULT,
 		.BindFlags = D3D11_BIND_UNORDERED_ACCESS,
 		.StructureByteStride = 4
 	};
-	hr = d3dDevice->CreateBuffer(&bd, nullptr, _resultBuffer.put());
+	HRESULT hr = d3dDevice->CreateBuffer(&bd, nullptr, _resultBuffer.put());
 	if (FAILED(hr)) {
 		Logger::Get().ComError("CreateBuffer 失败", hr);
 		return false;
@@ -297,35 +400,40 @@ bool FrameSourceBase::_InitCheckingForDuplicateFrame() {
 		Logger::Get().ComError("CreateComputeShader 失败", hr);
 		return false;
 	}
-
-	static constexpr std::pair<uint32_t, uint32_t> BLOCK_SIZE{ 16, 16 };
-	_dispatchCount.first = (td.Width + BLOCK_SIZE.first - 1) / BLOCK_SIZE.first;
-	_dispatchCount.second = (td.Height + BLOCK_SIZE.second - 1) / BLOCK_SIZE.second;
 	
 	return true;
 }
 
-bool FrameSourceBase::_IsDuplicateFrame() {
-	// 检查是否和前一帧相同
+void FrameSourceBase::_ComputeSignature() noexcept {
+	// 计算当前帧的签名并和保存的签名比较，结果为签名变化的块数
 	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
 
-	ID3D11ShaderResourceView* srvs[]{ _outputSrv, _prevFrameSrv.get() };
-	d3dDC->CSSetShaderResources(0, 2, srvs);
-
-	ID3D11SamplerState* sam = _deviceResources->GetSampler(
-		D3D11_FILTER_MIN_MAG_MIP_POINT, D3D11_TEXTURE_ADDRESS_CLAMP);
-	d3dDC->CSSetSamplers(0, 1, &sam);
+	d3dDC->CSSetShaderResources(0, 1, &_outputSrv);
 
-	// 将缓冲区置零
+	// 将结果置零
 	static constexpr UINT ZERO[4]{};
 	d3dDC->ClearUnorderedAccessViewUint(_resultBufferUav, ZERO);
-	d3dDC->CSSetUnorderedAccessViews(0, 1, &_resultBufferUav, nullptr);
+
+	ID3D11UnorderedAccessView* uavs[]{
+		_resultBufferUav,
+		_signatureBufferUavs[_curSignatureIdx],
+		_signatureBufferUavs[_curSignatureIdx ^ 1]
+	};
+	d3dDC->CSSetUnorderedAccessViews(0, (UINT)std::size(uavs), uavs, nullptr);
 
 	d3dDC->CSSetShader(_dupFrameCS.get(), nullptr, 0);
 
 	d3dDC->Dispatch(_dispatchCount.first, _dispatchCount.second, 1);
 
+	_isSignatureUpToDate = true;
+}
+
+bool FrameSourceBase::_IsDuplicateFrame() {
+	// 检查是否和前一帧相同
+	_ComputeSignature();
+
 	// 取回结果
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
 	d3dDC->CopyResource(_readBackBuffer.get(), _resultBuffer.get());
 
 	uint32_t result = 1;
@@ -338,4 +446,14 @@ bool FrameSourceBase::_IsDuplicateFrame() {
 	return result == 0;
 }
 
+void FrameSourceBase::_SavePrevFrame() noexcept {
+	// 只需保存签名，交换两个缓冲区即可
+	if (!_isSignatureUpToDate) {
+		_ComputeSignature();
+	}
+
+	_curSignatureIdx ^= 1;
+	_isSignatureUpToDate = false;
+}
+
 }
@@ -1,9 +1,11 @@
 #pragma once
+#include "DuplicateFramePolicy.h"
 
 namespace Magpie {
 
 class DeviceResources;
 class BackendDescriptorStore;
+class FrameTraceRecorder;
 
 enum class FrameSourceWaitType {
 	NoWait,
@@ -19,7 +21,7 @@ enum class FrameSourceState {
 
 class FrameSourceBase {
 public:
-	FrameSourceBase() noexcept;
+	FrameSourceBase() noexcept = default;
 
 	virtual ~FrameSourceBase() noexcept;
 
@@ -73,20 +75,45 @@ protected:
 	std::pair<uint32_t, uint32_t> _dispatchCount;
 
 private:
+	FrameSourceState _CheckForDuplicateFrame(FrameTraceDecision& decision) noexcept;
+
+	// 动态检测未经检查便丢弃的帧之后长时间没有新帧时检查它，见 DuplicateFramePolicy::OnIdle
+	FrameSourceState _CheckForUncheckedFrame() noexcept;
+
+	bool _InitFrameTraceRecorder() noexcept;
+
+	// 将当前帧交给 _traceRecorder 录制，只在录制帧内容时有效
+	void _RecordFrameContent() noexcept;
+
 	bool _InitCheckingForDuplicateFrame();
 
+	void _ComputeSignature() noexcept;
+
 	bool _IsDuplicateFrame();
 
-	// (预测错误帧数, 总计跳过帧数)
+	void _SavePrevFrame() noexcept;
+
+	void _UpdateStatistics() noexcept;
+
+	// 启用统计时为 (预测错误帧数, 总计预测帧数)，否则为 (预测错误次数, 验证次数)
 	std::atomic<std::pair<uint32_t, uint32_t>> _statistics;
 
-	// 用于检查重复帧
-	winrt::com_ptr<ID3D11Texture2D> _prevFrame;
-	winrt::com_ptr<ID3D11ShaderResourceView> _prevFrameSrv;
-	uint16_t _nextSkipCount;
-	uint16_t _framesLeft;
-	
-	bool _isCheckingForDuplicateFrame = true;
+	// 用于检查重复帧。比较每个块的签名而不是整个纹理，见 FrameSignature.h。
+	// _curSignatureIdx 指向当前帧的签名，另一个缓冲区保存上一帧的签名
+	winrt::com_ptr<ID3D11Buffer> _signatureBuffers[2];
+	ID3D11UnorderedAccessView* _signatureBufferUavs[2]{};
+	uint32_t _curSignatureIdx = 0;
+	// 当前帧的签名是否已经计算
+	bool _isSignatureUpToDate = false;
+
+	DuplicateFramePolicy _duplicateFramePolicy;
+
+	// 录制帧轨迹时使用
+	std::unique_ptr<FrameTraceRecorder> _traceRecorder;
+	// 最后一条记录的到达时间，录制的帧内容以此和记录对应
+	std::chrono::steady_clock::time_point _lastArrivalTime;
+	// 录制帧内容时用于读取当前帧
+	winrt::com_ptr<ID3D11Texture2D> _contentStagingTexture;
 
 protected:
 	bool _roundCornerDisabled = false;
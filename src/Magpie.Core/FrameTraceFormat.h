@@ -0,0 +1,127 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace Magpie {
+
+enum class FrameTraceDecision : uint8_t {
+	// 未检查重复帧
+	NotChecked,
+	// 检查后确认为新帧
+	New,
+	// 检查后确认为重复帧，此帧被丢弃
+	Duplicate,
+	// 动态检测跳过了检查，但统计发现这是重复帧，即预测错误
+	Mispredicted,
+	// 动态检测预测为重复帧，未经检查便丢弃。版本 2 新增
+	PredictedDuplicate,
+	// 动态检测预测为重复帧而丢弃，但统计发现这是新帧。版本 2 新增
+	MispredictedDuplicate
+};
+
+struct FrameTraceHeader {
+	uint32_t magic = 0;
+	uint16_t version = 0;
+	uint16_t captureMethod = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t duplicateFrameDetectionMode = 0;
+	float minFrameRate = 0.0f;
+	// 0 表示不限制
+	float maxFrameRate = 0.0f;
+};
+
+struct FrameTraceRecord {
+	// 新帧到达的时间，自开始录制起算，单位为纳秒
+	uint64_t arrivalTime = 0;
+	// 检查重复帧的用时，单位为微秒
+	uint32_t checkDuration = 0;
+	FrameTraceDecision decision = FrameTraceDecision::NotChecked;
+};
+
+// 帧轨迹文件格式。文件由一个 32 字节的文件头和紧随其后的若干 16 字节的记录组成，所有字段均为
+// 小端序，保留字段为 0。读写都逐字节进行，不依赖结构体布局和平台字节序，可在任何平台上使用。
+//
+// 文件头：magic(4) version(2) captureMethod(2) width(4) height(4) duplicateFrameDetectionMode(4)
+//         minFrameRate(4) maxFrameRate(4) 保留(4)
+// 记录：  arrivalTime(8) checkDuration(4) decision(1) 保留(3)
+struct FrameTraceFormat {
+	// "MPFT"
+	static constexpr uint32_t MAGIC = 0x5446504D;
+	static constexpr uint16_t VERSION = 2;
+
+	static constexpr size_t HEADER_SIZE = 32;
+	static constexpr size_t RECORD_SIZE = 16;
+
+	static void WriteHeader(const FrameTraceHeader& header, uint8_t* data) noexcept {
+		_Store(data, MAGIC);
+		_Store(data + 4, VERSION);
+		_Store(data + 6, header.captureMethod);
+		_Store(data + 8, header.width);
+		_Store(data + 12, header.height);
+		_Store(data + 16, header.duplicateFrameDetectionMode);
+		_Store(data + 20, std::bit_cast<uint32_t>(header.minFrameRate));
+		_Store(data + 24, std::bit_cast<uint32_t>(header.maxFrameRate));
+		// 保留字段
+		_Store(data + 28, uint32_t(0));
+	}
+
+	// 文件过小、magic 不匹配或版本不受支持时返回 false
+	static bool ReadHeader(const uint8_t* data, size_t size, FrameTraceHeader& header) noexcept {
+		if (size < HEADER_SIZE) {
+			return false;
+		}
+
+		header.magic = _Load<uint32_t>(data);
+		header.version = _Load<uint16_t>(data + 4);
+		if (header.magic != MAGIC || header.version == 0 || header.version > VERSION) {
+			return false;
+		}
+
+		header.captureMethod = _Load<uint16_t>(data + 6);
+		header.width = _Load<uint32_t>(data + 8);
+		header.height = _Load<uint32_t>(data + 12);
+		header.duplicateFrameDetectionMode = _Load<uint32_t>(data + 16);
+		header.minFrameRate = std::bit_cast<float>(_Load<uint32_t>(data + 20));
+		header.maxFrameRate = std::bit_cast<float>(_Load<uint32_t>(data + 24));
+		return true;
+	}
+
+	static void WriteRecord(const FrameTraceRecord& record, uint8_t* data) noexcept {
+		_Store(data, record.arrivalTime);
+		_Store(data + 8, record.checkDuration);
+		// 低位字节是 decision，其余三个字节为保留字段
+		_Store(data + 12, uint32_t(record.decision));
+	}
+
+	static void ReadRecord(const uint8_t* data, FrameTraceRecord& record) noexcept {
+		record.arrivalTime = _Load<uint64_t>(data);
+		record.checkDuration = _Load<uint32_t>(data + 8);
+		record.decision = (FrameTraceDecision)data[12];
+	}
+
+	// 文件中完整记录的数量，被截断的最后一条记录不计入
+	static size_t GetRecordCount(size_t fileSize) noexcept {
+		return fileSize < HEADER_SIZE ? 0 : (fileSize - HEADER_SIZE) / RECORD_SIZE;
+	}
+
+private:
+	template <typename T>
+	static void _Store(uint8_t* data, T value) noexcept {
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			data[i] = uint8_t(value >> (i * 8));
+		}
+	}
+
+	template <typename T>
+	static T _Load(const uint8_t* data) noexcept {
+		T value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			value |= T(data[i]) << (i * 8);
+		}
+		return value;
+	}
+};
+
+}
@@ -0,0 +1,273 @@
+#include "pch.h"
+#include "FrameTraceRecorder.h"
+#include "Logger.h"
+#include "StrHelper.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+// 等待写入的记录数达到此值时唤醒写入线程
+static constexpr uint32_t WAKE_THRESHOLD = 256;
+// 等待写入的记录数上限，约 1MB
+static constexpr uint32_t MAX_PENDING_RECORDS = 64 * 1024;
+// 即使没有达到 WAKE_THRESHOLD，写入线程也会定期写入
+static constexpr DWORD WRITE_INTERVAL_MS = 1000;
+// 帧缓冲区的数量上限，包括写入线程保存的上一帧。4K 下约 130MB
+static constexpr uint32_t MAX_FRAME_BUFFERS = 4;
+
+FrameTraceRecorder::~FrameTraceRecorder() noexcept {
+	if (!_writerThread.joinable()) {
+		return;
+	}
+
+	{
+		auto lk = _pendingLock.lock_exclusive();
+		_isStopping = true;
+	}
+	_hWakeEvent.SetEvent();
+	_writerThread.join();
+
+	if (const uint32_t droppedCount = _droppedCount.load(std::memory_order_relaxed)) {
+		Logger::Get().Warn("帧轨迹录制丢弃了 {} 条记录", droppedCount);
+	}
+	if (const uint32_t droppedFrameCount = _droppedFrameCount.load(std::memory_order_relaxed)) {
+		Logger::Get().Warn("帧内容录制丢弃了 {} 帧", droppedFrameCount);
+	}
+}
+
+bool FrameTraceRecorder::Initialize(
+	const std::wstring& fileName,
+	const FrameTraceHeader& header,
+	bool recordContent
+) noexcept {
+	CREATEFILE2_EXTENDED_PARAMETERS extendedParams{
+		.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS),
+		.dwFileAttributes = FILE_ATTRIBUTE_NORMAL,
+		.dwFileFlags = FILE_FLAG_SEQUENTIAL_SCAN
+	};
+
+	_hFile.reset(CreateFile2(fileName.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, &extendedParams));
+	if (!_hFile) {
+		Logger::Get().Win32Error("CreateFile2 失败");
+		return false;
+	}
+
+	uint8_t headerData[FrameTraceFormat::HEADER_SIZE];
+	FrameTraceFormat::WriteHeader(header, headerData);
+
+	DWORD written;
+	if (!WriteFile(_hFile.get(), headerData, (DWORD)std::size(headerData), &written, nullptr)
+		|| written != std::size(headerData)) {
+		Logger::Get().Win32Error("写入帧轨迹文件头失败");
+		return false;
+	}
+
+	if (recordContent) {
+		const std::wstring contentFileName = std::filesystem::path(fileName).replace_extension(L".mpfc").native();
+		_hContentFile.reset(CreateFile2(contentFileName.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, &extendedParams));
+		if (!_hContentFile) {
+			Logger::Get().Win32Error("CreateFile2 失败");
+			return false;
+		}
+
+		_contentHeader = {
+			.tileSize = FrameContentFormat::DEFAULT_TILE_SIZE,
+			.width = header.width,
+			.height = header.height
+		};
+
+		uint8_t contentHeaderData[FrameContentFormat::HEADER_SIZE];
+		FrameContentFormat::WriteHeader(_contentHeader, contentHeaderData);
+
+		if (!WriteFile(_hContentFile.get(), contentHeaderData, (DWORD)std::size(contentHeaderData), &written, nullptr)
+			|| written != std::size(contentHeaderData)) {
+			Logger::Get().Win32Error("写入帧内容文件头失败");
+			return false;
+		}
+	}
+
+	if (!_hWakeEvent.try_create(wil::EventOptions::None, nullptr)) {
+		Logger::Get().Win32Error("CreateEvent 失败");
+		return false;
+	}
+
+	_pendingRecords.reserve(WAKE_THRESHOLD);
+	_startTime = steady_clock::now();
+	_writerThread = std::thread(&FrameTraceRecorder::_WriterThreadProc, this);
+
+	Logger::Get().Info(StrHelper::Concat("开始录制帧轨迹: ", StrHelper::UTF16ToUTF8(fileName)));
+	return true;
+}
+
+void FrameTraceRecorder::Record(
+	steady_clock::time_point arrivalTime,
+	FrameTraceDecision decision,
+	uint32_t checkDuration
+) noexcept {
+	const FrameTraceRecord record{
+		.arrivalTime = (uint64_t)duration_cast<nanoseconds>(arrivalTime - _startTime).count(),
+		.checkDuration = checkDuration,
+		.decision = decision
+	};
+
+	bool shouldWake = false;
+	{
+		auto lk = _pendingLock.lock_exclusive();
+
+		if (_pendingRecords.size() >= MAX_PENDING_RECORDS) {
+			// 写入线程跟不上，宁可丢弃记录也不能无限增长
+			_droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		_pendingRecords.push_back(record);
+		shouldWake = _pendingRecords.size() == WAKE_THRESHOLD;
+	}
+
+	if (shouldWake) {
+		_hWakeEvent.SetEvent();
+	}
+}
+
+void FrameTraceRecorder::RecordContent(
+	steady_clock::time_point arrivalTime,
+	const uint8_t* data,
+	uint32_t rowPitch
+) noexcept {
+	assert(_hContentFile);
+
+	std::vector<uint8_t> pixels;
+	{
+		auto lk = _pendingLock.lock_exclusive();
+
+		if (!_freeFrameBuffers.empty()) {
+			pixels = std::move(_freeFrameBuffers.back());
+			_freeFrameBuffers.pop_back();
+		} else if (_frameBufferCount < MAX_FRAME_BUFFERS) {
+			++_frameBufferCount;
+		} else {
+			// 写入线程跟不上，之后的帧仍和写入线程保存的上一帧比较，因此只会丢失这一帧
+			_droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	// 在锁外复制，帧缓冲区的所有权已经转移到这个线程
+	const size_t rowSize = (size_t)_contentHeader.width * 4;
+	pixels.resize(rowSize * _contentHeader.height);
+	for (uint32_t y = 0; y < _contentHeader.height; ++y) {
+		std::memcpy(pixels.data() + y * rowSize, data + (size_t)y * rowPitch, rowSize);
+	}
+
+	{
+		auto lk = _pendingLock.lock_exclusive();
+		_pendingFrames.push_back({
+			.arrivalTime = (uint64_t)duration_cast<nanoseconds>(arrivalTime - _startTime).count(),
+			.pixels = std::move(pixels)
+		});
+	}
+
+	// 每一帧都很大，立即唤醒写入线程
+	_hWakeEvent.SetEvent();
+}
+
+void FrameTraceRecorder::_WriterThreadProc() noexcept {
+#ifdef _DEBUG
+	SetThreadDescription(GetCurrentThread(), L"Magpie-帧轨迹写入线程");
+#endif
+
+	// 和 _pendingRecords 以及 _pendingFrames 交换，避免在持有锁时写入文件
+	std::vector<FrameTraceRecord> records;
+	records.reserve(WAKE_THRESHOLD);
+	std::vector<_PendingFrame> frames;
+
+	while (true) {
+		_hWakeEvent.wait(WRITE_INTERVAL_MS);
+
+		bool isStopping;
+		{
+			auto lk = _pendingLock.lock_exclusive();
+			records.swap(_pendingRecords);
+			frames.swap(_pendingFrames);
+			isStopping = _isStopping;
+		}
+
+		if (!records.empty()) {
+			if (!_WriteRecords(records)) {
+				// 写入失败则放弃录制，之后的记录都将被丢弃
+				Logger::Get().Error("_WriteRecords 失败");
+
+				_isContentFailed.store(true, std::memory_order_relaxed);
+
+				auto lk = _pendingLock.lock_exclusive();
+				_pendingRecords.clear();
+				_pendingRecords.shrink_to_fit();
+				_pendingFrames.clear();
+				_freeFrameBuffers.clear();
+				return;
+			}
+
+			records.clear();
+		}
+
+		if (!frames.empty()) {
+			if (!_isContentFailed.load(std::memory_order_relaxed) && !_WriteFrames(frames)) {
+				// 写入失败则放弃录制帧内容，之后的帧都将被丢弃
+				Logger::Get().Error("_WriteFrames 失败");
+				_isContentFailed.store(true, std::memory_order_relaxed);
+			}
+
+			// 归还帧缓冲区
+			auto lk = _pendingLock.lock_exclusive();
+			for (_PendingFrame& frame : frames) {
+				if (!frame.pixels.empty()) {
+					_freeFrameBuffers.push_back(std::move(frame.pixels));
+				}
+			}
+			frames.clear();
+		}
+
+		if (isStopping) {
+			break;
+		}
+	}
+}
+
+bool FrameTraceRecorder::_WriteRecords(const std::vector<FrameTraceRecord>& records) noexcept {
+	_writeBuffer.resize(records.size() * FrameTraceFormat::RECORD_SIZE);
+	for (size_t i = 0; i < records.size(); ++i) {
+		FrameTraceFormat::WriteRecord(records[i], _writeBuffer.data() + i * FrameTraceFormat::RECORD_SIZE);
+	}
+
+	const DWORD size = (DWORD)_writeBuffer.size();
+	DWORD written;
+	if (!WriteFile(_hFile.get(), _writeBuffer.data(), size, &written, nullptr) || written != size) {
+		Logger::Get().Win32Error("写入帧轨迹文件失败");
+		return false;
+	}
+
+	return true;
+}
+
+bool FrameTraceRecorder::_WriteFrames(std::vector<_PendingFrame>& frames) noexcept {
+	for (_PendingFrame& frame : frames) {
+		_writeBuffer.clear();
+		FrameContentFormat::EncodeFrame(_contentHeader, frame.arrivalTime,
+			frame.pixels.data(), _prevFrame.empty() ? nullptr : _prevFrame.data(), _writeBuffer);
+
+		const DWORD size = (DWORD)_writeBuffer.size();
+		DWORD written;
+		if (!WriteFile(_hContentFile.get(), _writeBuffer.data(), size, &written, nullptr) || written != size) {
+			Logger::Get().Win32Error("写入帧内容文件失败");
+			return false;
+		}
+
+		// 此帧成为下一帧比较的对象，原来的上一帧可以复用
+		_prevFrame.swap(frame.pixels);
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "FrameContentFormat.h"
+#include "FrameTraceFormat.h"
+
+namespace Magpie {
+
+// 将每个到达的新帧以及重复帧检测的结果写入轨迹文件，供 FrameSimulator 离线分析。
+// 还可以将显示的每一帧写入同名的 .mpfc 文件，供 ReplayFrameSource 回放，见 FrameContentFormat。
+// 文件写入在独立线程中进行，缩放后端线程永远不会因磁盘 IO 而阻塞。
+// 内存占用有上限，写入线程来不及处理时新记录和帧内容将被丢弃。帧内容总是和写入线程保存的上一帧
+// 比较，因此丢弃一帧不影响之后的帧。
+class FrameTraceRecorder {
+public:
+	FrameTraceRecorder() = default;
+	~FrameTraceRecorder() noexcept;
+
+	FrameTraceRecorder(const FrameTraceRecorder&) = delete;
+	FrameTraceRecorder(FrameTraceRecorder&&) = delete;
+
+	// recordContent 为 true 时同时录制帧内容
+	bool Initialize(const std::wstring& fileName, const FrameTraceHeader& header, bool recordContent) noexcept;
+
+	// 只能从缩放后端线程调用
+	void Record(
+		std::chrono::steady_clock::time_point arrivalTime,
+		FrameTraceDecision decision,
+		uint32_t checkDuration
+	) noexcept;
+
+	bool IsRecordingContent() const noexcept {
+		return _hContentFile && !_isContentFailed.load(std::memory_order_relaxed);
+	}
+
+	// 只能从缩放后端线程调用。data 是 BGRA8 格式的帧，arrivalTime 和此帧对应的记录相同
+	void RecordContent(
+		std::chrono::steady_clock::time_point arrivalTime,
+		const uint8_t* data,
+		uint32_t rowPitch
+	) noexcept;
+
+private:
+	struct _PendingFrame {
+		uint64_t arrivalTime = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	void _WriterThreadProc() noexcept;
+
+	bool _WriteRecords(const std::vector<FrameTraceRecord>& records) noexcept;
+
+	bool _WriteFrames(std::vector<_PendingFrame>& frames) noexcept;
+
+	wil::unique_hfile _hFile;
+	// 不录制帧内容时为空
+	wil::unique_hfile _hContentFile;
+	FrameContentHeader _contentHeader;
+	std::thread _writerThread;
+	// 有待写入的记录或需要退出时触发
+	wil::unique_event_nothrow _hWakeEvent;
+
+	std::chrono::steady_clock::time_point _startTime;
+
+	wil::srwlock _pendingLock;
+	// 以下成员由 _pendingLock 同步
+	std::vector<FrameTraceRecord> _pendingRecords;
+	std::vector<_PendingFrame> _pendingFrames;
+	// 可以复用的帧缓冲区
+	std::vector<std::vector<uint8_t>> _freeFrameBuffers;
+	// 已分配的帧缓冲区总数，包括写入线程持有的
+	uint32_t _frameBufferCount = 0;
+	bool _isStopping = false;
+
+	// 以下成员只在写入线程中使用
+	// 编码后的记录或帧
+	std::vector<uint8_t> _writeBuffer;
+	// 上一个写入的帧，为空表示还没有写入过
+	std::vector<uint8_t> _prevFrame;
+
+	std::atomic<uint32_t> _droppedCount = 0;
+	std::atomic<uint32_t> _droppedFrameCount = 0;
+	// 写入帧内容失败后不再录制
+	std::atomic<bool> _isContentFailed = false;
+};
+
+}
@@ -49,7 +49,7 @@ bool GraphicsCaptureFrameSource::_Initialize() noexcept {
 			return false;
 		}
 	} catch (const winrt::hresult_error& e) {
-		Logger::Get().Error(StrHelper::Concat("初始化 WinRT 失败: ", StrHelper::UTF16ToUTF8(e.message())));
+		Logger::Get().Error("初始化 WinRT 失败: {}", e.message());
 		return false;
 	}
 
@@ -297,7 +297,7 @@ bool GraphicsCaptureFrameSource::_TryCreateGraphicsCaptureItem(IGraphicsCaptureI
 			return false;
 		}
 	} catch (const winrt::hresult_error& e) {
-		Logger::Get().Info(StrHelper::Concat("源窗口无法使用窗口捕获: ", StrHelper::UTF16ToUTF8(e.message())));
+		Logger::Get().Info("源窗口无法使用窗口捕获: {}", e.message());
 		return false;
 	}
 
@@ -349,7 +349,7 @@ bool GraphicsCaptureFrameSource::_StartCapture() noexcept {
 
 		_captureSession.StartCapture();
 	} catch (const winrt::hresult_error& e) {
-		Logger::Get().Info(StrHelper::Concat("Graphics Capture 失败: ", StrHelper::UTF16ToUTF8(e.message())));
+		Logger::Get().Info("Graphics Capture 失败: {}", e.message());
 		return false;
 	}
 
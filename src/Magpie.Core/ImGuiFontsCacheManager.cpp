@@ -173,27 +173,28 @@ void ImGuiFontsCacheManager::Save(std::wstring_view language, uint32_t dpi, cons
 }
 
 bool ImGuiFontsCacheManager::Load(std::wstring_view language, uint32_t dpi, ImFontAtlas& fontAltas) noexcept {
-	const std::vector<uint8_t>* pBuffer = nullptr;
+	std::span<const uint8_t> buffer;
 
-	// 先在内存缓存中查找，然后是磁盘缓存
+	// 先在内存缓存中查找，然后是磁盘缓存。磁盘缓存直接从映射中反序列化，不保留副本，
+	// 再次加载时重新映射的开销很小。映射必须在 Save 之前关闭，否则无法覆盖文件
+	MappedFile cacheFile;
 	if (auto it = _cacheMap.find(dpi); it == _cacheMap.end()) {
 		std::wstring cacheFileName = GetCacheFileName(language, dpi);
 		if (!Win32Helper::FileExists(cacheFileName.c_str())) {
 			return false;
 		}
 
-		std::vector<uint8_t> buffer;
-		if (!Win32Helper::ReadFile(cacheFileName.c_str(), buffer) || buffer.empty()) {
+		if (!Win32Helper::MapFile(cacheFileName.c_str(), cacheFile) || cacheFile.Size() == 0) {
 			return false;
 		}
 
-		pBuffer = &_cacheMap.emplace(dpi, std::move(buffer)).first->second;
+		buffer = cacheFile.Data();
 	} else {
-		pBuffer = &it->second;
+		buffer = it->second;
 	}
 
 	try {
-		yas::mem_istream mi(pBuffer->data(), pBuffer->size());
+		yas::mem_istream mi(buffer.data(), buffer.size());
 		yas::binary_iarchive<yas::mem_istream, yas::binary> ia(mi);
 
 		uint32_t cacheVersion;
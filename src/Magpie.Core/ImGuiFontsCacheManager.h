@@ -21,7 +21,7 @@ public:
 private:
 	ImGuiFontsCacheManager() = default;
 
-	// dpi -> 字体数据
+	// dpi -> 字体数据，只保存本次运行中生成的缓存
 	phmap::flat_hash_map<uint32_t, std::vector<uint8_t>> _cacheMap;
 };
 
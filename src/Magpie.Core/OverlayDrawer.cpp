@@ -266,14 +266,15 @@ bool OverlayDrawer::_BuildFonts() noexcept {
 			iconFontPath += "\\segmdl2.ttf";
 		}
 
-		std::vector<uint8_t> uiFontData;
-		if (!Win32Helper::ReadFile(uiFontPath.c_str(), uiFontData)) {
+		// 字体文件很大，但只会用到一部分字形
+		MappedFile uiFontFile;
+		if (!Win32Helper::MapFile(uiFontPath.c_str(), uiFontFile, MappedFileHint::Normal)) {
 			Logger::Get().Error("读取字体文件失败");
 			return false;
 		}
 
-		// 构建 ImFontAtlas 前 ranges 不能析构，因为 ImGui 只保存了指针
-		SmallVector<ImWchar> uiRanges = _BuildFontUI(language, uiFontData);
+		// 构建 ImFontAtlas 前 ranges 和 uiFontFile 不能析构，因为 ImGui 只保存了指针
+		SmallVector<ImWchar> uiRanges = _BuildFontUI(language, uiFontFile.Data());
 		_BuildFontIcons(iconFontPath.c_str());
 
 		if (!fontAtlas.Build()) {
@@ -327,7 +328,7 @@ static void SetGlyphRanges(SmallVector<ImWchar>& uiRanges, T ranges) noexcept {
 
 SmallVector<ImWchar> OverlayDrawer::_BuildFontUI(
 	std::wstring_view language,
-	const std::vector<uint8_t>& fontData
+	std::span<const uint8_t> fontData
 ) noexcept {
 	ImFontAtlas& fontAtlas = *ImGui::GetIO().Fonts;
 
@@ -774,6 +775,13 @@ bool OverlayDrawer::_DrawToolbar(uint32_t fps, int& itemId) noexcept {
 					// 开发者模式允许保存任意通道的输出
 					ImGui::PushID(itemId++);
 					if (ImGui::BeginMenu(effectName.data())) {
+						ImGui::PushID(itemId++);
+						if (ImGui::MenuItem(_GetResourceString(L"Overlay_Toolbar_TakeScreenshot_AllPasses").c_str())) {
+							ScalingWindow::Get().Renderer().TakeScreenshotOfAllPasses(i);
+						}
+						ImGui::PopID();
+						ImGui::Separator();
+
 						const uint32_t passCount = (uint32_t)effectDesc.passes.size();
 						for (uint32_t j = 0; j < passCount; ++j) {
 							const EffectPassDesc& passDesc = effectDesc.passes[j];
@@ -968,8 +976,8 @@ bool OverlayDrawer::_DrawProfiler(const SmallVector<float>& effectTimings, uint3
 	ImGui::TextUnformatted(StrHelper::Concat("GPU: ", _hardwareInfo.gpuName).c_str());
 	const std::string& captureMethodStr = _GetResourceString(L"Overlay_Profiler_CaptureMethod");
 	ImGui::TextUnformatted(StrHelper::Concat(captureMethodStr.c_str(), ": ", renderer.FrameSource().Name()).c_str());
-	if (options.IsStatisticsForDynamicDetectionEnabled() &&
-		options.duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Dynamic) {
+	// 不启用统计时显示抽样验证的结果
+	if (options.duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Dynamic) {
 		const std::pair<uint32_t, uint32_t> statistics =
 			renderer.FrameSource().GetStatisticsForDynamicDetection();
 		ImGui::TextUnformatted(StrHelper::Concat(_GetResourceString(L"Overlay_Profiler_DynamicDetection"), ": ").c_str());
@@ -42,7 +42,7 @@ public:
 
 private:
 	bool _BuildFonts() noexcept;
-	SmallVector<ImWchar> _BuildFontUI(std::wstring_view language, const std::vector<uint8_t>& fontData) noexcept;
+	SmallVector<ImWchar> _BuildFontUI(std::wstring_view language, std::span<const uint8_t> fontData) noexcept;
 	void _BuildFontIcons(const char* fontPath) noexcept;
 
 	struct _EffectDrawInfo {
@@ -0,0 +1,552 @@
+#pragma once
+#include "DDSFormat.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+#include <zlib.h>
+
+namespace Magpie {
+
+// 多线程 PNG 编码器。图像按行划分为条带，每个条带独立地转换格式、选择过滤器并压缩，最后拼接为
+// 一个 IDAT 流。每个条带使用之前的 32K 数据作为 deflate 的字典，因此分割条带几乎不影响压缩率。
+// 输出始终为 8 位 RGBA。只由头文件实现，无需 Windows 也可以使用，依赖 zlib。
+struct PngEncoder {
+	// 每个条带至少包含的行数，条带太小会降低压缩率
+	static constexpr uint32_t MIN_ROWS_PER_STRIPE = 64;
+	// deflate 的窗口大小
+	static constexpr uint32_t DEFLATE_WINDOW_SIZE = 32 * 1024;
+	static constexpr int COMPRESSION_LEVEL = 6;
+	static constexpr uint32_t BYTES_PER_PIXEL = 4;
+
+	static bool IsFormatSupported(DXGI_FORMAT format) noexcept {
+		switch (format) {
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+		case DXGI_FORMAT_R16G16B16A16_SNORM:
+		case DXGI_FORMAT_R32G32_FLOAT:
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+		case DXGI_FORMAT_R11G11B10_FLOAT:
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_SNORM:
+		case DXGI_FORMAT_R16G16_FLOAT:
+		case DXGI_FORMAT_R16G16_UNORM:
+		case DXGI_FORMAT_R16G16_SNORM:
+		case DXGI_FORMAT_R32_FLOAT:
+		case DXGI_FORMAT_R8G8_UNORM:
+		case DXGI_FORMAT_R8G8_SNORM:
+		case DXGI_FORMAT_R16_FLOAT:
+		case DXGI_FORMAT_R16_UNORM:
+		case DXGI_FORMAT_R16_SNORM:
+		case DXGI_FORMAT_R8_UNORM:
+		case DXGI_FORMAT_R8_SNORM:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// 将一行转换为 8 位 RGBA。缺少的颜色通道填充 0，缺少的 Alpha 通道填充 1，超出 [0, 1] 的值被截断
+	static void ConvertRow(DXGI_FORMAT format, const uint8_t* src, uint8_t* dest, uint32_t width) noexcept {
+		switch (format) {
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			_ConvertRow<4, float>(src, dest, width, _ConvertFloat);
+			break;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			_ConvertRow<4, uint16_t>(src, dest, width, _ConvertHalf);
+			break;
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+			_ConvertRow<4, uint16_t>(src, dest, width, _ConvertUNorm16);
+			break;
+		case DXGI_FORMAT_R16G16B16A16_SNORM:
+			_ConvertRow<4, int16_t>(src, dest, width, _ConvertSNorm16);
+			break;
+		case DXGI_FORMAT_R32G32_FLOAT:
+			_ConvertRow<2, float>(src, dest, width, _ConvertFloat);
+			break;
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+			for (uint32_t x = 0; x < width; ++x) {
+				uint32_t pixel;
+				std::memcpy(&pixel, src + (size_t)x * 4, 4);
+				dest[0] = uint8_t(((pixel & 0x3FF) * 255u + 511u) / 1023u);
+				dest[1] = uint8_t((((pixel >> 10) & 0x3FF) * 255u + 511u) / 1023u);
+				dest[2] = uint8_t((((pixel >> 20) & 0x3FF) * 255u + 511u) / 1023u);
+				dest[3] = uint8_t((pixel >> 30) * 85u);
+				dest += BYTES_PER_PIXEL;
+			}
+			break;
+		case DXGI_FORMAT_R11G11B10_FLOAT:
+			// 没有符号位，R 和 G 的尾数为 6 位，B 为 5 位，指数都为 5 位
+			for (uint32_t x = 0; x < width; ++x) {
+				uint32_t pixel;
+				std::memcpy(&pixel, src + (size_t)x * 4, 4);
+				dest[0] = _FloatToUNorm8(_UnpackFloat((pixel >> 6) & 0x1F, pixel & 0x3F, 6));
+				dest[1] = _FloatToUNorm8(_UnpackFloat((pixel >> 17) & 0x1F, (pixel >> 11) & 0x3F, 6));
+				dest[2] = _FloatToUNorm8(_UnpackFloat(pixel >> 27, (pixel >> 22) & 0x1F, 5));
+				dest[3] = 255;
+				dest += BYTES_PER_PIXEL;
+			}
+			break;
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+			std::memcpy(dest, src, (size_t)width * BYTES_PER_PIXEL);
+			break;
+		case DXGI_FORMAT_R8G8B8A8_SNORM:
+			_ConvertRow<4, int8_t>(src, dest, width, _ConvertSNorm8);
+			break;
+		case DXGI_FORMAT_R16G16_FLOAT:
+			_ConvertRow<2, uint16_t>(src, dest, width, _ConvertHalf);
+			break;
+		case DXGI_FORMAT_R16G16_UNORM:
+			_ConvertRow<2, uint16_t>(src, dest, width, _ConvertUNorm16);
+			break;
+		case DXGI_FORMAT_R16G16_SNORM:
+			_ConvertRow<2, int16_t>(src, dest, width, _ConvertSNorm16);
+			break;
+		case DXGI_FORMAT_R32_FLOAT:
+			_ConvertRow<1, float>(src, dest, width, _ConvertFloat);
+			break;
+		case DXGI_FORMAT_R8G8_UNORM:
+			_ConvertRow<2, uint8_t>(src, dest, width, _ConvertUNorm8);
+			break;
+		case DXGI_FORMAT_R8G8_SNORM:
+			_ConvertRow<2, int8_t>(src, dest, width, _ConvertSNorm8);
+			break;
+		case DXGI_FORMAT_R16_FLOAT:
+			_ConvertRow<1, uint16_t>(src, dest, width, _ConvertHalf);
+			break;
+		case DXGI_FORMAT_R16_UNORM:
+			_ConvertRow<1, uint16_t>(src, dest, width, _ConvertUNorm16);
+			break;
+		case DXGI_FORMAT_R16_SNORM:
+			_ConvertRow<1, int16_t>(src, dest, width, _ConvertSNorm16);
+			break;
+		case DXGI_FORMAT_R8_UNORM:
+			_ConvertRow<1, uint8_t>(src, dest, width, _ConvertUNorm8);
+			break;
+		case DXGI_FORMAT_R8_SNORM:
+			_ConvertRow<1, int8_t>(src, dest, width, _ConvertSNorm8);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// 将 pixelData 编码为完整的 PNG 文件并写入 result。stripeCount 为 0 时根据图像高度和线程池的线程数
+	// 决定条带数，为 1 时在当前线程中编码，和单线程的编码器相同。格式不受支持或 zlib 出错时返回 false
+	static bool Encode(
+		uint32_t width,
+		uint32_t height,
+		DXGI_FORMAT format,
+		std::span<const uint8_t> pixelData,
+		uint32_t rowPitch,
+		std::vector<uint8_t>& result,
+		uint32_t stripeCount = 0
+	) noexcept {
+		if (width == 0 || height == 0 || !IsFormatSupported(format)) {
+			return false;
+		}
+
+		if (stripeCount == 0) {
+			stripeCount = std::clamp(height / MIN_ROWS_PER_STRIPE, 1u, ThreadPool::Get().ThreadCount());
+		} else {
+			stripeCount = std::min(stripeCount, height);
+		}
+
+		const uint32_t rowSize = width * BYTES_PER_PIXEL;
+		// 过滤后每行开头有一个字节标识过滤器类型
+		const size_t filteredRowSize = (size_t)rowSize + 1;
+		const uint32_t rowsPerStripe = (height + stripeCount - 1) / stripeCount;
+		const bool needConversion = format != DXGI_FORMAT_R8G8B8A8_UNORM;
+
+		std::unique_ptr<uint8_t[]> filteredData;
+		std::vector<std::vector<uint8_t>> compressedStripes;
+		std::vector<uLong> stripeAdlers;
+		try {
+			filteredData.reset(new uint8_t[filteredRowSize * height]);
+			compressedStripes.resize(stripeCount);
+			stripeAdlers.resize(stripeCount);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		// 第一阶段: 转换格式并过滤。每个条带独立转换自己的行以及前一行，无需同步。
+		std::atomic<bool> failed = false;
+		ThreadPool::Get().ParallelFor(stripeCount, [&](uint32_t stripeIdx) {
+			const uint32_t beginRow = stripeIdx * rowsPerStripe;
+			const uint32_t endRow = std::min(beginRow + rowsPerStripe, height);
+			if (beginRow >= endRow) {
+				return;
+			}
+
+			std::vector<uint8_t> candidates;
+			// 转换后的行，多出的一行存放前一行
+			std::vector<uint8_t> converted;
+			try {
+				candidates.resize((size_t)rowSize * (uint32_t)_FilterType::COUNT);
+				converted.resize((size_t)rowSize * (needConversion ? endRow - beginRow + 1 : 1));
+			} catch (const std::bad_alloc&) {
+				failed.store(true, std::memory_order_relaxed);
+				return;
+			}
+
+			// 图像第一行的前一行视为 0
+			const uint8_t* prevRow = converted.data();
+			if (beginRow == 0) {
+				std::fill_n(converted.data(), rowSize, uint8_t(0));
+			} else {
+				const uint8_t* srcRow = pixelData.data() + (size_t)(beginRow - 1) * rowPitch;
+				if (needConversion) {
+					ConvertRow(format, srcRow, converted.data(), width);
+				} else {
+					prevRow = srcRow;
+				}
+			}
+
+			for (uint32_t y = beginRow; y < endRow; ++y) {
+				const uint8_t* curRow = pixelData.data() + (size_t)y * rowPitch;
+				if (needConversion) {
+					uint8_t* convertedRow = converted.data() + (size_t)(y - beginRow + 1) * rowSize;
+					ConvertRow(format, curRow, convertedRow, width);
+					curRow = convertedRow;
+				}
+
+				_FilterRow(curRow, prevRow, rowSize, candidates.data(), filteredData.get() + y * filteredRowSize);
+				prevRow = curRow;
+			}
+		});
+
+		if (failed) {
+			return false;
+		}
+
+		// 第二阶段: 并行压缩每个条带，使用前一个条带末尾的数据作为字典
+		ThreadPool::Get().ParallelFor(stripeCount, [&](uint32_t stripeIdx) {
+			const uint32_t beginRow = std::min(stripeIdx * rowsPerStripe, height);
+			const uint32_t endRow = std::min(beginRow + rowsPerStripe, height);
+
+			const size_t offset = beginRow * filteredRowSize;
+			const size_t dictSize = std::min(offset, (size_t)DEFLATE_WINDOW_SIZE);
+			std::span<const uint8_t> data(filteredData.get() + offset, (endRow - beginRow) * filteredRowSize);
+
+			stripeAdlers[stripeIdx] = adler32_z(adler32(0, nullptr, 0), data.data(), data.size());
+
+			if (!_DeflateStripe(
+				std::span(filteredData.get() + offset - dictSize, dictSize),
+				data,
+				stripeIdx == stripeCount - 1,
+				compressedStripes[stripeIdx]
+			)) {
+				failed.store(true, std::memory_order_relaxed);
+			}
+		});
+
+		if (failed) {
+			return false;
+		}
+
+		// 合并 Adler-32 校验和
+		uLong adler = stripeAdlers[0];
+		for (uint32_t i = 1; i < stripeCount; ++i) {
+			const uint32_t beginRow = std::min(i * rowsPerStripe, height);
+			const uint32_t endRow = std::min(beginRow + rowsPerStripe, height);
+			adler = adler32_combine(adler, stripeAdlers[i], (z_off_t)((endRow - beginRow) * filteredRowSize));
+		}
+
+		size_t idatSize = 0;
+		for (const std::vector<uint8_t>& stripe : compressedStripes) {
+			idatSize += stripe.size();
+		}
+
+		static constexpr uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		// 每个块有长度、类型和 CRC 共 12 字节。IHDR 和 IEND 各一个，每个条带一个 IDAT 块，
+		// 此外还有 zlib 头和校验和
+		try {
+			result.clear();
+			result.reserve(sizeof(PNG_SIGNATURE) + 12 * (2 + (size_t)stripeCount) + 13 + 6 + idatSize);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		result.insert(result.end(), std::begin(PNG_SIGNATURE), std::end(PNG_SIGNATURE));
+
+		{
+			uint8_t ihdr[13];
+			_StoreBE(ihdr, width);
+			_StoreBE(ihdr + 4, height);
+			// 位深度
+			ihdr[8] = 8;
+			// 颜色类型: RGBA
+			ihdr[9] = 6;
+			// 压缩方法、过滤方法和隔行扫描方法
+			ihdr[10] = 0;
+			ihdr[11] = 0;
+			ihdr[12] = 0;
+			_AppendChunk(result, "IHDR", {}, ihdr, {});
+		}
+
+		// 每个条带写入一个 IDAT 块。zlib 头附加在第一个条带前，校验和附加在最后一个条带后。
+		// CMF=0x78 表示 32K 窗口，FLG=0x9C 表示默认压缩级别
+		static constexpr uint8_t ZLIB_HEADER[] = { 0x78, 0x9C };
+		uint8_t adlerBE[4];
+		_StoreBE(adlerBE, (uint32_t)adler);
+
+		for (uint32_t i = 0; i < stripeCount; ++i) {
+			const std::vector<uint8_t>& stripe = compressedStripes[i];
+			const bool isFirst = i == 0;
+			const bool isLast = i == stripeCount - 1;
+			if (stripe.empty() && !isFirst && !isLast) {
+				continue;
+			}
+
+			_AppendChunk(
+				result,
+				"IDAT",
+				isFirst ? std::span<const uint8_t>(ZLIB_HEADER) : std::span<const uint8_t>(),
+				stripe,
+				isLast ? std::span<const uint8_t>(adlerBE) : std::span<const uint8_t>()
+			);
+		}
+
+		_AppendChunk(result, "IEND", {}, {}, {});
+		return true;
+	}
+
+private:
+	enum class _FilterType : uint8_t {
+		None,
+		Sub,
+		Up,
+		Average,
+		Paeth,
+		COUNT
+	};
+
+	static uint8_t _FloatToUNorm8(float value) noexcept {
+		// NaN 也转换为 0
+		if (!(value > 0.0f)) {
+			return 0;
+		}
+		if (value >= 1.0f) {
+			return 255;
+		}
+		return uint8_t(value * 255.0f + 0.5f);
+	}
+
+	// 将 5 位指数、偏移为 15 的无符号小浮点数转换为 float，用于半精度浮点数和 R11G11B10
+	static float _UnpackFloat(uint32_t exponent, uint32_t mantissa, uint32_t mantissaBits) noexcept {
+		if (exponent == 0) {
+			// 非规格化数和 0，单位为 2^(-14-mantissaBits)
+			return (float)mantissa * std::bit_cast<float>((127u - 14u - mantissaBits) << 23);
+		}
+
+		if (exponent == 0x1F) {
+			return std::bit_cast<float>(0x7F800000 | (mantissa << (23 - mantissaBits)));
+		}
+
+		return std::bit_cast<float>(((exponent + 112) << 23) | (mantissa << (23 - mantissaBits)));
+	}
+
+	// 将一行中每个通道分别转换，缺少的颜色通道填充 0，缺少的 Alpha 通道填充 1
+	template <uint32_t N, typename T, typename Converter>
+	static void _ConvertRow(const uint8_t* src, uint8_t* dest, uint32_t width, Converter converter) noexcept {
+		for (uint32_t x = 0; x < width; ++x) {
+			for (uint32_t c = 0; c < BYTES_PER_PIXEL; ++c) {
+				if (c < N) {
+					T value;
+					std::memcpy(&value, src + c * sizeof(T), sizeof(T));
+					dest[c] = converter(value);
+				} else {
+					dest[c] = c == 3 ? 255 : 0;
+				}
+			}
+
+			src += N * sizeof(T);
+			dest += BYTES_PER_PIXEL;
+		}
+	}
+
+	static uint8_t _ConvertFloat(float value) noexcept {
+		return _FloatToUNorm8(value);
+	}
+
+	static uint8_t _ConvertHalf(uint16_t value) noexcept {
+		// 负值截断为 0
+		if (value & 0x8000) {
+			return 0;
+		}
+		return _FloatToUNorm8(_UnpackFloat(value >> 10, value & 0x3FF, 10));
+	}
+
+	static uint8_t _ConvertUNorm16(uint16_t value) noexcept {
+		return uint8_t((value * 255u + 32767u) / 65535u);
+	}
+
+	static uint8_t _ConvertSNorm16(int16_t value) noexcept {
+		// 负值截断为 0
+		return _FloatToUNorm8(value / 32767.0f);
+	}
+
+	static uint8_t _ConvertUNorm8(uint8_t value) noexcept {
+		return value;
+	}
+
+	static uint8_t _ConvertSNorm8(int8_t value) noexcept {
+		return _FloatToUNorm8(value / 127.0f);
+	}
+
+	static uint8_t _PaethPredictor(int a, int b, int c) noexcept {
+		const int p = a + b - c;
+		const int pa = std::abs(p - a);
+		const int pb = std::abs(p - b);
+		const int pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc) {
+			return (uint8_t)a;
+		} else if (pb <= pc) {
+			return (uint8_t)b;
+		} else {
+			return (uint8_t)c;
+		}
+	}
+
+	// 按照 PNG 规范推荐的启发式方法选择过滤器：过滤后的字节视为有符号数，绝对值之和最小者胜出。
+	// candidates 用于存放所有过滤器的结果，大小为 rowSize * _FilterType::COUNT。
+	// 除 Paeth 外的计算都没有分支，编译器可以将其向量化。
+	static void _FilterRow(
+		const uint8_t* cur,
+		const uint8_t* prev,
+		uint32_t rowSize,
+		uint8_t* candidates,
+		uint8_t* dest
+	) noexcept {
+		uint8_t* none = candidates;
+		uint8_t* sub = none + rowSize;
+		uint8_t* up = sub + rowSize;
+		uint8_t* average = up + rowSize;
+		uint8_t* paeth = average + rowSize;
+
+		// 第一个像素左侧的像素视为 0
+		for (uint32_t i = 0; i < BYTES_PER_PIXEL; ++i) {
+			none[i] = cur[i];
+			sub[i] = cur[i];
+			up[i] = uint8_t(cur[i] - prev[i]);
+			average[i] = uint8_t(cur[i] - (prev[i] >> 1));
+			paeth[i] = uint8_t(cur[i] - prev[i]);
+		}
+
+		for (uint32_t i = BYTES_PER_PIXEL; i < rowSize; ++i) {
+			const uint8_t a = cur[i - BYTES_PER_PIXEL];
+			const uint8_t b = prev[i];
+			const uint8_t c = prev[i - BYTES_PER_PIXEL];
+			none[i] = cur[i];
+			sub[i] = uint8_t(cur[i] - a);
+			up[i] = uint8_t(cur[i] - b);
+			average[i] = uint8_t(cur[i] - ((a + b) >> 1));
+			paeth[i] = uint8_t(cur[i] - _PaethPredictor(a, b, c));
+		}
+
+		uint32_t bestFilter = 0;
+		uint64_t minSum = std::numeric_limits<uint64_t>::max();
+		for (uint32_t filter = 0; filter < (uint32_t)_FilterType::COUNT; ++filter) {
+			const int8_t* filtered = (const int8_t*)candidates + (size_t)filter * rowSize;
+
+			uint64_t sum = 0;
+			for (uint32_t i = 0; i < rowSize; ++i) {
+				sum += (uint32_t)std::abs(filtered[i]);
+			}
+
+			if (sum < minSum) {
+				minSum = sum;
+				bestFilter = filter;
+			}
+		}
+
+		dest[0] = (uint8_t)bestFilter;
+		std::memcpy(dest + 1, candidates + (size_t)bestFilter * rowSize, rowSize);
+	}
+
+	// 使用 raw deflate 压缩一个条带。除最后一个条带外都以 Z_SYNC_FLUSH 结束，使输出对齐到字节边界，
+	// 从而可以直接拼接。
+	static bool _DeflateStripe(
+		std::span<const uint8_t> dictionary,
+		std::span<const uint8_t> data,
+		bool isLast,
+		std::vector<uint8_t>& output
+	) noexcept {
+		z_stream stream{};
+		if (deflateInit2(&stream, COMPRESSION_LEVEL, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			return false;
+		}
+
+		if (!dictionary.empty()) {
+			if (deflateSetDictionary(&stream, dictionary.data(), (uInt)dictionary.size()) != Z_OK) {
+				deflateEnd(&stream);
+				return false;
+			}
+		}
+
+		try {
+			// Z_SYNC_FLUSH 最多额外输出几个字节
+			output.resize(deflateBound(&stream, (uLong)data.size()) + 16);
+		} catch (const std::bad_alloc&) {
+			deflateEnd(&stream);
+			return false;
+		}
+
+		stream.next_in = const_cast<Bytef*>(data.data());
+		stream.avail_in = (uInt)data.size();
+		stream.next_out = output.data();
+		stream.avail_out = (uInt)output.size();
+
+		const int ret = deflate(&stream, isLast ? Z_FINISH : Z_SYNC_FLUSH);
+		const bool success = isLast ? ret == Z_STREAM_END : (ret == Z_OK && stream.avail_in == 0);
+		output.resize(stream.total_out);
+		deflateEnd(&stream);
+
+		return success;
+	}
+
+	static void _StoreBE(uint8_t* data, uint32_t value) noexcept {
+		data[0] = uint8_t(value >> 24);
+		data[1] = uint8_t(value >> 16);
+		data[2] = uint8_t(value >> 8);
+		data[3] = uint8_t(value);
+	}
+
+	// 追加一个块，数据由 prefix、data 和 suffix 拼接而成。result 已预留足够的空间
+	static void _AppendChunk(
+		std::vector<uint8_t>& result,
+		const char(&type)[5],
+		std::span<const uint8_t> prefix,
+		std::span<const uint8_t> data,
+		std::span<const uint8_t> suffix
+	) noexcept {
+		uint8_t header[8];
+		_StoreBE(header, uint32_t(prefix.size() + data.size() + suffix.size()));
+		std::memcpy(header + 4, type, 4);
+		result.insert(result.end(), std::begin(header), std::end(header));
+
+		uLong crc = crc32(0, (const Bytef*)type, 4);
+		for (std::span<const uint8_t> part : { prefix, data, suffix }) {
+			// 缓冲区为 NULL 时 crc32_z 返回初始值而不是 crc
+			if (!part.empty()) {
+				crc = crc32_z(crc, part.data(), part.size());
+				result.insert(result.end(), part.begin(), part.end());
+			}
+		}
+
+		uint8_t crcBE[4];
+		_StoreBE(crcBE, (uint32_t)crc);
+		result.insert(result.end(), std::begin(crcBE), std::end(crcBE));
+	}
+};
+
+}
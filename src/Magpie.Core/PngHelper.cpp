@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "PngHelper.h"
+#include "EffectHelper.h"
+#include "Logger.h"
+#include "PngEncoder.h"
+
+namespace Magpie {
+
+bool PngHelper::Save(
+	const wchar_t* fileName,
+	uint32_t width,
+	uint32_t height,
+	EffectIntermediateTextureFormat format,
+	std::span<uint8_t> pixelData,
+	uint32_t rowPitch
+) noexcept {
+	const DXGI_FORMAT dxgiFormat = EffectHelper::FORMAT_DESCS[(uint32_t)format].dxgiFormat;
+
+	std::vector<uint8_t> fileData;
+	if (!PngEncoder::Encode(width, height, dxgiFormat, pixelData, rowPitch, fileData)) {
+		Logger::Get().Error("PngEncoder::Encode 失败");
+		return false;
+	}
+
+	CREATEFILE2_EXTENDED_PARAMETERS extendedParams{
+		.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS),
+		.dwFileAttributes = FILE_ATTRIBUTE_NORMAL,
+		.dwFileFlags = FILE_FLAG_SEQUENTIAL_SCAN
+	};
+	wil::unique_hfile hFile(CreateFile2(fileName, GENERIC_WRITE, 0, CREATE_ALWAYS, &extendedParams));
+	if (!hFile) {
+		Logger::Get().Win32Error("CreateFile2 失败");
+		return false;
+	}
+
+	DWORD written;
+	if (!WriteFile(hFile.get(), fileData.data(), (DWORD)fileData.size(), &written, nullptr) ||
+		written != fileData.size()) {
+		Logger::Get().Win32Error("WriteFile 失败");
+		return false;
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "EffectDesc.h"
+
+namespace Magpie {
+
+// 保存 PNG 文件，编码由 PngEncoder 完成。支持所有 EffectIntermediateTextureFormat，输出始终为 8 位 RGBA。
+struct PngHelper {
+	static bool Save(
+		const wchar_t* fileName,
+		uint32_t width,
+		uint32_t height,
+		EffectIntermediateTextureFormat format,
+		std::span<uint8_t> pixelData,
+		uint32_t rowPitch
+	) noexcept;
+};
+
+}
@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Magpie {
+
+// 根据每个效果的渲染时间自动调整质量。渲染跟不上目标帧率时将同一系列的效果切换到更快的档位，
+// 有余量时再切换回来。档位 0 为用户选择的效果，不会切换到比它更高的档位。
+// 时间由调用者传入，因此可以用模拟的时钟测试。只由头文件实现，无需 Windows 也可以使用。
+class QualityController {
+public:
+	// 效果渲染时间超过帧间隔的这个比例视为超出预算。效果之外还有捕获、呈现和源窗口自身的渲染，
+	// 因此不能用满整个帧间隔
+	static constexpr float DOWNGRADE_THRESHOLD = 0.8f;
+	// 升档后预计的渲染时间必须低于帧间隔的这个比例。和 DOWNGRADE_THRESHOLD 之间的差距用于防止来回切换
+	static constexpr float UPGRADE_THRESHOLD = 0.6f;
+	// 没有测量过高档位的渲染时间时，假设它是当前档位的两倍
+	static constexpr float UNKNOWN_UPGRADE_COST = 2.0f;
+	// 指数移动平均的平滑系数
+	static constexpr float SMOOTHING_FACTOR = 0.1f;
+
+	// 持续超出预算这么久才降档，偶尔的卡顿不应导致降档
+	static constexpr std::chrono::nanoseconds DOWNGRADE_DELAY = std::chrono::milliseconds(500);
+	// 持续有余量这么久才升档，乘以 upgradeBackoff
+	static constexpr std::chrono::nanoseconds UPGRADE_DELAY = std::chrono::seconds(3);
+	// 切换后等待移动平均稳定
+	static constexpr std::chrono::nanoseconds SETTLE_TIME = std::chrono::milliseconds(500);
+	// 升档后这么短时间内又降档则加倍升档前的等待时间
+	static constexpr std::chrono::nanoseconds OSCILLATION_WINDOW = std::chrono::seconds(10);
+	static constexpr uint32_t MAX_UPGRADE_BACKOFF = 16;
+
+	QualityController() = default;
+
+	QualityController(const QualityController&) = delete;
+	QualityController(QualityController&&) = delete;
+
+	// 返回比 effectName 低的档位，按质量从高到低排列。不属于任何系列时返回空
+	static std::span<const std::string_view> GetLowerTiers(std::string_view effectName) noexcept {
+		for (std::span<const std::string_view> family : _TIER_FAMILIES) {
+			auto it = std::find(family.begin(), family.end(), effectName);
+			if (it != family.end()) {
+				return { it + 1, family.end() };
+			}
+		}
+
+		return {};
+	}
+
+	// frameBudget 为目标帧间隔，tierCounts[i] 为第 i 个效果的档位数，1 表示不支持切换
+	void Initialize(std::chrono::nanoseconds frameBudget, std::span<const uint32_t> tierCounts) noexcept {
+		assert(frameBudget.count() > 0);
+
+		_frameBudget = std::chrono::duration<float, std::milli>(frameBudget).count();
+
+		_effects.clear();
+		_effects.resize(tierCounts.size());
+		for (size_t i = 0; i < tierCounts.size(); ++i) {
+			assert(tierCounts[i] > 0);
+			_effects[i].tierTimings.resize(tierCounts[i]);
+		}
+
+		_avgTimings.clear();
+		_lastSwitchTime.reset();
+		_overBudgetSince.reset();
+		_underBudgetSince.reset();
+		_isSwitching = false;
+	}
+
+	bool IsEnabled() const noexcept {
+		return !_effects.empty();
+	}
+
+	uint32_t GetTier(uint32_t effectIdx) const noexcept {
+		return effectIdx < _effects.size() ? _effects[effectIdx].tier : 0;
+	}
+
+	// 当前的升档等待时间倍数
+	uint32_t GetUpgradeBackoff(uint32_t effectIdx) const noexcept {
+		return effectIdx < _effects.size() ? _effects[effectIdx].upgradeBackoff : 1;
+	}
+
+	// 每渲染一帧调用一次，now 为当前时间，effectTimings 为每个效果的渲染时间（毫秒），包括追加的 Bicubic。
+	// 返回 true 表示应将效果 effectIdx 切换到 tier，切换完成后必须调用 OnTierSwitched
+	bool Update(
+		std::chrono::nanoseconds now,
+		std::span<const float> effectTimings,
+		uint32_t& effectIdx,
+		uint32_t& tier
+	) noexcept {
+		// 效果数量至少为 _effects 的大小，追加的 Bicubic 不计入 _effects
+		if (!IsEnabled() || _isSwitching || effectTimings.size() < _effects.size()) {
+			return false;
+		}
+
+		if (_avgTimings.size() != effectTimings.size()) {
+			// 追加或移除了 Bicubic
+			_avgTimings.clear();
+			_avgTimings.resize(effectTimings.size());
+		}
+
+		float totalTime = 0.0f;
+		for (size_t i = 0; i < effectTimings.size(); ++i) {
+			float& avgTime = _avgTimings[i];
+			if (avgTime == 0.0f) {
+				avgTime = effectTimings[i];
+			} else {
+				avgTime += (effectTimings[i] - avgTime) * SMOOTHING_FACTOR;
+			}
+			totalTime += avgTime;
+		}
+
+		if (_lastSwitchTime && now - *_lastSwitchTime < SETTLE_TIME) {
+			return false;
+		}
+
+		if (totalTime > _frameBudget * DOWNGRADE_THRESHOLD) {
+			_underBudgetSince.reset();
+			if (!_overBudgetSince) {
+				_overBudgetSince = now;
+			}
+
+			if (now - *_overBudgetSince < DOWNGRADE_DELAY) {
+				return false;
+			}
+
+			return _TryDowngrade(now, effectIdx, tier);
+		} else if (totalTime < _frameBudget * UPGRADE_THRESHOLD) {
+			_overBudgetSince.reset();
+			if (!_underBudgetSince) {
+				_underBudgetSince = now;
+			}
+
+			return _TryUpgrade(now, totalTime, effectIdx, tier);
+		} else {
+			_overBudgetSince.reset();
+			_underBudgetSince.reset();
+			return false;
+		}
+	}
+
+	// now 为切换完成的时间
+	void OnTierSwitched(std::chrono::nanoseconds now, uint32_t effectIdx, uint32_t tier, bool succeeded) noexcept {
+		assert(_isSwitching);
+		_isSwitching = false;
+
+		_EffectState& state = _effects[effectIdx];
+
+		if (succeeded) {
+			state.tier = tier;
+			// 重新开始统计新档位的渲染时间
+			_avgTimings[effectIdx] = 0.0f;
+		} else if (tier > state.tier) {
+			// 无法切换到这个档位，以后不再尝试
+			state.tierTimings.resize(tier);
+		} else {
+			state.upgradeBackoff = MAX_UPGRADE_BACKOFF;
+		}
+
+		_lastSwitchTime = now;
+		_overBudgetSince.reset();
+		_underBudgetSince.reset();
+	}
+
+private:
+	bool _TryDowngrade(std::chrono::nanoseconds now, uint32_t& effectIdx, uint32_t& tier) noexcept {
+		// 降低渲染时间最长的效果
+		uint32_t targetIdx = std::numeric_limits<uint32_t>::max();
+		for (uint32_t i = 0; i < (uint32_t)_effects.size(); ++i) {
+			const _EffectState& state = _effects[i];
+			if (state.tier + 1 >= state.tierTimings.size()) {
+				continue;
+			}
+
+			if (targetIdx == std::numeric_limits<uint32_t>::max() || _avgTimings[i] > _avgTimings[targetIdx]) {
+				targetIdx = i;
+			}
+		}
+
+		if (targetIdx == std::numeric_limits<uint32_t>::max()) {
+			// 已是最低档位
+			return false;
+		}
+
+		_EffectState& state = _effects[targetIdx];
+		state.tierTimings[state.tier] = _avgTimings[targetIdx];
+
+		if (state.lastUpgradeTime && now - *state.lastUpgradeTime < OSCILLATION_WINDOW) {
+			state.upgradeBackoff = std::min(state.upgradeBackoff * 2, MAX_UPGRADE_BACKOFF);
+		}
+
+		_isSwitching = true;
+		effectIdx = targetIdx;
+		tier = state.tier + 1;
+		return true;
+	}
+
+	bool _TryUpgrade(std::chrono::nanoseconds now, float totalTime, uint32_t& effectIdx, uint32_t& tier) noexcept {
+		for (uint32_t i = 0; i < (uint32_t)_effects.size(); ++i) {
+			_EffectState& state = _effects[i];
+			if (state.tier == 0 || now - *_underBudgetSince < UPGRADE_DELAY * state.upgradeBackoff) {
+				continue;
+			}
+
+			const float upperTierTime = state.tierTimings[state.tier - 1];
+			const float predictedTime = upperTierTime > 0.0f ? upperTierTime : _avgTimings[i] * UNKNOWN_UPGRADE_COST;
+			if (totalTime - _avgTimings[i] + predictedTime >= _frameBudget * UPGRADE_THRESHOLD) {
+				continue;
+			}
+
+			state.tierTimings[state.tier] = _avgTimings[i];
+			state.lastUpgradeTime = now;
+
+			_isSwitching = true;
+			effectIdx = i;
+			tier = state.tier - 1;
+			return true;
+		}
+
+		return false;
+	}
+
+	// 同一系列的效果，按质量从高到低排列。它们的输出尺寸相同，因此可以在渲染时互相替换
+	static constexpr std::string_view _GLSS_TIERS[] = {
+		"Glss\\Bicubic", "Glss\\Bicubic - lite", "Glss\\Bicubic - fast" };
+	static constexpr std::string_view _GLSS_MULTIPASS_TIERS[] = {
+		"Glss\\Bicubic - multipass", "Glss\\Bicubic - lite", "Glss\\Bicubic - fast" };
+	static constexpr std::string_view _CUNNY_TIERS[] = {
+		"CuNNy2\\CuNNy-8x32-NVL", "CuNNy2\\CuNNy-4x16-NVL", "CuNNy2\\CuNNy-fast-NVL" };
+	static constexpr std::string_view _RAVU_TIERS[] = {
+		"RAVU\\RAVU_R4", "RAVU\\RAVU_R3", "RAVU\\RAVU_R2" };
+	static constexpr std::string_view _RAVU_RGB_TIERS[] = {
+		"RAVU\\RAVU_R4_RGB", "RAVU\\RAVU_R3_RGB", "RAVU\\RAVU_R2_RGB" };
+	static constexpr std::string_view _RAVU_LITE_TIERS[] = {
+		"RAVU\\RAVU_Lite_R4", "RAVU\\RAVU_Lite_R3", "RAVU\\RAVU_Lite_R2" };
+	static constexpr std::string_view _RAVU_LITE_AR_TIERS[] = {
+		"RAVU\\RAVU_Lite_AR_R4", "RAVU\\RAVU_Lite_AR_R3", "RAVU\\RAVU_Lite_AR_R2" };
+	static constexpr std::string_view _RAVU_3X_TIERS[] = {
+		"RAVU\\RAVU_3x_R4", "RAVU\\RAVU_3x_R3", "RAVU\\RAVU_3x_R2" };
+	static constexpr std::string_view _RAVU_3X_RGB_TIERS[] = {
+		"RAVU\\RAVU_3x_R4_RGB", "RAVU\\RAVU_3x_R3_RGB", "RAVU\\RAVU_3x_R2_RGB" };
+	static constexpr std::string_view _RAVU_ZOOM_TIERS[] = {
+		"RAVU\\RAVU_Zoom_R3", "RAVU\\RAVU_Zoom_R2" };
+	static constexpr std::string_view _RAVU_ZOOM_RGB_TIERS[] = {
+		"RAVU\\RAVU_Zoom_R3_RGB", "RAVU\\RAVU_Zoom_R2_RGB" };
+	static constexpr std::string_view _RAVU_ZOOM_AR_TIERS[] = {
+		"RAVU\\RAVU_Zoom_AR_R3", "RAVU\\RAVU_Zoom_AR_R2" };
+	static constexpr std::string_view _RAVU_ZOOM_AR_RGB_TIERS[] = {
+		"RAVU\\RAVU_Zoom_AR_R3_RGB", "RAVU\\RAVU_Zoom_AR_R2_RGB" };
+
+	static constexpr std::span<const std::string_view> _TIER_FAMILIES[] = {
+		_GLSS_TIERS,
+		_GLSS_MULTIPASS_TIERS,
+		_CUNNY_TIERS,
+		_RAVU_TIERS,
+		_RAVU_RGB_TIERS,
+		_RAVU_LITE_TIERS,
+		_RAVU_LITE_AR_TIERS,
+		_RAVU_3X_TIERS,
+		_RAVU_3X_RGB_TIERS,
+		_RAVU_ZOOM_TIERS,
+		_RAVU_ZOOM_RGB_TIERS,
+		_RAVU_ZOOM_AR_TIERS,
+		_RAVU_ZOOM_AR_RGB_TIERS
+	};
+
+	struct _EffectState {
+		// 各档位最近一次测得的平均渲染时间，0 表示未知
+		std::vector<float> tierTimings;
+		uint32_t tier = 0;
+		// 升档后不久又降档说明余量不足，每发生一次加倍升档前的等待时间
+		uint32_t upgradeBackoff = 1;
+		std::optional<std::chrono::nanoseconds> lastUpgradeTime;
+	};
+	std::vector<_EffectState> _effects;
+
+	// 每个效果渲染时间的指数移动平均，0 表示尚无数据
+	std::vector<float> _avgTimings;
+	// 毫秒
+	float _frameBudget = 0.0f;
+
+	std::optional<std::chrono::nanoseconds> _lastSwitchTime;
+	std::optional<std::chrono::nanoseconds> _overBudgetSince;
+	std::optional<std::chrono::nanoseconds> _underBudgetSince;
+
+	bool _isSwitching = false;
+};
+
+}
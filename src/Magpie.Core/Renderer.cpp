@@ -2,6 +2,7 @@
 #include "CommonSharedConstants.h"
 #include "DesktopDuplicationFrameSource.h"
 #include "DeviceResources.h"
+#include "DDSFormat.h"
 #include "DirectXHelper.h"
 #include "DwmSharedSurfaceFrameSource.h"
 #include "EffectCompiler.h"
@@ -12,11 +13,13 @@
 #include "Logger.h"
 #include "OverlayDrawer.h"
 #include "Renderer.h"
+#include "ReplayFrameSource.h"
 #include "ScalingOptions.h"
 #include "ScalingWindow.h"
 #include "ScreenshotHelper.h"
 #include "StrHelper.h"
 #include "TextureHelper.h"
+#include "ThreadPool.h"
 #include "Win32Helper.h"
 #ifdef MP_USE_COMPSWAPCHAIN
 #include "CompSwapchainPresenter.h"
@@ -58,8 +61,8 @@ static void LogAdapter(IDXGIAdapter4* adapter) noexcept {
 	DXGI_ADAPTER_DESC1 desc;
 	adapter->GetDesc1(&desc);
 
-	Logger::Get().Info(fmt::format("当前图形适配器: \n\tVendorId: {:#x}\n\tDeviceId: {:#x}\n\tDescription: {}",
-		desc.VendorId, desc.DeviceId, StrHelper::UTF16ToUTF8(desc.Description)));
+	Logger::Get().Info("当前图形适配器: \n\tVendorId: {:#x}\n\tDeviceId: {:#x}\n\tDescription: {}",
+		desc.VendorId, desc.DeviceId, StrHelper::UTF16ToUTF8(desc.Description));
 }
 
 static void SetGpuPriority() noexcept {
@@ -119,9 +122,9 @@ ScalingError Renderer::Initialize(HWND hwndAttach, OverlayOptions& overlayOption
 
 	_UpdateDestRect();
 
-	Logger::Get().Info(fmt::format("目标矩形: {},{},{},{} ({}x{})",
+	Logger::Get().Info("目标矩形: {},{},{},{} ({}x{})",
 		_destRect.left, _destRect.top, _destRect.right, _destRect.bottom,
-		_destRect.right - _destRect.left, _destRect.bottom - _destRect.top));
+		_destRect.right - _destRect.left, _destRect.bottom - _destRect.top);
 
 	if (!_cursorDrawer.Initialize(_frontendResources)) {
 		Logger::Get().ComError("初始化 CursorDrawer 失败", hr);
@@ -185,18 +188,93 @@ void Renderer::StopProfile() noexcept {
 	});
 }
 
-winrt::fire_and_forget Renderer::TakeScreenshot(
+void Renderer::TakeScreenshot(
 	uint32_t effectIdx,
 	uint32_t passIdx,
 	uint32_t outputIdx
 ) noexcept {
-	assert(effectIdx < _activeEffectDescs.size());
+	assert(effectIdx < _frontendActiveEffectDescs.size());
 
-	if (!co_await _TakeScreenshotImpl(effectIdx, passIdx, outputIdx)) {
+	auto batch = std::make_shared<_ScreenshotBatch>();
+	batch->runId = ScalingWindow::RunId();
+	batch->count = 1;
+	_TakeScreenshot(std::move(batch), effectIdx, passIdx, outputIdx);
+}
+
+void Renderer::TakeScreenshotOfAllPasses(uint32_t effectIdx) noexcept {
+	assert(effectIdx < _frontendActiveEffectDescs.size());
+
+	const std::vector<EffectPassDesc>& passes = _frontendActiveEffectDescs[effectIdx]->passes;
+	const uint32_t passCount = (uint32_t)passes.size();
+
+	auto batch = std::make_shared<_ScreenshotBatch>();
+	batch->runId = ScalingWindow::RunId();
+	for (const EffectPassDesc& pass : passes) {
+		batch->count += (uint32_t)pass.outputs.size();
+	}
+
+	// 每个截图独立执行，它们的回读和编码可以同时进行，全部完成后只显示一个通知
+	for (uint32_t i = 0; i < passCount; ++i) {
+		const uint32_t outputCount = (uint32_t)passes[i].outputs.size();
+		for (uint32_t j = 0; j < outputCount; ++j) {
+			_TakeScreenshot(batch, effectIdx, i, j);
+		}
+	}
+}
+
+static void ShowScreenshotToast(std::vector<std::wstring>& savedFileNames, uint32_t count) noexcept {
+	const ScalingWindow& scalingWindow = ScalingWindow::Get();
+	const uint32_t failedCount = count - (uint32_t)savedFileNames.size();
+
+	if (count == 1) {
+		if (failedCount == 0) {
+			winrt::hstring msg = scalingWindow.GetLocalizedString(L"Message_ScreenshotSaved");
+			scalingWindow.ShowToast(fmt::format(fmt::runtime(std::wstring_view(msg)), savedFileNames[0]));
+		} else {
+			scalingWindow.ShowToast(scalingWindow.GetLocalizedString(L"Message_ScreenshotFailed"));
+		}
+	} else if (failedCount == 0) {
+		// 完成的顺序不确定，序号连续时按文件名排序即可得到第一个和最后一个
+		std::sort(savedFileNames.begin(), savedFileNames.end());
+		winrt::hstring msg = scalingWindow.GetLocalizedString(L"Message_ScreenshotsSaved");
+		scalingWindow.ShowToast(fmt::format(fmt::runtime(std::wstring_view(msg)),
+			count, savedFileNames.front(), savedFileNames.back()));
+	} else {
+		winrt::hstring msg = scalingWindow.GetLocalizedString(L"Message_ScreenshotsFailed");
+		scalingWindow.ShowToast(fmt::format(fmt::runtime(std::wstring_view(msg)), count, failedCount));
+	}
+}
+
+winrt::fire_and_forget Renderer::_TakeScreenshot(
+	std::shared_ptr<_ScreenshotBatch> batch,
+	uint32_t effectIdx,
+	uint32_t passIdx,
+	uint32_t outputIdx
+) noexcept {
+	winrt::DispatcherQueue frontendDispatcher = ScalingWindow::Dispatcher();
+
+	const winrt::hstring fileName = co_await _TakeScreenshotImpl(effectIdx, passIdx, outputIdx);
+	if (fileName.empty()) {
 		Logger::Get().Error("_TakeScreenshotImpl 失败");
-		ScalingWindow::Get().ShowToast(
-			ScalingWindow::Get().GetLocalizedString(L"Message_ScreenshotFailed"));
 	}
+
+	{
+		auto lk = batch->lock.lock_exclusive();
+		if (!fileName.empty()) {
+			batch->savedFileNames.emplace_back(fileName);
+		}
+
+		if (++batch->completedCount < batch->count) {
+			co_return;
+		}
+	}
+
+	// 由最后完成的截图在前端线程显示通知。缩放已结束则不显示
+	if (!co_await winrt::resume_foreground(frontendDispatcher) || batch->runId != ScalingWindow::RunId()) {
+		co_return;
+	}
+
+	ShowScreenshotToast(batch->savedFileNames, batch->count);
 }
 
 void Renderer::_FrontendRender(bool waitForRenderComplete) noexcept {
@@ -394,22 +472,28 @@ const RECT& Renderer::SrcRect() const noexcept {
 }
 
 bool Renderer::_InitFrameSource() noexcept {
-	switch (ScalingWindow::Get().Options().captureMethod) {
-	case CaptureMethod::GraphicsCapture:
-		_frameSource = std::make_unique<GraphicsCaptureFrameSource>();
-		break;
-	case CaptureMethod::DesktopDuplication:
-		_frameSource = std::make_unique<DesktopDuplicationFrameSource>();
-		break;
-	case CaptureMethod::GDI:
-		_frameSource = std::make_unique<GDIFrameSource>();
-		break;
-	case CaptureMethod::DwmSharedSurface:
-		_frameSource = std::make_unique<DwmSharedSurfaceFrameSource>();
-		break;
-	default:
-		Logger::Get().Error("未知的捕获模式");
-		return false;
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	if (!options.frameTraceReplayPath.empty()) {
+		// 回放帧轨迹代替捕获
+		_frameSource = std::make_unique<ReplayFrameSource>();
+	} else {
+		switch (options.captureMethod) {
+		case CaptureMethod::GraphicsCapture:
+			_frameSource = std::make_unique<GraphicsCaptureFrameSource>();
+			break;
+		case CaptureMethod::DesktopDuplication:
+			_frameSource = std::make_unique<DesktopDuplicationFrameSource>();
+			break;
+		case CaptureMethod::GDI:
+			_frameSource = std::make_unique<GDIFrameSource>();
+			break;
+		case CaptureMethod::DwmSharedSurface:
+			_frameSource = std::make_unique<DwmSharedSurfaceFrameSource>();
+			break;
+		default:
+			Logger::Get().Error("未知的捕获模式");
+			return false;
+		}
 	}
 
 	Logger::Get().Info(StrHelper::Concat("当前捕获模式: ", _frameSource->Name()));
@@ -423,7 +507,7 @@ bool Renderer::_InitFrameSource() noexcept {
 	// 由于 DPI 缩放，捕获尺寸和边界矩形尺寸不一定相同
 	D3D11_TEXTURE2D_DESC desc;
 	_frameSource->GetOutput()->GetDesc(&desc);
-	Logger::Get().Info(fmt::format("捕获尺寸: {}x{}", desc.Width, desc.Height));
+	Logger::Get().Info("捕获尺寸: {}x{}", desc.Width, desc.Height);
 
 	return true;
 }
@@ -431,6 +515,7 @@ bool Renderer::_InitFrameSource() noexcept {
 static std::optional<EffectDesc> CompileEffect(
 	const EffectOption& effectOption,
 	bool noFP16,
+	EffectIncludeCache* includeCache = nullptr,
 	bool forceInlineParams = false
 ) noexcept {
 	// 指定效果名
@@ -456,12 +541,12 @@ static std::optional<EffectDesc> CompileEffect(
 
 	bool success = true;
 	uint32_t duration = Measure([&]() {
-		success = !EffectCompiler::Compile(result, compileFlag, &effectOption.parameters);
+		success = !EffectCompiler::Compile(result, compileFlag, &effectOption.parameters, includeCache);
 	});
 
 	if (success) {
-		Logger::Get().Info(fmt::format("编译 {}.hlsl 用时 {} 毫秒",
-			effectOption.name, duration / 1000.0f));
+		Logger::Get().Info("编译 {}.hlsl 用时 {} 毫秒",
+			effectOption.name, duration / 1000.0f);
 		return result;
 	} else {
 		Logger::Get().Error(StrHelper::Concat("编译 ",
@@ -470,6 +555,52 @@ static std::optional<EffectDesc> CompileEffect(
 	}
 }
 
+// 较低的档位只使用第 0 档中它也有的参数，超出它的范围的参数使用它的默认值，否则编译或初始化会失败
+static phmap::flat_hash_map<std::string, float> GetTierParameters(
+	const EffectOption& option,
+	const std::string& tierName,
+	EffectIncludeCache* includeCache
+) noexcept {
+	phmap::flat_hash_map<std::string, float> result;
+	if (option.parameters.empty()) {
+		return result;
+	}
+
+	// 只解析参数
+	EffectDesc desc{ .name = tierName };
+	if (EffectCompiler::Compile(desc, EffectCompilerFlags::NoCompile, nullptr, includeCache)) {
+		// 稍后编译时同样会失败
+		return result;
+	}
+
+	for (const EffectParameterDesc& paramDesc : desc.params) {
+		auto it = option.parameters.find(paramDesc.name);
+		if (it == option.parameters.end()) {
+			continue;
+		}
+
+		bool isValid;
+		if (paramDesc.constant.index() == 0) {
+			const EffectConstant<float>& constant = std::get<0>(paramDesc.constant);
+			isValid = it->second >= constant.minValue && it->second <= constant.maxValue;
+		} else {
+			const EffectConstant<int>& constant = std::get<1>(paramDesc.constant);
+			const int value = (int)std::lroundf(it->second);
+			isValid = value >= constant.minValue && value <= constant.maxValue;
+		}
+
+		if (isValid) {
+			result.emplace(paramDesc.name, it->second);
+		}
+	}
+
+	return result;
+}
+
+const EffectOption& Renderer::_GetTierOption(uint32_t effectIdx, uint32_t tier) const noexcept {
+	return tier == 0 ? ScalingWindow::Get().Options().effects[effectIdx] : _lowerTierOptions[effectIdx][tier - 1];
+}
+
 ID3D11Texture2D* Renderer::_BuildEffects() noexcept {
 	const ScalingOptions& options = ScalingWindow::Get().Options();
 	const bool noFP16 = !_backendResources.IsFP16Supported() || options.IsFP16Disabled();
@@ -478,33 +609,97 @@ ID3D11Texture2D* Renderer::_BuildEffects() noexcept {
 	assert(!effects.empty());
 	const uint32_t effectCount = (uint32_t)effects.size();
 
+	// 自动调整质量时同时编译所有较低的档位，它们的 EffectDrawer 在第一次降档时才创建
+	const bool isAdaptiveQuality = options.IsAdaptiveQuality() && !options.IsBenchmarkMode();
+	// (效果索引, 档位 - 1)
+	SmallVector<std::pair<uint32_t, uint32_t>> tierTasks;
+	_lowerTierDescs.clear();
+	_lowerTierDescs.resize(effectCount);
+	_lowerTierOptions.clear();
+	_lowerTierOptions.resize(effectCount);
+	if (isAdaptiveQuality) {
+		for (uint32_t i = 0; i < effectCount; ++i) {
+			std::span<const std::string_view> lowerTiers = QualityController::GetLowerTiers(effects[i].name);
+			_lowerTierDescs[i].resize(lowerTiers.size());
+			_lowerTierOptions[i].resize(lowerTiers.size());
+
+			for (uint32_t j = 0; j < (uint32_t)lowerTiers.size(); ++j) {
+				tierTasks.emplace_back(i, j);
+
+				// 输出尺寸和第 0 档相同，参数在编译时确定
+				EffectOption& tierOption = _lowerTierOptions[i][j];
+				tierOption.name = lowerTiers[j];
+				tierOption.scalingType = effects[i].scalingType;
+				tierOption.scale = effects[i].scale;
+			}
+		}
+	}
+
 	// 并行编译所有效果
 	_effectDescs.resize(effects.size());
 	bool anyFailure = false;
+	// 编译失败的档位及其后的档位都不使用
+	SmallVector<uint32_t> tierCounts(effectCount, std::numeric_limits<uint32_t>::max());
 	wil::srwlock writeLock;
+	// 档位排在效果之后，有效果编译失败时取消尚未开始的编译
+	TaskGroup compileGroup(TaskPriority::Interactive);
+	// 各效果和档位常包含相同的文件
+	EffectIncludeCache includeCache;
 	
 	int duration = Measure([&]() {
-		Win32Helper::RunParallel([&](uint32_t id) {
-			std::optional<EffectDesc> desc = CompileEffect(effects[id], noFP16);
+		ThreadPool::Get().ParallelFor(compileGroup, effectCount + (uint32_t)tierTasks.size(), 1, [&](uint32_t id) {
+			if (id >= effectCount) {
+				const auto [effectIdx, tierIdx] = tierTasks[id - effectCount];
+				// 各任务只写入自己的 EffectOption
+				EffectOption& tierOption = _lowerTierOptions[effectIdx][tierIdx];
+				tierOption.parameters = GetTierParameters(effects[effectIdx], tierOption.name, &includeCache);
+				std::optional<EffectDesc> desc = CompileEffect(tierOption, noFP16, &includeCache);
+
+				auto lk = writeLock.lock_exclusive();
+				if (desc) {
+					_lowerTierDescs[effectIdx][tierIdx] = std::move(*desc);
+				} else {
+					tierCounts[effectIdx] = std::min(tierCounts[effectIdx], tierIdx + 1);
+				}
+				return;
+			}
+
+			std::optional<EffectDesc> desc = CompileEffect(effects[id], noFP16, &includeCache);
 
 			auto lk = writeLock.lock_exclusive();
 			if (desc) {
 				_effectDescs[id] = std::move(*desc);
 			} else {
 				anyFailure = true;
+				compileGroup.Cancel();
 			}
-		}, effectCount);
+		});
 	});
 
 	if (anyFailure) {
 		return nullptr;
 	}
 
-	if (effectCount > 1) {
-		Logger::Get().Info(fmt::format("编译着色器总计用时 {} 毫秒", duration / 1000.0f));
+	if (effectCount > 1 || !tierTasks.empty()) {
+		Logger::Get().Info("编译着色器总计用时 {} 毫秒", duration / 1000.0f);
+	}
+
+	for (uint32_t i = 0; i < effectCount; ++i) {
+		if (tierCounts[i] <= _lowerTierDescs[i].size()) {
+			Logger::Get().Warn("效果#{} ({}) 只能使用前 {} 个档位",
+				i, effects[i].name, tierCounts[i]);
+			_lowerTierDescs[i].resize(tierCounts[i] - 1);
+		}
 	}
 
 	_effectDrawers.resize(effectCount);
+	_tierDrawers.clear();
+	_tierDrawers.resize(effectCount);
+	for (uint32_t i = 0; i < effectCount; ++i) {
+		if (!_lowerTierDescs[i].empty()) {
+			_tierDrawers[i].resize(_lowerTierDescs[i].size() + 1);
+		}
+	}
 
 	ID3D11Texture2D* inOutTexture = _frameSource->GetOutput();
 	for (uint32_t i = 0; i < effectCount; ++i) {
@@ -515,11 +710,11 @@ ID3D11Texture2D* Renderer::_BuildEffects() noexcept {
 			_backendDescriptorStore,
 			&inOutTexture
 		)) {
-			Logger::Get().Error(fmt::format("初始化效果#{} ({}) 失败", i, effects[i].name));
+			Logger::Get().Error("初始化效果#{} ({}) 失败", i, effects[i].name);
 			return nullptr;
 		}
 
-		// 释放 CSO 内存，不再需要它们
+		// 着色器已创建，释放 CSO 内存。第 0 档的 EffectDrawer 不会被释放，较低档位的 CSO 则需保留
 		for (EffectPassDesc& passDesc : _effectDescs[i].passes) {
 			passDesc.cso = nullptr;
 		}
@@ -533,24 +728,30 @@ ID3D11Texture2D* Renderer::_BuildEffects() noexcept {
 	}
 
 	_UpdateActiveEffectDescs();
+	// 前端正在等待初始化完成
+	_frontendActiveEffectDescs = _activeEffectDescs;
 
-	// 初始化所有效果共用的动态常量缓冲区
-	for (const EffectDesc& effectDesc : _effectDescs) {
-		if (effectDesc.flags & EffectFlags::UseDynamic) {
-			D3D11_BUFFER_DESC bd{
-				.ByteWidth = 16,	// 只用 4 个字节
-				.Usage = D3D11_USAGE_DYNAMIC,
-				.BindFlags = D3D11_BIND_CONSTANT_BUFFER,
-				.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
-			};
+	// 初始化所有效果共用的动态常量缓冲区，切换档位后才使用的效果也要考虑
+	bool useDynamic = false;
+	for (uint32_t i = 0; i < effectCount; ++i) {
+		useDynamic |= bool(_effectDescs[i].flags & EffectFlags::UseDynamic);
+		for (const EffectDesc& tierDesc : _lowerTierDescs[i]) {
+			useDynamic |= bool(tierDesc.flags & EffectFlags::UseDynamic);
+		}
+	}
 
-			HRESULT hr = _backendResources.GetD3DDevice()->CreateBuffer(&bd, nullptr, _dynamicCB.put());
-			if (FAILED(hr)) {
-				Logger::Get().ComError("CreateBuffer 失败", hr);
-				return nullptr;
-			}
+	if (useDynamic) {
+		D3D11_BUFFER_DESC bd{
+			.ByteWidth = 16,	// 只用 4 个字节
+			.Usage = D3D11_USAGE_DYNAMIC,
+			.BindFlags = D3D11_BIND_CONSTANT_BUFFER,
+			.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
+		};
 
-			break;
+		HRESULT hr = _backendResources.GetD3DDevice()->CreateBuffer(&bd, nullptr, _dynamicCB.put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateBuffer 失败", hr);
+			return nullptr;
 		}
 	}
 
@@ -564,7 +765,7 @@ void Renderer::_UpdateActiveEffectDescs() noexcept {
 	_activeEffectDescs.resize(drawerCount);
 
 	for (uint32_t i = 0; i < effectCount; ++i) {
-		_activeEffectDescs[i] = &_effectDescs[i];
+		_activeEffectDescs[i] = &_GetTierDesc(i, _qualityController.GetTier(i));
 	}
 
 	if (drawerCount > effectCount) {
@@ -605,7 +806,7 @@ bool Renderer::_AppendBicubic(ID3D11Texture2D** inOutTexture) noexcept {
 
 	if (bicubicDesc.name.empty()) {
 		// 参数不会改变，因此可以内联
-		std::optional<EffectDesc> desc = CompileEffect(bicubicOption, true, true);
+		std::optional<EffectDesc> desc = CompileEffect(bicubicOption, true, nullptr, true);
 		if (!desc) {
 			Logger::Get().Error("编译降采样效果失败");
 			return false;
@@ -637,15 +838,35 @@ ID3D11Texture2D* Renderer::_ResizeEffects() noexcept {
 
 	ID3D11Texture2D* inOutTexture = _frameSource->GetOutput();
 	for (uint32_t i = 0; i < effectCount; ++i) {
+		ID3D11Texture2D* inputTexture = inOutTexture;
 		if (!_effectDrawers[i].ResizeTextures(
-			_effectDescs[i],
-			effects[i],
+			*_activeEffectDescs[i],
+			_GetTierOption(i, _qualityController.GetTier(i)),
 			_backendResources,
 			&inOutTexture
 		)) {
-			Logger::Get().Error(fmt::format("更改效果#{} ({}) 尺寸失败", i, effects[i].name));
+			Logger::Get().Error("更改效果#{} ({}) 尺寸失败", i, effects[i].name);
 			return nullptr;
 		}
+
+		// 保留的其他档位也要更改尺寸，切换档位时才能直接替换
+		for (uint32_t tier = 0; tier < (uint32_t)_tierDrawers[i].size(); ++tier) {
+			std::optional<EffectDrawer>& tierDrawer = _tierDrawers[i][tier];
+			if (!tierDrawer) {
+				continue;
+			}
+
+			ID3D11Texture2D* tierTexture = inputTexture;
+			if (!tierDrawer->ResizeTextures(
+				_GetTierDesc(i, tier),
+				_GetTierOption(i, tier),
+				_backendResources,
+				&tierTexture
+			)) {
+				Logger::Get().Error("更改效果#{} ({}) 第 {} 档的尺寸失败", i, effects[i].name, tier);
+				return nullptr;
+			}
+		}
 	}
 
 	// 处理追加的 Bicubic
@@ -683,6 +904,8 @@ ID3D11Texture2D* Renderer::_ResizeEffects() noexcept {
 
 	if (changed) {
 		_UpdateActiveEffectDescs();
+		// 前端正在等待
+		_frontendActiveEffectDescs = _activeEffectDescs;
 		_overlayDrawer.UpdateAfterActiveEffectsChanged();
 
 		if (_effectsProfiler.IsProfiling()) {
@@ -692,11 +915,111 @@ ID3D11Texture2D* Renderer::_ResizeEffects() noexcept {
 			}
 			_effectsProfiler.SetPassCount(_backendResources.GetD3DDevice(), passCount);
 		}
+
+		_qualityProfiler.SetPassCount(_backendResources.GetD3DDevice(), (uint32_t)_effectDrawers.size());
 	}
 
 	return inOutTexture;
 }
 
+// 在后端线程两帧之间执行
+bool Renderer::_ApplyQualityTier(uint32_t effectIdx, uint32_t tier) noexcept {
+	const EffectDesc& desc = _GetTierDesc(effectIdx, tier);
+	std::optional<EffectDrawer>& newDrawer = _tierDrawers[effectIdx][tier];
+
+	// 前一个效果切换过档位时输入已改变，尺寸和格式不变，只需重新绑定
+	ID3D11Texture2D* inputTexture = effectIdx == 0 ?
+		_frameSource->GetOutput() : _effectDrawers[effectIdx - 1].GetOutputTexture();
+
+	bool succeeded;
+	if (newDrawer) {
+		succeeded = newDrawer->GetTexture(0) == inputTexture || newDrawer->ReplaceInputTexture(desc, inputTexture);
+		if (!succeeded) {
+			Logger::Get().Error("ReplaceInputTexture 失败");
+		}
+	} else {
+		// 第一次降到这个档位
+		ID3D11Texture2D* inOutTexture = inputTexture;
+		succeeded = newDrawer.emplace().Initialize(
+			desc,
+			_GetTierOption(effectIdx, tier),
+			_backendResources,
+			_backendDescriptorStore,
+			&inOutTexture
+		);
+		if (!succeeded) {
+			Logger::Get().Error("初始化效果 {} 失败", desc.name);
+		}
+	}
+
+	if (succeeded) {
+		// 输出必须可以直接替换原来的输出
+		D3D11_TEXTURE2D_DESC oldDesc;
+		_effectDrawers[effectIdx].GetOutputTexture()->GetDesc(&oldDesc);
+		D3D11_TEXTURE2D_DESC newDesc;
+		newDrawer->GetOutputTexture()->GetDesc(&newDesc);
+
+		succeeded = oldDesc.Width == newDesc.Width && oldDesc.Height == newDesc.Height &&
+			oldDesc.Format == newDesc.Format;
+		if (!succeeded) {
+			Logger::Get().Error("{} 的输出和 {} 不兼容", desc.name, _activeEffectDescs[effectIdx]->name);
+		}
+	}
+
+	if (succeeded && effectIdx + 1 < _effectDrawers.size()) {
+		succeeded = _effectDrawers[effectIdx + 1].ReplaceInputTexture(
+			*_activeEffectDescs[effectIdx + 1], newDrawer->GetOutputTexture());
+		if (!succeeded) {
+			Logger::Get().Error("ReplaceInputTexture 失败");
+			// 恢复原来的输入
+			_effectDrawers[effectIdx + 1].ReplaceInputTexture(
+				*_activeEffectDescs[effectIdx + 1], _effectDrawers[effectIdx].GetOutputTexture());
+		}
+	}
+
+	const uint32_t oldTier = _qualityController.GetTier(effectIdx);
+
+	if (succeeded) {
+		Logger::Get().Info("效果#{} 由 {} 切换为 {}",
+			effectIdx, _activeEffectDescs[effectIdx]->name, desc.name);
+
+		if (tier > oldTier) {
+			// 降档时保留原来的 EffectDrawer，以便切换回来
+			_tierDrawers[effectIdx][oldTier] = std::move(_effectDrawers[effectIdx]);
+		}
+		// 升档说明有余量，释放较低的档位，再次需要时重新创建
+		_effectDrawers[effectIdx] = std::move(*newDrawer);
+		newDrawer.reset();
+		_activeEffectDescs[effectIdx] = &desc;
+
+		if (_effectsProfiler.IsProfiling()) {
+			uint32_t passCount = 0;
+			for (const EffectDesc* activeDesc : _activeEffectDescs) {
+				passCount += (uint32_t)activeDesc->passes.size();
+			}
+			_effectsProfiler.SetPassCount(_backendResources.GetD3DDevice(), passCount);
+			// 丢弃通道数不匹配的结果
+			_effectsProfiler.GetTimings();
+		}
+
+		// 无需等待前端
+		ScalingWindow::Dispatcher().TryEnqueue(
+			[this, runId(ScalingWindow::RunId()), activeEffectDescs(_activeEffectDescs)]() {
+			if (runId == ScalingWindow::RunId()) {
+				_frontendActiveEffectDescs = activeEffectDescs;
+				_overlayDrawer.UpdateAfterActiveEffectsChanged();
+			}
+		});
+	} else if (tier > oldTier) {
+		// 不会再切换到这个档位
+		newDrawer.reset();
+	}
+
+	_qualityController.OnTierSwitched(
+		std::chrono::steady_clock::now().time_since_epoch(), effectIdx, tier, succeeded);
+	return succeeded;
+}
+
 void Renderer::_UpdateDestRect() noexcept {
 	const RECT& rendererRect = ScalingWindow::Get().RendererRect();
 
@@ -861,10 +1184,12 @@ HANDLE Renderer::_InitBackend() noexcept {
 		return NULL;
 	}
 
+	// 自动调整质量时需要屏幕刷新率作为渲染时间的预算
+	uint32_t refreshRate = 0;
 	{
 		std::optional<float> maxFrameRate;
-		if (_frameSource->WaitType() == FrameSourceWaitType::NoWait) {
-			// 某些捕获方式不会限制捕获帧率，因此将捕获帧率限制为屏幕刷新率
+		if (_frameSource->WaitType() == FrameSourceWaitType::NoWait ||
+			ScalingWindow::Get().Options().IsAdaptiveQuality()) {
 			const HWND hwndSrc = ScalingWindow::Get().SrcTracker().Handle();
 			if (HMONITOR hMon = MonitorFromWindow(hwndSrc, MONITOR_DEFAULTTONEAREST)) {
 				MONITORINFOEX mi{ { sizeof(MONITORINFOEX) } };
@@ -874,12 +1199,17 @@ HANDLE Renderer::_InitBackend() noexcept {
 				EnumDisplaySettings(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm);
 
 				if (dm.dmDisplayFrequency > 0) {
-					Logger::Get().Info(fmt::format("屏幕刷新率: {}", dm.dmDisplayFrequency));
-					maxFrameRate = float(dm.dmDisplayFrequency);
+					Logger::Get().Info("屏幕刷新率: {}", dm.dmDisplayFrequency);
+					refreshRate = dm.dmDisplayFrequency;
 				}
 			}
 		}
 
+		if (refreshRate > 0 && _frameSource->WaitType() == FrameSourceWaitType::NoWait) {
+			// 某些捕获方式不会限制捕获帧率，因此将捕获帧率限制为屏幕刷新率
+			maxFrameRate = float(refreshRate);
+		}
+
 		const ScalingOptions& options = ScalingWindow::Get().Options();
 		if (options.maxFrameRate) {
 			if (!maxFrameRate || *options.maxFrameRate < *maxFrameRate) {
@@ -891,7 +1221,8 @@ HANDLE Renderer::_InitBackend() noexcept {
 		// 和无限大效果相同。
 		const float minFrameRate = options.IsBenchmarkMode()
 			? std::numeric_limits<float>::max() : options.minFrameRate;
-		_stepTimer.Initialize(minFrameRate, maxFrameRate);
+		_stepTimer.Initialize(minFrameRate, maxFrameRate,
+			options.IsFramePacing() && !options.IsBenchmarkMode());
 	}
 
 	ID3D11Texture2D* outputTexture = _BuildEffects();
@@ -899,6 +1230,26 @@ HANDLE Renderer::_InitBackend() noexcept {
 		return NULL;
 	}
 
+	if (std::any_of(_lowerTierDescs.begin(), _lowerTierDescs.end(),
+		[](const std::vector<EffectDesc>& descs) { return !descs.empty(); })) {
+		// 限制了帧率时以帧率为准，否则以屏幕刷新率为准
+		std::chrono::nanoseconds frameBudget = _stepTimer.MinInterval();
+		if (frameBudget.count() == 0 && refreshRate > 0) {
+			frameBudget = std::chrono::nanoseconds(1'000'000'000 / refreshRate);
+		}
+
+		if (frameBudget.count() > 0) {
+			SmallVector<uint32_t> tierCounts;
+			for (const std::vector<EffectDesc>& descs : _lowerTierDescs) {
+				tierCounts.push_back((uint32_t)descs.size() + 1);
+			}
+			_qualityController.Initialize(frameBudget, tierCounts);
+			_qualityProfiler.Start(d3dDevice, (uint32_t)_effectDrawers.size());
+		} else {
+			Logger::Get().Warn("无法确定帧率，已禁用自动调整质量");
+		}
+	}
+
 	HRESULT hr = d3dDevice->CreateFence(
 		_fenceValue, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(&_d3dFence));
 	if (FAILED(hr)) {
@@ -942,11 +1293,14 @@ void Renderer::_BackendRender(ID3D11Texture2D* effectsOutput) noexcept {
 	}
 
 	_effectsProfiler.OnBeginEffects(d3dDC);
+	_qualityProfiler.OnBeginEffects(d3dDC);
 
 	for (const EffectDrawer& effectDrawer : _effectDrawers) {
 		effectDrawer.Draw(_effectsProfiler);
+		_qualityProfiler.OnEndPass(d3dDC);
 	}
 
+	_qualityProfiler.OnEndEffects(d3dDC);
 	_effectsProfiler.OnEndEffects(d3dDC);
 
 	HRESULT hr = d3dDC->Signal(_d3dFence.get(), ++_fenceValue);
@@ -969,6 +1323,20 @@ void Renderer::_BackendRender(ID3D11Texture2D* effectsOutput) noexcept {
 	// 查询效果的渲染时间
 	_effectsProfiler.QueryTimings(d3dDC);
 
+	if (_qualityController.IsEnabled()) {
+		_qualityProfiler.QueryTimings(d3dDC);
+
+		uint32_t effectIdx = 0;
+		uint32_t tier = 0;
+		if (_qualityController.Update(std::chrono::steady_clock::now().time_since_epoch(),
+			_qualityProfiler.GetTimings(), effectIdx, tier)) {
+			// 下一帧开始前切换
+			_backendThreadDispatcher.TryEnqueue([this, effectIdx, tier]() {
+				_ApplyQualityTier(effectIdx, tier);
+			});
+		}
+	}
+
 	// 渲染完成后再更新 _sharedTextureMutexKey，否则前端必须等待，降低光标流畅度
 	const uint64_t key = ++_sharedTextureMutexKey;
 	hr = _backendSharedTextureMutex->AcquireSync(key - 1, INFINITE);
@@ -1053,7 +1421,7 @@ winrt::IAsyncAction Renderer::_UpdateNextScreenshotNum(const wchar_t* imgFormat)
 	}
 }
 
-winrt::IAsyncOperation<bool> Renderer::_TakeScreenshotImpl(
+winrt::IAsyncOperation<winrt::hstring> Renderer::_TakeScreenshotImpl(
 	uint32_t effectIdx,
 	uint32_t passIdx,
 	uint32_t outputIdx
@@ -1076,6 +1444,12 @@ winrt::IAsyncOperation<bool> Renderer::_TakeScreenshotImpl(
 	} else {
 		const std::vector<EffectPassDesc>& passes = _activeEffectDescs[effectIdx]->passes;
 		const uint32_t passCount = (uint32_t)passes.size();
+		if (passIdx >= passCount || (outputIdx != std::numeric_limits<uint32_t>::max() &&
+			outputIdx >= passes[passIdx].outputs.size())) {
+			// 前端请求截图后切换了档位
+			Logger::Get().Error("通道或输出不存在");
+			co_return {};
+		}
 
 		const SmallVector<uint32_t>& outputs = passes[passIdx].outputs;
 		// 只有一个输出时才允许不提供 outputIdx
@@ -1103,11 +1477,10 @@ winrt::IAsyncOperation<bool> Renderer::_TakeScreenshotImpl(
 	// 读取纹理数据时 _screenshotNum 有被并发修改的可能，把当前值保存到本地
 	const uint32_t screenshotNum = _screenshotNum;
 
-	ID3D11Device5* d3dDevice = _backendResources.GetD3DDevice();
 	ID3D11DeviceContext4* d3dDC = _backendResources.GetD3DDC();
 
 	if (isOverwritten) {
-		// 重新渲染
+		// 重新渲染。之后的复制在 GPU 上按顺序执行，因此无需等待渲染完成
 		d3dDC->ClearState();
 
 		if (ID3D11Buffer* t = _dynamicCB.get()) {
@@ -1117,98 +1490,142 @@ winrt::IAsyncOperation<bool> Renderer::_TakeScreenshotImpl(
 		_effectDrawers[effectIdx].DrawForExport(*_activeEffectDescs[effectIdx], passIdx);
 	}
 
-	// 创建 staging 纹理
 	D3D11_TEXTURE2D_DESC desc;
 	sourceTex->GetDesc(&desc);
-	desc.Usage = D3D11_USAGE_STAGING;
-	desc.BindFlags = 0;
-	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-	desc.MiscFlags = 0;
 
-	winrt::com_ptr<ID3D11Texture2D> stagingTex;
-	HRESULT hr = d3dDevice->CreateTexture2D(
-		&desc, nullptr, stagingTex.put());
-	if (FAILED(hr)) {
-		Logger::Get().ComError("CreateTexture2D 失败", hr);
-		co_return false;
+	winrt::com_ptr<ID3D11Texture2D> stagingTex = _AcquireScreenshotStagingTexture(desc);
+	if (!stagingTex) {
+		Logger::Get().Error("_AcquireScreenshotStagingTexture 失败");
+		co_return {};
 	}
 
 	d3dDC->CopyResource(stagingTex.get(), sourceTex);
-	
-	// 如果要导出的纹理不会被覆盖则转到后台等待 GPU 以防止卡顿
-	if (!isOverwritten) {
-		// 为避免混乱，使用独立的栅栏
-		winrt::com_ptr<ID3D11Fence> localFence;
-		wil::unique_event_nothrow localFenceEvent;
-
-		hr = d3dDevice->CreateFence(
-			0, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(&localFence));
-		if (FAILED(hr)) {
-			Logger::Get().ComError("CreateFence 失败", hr);
-			co_return false;
-		}
 
-		if (!localFenceEvent.try_create(wil::EventOptions::None, nullptr)) {
+	// 等待 GPU 完成复制后再 Map，防止阻塞后端线程。每个截图使用独立的事件，因此可以同时
+	// 进行多个截图，栅栏则和渲染共用
+	{
+		wil::unique_event_nothrow copyCompletedEvent;
+		if (!copyCompletedEvent.try_create(wil::EventOptions::None, nullptr)) {
 			Logger::Get().Win32Error("CreateEvent 失败");
-			co_return false;
+			co_return {};
 		}
 
-		hr = d3dDC->Signal(localFence.get(), 1);
+		const uint64_t fenceValue = ++_fenceValue;
+		HRESULT hr = d3dDC->Signal(_d3dFence.get(), fenceValue);
 		if (FAILED(hr)) {
 			Logger::Get().ComError("Signal 失败", hr);
-			co_return false;
+			co_return {};
 		}
 
-		hr = localFence->SetEventOnCompletion(1, localFenceEvent.get());
+		hr = _d3dFence->SetEventOnCompletion(fenceValue, copyCompletedEvent.get());
 		if (FAILED(hr)) {
 			Logger::Get().ComError("SetEventOnCompletion 失败", hr);
-			co_return false;
+			co_return {};
 		}
 
 		d3dDC->Flush();
 
 		winrt::DispatcherQueue dispatcher = _backendThreadDispatcher;
-		co_await winrt::resume_background();
-		localFenceEvent.wait();
-		co_await dispatcher;
+		co_await winrt::resume_on_signal(copyCompletedEvent.get());
+		if (!co_await winrt::resume_foreground(dispatcher)) {
+			// 缩放已结束，后端线程已退出，不能再访问 this。staging 纹理随协程释放，也不会显示通知
+			Logger::Get().Info("缩放已结束，取消截图");
+			co_return {};
+		}
 	}
 
-	// 读取纹理数据到内存。isOverwritten 为真时这个调用将阻塞 CPU
+	// GPU 已完成复制，不会阻塞
 	D3D11_MAPPED_SUBRESOURCE mapped;
-	hr = d3dDC->Map(stagingTex.get(), 0, D3D11_MAP_READ, 0, &mapped);
+	HRESULT hr = d3dDC->Map(stagingTex.get(), 0, D3D11_MAP_READ, 0, &mapped);
 	if (FAILED(hr)) {
 		Logger::Get().ComError("Map 失败", hr);
-		co_return false;
+		_ReleaseScreenshotStagingTexture(std::move(stagingTex));
+		co_return {};
 	}
 
-	std::vector<uint8_t> pixelData(size_t(mapped.RowPitch) * desc.Height);
-	std::memcpy(pixelData.data(), mapped.pData, pixelData.size());
+	// 复制出像素数据后立即 Unmap，staging 纹理可以马上被下一次截图重用。编码在后台进行，
+	// 在此期间后端线程可以继续渲染，其他截图也可以同时编码。
+	const uint32_t rowSize = uint32_t((desc.Width * DDSFormat::BitsPerPixel(desc.Format) + 7) / 8);
+	std::vector<uint8_t> pixelData((size_t)rowSize * desc.Height);
+	if (rowSize == mapped.RowPitch) {
+		std::memcpy(pixelData.data(), mapped.pData, pixelData.size());
+	} else {
+		for (uint32_t y = 0; y < desc.Height; ++y) {
+			std::memcpy(pixelData.data() + (size_t)rowSize * y,
+				(const uint8_t*)mapped.pData + (size_t)mapped.RowPitch * y, rowSize);
+		}
+	}
 
 	d3dDC->Unmap(stagingTex.get(), 0);
+	_ReleaseScreenshotStagingTexture(std::move(stagingTex));
 
+	// 后台线程上不访问 this，缩放可能已经结束
+	std::filesystem::path screenshotsDir = ScalingWindow::Get().Options().screenshotsDir;
 	co_await winrt::resume_background();
 
 	// 确保截图保存目录存在
-	const std::filesystem::path& screenshotsDir = ScalingWindow::Get().Options().screenshotsDir;
 	if (!Win32Helper::CreateDir(screenshotsDir.c_str(), true)) {
 		Logger::Get().Error("CreateDir 失败");
-		co_return false;
+		co_return {};
 	}
 
 	std::wstring fileName = fmt::format(L"Magpie_{:03}.{}", screenshotNum, imgFormat);
-	const std::filesystem::path& fullPath = screenshotsDir / fileName;
+	const std::filesystem::path fullPath = screenshotsDir / fileName;
 
 	if (!TextureHelper::SaveTexture(
-		fullPath.c_str(), desc.Width, desc.Height, format, pixelData, mapped.RowPitch)) {
-		Logger::Get().Error("SaveImage 失败");
-		co_return false;
+		fullPath.c_str(),
+		desc.Width,
+		desc.Height,
+		format,
+		pixelData,
+		rowSize
+	)) {
+		Logger::Get().Error("SaveTexture 失败");
+		co_return {};
+	}
+
+	co_return winrt::hstring(fileName);
+}
+
+winrt::com_ptr<ID3D11Texture2D> Renderer::_AcquireScreenshotStagingTexture(
+	const D3D11_TEXTURE2D_DESC& srcDesc
+) noexcept {
+	// 优先重用尺寸和格式相同的 staging 纹理
+	for (auto it = _screenshotStagingTextures.begin(); it != _screenshotStagingTextures.end(); ++it) {
+		D3D11_TEXTURE2D_DESC desc;
+		(*it)->GetDesc(&desc);
+
+		if (desc.Width == srcDesc.Width && desc.Height == srcDesc.Height && desc.Format == srcDesc.Format) {
+			winrt::com_ptr<ID3D11Texture2D> result = std::move(*it);
+			_screenshotStagingTextures.erase(it);
+			return result;
+		}
 	}
 
-	winrt::hstring successMsg =
-		ScalingWindow::Get().GetLocalizedString(L"Message_ScreenshotSaved");
-	ScalingWindow::Get().ShowToast(
-		fmt::format(fmt::runtime(std::wstring_view(successMsg)), fileName));
-	co_return true;
+	D3D11_TEXTURE2D_DESC desc = srcDesc;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	desc.MiscFlags = 0;
+
+	winrt::com_ptr<ID3D11Texture2D> result;
+	HRESULT hr = _backendResources.GetD3DDevice()->CreateTexture2D(&desc, nullptr, result.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateTexture2D 失败", hr);
+		return nullptr;
+	}
+
+	return result;
+}
+
+void Renderer::_ReleaseScreenshotStagingTexture(winrt::com_ptr<ID3D11Texture2D> stagingTex) noexcept {
+	// 导出所有通道时同时使用的 staging 纹理较多，只保留最近使用的几个
+	static constexpr size_t MAX_POOLED_STAGING_TEXTURES = 4;
+
+	if (_screenshotStagingTextures.size() >= MAX_POOLED_STAGING_TEXTURES) {
+		_screenshotStagingTextures.erase(_screenshotStagingTextures.begin());
+	}
+	_screenshotStagingTextures.push_back(std::move(stagingTex));
 }
 
 // 监听 PrintScreen 实现截屏时隐藏光标
@@ -6,6 +6,7 @@
 #include "EffectsProfiler.h"
 #include "OverlayDrawer.h"
 #include "PresenterBase.h"
+#include "QualityController.h"
 #include "StepTimer.h"
 
 namespace Magpie {
@@ -47,8 +48,9 @@ public:
 
 	void MessageHandler(UINT msg, WPARAM wParam, LPARAM lParam) noexcept;
 
+	// 只能由前台线程访问。后端切换档位后异步更新
 	const std::vector<const EffectDesc*>& ActiveEffectDescs() const noexcept {
-		return _activeEffectDescs;
+		return _frontendActiveEffectDescs;
 	}
 
 	void StartProfile() noexcept;
@@ -59,12 +61,15 @@ public:
 		return _overlayDrawer.IsCursorOnCaptionArea();
 	}
 
-	winrt::fire_and_forget TakeScreenshot(
+	void TakeScreenshot(
 		uint32_t effectIdx,
 		uint32_t passIdx = std::numeric_limits<uint32_t>::max(),
 		uint32_t outputIdx = std::numeric_limits<uint32_t>::max()
 	) noexcept;
 
+	// 导出效果所有通道的输出，完成后只显示一个通知
+	void TakeScreenshotOfAllPasses(uint32_t effectIdx) noexcept;
+
 private:
 	void _FrontendRender(bool waitForRenderComplete = false) noexcept;
 
@@ -84,6 +89,14 @@ private:
 
 	ID3D11Texture2D* _ResizeEffects() noexcept;
 
+	const EffectDesc& _GetTierDesc(uint32_t effectIdx, uint32_t tier) const noexcept {
+		return tier == 0 ? _effectDescs[effectIdx] : _lowerTierDescs[effectIdx][tier - 1];
+	}
+
+	const EffectOption& _GetTierOption(uint32_t effectIdx, uint32_t tier) const noexcept;
+
+	bool _ApplyQualityTier(uint32_t effectIdx, uint32_t tier) noexcept;
+
 	void _UpdateDestRect() noexcept;
 
 	HANDLE _CreateSharedTexture(ID3D11Texture2D* effectsOutput) noexcept;
@@ -94,12 +107,35 @@ private:
 
 	winrt::IAsyncAction _UpdateNextScreenshotNum(const wchar_t* imgFormat) noexcept;
 
-	winrt::IAsyncOperation<bool> _TakeScreenshotImpl(
+	// 一次请求中的所有截图，全部完成后显示一个通知
+	struct _ScreenshotBatch {
+		uint32_t runId = 0;
+		uint32_t count = 0;
+
+		wil::srwlock lock;
+		// 以下成员由 lock 保护
+		uint32_t completedCount = 0;
+		std::vector<std::wstring> savedFileNames;
+	};
+
+	winrt::fire_and_forget _TakeScreenshot(
+		std::shared_ptr<_ScreenshotBatch> batch,
 		uint32_t effectIdx,
 		uint32_t passIdx,
 		uint32_t outputIdx
 	) noexcept;
 
+	// 成功时返回文件名，失败时返回空
+	winrt::IAsyncOperation<winrt::hstring> _TakeScreenshotImpl(
+		uint32_t effectIdx,
+		uint32_t passIdx,
+		uint32_t outputIdx
+	) noexcept;
+
+	winrt::com_ptr<ID3D11Texture2D> _AcquireScreenshotStagingTexture(const D3D11_TEXTURE2D_DESC& srcDesc) noexcept;
+
+	void _ReleaseScreenshotStagingTexture(winrt::com_ptr<ID3D11Texture2D> stagingTex) noexcept;
+
 	static LRESULT CALLBACK _LowLevelKeyboardHook(int nCode, WPARAM wParam, LPARAM lParam);
 
 	// 只能由前台线程访问
@@ -113,6 +149,9 @@ private:
 	winrt::com_ptr<IDXGIKeyedMutex> _frontendSharedTextureMutex;
 	uint64_t _lastAccessMutexKey = 0;
 	RECT _destRect{};
+	// _activeEffectDescs 的副本。初始化和更改尺寸时前端等待后端，由后端直接更新；
+	// 切换档位时后端不等待前端，通过前端的 DispatcherQueue 更新
+	std::vector<const EffectDesc*> _frontendActiveEffectDescs;
 	
 	std::thread _backendThread;
 
@@ -123,9 +162,16 @@ private:
 	Magpie::BackendDescriptorStore _backendDescriptorStore;
 	std::unique_ptr<FrameSourceBase> _frameSource;
 	std::vector<EffectDrawer> _effectDrawers;
+	// _tierDrawers[i][t] 为效果 i 第 t 档的 EffectDrawer。较低的档位在第一次降到它时才创建，
+	// 升档后释放；降档时保留原来的 EffectDrawer，升档时直接交换。当前档位的位置为空，
+	// 它的 EffectDrawer 在 _effectDrawers[i] 中
+	std::vector<std::vector<std::optional<EffectDrawer>>> _tierDrawers;
 
 	StepTimer _stepTimer;
 	EffectsProfiler _effectsProfiler;
+	// 测量每个效果的渲染时间，供 _qualityController 使用
+	EffectsProfiler _qualityProfiler;
+	QualityController _qualityController;
 
 	winrt::com_ptr<ID3D11Fence> _d3dFence;
 	uint64_t _fenceValue = 0;
@@ -137,6 +183,8 @@ private:
 	winrt::com_ptr<ID3D11Buffer> _dynamicCB;
 
 	uint32_t _screenshotNum = 0;
+	// 截图使用的 staging 纹理，在多次截图间重用
+	std::vector<winrt::com_ptr<ID3D11Texture2D>> _screenshotStagingTextures;
 
 	// 可由所有线程访问
 	std::atomic<uint64_t> _sharedTextureMutexKey = 0;
@@ -147,6 +195,10 @@ private:
 	winrt::Windows::System::DispatcherQueue _backendThreadDispatcher{ nullptr };
 	ScalingError _backendInitError = ScalingError::NoError;
 	std::vector<EffectDesc> _effectDescs;
+	// _lowerTierDescs[i] 为 _effectDescs[i] 较低的档位。它们的 CSO 一直保留，以便随时创建 EffectDrawer
+	std::vector<std::vector<EffectDesc>> _lowerTierDescs;
+	// 和 _lowerTierDescs 对应，只包含档位自身也有的参数
+	std::vector<std::vector<EffectOption>> _lowerTierOptions;
 	// 包含追加的 Bicubic
 	std::vector<const EffectDesc*> _activeEffectDescs;
 };
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "ReplayFrameSource.h"
+#include "DeviceResources.h"
+#include "DirectXHelper.h"
+#include "Logger.h"
+#include "ScalingOptions.h"
+#include "ScalingWindow.h"
+#include "StrHelper.h"
+#include "Win32Helper.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+bool ReplayFrameSource::_Initialize() noexcept {
+	const std::filesystem::path& tracePath = ScalingWindow::Get().Options().frameTraceReplayPath;
+	if (!Win32Helper::MapFile(tracePath.c_str(), _traceFile)) {
+		Logger::Get().Error("MapFile 失败");
+		return false;
+	}
+
+	FrameTraceHeader traceHeader;
+	if (!FrameTraceFormat::ReadHeader(_traceFile.Data().data(), _traceFile.Size(), traceHeader)) {
+		Logger::Get().Error("帧轨迹文件无效");
+		return false;
+	}
+
+	_recordCount = FrameTraceFormat::GetRecordCount(_traceFile.Size());
+	if (_recordCount == 0) {
+		Logger::Get().Error("帧轨迹文件中没有记录");
+		return false;
+	}
+
+	const std::filesystem::path contentPath = std::filesystem::path(tracePath).replace_extension(L".mpfc");
+	if (!Win32Helper::MapFile(contentPath.c_str(), _contentFile)) {
+		Logger::Get().Error("MapFile 失败");
+		return false;
+	}
+
+	if (!FrameContentFormat::ReadHeader(_contentFile.Data().data(), _contentFile.Size(), _contentHeader)) {
+		Logger::Get().Error("帧内容文件无效");
+		return false;
+	}
+
+	if (_contentHeader.width != traceHeader.width || _contentHeader.height != traceHeader.height) {
+		Logger::Get().Error("帧内容和帧轨迹的尺寸不匹配");
+		return false;
+	}
+
+	_output = DirectXHelper::CreateTexture2D(
+		_deviceResources->GetD3DDevice(),
+		DXGI_FORMAT_B8G8R8A8_UNORM,
+		_contentHeader.width,
+		_contentHeader.height,
+		D3D11_BIND_SHADER_RESOURCE
+	);
+	if (!_output) {
+		Logger::Get().Error("创建纹理失败");
+		return false;
+	}
+
+	_frame.resize((size_t)_contentHeader.width * _contentHeader.height * 4);
+	_startTime = steady_clock::now();
+
+	Logger::Get().Info(StrHelper::Concat("开始回放帧轨迹: ", StrHelper::UTF16ToUTF8(tracePath.native())));
+	return true;
+}
+
+FrameSourceState ReplayFrameSource::_Update() noexcept {
+	const uint64_t elapsed = (uint64_t)duration_cast<nanoseconds>(steady_clock::now() - _startTime).count();
+
+	// 两次轮询之间到达了多帧时只有最后一帧可见，和捕获时的行为相同
+	bool hasNewFrame = false;
+	uint64_t arrivalTime = 0;
+	while (_nextRecordIdx < _recordCount) {
+		FrameTraceRecord record;
+		FrameTraceFormat::ReadRecord(_traceFile.Data().data() +
+			FrameTraceFormat::HEADER_SIZE + _nextRecordIdx * FrameTraceFormat::RECORD_SIZE, record);
+		if (record.arrivalTime > elapsed) {
+			break;
+		}
+
+		arrivalTime = record.arrivalTime;
+		hasNewFrame = true;
+		++_nextRecordIdx;
+	}
+
+	if (!hasNewFrame) {
+		if (_nextRecordIdx == _recordCount) {
+			// 从头开始。第一帧包含所有块，无需清空 _frame
+			_nextRecordIdx = 0;
+			_nextContentOffset = FrameContentFormat::HEADER_SIZE;
+			_startTime = steady_clock::now();
+		}
+
+		return FrameSourceState::Waiting;
+	}
+
+	_ApplyContent(arrivalTime);
+	return FrameSourceState::NewFrame;
+}
+
+void ReplayFrameSource::_ApplyContent(uint64_t arrivalTime) noexcept {
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+	const std::span<const uint8_t> content = _contentFile.Data();
+	const uint32_t pitch = _contentHeader.width * 4;
+
+	while (true) {
+		const uint8_t* data = content.data() + _nextContentOffset;
+		const size_t size = content.size() - _nextContentOffset;
+
+		uint64_t contentArrivalTime;
+		if (!FrameContentFormat::PeekArrivalTime(data, size, contentArrivalTime) ||
+			contentArrivalTime > arrivalTime) {
+			// 没有更多帧内容，或者属于之后的记录
+			return;
+		}
+
+		// 只上传变化的块
+		const size_t frameSize = FrameContentFormat::DecodeFrame(_contentHeader, data, size, _frame.data(),
+			[&](uint32_t left, uint32_t top, uint32_t width, uint32_t height) {
+				const D3D11_BOX box{ left, top, 0, left + width, top + height, 1 };
+				d3dDC->UpdateSubresource(_output.get(), 0, &box,
+					_frame.data() + (size_t)top * pitch + (size_t)left * 4, pitch, 0);
+			});
+		if (frameSize == 0) {
+			// 录制被中断时最后一帧可能不完整，忽略之后的内容
+			Logger::Get().Warn("帧内容文件不完整");
+			_nextContentOffset = content.size();
+			return;
+		}
+
+		_nextContentOffset += frameSize;
+	}
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "FrameSourceBase.h"
+#include "FrameContentFormat.h"
+#include "FrameTraceFormat.h"
+#include "MappedFile.h"
+
+namespace Magpie {
+
+// 回放 FrameTraceRecorder 录制的帧轨迹和帧内容，代替捕获源窗口。每一帧在录制时的到达时间出现，
+// 重复帧检测、StepTimer 和效果都像捕获时一样运行，因此可以在实验室中复现用户的问题，
+// 调整 DuplicateFrameDetectionMode、帧率限制和效果。到达结尾后从头开始。
+// 录制时被丢弃的重复帧没有帧内容，回放时和上一帧相同。
+class ReplayFrameSource final : public FrameSourceBase {
+public:
+	virtual ~ReplayFrameSource() {}
+
+	FrameSourceWaitType WaitType() const noexcept override {
+		return FrameSourceWaitType::NoWait;
+	}
+
+	const char* Name() const noexcept override {
+		return "Replay";
+	}
+
+protected:
+	bool _Initialize() noexcept override;
+
+	FrameSourceState _Update() noexcept override;
+
+private:
+	// 应用到达时间不晚于 arrivalTime 的帧内容
+	void _ApplyContent(uint64_t arrivalTime) noexcept;
+
+	MappedFile _traceFile;
+	MappedFile _contentFile;
+	FrameContentHeader _contentHeader;
+
+	size_t _recordCount = 0;
+	// 下一条记录的序号
+	size_t _nextRecordIdx = 0;
+	// 下一帧内容在 _contentFile 中的偏移
+	size_t _nextContentOffset = FrameContentFormat::HEADER_SIZE;
+
+	std::chrono::steady_clock::time_point _startTime;
+
+	// 当前帧，上传到 _output 时只上传变化的部分
+	std::vector<uint8_t> _frame;
+};
+
+}
@@ -37,7 +37,7 @@ static std::string LogEffects(const std::vector<EffectOption>& effects) noexcept
 }
 
 void ScalingOptions::Log() const noexcept {
-	Logger::Get().Info(fmt::format(R"(缩放选项
+	Logger::Get().Info(R"(缩放选项
 	IsWindowedMode: {}
 	IsDebugMode: {}
 	IsBenchmarkMode: {}
@@ -47,6 +47,8 @@ void ScalingOptions::Log() const noexcept {
 	IsSaveEffectSources: {}
 	IsWarningsAreErrors: {}
 	IsStatisticsForDynamicDetectionEnabled: {}
+	IsFrameTraceRecordingEnabled: {}
+	IsFrameContentRecordingEnabled: {}
 	IsInlineParams: {}
 	IsTouchSupportEnabled: {}
 	IsAllowScalingMaximized: {}
@@ -55,6 +57,8 @@ void ScalingOptions::Log() const noexcept {
 	IsCaptureTitleBar: {}
 	IsAdjustCursorSpeed: {}
 	IsDirectFlipDisabled: {}
+	IsAdaptiveQuality: {}
+	IsFramePacing: {}
 	cropping: {},{},{},{}
 	graphicsCardId:
 		idx: {}
@@ -70,6 +74,7 @@ void ScalingOptions::Log() const noexcept {
 	fullscreenInitialToolbarState: {}
 	windowedInitialToolbarState: {}
 	screenshotsDir: {}
+	frameTraceReplayPath: {}
 	effects: {})",
 		IsWindowedMode(),
 		IsDebugMode(),
@@ -80,6 +85,8 @@ void ScalingOptions::Log() const noexcept {
 		IsSaveEffectSources(),
 		IsWarningsAreErrors(),
 		IsStatisticsForDynamicDetectionEnabled(),
+		IsFrameTraceRecordingEnabled(),
+		IsFrameContentRecordingEnabled(),
 		IsInlineParams(),
 		IsTouchSupportEnabled(),
 		IsAllowScalingMaximized(),
@@ -88,6 +95,8 @@ void ScalingOptions::Log() const noexcept {
 		IsCaptureTitleBar(),
 		IsAdjustCursorSpeed(),
 		IsDirectFlipDisabled(),
+		IsAdaptiveQuality(),
+		IsFramePacing(),
 		cropping.Left, cropping.Top, cropping.Right, cropping.Bottom,
 		graphicsCardId.idx,
 		graphicsCardId.vendorId,
@@ -102,8 +111,9 @@ void ScalingOptions::Log() const noexcept {
 		(int)fullscreenInitialToolbarState,
 		(int)windowedInitialToolbarState,
 		StrHelper::UTF16ToUTF8(screenshotsDir.native()),
+		StrHelper::UTF16ToUTF8(frameTraceReplayPath.native()),
 		LogEffects(effects)
-	));
+	);
 }
 
 }
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "ScalingRuntime.h"
 #include "CommonSharedConstants.h"
+#include "DeviceResources.h"
 #include "Logger.h"
 #include "ScalingWindow.h"
 #include "Win32Helper.h"
@@ -90,6 +91,12 @@ void ScalingRuntime::Stop() {
 	});
 }
 
+void ScalingRuntime::ReleasePooledDevices() {
+	_Dispatcher().TryEnqueue([]() {
+		DeviceResources::ReleasePooledDevices();
+	});
+}
+
 static std::optional<bool> IsSrcRepositioning(HWND hwndSrc) noexcept {
 	if (!IsWindow(hwndSrc)) {
 		Logger::Get().Info("源窗口已销毁");
@@ -162,6 +169,8 @@ void ScalingRuntime::_ScalingThreadProc() noexcept {
 		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
 			if (msg.message == WM_QUIT) {
 				scalingWindow.Stop();
+				// 保留的设备必须在缩放线程退出前释放，不能留给静态对象的析构，那时 D3D 可能已被卸载
+				DeviceResources::ReleasePooledDevices();
 				return;
 			} else if (msg.message == CommonSharedConstants::WM_FRONTEND_RENDER &&
 				msg.hwnd == scalingWindow.Handle()) {
@@ -211,7 +220,9 @@ void ScalingRuntime::_ScalingThreadProc() noexcept {
 		} else {
 			_State(ScalingState::Idle);
 			lastRenderTime = {};
-			WaitMessage();
+			// 等待消息的同时释放空闲超时的设备
+			MsgWaitForMultipleObjectsEx(0, nullptr,
+				DeviceResources::ReleaseIdlePooledDevices(), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
 		}
 	}
 }
@@ -37,21 +37,21 @@ ScalingWindow::ScalingWindow() noexcept :
 ScalingWindow::~ScalingWindow() noexcept {}
 
 static void LogRects(const RECT& srcRect, const RECT& rendererRect, const RECT& windowRect) noexcept {
-	Logger::Get().Info(fmt::format("源矩形: {},{},{},{} ({}x{})",
+	Logger::Get().Info("源矩形: {},{},{},{} ({}x{})",
 		srcRect.left, srcRect.top, srcRect.right, srcRect.bottom,
-		srcRect.right - srcRect.left, srcRect.bottom - srcRect.top));
+		srcRect.right - srcRect.left, srcRect.bottom - srcRect.top);
 
-	Logger::Get().Info(fmt::format("渲染矩形: {},{},{},{} ({}x{})",
+	Logger::Get().Info("渲染矩形: {},{},{},{} ({}x{})",
 		rendererRect.left, rendererRect.top, rendererRect.right, rendererRect.bottom,
-		rendererRect.right - rendererRect.left, rendererRect.bottom - rendererRect.top));
+		rendererRect.right - rendererRect.left, rendererRect.bottom - rendererRect.top);
 
-	Logger::Get().Info(fmt::format("缩放窗口矩形: {},{},{},{} ({}x{})",
+	Logger::Get().Info("缩放窗口矩形: {},{},{},{} ({}x{})",
 		windowRect.left, windowRect.top, windowRect.right, windowRect.bottom,
-		windowRect.right - windowRect.left, windowRect.bottom - windowRect.top));
+		windowRect.right - windowRect.left, windowRect.bottom - windowRect.top);
 }
 
 ScalingError ScalingWindow::_StartImpl(HWND hwndSrc) noexcept {
-	Logger::Get().Info(fmt::format("缩放开始\n\t程序版本: {}\n\tOS 版本: {}\n\t管理员: {}",
+	Logger::Get().Info("缩放开始\n\t程序版本: {}\n\tOS 版本: {}\n\t管理员: {}",
 #ifdef MP_VERSION_TAG
 		STRING(MP_VERSION_TAG),
 #else
@@ -59,7 +59,7 @@ ScalingError ScalingWindow::_StartImpl(HWND hwndSrc) noexcept {
 #endif
 		Win32Helper::GetOSVersion().ToString<char>(),
 		Win32Helper::IsProcessElevated() ? "是" : "否"
-	));
+	);
 
 #if _DEBUG
 	OutputDebugString(fmt::format(L"可执行文件路径: {}\n窗口类: {}\n",
@@ -1,90 +1,62 @@
 #include "pch.h"
 #include "StepTimer.h"
+#include <dwmapi.h>
 
 using namespace std::chrono;
 
 namespace Magpie {
 
-void StepTimer::Initialize(float minFrameRate, std::optional<float> maxFrameRate) noexcept {
-	assert(minFrameRate >= 0);
-	if (minFrameRate > 0) {
-		_maxInterval = duration_cast<nanoseconds>(duration<float>(1 / minFrameRate));
-	}
-
-	if (maxFrameRate) {
-		assert(*maxFrameRate > 0);
-		_minInterval = duration_cast<nanoseconds>(duration<float>(1 / *maxFrameRate));
-		assert(_minInterval <= _maxInterval);
-
-		if (_HasMaxInterval()) {
-			// 确保最大帧间隔是最小帧间隔的整数倍，这能使帧间隔保持稳定，代价是实际最小帧率可能比要求的稍高一点
-			_maxInterval = _maxInterval / _minInterval * _minInterval;
-		}
-	}
+void StepTimer::Initialize(float minFrameRate, std::optional<float> maxFrameRate, bool enablePacing) noexcept {
+	_policy.Initialize(minFrameRate, maxFrameRate, enablePacing);
 }
 
-// 渲染新帧时以该次循环开始捕获的时间点作为新帧的开始时间，只有这个时间点是我们可以控制的。
-// 下图中的 wait 包括等待最大帧率限制和等待新帧，WaitForNextFrame 在此期间多次执行。
-// PrepareForRender 在 render 开始前执行。
-// 
-// _thisFrameStartTime      _nextFrameStartTime
-//         │                         │
-// ────────▼─────────┬────────┬──────▼─────────
-//    wait │ capture │ render │ wait │ capture
-//
+// 时序见 StepTimerPolicy::Decide
 StepTimerStatus StepTimer::WaitForNextFrame(bool waitMsgForNewFrame, bool& fpsUpdated) noexcept {
 	fpsUpdated = false;
 
-	// 不断更新 _nextFrameStartTime 直到新帧到达
-	_nextFrameStartTime = steady_clock::now();
+	if (_policy.IsCompositionTimingNeeded()) {
+		_UpdateCompositionTiming();
+	}
+
+	const time_point<steady_clock> now = steady_clock::now();
+	const StepTimerPolicy::Decision decision = _policy.Decide(now.time_since_epoch());
 
-	if (_thisFrameStartTime == time_point<steady_clock>{}) {
+	if (_frameCount == 0) {
 		// 等待第一帧，无需更新 FPS
 		if (waitMsgForNewFrame) {
 			WaitMessage();
 		}
 
-		return StepTimerStatus::WaitForNewFrame;
+		return decision.status;
 	}
 
-	// 包括当前帧的捕获时间和渲染时间以及渲染完成后已经等待的时间
-	const nanoseconds delta = _nextFrameStartTime - _thisFrameStartTime;
-
-	if (delta >= _maxInterval) {
-		return StepTimerStatus::ForceNewFrame;
+	if (decision.status == StepTimerStatus::ForceNewFrame) {
+		return decision.status;
 	}
 
 	// 没有新帧也应更新 FPS。作为性能优化，强制帧无需更新，因为 PrepareForRender 必定会执行
-	fpsUpdated = _UpdateFPS(_nextFrameStartTime);
+	fpsUpdated = _UpdateFPS(now);
 
-	if (delta < _minInterval) {
-		_WaitForMsgAndTimer(_minInterval - delta);
-		return StepTimerStatus::WaitForFPSLimiter;
+	if (decision.status == StepTimerStatus::WaitForFPSLimiter) {
+		_WaitForMsgAndTimer(decision.waitTime);
+		return decision.status;
 	}
 
 	// 有的捕获方法当有新帧时会有消息到达
 	if (waitMsgForNewFrame) {
-		if (_HasMaxInterval()) {
-			_WaitForMsgAndTimer(_maxInterval - delta);
+		if (decision.waitTime != StepTimerPolicy::INFINITE_WAIT) {
+			_WaitForMsgAndTimer(decision.waitTime);
 		} else {
 			// 没有最小帧率限制则只需等待消息。为了及时更新 FPS，每次等待 500ms
 			MsgWaitForMultipleObjectsEx(0, nullptr, 500, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
 		}
 	}
 
-	return StepTimerStatus::WaitForNewFrame;
+	return decision.status;
 }
 
 void StepTimer::PrepareForRender() noexcept {
-	// 进入新一帧，计算此帧的开始时间
-	if (_HasMinInterval()) {
-		// 限制最大帧率时帧间隔必须是最小帧间隔的整数倍，_nextFrameStartTime 需要稍微向前修正。
-		// 出于同样的原因，最大帧间隔应是最小帧间隔的整数倍。
-		_thisFrameStartTime = _nextFrameStartTime -
-			(_nextFrameStartTime - _thisFrameStartTime) % _minInterval;
-	} else {
-		_thisFrameStartTime = _nextFrameStartTime;
-	}
+	_policy.OnRender();
 
 	++_framesThisSecond;
 	++_frameCount;
@@ -135,12 +107,28 @@ bool StepTimer::_UpdateFPS(time_point<steady_clock> now) noexcept {
 	return changed;
 }
 
-bool StepTimer::_HasMinInterval() const noexcept {
-	return _minInterval.count() != 0;
-}
+void StepTimer::_UpdateCompositionTiming() noexcept {
+	DWM_TIMING_INFO info{};
+	info.cbSize = sizeof(info);
+	if (FAILED(DwmGetCompositionTimingInfo(NULL, &info)) || info.qpcRefreshPeriod == 0) {
+		return;
+	}
 
-bool StepTimer::_HasMaxInterval() const noexcept {
-	return _maxInterval.count() != std::numeric_limits<nanoseconds::rep>::max();
+	LARGE_INTEGER qpc;
+	QueryPerformanceCounter(&qpc);
+	const nanoseconds now = steady_clock::now().time_since_epoch();
+
+	LARGE_INTEGER qpf;
+	QueryPerformanceFrequency(&qpf);
+	auto toNanoseconds = [&](int64_t ticks) {
+		return nanoseconds(ticks * 1'000'000'000 / qpf.QuadPart);
+	};
+
+	// 不假设 steady_clock 和 QPC 的起点相同，从当前时间推算合成时间
+	_policy.Pacer().SetCompositionTiming(
+		now + toNanoseconds((int64_t)info.qpcCompose - qpc.QuadPart),
+		toNanoseconds((int64_t)info.qpcRefreshPeriod)
+	);
 }
 
 }
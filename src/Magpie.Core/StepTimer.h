@@ -1,13 +1,9 @@
 #pragma once
+#include "StepTimerPolicy.h"
 
 namespace Magpie {
 
-enum class StepTimerStatus {
-	WaitForNewFrame,
-	WaitForFPSLimiter,
-	ForceNewFrame
-};
-
+// 决策由 StepTimerPolicy 完成，这里负责读取时钟、等待以及统计 FPS
 class StepTimer {
 public:
 	StepTimer() = default;
@@ -15,7 +11,8 @@ public:
 	StepTimer(const StepTimer&) = delete;
 	StepTimer(StepTimer&&) = delete;
 
-	void Initialize(float minFrameRate, std::optional<float> maxFrameRate) noexcept;
+	// enablePacing 为 true 时推迟开始捕获的时间，使渲染恰好在下一次合成前完成
+	void Initialize(float minFrameRate, std::optional<float> maxFrameRate, bool enablePacing) noexcept;
 
 	StepTimerStatus WaitForNextFrame(bool waitMsgForNewFrame, bool& fpsUpdated) noexcept;
 
@@ -25,25 +22,26 @@ public:
 		return _frameCount;
 	}
 
+	// 未限制帧率时为 0
+	std::chrono::nanoseconds MinInterval() const noexcept {
+		return _policy.MinInterval();
+	}
+
 	// 从前端线程调用
 	uint32_t FPS() const noexcept {
 		return _framesPerSecond.load(std::memory_order_relaxed);
 	}
 
 private:
-	bool _HasMinInterval() const noexcept;
-	bool _HasMaxInterval() const noexcept;
-
 	void _WaitForMsgAndTimer(std::chrono::nanoseconds time) noexcept;
 
 	bool _UpdateFPS(std::chrono::time_point<std::chrono::steady_clock> now) noexcept;
 
-	std::chrono::nanoseconds _minInterval{};
-	std::chrono::nanoseconds _maxInterval{ std::numeric_limits<std::chrono::nanoseconds::rep>::max() };
+	void _UpdateCompositionTiming() noexcept;
+
+	StepTimerPolicy _policy;
 	wil::unique_event_nothrow _hTimer;
 
-	std::chrono::time_point<std::chrono::steady_clock> _thisFrameStartTime;
-	std::chrono::time_point<std::chrono::steady_clock> _nextFrameStartTime;
 	std::chrono::time_point<std::chrono::steady_clock> _lastSecondTime;
 
 	uint32_t _frameCount = 0;
@@ -0,0 +1,172 @@
+#pragma once
+#include "FramePacer.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <optional>
+
+namespace Magpie {
+
+enum class StepTimerStatus {
+	WaitForNewFrame,
+	WaitForFPSLimiter,
+	ForceNewFrame
+};
+
+// StepTimer 的决策部分：帧率限制、最小帧率和 pacing。自身不读取时钟也不等待，时间均为 steady_clock
+// 纪元以来的时长，由调用者传入，因此可以用模拟的时钟驱动，见 tools/FrameSimulator。
+// 只由头文件实现，无需 Windows 也可以使用。
+class StepTimerPolicy {
+public:
+	// 等待时长没有上限
+	static constexpr std::chrono::nanoseconds INFINITE_WAIT = std::chrono::nanoseconds::max();
+	// 渲染完成后前端还需要复制共享纹理并呈现，这些都应在合成前完成
+	static constexpr std::chrono::nanoseconds PACING_SAFETY_MARGIN = std::chrono::milliseconds(2);
+
+	struct Decision {
+		StepTimerStatus status = StepTimerStatus::WaitForNewFrame;
+		// WaitForFPSLimiter 时为应等待的时长，期间有消息到达也应醒来；
+		// WaitForNewFrame 时为等待新帧的最长时长。ForceNewFrame 时无意义
+		std::chrono::nanoseconds waitTime{};
+	};
+
+	StepTimerPolicy() = default;
+
+	StepTimerPolicy(const StepTimerPolicy&) = delete;
+	StepTimerPolicy(StepTimerPolicy&&) = delete;
+
+	void Initialize(float minFrameRate, std::optional<float> maxFrameRate, bool enablePacing) noexcept {
+		assert(minFrameRate >= 0);
+		if (minFrameRate > 0) {
+			_maxInterval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::duration<float>(1 / minFrameRate));
+		}
+
+		if (maxFrameRate) {
+			assert(*maxFrameRate > 0);
+			_minInterval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::duration<float>(1 / *maxFrameRate));
+			assert(_minInterval <= _maxInterval);
+
+			if (_HasMaxInterval()) {
+				// 确保最大帧间隔是最小帧间隔的整数倍，这能使帧间隔保持稳定，代价是实际最小帧率可能比要求的稍高一点
+				_maxInterval = _maxInterval / _minInterval * _minInterval;
+			}
+		}
+
+		_isPacingEnabled = enablePacing;
+		if (enablePacing) {
+			_pacer.Initialize(PACING_SAFETY_MARGIN);
+		}
+	}
+
+	// 渲染新帧时以该次循环开始捕获的时间点作为新帧的开始时间，只有这个时间点是我们可以控制的。
+	// 下图中的 wait 包括等待最大帧率限制和等待新帧，Decide 在此期间多次执行。
+	// OnRender 在 render 开始前执行。
+	//
+	// _thisFrameStartTime      _nextFrameStartTime
+	//         │                         │
+	// ────────▼─────────┬────────┬──────▼─────────
+	//    wait │ capture │ render │ wait │ capture
+	//
+	// 启用 pacing 时 render 之后的 wait 还包括等待 _pacedStartTime，它是预测能赶上下一次合成的最晚开始时间。
+	// capture 和 render 的耗时在渲染完成后第一次执行 Decide 时统计。
+	//
+	Decision Decide(std::chrono::nanoseconds now) noexcept {
+		// 不断更新 _nextFrameStartTime 直到新帧到达
+		_nextFrameStartTime = now;
+
+		if (!_hasStarted) {
+			// 等待第一帧
+			return { StepTimerStatus::WaitForNewFrame, INFINITE_WAIT };
+		}
+
+		if (_isPacingEnabled && !_isPacedStartTimeValid) {
+			// 使用墙上时间而不是 EffectsProfiler 的 GPU 时间戳：后者只覆盖效果的各个通道，不包括捕获和
+			// 复制，且只在显示性能数据或自动调整质量时才启用。渲染结束时后端会等待围栏，因此墙上时间已包含 GPU 耗时
+			_pacer.AddSample(now - _workStartTime);
+			// 帧率限制之前的开始时间无法实现，否则限制帧率时开始时间总是被推迟到帧率限制的时间，
+			// 无法和合成对齐
+			_pacedStartTime = _pacer.NextWorkStart(std::max(now, _thisFrameStartTime + _minInterval));
+			_isPacedStartTimeValid = true;
+		}
+
+		// 包括当前帧的捕获时间和渲染时间以及渲染完成后已经等待的时间
+		const std::chrono::nanoseconds delta = now - _thisFrameStartTime;
+
+		if (delta >= _maxInterval) {
+			return { StepTimerStatus::ForceNewFrame };
+		}
+
+		if (delta < _minInterval) {
+			return { StepTimerStatus::WaitForFPSLimiter, _minInterval - delta };
+		}
+
+		if (_isPacingEnabled && now < _pacedStartTime) {
+			// 过早开始捕获只会使帧在完成后等待合成，和等待帧率限制的处理方式相同
+			return { StepTimerStatus::WaitForFPSLimiter, _pacedStartTime - now };
+		}
+
+		return {
+			StepTimerStatus::WaitForNewFrame,
+			_HasMaxInterval() ? _maxInterval - delta : INFINITE_WAIT
+		};
+	}
+
+	void OnRender() noexcept {
+		// 进入新一帧，计算此帧的开始时间
+		if (_HasMinInterval()) {
+			// 限制最大帧率时帧间隔必须是最小帧间隔的整数倍，_nextFrameStartTime 需要稍微向前修正。
+			// 出于同样的原因，最大帧间隔应是最小帧间隔的整数倍。
+			_thisFrameStartTime = _nextFrameStartTime -
+				(_nextFrameStartTime - _thisFrameStartTime) % _minInterval;
+		} else {
+			_thisFrameStartTime = _nextFrameStartTime;
+		}
+
+		_workStartTime = _nextFrameStartTime;
+		_isPacedStartTimeValid = false;
+		_hasStarted = true;
+	}
+
+	// 为 true 时下一次 Decide 将计算下一帧的开始时间，调用者应先通过 Pacer() 更新合成时间
+	bool IsCompositionTimingNeeded() const noexcept {
+		return _isPacingEnabled && _hasStarted && !_isPacedStartTimeValid;
+	}
+
+	FramePacer& Pacer() noexcept {
+		return _pacer;
+	}
+
+	// 未限制帧率时为 0
+	std::chrono::nanoseconds MinInterval() const noexcept {
+		return _minInterval;
+	}
+
+private:
+	bool _HasMinInterval() const noexcept {
+		return _minInterval.count() != 0;
+	}
+
+	bool _HasMaxInterval() const noexcept {
+		return _maxInterval != INFINITE_WAIT;
+	}
+
+	std::chrono::nanoseconds _minInterval{};
+	std::chrono::nanoseconds _maxInterval = INFINITE_WAIT;
+
+	std::chrono::nanoseconds _thisFrameStartTime{};
+	std::chrono::nanoseconds _nextFrameStartTime{};
+
+	FramePacer _pacer;
+	// 当前帧开始捕获的时间，用于统计耗时
+	std::chrono::nanoseconds _workStartTime{};
+	// 下一帧最早开始捕获的时间
+	std::chrono::nanoseconds _pacedStartTime{};
+	bool _isPacedStartTimeValid = false;
+	bool _isPacingEnabled = false;
+
+	bool _hasStarted = false;
+};
+
+}
@@ -1,10 +1,15 @@
 #include "pch.h"
 #include "TextureHelper.h"
 #include "DDSHelper.h"
+#include "DeviceResources.h"
 #include "DirectXHelper.h"
 #include "EffectHelper.h"
 #include "Logger.h"
+#include "PngHelper.h"
+#include "Win32Helper.h"
 #include <wincodec.h>
+#include <parallel_hashmap/phmap.h>
+#include <rapidhash.h>
 
 namespace Magpie {
 
@@ -128,7 +133,7 @@ static winrt::com_ptr<ID3D11Texture2D> LoadImg(const wchar_t* fileName, ID3D11De
 	return result;
 }
 
-winrt::com_ptr<ID3D11Texture2D> TextureHelper::LoadTexture(const wchar_t* fileName, ID3D11Device* d3dDevice) noexcept {
+static winrt::com_ptr<ID3D11Texture2D> LoadTextureFromFile(const wchar_t* fileName, ID3D11Device* d3dDevice) noexcept {
 	std::wstring_view sv(fileName);
 	size_t npos = sv.find_last_of(L'.');
 	if (npos == std::wstring_view::npos) {
@@ -151,145 +156,87 @@ winrt::com_ptr<ID3D11Texture2D> TextureHelper::LoadTexture(const wchar_t* fileNa
 	return nullptr;
 }
 
-static bool SavePng(
-	const wchar_t* fileName,
-	uint32_t width,
-	uint32_t height,
-	std::span<uint8_t> pixelData,
-	uint32_t rowPitch
-) {
-	// 初始化 WIC
-	winrt::com_ptr<IWICImagingFactory2> wicFactory =
-		winrt::try_create_instance<IWICImagingFactory2>(CLSID_WICImagingFactory);
-	if (!wicFactory) {
-		Logger::Get().Error("创建 WICImagingFactory2 失败");
-		return false;
-	}
+// 文件路径到内容哈希的索引，以修改时间判断是否失效，避免每次加载都计算哈希
+struct ContentHashIndex {
+	struct Entry {
+		uint64_t lastWriteTime = 0;
+		uint64_t contentHash = 0;
+	};
 
-	winrt::com_ptr<IWICBitmapEncoder> imgEncoder;
-	HRESULT hr = wicFactory->CreateEncoder(GUID_ContainerFormatPng, nullptr, imgEncoder.put());
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICImagingFactory::CreateEncoder 失败", hr);
-		return false;
-	}
+	wil::srwlock lock;
+	phmap::flat_hash_map<std::wstring, Entry> entries;
+};
 
-	{
-		winrt::com_ptr<IWICStream> wicStream;
-		hr = wicFactory->CreateStream(wicStream.put());
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICImagingFactory::CreateStream 失败", hr);
-			return false;
-		}
-
-		hr = wicStream->InitializeFromFilename(fileName, GENERIC_WRITE);
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICStream::InitializeFromFilename 失败", hr);
-			return false;
-		}
+static ContentHashIndex& GetContentHashIndex() noexcept {
+	static ContentHashIndex index;
+	return index;
+}
 
-		hr = imgEncoder->Initialize(wicStream.get(), WICBitmapEncoderNoCache);
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICBitmapEncoder::Initialize 失败", hr);
-			return false;
-		}
+static bool GetLastWriteTime(const wchar_t* fileName, uint64_t& lastWriteTime) noexcept {
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesEx(fileName, GetFileExInfoStandard, &attributes)) {
+		Logger::Get().Win32Error("GetFileAttributesEx 失败");
+		return false;
 	}
 
-	winrt::com_ptr<IWICBitmapFrameEncode> frameEncoder;
-	hr = imgEncoder->CreateNewFrame(frameEncoder.put(), nullptr);
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICBitmapEncoder::CreateNewFrame 失败", hr);
+	lastWriteTime = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32)
+		| attributes.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+static bool GetContentHash(const wchar_t* fileName, uint64_t& contentHash) noexcept {
+	uint64_t lastWriteTime;
+	if (!GetLastWriteTime(fileName, lastWriteTime)) {
 		return false;
 	}
 
-	hr = frameEncoder->Initialize(nullptr);
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICBitmapFrameEncode::Initialize 失败", hr);
-		return false;
+	ContentHashIndex& index = GetContentHashIndex();
+	{
+		auto lk = index.lock.lock_shared();
+		auto it = index.entries.find(fileName);
+		if (it != index.entries.end() && it->second.lastWriteTime == lastWriteTime) {
+			contentHash = it->second.contentHash;
+			return true;
+		}
 	}
 
-	hr = frameEncoder->SetSize(width, height);
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICBitmapFrameEncode::SetSize 失败", hr);
+	MappedFile file;
+	if (!Win32Helper::MapFile(fileName, file)) {
 		return false;
 	}
 
-	const WICPixelFormatGUID& srcFormat = GUID_WICPixelFormat32bppRGBA;
-	WICPixelFormatGUID destFormat = srcFormat;
-	hr = frameEncoder->SetPixelFormat(&destFormat);
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICBitmapFrameEncode::SetPixelFormat 失败", hr);
+	if (file.Size() == 0) {
+		Logger::Get().Error("文件为空");
 		return false;
 	}
 
-	// 写入像素数据
-	if (destFormat == srcFormat) {
-		hr = frameEncoder->WritePixels(
-			height,
-			rowPitch,
-			(UINT)pixelData.size(),
-			pixelData.data()
-		);
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICBitmapFrameEncode::WritePixels 失败", hr);
-			return false;
-		}
-	} else {
-		// 需要转换格式
-		winrt::com_ptr<IWICBitmap> memBmp;
-		hr = wicFactory->CreateBitmapFromMemory(
-			width,
-			height,
-			srcFormat,
-			rowPitch,
-			(UINT)pixelData.size(),
-			pixelData.data(),
-			memBmp.put()
-		);
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICImagingFactory::CreateBitmapFromMemory 失败", hr);
-			return false;
-		}
-
-		winrt::com_ptr<IWICFormatConverter> formatConverter;
-		hr = wicFactory->CreateFormatConverter(formatConverter.put());
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICImagingFactory::CreateFormatConverter 失败", hr);
-			return false;
-		}
+	contentHash = rapidhash(file.Data().data(), file.Size());
 
-		hr = formatConverter->Initialize(
-			memBmp.get(),
-			destFormat,
-			WICBitmapDitherTypeNone,
-			nullptr,
-			0.0,
-			WICBitmapPaletteTypeMedianCut
-		);
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICFormatConverter::Initialize 失败", hr);
-			return false;
-		}
+	auto lk = index.lock.lock_exclusive();
+	index.entries[fileName] = { lastWriteTime, contentHash };
+	return true;
+}
 
-		hr = frameEncoder->WriteSource(formatConverter.get(), nullptr);
-		if (FAILED(hr)) {
-			Logger::Get().ComError("IWICBitmapFrameEncode::WriteSource 失败", hr);
-			return false;
-		}
+winrt::com_ptr<ID3D11Texture2D> TextureHelper::LoadTexture(const wchar_t* fileName, DeviceResources& deviceResources) noexcept {
+	// 以内容为键，即使路径不同，相同的纹理也只上传一次
+	uint64_t contentHash;
+	if (!GetContentHash(fileName, contentHash)) {
+		return nullptr;
 	}
 
-	hr = frameEncoder->Commit();
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICBitmapFrameEncode::Commit 失败", hr);
-		return false;
+	winrt::com_ptr<ID3D11Texture2D> texture;
+	texture.copy_from(deviceResources.GetCachedTexture(contentHash));
+	if (texture) {
+		return texture;
 	}
 
-	hr = imgEncoder->Commit();
-	if (FAILED(hr)) {
-		Logger::Get().ComError("IWICBitmapEncoder::Commit 失败", hr);
-		return false;
+	texture = LoadTextureFromFile(fileName, deviceResources.GetD3DDevice());
+	if (!texture) {
+		return nullptr;
 	}
 
-	return true;
+	deviceResources.CacheTexture(contentHash, texture.get(), TextureCacheScope::Device);
+	return texture;
 }
 
 bool TextureHelper::SaveTexture(
@@ -305,8 +252,7 @@ bool TextureHelper::SaveTexture(
 		return DDSHelper::Save(fileName, width, height, dxgiFormat, pixelData, rowPitch);
 	} else {
 		assert(std::wstring_view(fileName).ends_with(L".png"));
-		assert(format == EffectIntermediateTextureFormat::R8G8B8A8_UNORM);
-		return SavePng(fileName, width, height, pixelData, rowPitch);
+		return PngHelper::Save(fileName, width, height, format, pixelData, rowPitch);
 	}
 }
 
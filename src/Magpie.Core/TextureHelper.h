@@ -3,12 +3,14 @@
 
 namespace Magpie {
 
+class DeviceResources;
+
 class TextureHelper {
 public:
-	// 支持 dds、bmp、jpg、png 和 tiff
-	static winrt::com_ptr<ID3D11Texture2D> LoadTexture(const wchar_t* fileName, ID3D11Device* d3dDevice) noexcept;
+	// 支持 dds、bmp、jpg、png 和 tiff。加载的纹理缓存在设备上并在多次缩放间共享，因此是不可变的
+	static winrt::com_ptr<ID3D11Texture2D> LoadTexture(const wchar_t* fileName, DeviceResources& deviceResources) noexcept;
 
-	// 支持 dds 和 png
+	// 支持 dds 和 png。保存为 png 时任何格式都会被转换为 8 位 RGBA
 	static bool SaveTexture(
 		const wchar_t* fileName,
 		uint32_t width,
@@ -74,8 +74,12 @@ std::wstring Win32Helper::GetWindowPath(HWND hWnd) noexcept {
 		return {};
 	}
 
+	return GetProcessPath(hProc.get());
+}
+
+std::wstring Win32Helper::GetProcessPath(HANDLE hProcess) noexcept {
 	std::wstring fileName;
-	HRESULT hr = wil::QueryFullProcessImageNameW(hProc.get(), 0, fileName);
+	HRESULT hr = wil::QueryFullProcessImageNameW(hProcess, 0, fileName);
 	if (FAILED(hr)) {
 		Logger::Get().ComError("QueryFullProcessImageNameW 失败", hr);
 		return {};
@@ -296,7 +300,7 @@ bool Win32Helper::IsWindowHung(HWND hWnd) noexcept {
 }
 
 bool Win32Helper::ReadFile(const wchar_t* fileName, std::vector<uint8_t>& result) noexcept {
-	Logger::Get().Info(StrHelper::Concat("读取文件: ", StrHelper::UTF16ToUTF8(fileName)));
+	Logger::Get().Info("读取文件: {}", fileName);
 
 	CREATEFILE2_EXTENDED_PARAMETERS extendedParams{
 		.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS),
@@ -322,8 +326,19 @@ bool Win32Helper::ReadFile(const wchar_t* fileName, std::vector<uint8_t>& result
 	return true;
 }
 
+bool Win32Helper::MapFile(const wchar_t* fileName, MappedFile& result, MappedFileHint hint) noexcept {
+	Logger::Get().Info("映射文件: {}", fileName);
+
+	if (!result.Open(fileName, hint)) {
+		Logger::Get().Win32Error("映射文件失败");
+		return false;
+	}
+
+	return true;
+}
+
 bool Win32Helper::WriteFile(const wchar_t* fileName, std::span<uint8_t> buffer) noexcept {
-	Logger::Get().Info(StrHelper::Concat("写入文件: ", StrHelper::UTF16ToUTF8(fileName)));
+	Logger::Get().Info("写入文件: {}", fileName);
 
 	CREATEFILE2_EXTENDED_PARAMETERS extendedParams{
 		.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS),
@@ -347,11 +362,11 @@ bool Win32Helper::WriteFile(const wchar_t* fileName, std::span<uint8_t> buffer)
 }
 
 bool Win32Helper::ReadTextFile(const wchar_t* fileName, std::string& result) noexcept {
-	Logger::Get().Info(StrHelper::Concat("读取文本文件: ", StrHelper::UTF16ToUTF8(fileName)));
+	Logger::Get().Info("读取文本文件: {}", fileName);
 
 	wil::unique_file hFile;
 	if (_wfopen_s(hFile.put(), fileName, L"rt") || !hFile) {
-		Logger::Get().Error(StrHelper::Concat("打开文件 ", StrHelper::UTF16ToUTF8(fileName), " 失败"));
+		Logger::Get().Error("打开文件 {} 失败", fileName);
 		return false;
 	}
 
@@ -369,11 +384,11 @@ bool Win32Helper::ReadTextFile(const wchar_t* fileName, std::string& result) noe
 }
 
 bool Win32Helper::WriteTextFile(const wchar_t* fileName, std::string_view text) noexcept {
-	Logger::Get().Info(StrHelper::Concat("写入文本文件: ", StrHelper::UTF16ToUTF8(fileName)));
+	Logger::Get().Info("写入文本文件: {}", fileName);
 
 	wil::unique_file hFile;
 	if (_wfopen_s(hFile.put(), fileName, L"wt") || !hFile) {
-		Logger::Get().Error(StrHelper::Concat("打开文件 ", StrHelper::UTF16ToUTF8(fileName), " 失败"));
+		Logger::Get().Error("打开文件 {} 失败", fileName);
 		return false;
 	}
 
@@ -439,56 +454,6 @@ const Win32Helper::OSVersion& Win32Helper::GetOSVersion() noexcept {
 	return version;
 }
 
-struct TPContext {
-	std::function<void(uint32_t)> func;
-	std::atomic<uint32_t> id;
-};
-
-[[maybe_unused]]
-static void CALLBACK TPCallback(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK) {
-	TPContext* ctxt = (TPContext*)context;
-	const uint32_t id = ctxt->id.fetch_add(1, std::memory_order_relaxed) + 1;
-	ctxt->func(id);
-}
-
-void Win32Helper::RunParallel(std::function<void(uint32_t)> func, uint32_t times) noexcept {
-#ifdef _DEBUG
-	// 为了便于调试，DEBUG 模式下不使用线程池
-	for (UINT i = 0; i < times; ++i) {
-		func(i);
-	}
-#else
-	if (times == 0) {
-		return;
-	}
-
-	if (times == 1) {
-		return func(0);
-	}
-
-	TPContext ctxt = { func, 0 };
-	PTP_WORK work = CreateThreadpoolWork(TPCallback, &ctxt, nullptr);
-	if (work) {
-		// 在线程池中执行 times - 1 次
-		for (uint32_t i = 1; i < times; ++i) {
-			SubmitThreadpoolWork(work);
-		}
-
-		func(0);
-
-		WaitForThreadpoolWorkCallbacks(work, FALSE);
-		CloseThreadpoolWork(work);
-	} else {
-		Logger::Get().Win32Error("CreateThreadpoolWork 失败，回退到单线程");
-
-		// 回退到单线程
-		for (uint32_t i = 0; i < times; ++i) {
-			func(i);
-		}
-	}
-#endif // _DEBUG
-}
-
 static bool MapKeycodeToUnicode(
 	const int vCode,
 	HKL layout,
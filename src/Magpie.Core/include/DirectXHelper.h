@@ -16,7 +16,8 @@ struct DirectXHelper {
 		ID3DBlob** blob,
 		const char* sourceName = nullptr,
 		ID3DInclude* include = nullptr,
-		const std::vector<std::pair<std::string, std::string>>& macros = {},
+		// 以 { nullptr, nullptr } 结尾
+		const D3D_SHADER_MACRO* macros = nullptr,
 		bool warningsAreErrors = false
 	);
 
@@ -1,4 +1,5 @@
 #pragma once
+#include "MappedFile.h"
 #include <parallel_hashmap/phmap.h>
 
 namespace Magpie {
@@ -15,12 +16,26 @@ struct EffectCompilerFlags {
 	static constexpr uint32_t WarningsAreErrors = 1 << 19;
 };
 
+// 包含文件的缓存，可由同时编译的多个效果共用。每个包含文件只在第一次使用时读取，之后的修改
+// 不会被看到，因此只应在一次编译期间使用，如开始缩放时编译所有效果。
+class EffectIncludeCache {
+public:
+	// path 相对于程序所在目录，如 effects\SMAA\SMAA.hlsli
+	bool Get(std::wstring_view path, std::string_view& content) noexcept;
+
+private:
+	wil::srwlock _lock;
+	// 规范化的路径 -> 映射的文件，不同效果以不同的相对路径包含同一个文件时只读取一次
+	phmap::flat_hash_map<std::wstring, MappedFile> _files;
+};
+
 struct EffectCompiler {
-	// 调用者需填入 desc 中的 name 和 flags
+	// 调用者需填入 desc 中的 name 和 flags。includeCache 为空时只在通道间共用包含文件
 	static uint32_t Compile(
 		struct EffectDesc& desc,
 		uint32_t flags,	// EffectCompilerFlags
-		const phmap::flat_hash_map<std::string, float>* inlineParams = nullptr
+		const phmap::flat_hash_map<std::string, float>* inlineParams = nullptr,
+		EffectIncludeCache* includeCache = nullptr
 	) noexcept;
 };
 
@@ -0,0 +1,174 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Magpie {
+
+// 读取映射内容的方式，和 madvise 的含义相同
+enum class MappedFileHint {
+	Normal,
+	// 从头到尾读取一遍，如解析源码和反序列化缓存
+	Sequential,
+	// 很快会读取全部内容，立即开始预读
+	WillNeed
+};
+
+// 只读的内存映射文件。只由头文件实现，无需 Windows 也可以使用。
+//
+// 文件内容不再复制到 std::vector 或 std::string，而是在第一次访问时由缺页中断从页缓存载入，
+// 多次读取同一个文件也不会分配额外的内存。因此只应在内容被原地使用时（如反序列化、交给编译器或
+// 上传到 GPU）使用，需要复制一份时直接读取文件更快。允许其他进程同时读写文件，
+// 但映射期间文件无法被截断，其他进程写入的内容也会出现在映射中。
+// Windows 上没有和 MADV_SEQUENTIAL 对应的机制，Sequential 和 WillNeed 都使用
+// PrefetchVirtualMemory 一次性预读整个文件，代替逐页的缺页中断。
+class MappedFile {
+public:
+#ifdef _WIN32
+	using PathChar = wchar_t;
+#else
+	using PathChar = char;
+#endif
+
+	MappedFile() noexcept = default;
+	MappedFile(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept
+		: _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)) {}
+
+	MappedFile& operator=(MappedFile&& other) noexcept {
+		if (this != &other) {
+			Close();
+			_data = std::exchange(other._data, nullptr);
+			_size = std::exchange(other._size, 0);
+		}
+		return *this;
+	}
+
+	~MappedFile() noexcept {
+		Close();
+	}
+
+	// 失败时返回 false，原因可通过 GetLastError 或 errno 获取。空文件也会成功，此时 Data 为空
+	bool Open(const PathChar* fileName, MappedFileHint hint = MappedFileHint::Sequential) noexcept {
+		Close();
+
+#ifdef _WIN32
+		wil::unique_hfile hFile(CreateFile2(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, OPEN_EXISTING, nullptr));
+		if (!hFile) {
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(hFile.get(), &fileSize)) {
+			return false;
+		}
+
+		// 无法映射空文件
+		if (fileSize.QuadPart == 0) {
+			return true;
+		}
+
+		if ((uint64_t)fileSize.QuadPart > SIZE_MAX) {
+			SetLastError(ERROR_FILE_TOO_LARGE);
+			return false;
+		}
+
+		wil::unique_handle hMapping(CreateFileMapping(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+		if (!hMapping) {
+			return false;
+		}
+
+		// 视图会保持映射对象和文件打开，无需保留句柄
+		_data = (const uint8_t*)MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+		if (!_data) {
+			return false;
+		}
+
+		_size = (size_t)fileSize.QuadPart;
+#else
+		const int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+		if (fd == -1) {
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) == -1) {
+			close(fd);
+			return false;
+		}
+
+		if (fileStat.st_size == 0) {
+			close(fd);
+			return true;
+		}
+
+		void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// 映射会保持文件打开
+		close(fd);
+		if (data == MAP_FAILED) {
+			return false;
+		}
+
+		_data = (const uint8_t*)data;
+		_size = (size_t)fileStat.st_size;
+#endif
+
+		Advise(hint);
+		return true;
+	}
+
+	void Close() noexcept {
+		if (!_data) {
+			return;
+		}
+
+#ifdef _WIN32
+		UnmapViewOfFile(_data);
+#else
+		munmap((void*)_data, _size);
+#endif
+		_data = nullptr;
+		_size = 0;
+	}
+
+	// 只是提示，失败时不影响读取
+	void Advise(MappedFileHint hint) const noexcept {
+		if (!_data || hint == MappedFileHint::Normal) {
+			return;
+		}
+
+#ifdef _WIN32
+		WIN32_MEMORY_RANGE_ENTRY range{ (void*)_data, _size };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		madvise((void*)_data, _size, hint == MappedFileHint::Sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+#endif
+	}
+
+	std::span<const uint8_t> Data() const noexcept {
+		return { _data, _size };
+	}
+
+	// 不会转换换行符
+	std::string_view Text() const noexcept {
+		return { (const char*)_data, _size };
+	}
+
+	size_t Size() const noexcept {
+		return _size;
+	}
+
+private:
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+};
+
+}
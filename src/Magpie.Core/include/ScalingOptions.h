@@ -61,6 +61,11 @@ struct ScalingFlags {
 	static constexpr uint32_t FP16Disabled = 1 << 19;
 	static constexpr uint32_t BenchmarkMode = 1 << 20;
 	static constexpr uint32_t DeveloperMode = 1 << 21;
+	static constexpr uint32_t RecordFrameTrace = 1 << 22;
+	static constexpr uint32_t AdaptiveQuality = 1 << 23;
+	static constexpr uint32_t FramePacing = 1 << 24;
+	// 录制帧轨迹时同时录制每一帧的内容，供回放使用
+	static constexpr uint32_t RecordFrameContent = 1 << 25;
 };
 
 enum class ScalingType {
@@ -165,6 +170,8 @@ struct ScalingOptions {
 	DEFINE_FLAG_ACCESSOR(IsSaveEffectSources, ScalingFlags::SaveEffectSources, flags)
 	DEFINE_FLAG_ACCESSOR(IsWarningsAreErrors, ScalingFlags::WarningsAreErrors, flags)
 	DEFINE_FLAG_ACCESSOR(IsStatisticsForDynamicDetectionEnabled, ScalingFlags::EnableStatisticsForDynamicDetection, flags)
+	DEFINE_FLAG_ACCESSOR(IsFrameTraceRecordingEnabled, ScalingFlags::RecordFrameTrace, flags)
+	DEFINE_FLAG_ACCESSOR(IsFrameContentRecordingEnabled, ScalingFlags::RecordFrameContent, flags)
 	DEFINE_FLAG_ACCESSOR(IsInlineParams, ScalingFlags::InlineParams, flags)
 	DEFINE_FLAG_ACCESSOR(IsTouchSupportEnabled, ScalingFlags::TouchSupportEnabled, flags)
 	DEFINE_FLAG_ACCESSOR(IsAllowScalingMaximized, ScalingFlags::AllowScalingMaximized, flags)
@@ -173,6 +180,8 @@ struct ScalingOptions {
 	DEFINE_FLAG_ACCESSOR(IsCaptureTitleBar, ScalingFlags::CaptureTitleBar, flags)
 	DEFINE_FLAG_ACCESSOR(IsAdjustCursorSpeed, ScalingFlags::AdjustCursorSpeed, flags)
 	DEFINE_FLAG_ACCESSOR(IsDirectFlipDisabled, ScalingFlags::DisableDirectFlip, flags)
+	DEFINE_FLAG_ACCESSOR(IsAdaptiveQuality, ScalingFlags::AdaptiveQuality, flags)
+	DEFINE_FLAG_ACCESSOR(IsFramePacing, ScalingFlags::FramePacing, flags)
 
 	std::vector<EffectOption> effects;
 	uint32_t flags = ScalingFlags::AdjustCursorSpeed;
@@ -190,6 +199,8 @@ struct ScalingOptions {
 	ToolbarState windowedInitialToolbarState = ToolbarState::AutoHide;
 	float initialWindowedScaleFactor = 0.0f;
 	std::filesystem::path screenshotsDir;
+	// 非空时回放此帧轨迹（需要同名的 .mpfc 文件）代替捕获源窗口，见 ReplayFrameSource
+	std::filesystem::path frameTraceReplayPath;
 
 	// 下面的成员支持在缩放时修改
 	OverlayOptions overlayOptions;
@@ -22,6 +22,10 @@ public:
 
 	void Stop();
 
+	// 释放缩放结束后为重用而保留的设备。没有启用自动缩放时很可能不会马上再次缩放，
+	// 应立即释放而不是等待空闲超时
+	void ReleasePooledDevices();
+
 	ScalingState State() const noexcept {
 		return _state.load(std::memory_order_relaxed);
 	}
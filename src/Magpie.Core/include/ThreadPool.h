@@ -0,0 +1,392 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Magpie {
+
+// 线程池中任务的优先级。空闲的线程先执行 Interactive 的任务，没有时才执行 Background 的任务
+enum class TaskPriority {
+	// 用户正在等待结果，如开始缩放时编译效果
+	Interactive,
+	// 可以推迟的任务，如启动时解析所有效果
+	Background
+};
+
+class ThreadPool;
+
+// 一组任务，可以等待它们全部完成或取消尚未开始的任务。TaskGroup 被析构前会等待所有任务完成
+class TaskGroup {
+public:
+	explicit TaskGroup(TaskPriority priority = TaskPriority::Interactive) noexcept : _priority(priority) {}
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup(TaskGroup&&) = delete;
+
+	~TaskGroup() noexcept {
+		Wait();
+	}
+
+	TaskPriority Priority() const noexcept {
+		return _priority;
+	}
+
+	// 在线程池中执行 fn
+	template <typename Fn>
+	void Run(Fn&& fn) noexcept;
+
+	// 等待所有任务完成。等待期间当前线程会执行线程池中的任务，因此可以在任务中嵌套使用
+	void Wait() noexcept;
+
+	// 尚未开始的任务不再执行，正在执行的任务可以通过 IsCanceled 检查是否应提前结束
+	void Cancel() noexcept {
+		_isCanceled.store(true, std::memory_order_relaxed);
+	}
+
+	bool IsCanceled() const noexcept {
+		return _isCanceled.load(std::memory_order_relaxed);
+	}
+
+private:
+	friend class ThreadPool;
+
+	std::atomic<uint32_t> _pendingCount = 0;
+	std::atomic<bool> _isCanceled = false;
+	const TaskPriority _priority;
+};
+
+// 常驻的工作窃取线程池。只由头文件实现，无需 Windows 也可以使用。
+//
+// 每个工作线程有自己的任务队列，工作线程提交的 Interactive 任务放入自己的队列，从队尾取出执行以
+// 利用缓存；自己的队列为空时依次从 Interactive 的全局队列、其他线程队列的队首和 Background 的全局
+// 队列中获取任务。其他线程提交的任务以及所有 Background 任务放入对应优先级的全局队列，否则
+// Background 任务会和 Interactive 任务一样被优先执行。等待 TaskGroup 的线程也会执行任务，因此在
+// 任务中嵌套使用 ParallelFor 不会死锁，也不会占用额外的线程。
+//
+// 任务不使用 std::function，ParallelFor 的状态保存在调用者的栈上，提交任务时不分配内存。
+class ThreadPool {
+public:
+	static ThreadPool& Get() noexcept {
+		static ThreadPool instance;
+		return instance;
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+
+	~ThreadPool() noexcept {
+		{
+			std::scoped_lock lk(_sleepMutex);
+			_isStopping = true;
+		}
+		_workerCondition.notify_all();
+
+		for (std::thread& thread : _threads) {
+			thread.join();
+		}
+	}
+
+	// 参与执行 ParallelFor 的线程数，包括调用线程
+	uint32_t ThreadCount() const noexcept {
+		return (uint32_t)_workers.size() + 1;
+	}
+
+	// 对 [0, count) 中的每个 i 并行执行 fn(i)，执行完毕后返回。每 grainSize 个 i 为一块，
+	// 块按顺序被领取，调用线程也参与执行。fn 开销很小时应增大 grainSize
+	template <typename Fn>
+	void ParallelFor(TaskGroup& group, uint32_t count, uint32_t grainSize, Fn&& fn) noexcept {
+		if (count == 0) {
+			return;
+		}
+
+		grainSize = std::max(grainSize, 1u);
+		const uint32_t chunkCount = uint32_t(((uint64_t)count + grainSize - 1) / grainSize);
+
+		if (chunkCount == 1) {
+			if (!group.IsCanceled()) {
+				for (uint32_t i = 0; i < count; ++i) {
+					fn(i);
+				}
+			}
+			return;
+		}
+
+		using FnType = std::remove_reference_t<Fn>;
+		struct Context {
+			FnType* fn;
+			TaskGroup* group;
+			uint32_t count;
+			uint32_t grainSize;
+			uint32_t chunkCount;
+			std::atomic<uint32_t> nextChunk;
+		} context{ &fn, &group, count, grainSize, chunkCount, 0 };
+
+		static constexpr _TaskProc runChunks = [](void* data, bool) noexcept {
+			Context& ctx = *(Context*)data;
+			while (!ctx.group->IsCanceled()) {
+				const uint32_t chunk = ctx.nextChunk.fetch_add(1, std::memory_order_relaxed);
+				if (chunk >= ctx.chunkCount) {
+					return;
+				}
+
+				const uint32_t begin = chunk * ctx.grainSize;
+				const uint32_t end = (uint32_t)std::min((uint64_t)begin + ctx.grainSize, (uint64_t)ctx.count);
+				for (uint32_t i = begin; i < end; ++i) {
+					(*ctx.fn)(i);
+				}
+			}
+		};
+
+		// 多余的任务开始执行时发现所有块已被领取会立即返回
+		const uint32_t helperCount = std::min(chunkCount - 1, (uint32_t)_workers.size());
+		for (uint32_t i = 0; i < helperCount; ++i) {
+			_Submit(group, runChunks, &context);
+		}
+
+		runChunks(&context, false);
+		group.Wait();
+	}
+
+	template <typename Fn>
+	void ParallelFor(uint32_t count, uint32_t grainSize, Fn&& fn) noexcept {
+		TaskGroup group;
+		ParallelFor(group, count, grainSize, std::forward<Fn>(fn));
+	}
+
+	template <typename Fn>
+	void ParallelFor(uint32_t count, Fn&& fn) noexcept {
+		ParallelFor(count, 1, std::forward<Fn>(fn));
+	}
+
+private:
+	friend class TaskGroup;
+
+	// isCanceled 为 true 时只需释放资源
+	using _TaskProc = void(*)(void* data, bool isCanceled) noexcept;
+
+	struct _Task {
+		_TaskProc proc;
+		void* data;
+		TaskGroup* group;
+	};
+
+	struct _Worker {
+		std::mutex lock;
+		std::deque<_Task> tasks;
+	};
+
+	ThreadPool() noexcept {
+		// 调用线程也参与执行，因此工作线程比逻辑处理器少一个
+		const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		_workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i) {
+			_workers.emplace_back(std::make_unique<_Worker>());
+		}
+
+		_threads.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i) {
+			_threads.emplace_back(&ThreadPool::_WorkerThreadProc, this, i);
+		}
+	}
+
+	void _WorkerThreadProc(uint32_t workerIdx) noexcept {
+#if defined(_WIN32) && defined(_DEBUG)
+		SetThreadDescription(GetCurrentThread(), L"Magpie-线程池工作线程");
+#endif
+		_curWorker = _workers[workerIdx].get();
+
+		while (true) {
+			if (_TryRunTask(true)) {
+				continue;
+			}
+
+			std::unique_lock lk(_sleepMutex);
+			_workerCondition.wait(lk, [&] {
+				return _isStopping || _HasTask(true);
+			});
+
+			if (_isStopping) {
+				return;
+			}
+		}
+	}
+
+	void _Submit(TaskGroup& group, _TaskProc proc, void* data) noexcept {
+		group._pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+		// 工作线程的队列中只有 Interactive 任务
+		_Worker* queue = _curWorker;
+		if (!queue || group.Priority() == TaskPriority::Background) {
+			queue = &_globalQueues[(int)group.Priority()];
+		}
+
+		{
+			std::scoped_lock lk(queue->lock);
+			queue->tasks.push_back({ proc, data, &group });
+		}
+
+		_QueuedCount(queue).fetch_add(1, std::memory_order_release);
+
+		// 加锁确保正要睡眠的线程不会错过通知
+		bool hasWaiter;
+		{
+			std::scoped_lock lk(_sleepMutex);
+			hasWaiter = _waiterCount != 0;
+		}
+
+		// 唤醒一个工作线程，正在等待的线程也可以帮忙执行
+		_workerCondition.notify_one();
+		if (hasWaiter) {
+			_waiterCondition.notify_all();
+		}
+	}
+
+	void _Wait(TaskGroup& group) noexcept {
+		// 只有等待 Background 的任务时才执行 Background 的任务，防止延迟 Interactive 的任务
+		const bool allowBackground = group.Priority() == TaskPriority::Background;
+
+		while (group._pendingCount.load(std::memory_order_acquire) != 0) {
+			if (_TryRunTask(allowBackground)) {
+				continue;
+			}
+
+			std::unique_lock lk(_sleepMutex);
+			++_waiterCount;
+			_waiterCondition.wait(lk, [&] {
+				return group._pendingCount.load(std::memory_order_acquire) == 0 || _HasTask(allowBackground);
+			});
+			--_waiterCount;
+		}
+	}
+
+	bool _TryRunTask(bool allowBackground) noexcept {
+		_Task task;
+		if (!_TryPopTask(task, allowBackground)) {
+			return false;
+		}
+
+		TaskGroup* group = task.group;
+		task.proc(task.data, group->IsCanceled());
+
+		// 减为 0 后 group 可能立即被销毁，之后不能再访问它
+		if (group->_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			{
+				std::scoped_lock lk(_sleepMutex);
+			}
+			_waiterCondition.notify_all();
+		}
+
+		return true;
+	}
+
+	bool _HasTask(bool allowBackground) const noexcept {
+		return _queuedCount.load(std::memory_order_acquire) != 0 ||
+			(allowBackground && _backgroundQueuedCount.load(std::memory_order_acquire) != 0);
+	}
+
+	// Background 的全局队列单独计数，等待 Interactive 任务的线程不会因它们而被唤醒
+	std::atomic<uint32_t>& _QueuedCount(const _Worker* queue) noexcept {
+		return queue == &_globalQueues[(int)TaskPriority::Background] ? _backgroundQueuedCount : _queuedCount;
+	}
+
+	bool _TryPopTask(_Task& task, bool allowBackground) noexcept {
+		if (_queuedCount.load(std::memory_order_acquire) != 0) {
+			// 自己的任务后进先出
+			_Worker* curWorker = _curWorker;
+			if (curWorker && _PopBack(*curWorker, task)) {
+				return true;
+			}
+
+			if (_PopFront(_globalQueues[(int)TaskPriority::Interactive], task)) {
+				return true;
+			}
+
+			// 从其他线程窃取最早提交的任务，它们通常是最大的任务。从不同的位置开始以分散竞争
+			const uint32_t workerCount = (uint32_t)_workers.size();
+			const uint32_t start = _stealSeed.fetch_add(1, std::memory_order_relaxed);
+			for (uint32_t i = 0; i < workerCount; ++i) {
+				_Worker* victim = _workers[(start + i) % workerCount].get();
+				if (victim != curWorker && _PopFront(*victim, task)) {
+					return true;
+				}
+			}
+		}
+
+		return allowBackground && _backgroundQueuedCount.load(std::memory_order_acquire) != 0 &&
+			_PopFront(_globalQueues[(int)TaskPriority::Background], task);
+	}
+
+	bool _PopBack(_Worker& worker, _Task& task) noexcept {
+		std::scoped_lock lk(worker.lock);
+		if (worker.tasks.empty()) {
+			return false;
+		}
+
+		task = worker.tasks.back();
+		worker.tasks.pop_back();
+		_QueuedCount(&worker).fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool _PopFront(_Worker& worker, _Task& task) noexcept {
+		std::scoped_lock lk(worker.lock);
+		if (worker.tasks.empty()) {
+			return false;
+		}
+
+		task = worker.tasks.front();
+		worker.tasks.pop_front();
+		_QueuedCount(&worker).fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	std::vector<std::unique_ptr<_Worker>> _workers;
+	std::vector<std::thread> _threads;
+	// 非工作线程提交的任务和所有 Background 任务，按优先级分开
+	_Worker _globalQueues[2];
+
+	// 队列中的任务数，用于避免无任务时逐个检查队列
+	std::atomic<uint32_t> _queuedCount = 0;
+	std::atomic<uint32_t> _backgroundQueuedCount = 0;
+	std::atomic<uint32_t> _stealSeed = 0;
+
+	// 空闲的工作线程和等待 TaskGroup 的线程分别睡眠，前者只需唤醒一个
+	std::mutex _sleepMutex;
+	std::condition_variable _workerCondition;
+	std::condition_variable _waiterCondition;
+	uint32_t _waiterCount = 0;
+	bool _isStopping = false;
+
+	// 当前线程对应的工作线程，不是工作线程时为 nullptr
+	static inline thread_local _Worker* _curWorker = nullptr;
+};
+
+template <typename Fn>
+inline void TaskGroup::Run(Fn&& fn) noexcept {
+	using FnType = std::decay_t<Fn>;
+
+	static constexpr ThreadPool::_TaskProc proc = [](void* data, bool isCanceled) noexcept {
+		FnType* f = (FnType*)data;
+		if (!isCanceled) {
+			(*f)();
+		}
+		delete f;
+	};
+
+	ThreadPool::Get()._Submit(*this, proc, new FnType(std::forward<Fn>(fn)));
+}
+
+inline void TaskGroup::Wait() noexcept {
+	if (_pendingCount.load(std::memory_order_acquire) != 0) {
+		ThreadPool::Get()._Wait(*this);
+	}
+}
+
+}
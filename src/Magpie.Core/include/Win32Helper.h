@@ -1,5 +1,6 @@
 #pragma once
 #include "Logger.h"
+#include "MappedFile.h"
 #include "StrHelper.h"
 #include "Version.h"
 
@@ -41,6 +42,9 @@ struct Win32Helper {
 
 	static std::wstring GetWindowPath(HWND hWnd) noexcept;
 
+	// 需要 PROCESS_QUERY_LIMITED_INFORMATION 权限，失败时返回空字符串
+	static std::wstring GetProcessPath(HANDLE hProcess) noexcept;
+
 	static std::wstring GetWindowExeName(HWND hWnd) noexcept;
 
 	static UINT GetWindowShowCmd(HWND hWnd) noexcept;
@@ -58,8 +62,16 @@ struct Win32Helper {
 
 	static bool ReadFile(const wchar_t* fileName, std::vector<uint8_t>& result) noexcept;
 
+	// 内容可以直接从映射中使用时应使用 MapFile 代替 ReadFile，避免复制
+	static bool MapFile(
+		const wchar_t* fileName,
+		MappedFile& result,
+		MappedFileHint hint = MappedFileHint::Sequential
+	) noexcept;
+
 	static bool WriteFile(const wchar_t* fileName, std::span<uint8_t> buffer) noexcept;
 
+	// 和文本模式的 fopen 相同，CRLF 会被转换为 LF
 	static bool ReadTextFile(const wchar_t* fileName, std::string& result) noexcept;
 
 	static bool WriteTextFile(const wchar_t* fileName, std::string_view text) noexcept;
@@ -106,10 +118,6 @@ struct Win32Helper {
 
 	static const OSVersion& GetOSVersion() noexcept;
 
-	// 并行执行 times 次 func，并行失败时回退到单线程
-	// 执行完毕后返回
-	static void RunParallel(std::function<void(uint32_t)> func, uint32_t times) noexcept;
-
 	// 获取 Virtual Key 的名字
 	static const std::wstring& GetKeyName(uint8_t key) noexcept;
 
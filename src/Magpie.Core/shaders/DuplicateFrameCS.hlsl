@@ -1,35 +1,75 @@
-// 无需同步
+// 计算每个 32x32 块的 64 位签名，并和上一帧的签名比较。签名的计算方法见 FrameSignature.h，
+// 两者必须保持一致。
+// result[0] 为签名变化的块数，无需同步
 RWBuffer<uint> result : register(u0);
+// 每个块占两个元素
+RWBuffer<uint> curSignatures : register(u1);
+RWBuffer<uint> prevSignatures : register(u2);
 
-Texture2D tex1 : register(t0);
-Texture2D tex2 : register(t1);
+Texture2D tex : register(t0);
 
-SamplerState sam : register(s0);
+groupshared uint hash0;
+groupshared uint hash1;
 
+// MurmurHash3 的 fmix32
+uint Mix(uint x) {
+	x ^= x >> 16;
+	x *= 0x85ebca6bu;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35u;
+	x ^= x >> 16;
+	return x;
+}
+
+uint2 HashTexel(uint2 pos, uint3 rgb) {
+	uint2 h = uint2(0x9e3779b9u, 0x7f4a7c15u) ^ (pos.x | (pos.y << 16));
+	h = uint2(Mix(h.x ^ rgb.r), Mix(h.y ^ rgb.r));
+	h = uint2(Mix(h.x ^ rgb.g), Mix(h.y ^ rgb.g));
+	h = uint2(Mix(h.x ^ rgb.b), Mix(h.y ^ rgb.b));
+	return h;
+}
+
+// 每个线程处理 4x4 个像素
 [numthreads(8, 8, 1)]
-void main(uint3 tid : SV_GroupThreadID, uint3 gid : SV_GroupID) {
-	if (result[0]) {
-		return;
+void main(uint3 tid : SV_GroupThreadID, uint3 gid : SV_GroupID, uint gi : SV_GroupIndex) {
+	if (gi == 0) {
+		hash0 = 0;
+		hash1 = 0;
 	}
-	
-	const int2 gxy = (gid.xy << 4) + (tid.xy << 1);
-	
+	GroupMemoryBarrierWithGroupSync();
+
 	// 不知为何这比通过 cbuffer 传入更快
 	uint width, height;
-	tex1.GetDimensions(width, height);
-	const float2 pos = (gxy + 1) / float2(width, height);
-	
-	if (any(tex1.GatherRed(sam, pos) != tex2.GatherRed(sam, pos))) {
-		result[0] = 1u;
-		return;
+	tex.GetDimensions(width, height);
+
+	const uint2 origin = (gid.xy << 5) + (tid.xy << 2);
+	uint2 sum = 0;
+
+	[unroll]
+	for (uint y = 0; y < 4; ++y) {
+		[unroll]
+		for (uint x = 0; x < 4; ++x) {
+			const uint2 pos = origin + uint2(x, y);
+			if (pos.x < width && pos.y < height) {
+				sum += HashTexel(pos, asuint(tex[pos].rgb));
+			}
+		}
 	}
-	
-	if (any(tex1.GatherGreen(sam, pos) != tex2.GatherGreen(sam, pos))) {
-		result[0] = 1u;
+
+	// 块内所有像素的哈希之和，和顺序无关
+	InterlockedAdd(hash0, sum.x);
+	InterlockedAdd(hash1, sum.y);
+	GroupMemoryBarrierWithGroupSync();
+
+	if (gi != 0) {
 		return;
 	}
-	
-	if (any(tex1.GatherBlue(sam, pos) != tex2.GatherBlue(sam, pos))) {
-		result[0] = 1u;
+
+	const uint idx = (gid.y * ((width + 31) >> 5) + gid.x) * 2;
+	if (prevSignatures[idx] != hash0 || prevSignatures[idx + 1] != hash1) {
+		InterlockedAdd(result[0], 1u);
 	}
+
+	curSignatures[idx] = hash0;
+	curSignatures[idx + 1] = hash1;
 }
@@ -3,7 +3,7 @@
 #include "App.h"
 #include "DirectXHelper.h"
 #include "Logger.h"
-#include "Win32Helper.h"
+#include "ThreadPool.h"
 #include <d3d11_4.h>
 
 using namespace winrt::Magpie::implementation;
@@ -114,14 +114,14 @@ bool AdaptersService::_GatherAdapterInfos(
 
 	// 删除不支持功能级别 11 的显卡
 	wil::srwlock writeLock;
-	Win32Helper::RunParallel([&](uint32_t i) {
+	ThreadPool::Get().ParallelFor((uint32_t)adapters.size(), [&](uint32_t i) {
 		D3D_FEATURE_LEVEL fl = D3D_FEATURE_LEVEL_11_0;
 		if (FAILED(D3D11CreateDevice(adapters[i].get(), D3D_DRIVER_TYPE_UNKNOWN,
 			NULL, 0, &fl, 1, D3D11_SDK_VERSION, nullptr, nullptr, nullptr))) {
 			auto lock = writeLock.lock_exclusive();
 			adapterInfos[i].idx = std::numeric_limits<uint32_t>::max();
 		}
-	}, (uint32_t)adapters.size());
+	});
 
 	std::erase_if(adapterInfos, [](const AdapterInfo& info) {
 		return info.idx == std::numeric_limits<uint32_t>::max();
@@ -100,6 +100,8 @@ App& App::Get() {
 App::App() {
 	UnhandledException([](IInspectable const&, UnhandledExceptionEventArgs const& e) {
 		Logger::Get().ComCritical("未处理的异常", e.Exception().value);
+		// 日志由后台线程写入，进程随后终止
+		Logger::Get().Flush();
 
 		if (IsDebuggerPresent()) {
 			hstring errorMessage = e.Message();
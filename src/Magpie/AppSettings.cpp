@@ -105,6 +105,10 @@ static void WriteProfile(rapidjson::PrettyWriter<rapidjson::StringBuffer>& write
     writer.Bool(profile.isFrameRateLimiterEnabled);
     writer.Key("maxFrameRate");
     writer.Double(profile.maxFrameRate);
+    writer.Key("adaptiveQuality");
+    writer.Bool(profile.IsAdaptiveQuality());
+    writer.Key("framePacing");
+    writer.Bool(profile.IsFramePacing());
 
     writer.Key("3DGameMode");
     writer.Bool(profile.Is3DGameMode());
@@ -239,7 +243,7 @@ bool AppSettings::Initialize() noexcept {
     rapidjson::Document doc;
     doc.ParseInsitu(configText.data());
     if (doc.HasParseError()) {
-        Logger::Get().Error(fmt::format("解析配置失败\n\t错误码: {}", (int)doc.GetParseError()));
+        Logger::Get().Error("解析配置失败\n\t错误码: {}", (int)doc.GetParseError());
         ResourceLoader resourceLoader =
             ResourceLoader::GetForCurrentView(CommonSharedConstants::APP_RESOURCE_MAP_ID);
         hstring title = resourceLoader.GetString(L"AppSettings_ErrorDialog_NotValidJson");
@@ -334,7 +338,7 @@ void AppSettings::SetShortcut(ShortcutAction action, const Shortcut& value) {
     }
 
     _shortcuts[(size_t)action] = value;
-    Logger::Get().Info(fmt::format("热键 {} 已更改为 {}", ShortcutHelper::ToString(action), StrHelper::UTF16ToUTF8(value.ToString())));
+    Logger::Get().Info("热键 {} 已更改为 {}", ShortcutHelper::ToString(action), StrHelper::UTF16ToUTF8(value.ToString()));
     ShortcutChanged.Invoke(action);
 
     SaveAsync();
@@ -362,6 +366,9 @@ void AppSettings::IsDeveloperMode(bool value) noexcept {
         _isWarningsAreErrors = false;
         _duplicateFrameDetectionMode = DuplicateFrameDetectionMode::Dynamic;
         _isStatisticsForDynamicDetectionEnabled = false;
+        _isFrameTraceRecordingEnabled = false;
+        _isFrameContentRecordingEnabled = false;
+        _frameTraceReplayPath.clear();
         _isFP16Disabled = false;
     }
 
@@ -639,6 +646,12 @@ bool AppSettings::_Save(const _AppSettingsData& data) noexcept {
     writer.Uint((uint32_t)data._duplicateFrameDetectionMode);
     writer.Key("enableStatisticsForDynamicDetection");
     writer.Bool(data._isStatisticsForDynamicDetectionEnabled);
+    writer.Key("recordFrameTrace");
+    writer.Bool(data._isFrameTraceRecordingEnabled);
+    writer.Key("recordFrameContent");
+    writer.Bool(data._isFrameContentRecordingEnabled);
+    writer.Key("frameTraceReplayPath");
+    writer.String(StrHelper::UTF16ToUTF8(data._frameTraceReplayPath.native()).c_str());
     writer.Key("minFrameRate");
     writer.Double(data._minFrameRate);
     writer.Key("disableFP16");
@@ -833,6 +846,13 @@ void AppSettings::_LoadSettings(const rapidjson::GenericObject<true, rapidjson::
     _duplicateFrameDetectionMode = (::Magpie::DuplicateFrameDetectionMode)duplicateFrameDetectionMode;
 
     JsonHelper::ReadBool(root, "enableStatisticsForDynamicDetection", _isStatisticsForDynamicDetectionEnabled);
+    JsonHelper::ReadBool(root, "recordFrameTrace", _isFrameTraceRecordingEnabled);
+    JsonHelper::ReadBool(root, "recordFrameContent", _isFrameContentRecordingEnabled);
+    {
+        std::wstring value;
+        JsonHelper::ReadString(root, "frameTraceReplayPath", value);
+        _frameTraceReplayPath = std::move(value);
+    }
     JsonHelper::ReadFloat(root, "minFrameRate", _minFrameRate);
     JsonHelper::ReadBool(root, "disableFP16", _isFP16Disabled);
 
@@ -1057,6 +1077,8 @@ bool AppSettings::_LoadProfile(
     }
     JsonHelper::ReadBoolFlag(profileObj, "adjustCursorSpeed", ScalingFlags::AdjustCursorSpeed, profile.scalingFlags);
     JsonHelper::ReadBoolFlag(profileObj, "disableDirectFlip", ScalingFlags::DisableDirectFlip, profile.scalingFlags);
+    JsonHelper::ReadBoolFlag(profileObj, "adaptiveQuality", ScalingFlags::AdaptiveQuality, profile.scalingFlags);
+    JsonHelper::ReadBoolFlag(profileObj, "framePacing", ScalingFlags::FramePacing, profile.scalingFlags);
 
     uint32_t cursorScaling = (uint32_t)CursorScaling::NoScaling;
     JsonHelper::ReadUInt(profileObj, "cursorScaling", cursorScaling);
@@ -54,6 +54,8 @@ struct _AppSettingsData {
 	ToolbarState _windowedInitialToolbarState = ToolbarState::AutoHide;
 	// 为空表示 FOLDERID_Screenshots，支持绝对路径和相对路径
 	std::filesystem::path _screenshotsDir;
+	// 非空时回放此帧轨迹，支持绝对路径和相对路径
+	std::filesystem::path _frameTraceReplayPath;
 
 	OverlayOptions _overlayOptions;
 	
@@ -74,6 +76,8 @@ struct _AppSettingsData {
 	bool _isAutoCheckForUpdates = true;
 	bool _isCheckForPreviewUpdates = false;
 	bool _isStatisticsForDynamicDetectionEnabled = false;
+	bool _isFrameTraceRecordingEnabled = false;
+	bool _isFrameContentRecordingEnabled = false;
 	bool _isFP16Disabled = false;
 	// UI mode: true = simple mode, false = advanced mode
 	bool _isSimpleMode = true;
@@ -304,6 +308,29 @@ public:
 		SaveAsync();
 	}
 
+	bool IsFrameTraceRecordingEnabled() const noexcept {
+		return _isFrameTraceRecordingEnabled;
+	}
+
+	void IsFrameTraceRecordingEnabled(bool value) noexcept {
+		_isFrameTraceRecordingEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsFrameContentRecordingEnabled() const noexcept {
+		return _isFrameContentRecordingEnabled;
+	}
+
+	void IsFrameContentRecordingEnabled(bool value) noexcept {
+		_isFrameContentRecordingEnabled = value;
+		SaveAsync();
+	}
+
+	// 只能通过编辑配置文件修改
+	const std::filesystem::path& FrameTraceReplayPath() const noexcept {
+		return _frameTraceReplayPath;
+	}
+
 	float MinFrameRate() const noexcept {
 		return _minFrameRate;
 	}
@@ -5,6 +5,7 @@
 #include "EffectsService.h"
 #include "Logger.h"
 #include "StrHelper.h"
+#include "ThreadPool.h"
 #include "Win32Helper.h"
 
 using namespace winrt;
@@ -60,8 +61,9 @@ fire_and_forget EffectsService::Initialize() {
 	// 用于同步 _effectsMap 和 _effects 的初始化
 	wil::srwlock srwLock;
 
-	// 并行解析效果
-	Win32Helper::RunParallel([&](uint32_t id) {
+	// 并行解析效果。启动时不急于使用结果，不应延迟开始缩放时的编译
+	TaskGroup parseGroup(TaskPriority::Background);
+	ThreadPool::Get().ParallelFor(parseGroup, nEffect, 1, [&](uint32_t id) {
 		EffectDesc effectDesc;
 
 		effectDesc.name = StrHelper::UTF16ToUTF8(effectNames[id]);
@@ -94,7 +96,7 @@ fire_and_forget EffectsService::Initialize() {
 		auto lock = srwLock.lock_exclusive();
 		_effectsMap.emplace(effect.name, (uint32_t)_effects.size());
 		_effects.emplace_back(std::move(effect));
-	}, nEffect);
+	});
 
 	_initialized.store(true, std::memory_order_release);
 	_initialized.notify_one();
@@ -605,6 +605,36 @@ void HomeViewModel::IsStatisticsForDynamicDetectionEnabled(bool value) {
 	RaisePropertyChanged(L"IsStatisticsForDynamicDetectionEnabled");
 }
 
+bool HomeViewModel::IsFrameTraceRecordingEnabled() const noexcept {
+	return AppSettings::Get().IsFrameTraceRecordingEnabled();
+}
+
+void HomeViewModel::IsFrameTraceRecordingEnabled(bool value) {
+	AppSettings& settings = AppSettings::Get();
+
+	if (settings.IsFrameTraceRecordingEnabled() == value) {
+		return;
+	}
+
+	settings.IsFrameTraceRecordingEnabled(value);
+	RaisePropertyChanged(L"IsFrameTraceRecordingEnabled");
+}
+
+bool HomeViewModel::IsFrameContentRecordingEnabled() const noexcept {
+	return AppSettings::Get().IsFrameContentRecordingEnabled();
+}
+
+void HomeViewModel::IsFrameContentRecordingEnabled(bool value) {
+	AppSettings& settings = AppSettings::Get();
+
+	if (settings.IsFrameContentRecordingEnabled() == value) {
+		return;
+	}
+
+	settings.IsFrameContentRecordingEnabled(value);
+	RaisePropertyChanged(L"IsFrameContentRecordingEnabled");
+}
+
 void HomeViewModel::_ScalingService_IsTimerOnChanged(bool value, bool) {
 	if (!value) {
 		RaisePropertyChanged(L"TimerProgressRingValue");
@@ -116,6 +116,12 @@ struct HomeViewModel : HomeViewModelT<HomeViewModel>, wil::notify_property_chang
 	bool IsStatisticsForDynamicDetectionEnabled() const noexcept;
 	void IsStatisticsForDynamicDetectionEnabled(bool value);
 
+	bool IsFrameTraceRecordingEnabled() const noexcept;
+	void IsFrameTraceRecordingEnabled(bool value);
+
+	bool IsFrameContentRecordingEnabled() const noexcept;
+	void IsFrameContentRecordingEnabled(bool value);
+
 private:
 	void _ScalingService_IsTimerOnChanged(bool value, bool windowedMode);
 
@@ -58,6 +58,8 @@ struct Profile {
 	DEFINE_FLAG_ACCESSOR(IsCaptureTitleBar, ScalingFlags::CaptureTitleBar, scalingFlags)
 	DEFINE_FLAG_ACCESSOR(IsAdjustCursorSpeed, ScalingFlags::AdjustCursorSpeed, scalingFlags)
 	DEFINE_FLAG_ACCESSOR(IsDirectFlipDisabled, ScalingFlags::DisableDirectFlip, scalingFlags)
+	DEFINE_FLAG_ACCESSOR(IsAdaptiveQuality, ScalingFlags::AdaptiveQuality, scalingFlags)
+	DEFINE_FLAG_ACCESSOR(IsFramePacing, ScalingFlags::FramePacing, scalingFlags)
 
 	// 默认规则 name、pathRule 和 classNameRule 均为空
 	std::wstring name;
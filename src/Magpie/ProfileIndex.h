@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#if __has_include(<parallel_hashmap/phmap.h>)
+#include <parallel_hashmap/phmap.h>
+#else
+#include <unordered_map>
+#include <unordered_set>
+#endif
+
+namespace Magpie {
+
+// 按应用和类名查找配置文件的索引，由 ProfileService 在配置文件变化后重建。
+// 只由头文件实现，不依赖 Windows，tools/ProfileMatchBench 也使用它。没有 phmap 时使用标准库的容器。
+class ProfileIndex {
+public:
+	// 索引的键。类名中不会有空字符，可以作为分隔符
+	static std::wstring MakeKey(
+		bool isPackaged,
+		std::wstring_view pathOrAumid,
+		std::wstring_view parsedClassName
+	) noexcept {
+		std::wstring key;
+		key.reserve(parsedClassName.size() + pathOrAumid.size() + 2);
+		key.push_back(isPackaged ? L'1' : L'0');
+		key.append(parsedClassName);
+		key.push_back(L'\0');
+		key.append(pathOrAumid);
+		return key;
+	}
+
+	// TProfile 需包含 isPackaged、pathRule 和 classNameRule，isAutoScale(profile) 返回是否启用了自动缩放。
+	// 自动缩放的设置也保存在索引中，因此修改后同样需要重建
+	template <typename TProfile, typename IsAutoScale>
+	void Build(const std::vector<TProfile>& profiles, IsAutoScale&& isAutoScale) noexcept {
+		_index.clear();
+		_classNames.clear();
+		_anyAutoScale = false;
+
+		for (uint32_t i = 0, count = (uint32_t)profiles.size(); i < count; ++i) {
+			const TProfile& profile = profiles[i];
+			const bool autoScale = isAutoScale(profile);
+			// 靠前的配置文件优先
+			_index[MakeKey(profile.isPackaged, profile.pathRule, profile.classNameRule)].push_back({ i, autoScale });
+			_classNames.emplace(profile.classNameRule);
+			_anyAutoScale |= autoScale;
+		}
+	}
+
+	// 没有配置文件使用这个类名时窗口不可能匹配，无需获取它的应用信息
+	bool ContainsClassName(const std::wstring& parsedClassName) const noexcept {
+		return _classNames.contains(parsedClassName);
+	}
+
+	// 返回第一个匹配的配置文件的序号
+	std::optional<uint32_t> Find(const std::wstring& key, bool forAutoScale) const noexcept {
+		auto it = _index.find(key);
+		if (it == _index.end()) {
+			return std::nullopt;
+		}
+
+		// 通常只有一个，除非配置文件被手动编辑过
+		for (const _Entry& entry : it->second) {
+			if (!forAutoScale || entry.isAutoScale) {
+				return entry.profileIdx;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	// 是否有配置文件启用了自动缩放
+	bool AnyAutoScale() const noexcept {
+		return _anyAutoScale;
+	}
+
+private:
+	struct _Entry {
+		uint32_t profileIdx;
+		bool isAutoScale;
+	};
+
+#if __has_include(<parallel_hashmap/phmap.h>)
+	phmap::flat_hash_map<std::wstring, std::vector<_Entry>> _index;
+	phmap::flat_hash_set<std::wstring> _classNames;
+#else
+	std::unordered_map<std::wstring, std::vector<_Entry>> _index;
+	std::unordered_set<std::wstring> _classNames;
+#endif
+	bool _anyAutoScale = false;
+};
+
+}
@@ -98,6 +98,17 @@ static std::wstring_view ParseClassName(std::wstring_view className) noexcept {
 	return className;
 }
 
+// 检查过的窗口和进程最多保留的数量。前台窗口通常只在少数几个窗口间切换
+static constexpr size_t WINDOW_CACHE_SIZE = 32;
+static constexpr size_t PROCESS_CACHE_SIZE = 16;
+
+// 将第 idx 个元素移到最前面
+template <typename T>
+static T& MoveToFront(SmallVectorImpl<T>& cache, size_t idx) noexcept {
+	std::rotate(cache.begin(), cache.begin() + idx, cache.begin() + idx + 1);
+	return cache.front();
+}
+
 static bool TestNewProfileImpl(
 	bool isPackaged,
 	std::wstring_view pathOrAumid,
@@ -155,6 +166,7 @@ bool ProfileService::AddProfile(
 	profile.pathRule = pathOrAumid;
 	profile.classNameRule = parsedClassName;
 
+	_isIndexDirty = true;
 	ProfileAdded.Invoke(std::ref(profile));
 
 	AppSettings::Get().SaveAsync();
@@ -171,6 +183,7 @@ void ProfileService::RenameProfile(uint32_t profileIdx, std::wstring_view newNam
 void ProfileService::RemoveProfile(uint32_t profileIdx) {
 	std::vector<Profile>& profiles = AppSettings::Get().Profiles();
 	profiles.erase(profiles.begin() + profileIdx);
+	_isIndexDirty = true;
 	ProfileRemoved.Invoke(profileIdx);
 	AppSettings::Get().SaveAsync();
 }
@@ -182,70 +195,49 @@ bool ProfileService::MoveProfile(uint32_t profileIdx, bool isMoveUp) {
 	}
 
 	std::swap(profiles[profileIdx], profiles[isMoveUp ? (size_t)profileIdx - 1 : (size_t)profileIdx + 1]);
+	_isIndexDirty = true;
 	ProfileMoved.Invoke(profileIdx, isMoveUp);
 
 	AppSettings::Get().SaveAsync();
 	return true;
 }
 
-static bool AnyAutoScaleProfile(const std::vector<Profile>& profiles) noexcept {
-	for (const Profile& profile : profiles) {
-		if (profile.autoScale != AutoScale::Disabled) {
-			return true;
-		}
-	}
-	return false;
+void ProfileService::SetAutoScale(Profile& profile, AutoScale value) noexcept {
+	profile.autoScale = value;
+	_isIndexDirty = true;
+}
+
+bool ProfileService::IsAutoScaleEnabled() noexcept {
+	_UpdateIndex();
+	return _profileIndex.AnyAutoScale();
 }
 
 const Profile* ProfileService::GetProfileForWindow(HWND hWnd, bool forAutoScale) noexcept {
-	const std::vector<Profile>& profiles = AppSettings::Get().Profiles();
+	_UpdateIndex();
 
 	// 作为优化，先检查有没有配置文件启用了自动缩放
-	if (forAutoScale && !AnyAutoScaleProfile(profiles)) {
+	if (forAutoScale && !_profileIndex.AnyAutoScale()) {
 		return nullptr;
 	}
-	
-	// 先检查窗口类名，这比获取可执行文件名快得多
-	std::wstring className = Win32Helper::GetWindowClassName(hWnd);
-	std::wstring_view parsedClassName = ParseClassName(className);
 
-	std::wstring path;
-	std::optional<bool> isPackaged;
+	std::optional<uint32_t> profileIdx;
 
-	for (const Profile& profile : profiles) {
-		if (forAutoScale && profile.autoScale == AutoScale::Disabled) {
-			continue;
+	// 先检查窗口类名，这比获取可执行文件名快得多
+	if (_WindowInfo* windowInfo = _GetWindowInfo(hWnd); windowInfo && _profileIndex.ContainsClassName(windowInfo->className)) {
+		bool keepProfileKey = true;
+		if (!windowInfo->profileKey) {
+			keepProfileKey = _ResolveProfileKey(hWnd, *windowInfo);
 		}
 
-		if (profile.classNameRule != parsedClassName) {
-			continue;
-		}
+		profileIdx = _profileIndex.Find(*windowInfo->profileKey, forAutoScale);
 
-		if (!isPackaged.has_value()) {
-			AppXReader appxReader;
-			isPackaged = appxReader.Initialize(hWnd);
-			if (*isPackaged) {
-				// 打包应用匹配 AUMID
-				path = appxReader.AUMID();
-			}
-		}
-
-		if (profile.isPackaged != *isPackaged) {
-			continue;
+		if (!keepProfileKey) {
+			windowInfo->profileKey.reset();
 		}
+	}
 
-		if (!*isPackaged && path.empty()) {
-			// 桌面应用匹配路径
-			path = Win32Helper::GetWindowPath(hWnd);
-			if (path.empty()) {
-				// 获取路径失败
-				break;
-			}
-		}
-		
-		if (profile.pathRule == path) {
-			return &profile;
-		}
+	if (profileIdx) {
+		return &AppSettings::Get().Profiles()[*profileIdx];
 	}
 
 	return forAutoScale ? nullptr : &DefaultProfile();
@@ -263,4 +255,96 @@ uint32_t ProfileService::GetProfileCount() noexcept {
 	return (uint32_t)AppSettings::Get().Profiles().size();
 }
 
+void ProfileService::_UpdateIndex() noexcept {
+	if (!_isIndexDirty) {
+		return;
+	}
+	_isIndexDirty = false;
+
+	_profileIndex.Build(AppSettings::Get().Profiles(), [](const Profile& profile) {
+		return profile.autoScale != AutoScale::Disabled;
+	});
+}
+
+ProfileService::_WindowInfo* ProfileService::_GetWindowInfo(HWND hWnd) noexcept {
+	DWORD processId = 0;
+	const DWORD threadId = GetWindowThreadProcessId(hWnd, &processId);
+	if (threadId == 0) {
+		// 窗口已被销毁
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < _windowCache.size(); ++i) {
+		_WindowInfo& info = _windowCache[i];
+		if (info.hWnd != hWnd) {
+			continue;
+		}
+
+		if (info.threadId == threadId && info.processId == processId) {
+			return &MoveToFront(_windowCache, i);
+		}
+
+		// 原窗口已被销毁，句柄被新窗口复用
+		_windowCache.erase(_windowCache.begin() + i);
+		break;
+	}
+
+	if (_windowCache.size() >= WINDOW_CACHE_SIZE) {
+		_windowCache.pop_back();
+	}
+
+	return &*_windowCache.insert(_windowCache.begin(), _WindowInfo{
+		.hWnd = hWnd,
+		.threadId = threadId,
+		.processId = processId,
+		.className = std::wstring(ParseClassName(Win32Helper::GetWindowClassName(hWnd)))
+	});
+}
+
+bool ProfileService::_ResolveProfileKey(HWND hWnd, _WindowInfo& windowInfo) noexcept {
+	AppXReader appxReader;
+	if (appxReader.Initialize(hWnd)) {
+		// 打包应用匹配 AUMID
+		windowInfo.profileKey = ProfileIndex::MakeKey(true, appxReader.AUMID(), windowInfo.className);
+		return true;
+	}
+
+	// 桌面应用匹配路径。获取路径失败时路径为空，不会匹配任何配置文件
+	windowInfo.profileKey = ProfileIndex::MakeKey(false, _GetProcessPath(hWnd, windowInfo.processId), windowInfo.className);
+	// UWP 应用尚未完成初始化时可能无法获取 AUMID，下次检查时重试
+	return windowInfo.className != L"ApplicationFrameWindow";
+}
+
+const std::wstring& ProfileService::_GetProcessPath(HWND hWnd, DWORD processId) noexcept {
+	for (size_t i = 0; i < _processCache.size(); ++i) {
+		// 持有进程句柄时进程 ID 不会被复用，因此无需检查进程是否已经退出
+		if (_processCache[i].processId == processId) {
+			return MoveToFront(_processCache, i).path;
+		}
+	}
+
+	static const std::wstring emptyPath;
+
+	wil::unique_process_handle hProc = Win32Helper::GetWindowProcessHandle(hWnd);
+	if (!hProc) {
+		Logger::Get().Error("GetWindowProcessHandle 失败");
+		return emptyPath;
+	}
+
+	std::wstring path = Win32Helper::GetProcessPath(hProc.get());
+	if (path.empty()) {
+		return emptyPath;
+	}
+
+	if (_processCache.size() >= PROCESS_CACHE_SIZE) {
+		_processCache.pop_back();
+	}
+
+	return _processCache.insert(_processCache.begin(), _ProcessInfo{
+		.processId = processId,
+		.hProcess = std::move(hProc),
+		.path = std::move(path)
+	})->path;
+}
+
 }
@@ -1,9 +1,12 @@
 #pragma once
 #include "Event.h"
+#include "ProfileIndex.h"
+#include "SmallVector.h"
 
 namespace Magpie {
 
 struct Profile;
+enum class AutoScale;
 
 class ProfileService {
 public:
@@ -28,6 +31,12 @@ public:
 
 	const Profile* GetProfileForWindow(HWND hWnd, bool forAutoScale) noexcept;
 
+	// 修改自动缩放设置必须通过此函数，以便更新索引
+	void SetAutoScale(Profile& profile, AutoScale value) noexcept;
+
+	// 是否有配置文件启用了自动缩放
+	bool IsAutoScaleEnabled() noexcept;
+
 	Profile& DefaultProfile() noexcept;
 
 	Profile& GetProfile(uint32_t idx) noexcept;
@@ -41,6 +50,42 @@ public:
 
 private:
 	ProfileService() = default;
+
+	// 窗口的类名和所属的应用在整个生命周期中不会改变，只需在第一次检查时获取
+	struct _WindowInfo {
+		HWND hWnd = NULL;
+		// 用于检测窗口已被销毁而句柄被复用
+		DWORD threadId = 0;
+		DWORD processId = 0;
+		// 解析后的类名
+		std::wstring className;
+		// 索引的键，只在有配置文件匹配类名时才获取应用信息
+		std::optional<std::wstring> profileKey;
+	};
+
+	struct _ProcessInfo {
+		DWORD processId = 0;
+		// 保持句柄打开以防止进程 ID 被复用
+		wil::unique_process_handle hProcess;
+		std::wstring path;
+	};
+
+	void _UpdateIndex() noexcept;
+
+	_WindowInfo* _GetWindowInfo(HWND hWnd) noexcept;
+
+	// 结果保存在 windowInfo.profileKey 中，返回 false 表示结果不应被缓存
+	bool _ResolveProfileKey(HWND hWnd, _WindowInfo& windowInfo) noexcept;
+
+	const std::wstring& _GetProcessPath(HWND hWnd, DWORD processId) noexcept;
+
+	ProfileIndex _profileIndex;
+	// 添加、删除、移动配置文件或修改自动缩放设置后需要重建索引
+	bool _isIndexDirty = true;
+
+	// 最近检查过的窗口和进程，最近使用的在前
+	SmallVector<_WindowInfo> _windowCache;
+	SmallVector<_ProcessInfo> _processCache;
 };
 
 }
@@ -391,7 +391,7 @@ void ProfileViewModel::AutoScale(int value) {
 		return;
 	}
 
-	_data->autoScale = enumValue;
+	ProfileService::Get().SetAutoScale(*_data, enumValue);
 	AppSettings::Get().SaveAsync();
 
 	RaisePropertyChanged(L"AutoScale");
@@ -580,6 +580,36 @@ void ProfileViewModel::MaxFrameRate(double value) {
 	RaisePropertyChanged(L"MaxFrameRate");
 }
 
+bool ProfileViewModel::IsAdaptiveQuality() const noexcept {
+	return _data->IsAdaptiveQuality();
+}
+
+void ProfileViewModel::IsAdaptiveQuality(bool value) {
+	if (_data->IsAdaptiveQuality() == value) {
+		return;
+	}
+
+	_data->IsAdaptiveQuality(value);
+	AppSettings::Get().SaveAsync();
+
+	RaisePropertyChanged(L"IsAdaptiveQuality");
+}
+
+bool ProfileViewModel::IsFramePacing() const noexcept {
+	return _data->IsFramePacing();
+}
+
+void ProfileViewModel::IsFramePacing(bool value) {
+	if (_data->IsFramePacing() == value) {
+		return;
+	}
+
+	_data->IsFramePacing(value);
+	AppSettings::Get().SaveAsync();
+
+	RaisePropertyChanged(L"IsFramePacing");
+}
+
 bool ProfileViewModel::IsCaptureTitleBar() const noexcept {
 	return _data->IsCaptureTitleBar();
 }
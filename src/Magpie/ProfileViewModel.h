@@ -99,6 +99,12 @@ struct ProfileViewModel : ProfileViewModelT<ProfileViewModel>,
 	double MaxFrameRate() const noexcept;
 	void MaxFrameRate(double value);
 
+	bool IsAdaptiveQuality() const noexcept;
+	void IsAdaptiveQuality(bool value);
+
+	bool IsFramePacing() const noexcept;
+	void IsFramePacing(bool value);
+
 	bool IsCaptureTitleBar() const noexcept;
 	void IsCaptureTitleBar(bool value);
 
@@ -124,7 +124,7 @@ fire_and_forget ScalingModesViewModel::Import() {
 		// 导入时放宽 json 格式限制
 		doc.ParseInsitu<rapidjson::kParseCommentsFlag | rapidjson::kParseTrailingCommasFlag>(json.data());
 		if (doc.HasParseError()) {
-			Logger::Get().Error(fmt::format("解析 json 失败\n\t错误码: {}", (int)doc.GetParseError()));
+			Logger::Get().Error("解析 json 失败\n\t错误码: {}", (int)doc.GetParseError());
 		} else if (doc.IsObject() &&
 			ScalingModesService::Get().Import(((const rapidjson::Document&)doc).GetObj(), false)) {
 			// 导入成功
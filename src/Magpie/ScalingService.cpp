@@ -205,7 +205,7 @@ static void ShowError(HWND hWnd, ScalingError error) noexcept {
 		ResourceLoader::GetForViewIndependentUse(CommonSharedConstants::APP_RESOURCE_MAP_ID);
 	hstring title = isFail ? resourceLoader.GetString(L"Message_ScalingFailed") : hstring{};
 	ToastService::Get().ShowMessageOnWindow(title, resourceLoader.GetString(key), hWnd);
-	Logger::Get().Error(fmt::format("缩放失败\n\t错误码: {}", (int)error));
+	Logger::Get().Error("缩放失败\n\t错误码: {}", (int)error);
 }
 
 static bool IsPopupWindow(HWND hwndPopup, HWND hwndOwner) noexcept {
@@ -302,6 +302,10 @@ void ScalingService::_ScalingRuntime_StateChanged(ScalingState value) {
 
 			// 缩放结束后清空 _hwndCurSrc，等待状态下则保留
 			_hwndCurSrc = NULL;
+
+			if (_scalingRuntime && !ProfileService::Get().IsAutoScaleEnabled()) {
+				_scalingRuntime->ReleasePooledDevices();
+			}
 		}
 
 		IsScalingChanged.Invoke(value == ScalingState::Scaling);
@@ -463,6 +467,9 @@ ScalingError ScalingService::_StartScaleImpl(HWND hWnd, const Profile& profile,
 	options.IsSimulateExclusiveFullscreen(settings.IsSimulateExclusiveFullscreen());
 	options.duplicateFrameDetectionMode = settings.DuplicateFrameDetectionMode();
 	options.IsStatisticsForDynamicDetectionEnabled(settings.IsStatisticsForDynamicDetectionEnabled());
+	options.IsFrameTraceRecordingEnabled(settings.IsFrameTraceRecordingEnabled());
+	options.IsFrameContentRecordingEnabled(settings.IsFrameContentRecordingEnabled());
+	options.frameTraceReplayPath = settings.FrameTraceReplayPath();
 	options.IsInlineParams(settings.IsInlineParams());
 	options.IsFP16Disabled(settings.IsFP16Disabled());
 
@@ -76,7 +76,7 @@ LRESULT ShortcutService::_WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
 	if (message == WM_HOTKEY) {
 		if (wParam >= 0 && wParam < (UINT)ShortcutAction::COUNT_OR_NONE) {
 			ShortcutAction action = (ShortcutAction)wParam;
-			Logger::Get().Info(fmt::format("热键 {} 激活（Hotkey）", ShortcutHelper::ToString(action)));
+			Logger::Get().Info("热键 {} 激活（Hotkey）", ShortcutHelper::ToString(action));
 			_FireShortcut(action);
 			return 0;
 		}
@@ -209,7 +209,7 @@ LRESULT CALLBACK ShortcutService::_LowLevelKeyboardProc(int nCode, WPARAM wParam
 				App::Get().Dispatcher().RunAsync(
 					CoreDispatcherPriority::Normal,
 					[action]() {
-						Logger::Get().Info(fmt::format("热键 {} 激活（Keyboard Hook）", ShortcutHelper::ToString(action)));
+						Logger::Get().Info("热键 {} 激活（Keyboard Hook）", ShortcutHelper::ToString(action));
 						Get()._FireShortcut(action);
 					}
 				);
@@ -360,7 +360,7 @@ fire_and_forget UpdateService::DownloadAndInstall() {
 		nullptr
 	);
 	if (ec < 0) {
-		Logger::Get().Error(fmt::format("解压失败，错误代码: {}", ec));
+		Logger::Get().Error("解压失败，错误代码: {}", ec);
 		co_await App::Get().Dispatcher();
 		_Status(UpdateStatus::ErrorWhileDownloading);
 		co_return;
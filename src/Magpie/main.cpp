@@ -31,13 +31,25 @@ static void SetWorkingDir() noexcept {
 }
 
 static void InitializeLogger(const wchar_t* logFilePath) noexcept {
-	// 最多两个日志文件，每个最多 500KB
+	// 最多两个日志文件，每个最多 500KB。缩放时后端线程也会记录日志，因此在后台线程中写入。
+	// 定义 MP_BINARY_LOG 时写入二进制日志，开销最小，但需使用 tools/LogDecoder 解码
 	Logger::Get().Initialize(
 		spdlog::level::info,
 		logFilePath,
 		CommonSharedConstants::LOG_MAX_SIZE,
-		1
+		1,
+#ifdef MP_BINARY_LOG
+		LogMode::Binary
+#else
+		LogMode::Async
+#endif
 	);
+
+	// 崩溃时写入后台线程尚未写入的日志
+	SetUnhandledExceptionFilter([](EXCEPTION_POINTERS*) -> LONG {
+		Logger::Get().FlushOnCrash();
+		return EXCEPTION_CONTINUE_SEARCH;
+	});
 }
 
 int APIENTRY wWinMain(
@@ -73,7 +85,7 @@ int APIENTRY wWinMain(
 		CommonSharedConstants::LOG_PATH :
 		CommonSharedConstants::REGISTER_TOUCH_HELPER_LOG_PATH);
 
-	Logger::Get().Info(fmt::format("程序启动\n\t版本: {}\n\tOS 版本: {}\n\t管理员: {}",
+	Logger::Get().Info("程序启动\n\t版本: {}\n\tOS 版本: {}\n\t管理员: {}",
 #ifdef MP_VERSION_TAG
 		STRING(MP_VERSION_TAG),
 #else
@@ -81,7 +93,7 @@ int APIENTRY wWinMain(
 #endif
 		Win32Helper::GetOSVersion().ToString<char>(),
 		Win32Helper::IsProcessElevated() ? "是" : "否"
-	));
+	);
 
 	if (mode == RegisterTouchHelper) {
 		// 使 TouchHelper 获得 UIAccess 权限
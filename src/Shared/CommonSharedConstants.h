@@ -28,6 +28,7 @@ struct CommonSharedConstants {
 	static constexpr const wchar_t* EFFECTS_DIR = L"effects";
 	static constexpr const wchar_t* CACHE_DIR = L"cache";
 	static constexpr const wchar_t* UPDATE_DIR = L"update";
+	static constexpr const wchar_t* TRACES_DIR = L"traces";
 
 	static constexpr const wchar_t* OPTION_LAUNCH_WITHOUT_WINDOW = L"-t";
 
@@ -0,0 +1,269 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "UTFTranscoder.h"
+
+// 二进制日志的格式，由 Logger 在 LogMode::Binary 模式下写入，tools/LogDecoder 解码为文本。
+// 所有字段均为小端序，没有填充和对齐，可在任何平台上读取。只由头文件实现，无需 Windows 也可以使用。
+//
+// 文件由一个 LogFileHeader 和紧随其后的若干条目组成，每个条目以一个字节的 LogEntryType 开头：
+// * String: uint32 编号、uint32 长度和字符串的内容。记录通过编号引用文件名、函数名和格式字符串，
+//   每个字符串只写入一次，在第一次被引用之前。
+// * Record: int64 时间戳（自 Unix 纪元起算，单位为纳秒）、uint8 日志级别（spdlog::level::level_enum）、
+//   uint32 文件名编号、uint32 函数名编号、uint32 行号、uint32 格式字符串编号、uint8 参数个数，
+//   然后是每个参数。
+// * Dropped: uint32 因缓冲区已满被丢弃的日志条数。
+//
+// 参数以一个字节的 LogArgType 开头，之后的内容取决于类型：
+// Int 为 int64，UInt 和 Pointer 为 uint64，Float 为 float，Double 为 double，Bool 和 Char 为 uint8，
+// String 为 uint32 长度和 UTF-8 编码的内容，WString 为 uint32 长度（UTF-16 编码单元的个数）和
+// UTF-16 编码的内容。WString 在版本 2 中加入，宽字符串不必在记录日志的线程中转换为 UTF-8。
+//
+// Logger 的每线程缓冲区中参数也使用相同的编码，因此写入二进制日志时无需格式化。参数的编码和解码都在
+// 这里实现，Logger 和 tools/LogDecoder 共用。
+enum class LogEntryType : uint8_t {
+	String = 1,
+	Record = 2,
+	Dropped = 3
+};
+
+enum class LogArgType : uint8_t {
+	Int,
+	UInt,
+	Float,
+	Double,
+	Bool,
+	Char,
+	String,
+	Pointer,
+	WString
+};
+
+// 解码后的参数。Int 使用 intValue；UInt、Bool、Char 和 Pointer 使用 uintValue；
+// Float 使用 floatValue，Double 使用 doubleValue；String 和 WString 使用 stringValue，它指向原始数据，
+// WString 的 stringValue 是 UTF-16 编码的字节，可能没有对齐
+struct LogArg {
+	LogArgType type = LogArgType::Int;
+	int64_t intValue = 0;
+	uint64_t uintValue = 0;
+	float floatValue = 0;
+	double doubleValue = 0;
+	std::string_view stringValue;
+};
+
+struct LogRecordFormat {
+	// "MPBL"
+	static constexpr uint32_t MAGIC = 0x4C42504D;
+	static constexpr uint16_t VERSION = 2;
+	// 编号为 0 的字符串表示空指针
+	static constexpr uint32_t NULL_STRING_ID = 0;
+
+	// 宽字符串以 UTF-16 编码保存，wchar_t 为 32 位的平台上只支持 char16_t
+	template <typename T>
+	static constexpr bool IS_WSTRING_ARG = std::is_convertible_v<const T&, std::u16string_view> ||
+		(sizeof(wchar_t) == 2 && std::is_convertible_v<const T&, std::wstring_view>);
+
+	// 是否可以直接编码，其他类型的参数需要先格式化为字符串
+	template <typename T>
+	static constexpr bool IS_DIRECT_ARG = std::is_convertible_v<const T&, std::string_view> ||
+		IS_WSTRING_ARG<T> || std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_floating_point_v<T> ||
+		(std::is_integral_v<T> && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t> &&
+			!std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>) ||
+		std::is_same_v<T, void*> || std::is_same_v<T, const void*>;
+
+	// 编码后的字节数，T 必须满足 IS_DIRECT_ARG
+	template <typename T>
+	static uint32_t ArgSize(const T& arg) noexcept {
+		if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+			return 1 + sizeof(uint32_t) + (uint32_t)std::string_view(arg).size();
+		} else if constexpr (IS_WSTRING_ARG<T>) {
+			return 1 + sizeof(uint32_t) + (uint32_t)_WStringBytes(arg).size();
+		} else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+			return 1 + sizeof(uint8_t);
+		} else if constexpr (std::is_same_v<T, float>) {
+			return 1 + sizeof(float);
+		} else {
+			return 1 + sizeof(uint64_t);
+		}
+	}
+
+	// 将参数编码到 dest，返回下一个参数的位置。dest 至少要有 ArgSize(arg) 字节
+	template <typename T>
+	static uint8_t* WriteArg(uint8_t* dest, const T& arg) noexcept {
+		if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+			const std::string_view str(arg);
+			dest = _WriteValue(dest, LogArgType::String, (uint32_t)str.size());
+			std::memcpy(dest, str.data(), str.size());
+			return dest + str.size();
+		} else if constexpr (IS_WSTRING_ARG<T>) {
+			const std::string_view bytes = _WStringBytes(arg);
+			dest = _WriteValue(dest, LogArgType::WString, (uint32_t)(bytes.size() / 2));
+			std::memcpy(dest, bytes.data(), bytes.size());
+			return dest + bytes.size();
+		} else if constexpr (std::is_same_v<T, bool>) {
+			return _WriteValue(dest, LogArgType::Bool, (uint8_t)arg);
+		} else if constexpr (std::is_same_v<T, char>) {
+			return _WriteValue(dest, LogArgType::Char, (uint8_t)arg);
+		} else if constexpr (std::is_same_v<T, float>) {
+			return _WriteValue(dest, LogArgType::Float, arg);
+		} else if constexpr (std::is_floating_point_v<T>) {
+			return _WriteValue(dest, LogArgType::Double, (double)arg);
+		} else if constexpr (std::is_signed_v<T>) {
+			return _WriteValue(dest, LogArgType::Int, (int64_t)arg);
+		} else if constexpr (std::is_unsigned_v<T>) {
+			return _WriteValue(dest, LogArgType::UInt, (uint64_t)arg);
+		} else {
+			return _WriteValue(dest, LogArgType::Pointer, (uint64_t)(uintptr_t)arg);
+		}
+	}
+
+	template <typename T>
+	static const uint8_t* ReadValue(const uint8_t* data, const uint8_t* end, T& value) noexcept {
+		if (end - data < (ptrdiff_t)sizeof(T)) {
+			return nullptr;
+		}
+
+		std::memcpy(&value, data, sizeof(T));
+		return data + sizeof(T);
+	}
+
+	// 读取一个参数，返回下一个参数的位置，数据不完整或类型未知时返回 nullptr
+	static const uint8_t* ReadArg(const uint8_t* data, const uint8_t* end, LogArg& arg) noexcept {
+		uint8_t type;
+		data = ReadValue(data, end, type);
+		if (!data) {
+			return nullptr;
+		}
+
+		arg.type = (LogArgType)type;
+		switch (arg.type) {
+		case LogArgType::Int:
+			return ReadValue(data, end, arg.intValue);
+		case LogArgType::UInt:
+		case LogArgType::Pointer:
+			return ReadValue(data, end, arg.uintValue);
+		case LogArgType::Float:
+			return ReadValue(data, end, arg.floatValue);
+		case LogArgType::Double:
+			return ReadValue(data, end, arg.doubleValue);
+		case LogArgType::Bool:
+		case LogArgType::Char:
+		{
+			uint8_t value;
+			data = ReadValue(data, end, value);
+			arg.uintValue = value;
+			return data;
+		}
+		case LogArgType::String:
+		{
+			uint32_t size;
+			data = ReadValue(data, end, size);
+			if (!data || end - data < (ptrdiff_t)size) {
+				return nullptr;
+			}
+
+			arg.stringValue = std::string_view((const char*)data, size);
+			return data + size;
+		}
+		case LogArgType::WString:
+		{
+			uint32_t size;
+			data = ReadValue(data, end, size);
+			if (!data || (end - data) / 2 < (ptrdiff_t)size) {
+				return nullptr;
+			}
+
+			arg.stringValue = std::string_view((const char*)data, (size_t)size * 2);
+			return data + (size_t)size * 2;
+		}
+		default:
+			return nullptr;
+		}
+	}
+
+	// 将解码后的参数添加到 fmt::dynamic_format_arg_store。宽字符串在这里转换为 UTF-8，由 store 保存副本，
+	// 其他字符串仍引用原始数据
+	template <typename Store>
+	static void PushArg(const LogArg& arg, Store& store) {
+		switch (arg.type) {
+		case LogArgType::Int:
+			store.push_back(arg.intValue);
+			break;
+		case LogArgType::UInt:
+			store.push_back(arg.uintValue);
+			break;
+		case LogArgType::Float:
+			store.push_back(arg.floatValue);
+			break;
+		case LogArgType::Double:
+			store.push_back(arg.doubleValue);
+			break;
+		case LogArgType::Bool:
+			store.push_back(arg.uintValue != 0);
+			break;
+		case LogArgType::Char:
+			store.push_back((char)arg.uintValue);
+			break;
+		case LogArgType::String:
+			store.push_back(arg.stringValue);
+			break;
+		case LogArgType::Pointer:
+			store.push_back((const void*)(uintptr_t)arg.uintValue);
+			break;
+		case LogArgType::WString:
+		{
+			store.push_back(_UTF16BytesToUTF8(arg.stringValue));
+			break;
+		}
+		}
+	}
+
+	// 将宽字符串参数转换为 UTF-8，用于在记录日志的线程中格式化
+	template <typename T>
+	static std::string WStringArgToUTF8(const T& arg) {
+		return _UTF16BytesToUTF8(_WStringBytes(arg));
+	}
+
+private:
+	static std::string _UTF16BytesToUTF8(std::string_view bytes) {
+		// 复制以确保对齐
+		std::u16string str(bytes.size() / 2, u'\0');
+		std::memcpy(str.data(), bytes.data(), str.size() * 2);
+
+		std::string result(str.size() * 3, '\0');
+		result.resize(UTFTranscoder::UTF16ToUTF8(std::u16string_view(str), result.data()));
+		return result;
+	}
+
+	template <typename T>
+	static std::string_view _WStringBytes(const T& arg) noexcept {
+		if constexpr (std::is_convertible_v<const T&, std::u16string_view>) {
+			const std::u16string_view str(arg);
+			return std::string_view((const char*)str.data(), str.size() * 2);
+		} else {
+			const std::wstring_view str(arg);
+			return std::string_view((const char*)str.data(), str.size() * 2);
+		}
+	}
+
+	template <typename T>
+	static uint8_t* _WriteValue(uint8_t* dest, LogArgType type, const T& value) noexcept {
+		*dest++ = (uint8_t)type;
+		std::memcpy(dest, &value, sizeof(T));
+		return dest + sizeof(T);
+	}
+};
+
+#pragma pack(push, 1)
+struct LogFileHeader {
+	uint32_t magic = LogRecordFormat::MAGIC;
+	uint16_t version = LogRecordFormat::VERSION;
+	uint16_t reserved = 0;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(LogFileHeader) == 8);
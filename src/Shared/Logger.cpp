@@ -2,43 +2,279 @@
 #include "Logger.h"
 #include "StrHelper.h"
 #include <spdlog/sinks/rotating_file_sink.h>
+#include <fmt/args.h>
+#include <thread>
+#include <unordered_map>
 
-bool Logger::Initialize(spdlog::level::level_enum logLevel, std::wstring logFileName, int logArchiveAboveSize, int logMaxArchiveFiles) noexcept {
-	try {
-		_logger = spdlog::rotating_logger_mt(".", std::move(logFileName), logArchiveAboveSize, logMaxArchiveFiles);
-		_logger->set_level(logLevel);
-		_logger->set_pattern("%Y-%m-%d %H:%M:%S.%e|%l|%s:%#|%!|%v");
-		_logger->flush_on(spdlog::level::warn);
+// 每个线程的缓冲区大小，必须是 2 的整数次幂
+static constexpr uint32_t THREAD_BUFFER_SIZE = 256 * 1024;
+// 一条日志最多占用的字节数，超过则丢弃
+static constexpr uint32_t MAX_RECORD_SIZE = THREAD_BUFFER_SIZE / 4;
+// 后台线程至少每隔这么久读取一次缓冲区。警告或更高等级的日志以及缓冲区使用过半时会立即唤醒后台线程
+static constexpr DWORD DRAIN_INTERVAL_MS = 200;
+
+// 单生产者单消费者的环形缓冲区，生产者为所属线程，消费者为持有 drainLock 的线程。
+// 每条日志在缓冲区中是连续的，剩余空间不足时在末尾填充空白并从头开始写入。
+struct Logger::_ThreadBuffer {
+	// writePos 和 readPos 单调递增，对 THREAD_BUFFER_SIZE 取余得到在 data 中的位置
+	alignas(64) std::atomic<uint64_t> writePos = 0;
+	// 已预留但尚未提交的位置，只由生产者访问
+	uint64_t pendingWritePos = 0;
+
+	alignas(64) std::atomic<uint64_t> readPos = 0;
+	std::atomic<uint32_t> droppedCount = 0;
+	// 所属线程已退出，读取完毕后即可释放
+	std::atomic<bool> isAbandoned = false;
+
+	std::unique_ptr<uint8_t[]> data{ new uint8_t[THREAD_BUFFER_SIZE] };
+};
+
+struct Logger::_AsyncState {
+	std::thread writerThread;
+	// 有日志需要尽快写入或需要退出时触发
+	wil::unique_event_nothrow hWakeEvent;
+
+	wil::srwlock buffersLock;
+	// 以下两个成员由 buffersLock 同步
+	std::vector<std::shared_ptr<_ThreadBuffer>> buffers;
+	bool isStopping = false;
+
+	// 读取缓冲区和写入日志文件前必须获取此锁，后台线程和 Flush 都会读取缓冲区
+	wil::srwlock drainLock;
+	// 以下成员由 drainLock 同步
+	std::vector<std::shared_ptr<_ThreadBuffer>> drainingBuffers;
+	fmt::dynamic_format_arg_store<fmt::format_context> formatArgs;
+	fmt::memory_buffer formatBuffer;
+
+	// 以下成员只用于 Binary 模式
+	// 不含扩展名
+	std::wstring binaryFileBaseName;
+	uint64_t maxBinaryFileSize = 0;
+	int maxArchiveFiles = 0;
+	wil::unique_hfile hBinaryFile;
+	uint64_t binaryFileSize = 0;
+	// 等待写入文件的数据
+	std::string binaryBuffer;
+	// 每个文件都有自己的字符串表
+	std::unordered_map<const char*, uint32_t> stringIds;
+};
+
+// 只检查一次是否附加了调试器
+static bool IsDebuggerAttached() noexcept {
+	static const bool isDebuggerPresent = IsDebuggerPresent();
+	return isDebuggerPresent;
+}
+
+template <typename T>
+static void AppendValue(std::string& buffer, const T& value) noexcept {
+	buffer.append((const char*)&value, sizeof(T));
+}
+
+// 0 为当前文件，其他为存档
+static std::wstring GetBinaryFileName(const std::wstring& baseName, int index) noexcept {
+	if (index == 0) {
+		return baseName + L".binlog";
+	} else {
+		return StrHelper::Concat(baseName, L".", std::to_wstring(index), L".binlog");
+	}
+}
+
+Logger::Logger() noexcept {}
+
+Logger::~Logger() noexcept {
+	if (!_async || !_async->writerThread.joinable()) {
+		return;
+	}
+
+	{
+		auto lk = _async->buffersLock.lock_exclusive();
+		_async->isStopping = true;
+	}
+	_async->hWakeEvent.SetEvent();
+	_async->writerThread.join();
+
+	if (_logger) {
+		_logger->flush();
+	}
+}
+
+bool Logger::Initialize(
+	spdlog::level::level_enum logLevel,
+	std::wstring logFileName,
+	int logArchiveAboveSize,
+	int logMaxArchiveFiles,
+	LogMode mode
+) noexcept {
+	if (mode != LogMode::Sync) {
+		_async = std::make_unique<_AsyncState>();
+		if (!_async->hWakeEvent.try_create(wil::EventOptions::None, nullptr)) {
+			_async.reset();
+			return false;
+		}
+	}
+
+	if (mode == LogMode::Binary) {
+		// 替换扩展名
+		const size_t dotPos = logFileName.find_last_of(L'.');
+		if (dotPos != std::wstring::npos && logFileName.find_first_of(L"\\/", dotPos) == std::wstring::npos) {
+			logFileName.resize(dotPos);
+		}
+
+		_async->binaryFileBaseName = std::move(logFileName);
+		_async->maxBinaryFileSize = (uint64_t)logArchiveAboveSize;
+		_async->maxArchiveFiles = logMaxArchiveFiles;
+		if (!_OpenBinaryFile(false)) {
+			_async.reset();
+			return false;
+		}
+	} else {
+		try {
+			_logger = spdlog::rotating_logger_mt(".", std::move(logFileName), logArchiveAboveSize, logMaxArchiveFiles);
+			_logger->set_level(logLevel);
+			_logger->set_pattern("%Y-%m-%d %H:%M:%S.%e|%l|%s:%#|%!|%v");
+			_logger->flush_on(spdlog::level::warn);
 #ifdef _DEBUG
-		spdlog::flush_every(5s);
+			spdlog::flush_every(5s);
 #else
-		spdlog::flush_every(30s);
+			spdlog::flush_every(30s);
 #endif
-	} catch (const spdlog::spdlog_ex&) {
-		return false;
+		} catch (const spdlog::spdlog_ex&) {
+			_async.reset();
+			return false;
+		}
+	}
+
+	_level.store(logLevel, std::memory_order_relaxed);
+	_mode = mode;
+
+	if (_async) {
+		_async->writerThread = std::thread(&Logger::_WriterThreadProc, this);
 	}
 
 	return true;
 }
 
 void Logger::SetLevel(spdlog::level::level_enum logLevel) noexcept {
-	assert(_logger);
+	_level.store(logLevel, std::memory_order_relaxed);
 
-	_logger->flush();
-	_logger->set_level(logLevel);
+	if (_logger) {
+		_logger->flush();
+		_logger->set_level(logLevel);
+	}
 
 	static const char* LOG_LEVELS[7] = {
 		"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "CRITICAL", "OFF"
 	};
-	Info(fmt::format("当前日志级别: {}", LOG_LEVELS[logLevel]));
+	Info("当前日志级别: {}", LOG_LEVELS[logLevel]);
+}
+
+void Logger::Flush() noexcept {
+	if (_async) {
+		_Drain();
+	}
+
+	if (_logger) {
+		_logger->flush();
+	}
+}
+
+void Logger::FlushOnCrash() noexcept {
+	if (_async) {
+		auto lk = _async->drainLock.try_lock_exclusive();
+		if (!lk) {
+			return;
+		}
+
+		_DrainLocked();
+	}
+
+	if (_logger) {
+		_logger->flush();
+	}
+}
+
+bool Logger::_IsSyncFormatNeeded(spdlog::level::level_enum logLevel) const noexcept {
+	if (_mode == LogMode::Sync) {
+		return true;
+	}
+
+	// 需要输出到调试器，见 _Log
+	return logLevel >= spdlog::level::warn && IsDebuggerAttached();
+}
+
+uint8_t* Logger::_BeginRecord(uint32_t size, _ThreadBuffer*& buffer) noexcept {
+	// 线程退出时将缓冲区标记为废弃，由后台线程读取完毕后释放
+	struct ThreadBufferHolder {
+		~ThreadBufferHolder() {
+			if (buffer) {
+				buffer->isAbandoned.store(true, std::memory_order_release);
+			}
+		}
+
+		std::shared_ptr<_ThreadBuffer> buffer;
+	};
+	static thread_local ThreadBufferHolder holder;
+
+	if (!holder.buffer) {
+		// 只在线程第一次记录日志时获取锁
+		try {
+			holder.buffer = std::make_shared<_ThreadBuffer>();
+			auto lk = _async->buffersLock.lock_exclusive();
+			_async->buffers.push_back(holder.buffer);
+		} catch (...) {
+			holder.buffer.reset();
+			return nullptr;
+		}
+	}
+
+	buffer = holder.buffer.get();
+
+	// 保持 8 字节对齐
+	size = (size + 7) & ~7u;
+	if (size > MAX_RECORD_SIZE) {
+		buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	const uint64_t writePos = buffer->writePos.load(std::memory_order_relaxed);
+	const uint32_t offset = uint32_t(writePos & (THREAD_BUFFER_SIZE - 1));
+	// 末尾的剩余空间不足时填充空白
+	const uint32_t padding = offset + size > THREAD_BUFFER_SIZE ? THREAD_BUFFER_SIZE - offset : 0;
+
+	if (writePos + padding + size - buffer->readPos.load(std::memory_order_acquire) > THREAD_BUFFER_SIZE) {
+		// 后台线程跟不上，宁可丢弃日志也不能阻塞
+		buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	if (padding != 0) {
+		_RecordHeader& paddingHeader = *(_RecordHeader*)(buffer->data.get() + offset);
+		paddingHeader.size = padding;
+		paddingHeader.level = PADDING_LEVEL;
+	}
+
+	buffer->pendingWritePos = writePos + padding + size;
+
+	uint8_t* dest = buffer->data.get() + ((writePos + padding) & (THREAD_BUFFER_SIZE - 1));
+	((_RecordHeader*)dest)->size = size;
+	return dest;
+}
+
+void Logger::_EndRecord(_ThreadBuffer* buffer, spdlog::level::level_enum logLevel) noexcept {
+	const uint64_t writePos = buffer->pendingWritePos;
+	buffer->writePos.store(writePos, std::memory_order_release);
+
+	// 警告或更高等级的日志应尽快写入，缓冲区使用过半时也唤醒后台线程以免丢弃日志
+	if (logLevel >= spdlog::level::warn ||
+		writePos - buffer->readPos.load(std::memory_order_relaxed) > THREAD_BUFFER_SIZE / 2) {
+		_async->hWakeEvent.SetEvent();
+	}
 }
 
 void Logger::_Log(spdlog::level::level_enum logLevel, std::string_view msg, const SourceLocation& location) noexcept {
 	assert(!msg.empty());
 
-	// 只检查一次是否附加了调试器
-	static const bool isDebuggerPresent = IsDebuggerPresent();
-	if (isDebuggerPresent && logLevel >= spdlog::level::warn) {
+	if (IsDebuggerAttached() && logLevel >= spdlog::level::warn) {
 		// 警告或更高等级的日志也记录到调试器
 		if (msg.back() == '\n') {
 			OutputDebugString(StrHelper::Concat(L"[LOG] ", StrHelper::UTF8ToUTF16(msg)).c_str());
@@ -47,11 +283,282 @@ void Logger::_Log(spdlog::level::level_enum logLevel, std::string_view msg, cons
 		}
 	}
 
-	if (_logger) {
+	if (_mode == LogMode::Sync) {
+		if (_logger) {
+			_logger->log(
+				spdlog::source_loc{ location.FileName(), (int)location.Line(), location.FunctionName() },
+				logLevel,
+				msg
+			);
+		}
+	} else if (_ShouldLog(logLevel)) {
+		// 复制消息，由后台线程写入
+		_Enqueue(logLevel, location, "{}", msg);
+	}
+}
+
+void Logger::_WriterThreadProc() noexcept {
+#ifdef _DEBUG
+	SetThreadDescription(GetCurrentThread(), L"Magpie-日志线程");
+#endif
+
+	while (true) {
+		_async->hWakeEvent.wait(DRAIN_INTERVAL_MS);
+
+		bool isStopping;
+		{
+			auto lk = _async->buffersLock.lock_shared();
+			isStopping = _async->isStopping;
+		}
+
+		_Drain();
+
+		if (isStopping) {
+			break;
+		}
+	}
+}
+
+void Logger::_Drain() noexcept {
+	auto lk = _async->drainLock.lock_exclusive();
+	_DrainLocked();
+}
+
+void Logger::_DrainLocked() noexcept {
+	std::vector<std::shared_ptr<_ThreadBuffer>>& buffers = _async->drainingBuffers;
+	{
+		// 复制列表，读取缓冲区时不应阻塞新线程注册
+		auto lk1 = _async->buffersLock.lock_exclusive();
+
+		// 释放所属线程已退出且已读取完毕的缓冲区。先检查 isAbandoned，确保之后不会再有写入
+		std::erase_if(_async->buffers, [](const std::shared_ptr<_ThreadBuffer>& buffer) {
+			return buffer->isAbandoned.load(std::memory_order_acquire) &&
+				buffer->readPos.load(std::memory_order_relaxed) == buffer->writePos.load(std::memory_order_relaxed) &&
+				buffer->droppedCount.load(std::memory_order_relaxed) == 0;
+		});
+
+		buffers.assign(_async->buffers.begin(), _async->buffers.end());
+	}
+
+	for (const std::shared_ptr<_ThreadBuffer>& buffer : buffers) {
+		_DrainBuffer(*buffer);
+	}
+	buffers.clear();
+
+	if (_mode == LogMode::Binary) {
+		_FlushBinaryFile();
+	}
+}
+
+void Logger::_DrainBuffer(_ThreadBuffer& buffer) noexcept {
+	uint64_t readPos = buffer.readPos.load(std::memory_order_relaxed);
+	const uint64_t writePos = buffer.writePos.load(std::memory_order_acquire);
+
+	while (readPos != writePos) {
+		const _RecordHeader& header =
+			*(const _RecordHeader*)(buffer.data.get() + (readPos & (THREAD_BUFFER_SIZE - 1)));
+		if (header.level != PADDING_LEVEL) {
+			_WriteRecord(header);
+		}
+		readPos += header.size;
+	}
+
+	// 参数中的字符串直接引用缓冲区，因此写入完毕才能释放空间
+	buffer.readPos.store(readPos, std::memory_order_release);
+
+	if (const uint32_t droppedCount = buffer.droppedCount.exchange(0, std::memory_order_relaxed)) {
+		_WriteDropped(droppedCount);
+	}
+}
+
+void Logger::_WriteRecord(const _RecordHeader& header) noexcept {
+	if (_mode == LogMode::Binary) {
+		_WriteBinaryRecord(header);
+		return;
+	}
+
+	if (!_logger) {
+		return;
+	}
+
+	fmt::dynamic_format_arg_store<fmt::format_context>& formatArgs = _async->formatArgs;
+	formatArgs.clear();
+
+	const uint8_t* cur = (const uint8_t*)(&header + 1);
+	const uint8_t* end = (const uint8_t*)&header + header.size;
+	LogArg arg;
+	for (uint32_t i = 0; i < header.argCount; ++i) {
+		cur = LogRecordFormat::ReadArg(cur, end, arg);
+		if (!cur) {
+			assert(false);
+			return;
+		}
+
+		LogRecordFormat::PushArg(arg, formatArgs);
+	}
+
+	fmt::memory_buffer& msg = _async->formatBuffer;
+	msg.clear();
+	try {
+		fmt::vformat_to(fmt::appender(msg), fmt::string_view(header.format, header.formatSize), formatArgs);
+	} catch (...) {
+		// 格式字符串已在编译时检查过
+		assert(false);
+		return;
+	}
+
+	_logger->log(
+		header.time,
+		spdlog::source_loc{ header.file, (int)header.line, header.function },
+		(spdlog::level::level_enum)header.level,
+		spdlog::string_view_t(msg.data(), msg.size())
+	);
+}
+
+void Logger::_WriteBinaryRecord(const _RecordHeader& header) noexcept {
+	if (_async->binaryFileSize + _async->binaryBuffer.size() >= _async->maxBinaryFileSize) {
+		_RotateBinaryFile();
+	}
+
+	if (!_async->hBinaryFile) {
+		return;
+	}
+
+	// 参数的编码和缓冲区中相同，直接复制
+	const uint8_t* args = (const uint8_t*)(&header + 1);
+	const uint8_t* argsEnd = args;
+	const uint8_t* end = (const uint8_t*)&header + header.size;
+	LogArg arg;
+	for (uint32_t i = 0; i < header.argCount; ++i) {
+		argsEnd = LogRecordFormat::ReadArg(argsEnd, end, arg);
+		if (!argsEnd) {
+			assert(false);
+			return;
+		}
+	}
+
+	// 字符串表需在记录之前写入
+	const uint32_t fileId = _GetStringId(header.file);
+	const uint32_t functionId = _GetStringId(header.function);
+	const uint32_t formatId = _GetStringId(header.format, header.formatSize);
+
+	std::string& buffer = _async->binaryBuffer;
+	AppendValue(buffer, LogEntryType::Record);
+	AppendValue(buffer, (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		header.time.time_since_epoch()).count());
+	AppendValue(buffer, header.level);
+	AppendValue(buffer, fileId);
+	AppendValue(buffer, functionId);
+	AppendValue(buffer, header.line);
+	AppendValue(buffer, formatId);
+	AppendValue(buffer, header.argCount);
+	buffer.append((const char*)args, argsEnd - args);
+}
+
+void Logger::_WriteDropped(uint32_t droppedCount) noexcept {
+	if (_mode == LogMode::Binary) {
+		if (_async->hBinaryFile) {
+			AppendValue(_async->binaryBuffer, LogEntryType::Dropped);
+			AppendValue(_async->binaryBuffer, droppedCount);
+		}
+	} else if (_logger) {
+		const SourceLocation location = SourceLocation::Current();
 		_logger->log(
 			spdlog::source_loc{ location.FileName(), (int)location.Line(), location.FunctionName() },
-			logLevel,
-			msg
+			spdlog::level::warn,
+			fmt::format("{} 条日志因缓冲区已满被丢弃", droppedCount)
+		);
+	}
+}
+
+uint32_t Logger::_GetStringId(const char* str, size_t size) noexcept {
+	if (!str) {
+		return LogRecordFormat::NULL_STRING_ID;
+	}
+
+	auto [it, inserted] = _async->stringIds.try_emplace(str, (uint32_t)_async->stringIds.size() + 1);
+	if (inserted) {
+		if (size == std::string_view::npos) {
+			size = std::char_traits<char>::length(str);
+		}
+
+		std::string& buffer = _async->binaryBuffer;
+		AppendValue(buffer, LogEntryType::String);
+		AppendValue(buffer, it->second);
+		AppendValue(buffer, (uint32_t)size);
+		buffer.append(str, size);
+	}
+
+	return it->second;
+}
+
+bool Logger::_OpenBinaryFile(bool truncate) noexcept {
+	CREATEFILE2_EXTENDED_PARAMETERS extendedParams{
+		.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS),
+		.dwFileAttributes = FILE_ATTRIBUTE_NORMAL,
+		.dwFileFlags = FILE_FLAG_SEQUENTIAL_SCAN
+	};
+
+	// 和文本日志相同，启动时追加到已有的日志文件
+	_async->hBinaryFile.reset(CreateFile2(
+		GetBinaryFileName(_async->binaryFileBaseName, 0).c_str(),
+		FILE_APPEND_DATA,
+		FILE_SHARE_READ,
+		truncate ? CREATE_ALWAYS : OPEN_ALWAYS,
+		&extendedParams
+	));
+	if (!_async->hBinaryFile) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(_async->hBinaryFile.get(), &fileSize)) {
+		_async->hBinaryFile.reset();
+		return false;
+	}
+
+	_async->binaryFileSize = (uint64_t)fileSize.QuadPart;
+	_async->binaryBuffer.clear();
+	if (_async->binaryFileSize == 0) {
+		AppendValue(_async->binaryBuffer, LogFileHeader{});
+	}
+
+	// 追加时之前写入的字符串编号将被重新定义
+	_async->stringIds.clear();
+	return true;
+}
+
+bool Logger::_FlushBinaryFile() noexcept {
+	std::string& buffer = _async->binaryBuffer;
+	if (buffer.empty()) {
+		return true;
+	}
+
+	if (!_async->hBinaryFile) {
+		buffer.clear();
+		return false;
+	}
+
+	DWORD written;
+	const bool success = WriteFile(_async->hBinaryFile.get(), buffer.data(), (DWORD)buffer.size(), &written, nullptr)
+		&& written == buffer.size();
+	_async->binaryFileSize += buffer.size();
+	buffer.clear();
+	return success;
+}
+
+void Logger::_RotateBinaryFile() noexcept {
+	_FlushBinaryFile();
+	_async->hBinaryFile.reset();
+
+	// 和 spdlog 的 rotating_file_sink 相同，magpie.binlog -> magpie.1.binlog -> magpie.2.binlog ...
+	for (int i = _async->maxArchiveFiles; i > 0; --i) {
+		MoveFileEx(
+			GetBinaryFileName(_async->binaryFileBaseName, i - 1).c_str(),
+			GetBinaryFileName(_async->binaryFileBaseName, i).c_str(),
+			MOVEFILE_REPLACE_EXISTING
 		);
 	}
+
+	_OpenBinaryFile(true);
 }
@@ -8,6 +8,7 @@
 #pragma clang diagnostic pop
 #endif
 #include <fmt/printf.h>
+#include "LogRecordFormat.h"
 
 // std::source_location 中的函数名包含整个签名过于冗长，我们只需记录函数名，
 // 因此创建自己的 SourceLocation
@@ -46,6 +47,43 @@ private:
 	const char* _function = nullptr;
 };
 
+// 宽字符串参数在写入日志时才转换为 UTF-8，因此按 std::string 检查格式字符串
+template <typename T>
+struct LogFormatArg {
+	using type = T;
+};
+
+template <typename T>
+	requires LogRecordFormat::IS_WSTRING_ARG<std::remove_cvref_t<T>>
+struct LogFormatArg<T> {
+	using type = std::string;
+};
+
+template <typename T>
+using LogFormatArgT = typename LogFormatArg<T>::type;
+
+// 同时保存格式字符串和调用位置，使带参数的重载也能通过默认参数获取调用位置。
+// 格式字符串在编译时检查
+template <typename... Args>
+struct LogFormatString {
+	template <typename T>
+		requires std::is_convertible_v<const T&, std::string_view>
+	consteval LogFormatString(const T& str, SourceLocation loc = SourceLocation::Current()) noexcept
+		: format(str), location(loc) {}
+
+	fmt::format_string<Args...> format;
+	SourceLocation location;
+};
+
+enum class LogMode {
+	// 在调用线程中格式化并写入日志文件
+	Sync,
+	// 调用线程只将参数复制到自己的缓冲区，由后台线程格式化并写入日志文件
+	Async,
+	// 和 Async 相同，但后台线程不格式化而是直接写入二进制日志，需使用 tools/LogDecoder 解码
+	Binary
+};
+
 class Logger {
 public:
 	static Logger& Get() noexcept {
@@ -53,14 +91,35 @@ public:
 		return instance;
 	}
 
-	bool Initialize(spdlog::level::level_enum logLevel, std::wstring logFileName, int logArchiveAboveSize, int logMaxArchiveFiles) noexcept;
+	// _AsyncState 只在 Logger.cpp 中定义，因此构造和析构函数不能内联
+	Logger() noexcept;
+	~Logger() noexcept;
+
+	// Async 和 Binary 模式下记录日志的线程永远不会因磁盘 IO 而阻塞。Binary 模式下日志文件的扩展名
+	// 将被替换为 .binlog
+	bool Initialize(
+		spdlog::level::level_enum logLevel,
+		std::wstring logFileName,
+		int logArchiveAboveSize,
+		int logMaxArchiveFiles,
+		LogMode mode = LogMode::Sync
+	) noexcept;
 
 	void SetLevel(spdlog::level::level_enum logLevel) noexcept;
 
-	void Flush() noexcept {
-		if (_logger) {
-			_logger->flush();
-		}
+	// Async 和 Binary 模式下会等待后台线程写入所有已记录的日志
+	void Flush() noexcept;
+
+	// 用于未处理的异常。和 Flush 相同，但不等待锁，后台线程正在写入时什么也不做，
+	// 因为崩溃的可能正是持有锁的线程
+	void FlushOnCrash() noexcept;
+
+	// 带参数的重载先检查日志级别，被过滤的日志不会格式化。Async 和 Binary 模式下只复制参数，
+	// 格式化推迟到后台线程进行，因此调用者不应自己调用 fmt::format。宽字符串可以直接作为参数，
+	// 同样推迟到后台线程转换为 UTF-8
+	template <typename... Args>
+	void Info(LogFormatString<LogFormatArgT<Args>...> fmt, Args&&... args) noexcept {
+		_LogFormat(spdlog::level::info, fmt.location, fmt.format, std::forward<Args>(args)...);
 	}
 
 	void Info(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
@@ -68,15 +127,20 @@ public:
 	}
 
 	void Win32Info(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::info, _MakeWin32ErrorMsg(msg), location);
+		_LogWin32Error(spdlog::level::info, msg, location);
 	}
 
 	void NTInfo(std::string_view msg, NTSTATUS status, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::info, _MakeNTErrorMsg(msg, status), location);
+		_LogNTError(spdlog::level::info, msg, status, location);
 	}
 
 	void ComInfo(std::string_view msg, HRESULT hr, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::info, _MakeComErrorMsg(msg, hr), location);
+		_LogComError(spdlog::level::info, msg, hr, location);
+	}
+
+	template <typename... Args>
+	void Warn(LogFormatString<LogFormatArgT<Args>...> fmt, Args&&... args) noexcept {
+		_LogFormat(spdlog::level::warn, fmt.location, fmt.format, std::forward<Args>(args)...);
 	}
 
 	void Warn(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
@@ -84,15 +148,20 @@ public:
 	}
 
 	void Win32Warn(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::warn, _MakeWin32ErrorMsg(msg), location);
+		_LogWin32Error(spdlog::level::warn, msg, location);
 	}
 
 	void NTWarn(std::string_view msg, NTSTATUS status, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::warn, _MakeNTErrorMsg(msg, status), location);
+		_LogNTError(spdlog::level::warn, msg, status, location);
 	}
 
 	void ComWarn(std::string_view msg, HRESULT hr, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::warn, _MakeComErrorMsg(msg, hr), location);
+		_LogComError(spdlog::level::warn, msg, hr, location);
+	}
+
+	template <typename... Args>
+	void Error(LogFormatString<LogFormatArgT<Args>...> fmt, Args&&... args) noexcept {
+		_LogFormat(spdlog::level::err, fmt.location, fmt.format, std::forward<Args>(args)...);
 	}
 
 	void Error(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
@@ -100,15 +169,20 @@ public:
 	}
 
 	void Win32Error(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::err, _MakeWin32ErrorMsg(msg), location);
+		_LogWin32Error(spdlog::level::err, msg, location);
 	}
 
 	void NTError(std::string_view msg, NTSTATUS status, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::err, _MakeNTErrorMsg(msg, status), location);
+		_LogNTError(spdlog::level::err, msg, status, location);
 	}
 
 	void ComError(std::string_view msg, HRESULT hr, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::err, _MakeComErrorMsg(msg, hr), location);
+		_LogComError(spdlog::level::err, msg, hr, location);
+	}
+
+	template <typename... Args>
+	void Critical(LogFormatString<LogFormatArgT<Args>...> fmt, Args&&... args) noexcept {
+		_LogFormat(spdlog::level::critical, fmt.location, fmt.format, std::forward<Args>(args)...);
 	}
 
 	void Critical(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
@@ -116,31 +190,168 @@ public:
 	}
 
 	void Win32Critical(std::string_view msg, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::critical, _MakeWin32ErrorMsg(msg), location);
+		_LogWin32Error(spdlog::level::critical, msg, location);
 	}
 
 	void NTCritical(std::string_view msg, NTSTATUS status, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::critical, _MakeNTErrorMsg(msg, status), location);
+		_LogNTError(spdlog::level::critical, msg, status, location);
 	}
 
 	void ComCritical(std::string_view msg, HRESULT hr, const SourceLocation& location = SourceLocation::Current()) noexcept {
-		_Log(spdlog::level::critical, _MakeComErrorMsg(msg, hr), location);
+		_LogComError(spdlog::level::critical, msg, hr, location);
 	}
 
 private:
-	static std::string _MakeWin32ErrorMsg(std::string_view msg) noexcept {
-		return fmt::format("{}\n\tLastErrorCode: {}", msg, GetLastError());
+	struct _ThreadBuffer;
+	struct _AsyncState;
+
+	// 每线程缓冲区中一条日志的头部，之后是按 LogRecordFormat 编码的参数。
+	// 文件名、函数名和格式字符串都是字面量，因此只需保存指针
+	struct _RecordHeader {
+		// 包括参数在内的字节数，8 字节对齐。由 _BeginRecord 填写
+		uint32_t size;
+		// 为 PADDING_LEVEL 时表示缓冲区末尾的空白，应当跳过
+		uint8_t level;
+		uint8_t argCount;
+		uint32_t line;
+		uint32_t formatSize;
+		spdlog::log_clock::time_point time;
+		const char* file;
+		const char* function;
+		const char* format;
+	};
+
+	static constexpr uint8_t PADDING_LEVEL = 0xFF;
+
+	template <typename T>
+	static decltype(auto) _CaptureArg(const T& arg) noexcept {
+		if constexpr (LogRecordFormat::IS_DIRECT_ARG<T>) {
+			return (arg);
+		} else {
+			return fmt::format("{}", arg);
+		}
+	}
+
+	// 在调用线程中格式化时宽字符串需先转换为 UTF-8
+	template <typename T>
+	static decltype(auto) _SyncFormatArg(const T& arg) noexcept {
+		if constexpr (LogRecordFormat::IS_WSTRING_ARG<T>) {
+			return LogRecordFormat::WStringArgToUTF8(arg);
+		} else {
+			return (arg);
+		}
+	}
+
+	template <typename... Args>
+	static std::string _FormatSync(fmt::string_view format, const Args&... args) noexcept {
+		return fmt::vformat(format, fmt::make_format_args(args...));
+	}
+
+	bool _ShouldLog(spdlog::level::level_enum logLevel) const noexcept {
+		return logLevel >= _level.load(std::memory_order_relaxed);
+	}
+
+	// 是否应在调用线程中格式化
+	bool _IsSyncFormatNeeded(spdlog::level::level_enum logLevel) const noexcept;
+
+	template <typename... Args>
+	void _LogFormat(
+		spdlog::level::level_enum logLevel,
+		const SourceLocation& location,
+		fmt::format_string<LogFormatArgT<Args>...> fmt,
+		Args&&... args
+	) noexcept {
+		if (!_ShouldLog(logLevel)) {
+			return;
+		}
+
+		if (_IsSyncFormatNeeded(logLevel)) {
+			_Log(logLevel, _FormatSync(fmt::string_view(fmt), _SyncFormatArg(args)...), location);
+		} else {
+			_Enqueue(logLevel, location, fmt::string_view(fmt), _CaptureArg(args)...);
+		}
 	}
 
-	static std::string _MakeNTErrorMsg(std::string_view msg, NTSTATUS status) noexcept {
-		return fmt::format("{}\n\tNTSTATUS: {}", msg, status);
+	template <typename... Args>
+	void _Enqueue(
+		spdlog::level::level_enum logLevel,
+		const SourceLocation& location,
+		fmt::string_view format,
+		const Args&... args
+	) noexcept {
+		static_assert(sizeof...(Args) <= UINT8_MAX);
+
+		_ThreadBuffer* buffer;
+		uint8_t* dest = _BeginRecord(
+			uint32_t(sizeof(_RecordHeader) + (LogRecordFormat::ArgSize(args) + ... + 0)), buffer);
+		if (!dest) {
+			return;
+		}
+
+		_RecordHeader& header = *(_RecordHeader*)dest;
+		header.level = (uint8_t)logLevel;
+		header.argCount = (uint8_t)sizeof...(Args);
+		header.line = location.Line();
+		header.formatSize = (uint32_t)format.size();
+		header.time = spdlog::log_clock::now();
+		header.file = location.FileName();
+		header.function = location.FunctionName();
+		header.format = format.data();
+
+		dest += sizeof(_RecordHeader);
+		((dest = LogRecordFormat::WriteArg(dest, args)), ...);
+
+		_EndRecord(buffer, logLevel);
 	}
 
-	static std::string _MakeComErrorMsg(std::string_view msg, HRESULT hr) noexcept {
-		return fmt::sprintf("%s\n\tHRESULT: 0x%X", msg, hr);
+	// 在当前线程的缓冲区中预留 size 字节，空间不足时返回 nullptr，此条日志将被丢弃
+	uint8_t* _BeginRecord(uint32_t size, _ThreadBuffer*& buffer) noexcept;
+
+	void _EndRecord(_ThreadBuffer* buffer, spdlog::level::level_enum logLevel) noexcept;
+
+	void _LogWin32Error(spdlog::level::level_enum logLevel, std::string_view msg, const SourceLocation& location) noexcept {
+		// 先获取错误代码，以免被其他调用覆盖
+		const DWORD errorCode = GetLastError();
+		_LogFormat(logLevel, location, "{}\n\tLastErrorCode: {}", msg, errorCode);
+	}
+
+	void _LogNTError(spdlog::level::level_enum logLevel, std::string_view msg, NTSTATUS status, const SourceLocation& location) noexcept {
+		_LogFormat(logLevel, location, "{}\n\tNTSTATUS: {}", msg, status);
+	}
+
+	void _LogComError(spdlog::level::level_enum logLevel, std::string_view msg, HRESULT hr, const SourceLocation& location) noexcept {
+		_LogFormat(logLevel, location, "{}\n\tHRESULT: 0x{:X}", msg, (uint32_t)hr);
 	}
 
 	void _Log(spdlog::level::level_enum logLevel, std::string_view msg, const SourceLocation& location) noexcept;
 
+	void _WriterThreadProc() noexcept;
+
+	void _Drain() noexcept;
+
+	// 调用者需持有 drainLock
+	void _DrainLocked() noexcept;
+
+	void _DrainBuffer(_ThreadBuffer& buffer) noexcept;
+
+	void _WriteRecord(const _RecordHeader& header) noexcept;
+
+	void _WriteBinaryRecord(const _RecordHeader& header) noexcept;
+
+	void _WriteDropped(uint32_t droppedCount) noexcept;
+
+	// 返回字符串在二进制日志中的编号，第一次遇到时将其写入字符串表
+	uint32_t _GetStringId(const char* str, size_t size = std::string_view::npos) noexcept;
+
+	bool _OpenBinaryFile(bool truncate) noexcept;
+
+	bool _FlushBinaryFile() noexcept;
+
+	void _RotateBinaryFile() noexcept;
+
 	std::shared_ptr<spdlog::logger> _logger;
+	std::atomic<spdlog::level::level_enum> _level = spdlog::level::info;
+	LogMode _mode = LogMode::Sync;
+	// 只在 Async 和 Binary 模式下使用
+	std::unique_ptr<_AsyncState> _async;
 };
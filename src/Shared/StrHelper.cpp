@@ -1,30 +1,12 @@
 #include "pch.h"
 #include "StrHelper.h"
 #include "Logger.h"
+#include "UTFTranscoder.h"
 
 std::wstring StrHelper::UTF8ToUTF16(std::string_view str) noexcept {
-	if (str.empty()) {
-		return {};
-	}
-
-	int convertResult = MultiByteToWideChar(CP_UTF8, 0,
-		str.data(), (int)str.size(), nullptr, 0);
-	if (convertResult <= 0) {
-		Logger::Get().Win32Error("MultiByteToWideChar 失败");
-		assert(false);
-		return {};
-	}
-
-	std::wstring result(convertResult + 10, L'\0');
-	convertResult = MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(),
-		result.data(), (int)result.size());
-	if (convertResult <= 0) {
-		Logger::Get().Win32Error("MultiByteToWideChar 失败");
-		assert(false);
-		return {};
-	}
-
-	result.resize(convertResult);
+	// 结果不会比输入长
+	std::wstring result(str.size(), L'\0');
+	result.resize(UTFTranscoder::UTF8ToUTF16(str, result.data()));
 	return result;
 }
 
@@ -55,7 +37,10 @@ static std::string UTF16ToOther(UINT codePage, std::wstring_view str) noexcept {
 }
 
 std::string StrHelper::UTF16ToUTF8(std::wstring_view str) noexcept {
-	return UTF16ToOther(CP_UTF8, str);
+	// 每个 UTF-16 元素最多对应 3 个字节
+	std::string result(str.size() * 3, '\0');
+	result.resize(UTFTranscoder::UTF16ToUTF8(str, result.data()));
+	return result;
 }
 
 std::string StrHelper::UTF16ToANSI(std::wstring_view str) noexcept {
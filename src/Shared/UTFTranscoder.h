@@ -0,0 +1,224 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+// 定义 MP_UTF_TRANSCODER_NO_SSE2 时在 x64 上也使用可移植的实现，用于测试
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(MP_UTF_TRANSCODER_NO_SSE2)
+#include <emmintrin.h>
+#define MP_UTF_TRANSCODER_SSE2
+#endif
+
+// UTF-8 和 UTF-16 的相互转换，结果和 MultiByteToWideChar/WideCharToMultiByte 相同。
+// 只由头文件实现，无需 Windows 也可以使用。
+//
+// 实际使用的字符串（路径、效果名、日志）绝大部分是 ASCII，因此先以 16 个字符为一组检查，全部是 ASCII
+// 时直接扩展或压缩，x64 上使用 SSE2，其他平台上每次检查 8 个字节。遇到非 ASCII 字符时逐个码点转换，
+// 并检查编码是否有效：无效的序列（截断、过长编码、代理项、超出 U+10FFFF）按 Unicode 推荐的
+// “最大子部分”规则替换为 U+FFFD，孤立的代理项也替换为 U+FFFD。
+struct UTFTranscoder {
+	static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+	// dest 至少要有 src.size() 个元素，返回写入的元素数
+	template <typename CHAR16_T>
+	static size_t UTF8ToUTF16(std::string_view src, CHAR16_T* dest) noexcept {
+		static_assert(sizeof(CHAR16_T) == 2);
+
+		const uint8_t* s = (const uint8_t*)src.data();
+		const size_t size = src.size();
+		size_t i = 0;
+		size_t j = 0;
+
+		while (i < size) {
+			// 结果不会比输入长，因此 dest 总是有足够的空间一次写入 16 个元素
+			if (size - i >= 16) {
+#ifdef MP_UTF_TRANSCODER_SSE2
+				const __m128i bytes = _mm_loadu_si128((const __m128i*)(s + i));
+				const __m128i zero = _mm_setzero_si128();
+				_mm_storeu_si128((__m128i*)(dest + j), _mm_unpacklo_epi8(bytes, zero));
+				_mm_storeu_si128((__m128i*)(dest + j + 8), _mm_unpackhi_epi8(bytes, zero));
+
+				// 每个字节的最高位
+				const uint32_t nonAsciiMask = (uint32_t)_mm_movemask_epi8(bytes);
+				const uint32_t asciiCount = nonAsciiMask == 0 ? 16 : (uint32_t)std::countr_zero(nonAsciiMask);
+#else
+				uint32_t asciiCount = 0;
+				for (; asciiCount < 16; asciiCount += 8) {
+					uint64_t bytes;
+					std::memcpy(&bytes, s + i + asciiCount, 8);
+					if (bytes & 0x8080808080808080) {
+						break;
+					}
+
+					for (uint32_t k = 0; k < 8; ++k) {
+						dest[j + asciiCount + k] = (CHAR16_T)s[i + asciiCount + k];
+					}
+				}
+#endif
+				i += asciiCount;
+				j += asciiCount;
+				if (asciiCount == 16) {
+					continue;
+				}
+			}
+
+			if (s[i] < 0x80) {
+				dest[j++] = (CHAR16_T)s[i++];
+				continue;
+			}
+
+			// 非 ASCII 字符通常连续出现（如中文），逐个转换直到遇到 ASCII 字符再尝试快速路径
+			do {
+				const char32_t codePoint = _DecodeUTF8(s, size, i);
+				if (codePoint >= 0x10000) {
+					dest[j++] = (CHAR16_T)(0xD800 + ((codePoint - 0x10000) >> 10));
+					dest[j++] = (CHAR16_T)(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+				} else {
+					dest[j++] = (CHAR16_T)codePoint;
+				}
+			} while (i < size && s[i] >= 0x80);
+		}
+
+		return j;
+	}
+
+	// dest 至少要有 src.size() * 3 个元素，返回写入的元素数
+	template <typename CHAR16_T>
+	static size_t UTF16ToUTF8(std::basic_string_view<CHAR16_T> src, char* dest) noexcept {
+		static_assert(sizeof(CHAR16_T) == 2);
+
+		const CHAR16_T* s = src.data();
+		const size_t size = src.size();
+		size_t i = 0;
+		size_t j = 0;
+
+		while (i < size) {
+			if (size - i >= 16) {
+#ifdef MP_UTF_TRANSCODER_SSE2
+				const __m128i lo = _mm_loadu_si128((const __m128i*)(s + i));
+				const __m128i hi = _mm_loadu_si128((const __m128i*)(s + i + 8));
+				// 所有元素都小于 0x80 时才是 ASCII
+				const __m128i nonAsciiBits = _mm_and_si128(_mm_or_si128(lo, hi), _mm_set1_epi16((short)0xFF80));
+				const bool isAscii = _mm_movemask_epi8(_mm_cmpeq_epi16(nonAsciiBits, _mm_setzero_si128())) == 0xFFFF;
+				if (isAscii) {
+					_mm_storeu_si128((__m128i*)(dest + j), _mm_packus_epi16(lo, hi));
+				}
+#else
+				uint64_t units[4];
+				std::memcpy(units, s + i, 32);
+				const bool isAscii = ((units[0] | units[1] | units[2] | units[3]) & 0xFF80FF80FF80FF80) == 0;
+				if (isAscii) {
+					for (uint32_t k = 0; k < 16; ++k) {
+						dest[j + k] = (char)s[i + k];
+					}
+				}
+#endif
+				if (isAscii) {
+					i += 16;
+					j += 16;
+					continue;
+				}
+			}
+
+			if (s[i] < 0x80) {
+				dest[j++] = (char)s[i++];
+				continue;
+			}
+
+			// 和 UTF8ToUTF16 相同，连续转换非 ASCII 字符
+			do {
+				const char32_t c = s[i++];
+				char32_t codePoint = c;
+				if (c >= 0xD800 && c <= 0xDFFF) {
+					// 代理项必须是高代理项后跟低代理项
+					if (c <= 0xDBFF && i < size && s[i] >= 0xDC00 && s[i] <= 0xDFFF) {
+						codePoint = 0x10000 + ((c - 0xD800) << 10) + (s[i++] - 0xDC00);
+					} else {
+						codePoint = REPLACEMENT_CHARACTER;
+					}
+				}
+
+				j += _EncodeUTF8(codePoint, dest + j);
+			} while (i < size && s[i] >= 0x80);
+		}
+
+		return j;
+	}
+
+private:
+	static bool _IsContinuation(uint8_t c) noexcept {
+		return (c & 0xC0) == 0x80;
+	}
+
+	// s[i] 不是 ASCII。返回码点并将 i 移到下一个序列，序列无效时返回 U+FFFD
+	static char32_t _DecodeUTF8(const uint8_t* s, size_t size, size_t& i) noexcept {
+		const uint8_t c = s[i];
+
+		// 序列长度和第二个字节的有效范围，用于排除过长编码、代理项和超出 U+10FFFF 的码点
+		uint32_t length;
+		uint8_t secondMin = 0x80;
+		uint8_t secondMax = 0xBF;
+		if (c >= 0xC2 && c <= 0xDF) {
+			length = 2;
+		} else if (c >= 0xE0 && c <= 0xEF) {
+			length = 3;
+			if (c == 0xE0) {
+				secondMin = 0xA0;
+			} else if (c == 0xED) {
+				secondMax = 0x9F;
+			}
+		} else if (c >= 0xF0 && c <= 0xF4) {
+			length = 4;
+			if (c == 0xF0) {
+				secondMin = 0x90;
+			} else if (c == 0xF4) {
+				secondMax = 0x8F;
+			}
+		} else {
+			// 孤立的后续字节或不可能出现的首字节
+			++i;
+			return REPLACEMENT_CHARACTER;
+		}
+
+		if (i + 1 >= size || s[i + 1] < secondMin || s[i + 1] > secondMax) {
+			++i;
+			return REPLACEMENT_CHARACTER;
+		}
+
+		char32_t codePoint = c & (0x7F >> length);
+		codePoint = (codePoint << 6) | (s[i + 1] & 0x3F);
+
+		for (uint32_t k = 2; k < length; ++k) {
+			if (i + k >= size || !_IsContinuation(s[i + k])) {
+				// 替换已读取的有效前缀
+				i += k;
+				return REPLACEMENT_CHARACTER;
+			}
+
+			codePoint = (codePoint << 6) | (s[i + k] & 0x3F);
+		}
+
+		i += length;
+		return codePoint;
+	}
+
+	// codePoint 不是 ASCII，返回写入的字节数
+	static uint32_t _EncodeUTF8(char32_t codePoint, char* dest) noexcept {
+		if (codePoint < 0x800) {
+			dest[0] = char(0xC0 | (codePoint >> 6));
+			dest[1] = char(0x80 | (codePoint & 0x3F));
+			return 2;
+		} else if (codePoint < 0x10000) {
+			dest[0] = char(0xE0 | (codePoint >> 12));
+			dest[1] = char(0x80 | ((codePoint >> 6) & 0x3F));
+			dest[2] = char(0x80 | (codePoint & 0x3F));
+			return 3;
+		} else {
+			dest[0] = char(0xF0 | (codePoint >> 18));
+			dest[1] = char(0x80 | ((codePoint >> 12) & 0x3F));
+			dest[2] = char(0x80 | ((codePoint >> 6) & 0x3F));
+			dest[3] = char(0x80 | (codePoint & 0x3F));
+			return 4;
+		}
+	}
+};
@@ -0,0 +1,376 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "CuNNyCpu.h"
+#include "ResamplerCpu.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+// src/Effects/CuNNy2 和 src/Effects/CuNNy 中的全部模型，由 CMakeLists.txt 定义 MAGPIE_EFFECTS_DIR
+static constexpr const char* MODELS[] = {
+	"CuNNy2/CuNNy-veryfast-NVL",
+	"CuNNy2/CuNNy-faster-NVL",
+	"CuNNy2/CuNNy-fast-NVL",
+	"CuNNy2/CuNNy-3x12-NVL",
+	"CuNNy2/CuNNy-4x12-NVL",
+	"CuNNy2/CuNNy-4x16-NVL",
+	"CuNNy2/CuNNy-4x24-NVL",
+	"CuNNy2/CuNNy-4x32-NVL",
+	"CuNNy2/CuNNy-8x32-NVL",
+	"CuNNy/CuNNy-2x4C-NVL",
+	"CuNNy/CuNNy-2x4C-NVL-DN",
+	"CuNNy/CuNNy-3x4C-NVL",
+	"CuNNy/CuNNy-3x4C-NVL-DN",
+	"CuNNy/CuNNy-4x4C-NVL",
+	"CuNNy/CuNNy-4x4C-NVL-DN",
+	"CuNNy/CuNNy-4x8C-NVL",
+	"CuNNy/CuNNy-4x8C-NVL-DN",
+	"CuNNy/CuNNy-4x16C-NVL",
+	"CuNNy/CuNNy-4x16C-NVL-DN",
+	"CuNNy/CuNNy-6x8C-NVL",
+	"CuNNy/CuNNy-6x8C-NVL-DN",
+	"CuNNy/CuNNy-8x4C-NVL",
+	"CuNNy/CuNNy-8x4C-NVL-DN",
+	"CuNNy/CuNNy-8x8C-NVL",
+	"CuNNy/CuNNy-8x8C-NVL-DN",
+	"CuNNy/CuNNy-8x16C-NVL",
+	"CuNNy/CuNNy-8x16C-NVL-DN",
+	"CuNNy/CuNNy-16x16C-NVL",
+	"CuNNy/CuNNy-16x16C-NVL-DN"
+};
+
+static std::string ReadModel(const char* name) {
+	const std::filesystem::path path =
+		std::filesystem::path(MAGPIE_EFFECTS_DIR) / (std::string(name) + ".hlsl");
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	return stream.str();
+}
+
+static std::vector<float4> Scale(const CuNNyCpu& cunny, const std::vector<float4>& src, uint32_t width, uint32_t height) {
+	std::vector<float4> dest((size_t)width * height * 4);
+	if (!cunny.Scale(src, width, height, dest)) {
+		dest.clear();
+	}
+	return dest;
+}
+
+// 3x3 邻域的九个采样，如 "V4 s0_0 = l0(-1.0, -1.0);"，按行排列
+static std::string SampleStatements(const char* type, uint32_t group) {
+	std::string result;
+	for (uint32_t tap = 0; tap < 9; ++tap) {
+		result += std::string("\t") + type + " s" + std::to_string(group) + "_" + std::to_string(tap) +
+			" = l0(" + std::to_string(int(tap % 3) - 1) + ".0, " + std::to_string(int(tap / 3) - 1) + ".0);\n";
+	}
+	return result;
+}
+
+// 手写的两层 CuNNy 网络，只使用中心像素，便于计算期望的结果。第一层输出 (L, -L, L/2, 0)，
+// 其中 L = R - 0.5；第二层经过 CReLU 后输出 tanh(max(x, 0), min(y, 0), max(z, 0), min(x, 0))，
+// 和着色器一样按 (0,0)->x、(1,0)->y、(1,1)->w、(0,1)->z 叠加到亮度上
+static std::string MakeTinyModel() {
+	std::string source = R"(//!MAGPIE EFFECT
+//!VERSION 4
+
+//!TEXTURE
+//!FORMAT R8G8B8A8_SNORM
+Texture2D t0;
+
+//!PASS 1
+//!IN INPUT
+//!OUT t0
+
+#define l0(x, y) (dot(MF3(1.0, 0.0, 0.0), O(INPUT, float2(x, y)).rgb) + MF(-0.5))
+
+V4 f0(MF s0_0) {
+	V4 r = { 0.0, 0.0, 0.0, 0.0 };
+	r = mad(s0_4, V4(1.0, -1.0, 0.5, 0.0), r);
+	return r;
+}
+
+void Pass1(uint2 blockStart, uint3 tid) {
+)";
+	source += SampleStatements("MF", 0);
+	source += R"(	t0[gxy] = f0(s0_0);
+}
+
+//!PASS 2
+//!IN INPUT, t0
+//!OUT OUTPUT
+
+#define l0(x, y) V4(O(t0, float2(x, y)))
+
+V4 f0(V4 s0_0) {
+	V4 r = { 0.0, 0.0, 0.0, 0.0 };
+	r = MulAdd(s0_4, M4(1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0), r);
+	r = MulAdd(s1_4, M4(0.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0), r);
+	return tanh(r);
+}
+
+void Pass2(uint2 blockStart, uint3 tid) {
+)";
+	source += SampleStatements("V4", 0);
+	for (uint32_t tap = 0; tap < 9; ++tap) {
+		source += "\tV4 s1_" + std::to_string(tap) + " = -max(-s0_" + std::to_string(tap) + ", 0.0);\n";
+	}
+	for (uint32_t tap = 0; tap < 9; ++tap) {
+		source += "\ts0_" + std::to_string(tap) + " = max(s0_" + std::to_string(tap) + ", 0.0);\n";
+	}
+	source += R"(
+	V4 r = f0(s0_0);
+	OUTPUT[gxy] = MF4(mul(yuv2rgb, MF3(saturate(yuv.r + r.x), yuv.yz)), 1);
+	++gxy.x;
+	OUTPUT[gxy] = MF4(mul(yuv2rgb, MF3(saturate(yuv.r + r.y), yuv.yz)), 1);
+	++gxy.y;
+	OUTPUT[gxy] = MF4(mul(yuv2rgb, MF3(saturate(yuv.r + r.w), yuv.yz)), 1);
+	--gxy.x;
+	OUTPUT[gxy] = MF4(mul(yuv2rgb, MF3(saturate(yuv.r + r.z), yuv.yz)), 1);
+}
+)";
+	return source;
+}
+
+// 4 倍超采样的硬边缘：棋盘格、圆和斜条纹
+static std::vector<float4> MakeEdgeImage(uint32_t width, uint32_t height) {
+	std::vector<float4> image((size_t)width * height);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			float sum = 0.0f;
+			for (uint32_t j = 0; j < 4; ++j) {
+				for (uint32_t i = 0; i < 4; ++i) {
+					const float px = x + (i + 0.5f) / 4;
+					const float py = y + (j + 0.5f) / 4;
+					const bool inside = (((int)px / 7 + (int)py / 11) % 2 == 0) ^
+						((px - width / 2.0f) * (px - width / 2.0f) + (py - height / 2.0f) * (py - height / 2.0f) < 2500) ^
+						(std::fmod(px + 0.6f * py, 23.0f) < 4.0f);
+					sum += inside ? 0.9f : 0.1f;
+				}
+			}
+
+			const float value = sum / 16;
+			image[(size_t)y * width + x] = float4(value, value, value, 1.0f);
+		}
+	}
+	return image;
+}
+
+// 每边 2x2 像素缩小为 1 个像素
+static std::vector<float4> Downscale(const std::vector<float4>& src, uint32_t width, uint32_t height) {
+	std::vector<float4> dest((size_t)width * height / 4);
+	for (uint32_t y = 0; y < height / 2; ++y) {
+		for (uint32_t x = 0; x < width / 2; ++x) {
+			const float4* row0 = &src[(size_t)y * 2 * width + x * 2];
+			const float4* row1 = row0 + width;
+			dest[(size_t)y * (width / 2) + x] = (row0[0] + row0[1] + row1[0] + row1[1]) * 0.25f;
+		}
+	}
+	return dest;
+}
+
+// 不计边缘 8 个像素的 RGB 通道
+static double Psnr(const std::vector<float4>& a, const std::vector<float4>& b, uint32_t width, uint32_t height) {
+	double sum = 0.0;
+	size_t count = 0;
+	for (uint32_t y = 8; y + 8 < height; ++y) {
+		for (uint32_t x = 8; x + 8 < width; ++x) {
+			const float4 diff = a[(size_t)y * width + x] - b[(size_t)y * width + x];
+			sum += Dot3(diff, diff);
+			count += 3;
+		}
+	}
+	return 10.0 * std::log10(count / sum);
+}
+
+TEST_CASE(LoadsAllModels) {
+	for (const char* model : MODELS) {
+		CuNNyCpu cunny;
+		CHECK(cunny.Load(ReadModel(model)));
+		CHECK(cunny.GetReceptiveRadius() >= 2);
+	}
+}
+
+TEST_CASE(RejectsInvalidSource) {
+	CuNNyCpu cunny;
+	CHECK(!cunny.Load(""));
+	CHECK(!cunny.Load("//!MAGPIE EFFECT\n//!VERSION 4\n"));
+	CHECK(!cunny.IsLoaded());
+
+	// 截断的源码
+	for (const char* model : { "CuNNy2/CuNNy-fast-NVL", "CuNNy/CuNNy-4x8C-NVL" }) {
+		const std::string source = ReadModel(model);
+		REQUIRE(!source.empty());
+		CHECK(!cunny.Load(std::string_view(source).substr(0, source.size() / 2)));
+		CHECK(!cunny.IsLoaded());
+	}
+
+	// CReLU 的负的部分必须在取正的部分之前计算，否则恒为 0
+	std::string source = MakeTinyModel();
+	REQUIRE(cunny.Load(source));
+	const size_t negativePos = source.find("\tV4 s1_4 = -max(-s0_4, 0.0);\n");
+	const size_t positivePos = source.find("\ts0_4 = max(s0_4, 0.0);\n");
+	REQUIRE(negativePos != std::string::npos && positivePos != std::string::npos);
+	source.insert(negativePos, "\ts0_4 = max(s0_4, 0.0);\n");
+	CHECK(!cunny.Load(source));
+
+	// 采样的序号和偏移不一致
+	source = MakeTinyModel();
+	source.replace(source.find("MF s0_4 = l0(0.0, 0.0)"), 22, "MF s0_4 = l0(1.0, 0.0)");
+	CHECK(!cunny.Load(source));
+}
+
+TEST_CASE(RejectsInvalidArguments) {
+	CuNNyCpu cunny;
+	std::vector<float4> src(16);
+	std::vector<float4> dest(64);
+	// 未加载
+	CHECK(!cunny.Scale(src, 4, 4, dest));
+
+	REQUIRE(cunny.Load(ReadModel("CuNNy2/CuNNy-veryfast-NVL")));
+	CHECK(!cunny.Scale(src, 0, 4, dest));
+	CHECK(!cunny.Scale(src, 5, 4, dest));
+	CHECK(!cunny.Scale(src, 4, 4, std::span(dest).first(63)));
+}
+
+// 纯色图像的残差很小，输出接近输入
+TEST_CASE(FlatImageIsNearlyUnchanged) {
+	CuNNyCpu cunny;
+	REQUIRE(cunny.Load(ReadModel("CuNNy2/CuNNy-fast-NVL")));
+
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+	const std::vector<float4> dest = Scale(cunny, src, 16, 16);
+	REQUIRE(!dest.empty());
+	CHECK(MaxError(dest, std::vector<float4>(dest.size(), color)) < 0.05f);
+}
+
+TEST_CASE(OutputIsInRange) {
+	// 宽度不是 8 的倍数，覆盖每行末尾的可移植路径
+	const std::vector<float4> src = MakeTestImage(37, 21);
+
+	for (const char* model : MODELS) {
+		CuNNyCpu cunny;
+		REQUIRE(cunny.Load(ReadModel(model)));
+
+		const std::vector<float4> dest = Scale(cunny, src, 37, 21);
+		REQUIRE(!dest.empty());
+
+		// CuNNy 和着色器一样只把亮度限制在 [0, 1]，转换回 RGB 后可能略微超出
+		const bool isV1 = std::string_view(model).starts_with("CuNNy/");
+
+		bool inRange = true;
+		for (const float4& pixel : dest) {
+			if (isV1) {
+				const float luma = Dot3(pixel, float4(0.299f, 0.587f, 0.114f, 0.0f));
+				inRange &= luma >= -1e-3f && luma <= 1.001f && pixel.w == 1.0f;
+			} else {
+				inRange &= pixel.x >= 0.0f && pixel.x <= 1.0f && pixel.y >= 0.0f && pixel.y <= 1.0f &&
+					pixel.z >= 0.0f && pixel.z <= 1.0f && pixel.w == 1.0f;
+			}
+		}
+		CHECK(inRange);
+	}
+}
+
+// CuNNy 的 SNORM 量化、CReLU、tanh 和输出像素的排列
+TEST_CASE(TinyModel) {
+	CuNNyCpu cunny;
+	REQUIRE(cunny.Load(MakeTinyModel()));
+	CHECK(cunny.GetReceptiveRadius() == 2);
+
+	// 宽度为 16，同时覆盖 AVX2 核和可移植的实现
+	const float4 color(0.75f, 0.75f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 2, color);
+	const std::vector<float4> dest = Scale(cunny, src, 16, 2);
+	REQUIRE(!dest.empty());
+
+	// L = 0.25，写入 SNORM 纹理后为 (32, -32, 16, 0) / 127
+	const float residuals[4] = {
+		std::tanh(32.0f / 127),
+		std::tanh(-32.0f / 127),
+		std::tanh(16.0f / 127),
+		0.0f
+	};
+
+	bool isExpected = true;
+	for (uint32_t y = 0; y < 4; ++y) {
+		for (uint32_t x = 0; x < 32; ++x) {
+			const float expected = 0.75f + residuals[(y % 2) * 2 + x % 2];
+			const float4& pixel = dest[(size_t)y * 32 + x];
+			isExpected &= std::abs(pixel.x - expected) < 1e-4f && std::abs(pixel.y - expected) < 1e-4f &&
+				std::abs(pixel.z - expected) < 1e-4f && pixel.w == 1.0f;
+		}
+	}
+	CHECK(isExpected);
+}
+
+// 硬边缘的图像缩小一半后再放大，结果应明显好于双线性插值
+TEST_CASE(BeatsBilinear) {
+	constexpr uint32_t WIDTH = 200;
+	constexpr uint32_t HEIGHT = 180;
+	const std::vector<float4> original = MakeEdgeImage(WIDTH, HEIGHT);
+	const std::vector<float4> src = Downscale(original, WIDTH, HEIGHT);
+
+	std::vector<float4> bilinear(original.size());
+	REQUIRE(ResamplerCpu::Scale(ResampleFilter::Bilinear, {}, src, WIDTH / 2, HEIGHT / 2, bilinear, WIDTH, HEIGHT));
+	const double bilinearPsnr = Psnr(bilinear, original, WIDTH, HEIGHT);
+
+	for (const char* model : { "CuNNy2/CuNNy-fast-NVL", "CuNNy/CuNNy-2x4C-NVL", "CuNNy/CuNNy-4x8C-NVL-DN" }) {
+		CuNNyCpu cunny;
+		REQUIRE(cunny.Load(ReadModel(model)));
+
+		const std::vector<float4> dest = Scale(cunny, src, WIDTH / 2, HEIGHT / 2);
+		REQUIRE(!dest.empty());
+		CHECK(Psnr(dest, original, WIDTH, HEIGHT) > bilinearPsnr + 2.0);
+	}
+}
+
+// 半精度的权重只带来很小的误差。16 层的模型中个别像素的误差可达 0.06
+TEST_CASE(HalfWeights) {
+	const std::vector<float4> src = MakeTestImage(37, 21);
+
+	for (const char* model : MODELS) {
+		CuNNyCpu cunny;
+		CuNNyCpu halfCunny;
+		REQUIRE(cunny.Load(ReadModel(model)));
+		REQUIRE(halfCunny.Load(ReadModel(model), true));
+
+		const std::vector<float4> expected = Scale(cunny, src, 37, 21);
+		const std::vector<float4> dest = Scale(halfCunny, src, 37, 21);
+		REQUIRE(!expected.empty() && !dest.empty());
+
+		const float error = MaxError(dest, expected);
+		CHECK(error > 0.0f && error < 0.1f);
+	}
+}
+
+// AVX2 核不使用 FMA，半精度的权重转换为单精度是精确的，结果必须和可移植的实现完全相同
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	const std::vector<float4> src = MakeTestImage(37, 21);
+
+	for (const char* model : MODELS) {
+		for (bool halfWeights : { false, true }) {
+			CuNNyCpu cunny;
+			REQUIRE(cunny.Load(ReadModel(model), halfWeights));
+
+			CpuFeatures::SetAvx2Enabled(false);
+			const std::vector<float4> portable = Scale(cunny, src, 37, 21);
+			CpuFeatures::SetAvx2Enabled(true);
+			const std::vector<float4> avx2 = Scale(cunny, src, 37, 21);
+
+			REQUIRE(!portable.empty() && !avx2.empty());
+			CHECK(portable == avx2);
+		}
+	}
+}
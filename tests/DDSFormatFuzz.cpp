@@ -0,0 +1,86 @@
+#include "DDSFormat.h"
+#include "DDSSeeds.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Magpie;
+
+// 违反不变量时立即终止，模糊测试驱动和 libFuzzer 都会把它视为崩溃
+#define FUZZ_ASSERT(expr) \
+	do { \
+		if (!(expr)) { \
+			std::fprintf(stderr, "%s(%d): 不变量不成立: %s\n", __FILE__, __LINE__, #expr); \
+			std::abort(); \
+		} \
+	} while (false)
+
+std::vector<std::vector<uint8_t>> GetFuzzSeeds() {
+	return {
+		MakeDDSFile(8, 8, 4, DDSPF_A8R8G8B8),
+		MakeDDSFile(13, 7, 1, DDSPF_R5G6B5),
+		MakeDDSFile(16, 16, 5, DDSPF_DXT1),
+		MakeDDSFile(10, 6, 1, DDSPF_DXT5),
+		MakeDDSFile(64, 64, 1, DDSPF_L8),
+		MakeDDSFile(8, 8, 1, {}, DXGI_FORMAT_BC7_UNORM),
+		MakeDDSFile(4, 4, 3, {}, DXGI_FORMAT_R16G16B16A16_FLOAT),
+		MakeDDSFile(8, 4, 1, {}, DXGI_FORMAT_NV12),
+		MakeDDSFile(9, 3, 1, {}, DXGI_FORMAT_YUY2),
+		MakeDDSFile(2, 2, 1, {}, DXGI_FORMAT_R1_UNORM)
+	};
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	// 任意的像素格式描述都应得到受支持的格式或 DXGI_FORMAT_UNKNOWN
+	if (size >= sizeof(DDS_PIXELFORMAT)) {
+		DDS_PIXELFORMAT ddpf;
+		std::memcpy(&ddpf, data, sizeof(ddpf));
+		const DXGI_FORMAT format = DDSFormat::GetDXGIFormat(ddpf);
+		FUZZ_ASSERT(format == DXGI_FORMAT_UNKNOWN || DDSFormat::BitsPerPixel(format) != 0);
+	}
+
+	DDSTextureInfo info;
+	if (!DDSFormat::ParseHeader(data, size, info)) {
+		return 0;
+	}
+
+	FUZZ_ASSERT(info.dataOffset == DDS_MIN_HEADER_SIZE || info.dataOffset == DDS_DX10_HEADER_SIZE);
+	FUZZ_ASSERT(info.dataOffset + info.dataSize == size);
+	FUZZ_ASSERT(info.mipCount >= 1 && info.mipCount <= DDSFormat::MAX_MIP_LEVELS);
+	FUZZ_ASSERT(info.width >= 1 && info.width <= DDSFormat::MAX_TEXTURE_DIMENSION);
+	FUZZ_ASSERT(info.height >= 1 && info.height <= DDSFormat::MAX_TEXTURE_DIMENSION);
+	FUZZ_ASSERT(DDSFormat::BitsPerPixel(info.format) != 0);
+
+	// 和 DDSHelper 中的 FillInitData 相同，按 mip 切分数据并读取每个 mip 的首尾字节。越界读取会被 ASan 发现
+	const uint8_t* bitData = data + info.dataOffset;
+	size_t offset = 0;
+	size_t w = info.width;
+	size_t h = info.height;
+	// 防止读取被优化掉
+	volatile uint8_t sink = 0;
+	for (uint32_t i = 0; i < info.mipCount; ++i) {
+		size_t numBytes = 0;
+		size_t rowBytes = 0;
+		size_t numRows = 0;
+		if (!DDSFormat::GetSurfaceInfo(w, h, info.format, &numBytes, &rowBytes, &numRows)) {
+			break;
+		}
+
+		FUZZ_ASSERT(rowBytes > 0 && numRows > 0);
+		FUZZ_ASSERT(numBytes >= rowBytes);
+
+		if (numBytes > info.dataSize - offset) {
+			break;
+		}
+
+		sink = bitData[offset];
+		sink = bitData[offset + numBytes - 1];
+		offset += numBytes;
+
+		w = std::max<size_t>(w >> 1, 1);
+		h = std::max<size_t>(h >> 1, 1);
+	}
+
+	(void)sink;
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include "TestHelper.h"
+#include "DDSFormat.h"
+#include "DDSSeeds.h"
+
+using namespace Magpie;
+
+TEST_CASE(SurfaceInfo) {
+	size_t numBytes = 0;
+	size_t rowBytes = 0;
+	size_t numRows = 0;
+
+	REQUIRE(DDSFormat::GetSurfaceInfo(7, 5, DXGI_FORMAT_R8G8B8A8_UNORM, &numBytes, &rowBytes, &numRows));
+	CHECK(rowBytes == 28 && numRows == 5 && numBytes == 140);
+
+	// 块压缩格式按 4x4 的块计算，不足一块的按一块
+	REQUIRE(DDSFormat::GetSurfaceInfo(5, 1, DXGI_FORMAT_BC1_UNORM, &numBytes, &rowBytes, &numRows));
+	CHECK(rowBytes == 16 && numRows == 1 && numBytes == 16);
+	REQUIRE(DDSFormat::GetSurfaceInfo(8, 8, DXGI_FORMAT_BC7_UNORM, &numBytes, &rowBytes, &numRows));
+	CHECK(rowBytes == 32 && numRows == 2 && numBytes == 64);
+
+	REQUIRE(DDSFormat::GetSurfaceInfo(9, 2, DXGI_FORMAT_R1_UNORM, &numBytes, &rowBytes, &numRows));
+	CHECK(rowBytes == 2 && numBytes == 4);
+
+	// NV12 要求高度为偶数
+	REQUIRE(DDSFormat::GetSurfaceInfo(4, 4, DXGI_FORMAT_NV12, &numBytes, &rowBytes, &numRows));
+	CHECK(rowBytes == 4 && numRows == 6 && numBytes == 24);
+	CHECK(!DDSFormat::GetSurfaceInfo(4, 3, DXGI_FORMAT_NV12, &numBytes, nullptr, nullptr));
+
+	CHECK(!DDSFormat::GetSurfaceInfo(4, 4, DXGI_FORMAT_UNKNOWN, &numBytes, nullptr, nullptr));
+	CHECK(!DDSFormat::GetSurfaceInfo(4, 4, DXGI_FORMAT(1000), &numBytes, nullptr, nullptr));
+}
+
+TEST_CASE(LegacyPixelFormats) {
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_A8R8G8B8) == DXGI_FORMAT_B8G8R8A8_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_A8B8G8R8) == DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_R5G6B5) == DXGI_FORMAT_B5G6R5_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_L8) == DXGI_FORMAT_R8_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_A8) == DXGI_FORMAT_A8_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_DXT1) == DXGI_FORMAT_BC1_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_DXT5) == DXGI_FORMAT_BC3_UNORM);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_BC5_SNORM) == DXGI_FORMAT_BC5_SNORM);
+	// 没有对应的 DXGI 格式
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_R8G8B8) == DXGI_FORMAT_UNKNOWN);
+	CHECK(DDSFormat::GetDXGIFormat(DDSPF_X1R5G5B5) == DXGI_FORMAT_UNKNOWN);
+}
+
+TEST_CASE(ParseHeader) {
+	DDSTextureInfo info;
+
+	const std::vector<uint8_t> legacy = MakeDDSFile(8, 6, 3, DDSPF_A8R8G8B8);
+	REQUIRE(DDSFormat::ParseHeader(legacy.data(), legacy.size(), info));
+	CHECK(info.width == 8 && info.height == 6 && info.mipCount == 3);
+	CHECK(info.format == DXGI_FORMAT_B8G8R8A8_UNORM);
+	CHECK(info.dataOffset == DDS_MIN_HEADER_SIZE);
+	CHECK(info.dataSize == (8 * 6 + 4 * 3 + 2 * 1) * 4);
+
+	const std::vector<uint8_t> dx10 = MakeDDSFile(16, 16, 1, {}, DXGI_FORMAT_R16G16B16A16_FLOAT);
+	REQUIRE(DDSFormat::ParseHeader(dx10.data(), dx10.size(), info));
+	CHECK(info.format == DXGI_FORMAT_R16G16B16A16_FLOAT);
+	CHECK(info.dataOffset == DDS_DX10_HEADER_SIZE);
+	CHECK(info.dataSize == 16 * 16 * 8);
+}
+
+TEST_CASE(RejectsInvalidFiles) {
+	DDSTextureInfo info;
+
+	// 文件头不完整
+	const std::vector<uint8_t> dx10 = MakeDDSFile(4, 4, 1, {}, DXGI_FORMAT_BC1_UNORM);
+	CHECK(!DDSFormat::ParseHeader(dx10.data(), DDS_DX10_HEADER_SIZE - 1, info));
+	CHECK(!DDSFormat::ParseHeader(dx10.data(), 3, info));
+
+	// 视频格式、未知格式和不受支持的旧格式
+	std::vector<uint8_t> file = MakeDDSFile(4, 4, 1, {}, DXGI_FORMAT_P8, 16);
+	CHECK(!DDSFormat::ParseHeader(file.data(), file.size(), info));
+	file = MakeDDSFile(4, 4, 1, {}, DXGI_FORMAT(200), 16);
+	CHECK(!DDSFormat::ParseHeader(file.data(), file.size(), info));
+	file = MakeDDSFile(4, 4, 1, DDSPF_R8G8B8, DXGI_FORMAT_UNKNOWN, 48);
+	CHECK(!DDSFormat::ParseHeader(file.data(), file.size(), info));
+
+	// 尺寸和 mip 数量超过 Direct3D 11 的限制
+	file = MakeDDSFile(DDSFormat::MAX_TEXTURE_DIMENSION + 1, 1, 1, DDSPF_L8, DXGI_FORMAT_UNKNOWN, 16);
+	CHECK(!DDSFormat::ParseHeader(file.data(), file.size(), info));
+	file = MakeDDSFile(4, 4, DDSFormat::MAX_MIP_LEVELS + 1, DDSPF_L8, DXGI_FORMAT_UNKNOWN, 16);
+	CHECK(!DDSFormat::ParseHeader(file.data(), file.size(), info));
+
+	// magic 错误
+	file = MakeDDSFile(4, 4, 1, DDSPF_L8);
+	file[0] = 'X';
+	CHECK(!DDSFormat::ParseHeader(file.data(), file.size(), info));
+}
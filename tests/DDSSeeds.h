@@ -0,0 +1,61 @@
+#pragma once
+#include "DDSFormat.h"
+#include <cstring>
+#include <vector>
+
+// 生成用于测试的 DDS 文件。pixelDataSize 为 0 时按实际大小填充所有 mip
+inline std::vector<uint8_t> MakeDDSFile(
+	uint32_t width,
+	uint32_t height,
+	uint32_t mipCount,
+	const Magpie::DDS_PIXELFORMAT& ddpf,
+	DXGI_FORMAT dx10Format = DXGI_FORMAT_UNKNOWN,
+	size_t pixelDataSize = 0
+) {
+	using namespace Magpie;
+
+	Magpie::DDS_HEADER header{};
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDS_HEADER_FLAGS_TEXTURE | (mipCount > 1 ? DDS_HEADER_FLAGS_MIPMAP : 0);
+	header.width = width;
+	header.height = height;
+	header.depth = 1;
+	header.mipMapCount = mipCount;
+	header.ddspf = dx10Format == DXGI_FORMAT_UNKNOWN ? ddpf : DDSPF_DX10;
+	header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+
+	const DXGI_FORMAT format = dx10Format == DXGI_FORMAT_UNKNOWN ? DDSFormat::GetDXGIFormat(ddpf) : dx10Format;
+	if (pixelDataSize == 0) {
+		uint32_t w = width;
+		uint32_t h = height;
+		for (uint32_t i = 0; i < std::max(mipCount, 1u); ++i) {
+			size_t numBytes = 0;
+			DDSFormat::GetSurfaceInfo(w, h, format, &numBytes, nullptr, nullptr);
+			pixelDataSize += numBytes;
+			w = std::max(w >> 1, 1u);
+			h = std::max(h >> 1, 1u);
+		}
+	}
+
+	std::vector<uint8_t> file(sizeof(uint32_t) + sizeof(DDS_HEADER));
+	std::memcpy(file.data(), &DDS_MAGIC, sizeof(uint32_t));
+	std::memcpy(file.data() + sizeof(uint32_t), &header, sizeof(header));
+
+	if (dx10Format != DXGI_FORMAT_UNKNOWN) {
+		DDS_HEADER_DXT10 ext{};
+		ext.dxgiFormat = dx10Format;
+		ext.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+		ext.arraySize = 1;
+
+		const size_t offset = file.size();
+		file.resize(offset + sizeof(ext));
+		std::memcpy(file.data() + offset, &ext, sizeof(ext));
+	}
+
+	const size_t offset = file.size();
+	file.resize(offset + pixelDataSize);
+	for (size_t i = 0; i < pixelDataSize; ++i) {
+		file[offset + i] = uint8_t(i * 31);
+	}
+	return file;
+}
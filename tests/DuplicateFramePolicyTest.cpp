@@ -0,0 +1,139 @@
+#include "TestHelper.h"
+#include "DuplicateFramePolicy.h"
+#include <cstdint>
+#include <vector>
+
+// DuplicateFramePolicy 的动态检测，由模拟的帧序列驱动
+
+using namespace Magpie;
+using namespace std::chrono;
+
+namespace {
+
+struct ReplayResult {
+	std::vector<FrameTraceDecision> decisions;
+	// 比较的次数
+	uint32_t checks = 0;
+	// 内容变化后推迟显示的最多帧数
+	uint32_t maxDelay = 0;
+};
+
+}
+
+// contents[i] 为第 i 帧的内容，帧以 interval 为间隔到达
+static ReplayResult Replay(
+	DuplicateFramePolicy& policy,
+	const std::vector<uint32_t>& contents,
+	nanoseconds interval
+) {
+	ReplayResult result;
+	uint32_t prevContent = contents[0];
+	uint32_t delay = 0;
+
+	for (size_t i = 1; i < contents.size(); ++i) {
+		const uint32_t content = contents[i];
+
+		FrameTraceDecision decision = FrameTraceDecision::NotChecked;
+		const bool isDuplicate = policy.OnNewFrame(
+			interval * i,
+			[&]() {
+				++result.checks;
+				return content == prevContent;
+			},
+			[&]() { prevContent = content; },
+			decision
+		);
+		result.decisions.push_back(decision);
+
+		// 丢弃了新内容时显示被推迟
+		if (isDuplicate && content != prevContent) {
+			result.maxDelay = std::max(result.maxDelay, ++delay);
+		} else {
+			delay = 0;
+		}
+	}
+
+	return result;
+}
+
+// 内容每 period 帧变化一次，共 count 帧
+static std::vector<uint32_t> MakePeriodicContents(uint32_t period, uint32_t count) {
+	std::vector<uint32_t> contents(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		contents[i] = i / period;
+	}
+	return contents;
+}
+
+// 144Hz 下播放 24fps 的视频，学习后应跳过部分比较，但不会连续丢弃未经检查的帧
+TEST_CASE(PeriodicContentSkipsChecks) {
+	DuplicateFramePolicy policy;
+	policy.Initialize(false, false);
+
+	const std::vector<uint32_t> contents = MakePeriodicContents(6, 1440);
+	const ReplayResult result = Replay(policy, contents, nanoseconds(6'944'444));
+
+	CHECK(result.checks < contents.size() * 3 / 4);
+	CHECK(result.maxDelay == 0);
+
+	uint32_t predictedCount = 0;
+	bool isLastPredicted = false;
+	bool hasConsecutivePredicted = false;
+	for (FrameTraceDecision decision : result.decisions) {
+		const bool isPredicted = decision == FrameTraceDecision::PredictedDuplicate;
+		hasConsecutivePredicted |= isPredicted && isLastPredicted;
+		predictedCount += isPredicted;
+		isLastPredicted = isPredicted;
+	}
+	CHECK(predictedCount > 0);
+	CHECK(!hasConsecutivePredicted);
+}
+
+// 节奏突然改变时最多推迟一帧显示，且不启用统计也能得知预测错误
+TEST_CASE(CadenceChangeIsBounded) {
+	DuplicateFramePolicy policy;
+	policy.Initialize(false, false);
+
+	std::vector<uint32_t> contents = MakePeriodicContents(6, 720);
+	// 之后每帧都变化
+	for (uint32_t i = 0; i < 60; ++i) {
+		contents.push_back(contents.back() + 1);
+	}
+
+	const ReplayResult result = Replay(policy, contents, nanoseconds(6'944'444));
+	CHECK(result.maxDelay <= 1);
+
+	const auto [mispredicted, verified] = policy.VerificationStatistics();
+	CHECK(verified > 0);
+	CHECK(mispredicted > 0);
+	CHECK(policy.Statistics() == std::make_pair(0u, 0u));
+}
+
+// 预测正确时验证也不会报告错误
+TEST_CASE(StableContentHasNoMispredictions) {
+	DuplicateFramePolicy policy;
+	policy.Initialize(false, false);
+
+	// 游戏：每帧都变化
+	std::vector<uint32_t> contents(600);
+	for (uint32_t i = 0; i < contents.size(); ++i) {
+		contents[i] = i;
+	}
+
+	const ReplayResult result = Replay(policy, contents, nanoseconds(16'666'667));
+	CHECK(result.checks < contents.size() / 4);
+
+	const auto [mispredicted, verified] = policy.VerificationStatistics();
+	CHECK(verified > 0);
+	CHECK(mispredicted == 0);
+}
+
+TEST_CASE(AlwaysCheckComparesEveryFrame) {
+	DuplicateFramePolicy policy;
+	policy.Initialize(true, false);
+
+	const std::vector<uint32_t> contents = MakePeriodicContents(6, 120);
+	const ReplayResult result = Replay(policy, contents, nanoseconds(6'944'444));
+	CHECK(result.checks == contents.size() - 1);
+	CHECK(result.maxDelay == 0);
+}
@@ -0,0 +1,236 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "EffectChainCpu.h"
+#include "FsrCpu.h"
+#include "MmpxCpu.h"
+#include "NisCpu.h"
+#include "ResamplerCpu.h"
+#include "XbrzCpu.h"
+#include <fstream>
+#include <iterator>
+
+// EffectChainCpu 分块执行的结果必须和逐个调用各效果的结果完全相同。CMakeLists.txt 定义 MAGPIE_EFFECTS_DIR
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+static CpuEffectOption MakeOption(
+	const char* name,
+	CpuScalingType scalingType = CpuScalingType::Normal,
+	std::pair<float, float> scale = { 1.0f, 1.0f }
+) {
+	return { .name = name, .parameters = {}, .scalingType = scalingType, .scale = scale };
+}
+
+static bool InitializeChain(EffectChainCpu& effectChain, const std::vector<CpuEffectOption>& effects, bool isWindowedMode) {
+	return effectChain.Initialize(MAGPIE_EFFECTS_DIR, effects, isWindowedMode);
+}
+
+// 和 Renderer 一样在末尾追加的 Bicubic
+static std::vector<float4> AppendBicubic(const std::vector<float4>& src, CpuSize srcSize, CpuSize destSize) {
+	ResampleParameters params;
+	params.bicubicB = 0.0f;
+	params.bicubicC = 0.5f;
+
+	std::vector<float4> dest((size_t)destSize.width * destSize.height);
+	ResamplerCpu::Scale(ResampleFilter::Bicubic, params, src, srcSize.width, srcSize.height,
+		dest, destSize.width, destSize.height);
+	return dest;
+}
+
+// 不依赖标准库分布和数学函数的输入，在所有平台上都相同
+static std::vector<float4> MakeHashImage(uint32_t width, uint32_t height) {
+	static constexpr float4 PALETTE[] = {
+		{ 0.0f, 0.0f, 0.0f, 1.0f },
+		{ 1.0f, 1.0f, 1.0f, 1.0f },
+		{ 0.75f, 0.25f, 0.125f, 1.0f },
+		{ 0.25f, 0.5f, 0.875f, 1.0f }
+	};
+
+	std::vector<float4> image((size_t)width * height);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			uint32_t hash = x * 0x9E3779B1u ^ y * 0x85EBCA77u;
+			hash ^= hash >> 15;
+			hash *= 0x2C1B3C6Du;
+			hash ^= hash >> 12;
+
+			// 大块的斜向色带上叠加少量随机像素
+			const uint32_t idx = (hash & 0xF) == 0 ? (hash >> 4) % 4 : ((x + 2 * y) / 9) % 4;
+			image[(size_t)y * width + x] = PALETTE[idx];
+		}
+	}
+	return image;
+}
+
+// 量化为 8 位后的 FNV-1a 哈希，只包含 RGB 通道
+static uint64_t HashImage(const std::vector<float4>& image) noexcept {
+	uint64_t hash = 0xCBF29CE484222325;
+	for (const float4& pixel : image) {
+		for (float channel : { pixel.x, pixel.y, pixel.z }) {
+			hash ^= (uint64_t)std::lroundf(Saturate(channel) * 255.0f);
+			hash *= 0x100000001B3;
+		}
+	}
+	return hash;
+}
+
+TEST_CASE(RejectsUnknownEffects) {
+	EffectChainCpu effectChain;
+	CHECK(!InitializeChain(effectChain, {}, false));
+	CHECK(!InitializeChain(effectChain, { MakeOption("Nonexistent") }, false));
+	CHECK(!InitializeChain(effectChain, { MakeOption("CuNNy2\\Nonexistent") }, false));
+	CHECK(!InitializeChain(effectChain, { MakeOption("CuNNy\\Nonexistent") }, false));
+	CHECK(!effectChain.IsInitialized());
+}
+
+// 和 Renderer 相同：全屏模式只在输出大于屏幕时追加 Bicubic，窗口模式在尺寸不同时追加，并将 Fit 1x 视为 Fill
+TEST_CASE(OutputSizeMatchesRenderer) {
+	const CpuSize inputSize{ 400, 300 };
+	const CpuSize rendererSize{ 1000, 700 };
+
+	EffectChainCpu fullscreen;
+	REQUIRE(InitializeChain(fullscreen, { MakeOption("Bilinear", CpuScalingType::Fit) }, false));
+	CHECK(fullscreen.CalcOutputSize(inputSize, rendererSize) == CpuSize(933, 700));
+
+	EffectChainCpu windowed;
+	REQUIRE(InitializeChain(windowed, { MakeOption("Bilinear", CpuScalingType::Fit) }, true));
+	CHECK(windowed.CalcOutputSize(inputSize, rendererSize) == rendererSize);
+
+	EffectChainCpu oversized;
+	REQUIRE(InitializeChain(oversized, { MakeOption("Pixel Art\\MMPX"), MakeOption("xBRZ\\xBRZ_2x") }, false));
+	CHECK(oversized.CalcOutputSize(inputSize, rendererSize) == CpuSize(933, 700));
+	CHECK(oversized.CalcOutputSize({ 200, 150 }, rendererSize) == CpuSize(800, 600));
+}
+
+// 输出为 600x400，分为多个块，覆盖块的边缘和图像边缘重合与不重合的情况
+TEST_CASE(TiledSegmentMatchesSequential) {
+	constexpr uint32_t WIDTH = 150;
+	constexpr uint32_t HEIGHT = 100;
+	const std::vector<float4> src = MakePixelArtImage(WIDTH, HEIGHT);
+
+	CpuEffectOption rcas = MakeOption("FSR\\FSR_RCAS");
+	rcas.parameters["sharpness"] = 0.6f;
+
+	EffectChainCpu effectChain;
+	REQUIRE(InitializeChain(effectChain, { MakeOption("Pixel Art\\MMPX"), MakeOption("xBRZ\\xBRZ_2x"), rcas }, false));
+
+	std::vector<float4> result;
+	CpuSize resultSize;
+	REQUIRE(effectChain.Run(src, { WIDTH, HEIGHT }, { 1920, 1080 }, result, resultSize));
+	REQUIRE(resultSize == CpuSize(WIDTH * 4, HEIGHT * 4));
+
+	std::vector<float4> mmpx(src.size() * 4);
+	std::vector<float4> xbrz(src.size() * 16);
+	std::vector<float4> expected(xbrz.size());
+	REQUIRE(MmpxCpu::Scale(src, WIDTH, HEIGHT, mmpx));
+	REQUIRE(XbrzCpu::Scale(2, mmpx, WIDTH * 2, HEIGHT * 2, xbrz));
+	REQUIRE(FsrCpu::Rcas(xbrz, WIDTH * 4, HEIGHT * 4, expected, 0.6f));
+
+	CHECK(result == expected);
+}
+
+// 只有一个效果时不分块，因此连续执行两次 CuNNy。每个块按感受野扩展，结果应和直接执行完全相同
+TEST_CASE(TiledCuNNyMatchesDirect) {
+	constexpr uint32_t WIDTH = 150;
+	constexpr uint32_t HEIGHT = 100;
+	const std::vector<float4> src = MakeTestImage(WIDTH, HEIGHT);
+
+	EffectChainCpu effectChain;
+	REQUIRE(InitializeChain(effectChain, {
+		MakeOption("CuNNy\\CuNNy-4x8C-NVL"),
+		MakeOption("CuNNy\\CuNNy-4x8C-NVL")
+	}, false));
+
+	std::vector<float4> result;
+	CpuSize resultSize;
+	REQUIRE(effectChain.Run(src, { WIDTH, HEIGHT }, { 1920, 1080 }, result, resultSize));
+	REQUIRE(resultSize == CpuSize(WIDTH * 4, HEIGHT * 4));
+
+	std::ifstream file(std::filesystem::path(MAGPIE_EFFECTS_DIR) / "CuNNy" / "CuNNy-4x8C-NVL.hlsl", std::ios::binary);
+	const std::string source{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	CuNNyCpu cunny;
+	REQUIRE(cunny.Load(source));
+
+	std::vector<float4> scaled(src.size() * 4);
+	REQUIRE(cunny.Scale(src, WIDTH, HEIGHT, scaled));
+	std::vector<float4> expected(scaled.size() * 4);
+	REQUIRE(cunny.Scale(scaled, WIDTH * 2, HEIGHT * 2, expected));
+
+	CHECK(result == expected);
+}
+
+// 不可分块的效果、可分块的段以及追加的 Bicubic 交替执行
+TEST_CASE(MixedChainMatchesSequential) {
+	constexpr uint32_t WIDTH = 160;
+	constexpr uint32_t HEIGHT = 90;
+	const std::vector<float4> src = MakeTestImage(WIDTH, HEIGHT);
+
+	EffectChainCpu effectChain;
+	REQUIRE(InitializeChain(effectChain, {
+		MakeOption("FSR\\FSR_EASU", CpuScalingType::Normal, { 1.5f, 1.5f }),
+		MakeOption("FSR\\FSR_RCAS"),
+		MakeOption("NIS\\NVSharpen")
+	}, true));
+
+	const CpuSize rendererSize{ 300, 200 };
+	std::vector<float4> result;
+	CpuSize resultSize;
+	REQUIRE(effectChain.Run(src, { WIDTH, HEIGHT }, rendererSize, result, resultSize));
+	REQUIRE(resultSize == rendererSize);
+
+	const CpuSize scaledSize{ 240, 135 };
+	std::vector<float4> easu((size_t)scaledSize.width * scaledSize.height);
+	std::vector<float4> rcas(easu.size());
+	std::vector<float4> sharpen(easu.size());
+	REQUIRE(FsrCpu::Easu(src, WIDTH, HEIGHT, easu, scaledSize.width, scaledSize.height));
+	REQUIRE(FsrCpu::Rcas(easu, scaledSize.width, scaledSize.height, rcas));
+	REQUIRE(NisCpu::Sharpen(rcas, scaledSize.width, scaledSize.height, sharpen));
+
+	CHECK(result == AppendBicubic(sharpen, scaledSize, rendererSize));
+}
+
+// 效果链的输出不随实现改变。这些效果只使用四则运算和 sqrt，结果在所有平台上都相同，
+// 修改效果的行为时需要更新哈希
+TEST_CASE(GoldenOutput) {
+	constexpr uint32_t WIDTH = 96;
+	constexpr uint32_t HEIGHT = 80;
+	const std::vector<float4> src = MakeHashImage(WIDTH, HEIGHT);
+
+	EffectChainCpu effectChain;
+	REQUIRE(InitializeChain(effectChain, {
+		MakeOption("Pixel Art\\MMPX"),
+		MakeOption("xBRZ\\xBRZ_2x"),
+		MakeOption("FSR\\FSR_RCAS")
+	}, false));
+
+	constexpr uint64_t GOLDEN_HASH = 0xE49E352142292065;
+
+	auto run = [&]() -> uint64_t {
+		std::vector<float4> result;
+		CpuSize resultSize;
+		if (!effectChain.Run(src, { WIDTH, HEIGHT }, { 1920, 1080 }, result, resultSize) ||
+			resultSize != CpuSize(WIDTH * 4, HEIGHT * 4)) {
+			return 0;
+		}
+
+		const uint64_t hash = HashImage(result);
+		if (hash != GOLDEN_HASH) {
+			std::printf("哈希为 0x%016llX\n", (unsigned long long)hash);
+		}
+		return hash;
+	};
+
+	const bool avx2Supported = CpuFeatures::IsAvx2Enabled();
+
+	CpuFeatures::SetAvx2Enabled(false);
+	CHECK(run() == GOLDEN_HASH);
+	CpuFeatures::SetAvx2Enabled(true);
+
+	if (!avx2Supported) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+	CHECK(run() == GOLDEN_HASH);
+}
@@ -0,0 +1,218 @@
+#include "TestHelper.h"
+#include "FrameContentFormat.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace Magpie;
+
+namespace {
+
+struct Rect {
+	uint32_t left;
+	uint32_t top;
+	uint32_t width;
+	uint32_t height;
+
+	bool operator==(const Rect&) const = default;
+};
+
+}
+
+// 尺寸不是块大小的倍数，右侧和底部的块被裁剪
+static constexpr FrameContentHeader HEADER{
+	.tileSize = 16,
+	.width = 50,
+	.height = 35
+};
+
+static std::vector<uint8_t> MakeFrame(uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::vector<uint8_t> frame((size_t)HEADER.width * HEADER.height * 4);
+	for (uint8_t& b : frame) {
+		b = (uint8_t)rng();
+	}
+	return frame;
+}
+
+static void SetPixel(std::vector<uint8_t>& frame, uint32_t x, uint32_t y, uint8_t value) {
+	frame[((size_t)y * HEADER.width + x) * 4 + 2] = value;
+}
+
+// 解码一帧，返回写入的块
+static std::vector<Rect> Decode(const std::vector<uint8_t>& data, size_t offset, std::vector<uint8_t>& frame, size_t& frameSize) {
+	std::vector<Rect> tiles;
+	frameSize = FrameContentFormat::DecodeFrame(HEADER, data.data() + offset, data.size() - offset, frame.data(),
+		[&](uint32_t left, uint32_t top, uint32_t width, uint32_t height) {
+			tiles.push_back({ left, top, width, height });
+		});
+	return tiles;
+}
+
+TEST_CASE(HeaderRoundTrip) {
+	uint8_t data[FrameContentFormat::HEADER_SIZE];
+	FrameContentFormat::WriteHeader(HEADER, data);
+
+	FrameContentHeader result;
+	REQUIRE(FrameContentFormat::ReadHeader(data, std::size(data), result));
+	CHECK(result.magic == FrameContentFormat::MAGIC);
+	CHECK(result.version == FrameContentFormat::VERSION);
+	CHECK(result.tileSize == HEADER.tileSize);
+	CHECK(result.width == HEADER.width);
+	CHECK(result.height == HEADER.height);
+
+	// 保留字段为 0
+	bool isReservedZero = true;
+	for (size_t i = 16; i < FrameContentFormat::HEADER_SIZE; ++i) {
+		isReservedZero &= data[i] == 0;
+	}
+	CHECK(isReservedZero);
+}
+
+TEST_CASE(RejectsInvalidHeader) {
+	uint8_t data[FrameContentFormat::HEADER_SIZE];
+	FrameContentFormat::WriteHeader(HEADER, data);
+	FrameContentHeader result;
+
+	// 文件过小
+	CHECK(!FrameContentFormat::ReadHeader(data, std::size(data) - 1, result));
+
+	// magic 不匹配，比如帧轨迹文件
+	data[3] = 'T';
+	CHECK(!FrameContentFormat::ReadHeader(data, std::size(data), result));
+	data[3] = 'C';
+
+	// 未来的版本
+	data[4] = FrameContentFormat::VERSION + 1;
+	CHECK(!FrameContentFormat::ReadHeader(data, std::size(data), result));
+	data[4] = FrameContentFormat::VERSION;
+
+	// 块大小为 0
+	FrameContentFormat::WriteHeader({ .tileSize = 0, .width = 1, .height = 1 }, data);
+	CHECK(!FrameContentFormat::ReadHeader(data, std::size(data), result));
+
+	// 尺寸过大
+	FrameContentFormat::WriteHeader({ .tileSize = 64, .width = FrameContentFormat::MAX_SIZE + 1, .height = 1 }, data);
+	CHECK(!FrameContentFormat::ReadHeader(data, std::size(data), result));
+}
+
+TEST_CASE(FirstFrameHasAllTiles) {
+	const std::vector<uint8_t> frame = MakeFrame(1);
+
+	std::vector<uint8_t> data;
+	CHECK(FrameContentFormat::EncodeFrame(HEADER, 42, frame.data(), nullptr, data) == 4 * 3);
+	CHECK(data.size() == FrameContentFormat::FRAME_HEADER_SIZE +
+		4 * 3 * FrameContentFormat::TILE_HEADER_SIZE + frame.size());
+
+	uint64_t arrivalTime = 0;
+	REQUIRE(FrameContentFormat::PeekArrivalTime(data.data(), data.size(), arrivalTime));
+	CHECK(arrivalTime == 42);
+
+	std::vector<uint8_t> result(frame.size());
+	size_t frameSize;
+	const std::vector<Rect> tiles = Decode(data, 0, result, frameSize);
+	CHECK(frameSize == data.size());
+	CHECK(result == frame);
+
+	REQUIRE(tiles.size() == 12);
+	CHECK((tiles[0] == Rect{ 0, 0, 16, 16 }));
+	CHECK((tiles[3] == Rect{ 48, 0, 2, 16 }));
+	CHECK((tiles[11] == Rect{ 48, 32, 2, 3 }));
+}
+
+TEST_CASE(OnlyChangedTiles) {
+	const std::vector<uint8_t> prev = MakeFrame(1);
+	std::vector<uint8_t> cur = prev;
+	SetPixel(cur, 20, 17, ~cur[((size_t)17 * HEADER.width + 20) * 4 + 2]);
+	// 被裁剪的右下角的块的最后一个像素
+	SetPixel(cur, 49, 34, ~cur[((size_t)34 * HEADER.width + 49) * 4 + 2]);
+
+	std::vector<uint8_t> data;
+	CHECK(FrameContentFormat::EncodeFrame(HEADER, 7, cur.data(), prev.data(), data) == 2);
+
+	std::vector<uint8_t> result = prev;
+	size_t frameSize;
+	const std::vector<Rect> tiles = Decode(data, 0, result, frameSize);
+	CHECK(frameSize == data.size());
+	CHECK(result == cur);
+
+	REQUIRE(tiles.size() == 2);
+	CHECK((tiles[0] == Rect{ 16, 16, 16, 16 }));
+	CHECK((tiles[1] == Rect{ 48, 32, 2, 3 }));
+
+	// 没有变化时只有帧头
+	data.clear();
+	CHECK(FrameContentFormat::EncodeFrame(HEADER, 8, cur.data(), cur.data(), data) == 0);
+	CHECK(data.size() == FrameContentFormat::FRAME_HEADER_SIZE);
+	CHECK(Decode(data, 0, result, frameSize).empty());
+	CHECK(frameSize == data.size());
+}
+
+// 按 FrameTraceRecorder 的方式录制一系列局部变化的帧，其中一些被丢弃，再按 ReplayFrameSource 的方式解码
+TEST_CASE(StreamRoundTrip) {
+	std::mt19937 rng(42);
+
+	std::vector<std::vector<uint8_t>> frames{ MakeFrame(1) };
+	for (uint32_t i = 1; i < 50; ++i) {
+		std::vector<uint8_t> frame = frames.back();
+		for (uint32_t j = rng() % 4; j > 0; --j) {
+			SetPixel(frame, rng() % HEADER.width, rng() % HEADER.height, (uint8_t)rng());
+		}
+		frames.push_back(std::move(frame));
+	}
+
+	std::vector<uint8_t> data;
+	std::vector<size_t> recordedFrames;
+	const uint8_t* prevFrame = nullptr;
+	for (size_t i = 0; i < frames.size(); ++i) {
+		// 写入线程跟不上时丢弃的帧
+		if (i % 7 == 3) {
+			continue;
+		}
+
+		FrameContentFormat::EncodeFrame(HEADER, i * 1000, frames[i].data(), prevFrame, data);
+		prevFrame = frames[i].data();
+		recordedFrames.push_back(i);
+	}
+
+	std::vector<uint8_t> result(frames[0].size());
+	size_t offset = 0;
+	for (size_t idx : recordedFrames) {
+		uint64_t arrivalTime = 0;
+		REQUIRE(FrameContentFormat::PeekArrivalTime(data.data() + offset, data.size() - offset, arrivalTime));
+		CHECK(arrivalTime == idx * 1000);
+
+		size_t frameSize;
+		Decode(data, offset, result, frameSize);
+		REQUIRE(frameSize != 0);
+		CHECK(result == frames[idx]);
+		offset += frameSize;
+	}
+	CHECK(offset == data.size());
+
+	uint64_t arrivalTime;
+	CHECK(!FrameContentFormat::PeekArrivalTime(data.data() + offset, data.size() - offset, arrivalTime));
+}
+
+TEST_CASE(RejectsCorruptFrame) {
+	const std::vector<uint8_t> frame = MakeFrame(1);
+	std::vector<uint8_t> data;
+	FrameContentFormat::EncodeFrame(HEADER, 0, frame.data(), nullptr, data);
+
+	std::vector<uint8_t> result(frame.size());
+	size_t frameSize;
+
+	// 录制被中断时最后一帧不完整
+	for (size_t size : { (size_t)0, FrameContentFormat::FRAME_HEADER_SIZE - 1,
+		FrameContentFormat::FRAME_HEADER_SIZE + 2, data.size() - 1 }) {
+		const std::vector<uint8_t> truncated(data.begin(), data.begin() + size);
+		Decode(truncated, 0, result, frameSize);
+		CHECK(frameSize == 0);
+	}
+
+	// 块的坐标超出范围
+	std::vector<uint8_t> corrupt = data;
+	corrupt[FrameContentFormat::FRAME_HEADER_SIZE] = 4;
+	Decode(corrupt, 0, result, frameSize);
+	CHECK(frameSize == 0);
+}
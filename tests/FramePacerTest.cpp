@@ -0,0 +1,225 @@
+#include "TestHelper.h"
+#include "StepTimerPolicy.h"
+#include <cstdint>
+#include <functional>
+
+// FramePacer 的估计和 StepTimerPolicy 的 pacing 决策，由模拟的时钟驱动
+
+using namespace Magpie;
+using namespace std::chrono;
+
+static constexpr nanoseconds REFRESH_PERIOD = nanoseconds(16'666'667);
+
+namespace {
+
+struct PacingStats {
+	uint32_t frameCount = 0;
+	// 完成后前端来不及在合成前呈现的帧数
+	uint32_t missedCount = 0;
+	// 从开始捕获到渲染结果被合成的平均时长
+	nanoseconds meanLatency{};
+};
+
+}
+
+// 模拟 StepTimer 的循环：源窗口总有新帧，捕获和渲染的耗时由 workTime 给出，合成发生在
+// REFRESH_PERIOD 的整数倍。前 warmupCount 帧不计入统计
+static PacingStats SimulatePacing(
+	bool enablePacing,
+	const std::function<nanoseconds(uint32_t)>& workTime,
+	uint32_t frameCount,
+	uint32_t warmupCount,
+	std::optional<float> maxFrameRate = std::nullopt
+) {
+	StepTimerPolicy policy;
+	policy.Initialize(0, maxFrameRate, enablePacing);
+
+	PacingStats stats;
+	nanoseconds now{ 1'234'567 };
+	nanoseconds latencySum{};
+
+	for (uint32_t i = 0; i < frameCount;) {
+		if (policy.IsCompositionTimingNeeded()) {
+			policy.Pacer().SetCompositionTiming(nanoseconds(0), REFRESH_PERIOD);
+		}
+
+		const StepTimerPolicy::Decision decision = policy.Decide(now);
+		if (decision.status == StepTimerStatus::WaitForFPSLimiter) {
+			now += decision.waitTime;
+			continue;
+		}
+
+		const nanoseconds startTime = now;
+		policy.OnRender();
+		now += workTime(i);
+
+		if (i >= warmupCount) {
+			// 前端需要 PACING_SAFETY_MARGIN 才能呈现
+			const nanoseconds readyTime = now + StepTimerPolicy::PACING_SAFETY_MARGIN;
+			const nanoseconds composeTime = (readyTime + REFRESH_PERIOD - nanoseconds(1)) / REFRESH_PERIOD * REFRESH_PERIOD;
+			const nanoseconds latency = composeTime - startTime;
+
+			latencySum += latency;
+			stats.missedCount += latency > REFRESH_PERIOD;
+			++stats.frameCount;
+		}
+
+		++i;
+	}
+
+	stats.meanLatency = latencySum / stats.frameCount;
+	return stats;
+}
+
+TEST_CASE(FirstSampleInitializesEstimate) {
+	FramePacer pacer;
+	pacer.Initialize(milliseconds(2));
+	pacer.AddSample(milliseconds(4));
+
+	// 均值为样本，平均偏差为样本的一半
+	CHECK(pacer.PredictedWorkTime() == milliseconds(4 + 4 * 2));
+}
+
+TEST_CASE(EstimateConvergesToStableWorkTime) {
+	FramePacer pacer;
+	pacer.Initialize(milliseconds(2));
+	for (int i = 0; i < 40; ++i) {
+		pacer.AddSample(milliseconds(5));
+	}
+
+	// 平均偏差每次衰减为 3/4
+	CHECK(pacer.PredictedWorkTime() >= milliseconds(5));
+	CHECK(pacer.PredictedWorkTime() < microseconds(5010));
+}
+
+// 超出预测的样本立即提高均值，回落时缓慢收敛
+TEST_CASE(EstimateReactsToSpikes) {
+	FramePacer pacer;
+	pacer.Initialize(milliseconds(2));
+	for (int i = 0; i < 40; ++i) {
+		pacer.AddSample(milliseconds(5));
+	}
+
+	pacer.AddSample(milliseconds(9));
+	const nanoseconds afterSpike = pacer.PredictedWorkTime();
+	CHECK(afterSpike >= milliseconds(9));
+
+	// 偏差也随之增大，因此下一个正常的样本不会降低预测
+	pacer.AddSample(milliseconds(5));
+	CHECK(pacer.PredictedWorkTime() > milliseconds(9));
+
+	for (int i = 0; i < 60; ++i) {
+		pacer.AddSample(milliseconds(5));
+	}
+	CHECK(pacer.PredictedWorkTime() < microseconds(5100));
+}
+
+TEST_CASE(NoPacingUntilReady) {
+	FramePacer pacer;
+	pacer.Initialize(milliseconds(2));
+	const nanoseconds now = milliseconds(100);
+
+	// 没有合成时间
+	for (int i = 0; i < 20; ++i) {
+		pacer.AddSample(milliseconds(5));
+	}
+	CHECK(!pacer.IsReady());
+	CHECK(pacer.NextWorkStart(now) == now);
+
+	// 样本不足
+	FramePacer fewSamples;
+	fewSamples.Initialize(milliseconds(2));
+	fewSamples.SetCompositionTiming(nanoseconds(0), REFRESH_PERIOD);
+	for (int i = 0; i < 7; ++i) {
+		fewSamples.AddSample(milliseconds(5));
+	}
+	CHECK(!fewSamples.IsReady());
+	CHECK(fewSamples.NextWorkStart(now) == now);
+
+	fewSamples.AddSample(milliseconds(5));
+	CHECK(fewSamples.IsReady());
+}
+
+// 开始时间是赶得上合成的最晚时间，位于 now 之后的一个刷新间隔内
+TEST_CASE(WorkStartsJustInTime) {
+	FramePacer pacer;
+	pacer.Initialize(milliseconds(2));
+	pacer.SetCompositionTiming(milliseconds(3), REFRESH_PERIOD);
+	for (int i = 0; i < 40; ++i) {
+		pacer.AddSample(milliseconds(5));
+	}
+
+	const nanoseconds budget = pacer.PredictedWorkTime() + milliseconds(2);
+	for (nanoseconds now : { microseconds(100000), microseconds(107000), microseconds(1000000), microseconds(1003000) }) {
+		const nanoseconds start = pacer.NextWorkStart(now);
+		CHECK(start >= now);
+		CHECK(start - now < REFRESH_PERIOD);
+		// start + budget 恰好是一次合成
+		CHECK((start + budget - milliseconds(3)) % REFRESH_PERIOD == nanoseconds(0));
+	}
+}
+
+// 一个刷新间隔内无法完成时不推迟
+TEST_CASE(NoPacingWhenBudgetExceedsRefreshPeriod) {
+	FramePacer pacer;
+	pacer.Initialize(milliseconds(2));
+	pacer.SetCompositionTiming(nanoseconds(0), REFRESH_PERIOD);
+	for (int i = 0; i < 40; ++i) {
+		pacer.AddSample(milliseconds(15));
+	}
+
+	CHECK(pacer.NextWorkStart(milliseconds(100)) == milliseconds(100));
+}
+
+// 耗时稳定时开始捕获到合成的延迟接近耗时加上余量，不启用 pacing 时约多半个刷新间隔
+TEST_CASE(PacingReducesLatency) {
+	auto workTime = [](uint32_t) -> nanoseconds { return milliseconds(5); };
+	const PacingStats paced = SimulatePacing(true, workTime, 600, 30);
+	const PacingStats unpaced = SimulatePacing(false, workTime, 600, 30);
+
+	CHECK(paced.missedCount == 0);
+	CHECK(paced.meanLatency < microseconds(7100));
+	CHECK(unpaced.meanLatency > paced.meanLatency + milliseconds(3));
+}
+
+// 帧率限制为刷新率时（如 GDI 捕获）帧的开始时间也应和合成对齐，而不是停留在第一帧确定的相位上
+TEST_CASE(PacingAlignsFrameRateLimiter) {
+	auto workTime = [](uint32_t) -> nanoseconds { return milliseconds(5); };
+	const PacingStats paced = SimulatePacing(true, workTime, 600, 30, 60.0f);
+	const PacingStats unpaced = SimulatePacing(false, workTime, 600, 30, 60.0f);
+
+	CHECK(paced.missedCount == 0);
+	CHECK(paced.meanLatency < microseconds(7100));
+	CHECK(unpaced.meanLatency > paced.meanLatency + milliseconds(3));
+}
+
+// 耗时在 4.5ms 和 5.5ms 之间波动时预测的余量足以覆盖绝大多数波动
+TEST_CASE(PacingToleratesJitter) {
+	uint32_t state = 1;
+	auto workTime = [&](uint32_t) -> nanoseconds {
+		state = state * 1664525u + 1013904223u;
+		return microseconds(4500 + (state >> 8) % 1001);
+	};
+
+	const PacingStats stats = SimulatePacing(true, workTime, 2000, 30);
+	CHECK(stats.missedCount * 100 <= stats.frameCount);
+	CHECK(stats.meanLatency < milliseconds(10));
+}
+
+// 耗时突然变长时最多错过一次合成，之后立即适应
+TEST_CASE(PacingRecoversFromSlowdown) {
+	auto workTime = [](uint32_t frame) -> nanoseconds {
+		return frame < 300 ? milliseconds(4) : milliseconds(9);
+	};
+
+	const PacingStats stats = SimulatePacing(true, workTime, 600, 30);
+	CHECK(stats.missedCount <= 1);
+}
+
+// 耗时超过刷新间隔时 pacing 不生效，和不启用时相同
+TEST_CASE(PacingDisabledForSlowWork) {
+	auto workTime = [](uint32_t) -> nanoseconds { return milliseconds(20); };
+	const PacingStats paced = SimulatePacing(true, workTime, 200, 30);
+	const PacingStats unpaced = SimulatePacing(false, workTime, 200, 30);
+	CHECK(paced.meanLatency == unpaced.meanLatency);
+}
@@ -0,0 +1,204 @@
+#include "TestHelper.h"
+#include "FrameSignature.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// FrameSignature 的碰撞特性：单个像素变化和交换像素时签名必定变化，随机修改多个像素时两个分量都不应碰撞
+
+using namespace Magpie;
+
+// 宽高都不是 TILE_SIZE 的整数倍，覆盖边缘的不完整块
+static constexpr uint32_t WIDTH = 40;
+static constexpr uint32_t HEIGHT = 37;
+
+static std::vector<float> MakeImage(uint32_t width, uint32_t height, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::vector<float> rgba((size_t)width * height * 4);
+	for (size_t i = 0; i < rgba.size(); ++i) {
+		// 8 位的颜色，和捕获的纹理相同
+		rgba[i] = i % 4 == 3 ? 1.0f : float(rng() % 256) / 255.0f;
+	}
+	return rgba;
+}
+
+static std::vector<uint64_t> Compute(const std::vector<float>& rgba) {
+	std::vector<uint64_t> signatures;
+	FrameSignature::Compute(rgba.data(), WIDTH, HEIGHT, signatures);
+	return signatures;
+}
+
+static uint32_t TileIndex(uint32_t x, uint32_t y) noexcept {
+	return y / FrameSignature::TILE_SIZE * FrameSignature::TileCount(WIDTH) + x / FrameSignature::TILE_SIZE;
+}
+
+// 除了 changedTiles 中的块，其他块的签名不变；changedTiles 中的块的两个分量都变化
+static bool OnlyTilesChanged(
+	const std::vector<uint64_t>& before,
+	const std::vector<uint64_t>& after,
+	std::initializer_list<uint32_t> changedTiles
+) noexcept {
+	for (uint32_t i = 0; i < before.size(); ++i) {
+		bool shouldChange = false;
+		for (uint32_t tile : changedTiles) {
+			shouldChange |= tile == i;
+		}
+
+		if (shouldChange) {
+			if ((uint32_t)before[i] == (uint32_t)after[i] || before[i] >> 32 == after[i] >> 32) {
+				return false;
+			}
+		} else if (before[i] != after[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE(TileLayout) {
+	CHECK(FrameSignature::TileCount(1) == 1);
+	CHECK(FrameSignature::TileCount(32) == 1);
+	CHECK(FrameSignature::TileCount(33) == 2);
+
+	const std::vector<uint64_t> signatures = Compute(MakeImage(WIDTH, HEIGHT, 1));
+	CHECK(signatures.size() == 4);
+}
+
+TEST_CASE(IdenticalFramesMatch) {
+	CHECK(Compute(MakeImage(WIDTH, HEIGHT, 1)) == Compute(MakeImage(WIDTH, HEIGHT, 1)));
+}
+
+// 只比较 RGB，和着色器相同
+TEST_CASE(AlphaIsIgnored) {
+	std::vector<float> image = MakeImage(WIDTH, HEIGHT, 1);
+	const std::vector<uint64_t> before = Compute(image);
+	image[3] = 0.5f;
+	CHECK(Compute(image) == before);
+}
+
+// 每个像素的每个分量分别改变最低位和整个值
+TEST_CASE(SingleTexelEditsAlwaysDetected) {
+	const std::vector<float> image = MakeImage(WIDTH, HEIGHT, 2);
+	const std::vector<uint64_t> before = Compute(image);
+
+	uint32_t undetected = 0;
+	for (uint32_t y = 0; y < HEIGHT; ++y) {
+		for (uint32_t x = 0; x < WIDTH; ++x) {
+			const uint32_t channel = (x + y) % 3;
+			const size_t idx = ((size_t)y * WIDTH + x) * 4 + channel;
+
+			std::vector<float> edited = image;
+			edited[idx] = std::bit_cast<float>(std::bit_cast<uint32_t>(edited[idx]) ^ 1);
+			undetected += !OnlyTilesChanged(before, Compute(edited), { TileIndex(x, y) });
+
+			edited[idx] = image[idx] == 1.0f ? 0.0f : 1.0f;
+			undetected += !OnlyTilesChanged(before, Compute(edited), { TileIndex(x, y) });
+		}
+	}
+	CHECK(undetected == 0);
+}
+
+// 哈希包含位置，因此交换两个不同的像素时签名变化，无论它们是否在同一块中
+TEST_CASE(SwapsAlwaysDetected) {
+	const std::vector<float> image = MakeImage(WIDTH, HEIGHT, 3);
+	const std::vector<uint64_t> before = Compute(image);
+
+	auto swapTexels = [&](uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+		std::vector<float> edited = image;
+		for (uint32_t c = 0; c < 3; ++c) {
+			std::swap(edited[((size_t)y0 * WIDTH + x0) * 4 + c], edited[((size_t)y1 * WIDTH + x1) * 4 + c]);
+		}
+		return Compute(edited);
+	};
+
+	uint32_t undetected = 0;
+	for (uint32_t y = 0; y < HEIGHT; ++y) {
+		for (uint32_t x = 0; x + 1 < WIDTH; ++x) {
+			// 水平相邻
+			undetected += !OnlyTilesChanged(before, swapTexels(x, y, x + 1, y), { TileIndex(x, y), TileIndex(x + 1, y) });
+			// 竖直相邻
+			if (y + 1 < HEIGHT) {
+				undetected += !OnlyTilesChanged(before, swapTexels(x, y, x, y + 1), { TileIndex(x, y), TileIndex(x, y + 1) });
+			}
+		}
+	}
+	CHECK(undetected == 0);
+}
+
+// 在一个块内随机修改 2 到 16 个像素。签名是像素哈希之和，因此签名的变化量是被修改的像素的哈希的变化量之和
+TEST_CASE(RandomEditsHaveNoCollisions) {
+	constexpr uint32_t TILE_SIZE = FrameSignature::TILE_SIZE;
+	constexpr uint32_t EDIT_COUNT = 200000;
+
+	std::mt19937 rng(4);
+	std::vector<uint32_t> texels(TILE_SIZE * TILE_SIZE * 3);
+	for (uint32_t& value : texels) {
+		value = std::bit_cast<uint32_t>(float(rng() % 256) / 255.0f);
+	}
+
+	auto hashTexel = [&](uint32_t idx) {
+		return FrameSignature::HashTexel(idx % TILE_SIZE, idx / TILE_SIZE,
+			texels[idx * 3], texels[idx * 3 + 1], texels[idx * 3 + 2]);
+	};
+
+	uint64_t signature = 0;
+	for (uint32_t i = 0; i < TILE_SIZE * TILE_SIZE; ++i) {
+		signature = FrameSignature::Combine(signature, hashTexel(i));
+	}
+
+	// 确认和 Compute 一致
+	{
+		std::vector<float> rgba(TILE_SIZE * TILE_SIZE * 4);
+		for (uint32_t i = 0; i < TILE_SIZE * TILE_SIZE; ++i) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				rgba[i * 4 + c] = std::bit_cast<float>(texels[i * 3 + c]);
+			}
+		}
+		std::vector<uint64_t> signatures;
+		FrameSignature::Compute(rgba.data(), TILE_SIZE, TILE_SIZE, signatures);
+		REQUIRE(signatures.size() == 1);
+		REQUIRE(signatures[0] == signature);
+	}
+
+	uint32_t loCollisions = 0;
+	uint32_t hiCollisions = 0;
+	std::vector<uint32_t> edited;
+	for (uint32_t i = 0; i < EDIT_COUNT; ++i) {
+		// 选出不重复的像素
+		const uint32_t editCount = 2 + rng() % 15;
+		edited.clear();
+		while (edited.size() < editCount) {
+			const uint32_t idx = rng() % (TILE_SIZE * TILE_SIZE);
+			if (std::find(edited.begin(), edited.end(), idx) == edited.end()) {
+				edited.push_back(idx);
+			}
+		}
+
+		// 两个分量的变化量，签名不变时为 0
+		uint32_t deltaLo = 0;
+		uint32_t deltaHi = 0;
+		for (uint32_t idx : edited) {
+			const uint64_t oldHash = hashTexel(idx);
+
+			// 修改一个分量
+			uint32_t& value = texels[idx * 3 + rng() % 3];
+			const uint32_t oldValue = value;
+			do {
+				value = std::bit_cast<uint32_t>(float(rng() % 256) / 255.0f);
+			} while (value == oldValue);
+			const uint64_t newHash = hashTexel(idx);
+			value = oldValue;
+
+			deltaLo += (uint32_t)newHash - (uint32_t)oldHash;
+			deltaHi += (uint32_t)(newHash >> 32) - (uint32_t)(oldHash >> 32);
+		}
+
+		loCollisions += deltaLo == 0;
+		hiCollisions += deltaHi == 0;
+	}
+
+	CHECK(loCollisions == 0);
+	CHECK(hiCollisions == 0);
+}
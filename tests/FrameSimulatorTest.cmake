@@ -0,0 +1,86 @@
+# 用合成的帧轨迹运行 FrameSimulator，检查输出的帧率、丢帧数和延迟。
+# cmake -DFRAME_SIMULATOR=<FrameSimulator 的路径> -P FrameSimulatorTest.cmake
+#
+# 合成的轨迹没有抖动时结果是确定的，期望值可以由刷新率推算：60Hz 下每个内容在到达后的下一次合成时
+# 显示，延迟为一个刷新间隔，即 16.667ms。
+
+if(NOT FRAME_SIMULATOR)
+	message(FATAL_ERROR "未指定 FRAME_SIMULATOR")
+endif()
+
+# 检查 value 是否在 [min, max] 中
+function(check_range scenario column value min max)
+	if(value LESS min OR value GREATER max)
+		message(SEND_ERROR "${scenario}: ${column} 为 ${value}，应在 [${min}, ${max}] 中")
+	endif()
+endfunction()
+
+# simulate(<场景> <FrameSimulator 的参数>...)
+# 运行后将最后一行输出的各列保存在 fps、missed、wasted、checks、latency、p95、capture 和 capture95 中
+macro(simulate scenario)
+	execute_process(
+		COMMAND ${FRAME_SIMULATOR} --csv ${ARGN}
+		RESULT_VARIABLE exitCode
+		OUTPUT_VARIABLE output
+		ERROR_VARIABLE errorOutput
+		OUTPUT_STRIP_TRAILING_WHITESPACE
+	)
+	if(NOT exitCode EQUAL 0)
+		message(FATAL_ERROR "${scenario}: FrameSimulator 返回 ${exitCode}\n${errorOutput}")
+	endif()
+
+	string(REPLACE "\n" ";" lines "${output}")
+	list(GET lines -1 row)
+	# 轨迹的名字中可能有逗号，从末尾取各列
+	string(REPLACE "," ";" row "${row}")
+	list(GET row -10 arrivals)
+	list(GET row -9 contents)
+	list(GET row -8 fps)
+	list(GET row -7 missed)
+	list(GET row -6 wasted)
+	list(GET row -5 checks)
+	list(GET row -4 latency)
+	list(GET row -3 p95)
+	list(GET row -2 capture)
+	list(GET row -1 capture95)
+	message(STATUS "${scenario}: fps=${fps} missed=${missed} wasted=${wasted} checks=${checks} latency=${latency} p95=${p95}")
+endmacro()
+
+# 内容和捕获的帧率都是 60，每帧都应被渲染一次
+simulate("60/60" synthetic:source=60,content=60,seconds=10)
+check_range("60/60" arrivals ${arrivals} 600 600)
+check_range("60/60" contents ${contents} 600 600)
+check_range("60/60" fps ${fps} 59.5 60.5)
+check_range("60/60" missed ${missed} 0 0)
+check_range("60/60" wasted ${wasted} 0 0)
+check_range("60/60" latency ${latency} 16.6 16.7)
+check_range("60/60" p95 ${p95} 16.6 16.7)
+
+# 以 60 帧捕获 24 帧的视频，动态检测应跳过所有重复帧
+simulate("24/60 dynamic" --detection dynamic synthetic:source=60,content=24,seconds=10)
+check_range("24/60 dynamic" contents ${contents} 240 240)
+check_range("24/60 dynamic" fps ${fps} 23.5 24.5)
+check_range("24/60 dynamic" missed ${missed} 0 0)
+check_range("24/60 dynamic" wasted ${wasted} 0 0)
+check_range("24/60 dynamic" latency ${latency} 16.6 16.7)
+
+# 不检测重复帧时每次捕获都渲染，600 次渲染中 360 次是重复的
+simulate("24/60 never" --detection never synthetic:source=60,content=24,seconds=10)
+check_range("24/60 never" fps ${fps} 59.5 60.5)
+check_range("24/60 never" missed ${missed} 0 0)
+check_range("24/60 never" wasted ${wasted} 360 360)
+check_range("24/60 never" checks ${checks} 0 0)
+
+# 渲染一帧需要 20ms，超过了刷新间隔，每 6 帧丢失约 1 帧，延迟也随之增加
+simulate("slow render" --detection never --render-ms 20 synthetic:source=60,content=60,seconds=10)
+check_range("slow render" fps ${fps} 49.5 50.5)
+check_range("slow render" missed ${missed} 99 100)
+check_range("slow render" latency ${latency} 33.3 40)
+check_range("slow render" p95 ${p95} 49.9 50.1)
+
+# 到达时间有抖动时仍不应丢帧，延迟不超过两个刷新间隔
+simulate("30/144 jitter" synthetic:source=144,content=30,seconds=10,jitter=1,seed=3)
+check_range("30/144 jitter" contents ${contents} 300 300)
+check_range("30/144 jitter" fps ${fps} 29.5 30.5)
+check_range("30/144 jitter" missed ${missed} 0 0)
+check_range("30/144 jitter" p95 ${p95} 0 33.4)
@@ -0,0 +1,134 @@
+#include "TestHelper.h"
+#include "FrameTraceFormat.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace Magpie;
+
+// 按 FrameTraceRecorder 的方式生成完整的轨迹文件
+static std::vector<uint8_t> WriteTrace(
+	const FrameTraceHeader& header,
+	const std::vector<FrameTraceRecord>& records
+) {
+	std::vector<uint8_t> data(FrameTraceFormat::HEADER_SIZE + records.size() * FrameTraceFormat::RECORD_SIZE);
+	FrameTraceFormat::WriteHeader(header, data.data());
+	for (size_t i = 0; i < records.size(); ++i) {
+		FrameTraceFormat::WriteRecord(
+			records[i], data.data() + FrameTraceFormat::HEADER_SIZE + i * FrameTraceFormat::RECORD_SIZE);
+	}
+	return data;
+}
+
+TEST_CASE(HeaderRoundTrip) {
+	const FrameTraceHeader header{
+		.captureMethod = 2,
+		.width = 3840,
+		.height = 2160,
+		.duplicateFrameDetectionMode = 1,
+		.minFrameRate = 23.976f,
+		.maxFrameRate = 144.0f
+	};
+
+	const std::vector<uint8_t> data = WriteTrace(header, {});
+	REQUIRE(data.size() == 32);
+
+	FrameTraceHeader result;
+	REQUIRE(FrameTraceFormat::ReadHeader(data.data(), data.size(), result));
+	CHECK(result.magic == FrameTraceFormat::MAGIC);
+	CHECK(result.version == FrameTraceFormat::VERSION);
+	CHECK(result.captureMethod == header.captureMethod);
+	CHECK(result.width == header.width);
+	CHECK(result.height == header.height);
+	CHECK(result.duplicateFrameDetectionMode == header.duplicateFrameDetectionMode);
+	CHECK(result.minFrameRate == header.minFrameRate);
+	CHECK(result.maxFrameRate == header.maxFrameRate);
+}
+
+TEST_CASE(RecordRoundTrip) {
+	std::mt19937_64 rng(42);
+	std::vector<FrameTraceRecord> records(1000);
+	for (FrameTraceRecord& record : records) {
+		record.arrivalTime = rng();
+		record.checkDuration = (uint32_t)rng();
+		record.decision = FrameTraceDecision(rng() % 6);
+	}
+
+	const std::vector<uint8_t> data = WriteTrace({}, records);
+	REQUIRE(FrameTraceFormat::GetRecordCount(data.size()) == records.size());
+
+	for (size_t i = 0; i < records.size(); ++i) {
+		FrameTraceRecord result;
+		FrameTraceFormat::ReadRecord(
+			data.data() + FrameTraceFormat::HEADER_SIZE + i * FrameTraceFormat::RECORD_SIZE, result);
+		CHECK(result.arrivalTime == records[i].arrivalTime);
+		CHECK(result.checkDuration == records[i].checkDuration);
+		CHECK(result.decision == records[i].decision);
+	}
+}
+
+// 文件格式是固定的，修改编码方式不能改变已有文件的含义
+TEST_CASE(GoldenBytes) {
+	const FrameTraceHeader header{
+		.captureMethod = 1,
+		.width = 0x780,
+		.height = 0x438,
+		.duplicateFrameDetectionMode = 2,
+		.minFrameRate = 1.0f,
+		.maxFrameRate = 0.0f
+	};
+	const FrameTraceRecord record{
+		.arrivalTime = 0x0102030405060708,
+		.checkDuration = 0x1234,
+		.decision = FrameTraceDecision::MispredictedDuplicate
+	};
+
+	const std::vector<uint8_t> data = WriteTrace(header, { record });
+	const uint8_t expected[] = {
+		'M', 'P', 'F', 'T', 0x02, 0x00, 0x01, 0x00,
+		0x80, 0x07, 0x00, 0x00, 0x38, 0x04, 0x00, 0x00,
+		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+		0x34, 0x12, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00
+	};
+
+	REQUIRE(data.size() == std::size(expected));
+	for (size_t i = 0; i < data.size(); ++i) {
+		CHECK(data[i] == expected[i]);
+	}
+}
+
+TEST_CASE(RejectsInvalidHeader) {
+	std::vector<uint8_t> data = WriteTrace({}, {});
+	FrameTraceHeader result;
+
+	// 文件过小
+	CHECK(!FrameTraceFormat::ReadHeader(data.data(), data.size() - 1, result));
+
+	// magic 不匹配
+	data[0] = 'X';
+	CHECK(!FrameTraceFormat::ReadHeader(data.data(), data.size(), result));
+	data[0] = 'M';
+
+	// 未来的版本
+	data[4] = FrameTraceFormat::VERSION + 1;
+	CHECK(!FrameTraceFormat::ReadHeader(data.data(), data.size(), result));
+
+	// 版本 0 从未存在过
+	data[4] = 0;
+	CHECK(!FrameTraceFormat::ReadHeader(data.data(), data.size(), result));
+
+	// 版本 1 可以读取
+	data[4] = 1;
+	CHECK(FrameTraceFormat::ReadHeader(data.data(), data.size(), result));
+	CHECK(result.version == 1);
+}
+
+TEST_CASE(TruncatedRecordIsIgnored) {
+	const std::vector<uint8_t> data = WriteTrace({}, std::vector<FrameTraceRecord>(3));
+	CHECK(FrameTraceFormat::GetRecordCount(data.size()) == 3);
+	CHECK(FrameTraceFormat::GetRecordCount(data.size() - 1) == 2);
+	CHECK(FrameTraceFormat::GetRecordCount(FrameTraceFormat::HEADER_SIZE) == 0);
+	CHECK(FrameTraceFormat::GetRecordCount(0) == 0);
+}
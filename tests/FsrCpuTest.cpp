@@ -0,0 +1,88 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "FsrCpu.h"
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+TEST_CASE(RejectsInvalidArguments) {
+	std::vector<float4> src(16);
+	std::vector<float4> dest(64);
+	CHECK(!FsrCpu::Easu(src, 0, 4, dest, 8, 8));
+	CHECK(!FsrCpu::Easu(src, 5, 4, dest, 8, 8));
+	CHECK(!FsrCpu::Easu(src, 4, 4, dest, 9, 8));
+	CHECK(!FsrCpu::Rcas(src, 4, 0, dest));
+	CHECK(!FsrCpu::Rcas(src, 5, 4, dest));
+	CHECK(!FsrCpu::Scale(src, 4, 4, dest, 8, 9));
+}
+
+// 纯色图像上 EASU 的权重之和被归一化，RCAS 的 lobe 为 0
+TEST_CASE(FlatImageIsUnchanged) {
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+
+	std::vector<float4> dest(37 * 23);
+	REQUIRE(FsrCpu::Easu(src, 16, 16, dest, 37, 23));
+	CHECK(MaxError(dest, std::vector<float4>(dest.size(), color)) < 1e-5f);
+
+	dest.resize(src.size());
+	REQUIRE(FsrCpu::Rcas(src, 16, 16, dest));
+	// RCAS 在图像外读取 0，只检查内部
+	float maxError = 0.0f;
+	for (uint32_t y = 1; y < 15; ++y) {
+		for (uint32_t x = 1; x < 15; ++x) {
+			const float4 error = Abs(dest[y * 16 + x] - color);
+			maxError = std::max({ maxError, error.x, error.y, error.z });
+		}
+	}
+	CHECK(maxError < 1e-5f);
+}
+
+TEST_CASE(OutputIsInRange) {
+	const std::vector<float4> src = MakeTestImage(37, 29);
+	std::vector<float4> dest(74 * 58);
+	REQUIRE(FsrCpu::Scale(src, 37, 29, dest, 74, 58));
+
+	bool inRange = true;
+	for (const float4& pixel : dest) {
+		inRange &= pixel.x >= 0.0f && pixel.x <= 1.0f && pixel.y >= 0.0f && pixel.y <= 1.0f &&
+			pixel.z >= 0.0f && pixel.z <= 1.0f && pixel.w == 1.0f;
+	}
+	CHECK(inRange);
+}
+
+// AVX2 核不使用 FMA，结果必须和可移植的实现完全相同。宽度不是 8 的倍数，覆盖每行末尾的可移植路径
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	const std::vector<float4> src = MakeTestImage(37, 29);
+	const std::pair<uint32_t, uint32_t> destSizes[] = { { 74, 58 }, { 91, 43 }, { 23, 17 } };
+
+	for (auto [destWidth, destHeight] : destSizes) {
+		std::vector<float4> portable((size_t)destWidth * destHeight);
+		std::vector<float4> avx2(portable.size());
+
+		CpuFeatures::SetAvx2Enabled(false);
+		REQUIRE(FsrCpu::Scale(src, 37, 29, portable, destWidth, destHeight));
+		CpuFeatures::SetAvx2Enabled(true);
+		REQUIRE(FsrCpu::Scale(src, 37, 29, avx2, destWidth, destHeight));
+		CHECK(portable == avx2);
+	}
+
+	// 饱和的像素使 RCAS 的 hitMax 为 0/0，检查 NaN 的处理
+	std::vector<float4> saturated = src;
+	for (size_t i = 0; i < saturated.size(); i += 3) {
+		saturated[i] = float4(1.0f, 1.0f, 1.0f, 1.0f);
+	}
+	std::vector<float4> portable(saturated.size());
+	std::vector<float4> avx2(saturated.size());
+	CpuFeatures::SetAvx2Enabled(false);
+	REQUIRE(FsrCpu::Rcas(saturated, 37, 29, portable));
+	CpuFeatures::SetAvx2Enabled(true);
+	REQUIRE(FsrCpu::Rcas(saturated, 37, 29, avx2));
+	CHECK(portable == avx2);
+}
@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+// 没有 libFuzzer 时使用的驱动。命令行中给出的文件逐个运行一次；没有参数时从模糊测试目标提供的种子
+// 出发，随机变异固定的次数，使测试可以在 CI 中重现。使用 clang 时可以改为链接 -fsanitize=fuzzer。
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+// 由模糊测试目标定义
+std::vector<std::vector<uint8_t>> GetFuzzSeeds();
+
+static constexpr uint32_t ITERATIONS = 200000;
+
+static void Mutate(std::vector<uint8_t>& input, std::mt19937& rng) {
+	static constexpr uint32_t INTERESTING_VALUES[] = {
+		0, 1, 2, 3, 4, 0x7f, 0x80, 0xff, 0x100, 0x4000, 0x4001, 0x7fffffff, 0x80000000, 0xffffffff
+	};
+
+	const uint32_t mutationCount = 1 + rng() % 8;
+	for (uint32_t i = 0; i < mutationCount; ++i) {
+		switch (rng() % 5) {
+		case 0:
+			// 翻转一位
+			if (!input.empty()) {
+				input[rng() % input.size()] ^= uint8_t(1 << (rng() % 8));
+			}
+			break;
+		case 1:
+			// 随机字节
+			if (!input.empty()) {
+				input[rng() % input.size()] = uint8_t(rng());
+			}
+			break;
+		case 2:
+		{
+			// 写入特殊的 32 位整数，DDS 和 UTF 的边界条件大多是这些值
+			if (input.size() >= 4) {
+				const uint32_t value = INTERESTING_VALUES[rng() % std::size(INTERESTING_VALUES)];
+				const size_t pos = rng() % (input.size() - 3);
+				for (size_t j = 0; j < 4; ++j) {
+					input[pos + j] = uint8_t(value >> (j * 8));
+				}
+			}
+			break;
+		}
+		case 3:
+			// 截断
+			input.resize(input.empty() ? 0 : rng() % (input.size() + 1));
+			break;
+		default:
+			// 在末尾追加
+			input.resize(input.size() + 1 + rng() % 64, uint8_t(rng()));
+			break;
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc > 1) {
+		for (int i = 1; i < argc; ++i) {
+			std::ifstream file(argv[i], std::ios::binary);
+			if (!file) {
+				std::fprintf(stderr, "无法打开 %s\n", argv[i]);
+				return 1;
+			}
+
+			const std::vector<uint8_t> input(
+				(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			LLVMFuzzerTestOneInput(input.data(), input.size());
+		}
+		return 0;
+	}
+
+	const std::vector<std::vector<uint8_t>> seeds = GetFuzzSeeds();
+	for (const std::vector<uint8_t>& seed : seeds) {
+		LLVMFuzzerTestOneInput(seed.data(), seed.size());
+	}
+
+	std::mt19937 rng(0);
+	std::vector<uint8_t> input;
+	for (uint32_t i = 0; i < ITERATIONS; ++i) {
+		input = seeds[rng() % seeds.size()];
+		Mutate(input, rng);
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	std::printf("%u 次随机输入\n", ITERATIONS);
+	return 0;
+}
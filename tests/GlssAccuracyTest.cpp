@@ -0,0 +1,105 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "GlssCpu.h"
+#include <limits>
+
+// GLss 的 FP16 变体相对于 FP32 的精度损失。GlssCpu 以 emulateFP16 模拟着色器中 MF 类型的
+// 半精度舍入，这里放大同一张合成图像并比较两者，误差超出下面的界限时说明 FP16 路径的改动
+// 引入了额外的精度损失。
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+namespace {
+
+struct ErrorStats {
+	// 峰值为 1，两个图像相同时为无穷大
+	double psnr = 0;
+	float maxError = 0;
+	// 误差超过 1/255 的像素的比例
+	double outlierRatio = 0;
+};
+
+}
+
+// 只比较 RGB 通道
+static ErrorStats MeasureError(const std::vector<float4>& reference, const std::vector<float4>& test) noexcept {
+	double squaredErrorSum = 0;
+	size_t outlierCount = 0;
+	ErrorStats result;
+
+	for (size_t i = 0; i < reference.size(); ++i) {
+		const float4 error = Abs(reference[i] - test[i]);
+		const float pixelError = std::max({ error.x, error.y, error.z });
+		for (float channel : { error.x, error.y, error.z }) {
+			squaredErrorSum += (double)channel * channel;
+		}
+		result.maxError = std::max(result.maxError, pixelError);
+		outlierCount += pixelError > 1.0f / 255.0f;
+	}
+
+	const double mse = squaredErrorSum / (reference.size() * 3);
+	result.psnr = mse == 0 ? std::numeric_limits<double>::infinity() : -10.0 * std::log10(mse);
+	result.outlierRatio = (double)outlierCount / reference.size();
+	return result;
+}
+
+static ErrorStats MeasureFP16Error(GlssVariant variant) {
+	constexpr uint32_t SRC_WIDTH = 256;
+	constexpr uint32_t SRC_HEIGHT = 192;
+	const std::vector<float4> src = MakeTestImage(SRC_WIDTH, SRC_HEIGHT);
+
+	std::vector<float4> fp32((size_t)SRC_WIDTH * SRC_HEIGHT * 4);
+	std::vector<float4> fp16(fp32.size());
+	if (!GlssCpu::Scale(variant, {}, src, SRC_WIDTH, SRC_HEIGHT, fp32, SRC_WIDTH * 2, SRC_HEIGHT * 2, false) ||
+		!GlssCpu::Scale(variant, {}, src, SRC_WIDTH, SRC_HEIGHT, fp16, SRC_WIDTH * 2, SRC_HEIGHT * 2, true)) {
+		return {};
+	}
+
+	const ErrorStats stats = MeasureError(fp32, fp16);
+	std::printf("PSNR %.1f dB，最大误差 %.2f/255，超过 1/255 的像素 %.3f%%\n",
+		stats.psnr, stats.maxError * 255, stats.outlierRatio * 100);
+	return stats;
+}
+
+TEST_CASE(MeasureErrorOfIdenticalImages) {
+	const std::vector<float4> image = MakeTestImage(16, 16);
+	const ErrorStats stats = MeasureError(image, image);
+	CHECK(std::isinf(stats.psnr));
+	CHECK(stats.maxError == 0.0f);
+	CHECK(stats.outlierRatio == 0.0);
+}
+
+TEST_CASE(MeasureErrorOfUniformOffset) {
+	const std::vector<float4> image = MakeTestImage(16, 16);
+	std::vector<float4> shifted = image;
+	for (float4& pixel : shifted) {
+		pixel += float4(0.01f, 0.01f, 0.01f, 0.0f);
+	}
+
+	// MSE 为 1e-4，即 40 dB
+	const ErrorStats stats = MeasureError(image, shifted);
+	CHECK_NEAR(stats.psnr, 40.0, 0.01);
+	CHECK_NEAR(stats.maxError, 0.01f, 1e-5f);
+	CHECK(stats.outlierRatio == 1.0);
+}
+
+// Bicubic - multipass.hlsl：亮度和梯度保持 FP32，只有颜色插值使用 MF
+TEST_CASE(MultipassFP16Error) {
+	const ErrorStats stats = MeasureFP16Error(GlssVariant::Full);
+	CHECK(stats.psnr > 64.0);
+	CHECK(stats.maxError < 1.0f / 255.0f);
+}
+
+TEST_CASE(LiteFP16Error) {
+	const ErrorStats stats = MeasureFP16Error(GlssVariant::Lite);
+	CHECK(stats.psnr > 57.0);
+	CHECK(stats.maxError < 2.5f / 255.0f);
+}
+
+// fast 的边缘和噪声阈值可能因舍入而翻转，这些像素的误差很大，因此不限制最大误差，只限制它们的比例
+TEST_CASE(FastFP16Error) {
+	const ErrorStats stats = MeasureFP16Error(GlssVariant::Fast);
+	CHECK(stats.psnr > 43.0);
+	CHECK(stats.outlierRatio < 0.004);
+}
@@ -0,0 +1,131 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "GlssCpu.h"
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+static std::vector<float4> Scale(
+	GlssVariant variant,
+	const std::vector<float4>& src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	uint32_t destWidth,
+	uint32_t destHeight
+) {
+	std::vector<float4> dest((size_t)destWidth * destHeight);
+	if (!GlssCpu::Scale(variant, {}, src, srcWidth, srcHeight, dest, destWidth, destHeight)) {
+		dest.clear();
+	}
+	return dest;
+}
+
+static std::vector<float4> Transpose(const std::vector<float4>& image, uint32_t width, uint32_t height) {
+	std::vector<float4> result(image.size());
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			result[(size_t)x * height + y] = image[(size_t)y * width + x];
+		}
+	}
+	return result;
+}
+
+TEST_CASE(RejectsInvalidArguments) {
+	std::vector<float4> src(16);
+	std::vector<float4> dest(64);
+	CHECK(!GlssCpu::Scale(GlssVariant::Full, {}, src, 0, 4, dest, 8, 8));
+	CHECK(!GlssCpu::Scale(GlssVariant::Full, {}, src, 4, 4, dest, 8, 0));
+	CHECK(!GlssCpu::Scale(GlssVariant::Full, {}, src, 5, 4, dest, 8, 8));
+	CHECK(!GlssCpu::Scale(GlssVariant::Full, {}, src, 4, 4, dest, 9, 8));
+}
+
+// 纯色图像没有梯度和细节，完整变体的输出和输入相同
+TEST_CASE(FlatImageIsUnchanged) {
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+	const std::vector<float4> dest = Scale(GlssVariant::Full, src, 16, 16, 40, 24);
+	REQUIRE(!dest.empty());
+	CHECK(MaxError(dest, std::vector<float4>(dest.size(), color)) < 1e-5f);
+}
+
+// 和 Bicubic.hlsl 相同，Sobel 算子的两个表相同且关于中心对称，Scharr 算子互为转置，
+// 因此转置输入的输出应是输出的转置。镜像不满足这个关系，因为 Sobel 项不随镜像变号
+TEST_CASE(FullIsTransposeSymmetric) {
+	const std::vector<float4> src = MakeTestImage(32, 24);
+
+	const std::vector<float4> dest = Scale(GlssVariant::Full, src, 32, 24, 64, 48);
+	REQUIRE(!dest.empty());
+
+	const std::vector<float4> transposed = Scale(GlssVariant::Full, Transpose(src, 32, 24), 24, 32, 48, 64);
+	REQUIRE(!transposed.empty());
+	CHECK(MaxError(transposed, Transpose(dest, 64, 48)) < 1e-4f);
+}
+
+TEST_CASE(OutputIsInRange) {
+	const std::vector<float4> src = MakeTestImage(37, 29);
+
+	for (GlssVariant variant : { GlssVariant::Full, GlssVariant::Lite, GlssVariant::Fast }) {
+		// 放大和缩小
+		for (uint32_t destWidth : { 80u, 20u }) {
+			const std::vector<float4> dest = Scale(variant, src, 37, 29, destWidth, 61);
+			REQUIRE(!dest.empty());
+
+			bool inRange = true;
+			for (const float4& pixel : dest) {
+				inRange &= pixel.x >= 0.0f && pixel.x <= 1.0f && pixel.y >= 0.0f && pixel.y <= 1.0f &&
+					pixel.z >= 0.0f && pixel.z <= 1.0f && pixel.w == 1.0f;
+			}
+			CHECK(inRange);
+		}
+	}
+}
+
+// AVX2 实现和可移植的实现只有 FMA 引入的舍入误差
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	const std::vector<float4> src = MakeTestImage(48, 32);
+	const std::vector<float4> avx2 = Scale(GlssVariant::Full, src, 48, 32, 96, 64);
+
+	CpuFeatures::SetAvx2Enabled(false);
+	const std::vector<float4> portable = Scale(GlssVariant::Full, src, 48, 32, 96, 64);
+	CpuFeatures::SetAvx2Enabled(true);
+
+	REQUIRE(!avx2.empty() && !portable.empty());
+	CHECK(MaxError(avx2, portable) < 1e-4f);
+}
+
+// Lite 和 Fast 变体的 AVX2 核和可移植的实现完全相同。输出宽度不是 8 的倍数，剩余的像素使用可移植的实现
+TEST_CASE(Avx2BatchMatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	const std::vector<float4> src = MakeTestImage(37, 29);
+	// 更强的去噪使更多像素进入去噪分支
+	GlssParameters params;
+	params.denoise = 1.0f;
+
+	for (GlssVariant variant : { GlssVariant::Lite, GlssVariant::Fast }) {
+		for (bool emulateFP16 : { false, true }) {
+			// 放大和缩小
+			for (uint32_t destWidth : { 83u, 21u }) {
+				std::vector<float4> avx2((size_t)destWidth * 61);
+				std::vector<float4> portable(avx2.size());
+				REQUIRE(GlssCpu::Scale(variant, params, src, 37, 29, avx2, destWidth, 61, emulateFP16));
+
+				CpuFeatures::SetAvx2Enabled(false);
+				const bool success = GlssCpu::Scale(variant, params, src, 37, 29, portable, destWidth, 61, emulateFP16);
+				CpuFeatures::SetAvx2Enabled(true);
+
+				REQUIRE(success);
+				CHECK(avx2 == portable);
+			}
+		}
+	}
+}
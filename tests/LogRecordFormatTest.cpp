@@ -0,0 +1,127 @@
+#include "TestHelper.h"
+#include "LogRecordFormat.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/args.h>
+
+// Logger 编码参数，LogDecoder 和 Logger 的后台线程解码并格式化，结果应和直接调用 fmt::format 相同
+
+template <typename... Args>
+static std::vector<uint8_t> Encode(const Args&... args) {
+	std::vector<uint8_t> data((LogRecordFormat::ArgSize(args) + ... + 0));
+	uint8_t* dest = data.data();
+	((dest = LogRecordFormat::WriteArg(dest, args)), ...);
+	// ArgSize 和 WriteArg 应一致
+	if (dest != data.data() + data.size()) {
+		data.clear();
+	}
+	return data;
+}
+
+// 和 LogDecoder 相同，解码失败时返回空字符串
+static std::string Decode(std::string_view format, const std::vector<uint8_t>& data, uint32_t argCount) {
+	fmt::dynamic_format_arg_store<fmt::format_context> store;
+
+	const uint8_t* cur = data.data();
+	const uint8_t* end = data.data() + data.size();
+	LogArg arg;
+	for (uint32_t i = 0; i < argCount; ++i) {
+		cur = LogRecordFormat::ReadArg(cur, end, arg);
+		if (!cur) {
+			return {};
+		}
+		LogRecordFormat::PushArg(arg, store);
+	}
+
+	if (cur != end) {
+		return {};
+	}
+
+	return fmt::vformat(format, store);
+}
+
+// formatStr 必须是字面量，以便 fmt::format 在编译时检查
+#define CHECK_ROUND_TRIP(formatStr, ...) \
+	CHECK(Decode(formatStr, Encode(__VA_ARGS__), CountArgs(__VA_ARGS__)) == fmt::format(formatStr, __VA_ARGS__))
+
+template <typename... Args>
+static uint32_t CountArgs(const Args&...) {
+	return sizeof...(Args);
+}
+
+TEST_CASE(Integers) {
+	CHECK_ROUND_TRIP("{} {} {} {}", 0, -1, INT64_MIN, UINT64_MAX);
+	CHECK_ROUND_TRIP("{} {} {}", (int8_t)-5, (uint16_t)65535, (long)123456789);
+	// 格式说明符
+	CHECK_ROUND_TRIP("0x{:X} {:08b} {:+d} {:>6}", 0xDEADBEEFu, (uint8_t)5, 42, -7);
+}
+
+TEST_CASE(FloatingPoint) {
+	// float 不应被转换为 double，否则 0.1f 将输出为 0.10000000149011612
+	CHECK_ROUND_TRIP("{} {} {} {}", 0.1f, 1.5f, 0.1, -1e300);
+	CHECK_ROUND_TRIP("{:.3f} {:e} {:g}", 3.14159f, 2.5e-8, 100000000.0);
+}
+
+TEST_CASE(BoolCharPointer) {
+	CHECK_ROUND_TRIP("{} {} {:d}", true, false, true);
+	CHECK_ROUND_TRIP("{}{}{:c}", 'a', 'Z', '!');
+
+	int value = 0;
+	CHECK_ROUND_TRIP("{} {}", (const void*)&value, (void*)nullptr);
+}
+
+TEST_CASE(Strings) {
+	const std::string str = "缓存 cache";
+	const std::string_view view = "视图";
+	const char* cstr = "C 字符串";
+	CHECK_ROUND_TRIP("已读取缓存 {} {} {} {}", str, view, cstr, "字面量");
+	CHECK_ROUND_TRIP("[{:>12}] [{:<4}] [{}]", std::string("右对齐"), "ab", std::string());
+}
+
+// 宽字符串原样复制，解码时才转换为 UTF-8
+TEST_CASE(WideStrings) {
+	const std::u16string wstr = u"已读取缓存 C:\\效果\\Anime4K.hlsl";
+	const std::vector<uint8_t> data = Encode(wstr);
+	REQUIRE(!data.empty());
+	CHECK(data[0] == (uint8_t)LogArgType::WString);
+	CHECK(data.size() == 1 + sizeof(uint32_t) + wstr.size() * 2);
+
+	CHECK(Decode("{}", data, 1) == "已读取缓存 C:\\效果\\Anime4K.hlsl");
+
+	// 前面的参数使宽字符串没有对齐，代理对转换为 4 字节的 UTF-8
+	CHECK(Decode("{} {} [{:>6}]", Encode(true, u"😀 emoji", std::u16string_view(u"宽")), 3) ==
+		"true 😀 emoji [    宽]");
+
+	// 孤立的代理项替换为 U+FFFD
+	const char16_t lone[] = { u'a', (char16_t)0xD800, u'b', 0 };
+	CHECK(Decode("{}", Encode(lone), 1) == "a\uFFFDb");
+
+	CHECK(Decode("[{}]", Encode(std::u16string()), 1) == "[]");
+}
+
+TEST_CASE(RejectsTruncatedArgs) {
+	const std::vector<uint8_t> data = Encode(42, std::string("abc"), u"宽字符串");
+
+	// 录制被中断时最后一个参数可能不完整
+	for (size_t size = 0; size < data.size(); ++size) {
+		const std::vector<uint8_t> truncated(data.begin(), data.begin() + size);
+		CHECK(Decode("{} {} {}", truncated, 3).empty());
+	}
+	CHECK(Decode("{} {} {}", data, 3) == "42 abc 宽字符串");
+
+	// 读取不完整的字符串不应越界
+	for (const std::vector<uint8_t>& arg : { Encode(std::string("abc")), Encode(u"宽字符串") }) {
+		LogArg result;
+		for (size_t size = 0; size < arg.size(); ++size) {
+			CHECK(!LogRecordFormat::ReadArg(arg.data(), arg.data() + size, result));
+		}
+	}
+
+	// 未知的类型
+	std::vector<uint8_t> unknown = data;
+	unknown[0] = 0xFF;
+	CHECK(Decode("{} {} {}", unknown, 3).empty());
+}
@@ -0,0 +1,159 @@
+#include "TestHelper.h"
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// MappedFile 的 POSIX 实现
+
+using namespace Magpie;
+
+namespace {
+
+// 在临时文件夹中创建文件，析构时删除
+class TempFile {
+public:
+	explicit TempFile(const std::vector<uint8_t>& content) {
+		static uint32_t count = 0;
+		_path = std::filesystem::temp_directory_path() /
+			("MappedFileTest-" + std::to_string(getpid()) + "-" + std::to_string(count++));
+
+		std::ofstream file(_path, std::ios::binary);
+		file.write((const char*)content.data(), content.size());
+	}
+
+	TempFile(const TempFile&) = delete;
+
+	~TempFile() {
+		std::error_code ec;
+		std::filesystem::remove(_path, ec);
+	}
+
+	const char* Path() const noexcept {
+		return _path.c_str();
+	}
+
+private:
+	std::filesystem::path _path;
+};
+
+}
+
+static std::vector<uint8_t> MakeContent(size_t size) {
+	std::vector<uint8_t> result(size);
+	uint32_t state = 12345;
+	for (uint8_t& b : result) {
+		state = state * 1664525 + 1013904223;
+		b = uint8_t(state >> 24);
+	}
+	return result;
+}
+
+static bool HasContent(const MappedFile& file, const std::vector<uint8_t>& content) {
+	return file.Size() == content.size() &&
+		std::vector<uint8_t>(file.Data().begin(), file.Data().end()) == content;
+}
+
+TEST_CASE(MissingFileFails) {
+	MappedFile file;
+	errno = 0;
+	CHECK(!file.Open("/nonexistent/MappedFileTest"));
+	CHECK(errno == ENOENT);
+	CHECK(file.Size() == 0);
+	CHECK(file.Data().empty());
+}
+
+// 无法映射空文件，但打开应成功
+TEST_CASE(EmptyFile) {
+	TempFile tempFile({});
+
+	MappedFile file;
+	REQUIRE(file.Open(tempFile.Path()));
+	CHECK(file.Size() == 0);
+	CHECK(file.Data().data() == nullptr);
+	CHECK(file.Text().empty());
+
+	// 没有映射时 Advise 和 Close 什么也不做
+	file.Advise(MappedFileHint::WillNeed);
+	file.Close();
+	CHECK(file.Size() == 0);
+}
+
+TEST_CASE(RoundTrip) {
+	// 不足一页、恰好一页和跨越多页
+	for (size_t size : { (size_t)1, (size_t)4096, (size_t)1000003 }) {
+		const std::vector<uint8_t> content = MakeContent(size);
+		TempFile tempFile(content);
+
+		MappedFile file;
+		REQUIRE(file.Open(tempFile.Path()));
+		CHECK(HasContent(file, content));
+		CHECK(file.Text() == std::string_view((const char*)content.data(), content.size()));
+	}
+}
+
+TEST_CASE(AdviseKeepsContent) {
+	const std::vector<uint8_t> content = MakeContent(100000);
+	TempFile tempFile(content);
+
+	for (MappedFileHint hint : { MappedFileHint::Normal, MappedFileHint::Sequential, MappedFileHint::WillNeed }) {
+		MappedFile file;
+		REQUIRE(file.Open(tempFile.Path(), hint));
+		CHECK(HasContent(file, content));
+
+		// 映射后可以随时更改
+		for (MappedFileHint newHint : { MappedFileHint::WillNeed, MappedFileHint::Normal, MappedFileHint::Sequential }) {
+			file.Advise(newHint);
+			CHECK(HasContent(file, content));
+		}
+	}
+}
+
+TEST_CASE(MoveTransfersMapping) {
+	const std::vector<uint8_t> content1 = MakeContent(5000);
+	const std::vector<uint8_t> content2(300, 'x');
+	TempFile tempFile1(content1);
+	TempFile tempFile2(content2);
+
+	MappedFile file1;
+	REQUIRE(file1.Open(tempFile1.Path()));
+	const uint8_t* data = file1.Data().data();
+
+	// 移动构造不重新映射
+	MappedFile file2(std::move(file1));
+	CHECK(file1.Size() == 0 && file1.Data().data() == nullptr);
+	CHECK(file2.Data().data() == data);
+	CHECK(HasContent(file2, content1));
+
+	// 移动赋值先释放原有的映射
+	MappedFile file3;
+	REQUIRE(file3.Open(tempFile2.Path()));
+	file3 = std::move(file2);
+	CHECK(file2.Size() == 0 && file2.Data().data() == nullptr);
+	CHECK(HasContent(file3, content1));
+
+	// 自赋值不释放映射
+	MappedFile& self = file3;
+	file3 = std::move(self);
+	CHECK(HasContent(file3, content1));
+
+	// 再次打开时替换原有的映射
+	REQUIRE(file3.Open(tempFile2.Path()));
+	CHECK(HasContent(file3, content2));
+}
+
+// 映射会保持文件打开，删除文件后内容仍然可用
+TEST_CASE(OutlivesFile) {
+	const std::vector<uint8_t> content = MakeContent(20000);
+
+	MappedFile file;
+	{
+		TempFile tempFile(content);
+		REQUIRE(file.Open(tempFile.Path()));
+	}
+	CHECK(HasContent(file, content));
+}
@@ -0,0 +1,59 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "MmpxCpu.h"
+#include <algorithm>
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+TEST_CASE(RejectsInvalidArguments) {
+	std::vector<float4> src(16);
+	std::vector<float4> dest(64);
+	CHECK(!MmpxCpu::Scale(src, 0, 4, dest));
+	CHECK(!MmpxCpu::Scale(src, 5, 4, dest));
+	CHECK(!MmpxCpu::Scale(src, 4, 4, std::span(dest).first(63)));
+}
+
+// 纯色图像的每个像素都被复制为 2x2 个像素
+TEST_CASE(FlatImageIsUnchanged) {
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+
+	std::vector<float4> dest(src.size() * 4);
+	REQUIRE(MmpxCpu::Scale(src, 16, 16, dest));
+	CHECK(dest == std::vector<float4>(dest.size(), color));
+}
+
+// MMPX 只复制源像素，不产生新的颜色
+TEST_CASE(OutputUsesSourceColors) {
+	const std::vector<float4> src = MakePixelArtImage(37, 29);
+	std::vector<float4> dest(src.size() * 4);
+	REQUIRE(MmpxCpu::Scale(src, 37, 29, dest));
+
+	bool allFromSource = true;
+	for (const float4& pixel : dest) {
+		allFromSource &= std::find(src.begin(), src.end(), pixel) != src.end();
+	}
+	CHECK(allFromSource);
+}
+
+// 宽度不是 8 的倍数，覆盖每行末尾的可移植路径
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	for (uint32_t seed : { 1u, 2u, 3u }) {
+		const std::vector<float4> src = MakePixelArtImage(77, 61, seed);
+		std::vector<float4> portable(src.size() * 4);
+		std::vector<float4> avx2(portable.size());
+
+		CpuFeatures::SetAvx2Enabled(false);
+		REQUIRE(MmpxCpu::Scale(src, 77, 61, portable));
+		CpuFeatures::SetAvx2Enabled(true);
+		REQUIRE(MmpxCpu::Scale(src, 77, 61, avx2));
+		CHECK(portable == avx2);
+	}
+}
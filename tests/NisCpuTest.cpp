@@ -0,0 +1,83 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "NisCpu.h"
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+// 系数表位于 src/Effects/NIS，由 CMakeLists.txt 定义 MAGPIE_EFFECTS_DIR
+static bool InitializeNis(NisCpu& nis) {
+	const std::filesystem::path nisDir = std::filesystem::path(MAGPIE_EFFECTS_DIR) / "NIS";
+	return nis.Initialize(nisDir / "Coef_Scale.dds", nisDir / "Coef_USM.dds");
+}
+
+TEST_CASE(RejectsInvalidArguments) {
+	NisCpu nis;
+	std::vector<float4> src(16);
+	std::vector<float4> dest(64);
+	// 未初始化
+	CHECK(!nis.Scale(src, 4, 4, dest, 8, 8));
+	CHECK(!nis.Initialize("不存在.dds", "不存在.dds"));
+
+	REQUIRE(InitializeNis(nis));
+	CHECK(!nis.Scale(src, 0, 4, dest, 8, 8));
+	CHECK(!nis.Scale(src, 5, 4, dest, 8, 8));
+	CHECK(!nis.Scale(src, 4, 4, dest, 9, 8));
+	CHECK(!NisCpu::Sharpen(src, 5, 4, dest));
+}
+
+// 纯色图像没有边缘，锐化的结果为 0
+TEST_CASE(FlatImageIsUnchanged) {
+	NisCpu nis;
+	REQUIRE(InitializeNis(nis));
+
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+
+	std::vector<float4> dest(37 * 23);
+	REQUIRE(nis.Scale(src, 16, 16, dest, 37, 23));
+	CHECK(MaxError(dest, std::vector<float4>(dest.size(), color)) < 1e-3f);
+
+	dest.resize(src.size());
+	REQUIRE(NisCpu::Sharpen(src, 16, 16, dest));
+	CHECK(MaxError(dest, src) < 1e-6f);
+}
+
+// AVX2 核不使用 FMA，结果必须和可移植的实现完全相同。宽度不是 8 的倍数，覆盖每行末尾的可移植路径
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	NisCpu nis;
+	REQUIRE(InitializeNis(nis));
+
+	const std::vector<float4> src = MakeTestImage(37, 29);
+	const std::pair<uint32_t, uint32_t> destSizes[] = { { 74, 58 }, { 91, 43 }, { 23, 17 } };
+
+	for (auto [destWidth, destHeight] : destSizes) {
+		for (float sharpness : { 0.0f, 0.5f, 1.0f }) {
+			std::vector<float4> portable((size_t)destWidth * destHeight);
+			std::vector<float4> avx2(portable.size());
+
+			CpuFeatures::SetAvx2Enabled(false);
+			REQUIRE(nis.Scale(src, 37, 29, portable, destWidth, destHeight, sharpness));
+			CpuFeatures::SetAvx2Enabled(true);
+			REQUIRE(nis.Scale(src, 37, 29, avx2, destWidth, destHeight, sharpness));
+			CHECK(portable == avx2);
+		}
+	}
+
+	for (float sharpness : { 0.0f, 0.5f, 1.0f }) {
+		std::vector<float4> portable(src.size());
+		std::vector<float4> avx2(src.size());
+
+		CpuFeatures::SetAvx2Enabled(false);
+		REQUIRE(NisCpu::Sharpen(src, 37, 29, portable, sharpness));
+		CpuFeatures::SetAvx2Enabled(true);
+		REQUIRE(NisCpu::Sharpen(src, 37, 29, avx2, sharpness));
+		CHECK(portable == avx2);
+	}
+}
@@ -0,0 +1,418 @@
+#include "TestHelper.h"
+#include "PngEncoder.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <zlib.h>
+#ifdef MAGPIE_TEST_LIBPNG
+#include <png.h>
+#endif
+
+// PngEncoder 的输出由独立的解码器解码，像素应和输入相同。不同的条带数只影响压缩结果，不影响像素
+
+using namespace Magpie;
+
+namespace {
+
+struct DecodedPng {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// 紧密排列的 8 位 RGBA
+	std::vector<uint8_t> pixels;
+	uint32_t idatCount = 0;
+	// 每行使用的过滤器
+	std::vector<uint8_t> filters;
+};
+
+}
+
+static uint32_t LoadBE(const uint8_t* data) {
+	return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+}
+
+static uint8_t Paeth(int a, int b, int c) {
+	const int p = a + b - c;
+	const int pa = std::abs(p - a);
+	const int pb = std::abs(p - b);
+	const int pc = std::abs(p - c);
+	return uint8_t(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+// 用 zlib 解码，只支持 8 位 RGBA、非隔行扫描的图像。检查每个块的 CRC 以及 zlib 流的校验和，
+// 任何错误都返回 false
+static bool DecodeWithZlib(const std::vector<uint8_t>& png, DecodedPng& result) {
+	static constexpr uint8_t SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	if (png.size() < sizeof(SIGNATURE) || std::memcmp(png.data(), SIGNATURE, sizeof(SIGNATURE)) != 0) {
+		return false;
+	}
+
+	std::vector<uint8_t> idat;
+	bool hasIHDR = false;
+	bool hasIEND = false;
+	size_t pos = sizeof(SIGNATURE);
+	while (!hasIEND) {
+		if (png.size() - pos < 12) {
+			return false;
+		}
+
+		const uint32_t length = LoadBE(&png[pos]);
+		if (png.size() - pos - 12 < length) {
+			return false;
+		}
+
+		const uint8_t* type = &png[pos + 4];
+		const uint8_t* data = &png[pos + 8];
+		const uLong crc = crc32(0, type, 4 + length);
+		if (crc != LoadBE(data + length)) {
+			return false;
+		}
+
+		if (std::memcmp(type, "IHDR", 4) == 0) {
+			// 8 位 RGBA，压缩方法、过滤方法和隔行扫描方法都为 0
+			static constexpr uint8_t FORMAT[] = { 8, 6, 0, 0, 0 };
+			if (length != 13 || std::memcmp(data + 8, FORMAT, sizeof(FORMAT)) != 0) {
+				return false;
+			}
+			result.width = LoadBE(data);
+			result.height = LoadBE(data + 4);
+			hasIHDR = true;
+		} else if (std::memcmp(type, "IDAT", 4) == 0) {
+			idat.insert(idat.end(), data, data + length);
+			++result.idatCount;
+		} else if (std::memcmp(type, "IEND", 4) == 0) {
+			hasIEND = true;
+		}
+
+		pos += 12 + length;
+	}
+
+	if (!hasIHDR || pos != png.size()) {
+		return false;
+	}
+
+	const size_t rowSize = (size_t)result.width * 4;
+	std::vector<uint8_t> filtered((rowSize + 1) * result.height);
+	uLongf filteredSize = (uLongf)filtered.size();
+	if (uncompress(filtered.data(), &filteredSize, idat.data(), (uLong)idat.size()) != Z_OK ||
+		filteredSize != filtered.size()) {
+		return false;
+	}
+
+	result.pixels.assign(rowSize * result.height, 0);
+	result.filters.resize(result.height);
+	const std::vector<uint8_t> zeroRow(rowSize);
+	for (uint32_t y = 0; y < result.height; ++y) {
+		const uint8_t filter = filtered[y * (rowSize + 1)];
+		const uint8_t* src = &filtered[y * (rowSize + 1) + 1];
+		uint8_t* cur = &result.pixels[y * rowSize];
+		const uint8_t* prev = y == 0 ? zeroRow.data() : cur - rowSize;
+		result.filters[y] = filter;
+
+		for (size_t i = 0; i < rowSize; ++i) {
+			const uint8_t a = i >= 4 ? cur[i - 4] : 0;
+			const uint8_t b = prev[i];
+			const uint8_t c = i >= 4 ? prev[i - 4] : 0;
+			switch (filter) {
+			case 0: cur[i] = src[i]; break;
+			case 1: cur[i] = uint8_t(src[i] + a); break;
+			case 2: cur[i] = uint8_t(src[i] + b); break;
+			case 3: cur[i] = uint8_t(src[i] + ((a + b) >> 1)); break;
+			case 4: cur[i] = uint8_t(src[i] + Paeth(a, b, c)); break;
+			default: return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+#ifdef MAGPIE_TEST_LIBPNG
+static bool DecodeWithLibpng(const std::vector<uint8_t>& png, std::vector<uint8_t>& pixels) {
+	png_image image{};
+	image.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_memory(&image, png.data(), png.size())) {
+		return false;
+	}
+
+	image.format = PNG_FORMAT_RGBA;
+	pixels.resize(PNG_IMAGE_SIZE(image));
+	if (!png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr)) {
+		png_image_free(&image);
+		return false;
+	}
+	return true;
+}
+#endif
+
+// 编码后解码，检查尺寸和像素
+static bool RoundTrip(
+	uint32_t width,
+	uint32_t height,
+	DXGI_FORMAT format,
+	const std::vector<uint8_t>& pixelData,
+	uint32_t rowPitch,
+	const std::vector<uint8_t>& expected,
+	uint32_t stripeCount,
+	DecodedPng& decoded
+) {
+	std::vector<uint8_t> png;
+	if (!PngEncoder::Encode(width, height, format, pixelData, rowPitch, png, stripeCount)) {
+		return false;
+	}
+
+	if (!DecodeWithZlib(png, decoded) || decoded.width != width || decoded.height != height ||
+		decoded.pixels != expected) {
+		return false;
+	}
+
+#ifdef MAGPIE_TEST_LIBPNG
+	std::vector<uint8_t> libpngPixels;
+	if (!DecodeWithLibpng(png, libpngPixels) || libpngPixels != expected) {
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+// 渐变、噪声和纯色区域，使每种过滤器都有机会被选中
+static std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height, uint32_t rowPitch) {
+	std::mt19937 rng(42);
+	std::vector<uint8_t> image((size_t)rowPitch * height, 0xCD);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			uint8_t* pixel = &image[(size_t)y * rowPitch + x * 4];
+			if (y < height / 3) {
+				pixel[0] = uint8_t(x);
+				pixel[1] = uint8_t(y * 2);
+				pixel[2] = uint8_t(x + y);
+				pixel[3] = 255;
+			} else if (y < height * 2 / 3) {
+				for (uint32_t c = 0; c < 4; ++c) {
+					pixel[c] = uint8_t(rng());
+				}
+			} else {
+				pixel[0] = x < width / 2 ? 30 : 200;
+				pixel[1] = 60;
+				pixel[2] = uint8_t(x / 8 * 8);
+				pixel[3] = uint8_t(128 + (x + y) % 3);
+			}
+		}
+	}
+	return image;
+}
+
+// 去掉每行末尾的填充
+static std::vector<uint8_t> RemovePadding(const std::vector<uint8_t>& image, uint32_t width, uint32_t height, uint32_t rowPitch) {
+	std::vector<uint8_t> result((size_t)width * height * 4);
+	for (uint32_t y = 0; y < height; ++y) {
+		std::memcpy(&result[(size_t)y * width * 4], &image[(size_t)y * rowPitch], (size_t)width * 4);
+	}
+	return result;
+}
+
+// 每个条带的数据超过 32K，使字典被截断
+TEST_CASE(RoundTripRGBA8) {
+	static constexpr uint32_t WIDTH = 300;
+	static constexpr uint32_t HEIGHT = 200;
+	// 行间有填充，和映射的暂存纹理相同
+	static constexpr uint32_t ROW_PITCH = 1280;
+	const std::vector<uint8_t> image = MakeImage(WIDTH, HEIGHT, ROW_PITCH);
+	const std::vector<uint8_t> expected = RemovePadding(image, WIDTH, HEIGHT, ROW_PITCH);
+
+	for (uint32_t stripeCount : { 0u, 1u, 2u, 3u, 7u, 64u }) {
+		DecodedPng decoded;
+		CHECK(RoundTrip(WIDTH, HEIGHT, DXGI_FORMAT_R8G8B8A8_UNORM, image, ROW_PITCH, expected, stripeCount, decoded));
+		if (stripeCount > 1) {
+			CHECK(decoded.idatCount == stripeCount);
+		}
+	}
+
+	// 有规律的区域和噪声使用不同的过滤器
+	DecodedPng decoded;
+	REQUIRE(RoundTrip(WIDTH, HEIGHT, DXGI_FORMAT_R8G8B8A8_UNORM, image, ROW_PITCH, expected, 1, decoded));
+	uint32_t usedFilters = 0;
+	for (uint8_t filter : decoded.filters) {
+		usedFilters |= 1u << filter;
+	}
+	CHECK(usedFilters != 1 && (usedFilters & (usedFilters - 1)) != 0);
+}
+
+// 每个条带使用之前的数据作为字典，分割条带几乎不影响压缩率。行以 37 为周期重复，
+// 没有字典时每个条带开头的行无法引用之前的数据
+TEST_CASE(StripesKeepCompressionRatio) {
+	static constexpr uint32_t WIDTH = 256;
+	static constexpr uint32_t HEIGHT = 512;
+	std::vector<uint8_t> image((size_t)WIDTH * HEIGHT * 4);
+	for (uint32_t y = 0; y < HEIGHT; ++y) {
+		for (uint32_t x = 0; x < WIDTH * 4; ++x) {
+			image[(size_t)y * WIDTH * 4 + x] = uint8_t((x * 7 + (y % 37) * 13) ^ (x >> 3));
+		}
+	}
+
+	std::vector<uint8_t> single;
+	std::vector<uint8_t> striped;
+	REQUIRE(PngEncoder::Encode(WIDTH, HEIGHT, DXGI_FORMAT_R8G8B8A8_UNORM, image, WIDTH * 4, single, 1));
+	REQUIRE(PngEncoder::Encode(WIDTH, HEIGHT, DXGI_FORMAT_R8G8B8A8_UNORM, image, WIDTH * 4, striped, 8));
+	CHECK(striped.size() < single.size() * 101 / 100);
+}
+
+// 需要转换格式时每个条带也转换前一行
+TEST_CASE(RoundTripFloat) {
+	static constexpr uint32_t WIDTH = 100;
+	static constexpr uint32_t HEIGHT = 90;
+	const std::vector<uint8_t> expected = MakeImage(WIDTH, HEIGHT, WIDTH * 4);
+
+	std::vector<uint8_t> image(expected.size() * 4);
+	for (size_t i = 0; i < expected.size(); ++i) {
+		const float value = expected[i] / 255.0f;
+		std::memcpy(&image[i * 4], &value, 4);
+	}
+
+	for (uint32_t stripeCount : { 1u, 4u, 9u }) {
+		DecodedPng decoded;
+		CHECK(RoundTrip(WIDTH, HEIGHT, DXGI_FORMAT_R32G32B32A32_FLOAT, image, WIDTH * 16, expected, stripeCount, decoded));
+	}
+}
+
+// 条带数多于行数时多余的条带为空，最后一个条带仍然结束 deflate 流
+TEST_CASE(MoreStripesThanRows) {
+	const std::vector<uint8_t> image = MakeImage(5, 5, 20);
+	DecodedPng decoded;
+	CHECK(RoundTrip(5, 5, DXGI_FORMAT_R8G8B8A8_UNORM, image, 20, image, 8, decoded));
+	CHECK(RoundTrip(5, 5, DXGI_FORMAT_R8G8B8A8_UNORM, image, 20, image, 4, decoded));
+
+	const std::vector<uint8_t> pixel = { 1, 2, 3, 4 };
+	CHECK(RoundTrip(1, 1, DXGI_FORMAT_R8G8B8A8_UNORM, pixel, 4, pixel, 0, decoded));
+}
+
+template <typename T>
+static void Append(std::vector<uint8_t>& data, T value) {
+	const size_t pos = data.size();
+	data.resize(pos + sizeof(T));
+	std::memcpy(&data[pos], &value, sizeof(T));
+}
+
+// 每种格式的几个像素，缺少的颜色通道为 0，缺少的 Alpha 通道为 255，超出范围的值被截断
+TEST_CASE(ConvertFormats) {
+	struct FormatCase {
+		DXGI_FORMAT format;
+		std::vector<uint8_t> data;
+		std::vector<uint8_t> expected;
+	};
+	std::vector<FormatCase> cases;
+
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R32G32B32A32_FLOAT, {}, {} });
+		for (float value : { 0.0f, 1.0f, 0.5f, 2.0f, -1.0f, NAN, 0.25f, 1.0f }) {
+			Append(c.data, value);
+		}
+		c.expected = { 0, 255, 128, 255, 0, 0, 64, 255 };
+	}
+	{
+		// 1.0、0.5、-1.0、正无穷，NaN、最小的非规格化数、0.25、1.0
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R16G16B16A16_FLOAT, {}, {} });
+		for (uint16_t value : { 0x3C00, 0x3800, 0xBC00, 0x7C00, 0x7E00, 0x0001, 0x3400, 0x3C00 }) {
+			Append(c.data, value);
+		}
+		c.expected = { 255, 128, 0, 255, 0, 0, 64, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R16G16_FLOAT, {}, {} });
+		for (uint16_t value : { 0x3C00, 0x3800 }) {
+			Append(c.data, value);
+		}
+		c.expected = { 255, 128, 0, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R16G16B16A16_UNORM, {}, {} });
+		for (uint16_t value : { 0, 65535, 32768, 257 }) {
+			Append(c.data, value);
+		}
+		c.expected = { 0, 255, 128, 1 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R16G16_SNORM, {}, {} });
+		for (int16_t value : { 32767, -32767 }) {
+			Append(c.data, value);
+		}
+		c.expected = { 255, 0, 0, 255 };
+	}
+	{
+		// R 和 A 的最大值，G 为 512，B 为 0
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R10G10B10A2_UNORM, {}, {} });
+		Append(c.data, uint32_t(0x3FF | (512 << 10) | (3u << 30)));
+		Append(c.data, uint32_t(1u << 30));
+		c.expected = { 255, 128, 0, 255, 0, 0, 0, 85 };
+	}
+	{
+		// R 为 1.0，G 为 0.5，B 为 0.25；之后 R 为无穷大，G 为 0，B 超过 1
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R11G11B10_FLOAT, {}, {} });
+		Append(c.data, uint32_t((15u << 6) | ((14u << 6) << 11) | ((13u << 5) << 22)));
+		Append(c.data, uint32_t((31u << 6) | ((16u << 5) << 22)));
+		// B 为 0.75
+		Append(c.data, uint32_t(((14u << 5) | 16u) << 22));
+		c.expected = { 255, 128, 64, 255, 255, 0, 255, 255, 0, 0, 191, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R8G8B8A8_SNORM, {}, {} });
+		for (int8_t value : { 127, -128, 64, 0 }) {
+			Append(c.data, value);
+		}
+		c.expected = { 255, 0, 129, 0 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R32G32_FLOAT, {}, {} });
+		Append(c.data, 0.5f);
+		Append(c.data, 1.0f);
+		c.expected = { 128, 255, 0, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R32_FLOAT, {}, {} });
+		Append(c.data, 0.2f);
+		c.expected = { 51, 0, 0, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R8G8_UNORM, {}, {} });
+		c.data = { 10, 20 };
+		c.expected = { 10, 20, 0, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R8_SNORM, {}, {} });
+		c.data = { 127 };
+		c.expected = { 255, 0, 0, 255 };
+	}
+	{
+		FormatCase& c = cases.emplace_back(FormatCase{ DXGI_FORMAT_R16_UNORM, {}, {} });
+		Append(c.data, uint16_t(65535));
+		c.expected = { 255, 0, 0, 255 };
+	}
+
+	for (const FormatCase& c : cases) {
+		const uint32_t width = uint32_t(c.expected.size() / 4);
+		std::vector<uint8_t> converted(c.expected.size());
+		PngEncoder::ConvertRow(c.format, c.data.data(), converted.data(), width);
+		CHECK(converted == c.expected);
+
+		// 两行相同的像素，第二行分到另一个条带，需要转换前一行
+		std::vector<uint8_t> image = c.data;
+		image.insert(image.end(), c.data.begin(), c.data.end());
+		std::vector<uint8_t> expected = c.expected;
+		expected.insert(expected.end(), c.expected.begin(), c.expected.end());
+
+		DecodedPng decoded;
+		CHECK(RoundTrip(width, 2, c.format, image, (uint32_t)c.data.size(), expected, 2, decoded));
+	}
+}
+
+TEST_CASE(RejectsInvalidInput) {
+	const std::vector<uint8_t> image(64);
+	std::vector<uint8_t> png;
+	CHECK(!PngEncoder::Encode(0, 4, DXGI_FORMAT_R8G8B8A8_UNORM, image, 16, png));
+	CHECK(!PngEncoder::Encode(4, 0, DXGI_FORMAT_R8G8B8A8_UNORM, image, 16, png));
+	CHECK(!PngEncoder::Encode(4, 4, DXGI_FORMAT_BC1_UNORM, image, 16, png));
+	CHECK(!PngEncoder::Encode(4, 4, DXGI_FORMAT_UNKNOWN, image, 16, png));
+	CHECK(!PngEncoder::IsFormatSupported(DXGI_FORMAT_R32G32B32_FLOAT));
+}
@@ -0,0 +1,282 @@
+#include "TestHelper.h"
+#include "QualityController.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// QualityController 的降档、升档和防抖，由模拟的时钟和渲染时间驱动
+
+using namespace Magpie;
+using namespace std::chrono;
+
+// 60 FPS，降档阈值约 13.3 毫秒，升档阈值 10 毫秒
+static constexpr nanoseconds FRAME_BUDGET(16'666'667);
+
+namespace {
+
+struct Switch {
+	nanoseconds time;
+	uint32_t effectIdx;
+	uint32_t tier;
+	bool succeeded;
+};
+
+class Simulation {
+public:
+	// costs[i][t] 为效果 i 第 t 档的渲染时间（毫秒），档位数由它决定
+	explicit Simulation(std::vector<std::vector<float>> costs_) : costs(std::move(costs_)) {
+		std::vector<uint32_t> tierCounts;
+		for (const std::vector<float>& tierCosts : costs) {
+			tierCounts.push_back((uint32_t)tierCosts.size());
+		}
+		controller.Initialize(FRAME_BUDGET, tierCounts);
+	}
+
+	// 每帧渲染一次直到 end，请求切换时立即切换
+	void RunUntil(nanoseconds end) {
+		std::vector<float> timings(costs.size());
+
+		for (; now < end; now += FRAME_BUDGET) {
+			for (uint32_t i = 0; i < (uint32_t)costs.size(); ++i) {
+				timings[i] = costs[i][controller.GetTier(i)];
+			}
+
+			uint32_t effectIdx = 0;
+			uint32_t tier = 0;
+			if (!controller.Update(now, timings, effectIdx, tier)) {
+				continue;
+			}
+
+			const bool succeeded = canSwitch(effectIdx, tier);
+			controller.OnTierSwitched(now, effectIdx, tier, succeeded);
+			switches.push_back({ now, effectIdx, tier, succeeded });
+
+			if (onSwitched) {
+				onSwitched(switches.back());
+			}
+		}
+	}
+
+	QualityController controller;
+	std::vector<std::vector<float>> costs;
+	std::function<bool(uint32_t, uint32_t)> canSwitch = [](uint32_t, uint32_t) { return true; };
+	std::function<void(const Switch&)> onSwitched;
+	std::vector<Switch> switches;
+	nanoseconds now{};
+};
+
+}
+
+TEST_CASE(GetLowerTiers) {
+	std::span<const std::string_view> tiers = QualityController::GetLowerTiers("Glss\\Bicubic - multipass");
+	REQUIRE(tiers.size() == 2);
+	CHECK(tiers[0] == "Glss\\Bicubic - lite");
+	CHECK(tiers[1] == "Glss\\Bicubic - fast");
+
+	CHECK(QualityController::GetLowerTiers("RAVU\\RAVU_R3").size() == 1);
+	// 最低档位和不属于任何系列的效果
+	CHECK(QualityController::GetLowerTiers("RAVU\\RAVU_R2").empty());
+	CHECK(QualityController::GetLowerTiers("Bicubic").empty());
+}
+
+TEST_CASE(DisabledWithoutTiers) {
+	QualityController controller;
+	CHECK(!controller.IsEnabled());
+
+	uint32_t effectIdx;
+	uint32_t tier;
+	const float timings[] = { 100.0f };
+	CHECK(!controller.Update(seconds(10), timings, effectIdx, tier));
+}
+
+// 持续超出预算 DOWNGRADE_DELAY 后才降档，降档后在滞回区间内保持不变
+TEST_CASE(DowngradeAfterDelay) {
+	Simulation sim({ { 15.0f, 8.0f, 4.0f } });
+	sim.RunUntil(seconds(30));
+
+	REQUIRE(sim.switches.size() == 1);
+	const Switch& s = sim.switches[0];
+	CHECK(s.effectIdx == 0 && s.tier == 1 && s.succeeded);
+	CHECK(s.time >= QualityController::DOWNGRADE_DELAY);
+	CHECK(s.time < QualityController::DOWNGRADE_DELAY + FRAME_BUDGET * 2);
+	CHECK(sim.controller.GetTier(0) == 1);
+}
+
+// 偶尔的卡顿不应导致降档
+TEST_CASE(IgnoresBriefSpikes) {
+	Simulation sim({ { 12.0f, 4.0f } });
+
+	for (uint32_t i = 0; i < 10; ++i) {
+		sim.costs[0][0] = 12.0f;
+		sim.RunUntil(seconds(2) * i + milliseconds(1850));
+		sim.costs[0][0] = 20.0f;
+		sim.RunUntil(seconds(2) * (i + 1));
+	}
+
+	CHECK(sim.switches.empty());
+
+	// 持续更久则降档
+	sim.RunUntil(sim.now + seconds(1));
+	CHECK(sim.switches.size() == 1);
+}
+
+// 渲染时间在升档和降档阈值之间时不切换
+TEST_CASE(HysteresisBand) {
+	Simulation sim({ { 12.0f, 6.0f } });
+	sim.RunUntil(seconds(60));
+	CHECK(sim.switches.empty());
+
+	// 降档后 6 毫秒低于升档阈值，但已知第 0 档需要 12 毫秒，升档后会超出升档阈值
+	sim.costs[0][0] = 14.0f;
+	sim.RunUntil(seconds(120));
+	REQUIRE(sim.switches.size() == 1);
+	CHECK(sim.switches[0].tier == 1);
+}
+
+// 切换后等待 SETTLE_TIME，之后重新计算持续超出预算的时间
+TEST_CASE(SettleTime) {
+	Simulation sim({ { 20.0f, 15.0f, 4.0f } });
+	sim.RunUntil(seconds(10));
+
+	REQUIRE(sim.switches.size() == 2);
+	CHECK(sim.switches[1].tier == 2);
+
+	const nanoseconds gap = sim.switches[1].time - sim.switches[0].time;
+	CHECK(gap >= QualityController::SETTLE_TIME + QualityController::DOWNGRADE_DELAY);
+	CHECK(gap < QualityController::SETTLE_TIME + QualityController::DOWNGRADE_DELAY + FRAME_BUDGET * 2);
+}
+
+// 其他效果变快后有了余量，持续 UPGRADE_DELAY 后升档
+TEST_CASE(UpgradeWithHeadroom) {
+	// 效果 1 不支持切换
+	Simulation sim({ { 8.0f, 4.0f }, { 8.0f } });
+	sim.RunUntil(seconds(5));
+
+	REQUIRE(sim.switches.size() == 1);
+	CHECK(sim.switches[0].effectIdx == 0 && sim.switches[0].tier == 1);
+
+	// 4 + 8 处于滞回区间
+	sim.costs[1][0] = 1.0f;
+	sim.RunUntil(seconds(20));
+
+	REQUIRE(sim.switches.size() == 2);
+	const Switch& s = sim.switches[1];
+	CHECK(s.effectIdx == 0 && s.tier == 0 && s.succeeded);
+	CHECK(s.time >= seconds(5) + QualityController::UPGRADE_DELAY);
+	CHECK(s.time < seconds(5) + QualityController::UPGRADE_DELAY + milliseconds(100));
+	CHECK(sim.controller.GetUpgradeBackoff(0) == 1);
+}
+
+// 预计升档后超出升档阈值时不升档。第 0 档的渲染时间未知时假设为当前档位的两倍
+TEST_CASE(UpgradeNeedsPrediction) {
+	Simulation sim({ { 8.0f, 4.0f }, { 8.0f } });
+	sim.RunUntil(seconds(5));
+	REQUIRE(sim.switches.size() == 1);
+
+	// 4 - 4 + 8 + 3 > 10
+	sim.costs[1][0] = 3.0f;
+	sim.RunUntil(seconds(60));
+	CHECK(sim.switches.size() == 1);
+}
+
+// 升档后不久又降档则加倍升档前的等待时间，最多 MAX_UPGRADE_BACKOFF 倍
+TEST_CASE(UpgradeBackoff) {
+	Simulation sim({ { 8.0f, 4.0f }, { 1.0f } });
+	// 效果 0 处于第 0 档时效果 1 变慢，因此每次升档后都会降档
+	sim.costs[1][0] = 8.0f;
+
+	std::vector<uint32_t> backoffs;
+	sim.onSwitched = [&](const Switch& s) {
+		sim.costs[1][0] = s.tier == 0 ? 8.0f : 1.0f;
+		if (s.tier == 1) {
+			backoffs.push_back(sim.controller.GetUpgradeBackoff(0));
+		}
+	};
+	sim.RunUntil(seconds(300));
+
+	REQUIRE(backoffs.size() >= 6);
+	CHECK(backoffs[0] == 1);
+	CHECK(backoffs[1] == 2);
+	CHECK(backoffs[2] == 4);
+	CHECK(backoffs[3] == 8);
+	CHECK(backoffs[4] == 16);
+	CHECK(backoffs[5] == 16);
+
+	// 降档和下一次升档的间隔随之增长
+	for (size_t i = 1; i < sim.switches.size(); i += 2) {
+		const Switch& downgrade = sim.switches[i - 1];
+		const Switch& upgrade = sim.switches[i];
+		REQUIRE(downgrade.tier == 1 && upgrade.tier == 0);
+		CHECK(upgrade.time - downgrade.time >= QualityController::UPGRADE_DELAY * backoffs[i / 2]);
+	}
+}
+
+// 升档后超过 OSCILLATION_WINDOW 才降档不增加等待时间
+TEST_CASE(NoBackoffOutsideWindow) {
+	Simulation sim({ { 8.0f, 4.0f }, { 8.0f } });
+	sim.RunUntil(seconds(5));
+	sim.costs[1][0] = 1.0f;
+	sim.RunUntil(seconds(20));
+	REQUIRE(sim.switches.size() == 2);
+
+	sim.costs[1][0] = 8.0f;
+	sim.RunUntil(sim.switches[1].time + QualityController::OSCILLATION_WINDOW + seconds(5));
+	REQUIRE(sim.switches.size() == 3);
+	CHECK(sim.switches[2].tier == 1);
+	CHECK(sim.controller.GetUpgradeBackoff(0) == 1);
+}
+
+// 请求切换后直到 OnTierSwitched 前不再请求
+TEST_CASE(WaitsForSwitch) {
+	QualityController controller;
+	const uint32_t tierCounts[] = { 2 };
+	controller.Initialize(FRAME_BUDGET, tierCounts);
+
+	const float timings[] = { 20.0f };
+	uint32_t effectIdx = 0;
+	uint32_t tier = 0;
+	nanoseconds now{};
+	while (!controller.Update(now, timings, effectIdx, tier)) {
+		now += FRAME_BUDGET;
+		REQUIRE(now < seconds(1));
+	}
+	CHECK(effectIdx == 0 && tier == 1);
+	CHECK(controller.GetTier(0) == 0);
+
+	for (uint32_t i = 0; i < 100; ++i) {
+		now += FRAME_BUDGET;
+		CHECK(!controller.Update(now, timings, effectIdx, tier));
+	}
+
+	controller.OnTierSwitched(now, 0, 1, true);
+	CHECK(controller.GetTier(0) == 1);
+}
+
+// 无法降到的档位及其后的档位不再尝试，升档失败则尽可能推迟下一次升档
+TEST_CASE(FailedSwitch) {
+	Simulation sim({ { 20.0f, 15.0f, 14.0f, 4.0f } });
+	sim.canSwitch = [](uint32_t, uint32_t tier) { return tier != 2; };
+	sim.RunUntil(seconds(30));
+
+	REQUIRE(sim.switches.size() == 2);
+	CHECK(sim.switches[0].tier == 1 && sim.switches[0].succeeded);
+	CHECK(sim.switches[1].tier == 2 && !sim.switches[1].succeeded);
+	CHECK(sim.controller.GetTier(0) == 1);
+
+	Simulation upgradeSim({ { 8.0f, 4.0f }, { 8.0f } });
+	upgradeSim.canSwitch = [](uint32_t, uint32_t tier) { return tier != 0; };
+	upgradeSim.RunUntil(seconds(5));
+	upgradeSim.costs[1][0] = 1.0f;
+	upgradeSim.RunUntil(seconds(20));
+
+	REQUIRE(upgradeSim.switches.size() == 2);
+	CHECK(!upgradeSim.switches[1].succeeded);
+	CHECK(upgradeSim.controller.GetTier(0) == 1);
+	CHECK(upgradeSim.controller.GetUpgradeBackoff(0) == QualityController::MAX_UPGRADE_BACKOFF);
+
+	// 至少等待 UPGRADE_DELAY * MAX_UPGRADE_BACKOFF 才再次尝试
+	upgradeSim.RunUntil(upgradeSim.switches[1].time + QualityController::UPGRADE_DELAY * 15);
+	CHECK(upgradeSim.switches.size() == 2);
+	upgradeSim.RunUntil(upgradeSim.switches[1].time + QualityController::UPGRADE_DELAY * 17 + seconds(1));
+	CHECK(upgradeSim.switches.size() == 3);
+}
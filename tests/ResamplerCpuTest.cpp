@@ -0,0 +1,82 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "ResamplerCpu.h"
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+static constexpr ResampleFilter FILTERS[] = {
+	ResampleFilter::Nearest,
+	ResampleFilter::Bilinear,
+	ResampleFilter::Bicubic,
+	ResampleFilter::Lanczos,
+	ResampleFilter::Jinc
+};
+
+static std::vector<float4> Scale(
+	ResampleFilter filter,
+	const std::vector<float4>& src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	uint32_t destWidth,
+	uint32_t destHeight
+) {
+	std::vector<float4> dest((size_t)destWidth * destHeight);
+	if (!ResamplerCpu::Scale(filter, {}, src, srcWidth, srcHeight, dest, destWidth, destHeight)) {
+		dest.clear();
+	}
+	return dest;
+}
+
+TEST_CASE(RejectsInvalidArguments) {
+	std::vector<float4> src(16);
+	std::vector<float4> dest(64);
+	CHECK(!ResamplerCpu::Scale(ResampleFilter::Bilinear, {}, src, 0, 4, dest, 8, 8));
+	CHECK(!ResamplerCpu::Scale(ResampleFilter::Bilinear, {}, src, 4, 4, dest, 8, 0));
+	CHECK(!ResamplerCpu::Scale(ResampleFilter::Bilinear, {}, src, 5, 4, dest, 8, 8));
+	CHECK(!ResamplerCpu::Scale(ResampleFilter::Bilinear, {}, src, 4, 4, dest, 9, 8));
+}
+
+// 所有算法的权重之和都为 1，纯色图像保持不变
+TEST_CASE(FlatImageIsUnchanged) {
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+
+	for (ResampleFilter filter : FILTERS) {
+		const std::vector<float4> dest = Scale(filter, src, 16, 16, 37, 23);
+		REQUIRE(!dest.empty());
+		CHECK(MaxError(dest, std::vector<float4>(dest.size(), color)) < 1e-5f);
+	}
+}
+
+// 尺寸不变时 Nearest 和 Bilinear 的采样点都在纹素中心
+TEST_CASE(SameSizeIsIdentity) {
+	const std::vector<float4> src = MakeTestImage(19, 13);
+	CHECK(Scale(ResampleFilter::Nearest, src, 19, 13, 19, 13) == src);
+	CHECK(MaxError(Scale(ResampleFilter::Bilinear, src, 19, 13, 19, 13), src) < 1e-6f);
+}
+
+// AVX2 核不使用 FMA，结果必须和可移植的实现完全相同。奇数宽度覆盖每行末尾的单个像素，
+// 3.7 倍放大使 Jinc 的相位数超出上限，覆盖逐像素计算权重的路径
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	const std::vector<float4> src = MakeTestImage(37, 29);
+	const std::pair<uint32_t, uint32_t> destSizes[] = { { 74, 58 }, { 137, 107 }, { 23, 17 } };
+
+	for (ResampleFilter filter : FILTERS) {
+		for (auto [destWidth, destHeight] : destSizes) {
+			CpuFeatures::SetAvx2Enabled(false);
+			const std::vector<float4> portable = Scale(filter, src, 37, 29, destWidth, destHeight);
+			CpuFeatures::SetAvx2Enabled(true);
+			const std::vector<float4> avx2 = Scale(filter, src, 37, 29, destWidth, destHeight);
+
+			REQUIRE(!portable.empty() && !avx2.empty());
+			CHECK(portable == avx2);
+		}
+	}
+}
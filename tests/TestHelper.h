@@ -0,0 +1,76 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// 极简的测试框架。测试只依赖可移植的头文件，不引入第三方库，以便在任何平台的 CI 中编译运行。
+namespace MagpieTest {
+
+struct TestCase {
+	const char* name;
+	void (*func)();
+};
+
+inline std::vector<TestCase>& GetTestCases() noexcept {
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+inline int& GetFailureCount() noexcept {
+	static int failureCount = 0;
+	return failureCount;
+}
+
+struct TestRegistrar {
+	TestRegistrar(const char* name, void (*func)()) noexcept {
+		GetTestCases().push_back({ name, func });
+	}
+};
+
+inline void ReportFailure(const char* file, int line, const char* expr) noexcept {
+	std::fprintf(stderr, "%s(%d): 检查失败: %s\n", file, line, expr);
+	++GetFailureCount();
+}
+
+inline int RunAllTests() noexcept {
+	int failedCases = 0;
+	for (const TestCase& testCase : GetTestCases()) {
+		const int failureCount = GetFailureCount();
+		testCase.func();
+
+		if (GetFailureCount() == failureCount) {
+			std::printf("[  OK  ] %s\n", testCase.name);
+		} else {
+			std::printf("[FAILED] %s\n", testCase.name);
+			++failedCases;
+		}
+	}
+
+	std::printf("%zu 个测试，%d 个失败\n", GetTestCases().size(), failedCases);
+	return failedCases == 0 ? 0 : 1;
+}
+
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static const MagpieTest::TestRegistrar name##_registrar(#name, name); \
+	static void name()
+
+#define CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			MagpieTest::ReportFailure(__FILE__, __LINE__, #expr); \
+		} \
+	} while (false)
+
+// 失败时不再继续执行当前测试
+#define REQUIRE(expr) \
+	do { \
+		if (!(expr)) { \
+			MagpieTest::ReportFailure(__FILE__, __LINE__, #expr); \
+			return; \
+		} \
+	} while (false)
+
+#define CHECK_NEAR(a, b, eps) CHECK(std::abs(double(a) - double(b)) <= double(eps))
@@ -0,0 +1,88 @@
+#pragma once
+#include "Float4.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace MagpieTest {
+
+// CPU 效果测试使用的合成图像：平滑的渐变上叠加硬边缘、细线和少量噪声，覆盖各效果的主要分支
+inline std::vector<Magpie::float4> MakeTestImage(uint32_t width, uint32_t height, uint32_t seed = 1) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> noise(-0.03f, 0.03f);
+
+	std::vector<Magpie::float4> image((size_t)width * height);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			const float u = (x + 0.5f) / width;
+			const float v = (y + 0.5f) / height;
+
+			Magpie::float4 color(0.2f + 0.6f * u, 0.3f + 0.4f * v, 0.5f + 0.3f * std::sin(6.0f * (u + v)), 1.0f);
+			// 斜向的硬边缘
+			if (x + 2 * y > width) {
+				color.x = 1.0f - color.x;
+				color.z *= 0.5f;
+			}
+			// 一像素宽的细线
+			if (x % 7 == 3) {
+				color.y = 0.95f;
+			}
+
+			color.x = Magpie::Saturate(color.x + noise(rng));
+			color.y = Magpie::Saturate(color.y + noise(rng));
+			color.z = Magpie::Saturate(color.z + noise(rng));
+			image[(size_t)y * width + x] = color;
+		}
+	}
+
+	return image;
+}
+
+// 像素画效果测试使用的合成图像：由少数几种颜色组成，包含 1:1 和 2:1 的斜线、单像素的点以及纯色区域。
+// 左下角是两种颜色的随机像素，覆盖需要特定邻域的规则
+inline std::vector<Magpie::float4> MakePixelArtImage(uint32_t width, uint32_t height, uint32_t seed = 1) {
+	static constexpr Magpie::float4 PALETTE[] = {
+		{ 0.1f, 0.1f, 0.2f, 1.0f },
+		{ 0.9f, 0.8f, 0.3f, 1.0f },
+		{ 0.2f, 0.6f, 0.9f, 1.0f },
+		{ 0.8f, 0.2f, 0.2f, 1.0f }
+	};
+
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<uint32_t> dot(0, 15);
+
+	std::vector<Magpie::float4> image((size_t)width * height);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			uint32_t idx = 0;
+			if ((x + y) % 11 < 2) {
+				idx = 1;
+			} else if ((x + 2 * y) % 13 == 0 || (2 * x + y) % 17 == 0) {
+				idx = 2;
+			} else if ((x / 6 + y / 5) % 3 == 0) {
+				idx = 3;
+			}
+			if (x < width / 2 && y >= height / 2) {
+				idx = dot(rng) % 2;
+			} else if (dot(rng) == 0) {
+				// 少量孤立的点
+				idx = (idx + 1) % 4;
+			}
+			image[(size_t)y * width + x] = PALETTE[idx];
+		}
+	}
+
+	return image;
+}
+
+// RGB 通道的最大误差
+inline float MaxError(const std::vector<Magpie::float4>& a, const std::vector<Magpie::float4>& b) noexcept {
+	float result = 0.0f;
+	for (size_t i = 0; i < a.size(); ++i) {
+		const Magpie::float4 diff = Magpie::Abs(a[i] - b[i]);
+		result = std::max({ result, diff.x, diff.y, diff.z });
+	}
+	return result;
+}
+
+}
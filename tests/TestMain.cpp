@@ -0,0 +1,5 @@
+#include "TestHelper.h"
+
+int main() {
+	return MagpieTest::RunAllTests();
+}
@@ -0,0 +1,155 @@
+#include "TestHelper.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// ThreadPool 的调度和并发。CMakeLists.txt 在支持时以 ThreadSanitizer 构建，CHECK 只在主线程中使用
+
+using namespace Magpie;
+using namespace std::chrono;
+
+TEST_CASE(ParallelForVisitsEachIndexOnce) {
+	for (uint32_t grainSize : { 1u, 7u, 64u, 100000u }) {
+		std::vector<std::atomic<uint32_t>> visits(10000);
+		ThreadPool::Get().ParallelFor((uint32_t)visits.size(), grainSize, [&](uint32_t i) {
+			visits[i].fetch_add(1, std::memory_order_relaxed);
+		});
+
+		bool allOnce = true;
+		for (const std::atomic<uint32_t>& count : visits) {
+			allOnce &= count.load() == 1;
+		}
+		CHECK(allOnce);
+	}
+}
+
+TEST_CASE(NestedParallelFor) {
+	std::atomic<uint32_t> sum = 0;
+	ThreadPool::Get().ParallelFor(64, [&](uint32_t i) {
+		ThreadPool::Get().ParallelFor(64, [&](uint32_t j) {
+			sum.fetch_add(i * 64 + j, std::memory_order_relaxed);
+		});
+	});
+
+	CHECK(sum.load() == 4096 * 4095 / 2);
+}
+
+TEST_CASE(CanceledTasksAreSkipped) {
+	std::atomic<uint32_t> runCount = 0;
+
+	{
+		TaskGroup group;
+		group.Cancel();
+		for (uint32_t i = 0; i < 100; ++i) {
+			group.Run([&]() { runCount.fetch_add(1, std::memory_order_relaxed); });
+		}
+	}
+	CHECK(runCount.load() == 0);
+
+	// 取消后每个线程最多再执行完手中的块
+	TaskGroup group;
+	ThreadPool::Get().ParallelFor(group, 100000, 1, [&](uint32_t i) {
+		if (i == 0) {
+			group.Cancel();
+		}
+		runCount.fetch_add(1, std::memory_order_relaxed);
+	});
+	CHECK(runCount.load() <= ThreadPool::Get().ThreadCount() + 1);
+}
+
+// 正在等待 Interactive 任务的线程
+static thread_local bool isWaitingForInteractive = false;
+
+// 工作线程提交的 Background 任务应放入全局队列，不能被等待 Interactive 任务的线程执行
+TEST_CASE(BackgroundTasksFromWorkersStayBackground) {
+	std::atomic<uint32_t> backgroundRunCount = 0;
+	std::atomic<uint32_t> violationCount = 0;
+	std::atomic<bool> isDone = false;
+
+	TaskGroup background(TaskPriority::Background);
+	TaskGroup interactive;
+	interactive.Run([&]() {
+		// 先于 Background 任务提交，工作线程的队列后进先出
+		TaskGroup inner;
+		inner.Run([]() { std::this_thread::sleep_for(milliseconds(20)); });
+
+		for (uint32_t i = 0; i < 64; ++i) {
+			background.Run([&]() {
+				if (isWaitingForInteractive) {
+					violationCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				std::this_thread::sleep_for(microseconds(500));
+				backgroundRunCount.fetch_add(1, std::memory_order_relaxed);
+			});
+		}
+
+		// 等待期间这个工作线程会寻找任务执行
+		isWaitingForInteractive = true;
+		inner.Wait();
+		isWaitingForInteractive = false;
+
+		isDone.store(true, std::memory_order_release);
+	});
+
+	// 主线程不参与执行，确保提交 Background 任务的是工作线程
+	while (!isDone.load(std::memory_order_acquire)) {
+		std::this_thread::sleep_for(milliseconds(1));
+	}
+	interactive.Wait();
+	background.Wait();
+
+	CHECK(violationCount.load() == 0);
+	CHECK(backgroundRunCount.load() == 64);
+}
+
+// 多个线程同时以不同优先级提交、嵌套和取消任务
+TEST_CASE(ConcurrentStress) {
+	constexpr uint32_t THREAD_COUNT = 4;
+	constexpr uint32_t ROUND_COUNT = 1000;
+
+	std::vector<uint32_t> failedRounds(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < THREAD_COUNT; ++t) {
+		threads.emplace_back([&failedRounds, t]() {
+			for (uint32_t round = 0; round < ROUND_COUNT; ++round) {
+				const TaskPriority priority = (round + t) % 2 == 0 ? TaskPriority::Interactive : TaskPriority::Background;
+
+				std::atomic<uint32_t> sum = 0;
+				std::atomic<uint32_t> taskCount = 0;
+				{
+					TaskGroup group(priority);
+					for (uint32_t i = 0; i < 8; ++i) {
+						group.Run([&, i]() {
+							// 任务中以另一种优先级嵌套
+							TaskGroup nested(i % 2 == 0 ? TaskPriority::Interactive : TaskPriority::Background);
+							ThreadPool::Get().ParallelFor(nested, 32, 3, [&](uint32_t j) {
+								sum.fetch_add(j, std::memory_order_relaxed);
+							});
+							taskCount.fetch_add(1, std::memory_order_relaxed);
+						});
+					}
+
+					// 每 7 轮取消一次，这些轮次只检查不会崩溃或死锁
+					if (round % 7 == 3) {
+						group.Cancel();
+					}
+				}
+
+				if (round % 7 != 3 && (taskCount.load() != 8 || sum.load() != 8 * (32 * 31 / 2))) {
+					++failedRounds[t];
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	for (uint32_t count : failedRounds) {
+		CHECK(count == 0);
+	}
+}
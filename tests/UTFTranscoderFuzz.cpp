@@ -0,0 +1,186 @@
+#include "UTFTranscoder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// 将 UTFTranscoder 的结果和逐字节的参考实现比较。CMakeLists.txt 还以 MP_UTF_TRANSCODER_NO_SSE2
+// 构建一次，覆盖可移植的实现。输出缓冲区的大小恰好是文档要求的最小值，越界写入会被 ASan 发现
+
+// 违反不变量时立即终止，模糊测试驱动和 libFuzzer 都会把它视为崩溃
+#define FUZZ_ASSERT(expr) \
+	do { \
+		if (!(expr)) { \
+			std::fprintf(stderr, "%s(%d): 不变量不成立: %s\n", __FILE__, __LINE__, #expr); \
+			std::abort(); \
+		} \
+	} while (false)
+
+static constexpr char16_t REPLACEMENT = 0xFFFD;
+
+static void AppendUTF16(std::u16string& result, char32_t codePoint) {
+	if (codePoint >= 0x10000) {
+		result.push_back(char16_t(0xD800 + ((codePoint - 0x10000) >> 10)));
+		result.push_back(char16_t(0xDC00 + ((codePoint - 0x10000) & 0x3FF)));
+	} else {
+		result.push_back((char16_t)codePoint);
+	}
+}
+
+// Unicode 第 3 章表 3-7 中的合法序列，无效的序列按“最大子部分”替换为 U+FFFD
+static std::u16string ReferenceUTF8ToUTF16(const uint8_t* s, size_t size) {
+	std::u16string result;
+
+	for (size_t i = 0; i < size;) {
+		const uint8_t c = s[i];
+		if (c < 0x80) {
+			result.push_back(c);
+			++i;
+			continue;
+		}
+
+		uint32_t length = 0;
+		uint8_t lo = 0x80;
+		uint8_t hi = 0xBF;
+		if (c >= 0xC2 && c <= 0xDF) {
+			length = 2;
+		} else if (c == 0xE0) {
+			length = 3;
+			lo = 0xA0;
+		} else if (c == 0xED) {
+			length = 3;
+			hi = 0x9F;
+		} else if (c >= 0xE1 && c <= 0xEF) {
+			length = 3;
+		} else if (c == 0xF0) {
+			length = 4;
+			lo = 0x90;
+		} else if (c == 0xF4) {
+			length = 4;
+			hi = 0x8F;
+		} else if (c >= 0xF1 && c <= 0xF3) {
+			length = 4;
+		}
+
+		if (length == 0) {
+			result.push_back(REPLACEMENT);
+			++i;
+			continue;
+		}
+
+		// 只有第二个字节的范围受首字节限制，其余都是 80..BF
+		char32_t codePoint = c & (0xFF >> (length + 1));
+		uint32_t k = 1;
+		for (; k < length && i + k < size; ++k) {
+			const uint8_t next = s[i + k];
+			if (next < (k == 1 ? lo : 0x80) || next > (k == 1 ? hi : 0xBF)) {
+				break;
+			}
+			codePoint = (codePoint << 6) | (next & 0x3F);
+		}
+
+		if (k == length) {
+			AppendUTF16(result, codePoint);
+		} else {
+			result.push_back(REPLACEMENT);
+		}
+		i += k;
+	}
+
+	return result;
+}
+
+// 孤立的代理项替换为 U+FFFD
+static std::string ReferenceUTF16ToUTF8(const char16_t* s, size_t size) {
+	std::string result;
+
+	for (size_t i = 0; i < size; ++i) {
+		char32_t codePoint = s[i];
+		if (codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+			if (codePoint <= 0xDBFF && i + 1 < size && s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF) {
+				codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (s[i + 1] - 0xDC00);
+				++i;
+			} else {
+				codePoint = REPLACEMENT;
+			}
+		}
+
+		if (codePoint < 0x80) {
+			result.push_back((char)codePoint);
+		} else if (codePoint < 0x800) {
+			result.push_back(char(0xC0 | (codePoint >> 6)));
+			result.push_back(char(0x80 | (codePoint & 0x3F)));
+		} else if (codePoint < 0x10000) {
+			result.push_back(char(0xE0 | (codePoint >> 12)));
+			result.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+			result.push_back(char(0x80 | (codePoint & 0x3F)));
+		} else {
+			result.push_back(char(0xF0 | (codePoint >> 18)));
+			result.push_back(char(0x80 | ((codePoint >> 12) & 0x3F)));
+			result.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+			result.push_back(char(0x80 | (codePoint & 0x3F)));
+		}
+	}
+
+	return result;
+}
+
+static std::vector<uint8_t> MakeSeed(std::string_view str) {
+	return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+std::vector<std::vector<uint8_t>> GetFuzzSeeds() {
+	return {
+		MakeSeed(""),
+		MakeSeed("C:\\Program Files\\Magpie\\effects\\FSR\\FSR_EASU.hlsl"),
+		MakeSeed("日志文件 magpie.log 已存在，将覆盖原有内容"),
+		MakeSeed("abcdefghijklmnop\xF0\x9F\x98\x80qrstuvwxyz0123456789ABCDEFGHIJ"),
+		// 截断、过长编码、代理项、超出 U+10FFFF
+		MakeSeed("0123456789abcdef\xE6\x97 \xC0\xAF \xED\xA0\x80 \xF4\x90\x80\x80 \xF0\x9F\x98"),
+		// 作为 UTF-16 解释时包含成对和孤立的代理项
+		MakeSeed(std::string_view("a\0\x3D\xD8\x00\xDE" "b\0\x00\xDC" "c\0\x3D\xD8", 14))
+	};
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	{
+		// 结果不会比输入长
+		std::vector<char16_t> dest(size);
+		const size_t count = UTFTranscoder::UTF8ToUTF16(std::string_view((const char*)data, size), dest.data());
+		FUZZ_ASSERT(count <= size);
+		FUZZ_ASSERT(std::u16string_view(dest.data(), count) == ReferenceUTF8ToUTF16(data, size));
+	}
+
+	{
+		// 同一输入作为 UTF-16 解释
+		std::vector<char16_t> src(size / 2);
+		if (!src.empty()) {
+			std::memcpy(src.data(), data, src.size() * 2);
+		}
+
+		std::vector<char> dest(src.size() * 3);
+		const size_t count = UTFTranscoder::UTF16ToUTF8(std::u16string_view(src.data(), src.size()), dest.data());
+		FUZZ_ASSERT(count <= dest.size());
+
+		const std::string expected = ReferenceUTF16ToUTF8(src.data(), src.size());
+		FUZZ_ASSERT(std::string_view(dest.data(), count) == expected);
+
+		// 输出总是有效的 UTF-8，转换回来得到的是将孤立的代理项替换为 U+FFFD 的输入
+		std::u16string sanitized(src.begin(), src.end());
+		for (size_t i = 0; i < sanitized.size(); ++i) {
+			const char16_t c = sanitized[i];
+			if (c >= 0xD800 && c <= 0xDBFF && i + 1 < sanitized.size() &&
+				sanitized[i + 1] >= 0xDC00 && sanitized[i + 1] <= 0xDFFF) {
+				++i;
+			} else if (c >= 0xD800 && c <= 0xDFFF) {
+				sanitized[i] = REPLACEMENT;
+			}
+		}
+
+		std::vector<char16_t> roundTrip(count);
+		const size_t roundTripCount = UTFTranscoder::UTF8ToUTF16(std::string_view(dest.data(), count), roundTrip.data());
+		FUZZ_ASSERT(std::u16string_view(roundTrip.data(), roundTripCount) == sanitized);
+	}
+
+	return 0;
+}
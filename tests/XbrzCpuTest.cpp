@@ -0,0 +1,69 @@
+#include "TestHelper.h"
+#include "TestImages.h"
+#include "CpuFeatures.h"
+#include "XbrzCpu.h"
+
+using namespace Magpie;
+using namespace MagpieTest;
+
+TEST_CASE(RejectsInvalidArguments) {
+	std::vector<float4> src(16);
+	std::vector<float4> dest(16 * 36);
+	CHECK(!XbrzCpu::Scale(1, src, 4, 4, dest));
+	CHECK(!XbrzCpu::Scale(7, src, 4, 4, dest));
+	CHECK(!XbrzCpu::Scale(2, src, 0, 4, dest));
+	CHECK(!XbrzCpu::Scale(6, src, 4, 4, std::span(dest).first(16 * 36 - 1)));
+	CHECK(!XbrzCpu::ScaleFree(src, 4, 4, dest, 0, 8));
+	CHECK(!XbrzCpu::ScaleFree(src, 5, 4, dest, 8, 8));
+}
+
+// 纯色图像不需要混合
+TEST_CASE(FlatImageIsUnchanged) {
+	const float4 color(0.25f, 0.5f, 0.75f, 1.0f);
+	const std::vector<float4> src(16 * 16, color);
+
+	for (uint32_t scale = 2; scale <= 6; ++scale) {
+		std::vector<float4> dest(src.size() * scale * scale);
+		REQUIRE(XbrzCpu::Scale(scale, src, 16, 16, dest));
+		CHECK(dest == std::vector<float4>(dest.size(), color));
+	}
+
+	std::vector<float4> dest(37 * 23);
+	REQUIRE(XbrzCpu::ScaleFree(src, 16, 16, dest, 37, 23));
+	CHECK(dest == std::vector<float4>(dest.size(), color));
+}
+
+// 宽度不是 8 的倍数，覆盖每行末尾的可移植路径
+TEST_CASE(Avx2MatchesPortable) {
+	if (!CpuFeatures::IsAvx2Enabled()) {
+		std::printf("不支持 AVX2，跳过\n");
+		return;
+	}
+
+	// 像素画和带噪声的图像分别覆盖相同和相近颜色的比较
+	const std::vector<float4> images[] = { MakePixelArtImage(45, 31), MakeTestImage(45, 31) };
+	for (const std::vector<float4>& src : images) {
+		for (uint32_t scale = 2; scale <= 6; ++scale) {
+			std::vector<float4> portable(src.size() * scale * scale);
+			std::vector<float4> avx2(portable.size());
+
+			CpuFeatures::SetAvx2Enabled(false);
+			REQUIRE(XbrzCpu::Scale(scale, src, 45, 31, portable));
+			CpuFeatures::SetAvx2Enabled(true);
+			REQUIRE(XbrzCpu::Scale(scale, src, 45, 31, avx2));
+			CHECK(portable == avx2);
+		}
+
+		const std::pair<uint32_t, uint32_t> destSizes[] = { { 90, 62 }, { 131, 77 }, { 37, 23 } };
+		for (auto [destWidth, destHeight] : destSizes) {
+			std::vector<float4> portable((size_t)destWidth * destHeight);
+			std::vector<float4> avx2(portable.size());
+
+			CpuFeatures::SetAvx2Enabled(false);
+			REQUIRE(XbrzCpu::ScaleFree(src, 45, 31, portable, destWidth, destHeight));
+			CpuFeatures::SetAvx2Enabled(true);
+			REQUIRE(XbrzCpu::ScaleFree(src, 45, 31, avx2, destWidth, destHeight));
+			CHECK(portable == avx2);
+		}
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <immintrin.h>
+
+// AVX2 核共用的函数，只能被以 Avx2 结尾的源文件包含。所有函数都是内部链接的，不会和其他源文件中
+// 同名的内联函数合并
+
+namespace Magpie::Avx2Helper {
+
+// 8 个像素的 RGBA，每个寄存器保存 8 个像素的同一个分量
+struct Color8 {
+	__m256 r;
+	__m256 g;
+	__m256 b;
+	__m256 a;
+};
+
+// 和 std::min(a, b)、std::max(a, b) 相同，相等或有 NaN 时返回 a
+static inline __m256 Min(__m256 a, __m256 b) noexcept {
+	return _mm256_min_ps(b, a);
+}
+
+static inline __m256 Max(__m256 a, __m256 b) noexcept {
+	return _mm256_max_ps(b, a);
+}
+
+// 和 std::fmin、std::fmax 相同，忽略 NaN
+static inline __m256 FMin(__m256 a, __m256 b) noexcept {
+	return _mm256_blendv_ps(_mm256_min_ps(a, b), a, _mm256_cmp_ps(b, b, _CMP_UNORD_Q));
+}
+
+static inline __m256 FMax(__m256 a, __m256 b) noexcept {
+	return _mm256_blendv_ps(_mm256_max_ps(a, b), a, _mm256_cmp_ps(b, b, _CMP_UNORD_Q));
+}
+
+static inline __m256 Abs(__m256 value) noexcept {
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+}
+
+static inline __m256 Neg(__m256 value) noexcept {
+	return _mm256_xor_ps(value, _mm256_set1_ps(-0.0f));
+}
+
+// 和 Float4.h 中的 Saturate 相同，NaN 返回 0
+static inline __m256 Saturate(__m256 value) noexcept {
+	return _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+}
+
+static inline __m256 Add(__m256 a, __m256 b) noexcept {
+	return _mm256_add_ps(a, b);
+}
+
+static inline __m256 Sub(__m256 a, __m256 b) noexcept {
+	return _mm256_sub_ps(a, b);
+}
+
+static inline __m256 Mul(__m256 a, __m256 b) noexcept {
+	return _mm256_mul_ps(a, b);
+}
+
+static inline __m256 Div(__m256 a, __m256 b) noexcept {
+	return _mm256_div_ps(a, b);
+}
+
+static inline __m256 Set(float value) noexcept {
+	return _mm256_set1_ps(value);
+}
+
+// 和 Float4.h 中的 Lerp 相同
+static inline __m256 Lerp(__m256 a, __m256 b, __m256 t) noexcept {
+	return Add(a, Mul(Sub(b, a), t));
+}
+
+// 比较结果为掩码，每个像素的所有位为 1 或 0。和 C++ 的比较运算符一样，有 NaN 时除了 NotEqual 都为 false
+static inline __m256 Equal(__m256 a, __m256 b) noexcept {
+	return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+}
+
+static inline __m256 NotEqual(__m256 a, __m256 b) noexcept {
+	return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ);
+}
+
+static inline __m256 Less(__m256 a, __m256 b) noexcept {
+	return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+}
+
+static inline __m256 LessEqual(__m256 a, __m256 b) noexcept {
+	return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+}
+
+static inline __m256 Greater(__m256 a, __m256 b) noexcept {
+	return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+}
+
+static inline __m256 GreaterEqual(__m256 a, __m256 b) noexcept {
+	return _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+}
+
+static inline __m256 And(__m256 a, __m256 b) noexcept {
+	return _mm256_and_ps(a, b);
+}
+
+static inline __m256 Or(__m256 a, __m256 b) noexcept {
+	return _mm256_or_ps(a, b);
+}
+
+static inline __m256 Not(__m256 mask) noexcept {
+	return _mm256_xor_ps(mask, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+}
+
+// 掩码中是否有像素为 true
+static inline bool Any(__m256 mask) noexcept {
+	return _mm256_movemask_ps(mask) != 0;
+}
+
+// mask 的对应位为 1 时选择 ifTrue
+static inline __m256 Select(__m256 mask, __m256 ifTrue, __m256 ifFalse) noexcept {
+	return _mm256_blendv_ps(ifFalse, ifTrue, mask);
+}
+
+// 读取 8 个 RGBA 像素并转置
+static inline Color8 Load8(const float* const (&pixels)[8]) noexcept {
+	const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pixels[0])), _mm_loadu_ps(pixels[4]), 1);
+	const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pixels[1])), _mm_loadu_ps(pixels[5]), 1);
+	const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pixels[2])), _mm_loadu_ps(pixels[6]), 1);
+	const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pixels[3])), _mm_loadu_ps(pixels[7]), 1);
+
+	const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+	const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+	const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+	return {
+		_mm256_shuffle_ps(t0, t2, 0x44),
+		_mm256_shuffle_ps(t0, t2, 0xEE),
+		_mm256_shuffle_ps(t1, t3, 0x44),
+		_mm256_shuffle_ps(t1, t3, 0xEE)
+	};
+}
+
+// 读取一行中相邻的 8 个像素
+static inline Color8 Load8(const float* first) noexcept {
+	const float* const pixels[8] = {
+		first, first + 4, first + 8, first + 12, first + 16, first + 20, first + 24, first + 28
+	};
+	return Load8(pixels);
+}
+
+// 转置为 8 个 RGBA 像素并写入
+static inline void Store8(const Color8& color, float* dest) noexcept {
+	const __m256 t0 = _mm256_unpacklo_ps(color.r, color.g);
+	const __m256 t1 = _mm256_unpackhi_ps(color.r, color.g);
+	const __m256 t2 = _mm256_unpacklo_ps(color.b, color.a);
+	const __m256 t3 = _mm256_unpackhi_ps(color.b, color.a);
+
+	// 低半部分依次为第 0 到 3 个像素，高半部分为第 4 到 7 个像素
+	const __m256 p04 = _mm256_shuffle_ps(t0, t2, 0x44);
+	const __m256 p15 = _mm256_shuffle_ps(t0, t2, 0xEE);
+	const __m256 p26 = _mm256_shuffle_ps(t1, t3, 0x44);
+	const __m256 p37 = _mm256_shuffle_ps(t1, t3, 0xEE);
+
+	_mm256_storeu_ps(dest, _mm256_permute2f128_ps(p04, p15, 0x20));
+	_mm256_storeu_ps(dest + 8, _mm256_permute2f128_ps(p26, p37, 0x20));
+	_mm256_storeu_ps(dest + 16, _mm256_permute2f128_ps(p04, p15, 0x31));
+	_mm256_storeu_ps(dest + 24, _mm256_permute2f128_ps(p26, p37, 0x31));
+}
+
+}
@@ -0,0 +1,297 @@
+// CpuEffectsBatch.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 使用 EffectChainCpu 离线处理图像，用于在没有 GPU 的环境中检查效果链的输出。
+// CpuEffectsBatch --renderer <宽>x<高> --effect <名称> [--param <名称>=<值>]... [--scale <类型>[:<x>x<y>]]...
+//                 [--windowed] [--effects-dir <文件夹>] [--out <文件夹>] <输入>...
+//
+// --param 和 --scale 作用于前一个 --effect，缩放类型为 normal、fit、absolute 或 fill。
+// 支持二进制的 PPM (P6，8 位) 和 PFM (PF，32 位浮点) 图像，输出和输入的格式相同，文件名不变。
+
+#include "EffectChainCpu.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+using namespace Magpie;
+
+namespace {
+
+struct Image {
+	std::vector<float4> pixels;
+	CpuSize size;
+	bool isFloat = false;
+};
+
+}
+
+// 跳过空白和注释后读取头部的一项
+static bool ReadHeaderToken(std::istream& stream, std::string& token) {
+	token.clear();
+	for (int c = stream.get(); c != EOF; c = stream.get()) {
+		if (c == '#') {
+			std::string comment;
+			std::getline(stream, comment);
+		} else if (!std::isspace(c)) {
+			token.push_back((char)c);
+			break;
+		}
+	}
+
+	for (int c = stream.peek(); c != EOF && !std::isspace(c); c = stream.peek()) {
+		token.push_back((char)stream.get());
+	}
+
+	// 头部以单个空白字符结束
+	stream.get();
+	return !token.empty();
+}
+
+static bool ReadImage(const std::filesystem::path& path, Image& image) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	std::string magic, width, height, maxValue;
+	if (!ReadHeaderToken(file, magic) || !ReadHeaderToken(file, width) ||
+		!ReadHeaderToken(file, height) || !ReadHeaderToken(file, maxValue)) {
+		return false;
+	}
+
+	image.size = { std::atoi(width.c_str()), std::atoi(height.c_str()) };
+	if (image.size.width <= 0 || image.size.height <= 0) {
+		return false;
+	}
+
+	const size_t pixelCount = (size_t)image.size.width * image.size.height;
+	image.pixels.resize(pixelCount);
+
+	if (magic == "PF") {
+		// 比例为负数表示小端序，行由下向上排列
+		if (std::atof(maxValue.c_str()) >= 0) {
+			return false;
+		}
+
+		image.isFloat = true;
+		std::vector<float> row((size_t)image.size.width * 3);
+		for (int32_t y = image.size.height; y-- > 0;) {
+			if (!file.read((char*)row.data(), row.size() * sizeof(float))) {
+				return false;
+			}
+
+			float4* dest = image.pixels.data() + (size_t)y * image.size.width;
+			for (int32_t x = 0; x < image.size.width; ++x) {
+				dest[x] = float4(row[x * 3], row[x * 3 + 1], row[x * 3 + 2], 1.0f);
+			}
+		}
+	} else if (magic == "P6") {
+		if (std::atoi(maxValue.c_str()) != 255) {
+			return false;
+		}
+
+		image.isFloat = false;
+		std::vector<uint8_t> data(pixelCount * 3);
+		if (!file.read((char*)data.data(), data.size())) {
+			return false;
+		}
+
+		for (size_t i = 0; i < pixelCount; ++i) {
+			image.pixels[i] = float4(data[i * 3] / 255.0f, data[i * 3 + 1] / 255.0f, data[i * 3 + 2] / 255.0f, 1.0f);
+		}
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+static bool WriteImage(const std::filesystem::path& path, const Image& image) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	const size_t pixelCount = (size_t)image.size.width * image.size.height;
+
+	if (image.isFloat) {
+		file << "PF\n" << image.size.width << ' ' << image.size.height << "\n-1.0\n";
+
+		std::vector<float> row((size_t)image.size.width * 3);
+		for (int32_t y = image.size.height; y-- > 0;) {
+			const float4* src = image.pixels.data() + (size_t)y * image.size.width;
+			for (int32_t x = 0; x < image.size.width; ++x) {
+				row[x * 3] = src[x].x;
+				row[x * 3 + 1] = src[x].y;
+				row[x * 3 + 2] = src[x].z;
+			}
+			file.write((const char*)row.data(), row.size() * sizeof(float));
+		}
+	} else {
+		file << "P6\n" << image.size.width << ' ' << image.size.height << "\n255\n";
+
+		std::vector<uint8_t> data(pixelCount * 3);
+		for (size_t i = 0; i < pixelCount; ++i) {
+			const float4& pixel = image.pixels[i];
+			data[i * 3] = (uint8_t)std::lroundf(Saturate(pixel.x) * 255.0f);
+			data[i * 3 + 1] = (uint8_t)std::lroundf(Saturate(pixel.y) * 255.0f);
+			data[i * 3 + 2] = (uint8_t)std::lroundf(Saturate(pixel.z) * 255.0f);
+		}
+		file.write((const char*)data.data(), data.size());
+	}
+
+	return (bool)file;
+}
+
+// <类型>[:<x>x<y>]，只有一个值时两个方向使用相同的值
+static bool ParseScale(std::string_view arg, CpuEffectOption& option) {
+	const size_t colon = arg.find(':');
+	const std::string_view type = arg.substr(0, colon);
+
+	if (type == "normal") {
+		option.scalingType = CpuScalingType::Normal;
+	} else if (type == "fit") {
+		option.scalingType = CpuScalingType::Fit;
+	} else if (type == "absolute") {
+		option.scalingType = CpuScalingType::Absolute;
+	} else if (type == "fill") {
+		option.scalingType = CpuScalingType::Fill;
+	} else {
+		return false;
+	}
+
+	if (colon == std::string_view::npos) {
+		return option.scalingType == CpuScalingType::Fill;
+	}
+
+	const std::string value(arg.substr(colon + 1));
+	float x = 0;
+	float y = 0;
+	const int count = std::sscanf(value.c_str(), "%fx%f", &x, &y);
+	if (count == 1) {
+		y = x;
+	} else if (count != 2) {
+		return false;
+	}
+
+	option.scale = { x, y };
+	return x > 0 && y > 0;
+}
+
+static bool ParseParameter(std::string_view arg, CpuEffectOption& option) {
+	const size_t equal = arg.find('=');
+	if (equal == 0 || equal == std::string_view::npos) {
+		return false;
+	}
+
+	const std::string value(arg.substr(equal + 1));
+	char* end = nullptr;
+	const float number = std::strtof(value.c_str(), &end);
+	if (end == value.c_str() || *end != '\0') {
+		return false;
+	}
+
+	option.parameters[std::string(arg.substr(0, equal))] = number;
+	return true;
+}
+
+static int PrintUsage(const char* exe) {
+	std::fprintf(stderr,
+		"用法: %s --renderer <宽>x<高> --effect <名称> [--param <名称>=<值>]... [--scale <类型>[:<x>x<y>]]...\n"
+		"       [--windowed] [--effects-dir <文件夹>] [--out <文件夹>] <输入>...\n", exe);
+	return 1;
+}
+
+int main(int argc, char* argv[]) {
+	std::filesystem::path effectsDir = MAGPIE_EFFECTS_DIR;
+	std::filesystem::path outDir = "out";
+	std::vector<CpuEffectOption> effects;
+	std::vector<std::filesystem::path> inputs;
+	CpuSize rendererSize;
+	bool isWindowedMode = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "--effect" && hasValue) {
+			effects.emplace_back().name = argv[++i];
+		} else if (arg == "--param" && hasValue) {
+			if (effects.empty() || !ParseParameter(argv[++i], effects.back())) {
+				std::fprintf(stderr, "参数无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (arg == "--scale" && hasValue) {
+			if (effects.empty() || !ParseScale(argv[++i], effects.back())) {
+				std::fprintf(stderr, "缩放无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (arg == "--renderer" && hasValue) {
+			if (std::sscanf(argv[++i], "%dx%d", &rendererSize.width, &rendererSize.height) != 2 ||
+				rendererSize.width <= 0 || rendererSize.height <= 0) {
+				std::fprintf(stderr, "尺寸无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (arg == "--windowed") {
+			isWindowedMode = true;
+		} else if (arg == "--effects-dir" && hasValue) {
+			effectsDir = argv[++i];
+		} else if (arg == "--out" && hasValue) {
+			outDir = argv[++i];
+		} else if (!arg.starts_with("-")) {
+			inputs.emplace_back(arg);
+		} else {
+			return PrintUsage(argv[0]);
+		}
+	}
+
+	if (effects.empty() || inputs.empty() || rendererSize.width == 0) {
+		return PrintUsage(argv[0]);
+	}
+
+	EffectChainCpu effectChain;
+	if (!effectChain.Initialize(effectsDir, effects, isWindowedMode)) {
+		std::fprintf(stderr, "初始化效果链失败，有效果不存在或没有 CPU 实现\n");
+		return 1;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(outDir, ec);
+	if (ec) {
+		std::fprintf(stderr, "创建文件夹失败: %s\n", outDir.string().c_str());
+		return 1;
+	}
+
+	int failedCount = 0;
+	for (const std::filesystem::path& input : inputs) {
+		Image image;
+		if (!ReadImage(input, image)) {
+			std::fprintf(stderr, "读取失败: %s\n", input.string().c_str());
+			++failedCount;
+			continue;
+		}
+
+		Image output;
+		output.isFloat = image.isFloat;
+		if (!effectChain.Run(image.pixels, image.size, rendererSize, output.pixels, output.size)) {
+			std::fprintf(stderr, "执行效果链失败: %s\n", input.string().c_str());
+			++failedCount;
+			continue;
+		}
+
+		const std::filesystem::path outPath = outDir / input.filename();
+		if (!WriteImage(outPath, output)) {
+			std::fprintf(stderr, "写入失败: %s\n", outPath.string().c_str());
+			++failedCount;
+			continue;
+		}
+
+		std::printf("%s: %dx%d -> %dx%d\n", input.string().c_str(),
+			image.size.width, image.size.height, output.size.width, output.size.height);
+	}
+
+	return failedCount == 0 ? 0 : 1;
+}
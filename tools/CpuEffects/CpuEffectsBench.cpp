@@ -0,0 +1,435 @@
+// CpuEffectsBench.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 比较 CPU 效果的可移植实现和 AVX2 实现的耗时。之后将 ResamplerCpu 和逐像素的朴素实现比较，
+// 后者和着色器一样为每个输出像素即时计算权重，在单线程中执行。这一项默认输出 3840x2160 的帧，
+// ResamplerCpu 的目标是比朴素实现快一个数量级。
+// CpuEffectsBench [名称过滤] [--size <宽>x<高>] [--iterations <次数>] [--naive-size <宽>x<高>]
+
+#include "CpuFeatures.h"
+#include "FsrCpu.h"
+#include "GlssCpu.h"
+#include "MmpxCpu.h"
+#include "NisCpu.h"
+#include "ResamplerCpu.h"
+#include "XbrzCpu.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numbers>
+#include <string_view>
+#include <vector>
+
+using namespace Magpie;
+
+namespace {
+
+struct BenchCase {
+	const char* name;
+	// 输出尺寸相对于输入的倍数
+	uint32_t scale;
+	std::function<bool(std::span<const float4>, uint32_t, uint32_t, std::span<float4>)> run;
+};
+
+}
+
+static BenchCase ResampleCase(const char* name, ResampleFilter filter) {
+	return { name, 2, [filter](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+		return ResamplerCpu::Scale(filter, {}, src, width, height, dest, width * 2, height * 2);
+	} };
+}
+
+static BenchCase XbrzCase(const char* name, uint32_t scale) {
+	return { name, scale, [scale](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+		return XbrzCpu::Scale(scale, src, width, height, dest);
+	} };
+}
+
+static BenchCase GlssCase(const char* name, GlssVariant variant) {
+	return { name, 2, [variant](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+		return GlssCpu::Scale(variant, {}, src, width, height, dest, width * 2, height * 2);
+	} };
+}
+
+// 系数表位于 src/Effects/NIS，由 CMakeLists.txt 定义 MAGPIE_EFFECTS_DIR。加载失败时这一项报告失败
+static std::shared_ptr<NisCpu> CreateNis() {
+	auto nis = std::make_shared<NisCpu>();
+	const std::filesystem::path nisDir = std::filesystem::path(MAGPIE_EFFECTS_DIR) / "NIS";
+	nis->Initialize(nisDir / "Coef_Scale.dds", nisDir / "Coef_USM.dds");
+	return nis;
+}
+
+static std::vector<BenchCase> GetBenchCases() {
+	std::shared_ptr<NisCpu> nis = CreateNis();
+
+	return {
+		ResampleCase("Bilinear", ResampleFilter::Bilinear),
+		ResampleCase("Bicubic", ResampleFilter::Bicubic),
+		ResampleCase("Lanczos", ResampleFilter::Lanczos),
+		ResampleCase("Jinc", ResampleFilter::Jinc),
+		{ "FSR EASU", 2, [](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+			return FsrCpu::Easu(src, width, height, dest, width * 2, height * 2);
+		} },
+		{ "FSR RCAS", 1, [](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+			return FsrCpu::Rcas(src, width, height, dest);
+		} },
+		GlssCase("GLss", GlssVariant::Full),
+		GlssCase("GLss Lite", GlssVariant::Lite),
+		GlssCase("GLss Fast", GlssVariant::Fast),
+		{ "NIS", 2, [nis](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+			return nis->Scale(src, width, height, dest, width * 2, height * 2);
+		} },
+		{ "NIS Sharpen", 1, [](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+			return NisCpu::Sharpen(src, width, height, dest);
+		} },
+		XbrzCase("xBRZ 2x", 2),
+		XbrzCase("xBRZ 4x", 4),
+		XbrzCase("xBRZ 6x", 6),
+		{ "xBRZ Freescale", 2, [](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+			return XbrzCpu::ScaleFree(src, width, height, dest, width * 2, height * 2);
+		} },
+		{ "MMPX", 2, [](std::span<const float4> src, uint32_t width, uint32_t height, std::span<float4> dest) {
+			return MmpxCpu::Scale(src, width, height, dest);
+		} }
+	};
+}
+
+// 以下和 ResamplerCpu.cpp 中的同名函数相同
+static float BicubicWeight(float x, float B, float C) noexcept {
+	const float ax = std::abs(x);
+
+	if (ax < 1.0f) {
+		return (x * x * ((12.0f - 9.0f * B - 6.0f * C) * ax + (-18.0f + 12.0f * B + 6.0f * C)) + (6.0f - 2.0f * B)) / 6.0f;
+	} else if (ax < 2.0f) {
+		return (x * x * ((-B - 6.0f * C) * ax + (6.0f * B + 30.0f * C)) + (-12.0f * B - 48.0f * C) * ax + (8.0f * B + 24.0f * C)) / 6.0f;
+	} else {
+		return 0.0f;
+	}
+}
+
+static float LanczosWeight(float d) noexcept {
+	const float s = std::max(std::abs(std::numbers::pi_v<float> * d), 1e-5f);
+	return std::sin(s) * std::sin(s * (1.0f / 3.0f)) / (s * s);
+}
+
+static float4 AntiRinging(
+	const float4& color,
+	const float4& texel1,
+	const float4& texel2,
+	const float4& texel3,
+	const float4& texel4,
+	float strength
+) noexcept {
+	const float4 minSample = Min(Min(texel1, texel2), Min(texel3, texel4));
+	const float4 maxSample = Max(Max(texel1, texel2), Max(texel3, texel4));
+	return Lerp(color, Clamp(color, minSample, maxSample), strength);
+}
+
+// 逐像素的朴素实现，逐句对应着色器：每个输出像素即时计算权重，同时在两个方向上卷积，不使用线程池
+static void NaiveResample(
+	ResampleFilter filter,
+	const ResampleParameters& params,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	// 采样器使用 CLAMP 寻址
+	const auto texel = [&](int x, int y) -> const float4& {
+		x = std::clamp(x, 0, (int)srcWidth - 1);
+		y = std::clamp(y, 0, (int)srcHeight - 1);
+		return src[(size_t)y * srcWidth + x];
+	};
+
+	const float scaleX = (float)srcWidth / destWidth;
+	const float scaleY = (float)srcHeight / destHeight;
+	const float wa = params.jincWindowSinc * std::numbers::pi_v<float>;
+	const float wb = params.jincSinc * std::numbers::pi_v<float>;
+
+	for (uint32_t y = 0; y < destHeight; ++y) {
+		const float py = (y + 0.5f) * scaleY;
+
+		for (uint32_t x = 0; x < destWidth; ++x) {
+			const float px = (x + 0.5f) * scaleX;
+			float4 color;
+
+			switch (filter) {
+			case ResampleFilter::Nearest:
+			{
+				color = texel((int)std::floor(px), (int)std::floor(py));
+				break;
+			}
+			case ResampleFilter::Bilinear:
+			{
+				const float tx = px - 0.5f;
+				const float ty = py - 0.5f;
+				const int x0 = (int)std::floor(tx);
+				const int y0 = (int)std::floor(ty);
+				const float fx = tx - x0;
+				const float fy = ty - y0;
+				color = Lerp(
+					Lerp(texel(x0, y0), texel(x0 + 1, y0), fx),
+					Lerp(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx),
+					fy
+				);
+				break;
+			}
+			case ResampleFilter::Bicubic:
+			{
+				const float floorX = std::floor(px - 0.5f);
+				const float floorY = std::floor(py - 0.5f);
+				const float fx = px - (floorX + 0.5f);
+				const float fy = py - (floorY + 0.5f);
+
+				float wx[4], wy[4];
+				float sumX = 0.0f, sumY = 0.0f;
+				for (int t = 0; t < 4; ++t) {
+					wx[t] = BicubicWeight(t - 1.0f - fx, params.bicubicB, params.bicubicC);
+					wy[t] = BicubicWeight(t - 1.0f - fy, params.bicubicB, params.bicubicC);
+					sumX += wx[t];
+					sumY += wy[t];
+				}
+
+				color = float4();
+				for (int j = 0; j < 4; ++j) {
+					for (int i = 0; i < 4; ++i) {
+						color += texel((int)floorX - 1 + i, (int)floorY - 1 + j) * (wx[i] / sumX * (wy[j] / sumY));
+					}
+				}
+				color = WithAlpha(color, 1.0f);
+				break;
+			}
+			case ResampleFilter::Lanczos:
+			{
+				const float nx = std::floor(px + 0.5f);
+				const float ny = std::floor(py + 0.5f);
+				const float fx = px + 0.5f - nx;
+				const float fy = py + 0.5f - ny;
+
+				float wx[6], wy[6];
+				float sumX = 0.0f, sumY = 0.0f;
+				for (int t = 0; t < 6; ++t) {
+					wx[t] = LanczosWeight(t - 2.0f - fx);
+					wy[t] = LanczosWeight(t - 2.0f - fy);
+					sumX += wx[t];
+					sumY += wy[t];
+				}
+
+				const int x0 = (int)nx - 3;
+				const int y0 = (int)ny - 3;
+				color = float4();
+				for (int j = 0; j < 6; ++j) {
+					for (int i = 0; i < 6; ++i) {
+						color += texel(x0 + i, y0 + j) * (wx[i] / sumX * (wy[j] / sumY));
+					}
+				}
+
+				if (params.lanczosARStrength > 0.0f) {
+					color = AntiRinging(color, texel(x0 + 2, y0 + 2), texel(x0 + 3, y0 + 2),
+						texel(x0 + 2, y0 + 3), texel(x0 + 3, y0 + 3), params.lanczosARStrength);
+				}
+				color = WithAlpha(color, 1.0f);
+				break;
+			}
+			case ResampleFilter::Jinc:
+			{
+				const float floorX = std::floor(px - 0.5f);
+				const float floorY = std::floor(py - 0.5f);
+				const float fx = px - (floorX + 0.5f);
+				const float fy = py - (floorY + 0.5f);
+				const int x0 = (int)floorX - 1;
+				const int y0 = (int)floorY - 1;
+
+				color = float4();
+				float sum = 0.0f;
+				for (int j = 0; j < 4; ++j) {
+					for (int i = 0; i < 4; ++i) {
+						const float dx = (i - 1) - fx;
+						const float dy = (j - 1) - fy;
+						const float d = std::sqrt(dx * dx + dy * dy);
+						const float weight = d == 0.0f ? wa * wb : std::sin(d * wa) * std::sin(d * wb) / (d * d);
+						// 和 Jinc.hlsl 相同，最后一行的第二个纹素使用的是第三列
+						color += texel(x0 + (j == 3 && i == 1 ? 2 : i), y0 + j) * weight;
+						sum += weight;
+					}
+				}
+				color *= 1.0f / sum;
+
+				if (params.jincARStrength > 0.0f) {
+					color = AntiRinging(color, texel(x0 + 1, y0 + 1), texel(x0 + 2, y0 + 1),
+						texel(x0 + 1, y0 + 2), texel(x0 + 2, y0 + 2), params.jincARStrength);
+				}
+				color = WithAlpha(color, 1.0f);
+				break;
+			}
+			}
+
+			dest[(size_t)y * destWidth + x] = color;
+		}
+	}
+}
+
+// 平滑的渐变上叠加硬边缘，使各效果的分支都有机会执行
+static std::vector<float4> MakeImage(uint32_t width, uint32_t height) {
+	std::vector<float4> image((size_t)width * height);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			const float u = (x + 0.5f) / width;
+			const float v = (y + 0.5f) / height;
+			float4 color(u, v, 0.5f + 0.5f * std::sin(20.0f * (u + v)), 1.0f);
+			if ((x / 16 + y / 16) % 2 == 0) {
+				color.x = 1.0f - color.x;
+			}
+			image[(size_t)y * width + x] = color;
+		}
+	}
+	return image;
+}
+
+// 返回每次执行的平均毫秒数，失败时返回负数
+static double Measure(const BenchCase& benchCase, std::span<const float4> src,
+	uint32_t width, uint32_t height, std::span<float4> dest, uint32_t iterations) {
+	// 预热线程池和缓存
+	if (!benchCase.run(src, width, height, dest)) {
+		return -1.0;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		benchCase.run(src, width, height, dest);
+	}
+	const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+	return duration.count() / iterations;
+}
+
+// 将 ResamplerCpu 和 NaiveResample 比较，输入为输出的一半
+static void CompareWithNaive(std::string_view filter, uint32_t destWidth, uint32_t destHeight, uint32_t iterations, bool avx2Supported) {
+	static constexpr std::pair<const char*, ResampleFilter> FILTERS[] = {
+		{ "Nearest", ResampleFilter::Nearest },
+		{ "Bilinear", ResampleFilter::Bilinear },
+		{ "Bicubic", ResampleFilter::Bicubic },
+		{ "Lanczos", ResampleFilter::Lanczos },
+		{ "Jinc", ResampleFilter::Jinc }
+	};
+
+	const uint32_t width = destWidth / 2;
+	const uint32_t height = destHeight / 2;
+	const std::vector<float4> src = MakeImage(width, height);
+	std::vector<float4> expected((size_t)destWidth * destHeight);
+	std::vector<float4> dest(expected.size());
+
+	std::printf("\n和逐像素的朴素实现比较，输入 %ux%u，输出 %ux%u，朴素实现只执行一次\n",
+		width, height, destWidth, destHeight);
+	std::printf("%-16s %12s %12s %12s %10s %10s\n", "效果", "朴素 (ms)", "可移植 (ms)", "AVX2 (ms)", "朴素/最快", "最大误差");
+
+	for (const auto& [name, resampleFilter] : FILTERS) {
+		if (!filter.empty() && std::string_view(name).find(filter) == std::string_view::npos) {
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		NaiveResample(resampleFilter, {}, src, width, height, expected, destWidth, destHeight);
+		const double naive = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		const BenchCase benchCase = ResampleCase(name, resampleFilter);
+		CpuFeatures::SetAvx2Enabled(false);
+		const double portable = Measure(benchCase, src, width, height, dest, iterations);
+		if (portable < 0) {
+			std::printf("%-16s 失败\n", name);
+			continue;
+		}
+
+		// 两者计算的顺序不同，只有浮点误差
+		float maxError = 0.0f;
+		for (size_t i = 0; i < dest.size(); ++i) {
+			const float4 diff = Abs(dest[i] - expected[i]);
+			maxError = std::max({ maxError, diff.x, diff.y, diff.z, diff.w });
+		}
+
+		if (avx2Supported) {
+			CpuFeatures::SetAvx2Enabled(true);
+			const double avx2 = Measure(benchCase, src, width, height, dest, iterations);
+			std::printf("%-16s %12.1f %12.2f %12.2f %9.1fx %10.2e\n", name, naive, portable, avx2,
+				naive / std::min(portable, avx2), maxError);
+		} else {
+			std::printf("%-16s %12.1f %12.2f %12s %9.1fx %10.2e\n", name, naive, portable, "-",
+				naive / portable, maxError);
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	std::string_view filter;
+	uint32_t width = 960;
+	uint32_t height = 540;
+	uint32_t iterations = 5;
+	uint32_t naiveWidth = 3840;
+	uint32_t naiveHeight = 2160;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+				std::fprintf(stderr, "尺寸无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%u", &iterations) != 1 || iterations == 0) {
+				std::fprintf(stderr, "次数无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--naive-size") == 0 && i + 1 < argc) {
+			// 输入为输出的一半，因此必须是偶数
+			if (std::sscanf(argv[++i], "%ux%u", &naiveWidth, &naiveHeight) != 2 ||
+				naiveWidth < 2 || naiveHeight < 2 || naiveWidth % 2 != 0 || naiveHeight % 2 != 0) {
+				std::fprintf(stderr, "尺寸无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (argv[i][0] != '-') {
+			filter = argv[i];
+		} else {
+			std::fprintf(stderr, "用法: %s [名称过滤] [--size <宽>x<高>] [--iterations <次数>] [--naive-size <宽>x<高>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const bool avx2Supported = CpuFeatures::IsAvx2Enabled();
+	if (!avx2Supported) {
+		std::printf("不支持 AVX2，只测量可移植的实现\n");
+	}
+
+	const std::vector<float4> src = MakeImage(width, height);
+	std::printf("输入 %ux%u，每项执行 %u 次\n", width, height, iterations);
+	std::printf("%-16s %12s %12s %8s\n", "效果", "可移植 (ms)", "AVX2 (ms)", "加速比");
+
+	for (const BenchCase& benchCase : GetBenchCases()) {
+		if (!filter.empty() && std::string_view(benchCase.name).find(filter) == std::string_view::npos) {
+			continue;
+		}
+
+		std::vector<float4> dest((size_t)width * height * benchCase.scale * benchCase.scale);
+
+		CpuFeatures::SetAvx2Enabled(false);
+		const double portable = Measure(benchCase, src, width, height, dest, iterations);
+		if (portable < 0) {
+			std::printf("%-16s 失败\n", benchCase.name);
+			continue;
+		}
+
+		if (avx2Supported) {
+			CpuFeatures::SetAvx2Enabled(true);
+			const double avx2 = Measure(benchCase, src, width, height, dest, iterations);
+			std::printf("%-16s %12.2f %12.2f %7.2fx\n", benchCase.name, portable, avx2, portable / avx2);
+		} else {
+			std::printf("%-16s %12.2f\n", benchCase.name, portable);
+		}
+	}
+
+	CompareWithNaive(filter, naiveWidth, naiveHeight, iterations, avx2Supported);
+
+	return 0;
+}
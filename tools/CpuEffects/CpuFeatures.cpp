@@ -0,0 +1,58 @@
+#include "CpuFeatures.h"
+#include <atomic>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MP_CPU_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace Magpie {
+
+static bool IsAvx2Supported() noexcept {
+#if defined(MP_CPU_X64) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// FMA、OSXSAVE、AVX 和 F16C
+	__cpuid(info, 1);
+	constexpr int ECX_MASK = (1 << 12) | (1 << 27) | (1 << 28) | (1 << 29);
+	if ((info[2] & ECX_MASK) != ECX_MASK) {
+		return false;
+	}
+
+	// 操作系统保存了 YMM 寄存器
+	if ((_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(MP_CPU_X64)
+	// 已检查操作系统的支持
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+#else
+	return false;
+#endif
+}
+
+static std::atomic<bool>& Avx2Enabled() noexcept {
+	static std::atomic<bool> enabled = IsAvx2Supported();
+	return enabled;
+}
+
+bool CpuFeatures::IsAvx2Enabled() noexcept {
+	return Avx2Enabled().load(std::memory_order_relaxed);
+}
+
+void CpuFeatures::SetAvx2Enabled(bool enabled) noexcept {
+	Avx2Enabled().store(enabled && IsAvx2Supported(), std::memory_order_relaxed);
+}
+
+}
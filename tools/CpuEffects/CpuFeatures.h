@@ -0,0 +1,16 @@
+#pragma once
+
+namespace Magpie {
+
+// 运行时选择 SIMD 实现。AVX2 实现位于以 Avx2 结尾的源文件中，只有这些文件以 AVX2、FMA 和 F16C 编译。
+// 这些文件只使用 intrinsics 和内部链接的函数，不调用其他头文件中的内联函数，否则链接器可能为
+// 其他源文件选中 AVX2 版本的函数，在不支持 AVX2 的 CPU 上崩溃。
+struct CpuFeatures {
+	// CPU 和操作系统都支持 AVX2、FMA 和 F16C，且没有通过 SetAvx2Enabled 禁用。支持 AVX2 的 CPU 都支持 F16C
+	static bool IsAvx2Enabled() noexcept;
+
+	// 用于测试和性能对比，禁用后所有效果使用可移植的实现
+	static void SetAvx2Enabled(bool enabled) noexcept;
+};
+
+}
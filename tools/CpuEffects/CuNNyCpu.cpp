@@ -0,0 +1,1186 @@
+#include "CuNNyCpu.h"
+#include "CpuFeatures.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Magpie {
+
+// 每个任务处理的行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+static constexpr uint32_t MAX_GROUPS = CUNNY_MAX_GROUPS;
+static constexpr uint32_t INPUT_TEXTURE = std::numeric_limits<uint32_t>::max();
+static constexpr uint32_t INVALID_TEXTURE = std::numeric_limits<uint32_t>::max() - 1;
+// CuNNy 的 sN_i 中 i 的范围
+static constexpr uint32_t TAP_COUNT = 9;
+// 和着色器中的 RY、YR 相同
+static constexpr float4 RY[3] = {
+	{ 0.299f, 0.587f, 0.114f, 0.0f },
+	{ -0.169f, -0.331f, 0.5f, 0.0f },
+	{ 0.5f, -0.419f, -0.081f, 0.0f }
+};
+static constexpr float4 YR[3] = {
+	{ 1.0f, -0.00093f, 1.401687f, 0.0f },
+	{ 1.0f, -0.3437f, -0.71417f, 0.0f },
+	{ 1.0f, 1.77216f, 0.00099f, 0.0f }
+};
+
+// 效果源码只包含 ASCII 字符，不受区域设置影响
+static bool IsSpace(char c) noexcept {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool IsDigit(char c) noexcept {
+	return c >= '0' && c <= '9';
+}
+
+static bool IsAlnum(char c) noexcept {
+	return IsDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static void Trim(std::string_view& str) noexcept {
+	while (!str.empty() && IsSpace(str.front())) {
+		str.remove_prefix(1);
+	}
+	while (!str.empty() && IsSpace(str.back())) {
+		str.remove_suffix(1);
+	}
+}
+
+static std::vector<std::string_view> Split(std::string_view str, char delimiter) {
+	std::vector<std::string_view> result;
+	while (true) {
+		const size_t pos = str.find(delimiter);
+		result.push_back(str.substr(0, pos));
+		if (pos == std::string_view::npos) {
+			return result;
+		}
+		str.remove_prefix(pos + 1);
+	}
+}
+
+static void RemoveLeadingBlanks(std::string_view& str) noexcept {
+	while (!str.empty() && IsSpace(str[0])) {
+		str.remove_prefix(1);
+	}
+}
+
+static bool ConsumePrefix(std::string_view& str, std::string_view prefix) noexcept {
+	RemoveLeadingBlanks(str);
+	if (!str.starts_with(prefix)) {
+		return false;
+	}
+
+	str.remove_prefix(prefix.size());
+	return true;
+}
+
+template <typename T>
+static bool ConsumeNumber(std::string_view& str, T& value) noexcept {
+	RemoveLeadingBlanks(str);
+	const auto& result = std::from_chars(str.data(), str.data() + str.size(), value);
+	if ((int)result.ec) {
+		return false;
+	}
+
+	str.remove_prefix(result.ptr - str.data());
+	return true;
+}
+
+static bool ConsumeIdentifier(std::string_view& str, std::string_view& value) noexcept {
+	RemoveLeadingBlanks(str);
+
+	size_t i = 0;
+	while (i < str.size() && (IsAlnum(str[i]) || str[i] == '_')) {
+		++i;
+	}
+
+	if (i == 0) {
+		return false;
+	}
+
+	value = str.substr(0, i);
+	str.remove_prefix(i);
+	return true;
+}
+
+// 解析 "f0, f1, ..., fn)"，terminator 为最后的 ")"
+static bool ConsumeFloats(std::string_view& str, float* values, uint32_t count, std::string_view terminator = ")") noexcept {
+	for (uint32_t i = 0; i < count; ++i) {
+		if (!ConsumeNumber(str, values[i])) {
+			return false;
+		}
+
+		if (!ConsumePrefix(str, i + 1 == count ? terminator : ",")) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// 解析形如 "s0_1_2" 的变量名
+static bool ConsumeSampleVar(std::string_view& str, uint32_t& group, uint32_t& row, uint32_t& col) noexcept {
+	return ConsumePrefix(str, "s") && ConsumeNumber(str, group) &&
+		ConsumePrefix(str, "_") && ConsumeNumber(str, row) &&
+		ConsumePrefix(str, "_") && ConsumeNumber(str, col) &&
+		group < MAX_GROUPS && row < 3 && col < 3;
+}
+
+// 解析 CuNNy 中形如 "s0_5" 的变量名，5 为 3x3 邻域中按行排列的序号
+static bool ConsumeTapVar(std::string_view& str, uint32_t& group, uint32_t& tap) noexcept {
+	return ConsumePrefix(str, "s") && ConsumeNumber(str, group) &&
+		ConsumePrefix(str, "_") && ConsumeNumber(str, tap) &&
+		group < MAX_GROUPS && tap < TAP_COUNT;
+}
+
+// 解析形如 "r0" 的变量名
+static bool ConsumeResultVar(std::string_view& str, uint32_t& group) noexcept {
+	return ConsumePrefix(str, "r") && ConsumeNumber(str, group) && group < MAX_GROUPS;
+}
+
+// 解析亮度输入的定义中 "dot(MF3(w0, w1, w2), O(...).rgb) + MF(b)" 的部分，没有偏置时为 0
+static bool ConsumeLumaWeights(std::string_view def, float4& weights, float& bias) noexcept {
+	const size_t dotPos = def.find("dot(");
+	if (dotPos == std::string_view::npos) {
+		return false;
+	}
+	def.remove_prefix(dotPos + 4);
+
+	// MF3 或 float3
+	std::string_view typeName;
+	float values[3];
+	if (!ConsumeIdentifier(def, typeName) || !ConsumePrefix(def, "(") || !ConsumeFloats(def, values, 3)) {
+		return false;
+	}
+	weights = float4(values[0], values[1], values[2], 0.0f);
+
+	const size_t rgbPos = def.find(".rgb)");
+	if (rgbPos == std::string_view::npos) {
+		return false;
+	}
+	def.remove_prefix(rgbPos + 5);
+
+	bias = 0.0f;
+	if (!ConsumePrefix(def, "+")) {
+		return true;
+	}
+	ConsumePrefix(def, "MF(");
+	return ConsumeNumber(def, bias);
+}
+
+static uint32_t FindTexture(const std::vector<std::string_view>& textureNames, std::string_view name) noexcept {
+	if (name == "INPUT") {
+		return INPUT_TEXTURE;
+	}
+
+	auto it = std::find(textureNames.begin(), textureNames.end(), name);
+	return it == textureNames.end() ? INVALID_TEXTURE : uint32_t(it - textureNames.begin());
+}
+
+bool CuNNyCpu::Load(std::string_view source, bool halfWeights) noexcept {
+	_passes.clear();
+	_textureFormats.clear();
+	for (auto& shuffle : _shuffle) {
+		shuffle.clear();
+	}
+
+	// 失败时保持未加载状态
+	bool success = false;
+	try {
+		// CuNNy 的输入定义为 l0、l1……，CuNNy2 为 L0、L1……
+		success = source.find("#define l0(") == std::string_view::npos ? _Parse(source) : _ParseV1(source);
+
+		if (success && halfWeights) {
+			for (_Pass& pass : _passes) {
+				pass.halfConvs.reserve(pass.convs.size());
+				for (const _Conv& conv : pass.convs) {
+					_HalfConv& halfConv = pass.halfConvs.emplace_back();
+					halfConv.output = conv.output;
+					halfConv.input = conv.input;
+					halfConv.offsetX = conv.offsetX;
+					halfConv.offsetY = conv.offsetY;
+					halfConv.rowCount = conv.rowCount;
+					for (uint32_t row = 0; row < 4; ++row) {
+						for (uint32_t c = 0; c < 4; ++c) {
+							halfConv.weights[row][c] = FloatToHalf(conv.weights[row][c]);
+						}
+					}
+				}
+
+				pass.convs.clear();
+				pass.convs.shrink_to_fit();
+			}
+		}
+	} catch (const std::bad_alloc&) {
+		success = false;
+	}
+
+	if (!success) {
+		_passes.clear();
+	}
+	return success;
+}
+
+bool CuNNyCpu::_Parse(std::string_view source) {
+	// 中间纹理的名字，索引即纹理编号
+	std::vector<std::string_view> textureNames;
+
+	// sN_i_j 当前的值来自哪个输入以及偏移
+	struct SampleVar {
+		uint8_t input = 0;
+		int8_t offsetX = 0;
+		int8_t offsetY = 0;
+		bool isValid = false;
+	};
+	SampleVar sampleVars[MAX_GROUPS][3][3]{};
+
+	std::string_view lastFormat;
+	bool hasOutputPass = false;
+
+	for (std::string_view line : Split(source, '\n')) {
+		Trim(line);
+		if (line.empty()) {
+			continue;
+		}
+
+		if (line.starts_with("//!")) {
+			std::string_view directive = line.substr(3);
+
+			if (ConsumePrefix(directive, "FORMAT")) {
+				RemoveLeadingBlanks(directive);
+				lastFormat = directive;
+			} else if (ConsumePrefix(directive, "PASS")) {
+				if (hasOutputPass) {
+					return false;
+				}
+
+				_passes.emplace_back();
+				for (auto& group : sampleVars) {
+					for (auto& row : group) {
+						for (SampleVar& var : row) {
+							var.isValid = false;
+						}
+					}
+				}
+			} else if (ConsumePrefix(directive, "OUT") && !_passes.empty()) {
+				for (std::string_view name : Split(directive, ',')) {
+					Trim(name);
+					if (name == "OUTPUT") {
+						hasOutputPass = true;
+					}
+				}
+			}
+
+			continue;
+		}
+
+		if (line.starts_with("Texture2D ")) {
+			std::string_view name = line.substr(10);
+			if (!name.ends_with(';')) {
+				continue;
+			}
+			name.remove_suffix(1);
+			Trim(name);
+
+			if (name != "INPUT" && name != "OUTPUT") {
+				if (lastFormat != "R8G8B8A8_UNORM") {
+					return false;
+				}
+				textureNames.push_back(name);
+				_textureFormats.push_back(_TextureFormat::UNorm8);
+			}
+			lastFormat = {};
+			continue;
+		}
+
+		if (_passes.empty()) {
+			continue;
+		}
+
+		_Pass& pass = _passes.back();
+
+		// #define L0(x, y) V4(O(T0, x, y))
+		if (line.starts_with("#define L")) {
+			std::string_view def = line.substr(9);
+			uint32_t inputIdx;
+			if (!ConsumeNumber(def, inputIdx) || inputIdx != pass.inputs.size() || inputIdx >= MAX_GROUPS) {
+				return false;
+			}
+
+			const size_t pos = def.find("O(");
+			if (pos == std::string_view::npos) {
+				return false;
+			}
+
+			std::string_view texName = def.substr(pos + 2);
+			texName = texName.substr(0, texName.find(','));
+			Trim(texName);
+
+			_PassInput& input = pass.inputs.emplace_back();
+			input.texture = FindTexture(textureNames, texName);
+			if (input.texture == INVALID_TEXTURE) {
+				return false;
+			}
+
+			if (def.find("dot(") != std::string_view::npos) {
+				input.type = _InputType::Luma;
+				if (!ConsumeLumaWeights(def, input.lumaWeights, input.lumaBias)) {
+					return false;
+				}
+			} else if (def.find(".rgb") != std::string_view::npos) {
+				input.type = _InputType::RGB;
+			} else {
+				input.type = _InputType::RGBA;
+			}
+
+			if (input.type != _InputType::RGBA && input.texture != INPUT_TEXTURE) {
+				return false;
+			}
+			continue;
+		}
+
+		for (std::string_view stmt : Split(line, ';')) {
+			Trim(stmt);
+			if (stmt.empty()) {
+				continue;
+			}
+
+			if (stmt.size() > 1 && stmt[0] == 's' && IsDigit(stmt[1])) {
+				// s0_0_0 = L0(-1.0, -1.0)
+				uint32_t group, row, col, inputIdx;
+				float offsetX, offsetY;
+				if (!ConsumeSampleVar(stmt, group, row, col) || !ConsumePrefix(stmt, "=") ||
+					!ConsumePrefix(stmt, "L") || !ConsumeNumber(stmt, inputIdx) ||
+					!ConsumePrefix(stmt, "(") || !ConsumeNumber(stmt, offsetX) ||
+					!ConsumePrefix(stmt, ",") || !ConsumeNumber(stmt, offsetY) || !ConsumePrefix(stmt, ")")) {
+					return false;
+				}
+
+				if (inputIdx >= pass.inputs.size() || std::abs(offsetX) > 1 || std::abs(offsetY) > 1) {
+					return false;
+				}
+
+				sampleVars[group][row][col] = {
+					.input = (uint8_t)inputIdx,
+					.offsetX = (int8_t)std::lroundf(offsetX),
+					.offsetY = (int8_t)std::lroundf(offsetY),
+					.isValid = true
+				};
+			} else if (stmt.size() > 1 && stmt[0] == 'r' && IsDigit(stmt[1])) {
+				uint32_t group;
+				if (!ConsumeResultVar(stmt, group) || !ConsumePrefix(stmt, "=")) {
+					return false;
+				}
+
+				if (pass.biases.size() <= group) {
+					pass.biases.resize(group + 1, float4{});
+				}
+
+				if (ConsumePrefix(stmt, "V4(")) {
+					// r0 = V4(...)
+					float values[4];
+					if (!ConsumeFloats(stmt, values, 4)) {
+						return false;
+					}
+					pass.biases[group] = { values[0], values[1], values[2], values[3] };
+				} else if (ConsumePrefix(stmt, "max(")) {
+					// r0 = max(r0, 0.0)
+					uint32_t group1;
+					if (!ConsumeResultVar(stmt, group1) || group1 != group) {
+						return false;
+					}
+					pass.reluMask |= 1u << group;
+				} else {
+					// r0 = mad(s0_0_0, V4(...), r0)
+					// r0 = MulAdd(s0_0_0, M4(...), r0)
+					_Conv& conv = pass.convs.emplace_back();
+					conv.output = (uint8_t)group;
+
+					uint32_t sGroup, row, col;
+					uint32_t valueCount = 0;
+					if (ConsumePrefix(stmt, "mad(")) {
+						if (!ConsumeSampleVar(stmt, sGroup, row, col) ||
+							!ConsumePrefix(stmt, ",") || !ConsumePrefix(stmt, "V4(")) {
+							return false;
+						}
+						valueCount = 4;
+					} else if (ConsumePrefix(stmt, "MulAdd(")) {
+						if (!ConsumeSampleVar(stmt, sGroup, row, col) || !ConsumePrefix(stmt, ",")) {
+							return false;
+						}
+
+						if (ConsumePrefix(stmt, "M4(")) {
+							valueCount = 16;
+						} else if (ConsumePrefix(stmt, "M3x4(")) {
+							valueCount = 12;
+						} else {
+							return false;
+						}
+					} else {
+						return false;
+					}
+
+					const SampleVar& var = sampleVars[sGroup][row][col];
+					if (!var.isValid) {
+						return false;
+					}
+
+					conv.input = var.input;
+					conv.offsetX = var.offsetX;
+					conv.offsetY = var.offsetY;
+					conv.rowCount = uint8_t(valueCount / 4);
+
+					// 输入的分量数必须和矩阵的行数一致
+					const _InputType inputType = pass.inputs[var.input].type;
+					if ((inputType == _InputType::Luma) != (conv.rowCount == 1) ||
+						(inputType == _InputType::RGB) != (conv.rowCount == 3)) {
+						return false;
+					}
+
+					// HLSL 的矩阵构造函数按行排列，mul(x, M) 的第 i 行和 x 的第 i 个分量相乘
+					float values[16];
+					if (!ConsumeFloats(stmt, values, valueCount)) {
+						return false;
+					}
+					std::memcpy(conv.weights, values, sizeof(float) * valueCount);
+
+					uint32_t group1;
+					if (!ConsumePrefix(stmt, ",") || !ConsumeResultVar(stmt, group1) || group1 != group) {
+						return false;
+					}
+				}
+			} else if (stmt.starts_with("OUTPUT[gxy + int2(")) {
+				// OUTPUT[gxy + int2(1, 0)] = ... r0.y ...
+				stmt.remove_prefix(18);
+				uint32_t dx, dy;
+				if (!ConsumeNumber(stmt, dx) || !ConsumePrefix(stmt, ",") ||
+					!ConsumeNumber(stmt, dy) || !ConsumePrefix(stmt, ")]") || dx > 1 || dy > 1) {
+					return false;
+				}
+
+				auto& shuffle = _shuffle[dy * 2 + dx];
+				while (true) {
+					// 残差分量形如 " r0.x" 或 "(r0.x"
+					const size_t pos = std::min(stmt.find(" r"), stmt.find("(r"));
+					if (pos == std::string_view::npos) {
+						break;
+					}
+					stmt.remove_prefix(pos + 1);
+
+					uint32_t group;
+					if (!ConsumeResultVar(stmt, group) || !ConsumePrefix(stmt, ".") || stmt.empty()) {
+						return false;
+					}
+
+					const size_t component = std::string_view("xyzw").find(stmt[0]);
+					if (component == std::string_view::npos) {
+						return false;
+					}
+
+					shuffle.emplace_back((uint8_t)group, (uint8_t)component);
+				}
+
+				if (shuffle.size() != 1 && shuffle.size() != 3) {
+					return false;
+				}
+			} else {
+				// T0[gxy] = r0
+				std::string_view texName;
+				if (!ConsumeIdentifier(stmt, texName) || !ConsumePrefix(stmt, "[gxy]")) {
+					// 其他语句
+					continue;
+				}
+
+				uint32_t group;
+				if (!ConsumePrefix(stmt, "=") || !ConsumeResultVar(stmt, group)) {
+					return false;
+				}
+
+				const uint32_t texture = FindTexture(textureNames, texName);
+				if (texture >= textureNames.size()) {
+					return false;
+				}
+
+				if (pass.outputs.size() <= group) {
+					pass.outputs.resize(group + 1, INPUT_TEXTURE);
+				}
+				pass.outputs[group] = texture;
+			}
+		}
+	}
+
+	return hasOutputPass && _Validate();
+}
+
+bool CuNNyCpu::_ParseV1(std::string_view source) {
+	// 中间纹理的名字，索引即纹理编号
+	std::vector<std::string_view> textureNames;
+
+	// sN_i 当前的值来自哪个 lN 以及经过的激活函数
+	struct SampleVar {
+		uint8_t define = 0;
+		_Activation activation = _Activation::None;
+		bool isValid = false;
+	};
+	SampleVar sampleVars[MAX_GROUPS][TAP_COUNT]{};
+	// 当前通道的 l0、l1……
+	std::vector<_PassInput> defines;
+
+	// 正在解析的 fN 的 N，不在函数中时为 MAX_GROUPS。fN 计算第 N 组输出
+	uint32_t curFunc = MAX_GROUPS;
+	uint32_t funcMask = 0;
+	uint32_t tanhMask = 0;
+
+	// 最后一个通道中 V4 r = fN(...) 的 N，以及写入 OUTPUT 的位置相对于左上角的偏移
+	uint32_t residualGroup = MAX_GROUPS;
+	uint32_t outputX = 0;
+	uint32_t outputY = 0;
+
+	std::string_view lastFormat;
+	bool hasOutputPass = false;
+
+	// 函数在通道的主体之前，通道结束时才能确定卷积的每组输入来自哪个纹理
+	auto finishPass = [&]() -> bool {
+		if (_passes.empty()) {
+			return true;
+		}
+
+		_Pass& pass = _passes.back();
+		if (curFunc != MAX_GROUPS || (tanhMask != 0 && tanhMask != funcMask)) {
+			return false;
+		}
+		pass.useTanh = tanhMask != 0;
+
+		uint32_t groupCount = 0;
+		for (const _Conv& conv : pass.convs) {
+			groupCount = std::max(groupCount, conv.input + 1u);
+		}
+
+		for (uint32_t i = 0; i < groupCount; ++i) {
+			const SampleVar& first = sampleVars[i][0];
+			if (!std::all_of(std::begin(sampleVars[i]), std::end(sampleVars[i]), [&](const SampleVar& var) {
+				return var.isValid && var.define == first.define && var.activation == first.activation;
+			})) {
+				return false;
+			}
+
+			_PassInput& input = pass.inputs.emplace_back(defines[first.define]);
+			input.activation = first.activation;
+		}
+
+		// 输入的分量数必须和矩阵的行数一致
+		return std::all_of(pass.convs.begin(), pass.convs.end(), [&](const _Conv& conv) {
+			return (pass.inputs[conv.input].type == _InputType::Luma) == (conv.rowCount == 1);
+		});
+	};
+
+	for (std::string_view line : Split(source, '\n')) {
+		Trim(line);
+		if (line.empty()) {
+			continue;
+		}
+
+		if (line.starts_with("//!")) {
+			std::string_view directive = line.substr(3);
+
+			if (ConsumePrefix(directive, "FORMAT")) {
+				RemoveLeadingBlanks(directive);
+				lastFormat = directive;
+			} else if (ConsumePrefix(directive, "PASS")) {
+				if (hasOutputPass || !finishPass()) {
+					return false;
+				}
+
+				_passes.emplace_back();
+				for (auto& group : sampleVars) {
+					for (SampleVar& var : group) {
+						var.isValid = false;
+					}
+				}
+				defines.clear();
+				funcMask = 0;
+				tanhMask = 0;
+			} else if (ConsumePrefix(directive, "OUT") && !_passes.empty()) {
+				for (std::string_view name : Split(directive, ',')) {
+					Trim(name);
+					if (name == "OUTPUT") {
+						hasOutputPass = true;
+					}
+				}
+			}
+
+			continue;
+		}
+
+		if (line.starts_with("Texture2D ")) {
+			std::string_view name = line.substr(10);
+			if (!name.ends_with(';')) {
+				continue;
+			}
+			name.remove_suffix(1);
+			Trim(name);
+
+			if (name != "INPUT" && name != "OUTPUT") {
+				if (lastFormat != "R8G8B8A8_SNORM") {
+					return false;
+				}
+				textureNames.push_back(name);
+				_textureFormats.push_back(_TextureFormat::SNorm8);
+			}
+			lastFormat = {};
+			continue;
+		}
+
+		if (_passes.empty()) {
+			continue;
+		}
+
+		_Pass& pass = _passes.back();
+
+		// #define l0(x, y) V4(O(t0, float2(x, y)))
+		// #define l0(x, y) (dot(MF3(w0, w1, w2), O(INPUT, float2(x, y)).rgb) + MF(b))
+		if (line.starts_with("#define l")) {
+			std::string_view def = line.substr(9);
+			uint32_t defIdx;
+			if (!ConsumeNumber(def, defIdx) || defIdx != defines.size() || defIdx >= MAX_GROUPS) {
+				return false;
+			}
+
+			const size_t pos = def.find("O(");
+			if (pos == std::string_view::npos) {
+				return false;
+			}
+
+			std::string_view texName = def.substr(pos + 2);
+			texName = texName.substr(0, texName.find(','));
+			Trim(texName);
+
+			_PassInput& input = defines.emplace_back();
+			input.texture = FindTexture(textureNames, texName);
+			if (input.texture == INVALID_TEXTURE) {
+				return false;
+			}
+
+			if (def.find("dot(") != std::string_view::npos) {
+				input.type = _InputType::Luma;
+				if (!ConsumeLumaWeights(def, input.lumaWeights, input.lumaBias)) {
+					return false;
+				}
+			} else {
+				input.type = _InputType::RGBA;
+			}
+
+			if ((input.type == _InputType::Luma) != (input.texture == INPUT_TEXTURE)) {
+				return false;
+			}
+			continue;
+		}
+
+		// V4 f0(V4 s0_0, ...) {
+		if (line.starts_with("V4 f")) {
+			std::string_view decl = line.substr(4);
+			uint32_t group;
+			if (!ConsumeNumber(decl, group) || group >= MAX_GROUPS ||
+				curFunc != MAX_GROUPS || (funcMask & (1u << group))) {
+				return false;
+			}
+
+			curFunc = group;
+			funcMask |= 1u << group;
+			if (pass.biases.size() <= group) {
+				pass.biases.resize(group + 1, float4{});
+			}
+			continue;
+		}
+
+		for (std::string_view stmt : Split(line, ';')) {
+			Trim(stmt);
+			if (stmt.empty()) {
+				continue;
+			}
+
+			if (curFunc != MAX_GROUPS) {
+				if (stmt.starts_with("return")) {
+					// return r 或 return tanh(r)
+					if (stmt.find("tanh(") != std::string_view::npos) {
+						tanhMask |= 1u << curFunc;
+					}
+					curFunc = MAX_GROUPS;
+				} else if (ConsumePrefix(stmt, "V4 r =")) {
+					// V4 r = { b0, b1, b2, b3 } 或 V4 r = V4(b0, b1, b2, b3)
+					float values[4];
+					if (ConsumePrefix(stmt, "{")) {
+						if (!ConsumeFloats(stmt, values, 4, "}")) {
+							return false;
+						}
+					} else if (!ConsumePrefix(stmt, "V4(") || !ConsumeFloats(stmt, values, 4)) {
+						return false;
+					}
+					pass.biases[curFunc] = { values[0], values[1], values[2], values[3] };
+				} else if (ConsumePrefix(stmt, "r =")) {
+					// r = mad(s0_0, V4(...), r)
+					// r = mad(V4(...), s0_0, r)
+					// r = MulAdd(s0_0, M4(...), r)
+					uint32_t sGroup, tap;
+					uint32_t valueCount = 0;
+					float values[16];
+					if (ConsumePrefix(stmt, "mad(")) {
+						valueCount = 4;
+						if (ConsumePrefix(stmt, "V4(")) {
+							if (!ConsumeFloats(stmt, values, 4) || !ConsumePrefix(stmt, ",") ||
+								!ConsumeTapVar(stmt, sGroup, tap)) {
+								return false;
+							}
+						} else if (!ConsumeTapVar(stmt, sGroup, tap) || !ConsumePrefix(stmt, ",") ||
+							!ConsumePrefix(stmt, "V4(") || !ConsumeFloats(stmt, values, 4)) {
+							return false;
+						}
+					} else if (ConsumePrefix(stmt, "MulAdd(")) {
+						valueCount = 16;
+						if (!ConsumeTapVar(stmt, sGroup, tap) || !ConsumePrefix(stmt, ",") ||
+							!ConsumePrefix(stmt, "M4(") || !ConsumeFloats(stmt, values, 16)) {
+							return false;
+						}
+					} else {
+						return false;
+					}
+
+					if (!ConsumePrefix(stmt, ",") || !ConsumePrefix(stmt, "r)")) {
+						return false;
+					}
+
+					_Conv& conv = pass.convs.emplace_back();
+					conv.output = (uint8_t)curFunc;
+					conv.input = (uint8_t)sGroup;
+					conv.offsetX = int8_t(tap % 3) - 1;
+					conv.offsetY = int8_t(tap / 3) - 1;
+					conv.rowCount = uint8_t(valueCount / 4);
+					std::memcpy(conv.weights, values, sizeof(float) * valueCount);
+				}
+				continue;
+			}
+
+			if (stmt.starts_with("MF s") || stmt.starts_with("V4 s")) {
+				stmt.remove_prefix(3);
+
+				uint32_t group, tap;
+				if (!ConsumeTapVar(stmt, group, tap) || !ConsumePrefix(stmt, "=")) {
+					return false;
+				}
+
+				if (ConsumePrefix(stmt, "-max(-")) {
+					// V4 s1_0 = -max(-s0_0, 0.0)，负的部分。必须在 s0_0 取正的部分之前
+					uint32_t group1, tap1;
+					if (!ConsumeTapVar(stmt, group1, tap1) || tap1 != tap) {
+						return false;
+					}
+
+					const SampleVar& var = sampleVars[group1][tap];
+					if (!var.isValid || var.activation != _Activation::None) {
+						return false;
+					}
+					sampleVars[group][tap] = { var.define, _Activation::Negative, true };
+				} else {
+					// V4 s0_0 = l0(-1.0, -1.0)
+					uint32_t defIdx;
+					float offsetX, offsetY;
+					if (!ConsumePrefix(stmt, "l") || !ConsumeNumber(stmt, defIdx) ||
+						!ConsumePrefix(stmt, "(") || !ConsumeNumber(stmt, offsetX) ||
+						!ConsumePrefix(stmt, ",") || !ConsumeNumber(stmt, offsetY) || !ConsumePrefix(stmt, ")")) {
+						return false;
+					}
+
+					// 序号必须和偏移一致
+					if (defIdx >= defines.size() || std::lroundf(offsetX) != int(tap % 3) - 1 ||
+						std::lroundf(offsetY) != int(tap / 3) - 1) {
+						return false;
+					}
+					sampleVars[group][tap] = { (uint8_t)defIdx, _Activation::None, true };
+				}
+			} else if (stmt.size() > 1 && stmt[0] == 's' && IsDigit(stmt[1])) {
+				// s0_0 = max(s0_0, 0.0)，正的部分
+				uint32_t group, tap, group1, tap1;
+				if (!ConsumeTapVar(stmt, group, tap) || !ConsumePrefix(stmt, "=") || !ConsumePrefix(stmt, "max(") ||
+					!ConsumeTapVar(stmt, group1, tap1) || group1 != group || tap1 != tap) {
+					return false;
+				}
+
+				SampleVar& var = sampleVars[group][tap];
+				if (!var.isValid || var.activation != _Activation::None) {
+					return false;
+				}
+				var.activation = _Activation::Positive;
+			} else if (stmt == "++gxy.x" || stmt == "--gxy.x") {
+				stmt[0] == '+' ? ++outputX : --outputX;
+			} else if (stmt == "++gxy.y" || stmt == "--gxy.y") {
+				stmt[0] == '+' ? ++outputY : --outputY;
+			} else if (stmt.starts_with("OUTPUT[gxy]")) {
+				// OUTPUT[gxy] = MF4(mul(yuv2rgb, MF3(saturate(yuv.r + r.x), yuv.yz)), 1)
+				const size_t pos = stmt.find(" r.");
+				if (residualGroup == MAX_GROUPS || outputX > 1 || outputY > 1 ||
+					pos == std::string_view::npos || pos + 3 >= stmt.size()) {
+					return false;
+				}
+
+				const size_t component = std::string_view("xyzw").find(stmt[pos + 3]);
+				if (component == std::string_view::npos) {
+					return false;
+				}
+
+				_shuffle[outputY * 2 + outputX].emplace_back((uint8_t)residualGroup, (uint8_t)component);
+			} else if (ConsumePrefix(stmt, "V4 r =")) {
+				// V4 r = f0(...)
+				if (!ConsumePrefix(stmt, "f") || !ConsumeNumber(stmt, residualGroup) || residualGroup >= MAX_GROUPS) {
+					return false;
+				}
+			} else {
+				// t0[gxy] = f0(...)
+				std::string_view texName;
+				if (!ConsumeIdentifier(stmt, texName) || !ConsumePrefix(stmt, "[gxy]")) {
+					// 其他语句
+					continue;
+				}
+
+				uint32_t group;
+				if (!ConsumePrefix(stmt, "=") || !ConsumePrefix(stmt, "f") ||
+					!ConsumeNumber(stmt, group) || group >= MAX_GROUPS) {
+					return false;
+				}
+
+				const uint32_t texture = FindTexture(textureNames, texName);
+				if (texture >= textureNames.size()) {
+					return false;
+				}
+
+				if (pass.outputs.size() <= group) {
+					pass.outputs.resize(group + 1, INPUT_TEXTURE);
+				}
+				pass.outputs[group] = texture;
+			}
+		}
+	}
+
+	return hasOutputPass && finishPass() && _Validate();
+}
+
+bool CuNNyCpu::_Validate() {
+	const auto& lastShuffle = _shuffle[0];
+	if (_passes.size() < 2 || lastShuffle.empty() ||
+		std::any_of(std::begin(_shuffle), std::end(_shuffle),
+			[&](const auto& shuffle) { return shuffle.size() != lastShuffle.size(); })) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < _passes.size(); ++i) {
+		_Pass& pass = _passes[i];
+		const bool isLast = i + 1 == _passes.size();
+
+		for (const _Conv& conv : pass.convs) {
+			if (pass.biases.size() <= conv.output) {
+				pass.biases.resize(conv.output + 1, float4{});
+			}
+		}
+
+		const bool isValid = !pass.convs.empty() && (isLast ? pass.outputs.empty()
+			: pass.outputs.size() == pass.biases.size() &&
+			std::find(pass.outputs.begin(), pass.outputs.end(), INPUT_TEXTURE) == pass.outputs.end());
+		if (!isValid) {
+			return false;
+		}
+	}
+
+	for (const auto& shuffle : _shuffle) {
+		for (const auto& [group, component] : shuffle) {
+			if (group >= _passes.back().biases.size()) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static float4 QuantizeUNorm8(const float4& value) noexcept {
+	// 和写入 R8G8B8A8_UNORM 纹理相同
+	return Floor(Saturate(value) * 255.0f + float4(0.5f)) * (1 / 255.0f);
+}
+
+static float4 QuantizeSNorm8(const float4& value) noexcept {
+	// 和写入 R8G8B8A8_SNORM 纹理相同，不会产生 -128
+	return Floor(Clamp(value, float4(-1.0f), float4(1.0f)) * 127.0f + float4(0.5f)) * (1 / 127.0f);
+}
+
+static float4 Tanh(const float4& value) noexcept {
+	return { std::tanh(value.x), std::tanh(value.y), std::tanh(value.z), std::tanh(value.w) };
+}
+
+static float4 LoadWeightRow(const CuNNyConv& conv, uint32_t row) noexcept {
+	const float* weights = conv.weights[row];
+	return { weights[0], weights[1], weights[2], weights[3] };
+}
+
+static float4 LoadWeightRow(const CuNNyHalfConv& conv, uint32_t row) noexcept {
+	const uint16_t* weights = conv.weights[row];
+	return { HalfToFloat(weights[0]), HalfToFloat(weights[1]), HalfToFloat(weights[2]), HalfToFloat(weights[3]) };
+}
+
+// 可移植的实现，和 AVX2 核一样逐行累加 sample[row] * weights[row]
+template <typename Conv>
+static void Accumulate(const std::vector<Conv>& convs, const float4 (*samples)[3][3], float4* results) noexcept {
+	for (const Conv& conv : convs) {
+		const float* sample = &samples[conv.input][conv.offsetY + 1][conv.offsetX + 1].x;
+		float4& result = results[conv.output];
+
+		for (uint32_t row = 0; row < conv.rowCount; ++row) {
+			result = float4(sample[row]) * LoadWeightRow(conv, row) + result;
+		}
+	}
+}
+
+float4 CuNNyCpu::_ReadInput(
+	const _PassInput& input,
+	const PaddedImage& image,
+	const std::vector<std::vector<float4>>& textures,
+	int width,
+	int height,
+	int x,
+	int y
+) noexcept {
+	float4 value;
+	if (input.texture == INPUT_TEXTURE) {
+		const float4& color = image.Texel(x, y);
+		value = input.type == _InputType::Luma ? float4(Dot3(color, input.lumaWeights) + input.lumaBias) : color;
+	} else {
+		const int sx = std::clamp(x, 0, width - 1);
+		const int sy = std::clamp(y, 0, height - 1);
+		value = textures[input.texture][(size_t)sy * width + sx];
+	}
+
+	switch (input.activation) {
+	case _Activation::Positive:
+		return Max(value, float4());
+	case _Activation::Negative:
+		return Min(value, float4());
+	default:
+		return value;
+	}
+}
+
+void CuNNyCpu::_Evaluate(
+	const _Pass& pass,
+	const PaddedImage& image,
+	const std::vector<std::vector<float4>>& textures,
+	int width,
+	int height,
+	int x,
+	int y,
+	float4* results
+) noexcept {
+	// 预先读取所有输入的 3x3 邻域
+	float4 samples[MAX_GROUPS][3][3];
+	for (uint32_t i = 0; i < pass.inputs.size(); ++i) {
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				samples[i][dy + 1][dx + 1] = _ReadInput(pass.inputs[i], image, textures, width, height, x + dx, y + dy);
+			}
+		}
+	}
+
+	const uint32_t groupCount = (uint32_t)pass.biases.size();
+	for (uint32_t i = 0; i < groupCount; ++i) {
+		results[i] = pass.biases[i];
+	}
+
+	if (pass.halfConvs.empty()) {
+		Accumulate(pass.convs, samples, results);
+	} else {
+		Accumulate(pass.halfConvs, samples, results);
+	}
+
+	for (uint32_t i = 0; i < groupCount; ++i) {
+		if (pass.reluMask & (1u << i)) {
+			results[i] = Max(results[i], float4());
+		}
+		if (pass.useTanh) {
+			results[i] = Tanh(results[i]);
+		}
+	}
+}
+
+void CuNNyCpu::_EvaluateAvx2(
+	const _Pass& pass,
+	const PaddedImage& image,
+	const std::vector<std::vector<float4>>& textures,
+	int width,
+	int height,
+	int x,
+	int y,
+	float4 (*results)[CUNNY_MAX_GROUPS]
+) noexcept {
+	constexpr uint32_t BATCH = CUNNY_BATCH_SIZE;
+
+	// 转置为 [输入][3x3 邻域][分量][像素]，使 AVX2 核的每个寄存器保存 8 个像素的同一个分量
+	alignas(32) float samples[MAX_GROUPS][9][4][BATCH];
+	for (uint32_t i = 0; i < pass.inputs.size(); ++i) {
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				float (&tap)[4][BATCH] = samples[i][(dy + 1) * 3 + dx + 1];
+				for (uint32_t p = 0; p < BATCH; ++p) {
+					const float4 sample = _ReadInput(pass.inputs[i], image, textures, width, height, x + p + dx, y + dy);
+					tap[0][p] = sample.x;
+					tap[1][p] = sample.y;
+					tap[2][p] = sample.z;
+					tap[3][p] = sample.w;
+				}
+			}
+		}
+	}
+
+	const uint32_t groupCount = (uint32_t)pass.biases.size();
+	alignas(32) float soaResults[MAX_GROUPS][4][BATCH];
+	if (pass.halfConvs.empty()) {
+		CuNNyEvaluateAvx2(pass.convs.data(), pass.convs.size(), &pass.biases[0].x,
+			groupCount, pass.reluMask, &samples[0][0][0][0], &soaResults[0][0][0]);
+	} else {
+		CuNNyEvaluateAvx2(pass.halfConvs.data(), pass.halfConvs.size(), &pass.biases[0].x,
+			groupCount, pass.reluMask, &samples[0][0][0][0], &soaResults[0][0][0]);
+	}
+
+	for (uint32_t p = 0; p < BATCH; ++p) {
+		for (uint32_t i = 0; i < groupCount; ++i) {
+			const float4 result(soaResults[i][0][p], soaResults[i][1][p], soaResults[i][2][p], soaResults[i][3][p]);
+			// 和可移植的实现相同，使用标准库的 tanh
+			results[p][i] = pass.useTanh ? Tanh(result) : result;
+		}
+	}
+}
+
+bool CuNNyCpu::Scale(
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest
+) const noexcept {
+	if (!IsLoaded()) {
+		return false;
+	}
+
+	const uint32_t destWidth = srcWidth * 2;
+	const uint32_t destHeight = srcHeight * 2;
+	if (srcWidth == 0 || srcHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	PaddedImage image;
+	if (!image.Initialize(src, srcWidth, srcHeight)) {
+		return false;
+	}
+
+	std::vector<std::vector<float4>> textures(_textureFormats.size());
+	try {
+		for (std::vector<float4>& texture : textures) {
+			texture.resize((size_t)srcWidth * srcHeight);
+		}
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	const int width = (int)srcWidth;
+	const int height = (int)srcHeight;
+	const uint32_t bandCount = (srcHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	// 每行末尾不足一批的像素使用可移植的实现
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+
+	// 除最后一个通道外每个通道都读取上一个通道的全部输出，因此逐个通道执行，通道内按行划分条带并行
+	for (size_t passIdx = 0; passIdx + 1 < _passes.size(); ++passIdx) {
+		const _Pass& pass = _passes[passIdx];
+
+		ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+			const int beginRow = int(bandIdx * ROWS_PER_BAND);
+			const int endRow = std::min(beginRow + (int)ROWS_PER_BAND, height);
+
+			float4 results[CUNNY_BATCH_SIZE][MAX_GROUPS];
+			for (int y = beginRow; y < endRow; ++y) {
+				for (int x = 0; x < width;) {
+					const int batchSize = useAvx2 && x + (int)CUNNY_BATCH_SIZE <= width ? CUNNY_BATCH_SIZE : 1;
+					if (batchSize > 1) {
+						_EvaluateAvx2(pass, image, textures, width, height, x, y, results);
+					} else {
+						_Evaluate(pass, image, textures, width, height, x, y, results[0]);
+					}
+
+					for (int p = 0; p < batchSize; ++p, ++x) {
+						for (uint32_t i = 0; i < pass.outputs.size(); ++i) {
+							const uint32_t texture = pass.outputs[i];
+							textures[texture][(size_t)y * width + x] = _textureFormats[texture] == _TextureFormat::SNorm8 ?
+								QuantizeSNorm8(results[p][i]) : QuantizeUNorm8(results[p][i]);
+						}
+					}
+				}
+			}
+		});
+	}
+
+	// 最后一个通道：每个输入像素输出 2x2 个像素，残差叠加到 LINEAR 采样的输入上
+	const _Pass& lastPass = _passes.back();
+	const bool isLumaResidual = _shuffle[0].size() == 1;
+
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const int beginRow = int(bandIdx * ROWS_PER_BAND);
+		const int endRow = std::min(beginRow + (int)ROWS_PER_BAND, height);
+
+		float4 results[CUNNY_BATCH_SIZE][MAX_GROUPS];
+		for (int y = beginRow; y < endRow; ++y) {
+			for (int batchBegin = 0; batchBegin < width;) {
+				const int batchSize = useAvx2 && batchBegin + (int)CUNNY_BATCH_SIZE <= width ? CUNNY_BATCH_SIZE : 1;
+				if (batchSize > 1) {
+					_EvaluateAvx2(lastPass, image, textures, width, height, batchBegin, y, results);
+				} else {
+					_Evaluate(lastPass, image, textures, width, height, batchBegin, y, results[0]);
+				}
+
+				for (int p = 0; p < batchSize; ++p) {
+					const int x = batchBegin + p;
+					const float4* residuals = results[p];
+
+					for (uint32_t i = 0; i < 4; ++i) {
+						const uint32_t dx = i & 1;
+						const uint32_t dy = i >> 1;
+						// 输出像素的中心在输入图像中的位置
+						const float4 color = image.Sample(x + (dx + 0.5f) * 0.5f, y + (dy + 0.5f) * 0.5f);
+
+						auto getResidual = [&](uint32_t j) {
+							const auto [group, component] = _shuffle[i][j];
+							return (&residuals[group].x)[component];
+						};
+
+						float4 result;
+						if (isLumaResidual) {
+							const float luma = std::clamp(
+								Dot3(RY[0], color) + getResidual(0), 0.0f, 1.0f);
+							const float4 yuv = float4(luma, Dot3(RY[1], color), Dot3(RY[2], color), 0.0f);
+							result = float4(Dot3(YR[0], yuv), Dot3(YR[1], yuv), Dot3(YR[2], yuv), 1.0f);
+						} else {
+							const float4 residual = float4(getResidual(0), getResidual(1), getResidual(2), 0.0f);
+							result = WithAlpha(Saturate(color + residual), 1.0f);
+						}
+
+						dest[(size_t)(y * 2 + dy) * destWidth + x * 2 + dx] = result;
+					}
+				}
+
+				batchBegin += batchSize;
+			}
+		}
+	});
+
+	return true;
+}
+
+}
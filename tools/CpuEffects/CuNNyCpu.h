@@ -0,0 +1,151 @@
+#pragma once
+#include "Float4.h"
+#include "CuNNyCpuKernels.h"
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Magpie {
+
+class PaddedImage;
+
+// CuNNy 和 CuNNy2 系列效果的 CPU 实现。从效果源码中提取每个通道的 3x3 卷积权重、偏置和激活函数，
+// 在 CPU 上执行同一个网络，可用于在没有 GPU 时放大图像。中间纹理和着色器一样量化为 8 位
+// （CuNNy2 为 UNORM，CuNNy 为 SNORM），最后一个通道的 depth-to-space 和残差叠加也和着色器相同。
+// 输出尺寸为输入的两倍。支持 AVX2 时每次计算一行中相邻的 8 个像素，结果和可移植的实现完全相同。
+//
+// 尚未实现：ACNet、FSRCNNX 和 Anime4K 的解析，权重的 int8 打包，AVX-512 核。
+class CuNNyCpu {
+public:
+	CuNNyCpu() = default;
+
+	CuNNyCpu(const CuNNyCpu&) = delete;
+	CuNNyCpu(CuNNyCpu&&) = default;
+
+	// source 为效果的源码，如 CuNNy2/CuNNy-fast-NVL.hlsl 或 CuNNy/CuNNy-4x16C-NVL.hlsl 的内容。
+	// halfWeights 为 true 时卷积权重打包为半精度，占用的内存减半，较大的模型每个通道的权重可以放进
+	// L1 缓存。权重的精度和效果的 FP16 变体相同，中间结果仍为单精度。
+	bool Load(std::string_view source, bool halfWeights = false) noexcept;
+
+	bool IsLoaded() const noexcept {
+		return !_passes.empty();
+	}
+
+	// 输出像素依赖的输入像素在每侧的范围。每个通道的卷积核不超过 3x3，因此等于通道数
+	uint32_t GetReceptiveRadius() const noexcept {
+		return (uint32_t)_passes.size();
+	}
+
+	bool Scale(
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest
+	) const noexcept;
+
+private:
+	enum class _InputType : uint8_t {
+		// 输入纹理的亮度
+		Luma,
+		RGB,
+		RGBA
+	};
+
+	// CuNNy 的 CReLU 将同一个输入的正负两部分作为两组输入
+	enum class _Activation : uint8_t {
+		None,
+		// max(x, 0)
+		Positive,
+		// min(x, 0)
+		Negative
+	};
+
+	enum class _TextureFormat : uint8_t {
+		// CuNNy2
+		UNorm8,
+		// CuNNy
+		SNorm8
+	};
+
+	struct _PassInput {
+		uint32_t texture;
+		_InputType type;
+		_Activation activation = _Activation::None;
+		// 亮度输入为 dot(rgb, lumaWeights) + lumaBias，CuNNy 的权重和偏置由训练得到
+		float4 lumaWeights;
+		float lumaBias = 0.0f;
+	};
+
+	// 可移植的实现和 AVX2 核共用
+	using _Conv = CuNNyConv;
+	using _HalfConv = CuNNyHalfConv;
+
+	struct _Pass {
+		std::vector<_PassInput> inputs;
+		// 每组输出 (r0, r1, ...) 的初始值
+		std::vector<float4> biases;
+		// 每组输出写入的纹理，最后一个通道为空
+		std::vector<uint32_t> outputs;
+		// 第 i 位表示第 i 组输出使用 ReLU
+		uint32_t reluMask = 0;
+		// 所有输出使用 tanh，CuNNy 的最后一个通道
+		bool useTanh = false;
+		// 按源码中的顺序执行
+		std::vector<_Conv> convs;
+		// 权重打包为半精度时代替 convs
+		std::vector<_HalfConv> halfConvs;
+	};
+
+	// 以下三个函数内存不足时抛出 std::bad_alloc
+	bool _Parse(std::string_view source);
+
+	bool _ParseV1(std::string_view source);
+
+	// 两种格式共用：补齐偏置并检查每个通道的输入和输出
+	bool _Validate();
+
+	// POINT 采样器使用 CLAMP 寻址
+	static float4 _ReadInput(
+		const _PassInput& input,
+		const PaddedImage& image,
+		const std::vector<std::vector<float4>>& textures,
+		int width,
+		int height,
+		int x,
+		int y
+	) noexcept;
+
+	static void _Evaluate(
+		const _Pass& pass,
+		const PaddedImage& image,
+		const std::vector<std::vector<float4>>& textures,
+		int width,
+		int height,
+		int x,
+		int y,
+		float4* results
+	) noexcept;
+
+	// 计算 (x, y) 开始的 CUNNY_BATCH_SIZE 个像素，results 按 [像素][组] 排列
+	static void _EvaluateAvx2(
+		const _Pass& pass,
+		const PaddedImage& image,
+		const std::vector<std::vector<float4>>& textures,
+		int width,
+		int height,
+		int x,
+		int y,
+		float4 (*results)[CUNNY_MAX_GROUPS]
+	) noexcept;
+
+	std::vector<_Pass> _passes;
+	// 中间纹理的格式，索引即纹理编号
+	std::vector<_TextureFormat> _textureFormats;
+
+	// 最后一个通道中 2x2 个输出像素的残差来自哪些分量，按 (0,0)、(1,0)、(0,1)、(1,1) 排列。
+	// 每项为 (组, 分量)，亮度残差只有一项，RGB 残差有三项。
+	std::vector<std::pair<uint8_t, uint8_t>> _shuffle[4];
+};
+
+}
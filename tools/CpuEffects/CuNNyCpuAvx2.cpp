@@ -0,0 +1,103 @@
+#include "CuNNyCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+namespace Magpie {
+
+// 返回按行排列的 16 个权重
+static const float* LoadWeights(const CuNNyConv& conv, float*) noexcept {
+	return &conv.weights[0][0];
+}
+
+static const float* LoadWeights(const CuNNyHalfConv& conv, float* buffer) noexcept {
+	const __m128i* halves = (const __m128i*)conv.weights;
+	_mm256_storeu_ps(buffer, _mm256_cvtph_ps(_mm_loadu_si128(halves)));
+	_mm256_storeu_ps(buffer + 8, _mm256_cvtph_ps(_mm_loadu_si128(halves + 1)));
+	return buffer;
+}
+
+// 每个寄存器保存 8 个像素的同一个分量，权重广播到所有像素
+template <typename Conv>
+static void Evaluate(
+	const Conv* convs,
+	size_t convCount,
+	const float* biases,
+	uint32_t groupCount,
+	uint32_t reluMask,
+	const float* samples,
+	float* results
+) noexcept {
+	__m256 acc[CUNNY_MAX_GROUPS][4];
+	for (uint32_t i = 0; i < groupCount; ++i) {
+		for (uint32_t c = 0; c < 4; ++c) {
+			acc[i][c] = _mm256_set1_ps(biases[i * 4 + c]);
+		}
+	}
+
+	float buffer[16];
+	for (size_t i = 0; i < convCount; ++i) {
+		const Conv& conv = convs[i];
+		const uint32_t tap = (conv.offsetY + 1) * 3 + conv.offsetX + 1;
+		const float* sample = samples + (size_t)(conv.input * 9 + tap) * 4 * CUNNY_BATCH_SIZE;
+		const float* weights = LoadWeights(conv, buffer);
+		__m256* result = acc[conv.output];
+
+		// 和可移植的实现相同，逐行累加 sample[row] * weights[row]
+		for (uint32_t row = 0; row < conv.rowCount; ++row) {
+			const __m256 value = _mm256_load_ps(sample + row * CUNNY_BATCH_SIZE);
+			for (uint32_t c = 0; c < 4; ++c) {
+				result[c] = _mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(weights[row * 4 + c])), result[c]);
+			}
+		}
+	}
+
+	const __m256 zero = _mm256_setzero_ps();
+	for (uint32_t i = 0; i < groupCount; ++i) {
+		const bool relu = reluMask & (1u << i);
+		for (uint32_t c = 0; c < 4; ++c) {
+			// 参数顺序使 NaN 保持不变，和 std::max(x, 0.0f) 相同
+			const __m256 value = relu ? _mm256_max_ps(zero, acc[i][c]) : acc[i][c];
+			_mm256_store_ps(results + (i * 4 + c) * CUNNY_BATCH_SIZE, value);
+		}
+	}
+}
+
+void CuNNyEvaluateAvx2(
+	const CuNNyConv* convs,
+	size_t convCount,
+	const float* biases,
+	uint32_t groupCount,
+	uint32_t reluMask,
+	const float* samples,
+	float* results
+) noexcept {
+	Evaluate(convs, convCount, biases, groupCount, reluMask, samples, results);
+}
+
+void CuNNyEvaluateAvx2(
+	const CuNNyHalfConv* convs,
+	size_t convCount,
+	const float* biases,
+	uint32_t groupCount,
+	uint32_t reluMask,
+	const float* samples,
+	float* results
+) noexcept {
+	Evaluate(convs, convCount, biases, groupCount, reluMask, samples, results);
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void CuNNyEvaluateAvx2(const CuNNyConv*, size_t, const float*, uint32_t, uint32_t, const float*, float*) noexcept {}
+
+void CuNNyEvaluateAvx2(const CuNNyHalfConv*, size_t, const float*, uint32_t, uint32_t, const float*, float*) noexcept {}
+
+}
+
+#endif
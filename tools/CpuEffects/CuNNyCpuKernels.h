@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Magpie {
+
+// 每个通道最多的输入和输出组数，CuNNy-8x32 为 8
+inline constexpr uint32_t CUNNY_MAX_GROUPS = 8;
+
+// AVX2 核一次计算的像素数
+inline constexpr uint32_t CUNNY_BATCH_SIZE = 8;
+
+// 对应一次 mad 或 MulAdd：r[output] += mul(L[input](offsetX, offsetY), weights)。
+// weights 的第 i 行乘以输入的第 i 个分量，亮度输入只有一行，RGB 输入有三行
+struct CuNNyConv {
+	uint8_t output;
+	uint8_t input;
+	int8_t offsetX;
+	int8_t offsetY;
+	uint8_t rowCount;
+	float weights[4][4];
+};
+
+// 权重打包为半精度的 CuNNyConv，大小约为一半。AVX2 核使用 F16C 转换为单精度
+struct CuNNyHalfConv {
+	uint8_t output;
+	uint8_t input;
+	int8_t offsetX;
+	int8_t offsetY;
+	uint8_t rowCount;
+	uint16_t weights[4][4];
+};
+
+// 同时计算一行中相邻的 CUNNY_BATCH_SIZE 个像素。samples 按 [输入][3x3 邻域][分量][像素] 排列，
+// results 按 [组][分量][像素] 排列，都对齐到 32 字节。乘法和加法不合并为 FMA，因此结果和可移植的
+// 实现完全相同，量化为 8 位后也不会有差异。
+void CuNNyEvaluateAvx2(
+	const CuNNyConv* convs,
+	size_t convCount,
+	const float* biases,
+	uint32_t groupCount,
+	uint32_t reluMask,
+	const float* samples,
+	float* results
+) noexcept;
+
+// 半精度的权重转换为单精度是精确的，因此结果和可移植的实现仍然完全相同
+void CuNNyEvaluateAvx2(
+	const CuNNyHalfConv* convs,
+	size_t convCount,
+	const float* biases,
+	uint32_t groupCount,
+	uint32_t reluMask,
+	const float* samples,
+	float* results
+) noexcept;
+
+}
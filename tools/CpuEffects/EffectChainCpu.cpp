@@ -0,0 +1,579 @@
+#include "EffectChainCpu.h"
+#include "FsrCpu.h"
+#include "GlssCpu.h"
+#include "MmpxCpu.h"
+#include "ResamplerCpu.h"
+#include "ThreadPool.h"
+#include "XbrzCpu.h"
+#include <atomic>
+#include <cassert>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Magpie {
+
+// 分块执行时输出块的最大和最小边长
+static constexpr int32_t MAX_TILE_SIZE = 256;
+static constexpr int32_t MIN_TILE_SIZE = 32;
+
+static constexpr std::pair<std::string_view, ResampleFilter> RESAMPLE_EFFECTS[] = {
+	{ "Nearest", ResampleFilter::Nearest },
+	{ "Bilinear", ResampleFilter::Bilinear },
+	{ "Bicubic", ResampleFilter::Bicubic },
+	{ "Lanczos", ResampleFilter::Lanczos },
+	{ "Jinc", ResampleFilter::Jinc }
+};
+
+// 和其他 CPU 实现一样按 FP32 计算，因此 multipass 和 Bicubic.hlsl 相同
+static constexpr std::pair<std::string_view, GlssVariant> GLSS_EFFECTS[] = {
+	{ "Glss\\Bicubic", GlssVariant::Full },
+	{ "Glss\\Bicubic - multipass", GlssVariant::Full },
+	{ "Glss\\Bicubic - lite", GlssVariant::Lite },
+	{ "Glss\\Bicubic - fast", GlssVariant::Fast }
+};
+
+// 和 CommonDefines.h 中的 IsApprox 相同
+static bool IsApprox(float l, float r) noexcept {
+	return std::abs(l - r) < std::numeric_limits<float>::epsilon() * 100;
+}
+
+static float GetParameter(const CpuEffectOption& option, const char* name, float defaultValue) noexcept {
+	auto it = option.parameters.find(name);
+	return it == option.parameters.end() ? defaultValue : it->second;
+}
+
+// 每个核心独占的 L2 缓存的大小，读取失败时假设为 1MB
+static size_t GetL2CacheSize() noexcept {
+	static const size_t result = []() -> size_t {
+#if defined(_WIN32)
+		DWORD bufferSize = 0;
+		GetLogicalProcessorInformation(nullptr, &bufferSize);
+
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(
+			bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+		if (!infos.empty() && GetLogicalProcessorInformation(infos.data(), &bufferSize)) {
+			for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& info : infos) {
+				if (info.Relationship == RelationCache && info.Cache.Level == 2) {
+					return info.Cache.Size;
+				}
+			}
+		}
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+		if (const long size = sysconf(_SC_LEVEL2_CACHE_SIZE); size > 0) {
+			return (size_t)size;
+		}
+#endif
+
+		return 1024 * 1024;
+	}();
+	return result;
+}
+
+static void CopyRect(
+	const float4* src,
+	size_t srcStride,
+	float4* dest,
+	size_t destStride,
+	int32_t width,
+	int32_t height
+) noexcept {
+	for (int32_t y = 0; y < height; ++y) {
+		std::copy_n(src + y * srcStride, width, dest + y * destStride);
+	}
+}
+
+bool EffectChainCpu::Initialize(
+	const std::filesystem::path& effectsDir,
+	const std::vector<CpuEffectOption>& effects,
+	bool isWindowedMode
+) noexcept {
+	_effects.clear();
+	_cunnys.clear();
+	_isWindowedMode = isWindowedMode;
+
+	if (effects.empty()) {
+		return false;
+	}
+
+	try {
+		for (const CpuEffectOption& option : effects) {
+			if (!_AddEffect(effectsDir, option)) {
+				_effects.clear();
+				return false;
+			}
+		}
+
+		// 和 Renderer::_AppendBicubic 相同
+		_bicubic.option = CpuEffectOption{
+			.name = "Bicubic",
+			.parameters{
+				{"paramB", 0.0f},
+				{"paramC", 0.5f}
+			},
+			.scalingType = isWindowedMode ? CpuScalingType::Fill : CpuScalingType::Fit
+		};
+	} catch (const std::bad_alloc&) {
+		_effects.clear();
+		return false;
+	}
+
+	_bicubic.type = _EffectType::Resample;
+	_bicubic.variant = (uint32_t)ResampleFilter::Bicubic;
+
+	return true;
+}
+
+CpuSize EffectChainCpu::CalcOutputSize(CpuSize inputSize, CpuSize rendererSize) const noexcept {
+	std::vector<const _Effect*> chain;
+	std::vector<CpuSize> outputSizes;
+	_ResolveChain(inputSize, rendererSize, chain, outputSizes);
+	return outputSizes.empty() ? CpuSize{} : outputSizes.back();
+}
+
+bool EffectChainCpu::Run(
+	std::span<const float4> src,
+	CpuSize srcSize,
+	CpuSize rendererSize,
+	std::vector<float4>& dest,
+	CpuSize& destSize
+) const noexcept {
+	if (_effects.empty() || srcSize.width <= 0 || srcSize.height <= 0 ||
+		src.size() < (size_t)srcSize.width * srcSize.height) {
+		return false;
+	}
+
+	std::vector<const _Effect*> chain;
+	std::vector<CpuSize> outputSizes;
+	_ResolveChain(srcSize, rendererSize, chain, outputSizes);
+
+	const uint32_t effectCount = (uint32_t)chain.size();
+	for (uint32_t i = 0; i < effectCount; ++i) {
+		if (outputSizes[i].width <= 0 || outputSizes[i].height <= 0) {
+			return false;
+		}
+	}
+
+	// 中间结果在两个缓冲区之间交替
+	std::vector<float4> buffers[2];
+	uint32_t curBuffer = 0;
+	std::span<const float4> input = src;
+	CpuSize inputSize = srcSize;
+
+	for (uint32_t i = 0; i < effectCount;) {
+		// 合并连续的可分块执行的效果。只有一个效果时分块没有好处，这些效果自身已按行并行
+		uint32_t end = i + 1;
+		if (chain[i]->fixedScale != 0) {
+			while (end < effectCount && chain[end]->fixedScale != 0) {
+				++end;
+			}
+		}
+
+		const CpuSize outputSize = outputSizes[end - 1];
+		std::vector<float4>& output = buffers[curBuffer];
+		try {
+			output.resize((size_t)outputSize.width * outputSize.height);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		const bool success = end - i > 1
+			? _RunTiled({ chain.begin() + i, end - i }, input, inputSize, output, outputSize)
+			: _RunEffect(*chain[i], input, inputSize, output, outputSize);
+		if (!success) {
+			return false;
+		}
+
+		input = output;
+		inputSize = outputSize;
+		curBuffer ^= 1;
+		i = end;
+	}
+
+	dest = std::move(buffers[curBuffer ^ 1]);
+	destSize = inputSize;
+	return true;
+}
+
+bool EffectChainCpu::_AddEffect(const std::filesystem::path& effectsDir, const CpuEffectOption& option) {
+	_Effect& effect = _effects.emplace_back();
+	effect.option = option;
+
+	const std::string_view name = option.name;
+
+	for (const auto& [effectName, filter] : RESAMPLE_EFFECTS) {
+		if (name == effectName) {
+			effect.type = _EffectType::Resample;
+			effect.variant = (uint32_t)filter;
+			return true;
+		}
+	}
+
+	for (const auto& [effectName, variant] : GLSS_EFFECTS) {
+		if (name == effectName) {
+			effect.type = _EffectType::Glss;
+			effect.variant = (uint32_t)variant;
+			return true;
+		}
+	}
+
+	// halo 为各实现读取的邻域范围
+	if (name == "FSR\\FSR_EASU") {
+		effect.type = _EffectType::FsrEasu;
+	} else if (name == "FSR\\FSR_RCAS") {
+		effect.type = _EffectType::FsrRcas;
+		effect.fixedScale = 1;
+		effect.halo = 1;
+	} else if (name == "NIS\\NIS" || name == "NIS\\NVSharpen") {
+		if (name == "NIS\\NIS") {
+			effect.type = _EffectType::NisScale;
+
+			if (!_nis.IsInitialized()) {
+				if (!_nis.Initialize(effectsDir / "NIS" / "Coef_Scale.dds", effectsDir / "NIS" / "Coef_USM.dds")) {
+					return false;
+				}
+			}
+		} else {
+			effect.type = _EffectType::NisSharpen;
+			effect.fixedScale = 1;
+			effect.halo = 2;
+		}
+	} else if (name == "xBRZ\\xBRZ_Freescale") {
+		effect.type = _EffectType::XbrzFreescale;
+	} else if (name.size() == 12 && name.starts_with("xBRZ\\xBRZ_") &&
+		name[10] >= '2' && name[10] <= '6' && name[11] == 'x') {
+		effect.type = _EffectType::Xbrz;
+		effect.variant = name[10] - '0';
+		effect.fixedScale = effect.variant;
+		effect.halo = 2;
+	} else if (name == "Pixel Art\\MMPX") {
+		effect.type = _EffectType::Mmpx;
+		effect.fixedScale = 2;
+		effect.halo = 3;
+	} else if (name.starts_with("CuNNy\\") || name.starts_with("CuNNy2\\")) {
+		// 效果名中的分隔符为反斜杠，换成在所有平台上都有效的斜杠
+		std::string relativePath(name);
+		std::replace(relativePath.begin(), relativePath.end(), '\\', '/');
+		relativePath += ".hlsl";
+
+		std::ifstream file(effectsDir / relativePath, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		const std::string source{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+		CuNNyCpu& cunny = _cunnys.emplace_back();
+		if (!cunny.Load(source)) {
+			return false;
+		}
+
+		effect.type = _EffectType::CuNNy;
+		effect.variant = (uint32_t)_cunnys.size() - 1;
+		effect.fixedScale = 2;
+		effect.halo = cunny.GetReceptiveRadius();
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+void EffectChainCpu::_ResolveChain(
+	CpuSize inputSize,
+	CpuSize rendererSize,
+	std::vector<const _Effect*>& chain,
+	std::vector<CpuSize>& outputSizes
+) const noexcept {
+	CpuSize size = inputSize;
+	for (const _Effect& effect : _effects) {
+		size = _CalcEffectOutputSize(effect, size, rendererSize);
+		chain.push_back(&effect);
+		outputSizes.push_back(size);
+	}
+
+	if (!_effects.empty() && _ShouldAppendBicubic(size, rendererSize)) {
+		chain.push_back(&_bicubic);
+		outputSizes.push_back(_CalcEffectOutputSize(_bicubic, size, rendererSize));
+	}
+}
+
+// 和 EffectDrawer::_CalcOutputSize 相同。fixedScale 不为 0 的效果在源码中以表达式指定了输出尺寸
+CpuSize EffectChainCpu::_CalcEffectOutputSize(
+	const _Effect& effect,
+	CpuSize inputSize,
+	CpuSize rendererSize
+) const noexcept {
+	if (effect.fixedScale != 0) {
+		return { inputSize.width * (int32_t)effect.fixedScale, inputSize.height * (int32_t)effect.fixedScale };
+	}
+
+	const CpuEffectOption& option = effect.option;
+	switch (option.scalingType) {
+	case CpuScalingType::Normal:
+		return {
+			(int32_t)std::lroundf(inputSize.width * option.scale.first),
+			(int32_t)std::lroundf(inputSize.height * option.scale.second)
+		};
+	case CpuScalingType::Absolute:
+		return { (int32_t)std::lroundf(option.scale.first), (int32_t)std::lroundf(option.scale.second) };
+	case CpuScalingType::Fit:
+	{
+		// 窗口模式缩放时将缩放比例为 1 的 Fit 视为 Fill，见 EffectDrawer::_CalcOutputSize
+		const bool treatFitAsFill = _isWindowedMode &&
+			IsApprox(option.scale.first, 1.0f) && IsApprox(option.scale.second, 1.0f);
+
+		if (!treatFitAsFill) {
+			const float fillScale = std::min(
+				float(rendererSize.width) / inputSize.width,
+				float(rendererSize.height) / inputSize.height
+			);
+			return {
+				(int32_t)std::lroundf(inputSize.width * fillScale * option.scale.first),
+				(int32_t)std::lroundf(inputSize.height * fillScale * option.scale.second)
+			};
+		}
+		[[fallthrough]];
+	}
+	case CpuScalingType::Fill:
+		return rendererSize;
+	default:
+		assert(false);
+		return {};
+	}
+}
+
+bool EffectChainCpu::_ShouldAppendBicubic(CpuSize lastOutputSize, CpuSize rendererSize) const noexcept {
+	if (_isWindowedMode) {
+		return lastOutputSize != rendererSize;
+	} else {
+		return lastOutputSize.width > rendererSize.width || lastOutputSize.height > rendererSize.height;
+	}
+}
+
+bool EffectChainCpu::_RunEffect(
+	const _Effect& effect,
+	std::span<const float4> src,
+	CpuSize srcSize,
+	std::span<float4> dest,
+	CpuSize destSize
+) const noexcept {
+	const CpuEffectOption& option = effect.option;
+	const uint32_t srcWidth = (uint32_t)srcSize.width;
+	const uint32_t srcHeight = (uint32_t)srcSize.height;
+	const uint32_t destWidth = (uint32_t)destSize.width;
+	const uint32_t destHeight = (uint32_t)destSize.height;
+
+	switch (effect.type) {
+	case _EffectType::Resample:
+	{
+		ResampleParameters params;
+		params.bicubicB = GetParameter(option, "paramB", params.bicubicB);
+		params.bicubicC = GetParameter(option, "paramC", params.bicubicC);
+		params.lanczosARStrength = GetParameter(option, "ARStrength", params.lanczosARStrength);
+		params.jincWindowSinc = GetParameter(option, "windowSinc", params.jincWindowSinc);
+		params.jincSinc = GetParameter(option, "sinc", params.jincSinc);
+		params.jincARStrength = GetParameter(option, "ARStrength", params.jincARStrength);
+		return ResamplerCpu::Scale((ResampleFilter)effect.variant, params,
+			src, srcWidth, srcHeight, dest, destWidth, destHeight);
+	}
+	case _EffectType::FsrEasu:
+		return FsrCpu::Easu(src, srcWidth, srcHeight, dest, destWidth, destHeight);
+	case _EffectType::FsrRcas:
+		return FsrCpu::Rcas(src, srcWidth, srcHeight, dest, GetParameter(option, "sharpness", 0.87f));
+	case _EffectType::NisScale:
+		return _nis.Scale(src, srcWidth, srcHeight, dest, destWidth, destHeight,
+			GetParameter(option, "sharpness", 0.5f));
+	case _EffectType::NisSharpen:
+		return NisCpu::Sharpen(src, srcWidth, srcHeight, dest, GetParameter(option, "sharpness", 0.5f));
+	case _EffectType::Xbrz:
+		return XbrzCpu::Scale(effect.variant, src, srcWidth, srcHeight, dest);
+	case _EffectType::XbrzFreescale:
+		return XbrzCpu::ScaleFree(src, srcWidth, srcHeight, dest, destWidth, destHeight);
+	case _EffectType::Mmpx:
+		return MmpxCpu::Scale(src, srcWidth, srcHeight, dest);
+	case _EffectType::CuNNy:
+		return _cunnys[effect.variant].Scale(src, srcWidth, srcHeight, dest);
+	case _EffectType::Glss:
+	{
+		GlssParameters params;
+		params.sharpness = GetParameter(option, "paramSharpness", params.sharpness);
+		params.denoise = GetParameter(option, "paramDenoise", params.denoise);
+		params.aaStrength = GetParameter(option, "paramAAStrength", params.aaStrength);
+		params.detail = GetParameter(option, "paramDetail", params.detail);
+		params.softness = GetParameter(option, "paramSoftness", params.softness);
+		return GlssCpu::Scale((GlssVariant)effect.variant, params,
+			src, srcWidth, srcHeight, dest, destWidth, destHeight);
+	}
+	default:
+		assert(false);
+		return false;
+	}
+}
+
+bool EffectChainCpu::_RunTiled(
+	std::span<const _Effect* const> segment,
+	std::span<const float4> src,
+	CpuSize srcSize,
+	std::span<float4> dest,
+	CpuSize destSize
+) const noexcept {
+	const uint32_t stageCount = (uint32_t)segment.size();
+
+	std::vector<CpuSize> stageInputSizes(stageCount);
+	{
+		CpuSize size = srcSize;
+		for (uint32_t i = 0; i < stageCount; ++i) {
+			stageInputSizes[i] = size;
+			size = _CalcEffectOutputSize(*segment[i], size, {});
+		}
+		assert(size == destSize);
+	}
+
+	// 估算输出块边长为 tileSize 时的工作集：每个效果的输入块、效果内部复制的输入以及输出
+	auto estimateWorkingSet = [&](int32_t tileSize) {
+		size_t pixelCount = 0;
+		int32_t edge = tileSize;
+		for (uint32_t i = stageCount; i-- > 0;) {
+			const int32_t scale = (int32_t)segment[i]->fixedScale;
+			edge = (edge + scale - 1) / scale + 2 * (int32_t)segment[i]->halo;
+			pixelCount += 2 * (size_t)edge * edge + (size_t)edge * edge * scale * scale;
+		}
+		return pixelCount * sizeof(float4);
+	};
+
+	const size_t cacheSize = GetL2CacheSize();
+	int32_t tileSize = MAX_TILE_SIZE;
+	while (tileSize > MIN_TILE_SIZE && estimateWorkingSet(tileSize) > cacheSize) {
+		tileSize /= 2;
+	}
+
+	const uint32_t tileCountX = uint32_t((destSize.width + tileSize - 1) / tileSize);
+	const uint32_t tileCountY = uint32_t((destSize.height + tileSize - 1) / tileSize);
+	const uint32_t tileCount = tileCountX * tileCountY;
+	const uint32_t workerCount = std::min(tileCount, ThreadPool::Get().ThreadCount());
+
+	std::vector<_Arena> arenas;
+	try {
+		arenas.resize(workerCount);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	// 每个工作线程不断领取下一个块，按行优先的顺序相邻的块共享部分输入
+	std::atomic<uint32_t> nextTile = 0;
+	std::atomic<bool> failed = false;
+	ThreadPool::Get().ParallelFor(workerCount, [&](uint32_t workerIdx) {
+		_Arena& arena = arenas[workerIdx];
+
+		while (!failed.load(std::memory_order_relaxed)) {
+			const uint32_t tileIdx = nextTile.fetch_add(1, std::memory_order_relaxed);
+			if (tileIdx >= tileCount) {
+				return;
+			}
+
+			const int32_t left = int32_t(tileIdx % tileCountX) * tileSize;
+			const int32_t top = int32_t(tileIdx / tileCountX) * tileSize;
+			const _Rect tileRect{
+				left,
+				top,
+				std::min(left + tileSize, destSize.width),
+				std::min(top + tileSize, destSize.height)
+			};
+
+			if (!_RunTile(segment, stageInputSizes, src, tileRect, arena, dest, destSize.width)) {
+				failed.store(true, std::memory_order_relaxed);
+			}
+		}
+	});
+
+	return !failed.load(std::memory_order_relaxed);
+}
+
+bool EffectChainCpu::_RunTile(
+	std::span<const _Effect* const> segment,
+	std::span<const CpuSize> stageInputSizes,
+	std::span<const float4> src,
+	const _Rect& tileRect,
+	_Arena& arena,
+	std::span<float4> dest,
+	int32_t destWidth
+) const noexcept {
+	const uint32_t stageCount = (uint32_t)segment.size();
+
+	// 由后向前计算每个效果需要的输入区域。区域的边缘和图像边缘重合时效果的 CLAMP 寻址和在完整图像上
+	// 执行时相同，否则扩展的 halo 个像素足以覆盖所有采样，因此块内的结果和完整执行完全一致。
+	std::vector<_Rect> inputRects(stageCount);
+	_Rect rect = tileRect;
+	for (uint32_t i = stageCount; i-- > 0;) {
+		const int32_t scale = (int32_t)segment[i]->fixedScale;
+		const int32_t halo = (int32_t)segment[i]->halo;
+		const CpuSize inputSize = stageInputSizes[i];
+
+		rect = {
+			std::max(rect.left / scale - halo, 0),
+			std::max(rect.top / scale - halo, 0),
+			std::min((rect.right + scale - 1) / scale + halo, inputSize.width),
+			std::min((rect.bottom + scale - 1) / scale + halo, inputSize.height)
+		};
+		inputRects[i] = rect;
+	}
+
+	try {
+		const _Rect& firstRect = inputRects[0];
+		const int32_t width = firstRect.right - firstRect.left;
+		const int32_t height = firstRect.bottom - firstRect.top;
+		arena.input.resize((size_t)width * height);
+		CopyRect(src.data() + (size_t)firstRect.top * stageInputSizes[0].width + firstRect.left,
+			stageInputSizes[0].width, arena.input.data(), width, width, height);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < stageCount; ++i) {
+		const _Effect& effect = *segment[i];
+		const int32_t scale = (int32_t)effect.fixedScale;
+		const _Rect& inputRect = inputRects[i];
+		const CpuSize inputSize{ inputRect.right - inputRect.left, inputRect.bottom - inputRect.top };
+		const CpuSize outputSize{ inputSize.width * scale, inputSize.height * scale };
+
+		try {
+			arena.output.resize((size_t)outputSize.width * outputSize.height);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		if (!_RunEffect(effect, arena.input, inputSize, arena.output, outputSize)) {
+			return false;
+		}
+
+		// 取出下一个效果需要的区域，最后一个效果取出块本身
+		const bool isLast = i + 1 == stageCount;
+		const _Rect& nextRect = isLast ? tileRect : inputRects[i + 1];
+		const int32_t width = nextRect.right - nextRect.left;
+		const int32_t height = nextRect.bottom - nextRect.top;
+		const float4* origin = arena.output.data()
+			+ (size_t)(nextRect.top - inputRect.top * scale) * outputSize.width + nextRect.left - inputRect.left * scale;
+
+		if (isLast) {
+			CopyRect(origin, outputSize.width,
+				dest.data() + (size_t)nextRect.top * destWidth + nextRect.left, destWidth, width, height);
+		} else {
+			try {
+				arena.input.resize((size_t)width * height);
+			} catch (const std::bad_alloc&) {
+				return false;
+			}
+
+			CopyRect(origin, outputSize.width, arena.input.data(), width, width, height);
+		}
+	}
+
+	return true;
+}
+
+}
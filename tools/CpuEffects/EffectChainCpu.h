@@ -0,0 +1,155 @@
+#pragma once
+#include "Float4.h"
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include "CuNNyCpu.h"
+#include "NisCpu.h"
+
+namespace Magpie {
+
+// 和 ScalingOptions.h 中的 ScalingType 相同
+enum class CpuScalingType {
+	Normal,		// scale 表示缩放倍数
+	Fit,		// scale 表示相对于屏幕能容纳的最大等比缩放的比例
+	Absolute,	// scale 表示目标大小（单位为像素）
+	Fill		// 充满屏幕，此时不使用 scale
+};
+
+// 和 ScalingOptions.h 中的 EffectOption 相同，name 为效果相对于 effects 文件夹的路径，如 "FSR\\FSR_EASU"
+struct CpuEffectOption {
+	std::string name;
+	std::unordered_map<std::string, float> parameters;
+	CpuScalingType scalingType = CpuScalingType::Normal;
+	std::pair<float, float> scale = { 1.0f, 1.0f };
+};
+
+struct CpuSize {
+	int32_t width = 0;
+	int32_t height = 0;
+
+	friend bool operator==(const CpuSize&, const CpuSize&) noexcept = default;
+};
+
+// 在 CPU 上执行整个效果链，可作为 Renderer 的离线等价实现。每个效果的输出尺寸、缩放类型的含义
+// 以及末尾追加 Bicubic 的规则都和 Renderer 相同。
+// 输出尺寸为输入整数倍且只依赖有限邻域的连续效果（RCAS、NVSharpen、xBRZ、MMPX、CuNNy）
+// 合并为一段并按输出分块执行：每个块连同重叠区域依次经过段内所有效果，中间结果只有块的大小，
+// 块的尺寸根据 L2 缓存的大小确定。其他效果需要完整的输入，因此仍生成完整的中间图像。
+class EffectChainCpu {
+public:
+	EffectChainCpu() = default;
+
+	EffectChainCpu(const EffectChainCpu&) = delete;
+	EffectChainCpu(EffectChainCpu&&) = default;
+
+	// 从 effectsDir 读取 CuNNy 和 CuNNy2 的源码以及 NIS 的系数表。有效果没有 CPU 实现时失败
+	bool Initialize(
+		const std::filesystem::path& effectsDir,
+		const std::vector<CpuEffectOption>& effects,
+		bool isWindowedMode
+	) noexcept;
+
+	bool IsInitialized() const noexcept {
+		return !_effects.empty();
+	}
+
+	// rendererSize 对应 ScalingWindow::RendererRect 的尺寸。返回的尺寸包含追加的 Bicubic
+	CpuSize CalcOutputSize(CpuSize inputSize, CpuSize rendererSize) const noexcept;
+
+	bool Run(
+		std::span<const float4> src,
+		CpuSize srcSize,
+		CpuSize rendererSize,
+		std::vector<float4>& dest,
+		CpuSize& destSize
+	) const noexcept;
+
+private:
+	enum class _EffectType : uint8_t {
+		Resample,
+		FsrEasu,
+		FsrRcas,
+		NisScale,
+		NisSharpen,
+		Xbrz,
+		XbrzFreescale,
+		Mmpx,
+		CuNNy,
+		Glss
+	};
+
+	struct _Effect {
+		CpuEffectOption option;
+		_EffectType type = _EffectType::Resample;
+		// Resample 为 ResampleFilter，Xbrz 为缩放倍数，CuNNy 为 _cunnys 的索引，Glss 为 GlssVariant
+		uint32_t variant = 0;
+		// 输出尺寸为输入的 fixedScale 倍，为 0 表示由缩放类型决定。不为 0 的效果可以分块执行
+		uint32_t fixedScale = 0;
+		// 分块执行时输入块每侧需要扩展的像素数
+		uint32_t halo = 0;
+	};
+
+	struct _Rect {
+		int32_t left;
+		int32_t top;
+		int32_t right;
+		int32_t bottom;
+	};
+
+	// 每个工作线程独占，在块之间复用以避免反复分配
+	struct _Arena {
+		std::vector<float4> input;
+		std::vector<float4> output;
+	};
+
+	bool _AddEffect(const std::filesystem::path& effectsDir, const CpuEffectOption& option);
+
+	// 确定要执行的效果（包括追加的 Bicubic）以及每个效果的输出尺寸
+	void _ResolveChain(
+		CpuSize inputSize,
+		CpuSize rendererSize,
+		std::vector<const _Effect*>& chain,
+		std::vector<CpuSize>& outputSizes
+	) const noexcept;
+
+	CpuSize _CalcEffectOutputSize(const _Effect& effect, CpuSize inputSize, CpuSize rendererSize) const noexcept;
+
+	// 和 Renderer::_ShouldAppendBicubic 相同
+	bool _ShouldAppendBicubic(CpuSize lastOutputSize, CpuSize rendererSize) const noexcept;
+
+	bool _RunEffect(
+		const _Effect& effect,
+		std::span<const float4> src,
+		CpuSize srcSize,
+		std::span<float4> dest,
+		CpuSize destSize
+	) const noexcept;
+
+	bool _RunTiled(
+		std::span<const _Effect* const> segment,
+		std::span<const float4> src,
+		CpuSize srcSize,
+		std::span<float4> dest,
+		CpuSize destSize
+	) const noexcept;
+
+	bool _RunTile(
+		std::span<const _Effect* const> segment,
+		std::span<const CpuSize> stageInputSizes,
+		std::span<const float4> src,
+		const _Rect& tileRect,
+		_Arena& arena,
+		std::span<float4> dest,
+		int32_t destWidth
+	) const noexcept;
+
+	std::vector<_Effect> _effects;
+	_Effect _bicubic;
+	std::vector<CuNNyCpu> _cunnys;
+	NisCpu _nis;
+	bool _isWindowedMode = false;
+};
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace Magpie {
+
+// CPU 实现使用的四分量向量，对应着色器中的 float4。图像的每个像素也以 float4 保存，
+// 和 R32G32B32A32_FLOAT 纹理的布局相同。所有运算都逐分量进行，由编译器向量化。
+struct alignas(16) float4 {
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 0.0f;
+
+	constexpr float4() noexcept = default;
+	constexpr explicit float4(float value) noexcept : x(value), y(value), z(value), w(value) {}
+	constexpr float4(float x_, float y_, float z_, float w_) noexcept : x(x_), y(y_), z(z_), w(w_) {}
+
+	float4& operator+=(const float4& other) noexcept {
+		x += other.x;
+		y += other.y;
+		z += other.z;
+		w += other.w;
+		return *this;
+	}
+
+	float4& operator-=(const float4& other) noexcept {
+		x -= other.x;
+		y -= other.y;
+		z -= other.z;
+		w -= other.w;
+		return *this;
+	}
+
+	float4& operator*=(float value) noexcept {
+		x *= value;
+		y *= value;
+		z *= value;
+		w *= value;
+		return *this;
+	}
+
+	friend float4 operator+(float4 a, const float4& b) noexcept {
+		return a += b;
+	}
+
+	friend float4 operator-(float4 a, const float4& b) noexcept {
+		return a -= b;
+	}
+
+	friend float4 operator-(const float4& a) noexcept {
+		return { -a.x, -a.y, -a.z, -a.w };
+	}
+
+	friend float4 operator*(const float4& a, const float4& b) noexcept {
+		return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
+	}
+
+	friend float4 operator*(float4 a, float value) noexcept {
+		return a *= value;
+	}
+
+	friend float4 operator*(float value, float4 a) noexcept {
+		return a *= value;
+	}
+
+	friend bool operator==(const float4&, const float4&) noexcept = default;
+};
+
+static_assert(sizeof(float4) == 16);
+
+// 和 HLSL 的 saturate 相同，NaN 返回 0
+inline float Saturate(float value) noexcept {
+	return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+}
+
+inline float Lerp(float a, float b, float t) noexcept {
+	return a + (b - a) * t;
+}
+
+inline float4 Lerp(const float4& a, const float4& b, float t) noexcept {
+	return a + (b - a) * t;
+}
+
+inline float4 Lerp(const float4& a, const float4& b, const float4& t) noexcept {
+	return a + (b - a) * t;
+}
+
+inline float4 Min(const float4& a, const float4& b) noexcept {
+	return { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z), std::min(a.w, b.w) };
+}
+
+inline float4 Max(const float4& a, const float4& b) noexcept {
+	return { std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w) };
+}
+
+inline float4 Clamp(const float4& value, const float4& low, const float4& high) noexcept {
+	return Min(Max(value, low), high);
+}
+
+inline float4 Saturate(const float4& value) noexcept {
+	return { Saturate(value.x), Saturate(value.y), Saturate(value.z), Saturate(value.w) };
+}
+
+inline float4 Abs(const float4& value) noexcept {
+	return { std::abs(value.x), std::abs(value.y), std::abs(value.z), std::abs(value.w) };
+}
+
+inline float4 Floor(const float4& value) noexcept {
+	return { std::floor(value.x), std::floor(value.y), std::floor(value.z), std::floor(value.w) };
+}
+
+inline float Dot3(const float4& a, const float4& b) noexcept {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline float Length3(const float4& value) noexcept {
+	return std::sqrt(Dot3(value, value));
+}
+
+inline float4 WithAlpha(float4 color, float alpha) noexcept {
+	color.w = alpha;
+	return color;
+}
+
+// 半精度浮点数和单精度之间的转换，舍入到最近的偶数，和 GPU 的转换相同
+inline uint16_t FloatToHalf(float value) noexcept {
+	const uint32_t bits = std::bit_cast<uint32_t>(value);
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t absBits = bits & 0x7FFFFFFF;
+
+	if (absBits >= 0x7F800000) {
+		// NaN 保持为 NaN，无穷大保持为无穷大
+		return uint16_t(sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0));
+	}
+
+	if (absBits >= 0x477FF000) {
+		// 舍入后超出半精度的范围
+		return uint16_t(sign | 0x7C00);
+	}
+
+	if (absBits < 0x38800000) {
+		// 非规格化数。加上 0.5 后尾数的低位即为结果，加法本身完成了舍入
+		const float magic = std::bit_cast<float>(0x3F000000u);
+		return uint16_t(sign | (std::bit_cast<uint32_t>(std::bit_cast<float>(absBits) + magic) - 0x3F000000));
+	}
+
+	const uint32_t roundBit = (absBits >> 13) & 1;
+	return uint16_t(sign | ((absBits + 0xC8000FFF + roundBit) >> 13));
+}
+
+inline float HalfToFloat(uint16_t value) noexcept {
+	const uint32_t sign = uint32_t(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1F;
+	const uint32_t mantissa = value & 0x3FF;
+
+	if (exponent == 0) {
+		// 非规格化数和 0，单位为 2^-24
+		const float result = (float)mantissa * std::bit_cast<float>(0x33800000u);
+		return sign ? -result : result;
+	}
+
+	if (exponent == 0x1F) {
+		return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+	}
+
+	return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+// 舍入到半精度，用于模拟着色器中 min16float 的精度损失
+inline float RoundToHalf(float value) noexcept {
+	return HalfToFloat(FloatToHalf(value));
+}
+
+inline float4 RoundToHalf(const float4& value) noexcept {
+	return { RoundToHalf(value.x), RoundToHalf(value.y), RoundToHalf(value.z), RoundToHalf(value.w) };
+}
+
+}
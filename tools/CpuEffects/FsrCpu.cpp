@@ -0,0 +1,357 @@
+#include "FsrCpu.h"
+#include "CpuFeatures.h"
+#include "FsrCpuKernels.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+#include <vector>
+
+namespace Magpie {
+
+// 每个任务处理的输出行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+// AVX2 核一次计算的像素数
+static constexpr uint32_t AVX2_BATCH_SIZE = 8;
+
+static constexpr float FSR_RCAS_LIMIT = 0.25f - 1.0f / 16.0f;
+
+// 亮度的两倍，和 FSR 相同
+static float FsrLuma(const float4& color) noexcept {
+	return color.z * 0.5f + (color.x * 0.5f + color.y);
+}
+
+// 和 FSR_EASU.hlsl 中的 FsrEasuSetF 相同
+static void FsrEasuSet(
+	float& dirX,
+	float& dirY,
+	float& len,
+	float w,
+	float lA,
+	float lB,
+	float lC,
+	float lD,
+	float lE
+) noexcept {
+	const float lenX = Saturate(std::abs(lD - lB) / std::max(std::abs(lD - lC), std::abs(lC - lB)));
+	dirX += (lD - lB) * w;
+	len += lenX * lenX * w;
+
+	const float lenY = Saturate(std::abs(lE - lA) / std::max(std::abs(lE - lC), std::abs(lC - lA)));
+	dirY += (lE - lA) * w;
+	len += lenY * lenY * w;
+}
+
+// 和 FSR_EASU.hlsl 中的 FsrEasuTapF 相同
+static void FsrEasuTap(
+	float4& aC,
+	float& aW,
+	float offX,
+	float offY,
+	float dirX,
+	float dirY,
+	float lenX,
+	float lenY,
+	float lob,
+	float clp,
+	const float4& c
+) noexcept {
+	// 按方向旋转并拉伸
+	const float vX = (offX * dirX + offY * dirY) * lenX;
+	const float vY = (offX * -dirY + offY * dirX) * lenY;
+	const float d2 = std::min(vX * vX + vY * vY, clp);
+
+	// 不使用 sin 的 lanczos2 近似
+	float wB = 2.0f / 5.0f * d2 - 1.0f;
+	float wA = lob * d2 - 1.0f;
+	wB *= wB;
+	wA *= wA;
+	wB = 25.0f / 16.0f * wB - (25.0f / 16.0f - 1.0f);
+	const float w = wB * wA;
+
+	aC += c * w;
+	aW += w;
+}
+
+// ppX 和 ppY 为输出像素在输入中的位置，即着色器中 floor 之前的 pp
+static float4 FsrEasu(const PaddedImage& image, float ppX, float ppY) noexcept {
+	const float fpX = std::floor(ppX);
+	const float fpY = std::floor(ppY);
+	ppX -= fpX;
+	ppY -= fpY;
+	const int x = (int)fpX;
+	const int y = (int)fpY;
+
+	// 12 个采样点
+	//    b c
+	//  e f g h
+	//  i j k l
+	//    n o
+	const float4 b = image.Texel(x, y - 1);
+	const float4 c = image.Texel(x + 1, y - 1);
+	const float4 e = image.Texel(x - 1, y);
+	const float4 f = image.Texel(x, y);
+	const float4 g = image.Texel(x + 1, y);
+	const float4 h = image.Texel(x + 2, y);
+	const float4 i = image.Texel(x - 1, y + 1);
+	const float4 j = image.Texel(x, y + 1);
+	const float4 k = image.Texel(x + 1, y + 1);
+	const float4 l = image.Texel(x + 2, y + 1);
+	const float4 n = image.Texel(x, y + 2);
+	const float4 o = image.Texel(x + 1, y + 2);
+
+	const float bL = FsrLuma(b);
+	const float cL = FsrLuma(c);
+	const float eL = FsrLuma(e);
+	const float fL = FsrLuma(f);
+	const float gL = FsrLuma(g);
+	const float hL = FsrLuma(h);
+	const float iL = FsrLuma(i);
+	const float jL = FsrLuma(j);
+	const float kL = FsrLuma(k);
+	const float lL = FsrLuma(l);
+	const float nL = FsrLuma(n);
+	const float oL = FsrLuma(o);
+
+	// 对 f、g、j、k 四个位置的方向和长度做双线性插值
+	float dirX = 0.0f;
+	float dirY = 0.0f;
+	float len = 0.0f;
+	FsrEasuSet(dirX, dirY, len, (1.0f - ppX) * (1.0f - ppY), bL, eL, fL, gL, jL);
+	FsrEasuSet(dirX, dirY, len, ppX * (1.0f - ppY), cL, fL, gL, hL, kL);
+	FsrEasuSet(dirX, dirY, len, (1.0f - ppX) * ppY, fL, iL, jL, kL, nL);
+	FsrEasuSet(dirX, dirY, len, ppX * ppY, gL, jL, kL, lL, oL);
+
+	// 归一化，接近 0 时使用水平方向
+	float dirR = dirX * dirX + dirY * dirY;
+	const bool zro = dirR < 1.0f / 32768.0f;
+	dirR = zro ? 1.0f : 1.0f / std::sqrt(dirR);
+	dirX = zro ? 1.0f : dirX;
+	dirX *= dirR;
+	dirY *= dirR;
+
+	len = len * 0.5f;
+	len *= len;
+
+	const float stretch = (dirX * dirX + dirY * dirY) / std::max(std::abs(dirX), std::abs(dirY));
+	const float len2X = 1.0f + (stretch - 1.0f) * len;
+	const float len2Y = 1.0f - 0.5f * len;
+	const float lob = 0.5f + ((1.0f / 4.0f - 0.04f) - 0.5f) * len;
+	const float clp = 1.0f / lob;
+
+	float4 aC = float4();
+	float aW = 0.0f;
+	FsrEasuTap(aC, aW, 0.0f - ppX, -1.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, b);
+	FsrEasuTap(aC, aW, 1.0f - ppX, -1.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, c);
+	FsrEasuTap(aC, aW, -1.0f - ppX, 1.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, i);
+	FsrEasuTap(aC, aW, 0.0f - ppX, 1.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, j);
+	FsrEasuTap(aC, aW, 0.0f - ppX, 0.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, f);
+	FsrEasuTap(aC, aW, -1.0f - ppX, 0.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, e);
+	FsrEasuTap(aC, aW, 1.0f - ppX, 1.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, k);
+	FsrEasuTap(aC, aW, 2.0f - ppX, 1.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, l);
+	FsrEasuTap(aC, aW, 2.0f - ppX, 0.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, h);
+	FsrEasuTap(aC, aW, 1.0f - ppX, 0.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, g);
+	FsrEasuTap(aC, aW, 1.0f - ppX, 2.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, o);
+	FsrEasuTap(aC, aW, 0.0f - ppX, 2.0f - ppY, dirX, dirY, len2X, len2Y, lob, clp, n);
+
+	// 去除振铃，限制在最近的 4 个像素的范围内
+	const float4 min4 = Min(Min(f, g), Min(j, k));
+	const float4 max4 = Max(Max(f, g), Max(j, k));
+	return Min(max4, Max(min4, aC * (1.0f / aW)));
+}
+
+// 和 FSR_RCAS.hlsl 中的 FsrRcasF 相同
+//    b
+//  d e f
+//    h
+static float4 FsrRcas(
+	const float4& b,
+	const float4& d,
+	const float4& e,
+	const float4& f,
+	const float4& h,
+	float sharpness
+) noexcept {
+	const float bL = FsrLuma(b);
+	const float dL = FsrLuma(d);
+	const float eL = FsrLuma(e);
+	const float fL = FsrLuma(f);
+	const float hL = FsrLuma(h);
+
+	// 噪声检测
+	float nz = 0.25f * bL + 0.25f * dL + 0.25f * fL + 0.25f * hL - eL;
+	nz = Saturate(std::abs(nz) / (
+		std::max(std::max(std::max(bL, dL), std::max(eL, fL)), hL) -
+		std::min(std::min(std::min(bL, dL), std::min(eL, fL)), hL)));
+	nz = -0.5f * nz + 1.0f;
+
+	const float4 mn4 = Min(Min(b, d), Min(f, h));
+	const float4 mx4 = Max(Max(b, d), Max(f, h));
+
+	// 除以 0 时和 GPU 一样产生 NaN，std::fmax 和 GPU 的 max 一样忽略 NaN
+	auto calcLobe = [](float mn, float mx, float c) {
+		const float hitMin = std::min(mn, c) / (4.0f * mx);
+		const float hitMax = (1.0f - std::max(mx, c)) / (4.0f * mn - 4.0f);
+		return std::fmax(-hitMin, hitMax);
+	};
+	const float maxLobe = std::fmax(std::fmax(
+		calcLobe(mn4.x, mx4.x, e.x), calcLobe(mn4.y, mx4.y, e.y)), calcLobe(mn4.z, mx4.z, e.z));
+	float lobe = std::fmax(-FSR_RCAS_LIMIT, std::fmin(maxLobe, 0.0f)) * sharpness;
+	lobe *= nz;
+
+	const float4 sum = b + d + (h + f);
+	return (sum * lobe + e) * (1.0f / (4.0f * lobe + 1.0f));
+}
+
+bool FsrCpu::Easu(
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	if (srcWidth == 0 || srcHeight == 0 || destWidth == 0 || destHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	PaddedImage image;
+	if (!image.Initialize(src, srcWidth, srcHeight)) {
+		return false;
+	}
+
+	// 和着色器中的 con0 相同
+	const float scaleX = (float)srcWidth / destWidth;
+	const float scaleY = (float)srcHeight / destHeight;
+	const float offsetX = 0.5f * scaleX - 0.5f;
+	const float offsetY = 0.5f * scaleY - 0.5f;
+
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+	const uint32_t bandCount = (destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float ppY = y * scaleY + offsetY;
+			float4* destRow = dest.data() + (size_t)y * destWidth;
+
+			uint32_t x = 0;
+			if (useAvx2) {
+				const float fpY = std::floor(ppY);
+				for (; x + AVX2_BATCH_SIZE <= destWidth; x += AVX2_BATCH_SIZE) {
+					const float* origins[AVX2_BATCH_SIZE];
+					float fracX[AVX2_BATCH_SIZE];
+					for (uint32_t i = 0; i < AVX2_BATCH_SIZE; ++i) {
+						const float ppX = (x + i) * scaleX + offsetX;
+						const float fpX = std::floor(ppX);
+						origins[i] = &image.Texel((int)fpX, (int)fpY).x;
+						fracX[i] = ppX - fpX;
+					}
+
+					FsrEasuAvx2(origins, image.Stride(), fracX, ppY - fpY, &destRow[x].x);
+				}
+			}
+
+			// 剩余的像素使用可移植的实现
+			for (; x < destWidth; ++x) {
+				const float4 color = FsrEasu(image, x * scaleX + offsetX, ppY);
+				destRow[x] = WithAlpha(color, 1.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+bool FsrCpu::Rcas(
+	std::span<const float4> src,
+	uint32_t width,
+	uint32_t height,
+	std::span<float4> dest,
+	float sharpness
+) noexcept {
+	if (width == 0 || height == 0 || src.size() < (size_t)width * height || dest.size() < (size_t)width * height) {
+		return false;
+	}
+
+	// 着色器使用 Load 读取，超出边界时为 0
+	auto load = [&](int x, int y) {
+		if (x < 0 || y < 0 || x >= (int)width || y >= (int)height) {
+			return float4();
+		}
+		return src[(size_t)y * width + x];
+	};
+
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+	const uint32_t bandCount = (height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, height);
+
+		auto rcasPixel = [&](uint32_t x, uint32_t y) {
+			const float4 color = FsrRcas(
+				load(x, y - 1),
+				load(x - 1, y),
+				load(x, y),
+				load(x + 1, y),
+				load(x, y + 1),
+				sharpness
+			);
+			return WithAlpha(color, 1.0f);
+		};
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float4* srcRow = src.data() + (size_t)y * width;
+			float4* destRow = dest.data() + (size_t)y * width;
+
+			// [avx2Begin, avx2End) 由 AVX2 核计算。边缘的像素需要读取图像外的 0，使用可移植的实现
+			uint32_t avx2Begin = 0;
+			uint32_t avx2End = 0;
+			if (useAvx2 && y > 0 && y + 1 < height && width >= AVX2_BATCH_SIZE + 2) {
+				avx2Begin = 1;
+				avx2End = 1 + (width - 2) / AVX2_BATCH_SIZE * AVX2_BATCH_SIZE;
+				for (uint32_t x = avx2Begin; x < avx2End; x += AVX2_BATCH_SIZE) {
+					FsrRcasAvx2(&srcRow[x].x, width, sharpness, &destRow[x].x);
+				}
+			}
+
+			for (uint32_t x = 0; x < avx2Begin; ++x) {
+				destRow[x] = rcasPixel(x, y);
+			}
+			for (uint32_t x = avx2End; x < width; ++x) {
+				destRow[x] = rcasPixel(x, y);
+			}
+		}
+	});
+
+	return true;
+}
+
+bool FsrCpu::Scale(
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight,
+	float sharpness
+) noexcept {
+	if (dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	std::vector<float4> upscaled;
+	try {
+		upscaled.resize((size_t)destWidth * destHeight);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	if (!Easu(src, srcWidth, srcHeight, upscaled, destWidth, destHeight)) {
+		return false;
+	}
+
+	return Rcas(upscaled, destWidth, destHeight, dest, sharpness);
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Float4.h"
+#include <span>
+
+namespace Magpie {
+
+// FSR 的 CPU 实现，分别复现 FSR/FSR_EASU.hlsl 和 FSR/FSR_RCAS.hlsl 的 FP32 路径。
+// 可用于在没有 GPU 时缩放图像，也可作为着色器输出的参考。输出的 Alpha 通道始终为 1。
+// 支持 AVX2 时每次计算一行中相邻的 8 个像素，结果和可移植的实现完全相同。
+struct FsrCpu {
+	static bool Easu(
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest,
+		uint32_t destWidth,
+		uint32_t destHeight
+	) noexcept;
+
+	// 输出尺寸和输入相同。sharpness 的默认值和效果相同
+	static bool Rcas(
+		std::span<const float4> src,
+		uint32_t width,
+		uint32_t height,
+		std::span<float4> dest,
+		float sharpness = 0.87f
+	) noexcept;
+
+	// 依次执行 EASU 和 RCAS，和 FSR 缩放模式相同
+	static bool Scale(
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest,
+		uint32_t destWidth,
+		uint32_t destHeight,
+		float sharpness = 0.87f
+	) noexcept;
+};
+
+}
@@ -0,0 +1,252 @@
+#include "FsrCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include "Avx2Helper.h"
+
+namespace Magpie {
+
+using namespace Avx2Helper;
+
+// 亮度的两倍，和 FSR 相同
+static __m256 FsrLuma(const Color8& color) noexcept {
+	return Add(Mul(color.b, Set(0.5f)), Add(Mul(color.r, Set(0.5f)), color.g));
+}
+
+// 和 FsrCpu.cpp 中的 FsrEasuSet 相同
+static void FsrEasuSet(
+	__m256& dirX,
+	__m256& dirY,
+	__m256& len,
+	__m256 w,
+	__m256 lA,
+	__m256 lB,
+	__m256 lC,
+	__m256 lD,
+	__m256 lE
+) noexcept {
+	const __m256 lenX = Saturate(Div(Abs(Sub(lD, lB)), Max(Abs(Sub(lD, lC)), Abs(Sub(lC, lB)))));
+	dirX = Add(dirX, Mul(Sub(lD, lB), w));
+	len = Add(len, Mul(Mul(lenX, lenX), w));
+
+	const __m256 lenY = Saturate(Div(Abs(Sub(lE, lA)), Max(Abs(Sub(lE, lC)), Abs(Sub(lC, lA)))));
+	dirY = Add(dirY, Mul(Sub(lE, lA), w));
+	len = Add(len, Mul(Mul(lenY, lenY), w));
+}
+
+namespace {
+
+// FsrEasuTap 中所有采样点共用的值
+struct EasuTapParams {
+	__m256 dirX;
+	__m256 dirY;
+	__m256 negDirY;
+	__m256 lenX;
+	__m256 lenY;
+	__m256 lob;
+	__m256 clp;
+};
+
+}
+
+// 和 FsrCpu.cpp 中的 FsrEasuTap 相同
+static void FsrEasuTap(
+	Color8& aC,
+	__m256& aW,
+	__m256 offX,
+	__m256 offY,
+	const EasuTapParams& params,
+	const Color8& c
+) noexcept {
+	const __m256 vX = Mul(Add(Mul(offX, params.dirX), Mul(offY, params.dirY)), params.lenX);
+	const __m256 vY = Mul(Add(Mul(offX, params.negDirY), Mul(offY, params.dirX)), params.lenY);
+	const __m256 d2 = Min(Add(Mul(vX, vX), Mul(vY, vY)), params.clp);
+
+	__m256 wB = Sub(Mul(Set(2.0f / 5.0f), d2), Set(1.0f));
+	__m256 wA = Sub(Mul(params.lob, d2), Set(1.0f));
+	wB = Mul(wB, wB);
+	wA = Mul(wA, wA);
+	wB = Sub(Mul(Set(25.0f / 16.0f), wB), Set(25.0f / 16.0f - 1.0f));
+	const __m256 w = Mul(wB, wA);
+
+	aC.r = Add(aC.r, Mul(c.r, w));
+	aC.g = Add(aC.g, Mul(c.g, w));
+	aC.b = Add(aC.b, Mul(c.b, w));
+	aW = Add(aW, w);
+}
+
+void FsrEasuAvx2(const float* const* origins, size_t stride, const float* fracX, float fracY, float* dest) noexcept {
+	const ptrdiff_t rowStride = (ptrdiff_t)stride * 4;
+
+	// 读取每个像素相对于 f 偏移 (dx, dy) 处的纹素
+	auto load = [&](int dx, int dy) {
+		const ptrdiff_t offset = dy * rowStride + dx * 4;
+		const float* const pixels[8] = {
+			origins[0] + offset, origins[1] + offset, origins[2] + offset, origins[3] + offset,
+			origins[4] + offset, origins[5] + offset, origins[6] + offset, origins[7] + offset
+		};
+		return Load8(pixels);
+	};
+
+	//    b c
+	//  e f g h
+	//  i j k l
+	//    n o
+	const Color8 b = load(0, -1);
+	const Color8 c = load(1, -1);
+	const Color8 e = load(-1, 0);
+	const Color8 f = load(0, 0);
+	const Color8 g = load(1, 0);
+	const Color8 h = load(2, 0);
+	const Color8 i = load(-1, 1);
+	const Color8 j = load(0, 1);
+	const Color8 k = load(1, 1);
+	const Color8 l = load(2, 1);
+	const Color8 n = load(0, 2);
+	const Color8 o = load(1, 2);
+
+	const __m256 bL = FsrLuma(b);
+	const __m256 cL = FsrLuma(c);
+	const __m256 eL = FsrLuma(e);
+	const __m256 fL = FsrLuma(f);
+	const __m256 gL = FsrLuma(g);
+	const __m256 hL = FsrLuma(h);
+	const __m256 iL = FsrLuma(i);
+	const __m256 jL = FsrLuma(j);
+	const __m256 kL = FsrLuma(k);
+	const __m256 lL = FsrLuma(l);
+	const __m256 nL = FsrLuma(n);
+	const __m256 oL = FsrLuma(o);
+
+	const __m256 ppX = _mm256_loadu_ps(fracX);
+	const __m256 ppY = Set(fracY);
+	const __m256 one = Set(1.0f);
+
+	__m256 dirX = _mm256_setzero_ps();
+	__m256 dirY = _mm256_setzero_ps();
+	__m256 len = _mm256_setzero_ps();
+	FsrEasuSet(dirX, dirY, len, Mul(Sub(one, ppX), Sub(one, ppY)), bL, eL, fL, gL, jL);
+	FsrEasuSet(dirX, dirY, len, Mul(ppX, Sub(one, ppY)), cL, fL, gL, hL, kL);
+	FsrEasuSet(dirX, dirY, len, Mul(Sub(one, ppX), ppY), fL, iL, jL, kL, nL);
+	FsrEasuSet(dirX, dirY, len, Mul(ppX, ppY), gL, jL, kL, lL, oL);
+
+	// 归一化，接近 0 时使用水平方向
+	__m256 dirR = Add(Mul(dirX, dirX), Mul(dirY, dirY));
+	const __m256 zro = Less(dirR, Set(1.0f / 32768.0f));
+	dirR = _mm256_blendv_ps(Div(one, _mm256_sqrt_ps(dirR)), one, zro);
+	dirX = _mm256_blendv_ps(dirX, one, zro);
+	dirX = Mul(dirX, dirR);
+	dirY = Mul(dirY, dirR);
+
+	len = Mul(len, Set(0.5f));
+	len = Mul(len, len);
+
+	const __m256 stretch = Div(Add(Mul(dirX, dirX), Mul(dirY, dirY)), Max(Abs(dirX), Abs(dirY)));
+	EasuTapParams params;
+	params.dirX = dirX;
+	params.dirY = dirY;
+	params.negDirY = Neg(dirY);
+	params.lenX = Add(one, Mul(Sub(stretch, one), len));
+	params.lenY = Sub(one, Mul(Set(0.5f), len));
+	params.lob = Add(Set(0.5f), Mul(Set((1.0f / 4.0f - 0.04f) - 0.5f), len));
+	params.clp = Div(one, params.lob);
+
+	auto off = [](float offset, __m256 pp) {
+		return Sub(Set(offset), pp);
+	};
+
+	Color8 aC{ _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+	__m256 aW = _mm256_setzero_ps();
+	FsrEasuTap(aC, aW, off(0.0f, ppX), off(-1.0f, ppY), params, b);
+	FsrEasuTap(aC, aW, off(1.0f, ppX), off(-1.0f, ppY), params, c);
+	FsrEasuTap(aC, aW, off(-1.0f, ppX), off(1.0f, ppY), params, i);
+	FsrEasuTap(aC, aW, off(0.0f, ppX), off(1.0f, ppY), params, j);
+	FsrEasuTap(aC, aW, off(0.0f, ppX), off(0.0f, ppY), params, f);
+	FsrEasuTap(aC, aW, off(-1.0f, ppX), off(0.0f, ppY), params, e);
+	FsrEasuTap(aC, aW, off(1.0f, ppX), off(1.0f, ppY), params, k);
+	FsrEasuTap(aC, aW, off(2.0f, ppX), off(1.0f, ppY), params, l);
+	FsrEasuTap(aC, aW, off(2.0f, ppX), off(0.0f, ppY), params, h);
+	FsrEasuTap(aC, aW, off(1.0f, ppX), off(0.0f, ppY), params, g);
+	FsrEasuTap(aC, aW, off(1.0f, ppX), off(2.0f, ppY), params, o);
+	FsrEasuTap(aC, aW, off(0.0f, ppX), off(2.0f, ppY), params, n);
+
+	// 去除振铃，限制在最近的 4 个像素的范围内
+	const __m256 rcpW = Div(one, aW);
+	auto deRing = [&](__m256 value, __m256 f, __m256 g, __m256 j, __m256 k) {
+		const __m256 min4 = Min(Min(f, g), Min(j, k));
+		const __m256 max4 = Max(Max(f, g), Max(j, k));
+		return Min(max4, Max(min4, Mul(value, rcpW)));
+	};
+
+	Store8({
+		deRing(aC.r, f.r, g.r, j.r, k.r),
+		deRing(aC.g, f.g, g.g, j.g, k.g),
+		deRing(aC.b, f.b, g.b, j.b, k.b),
+		one
+	}, dest);
+}
+
+void FsrRcasAvx2(const float* center, size_t stride, float sharpness, float* dest) noexcept {
+	//    b
+	//  d e f
+	//    h
+	const Color8 b = Load8(center - stride * 4);
+	const Color8 d = Load8(center - 4);
+	const Color8 e = Load8(center);
+	const Color8 f = Load8(center + 4);
+	const Color8 h = Load8(center + stride * 4);
+
+	const __m256 bL = FsrLuma(b);
+	const __m256 dL = FsrLuma(d);
+	const __m256 eL = FsrLuma(e);
+	const __m256 fL = FsrLuma(f);
+	const __m256 hL = FsrLuma(h);
+
+	// 噪声检测
+	const __m256 quarter = Set(0.25f);
+	__m256 nz = Sub(Add(Add(Add(Mul(quarter, bL), Mul(quarter, dL)), Mul(quarter, fL)), Mul(quarter, hL)), eL);
+	nz = Saturate(Div(Abs(nz), Sub(
+		Max(Max(Max(bL, dL), Max(eL, fL)), hL),
+		Min(Min(Min(bL, dL), Min(eL, fL)), hL))));
+	nz = Add(Mul(Set(-0.5f), nz), Set(1.0f));
+
+	auto calcLobe = [](__m256 b, __m256 d, __m256 c, __m256 f, __m256 h) {
+		const __m256 mn = Min(Min(b, d), Min(f, h));
+		const __m256 mx = Max(Max(b, d), Max(f, h));
+		const __m256 hitMin = Div(Min(mn, c), Mul(Set(4.0f), mx));
+		const __m256 hitMax = Div(Sub(Set(1.0f), Max(mx, c)), Sub(Mul(Set(4.0f), mn), Set(4.0f)));
+		return FMax(Neg(hitMin), hitMax);
+	};
+	const __m256 maxLobe = FMax(FMax(
+		calcLobe(b.r, d.r, e.r, f.r, h.r), calcLobe(b.g, d.g, e.g, f.g, h.g)), calcLobe(b.b, d.b, e.b, f.b, h.b));
+	// 和 FSR_RCAS_LIMIT 相同
+	__m256 lobe = Mul(FMax(Set(-(0.25f - 1.0f / 16.0f)), FMin(maxLobe, _mm256_setzero_ps())), Set(sharpness));
+	lobe = Mul(lobe, nz);
+
+	const __m256 rcpL = Div(Set(1.0f), Add(Mul(Set(4.0f), lobe), Set(1.0f)));
+	auto sharpen = [&](__m256 b, __m256 d, __m256 e, __m256 f, __m256 h) {
+		const __m256 sum = Add(Add(b, d), Add(h, f));
+		return Mul(Add(Mul(sum, lobe), e), rcpL);
+	};
+
+	Store8({
+		sharpen(b.r, d.r, e.r, f.r, h.r),
+		sharpen(b.g, d.g, e.g, f.g, h.g),
+		sharpen(b.b, d.b, e.b, f.b, h.b),
+		Set(1.0f)
+	}, dest);
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void FsrEasuAvx2(const float* const*, size_t, const float*, float, float*) noexcept {}
+
+void FsrRcasAvx2(const float*, size_t, float, float*) noexcept {}
+
+}
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+namespace Magpie {
+
+// FsrCpu 的 AVX2 核，每次计算 8 个像素，每个寄存器保存 8 个像素的同一个分量。乘法和加法不合并为 FMA，
+// min、max 等的语义也和可移植的实现相同，因此结果完全相同。stride 以 float4 为单位。
+
+// EASU。origins[p] 为第 p 个像素的 f 纹素，即 floor(pp) 处，它周围 [-1, 2] 范围内的纹素必须可读取。
+// fracX 为每个像素的 pp.x 的小数部分。结果以 RGBA 写入 dest，Alpha 为 1
+void FsrEasuAvx2(const float* const* origins, size_t stride, const float* fracX, float fracY, float* dest) noexcept;
+
+// RCAS。center 为一行中相邻的 8 个像素中的第一个，它们上下左右的像素必须可读取。
+// 结果以 RGBA 写入 dest，Alpha 为 1
+void FsrRcasAvx2(const float* center, size_t stride, float sharpness, float* dest) noexcept;
+
+}
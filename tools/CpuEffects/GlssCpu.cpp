@@ -0,0 +1,582 @@
+#include "GlssCpu.h"
+#include "CpuFeatures.h"
+#include "GlssCpuKernels.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+#include <cstring>
+#include <vector>
+
+namespace Magpie {
+
+// 每个任务处理的输出行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+// Lite 和 Fast 变体的 AVX2 核一次计算的像素数
+static constexpr uint32_t AVX2_BATCH_SIZE = 8;
+
+static float Luma(const float4& color) noexcept {
+	return color.x * GLSS_LUM_WEIGHTS[0] + color.y * GLSS_LUM_WEIGHTS[1] + color.z * GLSS_LUM_WEIGHTS[2];
+}
+
+// 对应着色器中的 MF 类型。FP16 为 true 时舍入到半精度，用于模拟 FP16 变体的精度损失
+template <bool FP16, typename T>
+static T ToMF(const T& value) noexcept {
+	if constexpr (FP16) {
+		return RoundToHalf(value);
+	} else {
+		return value;
+	}
+}
+
+template <bool FP16, size_t N>
+static void ToMF(float4(&window)[N][N]) noexcept {
+	if constexpr (FP16) {
+		for (auto& row : window) {
+			for (float4& texel : row) {
+				texel = RoundToHalf(texel);
+			}
+		}
+	}
+}
+
+static void AnalyzeWindow(const PaddedImage& image, float x, float y, GlssWindow& result) noexcept {
+	float4 window[7][7];
+	image.SampleWindow<3>(x, y, window);
+
+	for (int j = 0; j < 7; ++j) {
+		for (int i = 0; i < 7; ++i) {
+			std::memcpy(result.colors[j][i], &window[j][i], sizeof(float4));
+			result.lum[j][i] = Luma(window[j][i]);
+		}
+	}
+
+	const float centerLum = result.lum[3][3];
+	result.sobelX = result.sobelY = result.scharrX = result.scharrY = result.variance = 0;
+	for (int i = 0; i < 49; ++i) {
+		const float l = result.lum[i / 7][i % 7];
+		result.sobelX += l * GLSS_SOBEL_X[i];
+		result.sobelY += l * GLSS_SOBEL_Y[i];
+		result.scharrX += l * GLSS_SCHARR_X[i];
+		result.scharrY += l * GLSS_SCHARR_Y[i];
+		result.variance += (l - centerLum) * (l - centerLum);
+	}
+}
+
+// Bicubic.hlsl。原实现中锐化只基于输入颜色，去噪、频率融合和形态学抗锯齿的结果没有被使用，
+// 因此这里只计算影响输出的部分。FP16 为 true 时模拟 Bicubic - multipass.hlsl 的 FP16 变体：
+// 亮度和梯度求和使用 float，颜色、特征和重建通道使用 MF。
+template <bool FP16, bool AVX2>
+static float4 ScaleFull(const PaddedImage& image, const GlssParameters& params, float x, float y) noexcept {
+	GlssWindow analysis;
+	if constexpr (AVX2) {
+		float fx, fy;
+		const float4* origin = image.WindowOrigin<3>(x, y, fx, fy);
+		GlssAnalyzeWindowAvx2(&origin->x, image.Stride(), fx, fy, analysis);
+	} else {
+		AnalyzeWindow(image, x, y, analysis);
+	}
+
+	float4 window[7][7];
+	std::memcpy(window, analysis.colors, sizeof(window));
+	ToMF<FP16>(window);
+	const auto& lum = analysis.lum;
+
+	const float4 center = window[3][3];
+	const float centerLum = lum[3][3];
+
+	// 混合 7x7 Sobel 和 Scharr 梯度，同时计算纹理复杂度
+	const float sobelX = analysis.sobelX;
+	const float sobelY = analysis.sobelY;
+	const float scharrX = analysis.scharrX;
+	const float scharrY = analysis.scharrY;
+	const float variance = analysis.variance;
+
+	const float gradX = Lerp(sobelX / 120.0f, scharrX / 480.0f, 0.5f);
+	const float gradY = Lerp(sobelY / 120.0f, scharrY / 480.0f, 0.5f);
+	const float magnitude = std::sqrt(gradX * gradX + gradY * gradY);
+	const float complexity = std::sqrt(variance / 49.0f);
+
+	// 方向场：原始方向和相距 2 个像素的 8 个邻域的 3x3 Sobel 方向的混合
+	float dirX = 1.0f;
+	float dirY = 0.0f;
+	if (magnitude >= 0.001f) {
+		dirX = gradX / magnitude;
+		dirY = gradY / magnitude;
+
+		float avgX = 0, avgY = 0;
+		float count = 0;
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				if (dx == 0 && dy == 0) {
+					continue;
+				}
+
+				const int cx = 3 + dx * 2;
+				const int cy = 3 + dy * 2;
+				const float neighborX = (-lum[cy - 1][cx - 1] - 2 * lum[cy][cx - 1] - lum[cy + 1][cx - 1]
+					+ lum[cy - 1][cx + 1] + 2 * lum[cy][cx + 1] + lum[cy + 1][cx + 1]) / 4.0f;
+				const float neighborY = (-lum[cy - 1][cx - 1] - 2 * lum[cy - 1][cx] - lum[cy - 1][cx + 1]
+					+ lum[cy + 1][cx - 1] + 2 * lum[cy + 1][cx] + lum[cy + 1][cx + 1]) / 4.0f;
+
+				const float neighborLength = std::sqrt(neighborX * neighborX + neighborY * neighborY);
+				if (neighborLength > 0.01f) {
+					avgX += neighborX / neighborLength;
+					avgY += neighborY / neighborLength;
+					count += 1.0f;
+				}
+			}
+		}
+
+		if (count > 0) {
+			avgX /= count;
+			avgY /= count;
+			const float avgLength = std::sqrt(avgX * avgX + avgY * avgY);
+			dirX = Lerp(dirX, avgX / avgLength, 0.3f);
+			dirY = Lerp(dirY, avgY / avgLength, 0.3f);
+		}
+	}
+
+	// 梯度一致性：正交方向和梯度方向上亮度变化之比
+	const float alongChange =
+		std::abs(Luma(image.Sample(x + dirX * 3.0f, y + dirY * 3.0f)) - centerLum) +
+		std::abs(Luma(image.Sample(x - dirX * 3.0f, y - dirY * 3.0f)) - centerLum);
+	const float orthoChange =
+		std::abs(Luma(image.Sample(x - dirY * 3.0f, y + dirX * 3.0f)) - centerLum) +
+		std::abs(Luma(image.Sample(x + dirY * 3.0f, y - dirX * 3.0f)) - centerLum);
+	const float coherence = Saturate(orthoChange / (alongChange + 0.001f));
+
+	// 重建时使用的特征
+	const float featureGradX = ToMF<FP16>(gradX);
+	const float featureGradY = ToMF<FP16>(gradY);
+	const float featureComplexity = ToMF<FP16>(complexity);
+	const float featureCoherence = ToMF<FP16>(coherence);
+	const float edgeStrength = std::max(std::abs(featureGradX), std::abs(featureGradY));
+	const float confidence = ToMF<FP16>(Saturate(std::sqrt(featureGradX * featureGradX + featureGradY * featureGradY) * 5.0f)
+		* featureCoherence * (1.0f - Saturate(featureComplexity * 2.0f)));
+
+	// 3x3、5x5 和 7x7 拉普拉斯
+	float4 sum7x7 = float4();
+	float4 sum5x5 = float4();
+	for (int j = 0; j < 7; ++j) {
+		for (int i = 0; i < 7; ++i) {
+			sum7x7 += window[j][i];
+			if (j >= 1 && j <= 5 && i >= 1 && i <= 5) {
+				sum5x5 += window[j][i];
+			}
+		}
+	}
+
+	const float4 sumCross = window[2][3] + window[4][3] + (window[3][2] + window[3][4]);
+	const float4 sumDiagonal = window[2][2] + window[2][4] + (window[4][2] + window[4][4]);
+
+	const float4 ultraFineDetails = center * 4.0f - sumCross;
+	const float4 fineDetails = (center * 25.0f - sum5x5) * (1.0f / 24.0f);
+	const float4 mediumDetails = (center * 49.0f - sum7x7) * (1.0f / 48.0f);
+
+	// 自适应锐化
+	float adaptiveSharp = params.sharpness;
+	adaptiveSharp = ToMF<FP16>(Lerp(adaptiveSharp * 0.3f, adaptiveSharp, confidence));
+	adaptiveSharp = ToMF<FP16>(Lerp(adaptiveSharp, adaptiveSharp * 0.5f, featureComplexity));
+	adaptiveSharp = ToMF<FP16>(Lerp(adaptiveSharp, adaptiveSharp * 1.5f, edgeStrength));
+	adaptiveSharp = ToMF<FP16>(Lerp(adaptiveSharp * 0.5f, adaptiveSharp, featureCoherence));
+
+	float4 diff = mediumDetails * 0.3f;
+	diff = fineDetails * 0.4f + diff;
+	diff = ultraFineDetails * 0.3f + diff;
+	diff = ToMF<FP16>(ToMF<FP16>(diff) * adaptiveSharp);
+
+	// 振铃控制
+	const float4 maxSharpen(ToMF<FP16>(0.15f + confidence * 0.1f));
+	diff = Clamp(diff, -maxSharpen, maxSharpen);
+	const float4 sharpened = ToMF<FP16>(Saturate(diff + center));
+
+	// 柔化
+	float4 finalColor = sharpened;
+	if (params.softness > 0.0f) {
+		float4 soft = sumCross * 0.1f;
+		soft = ToMF<FP16>(sumDiagonal * 0.05f + soft);
+		const float4 softResult = ToMF<FP16>((sharpened + soft) * (1.0f / 1.6f));
+		finalColor = ToMF<FP16>(Lerp(sharpened, softResult, ToMF<FP16>(params.softness) * 0.5f));
+	}
+
+	return Saturate(finalColor);
+}
+
+static float BicubicWeight(float x, float B, float C) noexcept {
+	const float ax = std::abs(x);
+
+	if (ax < 1.0f) {
+		return (x * x * ((12.0f - 9.0f * B - 6.0f * C) * ax + (-18.0f + 12.0f * B + 6.0f * C)) + (6.0f - 2.0f * B)) / 6.0f;
+	} else if (ax < 2.0f) {
+		return (x * x * ((-B - 6.0f * C) * ax + (6.0f * B + 30.0f * C)) + (-12.0f * B - 48.0f * C) * ax + (8.0f * B + 24.0f * C)) / 6.0f;
+	} else {
+		return 0.0f;
+	}
+}
+
+// 以 (x, y) 为中心、间距为 scale 个像素的 3x3 高斯模糊
+static float4 SimpleGaussianBlur(const PaddedImage& image, float x, float y, float scale) noexcept {
+	float4 result = float4();
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			const float4 texel = image.Sample(x + (i - 1) * scale, y + (j - 1) * scale);
+			result = texel * GLSS_GAUSSIAN_WEIGHTS[j * 3 + i] + result;
+		}
+	}
+	return result;
+}
+
+static float4 SimpleGaussianBlur(const float4(&window)[3][3]) noexcept {
+	float4 result = float4();
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			result = window[j][i] * GLSS_GAUSSIAN_WEIGHTS[j * 3 + i] + result;
+		}
+	}
+	return result;
+}
+
+static void SobelGradient(const float4(&window)[3][3], float& gradX, float& gradY) noexcept {
+	float lum[3][3];
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			lum[j][i] = Luma(window[j][i]);
+		}
+	}
+
+	gradX = -lum[0][0] - 2.0f * lum[1][0] - lum[2][0] + lum[0][2] + 2.0f * lum[1][2] + lum[2][2];
+	gradY = -lum[0][0] - 2.0f * lum[0][1] - lum[0][2] + lum[2][0] + 2.0f * lum[2][1] + lum[2][2];
+}
+
+static float4 Laplacian3x3(const float4(&window)[3][3]) noexcept {
+	const float4 sumCross = window[0][1] + window[2][1] + (window[1][0] + window[1][2]);
+	return window[1][1] * 4.0f - sumCross;
+}
+
+static float DetectNoise(const float4& center, const float4& blurred, float gradMagnitude, float noiseThreshold) noexcept {
+	const float noiseEnergy = Length3(Abs(center - blurred));
+	const float edgeMask = Saturate(gradMagnitude * 2.0f);
+	const float adjustedNoise = noiseEnergy * (1.0f - edgeMask * 0.2f);
+	return Saturate(adjustedNoise - noiseThreshold) / (1.0f - noiseThreshold);
+}
+
+// 沿边缘方向和正交方向各采样两个点的平均值
+static float4 EdgeAverage(const PaddedImage& image, float x, float y, float edgeX, float edgeY) noexcept {
+	float4 result = image.Sample(x + edgeX * 0.5f, y + edgeY * 0.5f);
+	result = result + image.Sample(x - edgeX * 0.5f, y - edgeY * 0.5f);
+	result = result + image.Sample(x - edgeY * 0.5f, y + edgeX * 0.5f);
+	result = result + image.Sample(x + edgeY * 0.5f, y - edgeX * 0.5f);
+	return result * 0.25f;
+}
+
+// Bicubic - lite.hlsl
+template <bool FP16>
+static float4 ScaleLite(const PaddedImage& image, const GlssParameters& params, float x, float y) noexcept {
+	const float B = 0.25f + params.detail * 0.25f;
+	const float C = 0.5f - params.detail * 0.3f;
+	const float lowFreqBoost = 0.9f + params.detail * 0.2f;
+	const float midFreqBoost = 1.2f + params.sharpness * 0.6f;
+	const float highFreqBoost = 2.0f + params.sharpness * 1.2f;
+	const float noiseThreshold = 0.01f + params.denoise * 0.02f;
+
+	// 双三次插值，采样点均位于纹素中心
+	const float floorX = std::floor(x - 0.5f);
+	const float floorY = std::floor(y - 0.5f);
+	const float subX = x - floorX - 0.5f;
+	const float subY = y - floorY - 0.5f;
+
+	float rowWeights[4];
+	float colWeights[4];
+	float rowSum = 0;
+	float colSum = 0;
+	for (int i = 0; i < 4; ++i) {
+		rowWeights[i] = BicubicWeight(1.0f - subX + (i - 2), B, C);
+		colWeights[i] = BicubicWeight(1.0f - subY + (i - 2), B, C);
+		rowSum += rowWeights[i];
+		colSum += colWeights[i];
+	}
+
+	// 权重在 float 中归一化后才转换为 MF
+	float4 bicubicResult = float4();
+	for (int j = 0; j < 4; ++j) {
+		float4 rowResult = float4();
+		for (int i = 0; i < 4; ++i) {
+			const float4 texel = ToMF<FP16>(image.Texel((int)floorX + i - 1, (int)floorY + j - 1));
+			rowResult = ToMF<FP16>(texel * ToMF<FP16>(rowWeights[i] / rowSum) + rowResult);
+		}
+		bicubicResult = ToMF<FP16>(rowResult * ToMF<FP16>(colWeights[j] / colSum) + bicubicResult);
+	}
+
+	float4 window[3][3];
+	image.SampleWindow<1>(x, y, window);
+	ToMF<FP16>(window);
+	const float4 center = window[1][1];
+
+	// 梯度，长度限制为 0.15 以防止振铃
+	float gradX, gradY;
+	SobelGradient(window, gradX, gradY);
+	gradX = ToMF<FP16>(gradX);
+	gradY = ToMF<FP16>(gradY);
+	float gradMagnitude = ToMF<FP16>(std::sqrt(gradX * gradX + gradY * gradY));
+	if (gradMagnitude > 0.15f) {
+		gradX = gradX / gradMagnitude * 0.15f;
+		gradY = gradY / gradMagnitude * 0.15f;
+		gradMagnitude = 0.15f;
+	}
+
+	float edgeX = 1.0f;
+	float edgeY = 0.0f;
+	if (gradMagnitude >= 0.001f) {
+		edgeX = gradX / gradMagnitude;
+		edgeY = gradY / gradMagnitude;
+	}
+
+	// 频率增强
+	const float4 lowFreq = ToMF<FP16>(SimpleGaussianBlur(image, x, y, 1.5f));
+	const float4 midFreq = ToMF<FP16>(ToMF<FP16>(SimpleGaussianBlur(image, x, y, 0.8f)) - lowFreq);
+	const float4 highFreq = ToMF<FP16>(bicubicResult - ToMF<FP16>(SimpleGaussianBlur(image, x, y, 0.5f)));
+
+	float4 enhanced = ToMF<FP16>(lowFreq * (lowFreqBoost * 0.9f));
+	enhanced = ToMF<FP16>(midFreq * midFreqBoost + enhanced);
+	enhanced = ToMF<FP16>(highFreq * (highFreqBoost * 1.2f) + enhanced);
+
+	// 自适应去噪
+	float4 denoised = enhanced;
+	const float noiseLevel = ToMF<FP16>(
+		DetectNoise(center, ToMF<FP16>(SimpleGaussianBlur(window)), gradMagnitude, noiseThreshold));
+	if (noiseLevel > 0.05f) {
+		static constexpr int OFFSETS[4][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+		const float centerLum = Luma(center);
+		float4 filtered = center;
+		float totalWeight = 1.0f;
+		for (const auto& offset : OFFSETS) {
+			for (int sign = 1; sign >= -1; sign -= 2) {
+				const float4 texel = window[1 + offset[1] * sign][1 + offset[0] * sign];
+				const float colorDiff = Luma(texel) - centerLum;
+				const float weight = ToMF<FP16>(
+					0.2f * std::exp(-colorDiff * colorDiff / (2.0f * noiseThreshold * noiseThreshold)));
+				filtered = ToMF<FP16>(texel * weight + filtered);
+				totalWeight = ToMF<FP16>(totalWeight + weight);
+			}
+		}
+
+		denoised = ToMF<FP16>(Lerp(enhanced,
+			ToMF<FP16>(filtered * (1.0f / totalWeight)), params.denoise * 0.8f * noiseLevel));
+	}
+
+	// 抗锯齿
+	const float4 aaResult = ToMF<FP16>(Lerp(
+		center, ToMF<FP16>(EdgeAverage(image, x, y, edgeX, edgeY)), params.aaStrength * 0.6f));
+	const float4 antiAliased = ToMF<FP16>(
+		Lerp(denoised, aaResult, Saturate(gradMagnitude * 3.0f) * params.aaStrength));
+
+	// 自适应锐化，振铃控制
+	const float4 maxSharpen(0.1f);
+	const float4 diff = Clamp(ToMF<FP16>(Laplacian3x3(window) * (params.sharpness * 0.3f)),
+		-maxSharpen, maxSharpen);
+	return ToMF<FP16>(Saturate(diff + antiAliased));
+}
+
+// Bicubic - fast.hlsl
+template <bool FP16>
+static float4 ScaleFast(const PaddedImage& image, const GlssParameters& params, float x, float y) noexcept {
+	const float lowFreqBoost = 0.9f + params.detail * 0.2f;
+	const float midFreqBoost = 1.2f + params.sharpness * 0.6f;
+	const float highFreqBoost = 2.0f + params.sharpness * 1.2f;
+	const float edgeThreshold = 0.02f + params.aaStrength * 0.02f;
+	const float noiseThreshold = 0.01f + params.denoise * 0.02f;
+
+	float4 window[3][3];
+	image.SampleWindow<1>(x, y, window);
+	ToMF<FP16>(window);
+	const float4 center = window[1][1];
+
+	// 双线性插值，采样点均位于纹素中心，然后模拟锐化
+	float4 baseColor;
+	{
+		const float floorX = std::floor(x - 0.5f);
+		const float floorY = std::floor(y - 0.5f);
+		const float subX = x - floorX - 0.5f;
+		const float subY = y - floorY - 0.5f;
+
+		const float4 samples[4] = {
+			ToMF<FP16>(image.Texel((int)floorX, (int)floorY)),
+			ToMF<FP16>(image.Texel((int)floorX + 1, (int)floorY)),
+			ToMF<FP16>(image.Texel((int)floorX, (int)floorY + 1)),
+			ToMF<FP16>(image.Texel((int)floorX + 1, (int)floorY + 1))
+		};
+		const float w1X = ToMF<FP16>(1.0f - ToMF<FP16>(subX));
+		const float w1Y = ToMF<FP16>(1.0f - ToMF<FP16>(subY));
+		const float weights[4] = {
+			ToMF<FP16>(w1X * w1Y),
+			ToMF<FP16>(ToMF<FP16>(subX) * w1Y),
+			ToMF<FP16>(w1X * ToMF<FP16>(subY)),
+			ToMF<FP16>(ToMF<FP16>(subX) * ToMF<FP16>(subY))
+		};
+
+		float4 bilinearResult = float4();
+		float4 sum = float4();
+		for (int i = 0; i < 4; ++i) {
+			bilinearResult = ToMF<FP16>(samples[i] * weights[i] + bilinearResult);
+			sum = ToMF<FP16>(sum + samples[i]);
+		}
+
+		const float4 laplacian = ToMF<FP16>(bilinearResult * 4.0f - sum * 0.25f);
+		baseColor = ToMF<FP16>(laplacian * (params.sharpness * 0.1f) + bilinearResult);
+	}
+
+	// 梯度，每个分量限制在 [-0.15, 0.15]
+	float gradX, gradY;
+	SobelGradient(window, gradX, gradY);
+	gradX = ToMF<FP16>(std::clamp(gradX, -0.15f, 0.15f));
+	gradY = ToMF<FP16>(std::clamp(gradY, -0.15f, 0.15f));
+	const float gradMagnitude = ToMF<FP16>(std::sqrt(gradX * gradX + gradY * gradY));
+
+	float edgeX = 1.0f;
+	float edgeY = 0.0f;
+	if (gradMagnitude >= 0.001f) {
+		edgeX = gradX / gradMagnitude;
+		edgeY = gradY / gradMagnitude;
+	}
+
+	const float4 laplacian = ToMF<FP16>(Laplacian3x3(window));
+	const float4 gaussian = ToMF<FP16>(SimpleGaussianBlur(window));
+
+	// 频率增强
+	float4 enhanced = ToMF<FP16>(gaussian * lowFreqBoost);
+	enhanced = ToMF<FP16>(ToMF<FP16>(baseColor - gaussian) * midFreqBoost + enhanced);
+	enhanced = ToMF<FP16>(laplacian * (highFreqBoost * 0.3f) + enhanced);
+
+	// 自适应去噪
+	float4 denoised = enhanced;
+	const float noiseLevel = ToMF<FP16>(DetectNoise(center, gaussian, gradMagnitude, noiseThreshold));
+	if (noiseLevel > 0.05f) {
+		const float centerLum = Luma(center);
+		const float sigmaColor = noiseThreshold * noiseThreshold * 2.0f;
+
+		float4 filtered = center;
+		float totalWeight = 1.0f;
+		for (const float4& texel : { window[0][1], window[1][0], window[1][2], window[2][1] }) {
+			const float colorDiff = Luma(texel) - centerLum;
+			const float weight = ToMF<FP16>(0.2f * std::exp(-colorDiff * colorDiff / sigmaColor));
+			filtered = ToMF<FP16>(texel * weight + filtered);
+			totalWeight = ToMF<FP16>(totalWeight + weight);
+		}
+
+		denoised = ToMF<FP16>(Lerp(enhanced,
+			ToMF<FP16>(filtered * (1.0f / totalWeight)), params.denoise * 0.8f * noiseLevel));
+	}
+
+	// 抗锯齿
+	float4 aaResult = denoised;
+	if (gradMagnitude > edgeThreshold) {
+		aaResult = ToMF<FP16>(Lerp(
+			denoised, ToMF<FP16>(EdgeAverage(image, x, y, edgeX, edgeY)), params.aaStrength * 0.6f));
+	}
+
+	// 锐化
+	return ToMF<FP16>(Saturate(laplacian * (params.sharpness * 0.15f) + aaResult));
+}
+
+bool GlssCpu::Scale(
+	GlssVariant variant,
+	const GlssParameters& params,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight,
+	bool emulateFP16
+) noexcept {
+	if (srcWidth == 0 || srcHeight == 0 || destWidth == 0 || destHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	PaddedImage image;
+	if (!image.Initialize(src, srcWidth, srcHeight)) {
+		return false;
+	}
+
+	float4(*scaleFunc)(const PaddedImage&, const GlssParameters&, float, float) noexcept;
+	if (CpuFeatures::IsAvx2Enabled()) {
+		scaleFunc = emulateFP16 ? ScaleFull<true, true> : ScaleFull<false, true>;
+	} else {
+		scaleFunc = emulateFP16 ? ScaleFull<true, false> : ScaleFull<false, false>;
+	}
+	if (variant == GlssVariant::Lite) {
+		scaleFunc = emulateFP16 ? ScaleLite<true> : ScaleLite<false>;
+	} else if (variant == GlssVariant::Fast) {
+		scaleFunc = emulateFP16 ? ScaleFast<true> : ScaleFast<false>;
+	}
+
+	// Lite 和 Fast 变体在支持时每次计算 8 个像素
+	void(*batchFunc)(const GlssBatch&, float*) noexcept = nullptr;
+	if (CpuFeatures::IsAvx2Enabled()) {
+		if (variant == GlssVariant::Lite) {
+			batchFunc = GlssLiteAvx2;
+		} else if (variant == GlssVariant::Fast) {
+			batchFunc = GlssFastAvx2;
+		}
+	}
+
+	const float scaleX = (float)srcWidth / destWidth;
+	const float scaleY = (float)srcHeight / destHeight;
+
+	// 每个输出列在源图像中的横坐标，供 AVX2 核使用
+	std::vector<float> columnsX;
+	if (batchFunc) {
+		try {
+			columnsX.resize(destWidth);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		for (uint32_t x = 0; x < destWidth; ++x) {
+			columnsX[x] = (x + 0.5f) * scaleX;
+		}
+	}
+
+	// 输出按行划分为条带并行处理，同一条带访问的源图像行相邻，可以更好地利用缓存
+	const uint32_t bandCount = (destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float srcY = (y + 0.5f) * scaleY;
+			float4* destRow = dest.data() + (size_t)y * destWidth;
+
+			uint32_t x = 0;
+			if (batchFunc) {
+				GlssBatch batch;
+				batch.sharpness = params.sharpness;
+				batch.denoise = params.denoise;
+				batch.aaStrength = params.aaStrength;
+				batch.detail = params.detail;
+				batch.emulateFP16 = emulateFP16;
+				batch.pixels = &image.Texel(-PaddedImage::PADDING, -PaddedImage::PADDING).x;
+				batch.stride = image.Stride();
+				batch.paddedHeight = image.PaddedHeight();
+				batch.padding = PaddedImage::PADDING;
+				batch.y = srcY;
+
+				for (; x + AVX2_BATCH_SIZE <= destWidth; x += AVX2_BATCH_SIZE) {
+					batch.x = &columnsX[x];
+					batchFunc(batch, &destRow[x].x);
+				}
+			}
+
+			// 剩余的像素使用可移植的实现
+			for (; x < destWidth; ++x) {
+				const float4 color = scaleFunc(image, params, (x + 0.5f) * scaleX, srcY);
+				destRow[x] = WithAlpha(color, 1.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Float4.h"
+#include <span>
+
+namespace Magpie {
+
+enum class GlssVariant {
+	// Glss/Bicubic.hlsl
+	Full,
+	// Glss/Bicubic - lite.hlsl
+	Lite,
+	// Glss/Bicubic - fast.hlsl
+	Fast
+};
+
+// 和 GLss 效果的参数一一对应，默认值也相同。Lite 和 Fast 没有 Softness 参数
+struct GlssParameters {
+	float sharpness = 1.8f;
+	float denoise = 0.4f;
+	float aaStrength = 0.6f;
+	float detail = 0.8f;
+	float softness = 0.3f;
+};
+
+// GLss 的 CPU 实现，逐像素复现着色器的计算，包括 LINEAR 采样器的双线性插值和 CLAMP 寻址。
+// 可用于在没有 GPU 时缩放图像，也可作为着色器输出的参考。输出的 Alpha 通道始终为 1。
+// 支持 AVX2 时，完整变体的窗口采样和梯度使用 AVX2，只有 FMA 引入的舍入误差；Lite 和 Fast 变体每次计算
+// 8 个像素，结果和可移植的实现完全相同。ARM64 上尚无 NEON 实现，所有变体按 float4 逐分量计算。
+struct GlssCpu {
+	// emulateFP16 为 true 时把着色器中 MF 类型的中间结果舍入到半精度，模拟支持 FP16 时的输出。
+	// Full 变体此时模拟的是 Bicubic - multipass.hlsl。tests/GlssAccuracyTest 以此检查 FP16 变体的误差。
+	static bool Scale(
+		GlssVariant variant,
+		const GlssParameters& params,
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest,
+		uint32_t destWidth,
+		uint32_t destHeight,
+		bool emulateFP16 = false
+	) noexcept;
+};
+
+}
@@ -0,0 +1,591 @@
+#include "GlssCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include "Avx2Helper.h"
+#include <cmath>
+
+namespace Magpie {
+
+using namespace Avx2Helper;
+
+static float HorizontalSum(__m256 value) noexcept {
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+	return _mm_cvtss_f32(sum);
+}
+
+// 每个寄存器保存两个相邻采样点，一行的 7 个采样点占 4 个寄存器，最后一个的高半部分不使用
+void GlssAnalyzeWindowAvx2(const float* origin, size_t stride, float fx, float fy, GlssWindow& window) noexcept {
+	const __m256 fxv = _mm256_set1_ps(fx);
+	const __m256 fyv = _mm256_set1_ps(fy);
+	const __m256 lumWeights = _mm256_setr_ps(
+		GLSS_LUM_WEIGHTS[0], GLSS_LUM_WEIGHTS[1], GLSS_LUM_WEIGHTS[2], 0.0f,
+		GLSS_LUM_WEIGHTS[0], GLSS_LUM_WEIGHTS[1], GLSS_LUM_WEIGHTS[2], 0.0f
+	);
+	// 水平相加后亮度的顺序为 0, 2, 4, 6, 1, 3, 5, 7
+	const __m256i lumOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	// 只有前 7 个分量有效
+	const __m256i rowMask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, -1, 0);
+
+	__m256 lumRows[7];
+	__m256 prevRow[4];
+	for (int j = 0; j < 8; ++j) {
+		// 水平插值。最后一个寄存器读取了第 9 个纹素，PaddedImage 的填充保证它可以读取
+		const float* texels = origin + (size_t)j * stride * 4;
+		__m256 curRow[4];
+		for (int p = 0; p < 4; ++p) {
+			const __m256 left = _mm256_loadu_ps(texels + p * 8);
+			const __m256 right = _mm256_loadu_ps(texels + p * 8 + 4);
+			curRow[p] = _mm256_fmadd_ps(_mm256_sub_ps(right, left), fxv, left);
+		}
+
+		if (j > 0) {
+			// 竖直插值得到窗口的第 j - 1 行
+			float* colors = window.colors[j - 1][0];
+			__m256 lumParts[4];
+			for (int p = 0; p < 4; ++p) {
+				const __m256 color = _mm256_fmadd_ps(_mm256_sub_ps(curRow[p], prevRow[p]), fyv, prevRow[p]);
+				if (p < 3) {
+					_mm256_storeu_ps(colors + p * 8, color);
+				} else {
+					_mm_storeu_ps(colors + 24, _mm256_castps256_ps128(color));
+				}
+				lumParts[p] = _mm256_mul_ps(color, lumWeights);
+			}
+
+			// 和 x * 0.299 + y * 0.587 + z * 0.114 的求值顺序相同
+			const __m256 lum = _mm256_hadd_ps(
+				_mm256_hadd_ps(lumParts[0], lumParts[1]),
+				_mm256_hadd_ps(lumParts[2], lumParts[3])
+			);
+			lumRows[j - 1] = _mm256_permutevar8x32_ps(lum, lumOrder);
+			_mm256_maskstore_ps(window.lum[j - 1], rowMask, lumRows[j - 1]);
+		}
+
+		for (int p = 0; p < 4; ++p) {
+			prevRow[p] = curRow[p];
+		}
+	}
+
+	const __m256 centerLum = _mm256_set1_ps(window.lum[3][3]);
+	const __m256 validLanes = _mm256_castsi256_ps(rowMask);
+
+	__m256 sobelX = _mm256_setzero_ps();
+	__m256 sobelY = _mm256_setzero_ps();
+	__m256 scharrX = _mm256_setzero_ps();
+	__m256 scharrY = _mm256_setzero_ps();
+	__m256 variance = _mm256_setzero_ps();
+	for (int j = 0; j < 7; ++j) {
+		// 第 8 个分量读取为 0
+		const __m256 lum = lumRows[j];
+		sobelX = _mm256_fmadd_ps(lum, _mm256_maskload_ps(GLSS_SOBEL_X + j * 7, rowMask), sobelX);
+		sobelY = _mm256_fmadd_ps(lum, _mm256_maskload_ps(GLSS_SOBEL_Y + j * 7, rowMask), sobelY);
+		scharrX = _mm256_fmadd_ps(lum, _mm256_maskload_ps(GLSS_SCHARR_X + j * 7, rowMask), scharrX);
+		scharrY = _mm256_fmadd_ps(lum, _mm256_maskload_ps(GLSS_SCHARR_Y + j * 7, rowMask), scharrY);
+
+		const __m256 diff = _mm256_and_ps(_mm256_sub_ps(lum, centerLum), validLanes);
+		variance = _mm256_fmadd_ps(diff, diff, variance);
+	}
+
+	window.sobelX = HorizontalSum(sobelX);
+	window.sobelY = HorizontalSum(sobelY);
+	window.scharrX = HorizontalSum(scharrX);
+	window.scharrY = HorizontalSum(scharrY);
+	window.variance = HorizontalSum(variance);
+}
+
+// 以下为 Lite 和 Fast 变体的 AVX2 核，每个函数和 GlssCpu.cpp 中的同名函数相同，只计算 RGB
+
+static Color8 Add(const Color8& a, const Color8& b) noexcept {
+	return { Add(a.r, b.r), Add(a.g, b.g), Add(a.b, b.b), a.a };
+}
+
+static Color8 Sub(const Color8& a, const Color8& b) noexcept {
+	return { Sub(a.r, b.r), Sub(a.g, b.g), Sub(a.b, b.b), a.a };
+}
+
+static Color8 Mul(const Color8& a, __m256 b) noexcept {
+	return { Mul(a.r, b), Mul(a.g, b), Mul(a.b, b), a.a };
+}
+
+// a * b + c
+static Color8 MulAdd(const Color8& a, __m256 b, const Color8& c) noexcept {
+	return Add(Mul(a, b), c);
+}
+
+static Color8 Lerp(const Color8& a, const Color8& b, __m256 t) noexcept {
+	return { Lerp(a.r, b.r, t), Lerp(a.g, b.g, t), Lerp(a.b, b.b, t), a.a };
+}
+
+static Color8 Select(__m256 mask, const Color8& ifTrue, const Color8& ifFalse) noexcept {
+	return {
+		Select(mask, ifTrue.r, ifFalse.r),
+		Select(mask, ifTrue.g, ifFalse.g),
+		Select(mask, ifTrue.b, ifFalse.b),
+		ifFalse.a
+	};
+}
+
+static Color8 Saturate(const Color8& value) noexcept {
+	return { Saturate(value.r), Saturate(value.g), Saturate(value.b), value.a };
+}
+
+static Color8 Clamp(const Color8& value, __m256 low, __m256 high) noexcept {
+	return {
+		Min(Max(value.r, low), high),
+		Min(Max(value.g, low), high),
+		Min(Max(value.b, low), high),
+		value.a
+	};
+}
+
+static Color8 Zero8() noexcept {
+	const __m256 zero = _mm256_setzero_ps();
+	return { zero, zero, zero, zero };
+}
+
+// 和 RoundToHalf 相同
+template <bool FP16>
+static __m256 ToMF(__m256 value) noexcept {
+	if constexpr (FP16) {
+		return _mm256_cvtph_ps(_mm256_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+	} else {
+		return value;
+	}
+}
+
+template <bool FP16>
+static Color8 ToMF(const Color8& value) noexcept {
+	return { ToMF<FP16>(value.r), ToMF<FP16>(value.g), ToMF<FP16>(value.b), value.a };
+}
+
+static __m256 Luma(const Color8& color) noexcept {
+	return Add(Add(Mul(color.r, Set(GLSS_LUM_WEIGHTS[0])), Mul(color.g, Set(GLSS_LUM_WEIGHTS[1]))),
+		Mul(color.b, Set(GLSS_LUM_WEIGHTS[2])));
+}
+
+// 逐像素调用 expf，和可移植的实现中的 std::exp 相同
+static __m256 Exp(__m256 value) noexcept {
+	alignas(32) float values[8];
+	_mm256_store_ps(values, value);
+	for (float& v : values) {
+		v = expf(v);
+	}
+	return _mm256_load_ps(values);
+}
+
+// 和 std::clamp 相同，有 NaN 时返回 value
+static __m256 ClampScalar(__m256 value, float low, float high) noexcept {
+	const __m256 result = Select(Less(Set(high), value), Set(high), value);
+	return Select(Less(value, Set(low)), Set(low), result);
+}
+
+// 每个像素读取 left 和 top 处的纹素，它们是包括填充在内的索引
+static Color8 LoadTexels(const GlssBatch& batch, __m256i left, __m256i top, int offsetX, int offsetY) noexcept {
+	alignas(32) int32_t lefts[8];
+	alignas(32) int32_t tops[8];
+	_mm256_store_si256((__m256i*)lefts, left);
+	_mm256_store_si256((__m256i*)tops, top);
+
+	const float* pixels[8];
+	for (int i = 0; i < 8; ++i) {
+		pixels[i] = batch.pixels + ((size_t)(tops[i] + offsetY) * batch.stride + lefts[i] + offsetX) * 4;
+	}
+	return Load8(pixels);
+}
+
+// 和 PaddedImage::Sample 相同
+static Color8 Sample(const GlssBatch& batch, __m256 x, __m256 y) noexcept {
+	const __m256 tx = Sub(x, Set(0.5f));
+	const __m256 ty = Sub(y, Set(0.5f));
+	const __m256 floorX = _mm256_floor_ps(tx);
+	const __m256 floorY = _mm256_floor_ps(ty);
+	const __m256 fx = Sub(tx, floorX);
+	const __m256 fy = Sub(ty, floorY);
+
+	// 超出填充范围时钳位
+	const __m256i padding = _mm256_set1_epi32(batch.padding);
+	const __m256i left = _mm256_min_epi32(_mm256_max_epi32(
+		_mm256_add_epi32(_mm256_cvttps_epi32(floorX), padding), _mm256_setzero_si256()),
+		_mm256_set1_epi32((int32_t)batch.stride - 2));
+	const __m256i top = _mm256_min_epi32(_mm256_max_epi32(
+		_mm256_add_epi32(_mm256_cvttps_epi32(floorY), padding), _mm256_setzero_si256()),
+		_mm256_set1_epi32(batch.paddedHeight - 2));
+
+	return Lerp(
+		Lerp(LoadTexels(batch, left, top, 0, 0), LoadTexels(batch, left, top, 1, 0), fx),
+		Lerp(LoadTexels(batch, left, top, 0, 1), LoadTexels(batch, left, top, 1, 1), fx),
+		fy
+	);
+}
+
+namespace {
+
+// 每个输出像素周围的 4x4 个纹素以及 PaddedImage::SampleWindow<1> 的结果
+struct Window8 {
+	// 左上角为 floor(x - 0.5) - 1 和 floor(y - 0.5) - 1 处的纹素
+	Color8 texels[4][4];
+	Color8 window[3][3];
+	// floor(x - 0.5) 和 floor(y - 0.5)
+	__m256 floorX;
+	__m256 floorY;
+};
+
+}
+
+template <bool FP16>
+static void LoadWindow(const GlssBatch& batch, __m256 x, __m256 y, Window8& result) noexcept {
+	const __m256 tx = Sub(x, Set(0.5f));
+	const __m256 ty = Sub(y, Set(0.5f));
+	result.floorX = _mm256_floor_ps(tx);
+	result.floorY = _mm256_floor_ps(ty);
+	const __m256 fx = Sub(tx, result.floorX);
+	const __m256 fy = Sub(ty, result.floorY);
+
+	const __m256i offset = _mm256_set1_epi32(batch.padding - 1);
+	const __m256i left = _mm256_add_epi32(_mm256_cvttps_epi32(result.floorX), offset);
+	const __m256i top = _mm256_add_epi32(_mm256_cvttps_epi32(result.floorY), offset);
+	for (int j = 0; j < 4; ++j) {
+		for (int i = 0; i < 4; ++i) {
+			result.texels[j][i] = LoadTexels(batch, left, top, i, j);
+		}
+	}
+
+	Color8 rows[4][3];
+	for (int j = 0; j < 4; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			rows[j][i] = Lerp(result.texels[j][i], result.texels[j][i + 1], fx);
+		}
+	}
+
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			result.window[j][i] = ToMF<FP16>(Lerp(rows[j][i], rows[j + 1][i], fy));
+		}
+	}
+}
+
+// 以 (x, y) 为中心、间距为 scale 个像素的 3x3 高斯模糊
+static Color8 SimpleGaussianBlur(const GlssBatch& batch, __m256 x, __m256 y, float scale) noexcept {
+	Color8 result = Zero8();
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			const Color8 texel = Sample(batch, Add(x, Set((i - 1) * scale)), Add(y, Set((j - 1) * scale)));
+			result = MulAdd(texel, Set(GLSS_GAUSSIAN_WEIGHTS[j * 3 + i]), result);
+		}
+	}
+	return result;
+}
+
+static Color8 SimpleGaussianBlur(const Color8(&window)[3][3]) noexcept {
+	Color8 result = Zero8();
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			result = MulAdd(window[j][i], Set(GLSS_GAUSSIAN_WEIGHTS[j * 3 + i]), result);
+		}
+	}
+	return result;
+}
+
+static void SobelGradient(const Color8(&window)[3][3], __m256& gradX, __m256& gradY) noexcept {
+	__m256 lum[3][3];
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			lum[j][i] = Luma(window[j][i]);
+		}
+	}
+
+	const __m256 two = Set(2.0f);
+	gradX = Add(Add(Add(Sub(Sub(Neg(lum[0][0]), Mul(two, lum[1][0])), lum[2][0]), lum[0][2]),
+		Mul(two, lum[1][2])), lum[2][2]);
+	gradY = Add(Add(Add(Sub(Sub(Neg(lum[0][0]), Mul(two, lum[0][1])), lum[0][2]), lum[2][0]),
+		Mul(two, lum[2][1])), lum[2][2]);
+}
+
+static Color8 Laplacian3x3(const Color8(&window)[3][3]) noexcept {
+	const Color8 sumCross = Add(Add(window[0][1], window[2][1]), Add(window[1][0], window[1][2]));
+	return Sub(Mul(window[1][1], Set(4.0f)), sumCross);
+}
+
+static __m256 DetectNoise(const Color8& center, const Color8& blurred, __m256 gradMagnitude, float noiseThreshold) noexcept {
+	const __m256 diffR = Abs(Sub(center.r, blurred.r));
+	const __m256 diffG = Abs(Sub(center.g, blurred.g));
+	const __m256 diffB = Abs(Sub(center.b, blurred.b));
+	const __m256 noiseEnergy = _mm256_sqrt_ps(Add(Add(Mul(diffR, diffR), Mul(diffG, diffG)), Mul(diffB, diffB)));
+	const __m256 edgeMask = Saturate(Mul(gradMagnitude, Set(2.0f)));
+	const __m256 adjustedNoise = Mul(noiseEnergy, Sub(Set(1.0f), Mul(edgeMask, Set(0.2f))));
+	return Div(Saturate(Sub(adjustedNoise, Set(noiseThreshold))), Set(1.0f - noiseThreshold));
+}
+
+static Color8 EdgeAverage(const GlssBatch& batch, __m256 x, __m256 y, __m256 edgeX, __m256 edgeY) noexcept {
+	const __m256 halfX = Mul(edgeX, Set(0.5f));
+	const __m256 halfY = Mul(edgeY, Set(0.5f));
+	Color8 result = Sample(batch, Add(x, halfX), Add(y, halfY));
+	result = Add(result, Sample(batch, Sub(x, halfX), Sub(y, halfY)));
+	result = Add(result, Sample(batch, Sub(x, halfY), Add(y, halfX)));
+	result = Add(result, Sample(batch, Add(x, halfY), Sub(y, halfX)));
+	return Mul(result, Set(0.25f));
+}
+
+// 去噪时和中心比较的一个纹素
+template <bool FP16>
+static void AddDenoiseTap(
+	const Color8& texel,
+	__m256 centerLum,
+	float sigma,
+	Color8& filtered,
+	__m256& totalWeight
+) noexcept {
+	const __m256 colorDiff = Sub(Luma(texel), centerLum);
+	const __m256 weight = ToMF<FP16>(Mul(Set(0.2f), Exp(Div(Mul(Neg(colorDiff), colorDiff), Set(sigma)))));
+	filtered = ToMF<FP16>(MulAdd(texel, weight, filtered));
+	totalWeight = ToMF<FP16>(Add(totalWeight, weight));
+}
+
+static __m256 BicubicWeight(__m256 x, float B, float C) noexcept {
+	const __m256 ax = Abs(x);
+	const __m256 xx = Mul(x, x);
+
+	const __m256 near = Div(Add(Mul(xx, Add(Mul(Set(12.0f - 9.0f * B - 6.0f * C), ax),
+		Set(-18.0f + 12.0f * B + 6.0f * C))), Set(6.0f - 2.0f * B)), Set(6.0f));
+	const __m256 far = Div(Add(Add(Mul(xx, Add(Mul(Set(-B - 6.0f * C), ax), Set(6.0f * B + 30.0f * C))),
+		Mul(Set(-12.0f * B - 48.0f * C), ax)), Set(8.0f * B + 24.0f * C)), Set(6.0f));
+
+	return Select(Less(ax, Set(1.0f)), near, And(Less(ax, Set(2.0f)), far));
+}
+
+template <bool FP16>
+static void GlssLite(const GlssBatch& batch, float* dest) noexcept {
+	const float B = 0.25f + batch.detail * 0.25f;
+	const float C = 0.5f - batch.detail * 0.3f;
+	const float lowFreqBoost = 0.9f + batch.detail * 0.2f;
+	const float midFreqBoost = 1.2f + batch.sharpness * 0.6f;
+	const float highFreqBoost = 2.0f + batch.sharpness * 1.2f;
+	const float noiseThreshold = 0.01f + batch.denoise * 0.02f;
+
+	const __m256 x = _mm256_loadu_ps(batch.x);
+	const __m256 y = Set(batch.y);
+
+	Window8 w;
+	LoadWindow<FP16>(batch, x, y, w);
+	const Color8 center = w.window[1][1];
+
+	// 双三次插值
+	const __m256 subX = Sub(Sub(x, w.floorX), Set(0.5f));
+	const __m256 subY = Sub(Sub(y, w.floorY), Set(0.5f));
+
+	__m256 rowWeights[4];
+	__m256 colWeights[4];
+	__m256 rowSum = _mm256_setzero_ps();
+	__m256 colSum = _mm256_setzero_ps();
+	for (int i = 0; i < 4; ++i) {
+		rowWeights[i] = BicubicWeight(Add(Sub(Set(1.0f), subX), Set((float)(i - 2))), B, C);
+		colWeights[i] = BicubicWeight(Add(Sub(Set(1.0f), subY), Set((float)(i - 2))), B, C);
+		rowSum = Add(rowSum, rowWeights[i]);
+		colSum = Add(colSum, colWeights[i]);
+	}
+
+	Color8 bicubicResult = Zero8();
+	for (int j = 0; j < 4; ++j) {
+		Color8 rowResult = Zero8();
+		for (int i = 0; i < 4; ++i) {
+			const Color8 texel = ToMF<FP16>(w.texels[j][i]);
+			rowResult = ToMF<FP16>(MulAdd(texel, ToMF<FP16>(Div(rowWeights[i], rowSum)), rowResult));
+		}
+		bicubicResult = ToMF<FP16>(MulAdd(rowResult, ToMF<FP16>(Div(colWeights[j], colSum)), bicubicResult));
+	}
+
+	// 梯度，长度限制为 0.15
+	__m256 gradX, gradY;
+	SobelGradient(w.window, gradX, gradY);
+	gradX = ToMF<FP16>(gradX);
+	gradY = ToMF<FP16>(gradY);
+	__m256 gradMagnitude = ToMF<FP16>(_mm256_sqrt_ps(Add(Mul(gradX, gradX), Mul(gradY, gradY))));
+	{
+		const __m256 tooLong = Greater(gradMagnitude, Set(0.15f));
+		gradX = Select(tooLong, Mul(Div(gradX, gradMagnitude), Set(0.15f)), gradX);
+		gradY = Select(tooLong, Mul(Div(gradY, gradMagnitude), Set(0.15f)), gradY);
+		gradMagnitude = Select(tooLong, Set(0.15f), gradMagnitude);
+	}
+
+	const __m256 hasEdge = GreaterEqual(gradMagnitude, Set(0.001f));
+	const __m256 edgeX = Select(hasEdge, Div(gradX, gradMagnitude), Set(1.0f));
+	const __m256 edgeY = Select(hasEdge, Div(gradY, gradMagnitude), _mm256_setzero_ps());
+
+	// 频率增强
+	const Color8 lowFreq = ToMF<FP16>(SimpleGaussianBlur(batch, x, y, 1.5f));
+	const Color8 midFreq = ToMF<FP16>(Sub(ToMF<FP16>(SimpleGaussianBlur(batch, x, y, 0.8f)), lowFreq));
+	const Color8 highFreq = ToMF<FP16>(Sub(bicubicResult, ToMF<FP16>(SimpleGaussianBlur(batch, x, y, 0.5f))));
+
+	Color8 enhanced = ToMF<FP16>(Mul(lowFreq, Set(lowFreqBoost * 0.9f)));
+	enhanced = ToMF<FP16>(MulAdd(midFreq, Set(midFreqBoost), enhanced));
+	enhanced = ToMF<FP16>(MulAdd(highFreq, Set(highFreqBoost * 1.2f), enhanced));
+
+	// 自适应去噪
+	Color8 denoised = enhanced;
+	const __m256 noiseLevel = ToMF<FP16>(
+		DetectNoise(center, ToMF<FP16>(SimpleGaussianBlur(w.window)), gradMagnitude, noiseThreshold));
+	const __m256 isNoisy = Greater(noiseLevel, Set(0.05f));
+	if (Any(isNoisy)) {
+		static constexpr int OFFSETS[4][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+		const __m256 centerLum = Luma(center);
+		const float sigma = 2.0f * noiseThreshold * noiseThreshold;
+		Color8 filtered = center;
+		__m256 totalWeight = Set(1.0f);
+		for (const auto& offset : OFFSETS) {
+			for (int sign = 1; sign >= -1; sign -= 2) {
+				AddDenoiseTap<FP16>(w.window[1 + offset[1] * sign][1 + offset[0] * sign],
+					centerLum, sigma, filtered, totalWeight);
+			}
+		}
+
+		denoised = Select(isNoisy, ToMF<FP16>(Lerp(enhanced, ToMF<FP16>(Mul(filtered, Div(Set(1.0f), totalWeight))),
+			Mul(Set(batch.denoise * 0.8f), noiseLevel))), enhanced);
+	}
+
+	// 抗锯齿
+	const Color8 aaResult = ToMF<FP16>(Lerp(
+		center, ToMF<FP16>(EdgeAverage(batch, x, y, edgeX, edgeY)), Set(batch.aaStrength * 0.6f)));
+	const Color8 antiAliased = ToMF<FP16>(
+		Lerp(denoised, aaResult, Mul(Saturate(Mul(gradMagnitude, Set(3.0f))), Set(batch.aaStrength))));
+
+	// 自适应锐化，振铃控制
+	const Color8 diff = Clamp(ToMF<FP16>(Mul(Laplacian3x3(w.window), Set(batch.sharpness * 0.3f))),
+		Set(-0.1f), Set(0.1f));
+	Color8 result = ToMF<FP16>(Saturate(Add(diff, antiAliased)));
+	result.a = Set(1.0f);
+	Store8(result, dest);
+}
+
+template <bool FP16>
+static void GlssFast(const GlssBatch& batch, float* dest) noexcept {
+	const float lowFreqBoost = 0.9f + batch.detail * 0.2f;
+	const float midFreqBoost = 1.2f + batch.sharpness * 0.6f;
+	const float highFreqBoost = 2.0f + batch.sharpness * 1.2f;
+	const float edgeThreshold = 0.02f + batch.aaStrength * 0.02f;
+	const float noiseThreshold = 0.01f + batch.denoise * 0.02f;
+
+	const __m256 x = _mm256_loadu_ps(batch.x);
+	const __m256 y = Set(batch.y);
+
+	Window8 w;
+	LoadWindow<FP16>(batch, x, y, w);
+	const Color8 center = w.window[1][1];
+
+	// 双线性插值然后模拟锐化
+	Color8 baseColor;
+	{
+		const Color8 samples[4] = {
+			ToMF<FP16>(w.texels[1][1]),
+			ToMF<FP16>(w.texels[1][2]),
+			ToMF<FP16>(w.texels[2][1]),
+			ToMF<FP16>(w.texels[2][2])
+		};
+		const __m256 subX = ToMF<FP16>(Sub(Sub(x, w.floorX), Set(0.5f)));
+		const __m256 subY = ToMF<FP16>(Sub(Sub(y, w.floorY), Set(0.5f)));
+		const __m256 w1X = ToMF<FP16>(Sub(Set(1.0f), subX));
+		const __m256 w1Y = ToMF<FP16>(Sub(Set(1.0f), subY));
+		const __m256 weights[4] = {
+			ToMF<FP16>(Mul(w1X, w1Y)),
+			ToMF<FP16>(Mul(subX, w1Y)),
+			ToMF<FP16>(Mul(w1X, subY)),
+			ToMF<FP16>(Mul(subX, subY))
+		};
+
+		Color8 bilinearResult = Zero8();
+		Color8 sum = Zero8();
+		for (int i = 0; i < 4; ++i) {
+			bilinearResult = ToMF<FP16>(MulAdd(samples[i], weights[i], bilinearResult));
+			sum = ToMF<FP16>(Add(sum, samples[i]));
+		}
+
+		const Color8 laplacian = ToMF<FP16>(Sub(Mul(bilinearResult, Set(4.0f)), Mul(sum, Set(0.25f))));
+		baseColor = ToMF<FP16>(MulAdd(laplacian, Set(batch.sharpness * 0.1f), bilinearResult));
+	}
+
+	// 梯度，每个分量限制在 [-0.15, 0.15]
+	__m256 gradX, gradY;
+	SobelGradient(w.window, gradX, gradY);
+	gradX = ToMF<FP16>(ClampScalar(gradX, -0.15f, 0.15f));
+	gradY = ToMF<FP16>(ClampScalar(gradY, -0.15f, 0.15f));
+	const __m256 gradMagnitude = ToMF<FP16>(_mm256_sqrt_ps(Add(Mul(gradX, gradX), Mul(gradY, gradY))));
+
+	const __m256 hasEdge = GreaterEqual(gradMagnitude, Set(0.001f));
+	const __m256 edgeX = Select(hasEdge, Div(gradX, gradMagnitude), Set(1.0f));
+	const __m256 edgeY = Select(hasEdge, Div(gradY, gradMagnitude), _mm256_setzero_ps());
+
+	const Color8 laplacian = ToMF<FP16>(Laplacian3x3(w.window));
+	const Color8 gaussian = ToMF<FP16>(SimpleGaussianBlur(w.window));
+
+	// 频率增强
+	Color8 enhanced = ToMF<FP16>(Mul(gaussian, Set(lowFreqBoost)));
+	enhanced = ToMF<FP16>(MulAdd(ToMF<FP16>(Sub(baseColor, gaussian)), Set(midFreqBoost), enhanced));
+	enhanced = ToMF<FP16>(MulAdd(laplacian, Set(highFreqBoost * 0.3f), enhanced));
+
+	// 自适应去噪
+	Color8 denoised = enhanced;
+	const __m256 noiseLevel = ToMF<FP16>(DetectNoise(center, gaussian, gradMagnitude, noiseThreshold));
+	const __m256 isNoisy = Greater(noiseLevel, Set(0.05f));
+	if (Any(isNoisy)) {
+		const __m256 centerLum = Luma(center);
+		const float sigmaColor = noiseThreshold * noiseThreshold * 2.0f;
+
+		Color8 filtered = center;
+		__m256 totalWeight = Set(1.0f);
+		const Color8* neighbors[4] = { &w.window[0][1], &w.window[1][0], &w.window[1][2], &w.window[2][1] };
+		for (const Color8* texel : neighbors) {
+			AddDenoiseTap<FP16>(*texel, centerLum, sigmaColor, filtered, totalWeight);
+		}
+
+		denoised = Select(isNoisy, ToMF<FP16>(Lerp(enhanced, ToMF<FP16>(Mul(filtered, Div(Set(1.0f), totalWeight))),
+			Mul(Set(batch.denoise * 0.8f), noiseLevel))), enhanced);
+	}
+
+	// 抗锯齿
+	Color8 aaResult = denoised;
+	const __m256 isEdge = Greater(gradMagnitude, Set(edgeThreshold));
+	if (Any(isEdge)) {
+		aaResult = Select(isEdge, ToMF<FP16>(Lerp(denoised,
+			ToMF<FP16>(EdgeAverage(batch, x, y, edgeX, edgeY)), Set(batch.aaStrength * 0.6f))), denoised);
+	}
+
+	// 锐化
+	Color8 result = ToMF<FP16>(Saturate(MulAdd(laplacian, Set(batch.sharpness * 0.15f), aaResult)));
+	result.a = Set(1.0f);
+	Store8(result, dest);
+}
+
+void GlssLiteAvx2(const GlssBatch& batch, float* dest) noexcept {
+	if (batch.emulateFP16) {
+		GlssLite<true>(batch, dest);
+	} else {
+		GlssLite<false>(batch, dest);
+	}
+}
+
+void GlssFastAvx2(const GlssBatch& batch, float* dest) noexcept {
+	if (batch.emulateFP16) {
+		GlssFast<true>(batch, dest);
+	} else {
+		GlssFast<false>(batch, dest);
+	}
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void GlssAnalyzeWindowAvx2(const float*, size_t, float, float, GlssWindow&) noexcept {}
+
+void GlssLiteAvx2(const GlssBatch&, float*) noexcept {}
+
+void GlssFastAvx2(const GlssBatch&, float*) noexcept {}
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Magpie {
+
+// 7x7 Sobel 算子，和 Bicubic.hlsl 相同
+inline constexpr float GLSS_SOBEL_X[49] = {
+	-1, -4, -5, -6, -5, -4, -1,
+	-4, -16, -20, -24, -20, -16, -4,
+	-5, -20, -25, -30, -25, -20, -5,
+	-6, -24, -30, 0, -30, -24, -6,
+	-5, -20, -25, -30, -25, -20, -5,
+	-4, -16, -20, -24, -20, -16, -4,
+	-1, -4, -5, -6, -5, -4, -1
+};
+
+inline constexpr float GLSS_SOBEL_Y[49] = {
+	-1, -4, -5, -6, -5, -4, -1,
+	-4, -16, -20, -24, -20, -16, -4,
+	-5, -20, -25, -30, -25, -20, -5,
+	-6, -24, -30, 0, -30, -24, -6,
+	-5, -20, -25, -30, -25, -20, -5,
+	-4, -16, -20, -24, -20, -16, -4,
+	-1, -4, -5, -6, -5, -4, -1
+};
+
+// 7x7 Scharr 算子
+inline constexpr float GLSS_SCHARR_X[49] = {
+	-1, -4, -5, 0, 5, 4, 1,
+	-6, -24, -30, 0, 30, 24, 6,
+	-15, -60, -75, 0, 75, 60, 15,
+	-20, -80, -100, 0, 100, 80, 20,
+	-15, -60, -75, 0, 75, 60, 15,
+	-6, -24, -30, 0, 30, 24, 6,
+	-1, -4, -5, 0, 5, 4, 1
+};
+
+inline constexpr float GLSS_SCHARR_Y[49] = {
+	-1, -6, -15, -20, -15, -6, -1,
+	-4, -24, -60, -80, -60, -24, -4,
+	-5, -30, -75, -100, -75, -30, -5,
+	0, 0, 0, 0, 0, 0, 0,
+	5, 30, 75, 100, 75, 30, 5,
+	4, 24, 60, 80, 60, 24, 4,
+	1, 6, 15, 20, 15, 6, 1
+};
+
+inline constexpr float GLSS_LUM_WEIGHTS[3] = { 0.299f, 0.587f, 0.114f };
+
+// Lite 和 Fast 变体使用的 3x3 高斯核
+inline constexpr float GLSS_GAUSSIAN_WEIGHTS[9] = {
+	1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
+	2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
+	1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
+};
+
+// Bicubic.hlsl 中每个输出像素的前半部分：采样 7x7 窗口，计算亮度、梯度和纹理复杂度。
+// 这部分占完整变体的大部分计算量且没有分支，因此有 AVX2 实现。
+struct GlssWindow {
+	// 每个采样点的 RGBA
+	alignas(32) float colors[7][7][4];
+	float lum[7][7];
+	float sobelX;
+	float sobelY;
+	float scharrX;
+	float scharrY;
+	// 和中心亮度之差的平方和
+	float variance;
+};
+
+// origin 和 fx、fy 来自 PaddedImage::WindowOrigin<3>，stride 以 float4 为单位。
+// 和可移植的实现相比只有 FMA 引入的舍入误差
+void GlssAnalyzeWindowAvx2(const float* origin, size_t stride, float fx, float fy, GlssWindow& window) noexcept;
+
+// Lite 和 Fast 变体的 AVX2 核，每次计算同一行中相邻的 8 个输出像素，每个寄存器保存 8 个像素的同一个分量。
+// 乘法和加法不合并为 FMA，分支改为逐像素选择，exp 逐像素调用 expf，MF 类型使用 F16C 舍入，和 RoundToHalf
+// 相同，因此结果和可移植的实现完全相同。
+struct GlssBatch {
+	// 和 GlssParameters 相同
+	float sharpness;
+	float denoise;
+	float aaStrength;
+	float detail;
+	bool emulateFP16;
+
+	// PaddedImage 包括填充在内的所有纹素，stride 和 paddedHeight 为每行的纹素数和行数，
+	// padding 为 PaddedImage::PADDING
+	const float* pixels;
+	size_t stride;
+	int32_t paddedHeight;
+	int32_t padding;
+
+	// 每个输出像素在源图像中的坐标，以像素为单位，y 所有像素相同
+	const float* x;
+	float y;
+};
+
+// 结果以 RGBA 写入 dest，Alpha 为 1
+void GlssLiteAvx2(const GlssBatch& batch, float* dest) noexcept;
+void GlssFastAvx2(const GlssBatch& batch, float* dest) noexcept;
+
+}
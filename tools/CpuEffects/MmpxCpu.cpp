@@ -0,0 +1,162 @@
+#include "MmpxCpu.h"
+#include "CpuFeatures.h"
+#include "MmpxCpuKernels.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+
+namespace Magpie {
+
+// 每个任务处理的行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+// AVX2 核一次计算的像素数
+static constexpr uint32_t AVX2_BATCH_SIZE = 8;
+
+static bool Eq(const float4& a, const float4& b) noexcept {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static bool AllEq2(const float4& b, const float4& a0, const float4& a1) noexcept {
+	return Eq(b, a0) && Eq(b, a1);
+}
+
+static bool AllEq3(const float4& b, const float4& a0, const float4& a1, const float4& a2) noexcept {
+	return Eq(b, a0) && Eq(b, a1) && Eq(b, a2);
+}
+
+static bool AllEq4(const float4& b, const float4& a0, const float4& a1, const float4& a2, const float4& a3) noexcept {
+	return Eq(b, a0) && Eq(b, a1) && Eq(b, a2) && Eq(b, a3);
+}
+
+static bool AnyEq3(const float4& b, const float4& a0, const float4& a1, const float4& a2) noexcept {
+	return Eq(b, a0) || Eq(b, a1) || Eq(b, a2);
+}
+
+static bool NoneEq2(const float4& b, const float4& a0, const float4& a1) noexcept {
+	return !Eq(b, a0) && !Eq(b, a1);
+}
+
+static bool NoneEq4(const float4& b, const float4& a0, const float4& a1, const float4& a2, const float4& a3) noexcept {
+	return !Eq(b, a0) && !Eq(b, a1) && !Eq(b, a2) && !Eq(b, a3);
+}
+
+static float Luma(const float4& c) noexcept {
+	return c.x + c.y + c.z;
+}
+
+// 和着色器相同，输出 2x2 个像素，按左上、右上、左下、右下排列
+static void Mmpx(const PaddedImage& image, int x, int y, float4(&result)[4]) noexcept {
+	auto src = [&](int offsetX, int offsetY) {
+		return image.Texel(x + offsetX, y + offsetY);
+	};
+
+	const float4 A = src(-1, -1), B = src(0, -1), C = src(1, -1);
+	const float4 D = src(-1, 0), E = src(0, 0), F = src(1, 0);
+	const float4 G = src(-1, 1), H = src(0, 1), I = src(1, 1);
+
+	float4 J = E, K = E, L = E, M = E;
+
+	if (!Eq(A, E) || !Eq(B, E) || !Eq(C, E) || !Eq(D, E) || !Eq(F, E) || !Eq(G, E) || !Eq(H, E) || !Eq(I, E)) {
+		const float4 P = src(0, -2), S = src(0, 2);
+		const float4 Q = src(-2, 0), R = src(2, 0);
+		const float Bl = Luma(B), Dl = Luma(D), El = Luma(E), Fl = Luma(F), Hl = Luma(H);
+
+		// 1:1 slope rules
+		if ((Eq(D, B) && !Eq(D, H) && !Eq(D, F)) && (El >= Dl || Eq(E, A)) && AnyEq3(E, A, C, G) && ((El < Dl) || !Eq(A, D) || !Eq(E, P) || !Eq(E, Q))) J = D;
+		if ((Eq(B, F) && !Eq(B, D) && !Eq(B, H)) && (El >= Bl || Eq(E, C)) && AnyEq3(E, A, C, I) && ((El < Bl) || !Eq(C, B) || !Eq(E, P) || !Eq(E, R))) K = B;
+		if ((Eq(H, D) && !Eq(H, F) && !Eq(H, B)) && (El >= Hl || Eq(E, G)) && AnyEq3(E, A, G, I) && ((El < Hl) || !Eq(G, H) || !Eq(E, S) || !Eq(E, Q))) L = H;
+		if ((Eq(F, H) && !Eq(F, B) && !Eq(F, D)) && (El >= Fl || Eq(E, I)) && AnyEq3(E, C, G, I) && ((El < Fl) || !Eq(I, H) || !Eq(E, R) || !Eq(E, S))) M = F;
+
+		// Intersection rules
+		if ((!Eq(E, F) && AllEq4(E, C, I, D, Q) && AllEq2(F, B, H)) && !Eq(F, src(3, 0))) K = M = F;
+		if ((!Eq(E, D) && AllEq4(E, A, G, F, R) && AllEq2(D, B, H)) && !Eq(D, src(-3, 0))) J = L = D;
+		if ((!Eq(E, H) && AllEq4(E, G, I, B, P) && AllEq2(H, D, F)) && !Eq(H, src(0, 3))) L = M = H;
+		if ((!Eq(E, B) && AllEq4(E, A, C, H, S) && AllEq2(B, D, F)) && !Eq(B, src(0, -3))) J = K = B;
+		if (Bl < El && AllEq4(E, G, H, I, S) && NoneEq4(E, A, D, C, F)) J = K = B;
+		if (Hl < El && AllEq4(E, A, B, C, P) && NoneEq4(E, D, G, I, F)) L = M = H;
+		if (Fl < El && AllEq4(E, A, D, G, Q) && NoneEq4(E, B, C, I, H)) K = M = F;
+		if (Dl < El && AllEq4(E, C, F, I, R) && NoneEq4(E, B, A, G, H)) J = L = D;
+
+		// 2:1 slope rules
+		if (!Eq(H, B)) {
+			if (!Eq(H, A) && !Eq(H, E) && !Eq(H, C)) {
+				if (AllEq3(H, G, F, R) && NoneEq2(H, D, src(2, -1))) L = M;
+				if (AllEq3(H, I, D, Q) && NoneEq2(H, F, src(-2, -1))) M = L;
+			}
+
+			if (!Eq(B, I) && !Eq(B, G) && !Eq(B, E)) {
+				if (AllEq3(B, A, F, R) && NoneEq2(B, D, src(2, 1))) J = K;
+				if (AllEq3(B, C, D, Q) && NoneEq2(B, F, src(-2, 1))) K = J;
+			}
+		}
+
+		if (!Eq(F, D)) {
+			if (!Eq(D, I) && !Eq(D, E) && !Eq(D, C)) {
+				if (AllEq3(D, A, H, S) && NoneEq2(D, B, src(1, 2))) J = L;
+				if (AllEq3(D, G, B, P) && NoneEq2(D, H, src(1, -2))) L = J;
+			}
+
+			if (!Eq(F, E) && !Eq(F, A) && !Eq(F, G)) {
+				if (AllEq3(F, C, H, S) && NoneEq2(F, B, src(-1, 2))) K = M;
+				if (AllEq3(F, I, B, P) && NoneEq2(F, H, src(-1, -2))) M = K;
+			}
+		}
+	}
+
+	result[0] = J;
+	result[1] = K;
+	result[2] = L;
+	result[3] = M;
+}
+
+bool MmpxCpu::Scale(
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest
+) noexcept {
+	if (srcWidth == 0 || srcHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)srcWidth * srcHeight * 4) {
+		return false;
+	}
+
+	PaddedImage image;
+	if (!image.Initialize(src, srcWidth, srcHeight)) {
+		return false;
+	}
+
+	const uint32_t destWidth = srcWidth * 2;
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+
+	const uint32_t bandCount = (srcHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, srcHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			float4* destRow0 = dest.data() + (size_t)y * 2 * destWidth;
+			float4* destRow1 = destRow0 + destWidth;
+
+			uint32_t x = 0;
+			if (useAvx2) {
+				for (; x + AVX2_BATCH_SIZE <= srcWidth; x += AVX2_BATCH_SIZE) {
+					MmpxAvx2(&image.Texel((int)x, (int)y).x, image.Stride(), &destRow0[x * 2].x, &destRow1[x * 2].x);
+				}
+			}
+
+			// 剩余的像素使用可移植的实现
+			for (; x < srcWidth; ++x) {
+				float4 result[4];
+				Mmpx(image, (int)x, (int)y, result);
+
+				destRow0[x * 2] = WithAlpha(result[0], 1.0f);
+				destRow0[x * 2 + 1] = WithAlpha(result[1], 1.0f);
+				destRow1[x * 2] = WithAlpha(result[2], 1.0f);
+				destRow1[x * 2 + 1] = WithAlpha(result[3], 1.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+}
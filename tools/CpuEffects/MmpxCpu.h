@@ -0,0 +1,18 @@
+#pragma once
+#include "Float4.h"
+#include <span>
+
+namespace Magpie {
+
+// MMPX 的 CPU 实现，复现 Pixel Art/MMPX.hlsl。输出尺寸为输入的两倍，Alpha 通道始终为 1。
+// 支持 AVX2 时每次计算一行中相邻的 8 个像素，结果和可移植的实现完全相同。
+struct MmpxCpu {
+	static bool Scale(
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest
+	) noexcept;
+};
+
+}
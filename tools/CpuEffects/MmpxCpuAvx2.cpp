@@ -0,0 +1,164 @@
+#include "MmpxCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include "Avx2Helper.h"
+#include <cstring>
+
+namespace Magpie {
+
+using namespace Avx2Helper;
+
+// 和 MmpxCpu.cpp 中的 Eq 相同，只比较 RGB
+static __m256 Eq(const Color8& a, const Color8& b) noexcept {
+	return And(And(Equal(a.r, b.r), Equal(a.g, b.g)), Equal(a.b, b.b));
+}
+
+static __m256 Ne(const Color8& a, const Color8& b) noexcept {
+	return Not(Eq(a, b));
+}
+
+static __m256 AllEq2(const Color8& b, const Color8& a0, const Color8& a1) noexcept {
+	return And(Eq(b, a0), Eq(b, a1));
+}
+
+static __m256 AllEq3(const Color8& b, const Color8& a0, const Color8& a1, const Color8& a2) noexcept {
+	return And(AllEq2(b, a0, a1), Eq(b, a2));
+}
+
+static __m256 AllEq4(const Color8& b, const Color8& a0, const Color8& a1, const Color8& a2, const Color8& a3) noexcept {
+	return And(AllEq3(b, a0, a1, a2), Eq(b, a3));
+}
+
+static __m256 AnyEq3(const Color8& b, const Color8& a0, const Color8& a1, const Color8& a2) noexcept {
+	return Or(Or(Eq(b, a0), Eq(b, a1)), Eq(b, a2));
+}
+
+static __m256 NoneEq2(const Color8& b, const Color8& a0, const Color8& a1) noexcept {
+	return And(Ne(b, a0), Ne(b, a1));
+}
+
+static __m256 NoneEq4(const Color8& b, const Color8& a0, const Color8& a1, const Color8& a2, const Color8& a3) noexcept {
+	return And(NoneEq2(b, a0, a1), NoneEq2(b, a2, a3));
+}
+
+static __m256 Luma(const Color8& c) noexcept {
+	return Add(Add(c.r, c.g), c.b);
+}
+
+static void Assign(__m256 mask, const Color8& value, Color8& target) noexcept {
+	target.r = Select(mask, value.r, target.r);
+	target.g = Select(mask, value.g, target.g);
+	target.b = Select(mask, value.b, target.b);
+}
+
+// 和 MmpxCpu.cpp 中的 Mmpx 相同。每条规则先对所有像素求值，再只修改满足条件的像素，
+// 规则的顺序不变，因此后面的规则读取的是前面的规则修改后的值
+void MmpxAvx2(const float* texel, size_t stride, float* destRow0, float* destRow1) noexcept {
+	auto src = [&](int offsetX, int offsetY) {
+		return Load8(texel + ((ptrdiff_t)offsetY * (ptrdiff_t)stride + offsetX) * 4);
+	};
+
+	const Color8 A = src(-1, -1), B = src(0, -1), C = src(1, -1);
+	const Color8 D = src(-1, 0), E = src(0, 0), F = src(1, 0);
+	const Color8 G = src(-1, 1), H = src(0, 1), I = src(1, 1);
+
+	Color8 J = E, K = E, L = E, M = E;
+
+	const __m256 notFlat = Or(Or(Or(Ne(A, E), Ne(B, E)), Or(Ne(C, E), Ne(D, E))),
+		Or(Or(Ne(F, E), Ne(G, E)), Or(Ne(H, E), Ne(I, E))));
+	if (Any(notFlat)) {
+		const Color8 P = src(0, -2), S = src(0, 2);
+		const Color8 Q = src(-2, 0), R = src(2, 0);
+		const __m256 Bl = Luma(B), Dl = Luma(D), El = Luma(E), Fl = Luma(F), Hl = Luma(H);
+
+		auto rule = [&](__m256 cond, const Color8& value, Color8& target) {
+			Assign(And(notFlat, cond), value, target);
+		};
+
+		// 1:1 slope rules
+		rule(And(And(And(Eq(D, B), Ne(D, H)), Ne(D, F)), And(And(Or(GreaterEqual(El, Dl), Eq(E, A)), AnyEq3(E, A, C, G)),
+			Or(Or(Less(El, Dl), Ne(A, D)), Or(Ne(E, P), Ne(E, Q))))), D, J);
+		rule(And(And(And(Eq(B, F), Ne(B, D)), Ne(B, H)), And(And(Or(GreaterEqual(El, Bl), Eq(E, C)), AnyEq3(E, A, C, I)),
+			Or(Or(Less(El, Bl), Ne(C, B)), Or(Ne(E, P), Ne(E, R))))), B, K);
+		rule(And(And(And(Eq(H, D), Ne(H, F)), Ne(H, B)), And(And(Or(GreaterEqual(El, Hl), Eq(E, G)), AnyEq3(E, A, G, I)),
+			Or(Or(Less(El, Hl), Ne(G, H)), Or(Ne(E, S), Ne(E, Q))))), H, L);
+		rule(And(And(And(Eq(F, H), Ne(F, B)), Ne(F, D)), And(And(Or(GreaterEqual(El, Fl), Eq(E, I)), AnyEq3(E, C, G, I)),
+			Or(Or(Less(El, Fl), Ne(I, H)), Or(Ne(E, R), Ne(E, S))))), F, M);
+
+		// Intersection rules
+		__m256 cond = And(And(Ne(E, F), AllEq4(E, C, I, D, Q)), And(AllEq2(F, B, H), Ne(F, src(3, 0))));
+		rule(cond, F, K);
+		rule(cond, F, M);
+		cond = And(And(Ne(E, D), AllEq4(E, A, G, F, R)), And(AllEq2(D, B, H), Ne(D, src(-3, 0))));
+		rule(cond, D, J);
+		rule(cond, D, L);
+		cond = And(And(Ne(E, H), AllEq4(E, G, I, B, P)), And(AllEq2(H, D, F), Ne(H, src(0, 3))));
+		rule(cond, H, L);
+		rule(cond, H, M);
+		cond = And(And(Ne(E, B), AllEq4(E, A, C, H, S)), And(AllEq2(B, D, F), Ne(B, src(0, -3))));
+		rule(cond, B, J);
+		rule(cond, B, K);
+		cond = And(And(Less(Bl, El), AllEq4(E, G, H, I, S)), NoneEq4(E, A, D, C, F));
+		rule(cond, B, J);
+		rule(cond, B, K);
+		cond = And(And(Less(Hl, El), AllEq4(E, A, B, C, P)), NoneEq4(E, D, G, I, F));
+		rule(cond, H, L);
+		rule(cond, H, M);
+		cond = And(And(Less(Fl, El), AllEq4(E, A, D, G, Q)), NoneEq4(E, B, C, I, H));
+		rule(cond, F, K);
+		rule(cond, F, M);
+		cond = And(And(Less(Dl, El), AllEq4(E, C, F, I, R)), NoneEq4(E, B, A, G, H));
+		rule(cond, D, J);
+		rule(cond, D, L);
+
+		// 2:1 slope rules
+		const __m256 hNeB = Ne(H, B);
+		__m256 outer = And(hNeB, And(And(Ne(H, A), Ne(H, E)), Ne(H, C)));
+		rule(And(outer, And(AllEq3(H, G, F, R), NoneEq2(H, D, src(2, -1)))), M, L);
+		rule(And(outer, And(AllEq3(H, I, D, Q), NoneEq2(H, F, src(-2, -1)))), L, M);
+
+		outer = And(hNeB, And(And(Ne(B, I), Ne(B, G)), Ne(B, E)));
+		rule(And(outer, And(AllEq3(B, A, F, R), NoneEq2(B, D, src(2, 1)))), K, J);
+		rule(And(outer, And(AllEq3(B, C, D, Q), NoneEq2(B, F, src(-2, 1)))), J, K);
+
+		const __m256 fNeD = Ne(F, D);
+		outer = And(fNeD, And(And(Ne(D, I), Ne(D, E)), Ne(D, C)));
+		rule(And(outer, And(AllEq3(D, A, H, S), NoneEq2(D, B, src(1, 2)))), L, J);
+		rule(And(outer, And(AllEq3(D, G, B, P), NoneEq2(D, H, src(1, -2)))), J, L);
+
+		outer = And(fNeD, And(And(Ne(F, E), Ne(F, A)), Ne(F, G)));
+		rule(And(outer, And(AllEq3(F, C, H, S), NoneEq2(F, B, src(-1, 2)))), M, K);
+		rule(And(outer, And(AllEq3(F, I, B, P), NoneEq2(F, H, src(-1, -2)))), K, M);
+	}
+
+	// 输出的 Alpha 通道始终为 1
+	const __m256 one = Set(1.0f);
+	J.a = K.a = L.a = M.a = one;
+
+	// 两个输出像素交错排列
+	alignas(32) float top[2][8 * 4];
+	alignas(32) float bottom[2][8 * 4];
+	Store8(J, top[0]);
+	Store8(K, top[1]);
+	Store8(L, bottom[0]);
+	Store8(M, bottom[1]);
+	for (int i = 0; i < 8; ++i) {
+		for (int j = 0; j < 2; ++j) {
+			std::memcpy(destRow0 + (i * 2 + j) * 4, top[j] + i * 4, 4 * sizeof(float));
+			std::memcpy(destRow1 + (i * 2 + j) * 4, bottom[j] + i * 4, 4 * sizeof(float));
+		}
+	}
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void MmpxAvx2(const float*, size_t, float*, float*) noexcept {}
+
+}
+
+#endif
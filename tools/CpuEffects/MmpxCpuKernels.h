@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+
+namespace Magpie {
+
+// 一行中相邻的 8 个源像素的 MMPX，结果和可移植的实现完全相同。texel 指向第一个像素，四周至少有 3 个
+// 可读取的像素，stride 为每行的像素数。每个源像素输出 2x2 个像素，destRow0 和 destRow1 分别为上下两行
+// 的第一个输出像素，都以 float4 为单位。
+void MmpxAvx2(const float* texel, size_t stride, float* destRow0, float* destRow1) noexcept;
+
+}
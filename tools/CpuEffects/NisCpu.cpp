@@ -0,0 +1,628 @@
+#include "NisCpu.h"
+#include "CpuFeatures.h"
+#include "NisCpuKernels.h"
+#include "DDSFormat.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace Magpie {
+
+// 每个任务处理的输出行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+// AVX2 核一次计算的像素数
+static constexpr uint32_t AVX2_BATCH_SIZE = 8;
+
+// 由 sharpness 参数计算 NisSharpness
+struct SharpnessParams : NisSharpness {
+	explicit SharpnessParams(float sharpness) noexcept {
+		const float slider = sharpness - 0.5f;
+		const float minScale = (slider >= 0.0f) ? 1.25f : 1.0f;
+		const float maxScale = (slider >= 0.0f) ? 1.25f : 1.75f;
+		strengthMin = std::max(0.0f, 0.4f + slider * minScale * 1.2f);
+		strengthScale = 1.6f + slider * maxScale * 1.8f - strengthMin;
+
+		const float limitScaleFactor = (slider >= 0.0f) ? 1.25f : 1.0f;
+		limitMin = std::max(0.1f, 0.14f + slider * limitScaleFactor * 0.32f);
+		limitScale = 0.5f + slider * limitScaleFactor * 0.6f - limitMin;
+	}
+};
+
+static float GetY(const float4& color) noexcept {
+	return 0.2126f * color.x + 0.7152f * color.y + 0.0722f * color.z;
+}
+
+// 源图像的亮度，四周复制了边缘像素，和 PaddedImage 一样等价于 CLAMP 寻址
+class LumaPlane {
+public:
+	// 足以覆盖 NIS 的 6x6 窗口和边缘图外扩的一个像素
+	static constexpr int PADDING = 4;
+
+	bool Initialize(std::span<const float4> src, uint32_t width, uint32_t height) noexcept {
+		_stride = (int)width + 2 * PADDING;
+		const int paddedHeight = (int)height + 2 * PADDING;
+
+		try {
+			_luma.resize((size_t)_stride * paddedHeight);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		for (int y = 0; y < paddedHeight; ++y) {
+			const int srcY = std::clamp(y - PADDING, 0, (int)height - 1);
+			const float4* srcRow = src.data() + (size_t)srcY * width;
+			float* destRow = _luma.data() + (size_t)y * _stride;
+
+			for (int x = 0; x < _stride; ++x) {
+				destRow[x] = GetY(srcRow[std::clamp(x - PADDING, 0, (int)width - 1)]);
+			}
+		}
+
+		return true;
+	}
+
+	// 像素 (x, y) 的地址，供 SIMD 实现使用。四周各有 PADDING 个可读取的像素
+	const float* Pixel(int x, int y) const noexcept {
+		return &_luma[(size_t)(y + PADDING) * _stride + x + PADDING];
+	}
+
+	// 每行的像素数
+	int Stride() const noexcept {
+		return _stride;
+	}
+
+	// 以 (x, y) 为左上角读取 N x N 个像素，按 [行][列] 排列
+	template <int N>
+	void Window(int x, int y, float(&window)[N][N]) const noexcept {
+		static_assert(N <= PADDING * 2);
+		for (int i = 0; i < N; ++i) {
+			const float* row = &_luma[(size_t)(y + i + PADDING) * _stride + x + PADDING];
+			std::copy_n(row, N, window[i]);
+		}
+	}
+
+private:
+	std::vector<float> _luma;
+	int _stride = 0;
+};
+
+// NisScaleBatch 中每个输出列一项的表。采样位置只和列有关，因此只需计算一次
+struct ScaleColumns {
+	std::vector<float> fx;
+	std::vector<int32_t> phaseX;
+	std::vector<int32_t> lumaX;
+	std::vector<int32_t> edgeMapX;
+	std::vector<int32_t> sampleX;
+	std::vector<float> sampleFx;
+
+	bool Initialize(const PaddedImage& image, uint32_t destWidth, float scaleX, uint32_t phaseCount) noexcept {
+		try {
+			fx.resize(destWidth);
+			phaseX.resize(destWidth);
+			lumaX.resize(destWidth);
+			edgeMapX.resize(destWidth);
+			sampleX.resize(destWidth);
+			sampleFx.resize(destWidth);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		// 和可移植的实现中的计算相同
+		for (uint32_t dstX = 0; dstX < destWidth; ++dstX) {
+			const float srcX = (0.5f + dstX) * scaleX - 0.5f;
+			const float floorX = std::floor(srcX);
+			const int px = (int)floorX;
+
+			fx[dstX] = srcX - floorX;
+			phaseX[dstX] = (int32_t)(uint32_t)(fx[dstX] * phaseCount);
+			lumaX[dstX] = px - 2;
+			// 边缘图中 (x, y) 对应源像素 (x - 1, y - 1)
+			edgeMapX[dstX] = px + 1;
+			sampleX[dstX] = image.SampleColumn(srcX + 0.5f, sampleFx[dstX]);
+		}
+
+		return true;
+	}
+};
+
+// 和 NIS_Scaler.hlsli 中的 GetEdgeMap 相同，p 为 3x3 的亮度，返回 0°、90°、45°、135° 方向的权重
+static float4 GetEdgeMap(const float(&p)[3][3]) noexcept {
+	const float g_0 = std::abs(p[0][0] + p[0][1] + p[0][2] - p[2][0] - p[2][1] - p[2][2]);
+	const float g_45 = std::abs(p[1][0] + p[0][0] + p[0][1] - p[2][1] - p[2][2] - p[1][2]);
+	const float g_90 = std::abs(p[0][0] + p[1][0] + p[2][0] - p[0][2] - p[1][2] - p[2][2]);
+	const float g_135 = std::abs(p[1][0] + p[2][0] + p[2][1] - p[0][1] - p[0][2] - p[1][2]);
+
+	const float g_0_90_max = std::max(g_0, g_90);
+	const float g_0_90_min = std::min(g_0, g_90);
+	const float g_45_135_max = std::max(g_45, g_135);
+	const float g_45_135_min = std::min(g_45, g_135);
+
+	if (g_0_90_max + g_45_135_max == 0) {
+		return {};
+	}
+
+	const float e_0_90 = std::min(g_0_90_max / (g_0_90_max + g_45_135_max), 1.0f);
+	const float e_45_135 = 1.0f - e_0_90;
+
+	const bool c_0_90 = (g_0_90_max > (g_0_90_min * NIS_DETECT_RATIO)) && (g_0_90_max > NIS_DETECT_THRES) && (g_0_90_max > g_45_135_min);
+	const bool c_45_135 = (g_45_135_max > (g_45_135_min * NIS_DETECT_RATIO)) && (g_45_135_max > NIS_DETECT_THRES) && (g_45_135_max > g_0_90_min);
+	const bool c_g_0_90 = g_0_90_max == g_0;
+	const bool c_g_45_135 = g_45_135_max == g_45;
+
+	const float f_e_0_90 = (c_0_90 && c_45_135) ? e_0_90 : 1.0f;
+	const float f_e_45_135 = (c_0_90 && c_45_135) ? e_45_135 : 1.0f;
+
+	return {
+		(c_0_90 && c_g_0_90) ? f_e_0_90 : 0.0f,
+		(c_0_90 && !c_g_0_90) ? f_e_0_90 : 0.0f,
+		(c_45_135 && c_g_45_135) ? f_e_45_135 : 0.0f,
+		(c_45_135 && !c_g_45_135) ? f_e_45_135 : 0.0f
+	};
+}
+
+static float CalcLTI(const float(&p)[6], uint32_t phase) noexcept {
+	const bool selector = phase <= 64 / 2;
+	float sel = selector ? p[0] : p[3];
+	const float a_min = std::min(std::min(p[1], p[2]), sel);
+	const float a_max = std::max(std::max(p[1], p[2]), sel);
+	sel = selector ? p[2] : p[5];
+	const float b_min = std::min(std::min(p[3], p[4]), sel);
+	const float b_max = std::max(std::max(p[3], p[4]), sel);
+
+	const float a_cont = a_max - a_min;
+	const float b_cont = b_max - b_min;
+
+	const float cont_ratio = std::max(a_cont, b_cont) / (std::min(a_cont, b_cont) + NIS_EPS);
+	return (1.0f - Saturate((cont_ratio - NIS_MIN_CONTRAST_RATIO) * NIS_RATIO_NORM)) * NIS_CONTRAST_BOOST;
+}
+
+// NIS.hlsl 中一个输出像素需要的所有数据
+struct ScalerContext {
+	const std::array<std::array<float, 6>, 64>& coefScaler;
+	const std::array<std::array<float, 6>, 64>& coefUsm;
+	const SharpnessParams& sharpness;
+};
+
+static float EvalPoly6(const ScalerContext& ctx, const float(&pxl)[6], uint32_t phase) noexcept {
+	float y = 0.0f;
+	float y_usm = 0.0f;
+	for (int i = 0; i < 6; ++i) {
+		y += ctx.coefScaler[phase][i] * pxl[i];
+	}
+	for (int i = 0; i < 6; ++i) {
+		y_usm += ctx.coefUsm[phase][i] * pxl[i];
+	}
+
+	const float y_scale = 1.0f - Saturate((y - NIS_SHARP_START_Y) * NIS_SHARP_SCALE_Y);
+	const float y_sharpness = y_scale * ctx.sharpness.strengthScale + ctx.sharpness.strengthMin;
+	y_usm *= y_sharpness;
+
+	const float y_sharpness_limit = (y_scale * ctx.sharpness.limitScale + ctx.sharpness.limitMin) * y;
+	y_usm = std::min(y_sharpness_limit, std::max(-y_sharpness_limit, y_usm));
+	y_usm *= CalcLTI(pxl, phase);
+
+	return y + y_usm;
+}
+
+static float FilterNormal(const ScalerContext& ctx, const float(&p)[6][6], uint32_t phaseX, uint32_t phaseY) noexcept {
+	float h_acc = 0.0f;
+	for (int j = 0; j < 6; ++j) {
+		float v_acc = 0.0f;
+		for (int i = 0; i < 6; ++i) {
+			v_acc += p[i][j] * ctx.coefScaler[phaseY][i];
+		}
+		h_acc += v_acc * ctx.coefScaler[phaseX][j];
+	}
+
+	return h_acc;
+}
+
+static float AddDirFilters(
+	const ScalerContext& ctx,
+	const float(&p)[6][6],
+	float fx,
+	float fy,
+	uint32_t phaseX,
+	uint32_t phaseY,
+	const float4& w
+) noexcept {
+	float f = 0.0f;
+
+	if (w.x > 0.0f) {
+		// 0°
+		float interp0Deg[6];
+		for (int i = 0; i < 6; ++i) {
+			interp0Deg[i] = Lerp(p[i][2], p[i][3], fx);
+		}
+		f += EvalPoly6(ctx, interp0Deg, phaseY) * w.x;
+	}
+
+	if (w.y > 0.0f) {
+		// 90°
+		float interp90Deg[6];
+		for (int i = 0; i < 6; ++i) {
+			interp90Deg[i] = Lerp(p[2][i], p[3][i], fy);
+		}
+		f += EvalPoly6(ctx, interp90Deg, phaseX) * w.y;
+	}
+
+	if (w.z > 0.0f) {
+		// 45°
+		float pphase_b45 = 0.5f + 0.5f * (fx - fy);
+
+		float temp_interp45Deg[7];
+		temp_interp45Deg[1] = Lerp(p[2][1], p[1][2], pphase_b45);
+		temp_interp45Deg[3] = Lerp(p[3][2], p[2][3], pphase_b45);
+		temp_interp45Deg[5] = Lerp(p[4][3], p[3][4], pphase_b45);
+
+		pphase_b45 = pphase_b45 - 0.5f;
+		const float a = (pphase_b45 >= 0.f) ? p[0][2] : p[2][0];
+		const float b = (pphase_b45 >= 0.f) ? p[1][3] : p[3][1];
+		const float c = (pphase_b45 >= 0.f) ? p[2][4] : p[4][2];
+		const float d = (pphase_b45 >= 0.f) ? p[3][5] : p[5][3];
+		temp_interp45Deg[0] = Lerp(p[1][1], a, std::abs(pphase_b45));
+		temp_interp45Deg[2] = Lerp(p[2][2], b, std::abs(pphase_b45));
+		temp_interp45Deg[4] = Lerp(p[3][3], c, std::abs(pphase_b45));
+		temp_interp45Deg[6] = Lerp(p[4][4], d, std::abs(pphase_b45));
+
+		float interp45Deg[6];
+		float pphase_p45 = fx + fy;
+		const int offset = pphase_p45 >= 1 ? 1 : 0;
+		if (offset) {
+			pphase_p45 = pphase_p45 - 1;
+		}
+		std::copy_n(temp_interp45Deg + offset, 6, interp45Deg);
+
+		f += EvalPoly6(ctx, interp45Deg, (uint32_t)(pphase_p45 * 64)) * w.z;
+	}
+
+	if (w.w > 0.0f) {
+		// 135°
+		float pphase_b135 = 0.5f * (fx + fy);
+
+		float temp_interp135Deg[7];
+		temp_interp135Deg[1] = Lerp(p[3][1], p[4][2], pphase_b135);
+		temp_interp135Deg[3] = Lerp(p[2][2], p[3][3], pphase_b135);
+		temp_interp135Deg[5] = Lerp(p[1][3], p[2][4], pphase_b135);
+
+		pphase_b135 = pphase_b135 - 0.5f;
+		const float a = (pphase_b135 >= 0.f) ? p[5][2] : p[3][0];
+		const float b = (pphase_b135 >= 0.f) ? p[4][3] : p[2][1];
+		const float c = (pphase_b135 >= 0.f) ? p[3][4] : p[1][2];
+		const float d = (pphase_b135 >= 0.f) ? p[2][5] : p[0][3];
+		temp_interp135Deg[0] = Lerp(p[4][1], a, std::abs(pphase_b135));
+		temp_interp135Deg[2] = Lerp(p[3][2], b, std::abs(pphase_b135));
+		temp_interp135Deg[4] = Lerp(p[2][3], c, std::abs(pphase_b135));
+		temp_interp135Deg[6] = Lerp(p[1][4], d, std::abs(pphase_b135));
+
+		float interp135Deg[6];
+		float pphase_p135 = 1 + (fx - fy);
+		const int offset = pphase_p135 >= 1 ? 1 : 0;
+		if (offset) {
+			pphase_p135 = pphase_p135 - 1;
+		}
+		std::copy_n(temp_interp135Deg + offset, 6, interp135Deg);
+
+		f += EvalPoly6(ctx, interp135Deg, (uint32_t)(pphase_p135 * 64)) * w.w;
+	}
+
+	return f;
+}
+
+static float CalcLTIFast(const float(&y)[5]) noexcept {
+	const float a_min = std::min(std::min(y[0], y[1]), y[2]);
+	const float a_max = std::max(std::max(y[0], y[1]), y[2]);
+
+	const float b_min = std::min(std::min(y[2], y[3]), y[4]);
+	const float b_max = std::max(std::max(y[2], y[3]), y[4]);
+
+	const float a_cont = a_max - a_min;
+	const float b_cont = b_max - b_min;
+
+	const float cont_ratio = std::max(a_cont, b_cont) / (std::min(a_cont, b_cont) + NIS_EPS);
+	return (1.0f - Saturate((cont_ratio - NIS_MIN_CONTRAST_RATIO) * NIS_RATIO_NORM)) * NIS_CONTRAST_BOOST;
+}
+
+static float EvalUSM(const float(&pxl)[5], float sharpnessStrength, float sharpnessLimit) noexcept {
+	float y_usm = -0.6001f * pxl[1] + 1.2002f * pxl[2] - 0.6001f * pxl[3];
+	y_usm *= sharpnessStrength;
+	y_usm = std::min(sharpnessLimit, std::max(-sharpnessLimit, y_usm));
+	y_usm *= CalcLTIFast(pxl);
+	return y_usm;
+}
+
+// 和 NIS_Scaler.hlsli 中的 GetDirUSM 相同
+static float4 GetDirUSM(const float(&p)[5][5], const SharpnessParams& params) noexcept {
+	const float scaleY = 1.0f - Saturate((p[2][2] - NIS_SHARP_START_Y) * NIS_SHARP_SCALE_Y);
+	const float sharpnessStrength = scaleY * params.strengthScale + params.strengthMin;
+	const float sharpnessLimit = (scaleY * params.limitScale + params.limitMin) * p[2][2];
+
+	float4 rval;
+
+	const float interp0Deg[5] = { p[0][2], p[1][2], p[2][2], p[3][2], p[4][2] };
+	rval.x = EvalUSM(interp0Deg, sharpnessStrength, sharpnessLimit);
+
+	const float interp90Deg[5] = { p[2][0], p[2][1], p[2][2], p[2][3], p[2][4] };
+	rval.y = EvalUSM(interp90Deg, sharpnessStrength, sharpnessLimit);
+
+	const float interp45Deg[5] = {
+		p[1][1],
+		Lerp(p[2][1], p[1][2], 0.5f),
+		p[2][2],
+		Lerp(p[3][2], p[2][3], 0.5f),
+		p[3][3]
+	};
+	rval.z = EvalUSM(interp45Deg, sharpnessStrength, sharpnessLimit);
+
+	const float interp135Deg[5] = {
+		p[3][1],
+		Lerp(p[3][2], p[2][1], 0.5f),
+		p[2][2],
+		Lerp(p[2][3], p[1][2], 0.5f),
+		p[1][3]
+	};
+	rval.w = EvalUSM(interp135Deg, sharpnessStrength, sharpnessLimit);
+
+	return rval;
+}
+
+bool NisCpu::_LoadFilterBank(const std::filesystem::path& fileName, _FilterBank& filterBank) noexcept {
+	std::vector<uint8_t> ddsData;
+	try {
+		std::ifstream file(fileName, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		ddsData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	} catch (...) {
+		return false;
+	}
+
+	DDSTextureInfo info;
+	if (!DDSFormat::ParseHeader(ddsData.data(), ddsData.size(), info)) {
+		return false;
+	}
+
+	// 每个相位占一行，两个纹素共 8 个分量，只使用前 6 个
+	if (info.width != 2 || info.height != PHASE_COUNT || info.format != DXGI_FORMAT_R16G16B16A16_FLOAT) {
+		return false;
+	}
+
+	constexpr size_t rowSize = 8 * sizeof(uint16_t);
+	if (info.dataSize < rowSize * PHASE_COUNT) {
+		return false;
+	}
+
+	const uint8_t* coefs = ddsData.data() + info.dataOffset;
+	for (uint32_t phase = 0; phase < PHASE_COUNT; ++phase) {
+		for (uint32_t i = 0; i < FILTER_SIZE; ++i) {
+			uint16_t coef;
+			std::memcpy(&coef, coefs + phase * rowSize + i * sizeof(uint16_t), sizeof(coef));
+			filterBank[phase][i] = HalfToFloat(coef);
+		}
+	}
+
+	return true;
+}
+
+bool NisCpu::Initialize(
+	const std::filesystem::path& coefScaleFile,
+	const std::filesystem::path& coefUsmFile
+) noexcept {
+	_isInitialized = _LoadFilterBank(coefScaleFile, _coefScaler) && _LoadFilterBank(coefUsmFile, _coefUsm);
+	if (!_isInitialized) {
+		return false;
+	}
+
+	return true;
+}
+
+bool NisCpu::Scale(
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight,
+	float sharpness
+) const noexcept {
+	if (!_isInitialized) {
+		return false;
+	}
+
+	if (srcWidth == 0 || srcHeight == 0 || destWidth == 0 || destHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	PaddedImage image;
+	LumaPlane luma;
+	// 每个源像素的边缘图，四周各多一个像素，和着色器的 shEdgeMap 相同
+	std::vector<float4> edgeMap;
+	try {
+		edgeMap.resize((size_t)(srcWidth + 2) * (srcHeight + 2));
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	if (!image.Initialize(src, srcWidth, srcHeight) || !luma.Initialize(src, srcWidth, srcHeight)) {
+		return false;
+	}
+
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+	const uint32_t edgeMapWidth = srcWidth + 2;
+	const uint32_t edgeMapHeight = srcHeight + 2;
+	ThreadPool::Get().ParallelFor((edgeMapHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, edgeMapHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			uint32_t x = 0;
+			if (useAvx2) {
+				for (; x + AVX2_BATCH_SIZE <= edgeMapWidth; x += AVX2_BATCH_SIZE) {
+					NisEdgeMapAvx2(luma.Pixel((int)x - 2, (int)y - 2), luma.Stride(),
+						&edgeMap[(size_t)y * edgeMapWidth + x].x);
+				}
+			}
+
+			for (; x < edgeMapWidth; ++x) {
+				// 边缘图中 (x, y) 对应源像素 (x - 1, y - 1)
+				float p[3][3];
+				luma.Window<3>((int)x - 2, (int)y - 2, p);
+				edgeMap[(size_t)y * edgeMapWidth + x] = GetEdgeMap(p);
+			}
+		}
+	});
+
+	// 和着色器中的 kScaleX 和 kScaleY 相同
+	const float scaleX = 1 / (destWidth / (float)srcWidth);
+	const float scaleY = 1 / (destHeight / (float)srcHeight);
+
+	const SharpnessParams sharpnessParams(sharpness);
+	const ScalerContext ctx{ _coefScaler, _coefUsm, sharpnessParams };
+
+	// AVX2 核使用的每列的采样位置，所有行相同
+	ScaleColumns columns;
+	if (useAvx2 && !columns.Initialize(image, destWidth, scaleX, PHASE_COUNT)) {
+		return false;
+	}
+
+	const uint32_t bandCount = (destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t dstY = beginRow; dstY < endRow; ++dstY) {
+			const float srcY = (0.5f + dstY) * scaleY - 0.5f;
+			const float floorY = std::floor(srcY);
+			const float fy = srcY - floorY;
+			const uint32_t fy_int = (uint32_t)(fy * PHASE_COUNT);
+			const int py = (int)floorY;
+
+			float4* destRow = dest.data() + (size_t)dstY * destWidth;
+
+			uint32_t dstX = 0;
+			if (useAvx2) {
+				NisScaleBatch batch;
+				batch.coefScaler = _coefScaler[0].data();
+				batch.coefUsm = _coefUsm[0].data();
+				batch.sharpness = sharpnessParams;
+				batch.fy = fy;
+				batch.phaseY = (int32_t)fy_int;
+				batch.lumaRow = luma.Pixel(0, py - 2);
+				batch.lumaStride = luma.Stride();
+				batch.edgeMapRow = &edgeMap[(size_t)(py + 1) * edgeMapWidth].x;
+				batch.edgeMapStride = edgeMapWidth;
+				batch.sampleRow = &image.SampleRow(srcY + 0.5f, batch.sampleFy)->x;
+				batch.imageStride = image.Stride();
+
+				for (; dstX + AVX2_BATCH_SIZE <= destWidth; dstX += AVX2_BATCH_SIZE) {
+					batch.fx = &columns.fx[dstX];
+					batch.phaseX = &columns.phaseX[dstX];
+					batch.lumaX = &columns.lumaX[dstX];
+					batch.edgeMapX = &columns.edgeMapX[dstX];
+					batch.sampleX = &columns.sampleX[dstX];
+					batch.sampleFx = &columns.sampleFx[dstX];
+					NisScaleAvx2(batch, &destRow[dstX].x);
+				}
+			}
+
+			// 剩余的像素使用可移植的实现
+			for (; dstX < destWidth; ++dstX) {
+				const float srcX = (0.5f + dstX) * scaleX - 0.5f;
+				const float floorX = std::floor(srcX);
+				const float fx = srcX - floorX;
+				const uint32_t fx_int = (uint32_t)(fx * PHASE_COUNT);
+				const int px = (int)floorX;
+
+				// 插值 (px, py) 右下 2x2 个源像素的边缘图
+				const float4* edgeRow0 = &edgeMap[(size_t)(py + 1) * edgeMapWidth + px + 1];
+				const float4* edgeRow1 = edgeRow0 + edgeMapWidth;
+				float4 w;
+				w = Lerp(Lerp(edgeRow0[0], edgeRow0[1], fx), Lerp(edgeRow1[0], edgeRow1[1], fx), fy);
+
+				float p[6][6];
+				luma.Window<6>(px - 2, py - 2, p);
+
+				const float baseWeight = 1.0f - w.x - w.y - w.z - w.w;
+
+				float opY = 0;
+				opY += FilterNormal(ctx, p, fx_int, fy_int) * baseWeight;
+				opY += AddDirFilters(ctx, p, fx, fy, fx_int, fy_int, w);
+
+				// 对源图像双线性插值，然后调整亮度
+				const float4 op = image.Sample(srcX + 0.5f, srcY + 0.5f);
+				const float corr = opY - GetY(op);
+				destRow[dstX] = op + float4(corr, corr, corr, 0.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+bool NisCpu::Sharpen(
+	std::span<const float4> src,
+	uint32_t width,
+	uint32_t height,
+	std::span<float4> dest,
+	float sharpness
+) noexcept {
+	if (width == 0 || height == 0 || src.size() < (size_t)width * height || dest.size() < (size_t)width * height) {
+		return false;
+	}
+
+	LumaPlane luma;
+	if (!luma.Initialize(src, width, height)) {
+		return false;
+	}
+
+	const SharpnessParams sharpnessParams(sharpness);
+
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+	const uint32_t bandCount = (height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, height);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float4* srcRow = src.data() + (size_t)y * width;
+			float4* destRow = dest.data() + (size_t)y * width;
+
+			uint32_t x = 0;
+			if (useAvx2) {
+				for (; x + AVX2_BATCH_SIZE <= width; x += AVX2_BATCH_SIZE) {
+					NisSharpenAvx2(luma.Pixel((int)x - 2, (int)y - 2), luma.Stride(),
+						&srcRow[x].x, sharpnessParams, &destRow[x].x);
+				}
+			}
+
+			for (; x < width; ++x) {
+				float p[5][5];
+				luma.Window<5>((int)x - 2, (int)y - 2, p);
+
+				const float4 dirUSM = GetDirUSM(p, sharpnessParams);
+
+				float center[3][3];
+				for (int i = 0; i < 3; ++i) {
+					std::copy_n(&p[i + 1][1], 3, center[i]);
+				}
+				const float4 w = GetEdgeMap(center);
+
+				const float usmY = dirUSM.x * w.x + dirUSM.y * w.y + dirUSM.z * w.z + dirUSM.w * w.w;
+
+				float4 op = srcRow[x];
+				op.x += usmY;
+				op.y += usmY;
+				op.z += usmY;
+				destRow[x] = op;
+			}
+		}
+	});
+
+	return true;
+}
+
+}
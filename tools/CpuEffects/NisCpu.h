@@ -0,0 +1,59 @@
+#pragma once
+#include "Float4.h"
+#include <array>
+#include <filesystem>
+#include <span>
+
+namespace Magpie {
+
+// NIS 的 CPU 实现，复现 NIS/NIS.hlsl 和 NIS/NVSharpen.hlsl 的 FP32 路径。缩放使用的系数表
+// 和着色器一样从 Coef_Scale.dds 和 Coef_USM.dds 读取。可用于在没有 GPU 时缩放图像，
+// 也可作为着色器输出的参考。支持 AVX2 时每次计算一行中相邻的 8 个像素，结果和可移植的实现完全相同。
+class NisCpu {
+public:
+	NisCpu() = default;
+
+	NisCpu(const NisCpu&) = delete;
+	NisCpu(NisCpu&&) = default;
+
+	// 参数为 NIS/Coef_Scale.dds 和 NIS/Coef_USM.dds 的路径
+	bool Initialize(const std::filesystem::path& coefScaleFile, const std::filesystem::path& coefUsmFile) noexcept;
+
+	bool IsInitialized() const noexcept {
+		return _isInitialized;
+	}
+
+	// NIS.hlsl，sharpness 的默认值和效果相同
+	bool Scale(
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest,
+		uint32_t destWidth,
+		uint32_t destHeight,
+		float sharpness = 0.5f
+	) const noexcept;
+
+	// NVSharpen.hlsl，输出尺寸和输入相同。不使用系数表，因此无需初始化
+	static bool Sharpen(
+		std::span<const float4> src,
+		uint32_t width,
+		uint32_t height,
+		std::span<float4> dest,
+		float sharpness = 0.5f
+	) noexcept;
+
+private:
+	static constexpr uint32_t PHASE_COUNT = 64;
+	static constexpr uint32_t FILTER_SIZE = 6;
+
+	using _FilterBank = std::array<std::array<float, FILTER_SIZE>, PHASE_COUNT>;
+
+	static bool _LoadFilterBank(const std::filesystem::path& fileName, _FilterBank& filterBank) noexcept;
+
+	_FilterBank _coefScaler{};
+	_FilterBank _coefUsm{};
+	bool _isInitialized = false;
+};
+
+}
@@ -0,0 +1,422 @@
+#include "NisCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include "Avx2Helper.h"
+
+namespace Magpie {
+
+using namespace Avx2Helper;
+
+static __m256 GetY(const Color8& color) noexcept {
+	return Add(Add(Mul(Set(0.2126f), color.r), Mul(Set(0.7152f), color.g)), Mul(Set(0.0722f), color.b));
+}
+
+// 和 NisCpu.cpp 中的 GetEdgeMap 相同
+static Color8 GetEdgeMap(const __m256(&p)[3][3]) noexcept {
+	const __m256 g_0 = Abs(Sub(Sub(Sub(Add(Add(p[0][0], p[0][1]), p[0][2]), p[2][0]), p[2][1]), p[2][2]));
+	const __m256 g_45 = Abs(Sub(Sub(Sub(Add(Add(p[1][0], p[0][0]), p[0][1]), p[2][1]), p[2][2]), p[1][2]));
+	const __m256 g_90 = Abs(Sub(Sub(Sub(Add(Add(p[0][0], p[1][0]), p[2][0]), p[0][2]), p[1][2]), p[2][2]));
+	const __m256 g_135 = Abs(Sub(Sub(Sub(Add(Add(p[1][0], p[2][0]), p[2][1]), p[0][1]), p[0][2]), p[1][2]));
+
+	const __m256 g_0_90_max = Max(g_0, g_90);
+	const __m256 g_0_90_min = Min(g_0, g_90);
+	const __m256 g_45_135_max = Max(g_45, g_135);
+	const __m256 g_45_135_min = Min(g_45, g_135);
+
+	const __m256 sum = Add(g_0_90_max, g_45_135_max);
+	const __m256 e_0_90 = Min(Div(g_0_90_max, sum), Set(1.0f));
+	const __m256 e_45_135 = Sub(Set(1.0f), e_0_90);
+
+	const __m256 detectThres = Set(NIS_DETECT_THRES);
+	const __m256 c_0_90 = And(And(Greater(g_0_90_max, Mul(g_0_90_min, Set(NIS_DETECT_RATIO))),
+		Greater(g_0_90_max, detectThres)), Greater(g_0_90_max, g_45_135_min));
+	const __m256 c_45_135 = And(And(Greater(g_45_135_max, Mul(g_45_135_min, Set(NIS_DETECT_RATIO))),
+		Greater(g_45_135_max, detectThres)), Greater(g_45_135_max, g_0_90_min));
+	const __m256 c_g_0_90 = Equal(g_0_90_max, g_0);
+	const __m256 c_g_45_135 = Equal(g_45_135_max, g_45);
+
+	const __m256 both = And(c_0_90, c_45_135);
+	const __m256 f_e_0_90 = Select(both, e_0_90, Set(1.0f));
+	const __m256 f_e_45_135 = Select(both, e_45_135, Set(1.0f));
+
+	// 梯度都为 0 时结果为 0
+	const __m256 nonZero = NotEqual(sum, _mm256_setzero_ps());
+	const __m256 zero = _mm256_setzero_ps();
+	return {
+		Select(And(nonZero, And(c_0_90, c_g_0_90)), f_e_0_90, zero),
+		Select(And(nonZero, _mm256_andnot_ps(c_g_0_90, c_0_90)), f_e_0_90, zero),
+		Select(And(nonZero, And(c_45_135, c_g_45_135)), f_e_45_135, zero),
+		Select(And(nonZero, _mm256_andnot_ps(c_g_45_135, c_45_135)), f_e_45_135, zero)
+	};
+}
+
+// 和 NisCpu.cpp 中的 CalcLTIFast 和 CalcLTI 相同，参数顺序也和它们计算最小值和最大值的顺序相同
+static __m256 CalcLTI(__m256 a0, __m256 a1, __m256 a2, __m256 b0, __m256 b1, __m256 b2) noexcept {
+	const __m256 a_min = Min(Min(a0, a1), a2);
+	const __m256 a_max = Max(Max(a0, a1), a2);
+	const __m256 b_min = Min(Min(b0, b1), b2);
+	const __m256 b_max = Max(Max(b0, b1), b2);
+
+	const __m256 a_cont = Sub(a_max, a_min);
+	const __m256 b_cont = Sub(b_max, b_min);
+
+	const __m256 cont_ratio = Div(Max(a_cont, b_cont), Add(Min(a_cont, b_cont), Set(NIS_EPS)));
+	return Mul(Sub(Set(1.0f), Saturate(Mul(Sub(cont_ratio, Set(NIS_MIN_CONTRAST_RATIO)), Set(NIS_RATIO_NORM)))),
+		Set(NIS_CONTRAST_BOOST));
+}
+
+// 和 NisCpu.cpp 中的 EvalUSM 相同
+static __m256 EvalUSM(const __m256(&pxl)[5], __m256 sharpnessStrength, __m256 sharpnessLimit) noexcept {
+	__m256 y_usm = Sub(Add(Mul(Set(-0.6001f), pxl[1]), Mul(Set(1.2002f), pxl[2])), Mul(Set(0.6001f), pxl[3]));
+	y_usm = Mul(y_usm, sharpnessStrength);
+	y_usm = Min(sharpnessLimit, Max(Neg(sharpnessLimit), y_usm));
+	return Mul(y_usm, CalcLTI(pxl[0], pxl[1], pxl[2], pxl[2], pxl[3], pxl[4]));
+}
+
+void NisEdgeMapAvx2(const float* luma, size_t lumaStride, float* dest) noexcept {
+	__m256 p[3][3];
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			p[i][j] = _mm256_loadu_ps(luma + i * lumaStride + j);
+		}
+	}
+
+	Store8(GetEdgeMap(p), dest);
+}
+
+void NisSharpenAvx2(
+	const float* luma,
+	size_t lumaStride,
+	const float* src,
+	const NisSharpness& sharpness,
+	float* dest
+) noexcept {
+	__m256 p[5][5];
+	for (int i = 0; i < 5; ++i) {
+		for (int j = 0; j < 5; ++j) {
+			p[i][j] = _mm256_loadu_ps(luma + i * lumaStride + j);
+		}
+	}
+
+	// 和 NisCpu.cpp 中的 GetDirUSM 相同
+	const __m256 scaleY = Sub(Set(1.0f), Saturate(Mul(Sub(p[2][2], Set(NIS_SHARP_START_Y)), Set(NIS_SHARP_SCALE_Y))));
+	const __m256 sharpnessStrength = Add(Mul(scaleY, Set(sharpness.strengthScale)), Set(sharpness.strengthMin));
+	const __m256 sharpnessLimit = Mul(Add(Mul(scaleY, Set(sharpness.limitScale)), Set(sharpness.limitMin)), p[2][2]);
+
+	const __m256 half = Set(0.5f);
+	const __m256 interp0Deg[5] = { p[0][2], p[1][2], p[2][2], p[3][2], p[4][2] };
+	const __m256 interp90Deg[5] = { p[2][0], p[2][1], p[2][2], p[2][3], p[2][4] };
+	const __m256 interp45Deg[5] = {
+		p[1][1],
+		Lerp(p[2][1], p[1][2], half),
+		p[2][2],
+		Lerp(p[3][2], p[2][3], half),
+		p[3][3]
+	};
+	const __m256 interp135Deg[5] = {
+		p[3][1],
+		Lerp(p[3][2], p[2][1], half),
+		p[2][2],
+		Lerp(p[2][3], p[1][2], half),
+		p[1][3]
+	};
+
+	const __m256 center[3][3] = {
+		{ p[1][1], p[1][2], p[1][3] },
+		{ p[2][1], p[2][2], p[2][3] },
+		{ p[3][1], p[3][2], p[3][3] }
+	};
+	const Color8 w = GetEdgeMap(center);
+
+	const __m256 usmY = Add(Add(Add(
+		Mul(EvalUSM(interp0Deg, sharpnessStrength, sharpnessLimit), w.r),
+		Mul(EvalUSM(interp90Deg, sharpnessStrength, sharpnessLimit), w.g)),
+		Mul(EvalUSM(interp45Deg, sharpnessStrength, sharpnessLimit), w.b)),
+		Mul(EvalUSM(interp135Deg, sharpnessStrength, sharpnessLimit), w.a));
+
+	Color8 op = Load8(src);
+	op.r = Add(op.r, usmY);
+	op.g = Add(op.g, usmY);
+	op.b = Add(op.b, usmY);
+	Store8(op, dest);
+}
+
+namespace {
+
+// NisScaleAvx2 中所有方向共用的值
+struct ScaleContext {
+	const float* coefScaler;
+	const float* coefUsm;
+	__m256 strengthMin;
+	__m256 strengthScale;
+	__m256 limitMin;
+	__m256 limitScale;
+};
+
+}
+
+// 每个像素的第 phase 个相位的第 i 个系数
+static __m256 GatherCoef(const float* coefs, __m256i phase, int i) noexcept {
+	return _mm256_i32gather_ps(coefs + i, _mm256_mullo_epi32(phase, _mm256_set1_epi32(6)), 4);
+}
+
+// 和 NisCpu.cpp 中的 EvalPoly6 相同
+static __m256 EvalPoly6(const ScaleContext& ctx, const __m256(&pxl)[6], __m256i phase) noexcept {
+	__m256 y = _mm256_setzero_ps();
+	__m256 y_usm = _mm256_setzero_ps();
+	for (int i = 0; i < 6; ++i) {
+		y = Add(y, Mul(GatherCoef(ctx.coefScaler, phase, i), pxl[i]));
+	}
+	for (int i = 0; i < 6; ++i) {
+		y_usm = Add(y_usm, Mul(GatherCoef(ctx.coefUsm, phase, i), pxl[i]));
+	}
+
+	const __m256 y_scale = Sub(Set(1.0f), Saturate(Mul(Sub(y, Set(NIS_SHARP_START_Y)), Set(NIS_SHARP_SCALE_Y))));
+	const __m256 y_sharpness = Add(Mul(y_scale, ctx.strengthScale), ctx.strengthMin);
+	y_usm = Mul(y_usm, y_sharpness);
+
+	const __m256 y_sharpness_limit = Mul(Add(Mul(y_scale, ctx.limitScale), ctx.limitMin), y);
+	y_usm = Min(y_sharpness_limit, Max(Neg(y_sharpness_limit), y_usm));
+
+	// 和 NisCpu.cpp 中的 CalcLTI 相同
+	const __m256 selector = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(64 / 2 + 1), phase));
+	y_usm = Mul(y_usm, CalcLTI(
+		pxl[1], pxl[2], Select(selector, pxl[0], pxl[3]),
+		pxl[3], pxl[4], Select(selector, pxl[2], pxl[5])
+	));
+
+	return Add(y, y_usm);
+}
+
+// 45° 和 135° 方向在 7 个插值结果中选择连续的 6 个，offset 的对应位为 1 时从第二个开始
+static void SelectInterp(const __m256(&temp)[7], __m256 offset, __m256(&interp)[6]) noexcept {
+	for (int i = 0; i < 6; ++i) {
+		interp[i] = Select(offset, temp[i + 1], temp[i]);
+	}
+}
+
+// 和 NisCpu.cpp 中的 AddDirFilters 相同。可移植的实现跳过权重为 0 的方向，这里改为不累加它们的结果，
+// 8 个像素的权重都为 0 时同样跳过。平坦区域的大部分像素没有边缘，因此很少需要计算方向滤波
+static __m256 AddDirFilters(
+	const ScaleContext& ctx,
+	const __m256(&p)[6][6],
+	__m256 fx,
+	__m256 fy,
+	__m256i phaseX,
+	__m256i phaseY,
+	const Color8& w
+) noexcept {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = Set(1.0f);
+	const __m256 half = Set(0.5f);
+	__m256 f = zero;
+	const __m256 mask0Deg = Greater(w.r, zero);
+	const __m256 mask90Deg = Greater(w.g, zero);
+	const __m256 mask45Deg = Greater(w.b, zero);
+	const __m256 mask135Deg = Greater(w.a, zero);
+
+	if (Any(mask0Deg)) {
+		// 0°
+		__m256 interp0Deg[6];
+		for (int i = 0; i < 6; ++i) {
+			interp0Deg[i] = Lerp(p[i][2], p[i][3], fx);
+		}
+		const __m256 value = Mul(EvalPoly6(ctx, interp0Deg, phaseY), w.r);
+		f = Select(mask0Deg, Add(f, value), f);
+	}
+
+	if (Any(mask90Deg)) {
+		// 90°
+		__m256 interp90Deg[6];
+		for (int i = 0; i < 6; ++i) {
+			interp90Deg[i] = Lerp(p[2][i], p[3][i], fy);
+		}
+		const __m256 value = Mul(EvalPoly6(ctx, interp90Deg, phaseX), w.g);
+		f = Select(mask90Deg, Add(f, value), f);
+	}
+
+	if (Any(mask45Deg)) {
+		// 45°
+		__m256 pphase_b45 = Add(half, Mul(half, Sub(fx, fy)));
+
+		__m256 temp_interp45Deg[7];
+		temp_interp45Deg[1] = Lerp(p[2][1], p[1][2], pphase_b45);
+		temp_interp45Deg[3] = Lerp(p[3][2], p[2][3], pphase_b45);
+		temp_interp45Deg[5] = Lerp(p[4][3], p[3][4], pphase_b45);
+
+		pphase_b45 = Sub(pphase_b45, half);
+		const __m256 sel = GreaterEqual(pphase_b45, zero);
+		const __m256 absPhase = Abs(pphase_b45);
+		temp_interp45Deg[0] = Lerp(p[1][1], Select(sel, p[0][2], p[2][0]), absPhase);
+		temp_interp45Deg[2] = Lerp(p[2][2], Select(sel, p[1][3], p[3][1]), absPhase);
+		temp_interp45Deg[4] = Lerp(p[3][3], Select(sel, p[2][4], p[4][2]), absPhase);
+		temp_interp45Deg[6] = Lerp(p[4][4], Select(sel, p[3][5], p[5][3]), absPhase);
+
+		__m256 pphase_p45 = Add(fx, fy);
+		const __m256 offset = GreaterEqual(pphase_p45, one);
+		pphase_p45 = Select(offset, Sub(pphase_p45, one), pphase_p45);
+
+		__m256 interp45Deg[6];
+		SelectInterp(temp_interp45Deg, offset, interp45Deg);
+
+		const __m256i phase = _mm256_cvttps_epi32(Mul(pphase_p45, Set(64.0f)));
+		const __m256 value = Mul(EvalPoly6(ctx, interp45Deg, phase), w.b);
+		f = Select(mask45Deg, Add(f, value), f);
+	}
+
+	if (Any(mask135Deg)) {
+		// 135°
+		__m256 pphase_b135 = Mul(half, Add(fx, fy));
+
+		__m256 temp_interp135Deg[7];
+		temp_interp135Deg[1] = Lerp(p[3][1], p[4][2], pphase_b135);
+		temp_interp135Deg[3] = Lerp(p[2][2], p[3][3], pphase_b135);
+		temp_interp135Deg[5] = Lerp(p[1][3], p[2][4], pphase_b135);
+
+		pphase_b135 = Sub(pphase_b135, half);
+		const __m256 sel = GreaterEqual(pphase_b135, zero);
+		const __m256 absPhase = Abs(pphase_b135);
+		temp_interp135Deg[0] = Lerp(p[4][1], Select(sel, p[5][2], p[3][0]), absPhase);
+		temp_interp135Deg[2] = Lerp(p[3][2], Select(sel, p[4][3], p[2][1]), absPhase);
+		temp_interp135Deg[4] = Lerp(p[2][3], Select(sel, p[3][4], p[1][2]), absPhase);
+		temp_interp135Deg[6] = Lerp(p[1][4], Select(sel, p[2][5], p[0][3]), absPhase);
+
+		__m256 pphase_p135 = Add(one, Sub(fx, fy));
+		const __m256 offset = GreaterEqual(pphase_p135, one);
+		pphase_p135 = Select(offset, Sub(pphase_p135, one), pphase_p135);
+
+		__m256 interp135Deg[6];
+		SelectInterp(temp_interp135Deg, offset, interp135Deg);
+
+		const __m256i phase = _mm256_cvttps_epi32(Mul(pphase_p135, Set(64.0f)));
+		const __m256 value = Mul(EvalPoly6(ctx, interp135Deg, phase), w.a);
+		f = Select(mask135Deg, Add(f, value), f);
+	}
+
+	return f;
+}
+
+void NisScaleAvx2(const NisScaleBatch& batch, float* dest) noexcept {
+	const ScaleContext ctx{
+		batch.coefScaler,
+		batch.coefUsm,
+		Set(batch.sharpness.strengthMin),
+		Set(batch.sharpness.strengthScale),
+		Set(batch.sharpness.limitMin),
+		Set(batch.sharpness.limitScale)
+	};
+
+	const __m256 fx = _mm256_loadu_ps(batch.fx);
+	const __m256 fy = Set(batch.fy);
+	const __m256i phaseX = _mm256_loadu_si256((const __m256i*)batch.phaseX);
+	const __m256i phaseY = _mm256_set1_epi32(batch.phaseY);
+
+	// 插值 2x2 个边缘图像素
+	Color8 w;
+	{
+		const size_t rowStride = batch.edgeMapStride * 4;
+		const float* e[8];
+		for (int i = 0; i < 8; ++i) {
+			e[i] = batch.edgeMapRow + (size_t)batch.edgeMapX[i] * 4;
+		}
+		const Color8 e00 = Load8(e);
+		const float* const e01Ptrs[8] = { e[0] + 4, e[1] + 4, e[2] + 4, e[3] + 4, e[4] + 4, e[5] + 4, e[6] + 4, e[7] + 4 };
+		const float* const e10Ptrs[8] = {
+			e[0] + rowStride, e[1] + rowStride, e[2] + rowStride, e[3] + rowStride,
+			e[4] + rowStride, e[5] + rowStride, e[6] + rowStride, e[7] + rowStride
+		};
+		const float* const e11Ptrs[8] = {
+			e10Ptrs[0] + 4, e10Ptrs[1] + 4, e10Ptrs[2] + 4, e10Ptrs[3] + 4,
+			e10Ptrs[4] + 4, e10Ptrs[5] + 4, e10Ptrs[6] + 4, e10Ptrs[7] + 4
+		};
+		const Color8 e01 = Load8(e01Ptrs);
+		const Color8 e10 = Load8(e10Ptrs);
+		const Color8 e11 = Load8(e11Ptrs);
+
+		w.r = Lerp(Lerp(e00.r, e01.r, fx), Lerp(e10.r, e11.r, fx), fy);
+		w.g = Lerp(Lerp(e00.g, e01.g, fx), Lerp(e10.g, e11.g, fx), fy);
+		w.b = Lerp(Lerp(e00.b, e01.b, fx), Lerp(e10.b, e11.b, fx), fy);
+		w.a = Lerp(Lerp(e00.a, e01.a, fx), Lerp(e10.a, e11.a, fx), fy);
+	}
+
+	__m256 p[6][6];
+	{
+		const __m256i lumaX = _mm256_loadu_si256((const __m256i*)batch.lumaX);
+		for (int i = 0; i < 6; ++i) {
+			const float* row = batch.lumaRow + i * batch.lumaStride;
+			for (int j = 0; j < 6; ++j) {
+				p[i][j] = _mm256_i32gather_ps(row + j, lumaX, 4);
+			}
+		}
+	}
+
+	const __m256 baseWeight = Sub(Sub(Sub(Sub(Set(1.0f), w.r), w.g), w.b), w.a);
+
+	// 和 NisCpu.cpp 中的 FilterNormal 相同
+	__m256 filterNormal = _mm256_setzero_ps();
+	for (int j = 0; j < 6; ++j) {
+		__m256 v_acc = _mm256_setzero_ps();
+		for (int i = 0; i < 6; ++i) {
+			v_acc = Add(v_acc, Mul(p[i][j], Set(batch.coefScaler[batch.phaseY * 6 + i])));
+		}
+		filterNormal = Add(filterNormal, Mul(v_acc, GatherCoef(batch.coefScaler, phaseX, j)));
+	}
+
+	__m256 opY = _mm256_setzero_ps();
+	opY = Add(opY, Mul(filterNormal, baseWeight));
+	opY = Add(opY, AddDirFilters(ctx, p, fx, fy, phaseX, phaseY, w));
+
+	// 对源图像双线性插值，然后调整亮度
+	Color8 op;
+	{
+		const size_t rowStride = batch.imageStride * 4;
+		const float* s[8];
+		for (int i = 0; i < 8; ++i) {
+			s[i] = batch.sampleRow + (size_t)batch.sampleX[i] * 4;
+		}
+		const float* const s01Ptrs[8] = { s[0] + 4, s[1] + 4, s[2] + 4, s[3] + 4, s[4] + 4, s[5] + 4, s[6] + 4, s[7] + 4 };
+		const float* const s10Ptrs[8] = {
+			s[0] + rowStride, s[1] + rowStride, s[2] + rowStride, s[3] + rowStride,
+			s[4] + rowStride, s[5] + rowStride, s[6] + rowStride, s[7] + rowStride
+		};
+		const float* const s11Ptrs[8] = {
+			s10Ptrs[0] + 4, s10Ptrs[1] + 4, s10Ptrs[2] + 4, s10Ptrs[3] + 4,
+			s10Ptrs[4] + 4, s10Ptrs[5] + 4, s10Ptrs[6] + 4, s10Ptrs[7] + 4
+		};
+		const Color8 s00 = Load8(s);
+		const Color8 s01 = Load8(s01Ptrs);
+		const Color8 s10 = Load8(s10Ptrs);
+		const Color8 s11 = Load8(s11Ptrs);
+
+		const __m256 sfx = _mm256_loadu_ps(batch.sampleFx);
+		const __m256 sfy = Set(batch.sampleFy);
+		op.r = Lerp(Lerp(s00.r, s01.r, sfx), Lerp(s10.r, s11.r, sfx), sfy);
+		op.g = Lerp(Lerp(s00.g, s01.g, sfx), Lerp(s10.g, s11.g, sfx), sfy);
+		op.b = Lerp(Lerp(s00.b, s01.b, sfx), Lerp(s10.b, s11.b, sfx), sfy);
+		op.a = Lerp(Lerp(s00.a, s01.a, sfx), Lerp(s10.a, s11.a, sfx), sfy);
+	}
+
+	const __m256 corr = Sub(opY, GetY(op));
+	op.r = Add(op.r, corr);
+	op.g = Add(op.g, corr);
+	op.b = Add(op.b, corr);
+	op.a = Add(op.a, _mm256_setzero_ps());
+	Store8(op, dest);
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void NisEdgeMapAvx2(const float*, size_t, float*) noexcept {}
+
+void NisSharpenAvx2(const float*, size_t, const float*, const NisSharpness&, float*) noexcept {}
+
+void NisScaleAvx2(const NisScaleBatch&, float*) noexcept {}
+
+}
+
+#endif
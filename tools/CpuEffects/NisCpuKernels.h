@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Magpie {
+
+// NisCpu 的 AVX2 核，每次计算 8 个像素，每个寄存器保存 8 个像素的同一个分量。乘法和加法不合并为 FMA，
+// 分支改为逐像素选择，结果和可移植的实现完全相同。亮度平面以 float 为单位，图像和边缘图以 float4 为单位。
+
+// 以下常量和 NIS.hlsl 相同
+inline constexpr float NIS_DETECT_RATIO = 2.0f * 1127.f / 1024.f;
+inline constexpr float NIS_DETECT_THRES = 64.0f / 1024.0f;
+inline constexpr float NIS_EPS = 1.0f / 255.0f;
+inline constexpr float NIS_MIN_CONTRAST_RATIO = 2.0f;
+inline constexpr float NIS_MAX_CONTRAST_RATIO = 10.0f;
+inline constexpr float NIS_RATIO_NORM = 1.0f / (NIS_MAX_CONTRAST_RATIO - NIS_MIN_CONTRAST_RATIO);
+inline constexpr float NIS_CONTRAST_BOOST = 1.0f;
+inline constexpr float NIS_SHARP_START_Y = 0.45f;
+inline constexpr float NIS_SHARP_END_Y = 0.9f;
+inline constexpr float NIS_SHARP_SCALE_Y = 1.0f / (NIS_SHARP_END_Y - NIS_SHARP_START_Y);
+
+// 由 sharpness 参数计算的常量
+struct NisSharpness {
+	float strengthMin;
+	float strengthScale;
+	float limitMin;
+	float limitScale;
+};
+
+// 一行中相邻的 8 个像素的边缘图，luma 为第一个像素的 3x3 窗口的左上角。结果以 float4 写入 dest
+void NisEdgeMapAvx2(const float* luma, size_t lumaStride, float* dest) noexcept;
+
+// NVSharpen.hlsl 中一行中相邻的 8 个像素，luma 为第一个像素的 5x5 窗口的左上角，src 为这些像素的颜色
+void NisSharpenAvx2(
+	const float* luma,
+	size_t lumaStride,
+	const float* src,
+	const NisSharpness& sharpness,
+	float* dest
+) noexcept;
+
+// NIS.hlsl 中同一行的 8 个输出像素需要的数据。以 X 结尾的成员和 fx、phaseX、sampleFx 指向每个输出列一项的表，
+// 已偏移到这 8 个像素中的第一个，其他成员所有像素相同
+struct NisScaleBatch {
+	// 系数表，64 个相位，每个相位 6 个系数
+	const float* coefScaler;
+	const float* coefUsm;
+	NisSharpness sharpness;
+
+	const float* fx;
+	float fy;
+	const int32_t* phaseX;
+	int32_t phaseY;
+
+	// 亮度平面中 6x6 窗口的第一行的起点，lumaX 为窗口的第一列
+	const float* lumaRow;
+	size_t lumaStride;
+	const int32_t* lumaX;
+
+	// 需要插值的 2x2 个边缘图像素中第一行的起点，edgeMapX 为左上角像素的列
+	const float* edgeMapRow;
+	size_t edgeMapStride;
+	const int32_t* edgeMapX;
+
+	// 源图像的双线性插值，sampleRow 为 2x2 个纹素中第一行的起点，sampleX 为左上角纹素的列
+	const float* sampleRow;
+	size_t imageStride;
+	const int32_t* sampleX;
+	const float* sampleFx;
+	float sampleFy;
+};
+
+void NisScaleAvx2(const NisScaleBatch& batch, float* dest) noexcept;
+
+}
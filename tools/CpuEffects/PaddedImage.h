@@ -0,0 +1,127 @@
+#pragma once
+#include "Float4.h"
+#include <new>
+#include <span>
+#include <vector>
+
+namespace Magpie {
+
+// 四周复制了边缘像素的源图像。坐标均以像素为单位，即 uv * 尺寸
+class PaddedImage {
+public:
+	// 四周复制边缘像素的宽度，足以覆盖所有采样偏移。采样器使用 CLAMP 寻址，因此结果相同
+	static constexpr int PADDING = 8;
+
+	bool Initialize(std::span<const float4> src, uint32_t width, uint32_t height) noexcept {
+		_stride = (int)width + 2 * PADDING;
+		_paddedHeight = (int)height + 2 * PADDING;
+
+		try {
+			_pixels.resize((size_t)_stride * _paddedHeight);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		for (int y = 0; y < _paddedHeight; ++y) {
+			const int srcY = std::clamp(y - PADDING, 0, (int)height - 1);
+			const float4* srcRow = src.data() + (size_t)srcY * width;
+			float4* destRow = _pixels.data() + (size_t)y * _stride;
+
+			for (int x = 0; x < _stride; ++x) {
+				destRow[x] = srcRow[std::clamp(x - PADDING, 0, (int)width - 1)];
+			}
+		}
+
+		return true;
+	}
+
+	// 读取纹素，x 和 y 为纹素的索引
+	const float4& Texel(int x, int y) const noexcept {
+		return _pixels[(size_t)(y + PADDING) * _stride + x + PADDING];
+	}
+
+	// 和 LINEAR 采样器相同
+	float4 Sample(float x, float y) const noexcept {
+		float fx, fy;
+		const float4* row0 = SampleRow(y, fy) + SampleColumn(x, fx);
+		const float4* row1 = row0 + _stride;
+		return Lerp(Lerp(row0[0], row0[1], fx), Lerp(row1[0], row1[1], fx), fy);
+	}
+
+	// Sample 读取的 2x2 个纹素中第一行的起点以及竖直方向的插值权重，供 SIMD 实现使用
+	const float4* SampleRow(float y, float& fy) const noexcept {
+		const float ty = y - 0.5f;
+		const float floorY = std::floor(ty);
+		fy = ty - floorY;
+
+		// 超出填充范围时钳位
+		const int iy = std::clamp((int)floorY + PADDING, 0, _paddedHeight - 2);
+		return _pixels.data() + (size_t)iy * _stride;
+	}
+
+	// Sample 读取的 2x2 个纹素中左边一列在行内的索引以及水平方向的插值权重
+	int SampleColumn(float x, float& fx) const noexcept {
+		const float tx = x - 0.5f;
+		const float floorX = std::floor(tx);
+		fx = tx - floorX;
+
+		return std::clamp((int)floorX + PADDING, 0, _stride - 2);
+	}
+
+	// 以 (x, y) 为中心，采样 (2R+1)x(2R+1) 个相距整数个像素的点。这些点的插值权重相同，
+	// 因此只需读取 (2R+2)x(2R+2) 个纹素，再分别在水平和竖直方向插值。
+	template <int R>
+	void SampleWindow(float x, float y, float4(&window)[2 * R + 1][2 * R + 1]) const noexcept {
+		constexpr int SIZE = 2 * R + 1;
+
+		float fx, fy;
+		const float4* origin = WindowOrigin<R>(x, y, fx, fy);
+
+		float4 rows[SIZE + 1][SIZE];
+		for (int j = 0; j <= SIZE; ++j) {
+			const float4* row = origin + (size_t)j * _stride;
+			for (int i = 0; i < SIZE; ++i) {
+				rows[j][i] = Lerp(row[i], row[i + 1], fx);
+			}
+		}
+
+		for (int j = 0; j < SIZE; ++j) {
+			for (int i = 0; i < SIZE; ++i) {
+				window[j][i] = Lerp(rows[j][i], rows[j + 1][i], fy);
+			}
+		}
+	}
+
+	// SampleWindow 读取的纹素中左上角的一个以及两个方向的插值权重，供 SIMD 实现使用。
+	// 右侧和下方至少还有 PADDING - R - 1 个可读取的纹素
+	template <int R>
+	const float4* WindowOrigin(float x, float y, float& fx, float& fy) const noexcept {
+		static_assert(R + 2 <= PADDING);
+
+		const float tx = x - 0.5f;
+		const float ty = y - 0.5f;
+		const float floorX = std::floor(tx);
+		const float floorY = std::floor(ty);
+		fx = tx - floorX;
+		fy = ty - floorY;
+
+		return _pixels.data() + (size_t)((int)floorY - R + PADDING) * _stride + (int)floorX - R + PADDING;
+	}
+
+	// 每行的纹素数
+	int Stride() const noexcept {
+		return _stride;
+	}
+
+	// 包括填充在内的行数
+	int PaddedHeight() const noexcept {
+		return _paddedHeight;
+	}
+
+private:
+	std::vector<float4> _pixels;
+	int _stride = 0;
+	int _paddedHeight = 0;
+};
+
+}
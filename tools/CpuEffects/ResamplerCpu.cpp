@@ -0,0 +1,497 @@
+#include "ResamplerCpu.h"
+#include "CpuFeatures.h"
+#include "ResamplerCpuKernels.h"
+#include "ThreadPool.h"
+#include <array>
+#include <cstring>
+#include <numbers>
+#include <vector>
+
+namespace Magpie {
+
+// 每个任务处理的行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+// Jinc 的权重取决于输出像素在两个方向上的相位，两个方向的相位数都不超过这个值时预先计算所有组合的权重。
+// 缩放倍数为简单分数时相位数很少，比如 2 倍放大只有两个相位
+static constexpr uint32_t MAX_JINC_PHASES = 64;
+
+// 一个方向上每个输出像素使用的纹素和权重
+struct WeightTable {
+	uint32_t taps = 0;
+	// 已钳位的纹素索引，第 i 个输出像素使用 [i * taps, (i + 1) * taps) 这些项
+	std::vector<uint32_t> indices;
+	std::vector<float> weights;
+};
+
+// Jinc 不可分离，每个方向只保存纹素索引和相位
+struct JincAxis {
+	// 已钳位的纹素索引，每个输出像素 4 项
+	std::vector<uint32_t> indices;
+	// 每个输出像素的 pc - tc
+	std::vector<float> fracs;
+	// 每个输出像素的相位编号，相位过多时为空
+	std::vector<uint32_t> phaseIds;
+	std::vector<float> phases;
+};
+
+// 和 Bicubic.hlsl 中的 weight 相同
+static float BicubicWeight(float x, float B, float C) noexcept {
+	const float ax = std::abs(x);
+
+	if (ax < 1.0f) {
+		return (x * x * ((12.0f - 9.0f * B - 6.0f * C) * ax + (-18.0f + 12.0f * B + 6.0f * C)) + (6.0f - 2.0f * B)) / 6.0f;
+	} else if (ax < 2.0f) {
+		return (x * x * ((-B - 6.0f * C) * ax + (6.0f * B + 30.0f * C)) + (-12.0f * B - 48.0f * C) * ax + (8.0f * B + 24.0f * C)) / 6.0f;
+	} else {
+		return 0.0f;
+	}
+}
+
+// 和 Lanczos.hlsl 中的 weight3 相同，d 为纹素到采样点的距离。之后会归一化，因此不需要乘以半径
+static float LanczosWeight(float d) noexcept {
+	const float s = std::max(std::abs(std::numbers::pi_v<float> * d), 1e-5f);
+	return std::sin(s) * std::sin(s * (1.0f / 3.0f)) / (s * s);
+}
+
+// 和 Jinc.hlsl 相同，fx 和 fy 为 pc - tc。结果已归一化
+static void JincWeights(float fx, float fy, float wa, float wb, float(&weights)[4][4]) noexcept {
+	float sum = 0.0f;
+	for (int j = 0; j < 4; ++j) {
+		const float dy = (j - 1) - fy;
+		for (int i = 0; i < 4; ++i) {
+			const float dx = (i - 1) - fx;
+			const float d = std::sqrt(dx * dx + dy * dy);
+			const float weight = d == 0.0f ? wa * wb : std::sin(d * wa) * std::sin(d * wb) / (d * d);
+			weights[j][i] = weight;
+			sum += weight;
+		}
+	}
+
+	const float rcpSum = 1.0f / sum;
+	for (auto& row : weights) {
+		for (float& weight : row) {
+			weight *= rcpSum;
+		}
+	}
+}
+
+// 可能抛出 std::bad_alloc
+static void BuildWeightTable(
+	ResampleFilter filter,
+	const ResampleParameters& params,
+	uint32_t srcSize,
+	uint32_t destSize,
+	WeightTable& table
+) {
+	switch (filter) {
+	case ResampleFilter::Nearest:
+		table.taps = 1;
+		break;
+	case ResampleFilter::Bilinear:
+		table.taps = 2;
+		break;
+	case ResampleFilter::Bicubic:
+		table.taps = 4;
+		break;
+	default:
+		table.taps = 6;
+		break;
+	}
+
+	const uint32_t taps = table.taps;
+	table.indices.resize((size_t)destSize * taps);
+	table.weights.resize((size_t)destSize * taps);
+
+	const float scale = (float)srcSize / destSize;
+	for (uint32_t i = 0; i < destSize; ++i) {
+		// 和着色器中的 pos * GetInputSize() 相同
+		const float pos = (i + 0.5f) * scale;
+		float* weights = table.weights.data() + (size_t)i * taps;
+
+		// 第一个纹素的索引，未钳位
+		int first;
+		if (filter == ResampleFilter::Nearest) {
+			first = (int)std::floor(pos);
+			weights[0] = 1.0f;
+		} else if (filter == ResampleFilter::Bilinear) {
+			// 和 LINEAR 采样器相同
+			const float t = pos - 0.5f;
+			const float floorT = std::floor(t);
+			first = (int)floorT;
+			weights[1] = t - floorT;
+			weights[0] = 1.0f - weights[1];
+		} else if (filter == ResampleFilter::Bicubic) {
+			// 采样 pos1 左右各两个纹素
+			const float floorPos = std::floor(pos - 0.5f);
+			const float f = pos - (floorPos + 0.5f);
+			first = (int)floorPos - 1;
+
+			float sum = 0.0f;
+			for (uint32_t t = 0; t < 4; ++t) {
+				weights[t] = BicubicWeight((float)t - 1.0f - f, params.bicubicB, params.bicubicC);
+				sum += weights[t];
+			}
+			// 和着色器一样确保权重之和为 1
+			for (uint32_t t = 0; t < 4; ++t) {
+				weights[t] /= sum;
+			}
+		} else {
+			// Lanczos3，采样距离最近的 6 个纹素
+			const float n = std::floor(pos + 0.5f);
+			const float f = pos + 0.5f - n;
+			first = (int)n - 3;
+
+			float sum = 0.0f;
+			for (uint32_t t = 0; t < 6; ++t) {
+				weights[t] = LanczosWeight((float)t - 2.0f - f);
+				sum += weights[t];
+			}
+			for (uint32_t t = 0; t < 6; ++t) {
+				weights[t] /= sum;
+			}
+		}
+
+		// 采样器使用 CLAMP 寻址
+		uint32_t* indices = table.indices.data() + (size_t)i * taps;
+		for (uint32_t t = 0; t < taps; ++t) {
+			indices[t] = (uint32_t)std::clamp(first + (int)t, 0, (int)srcSize - 1);
+		}
+	}
+}
+
+// 可能抛出 std::bad_alloc
+static void BuildJincAxis(uint32_t srcSize, uint32_t destSize, JincAxis& axis) {
+	axis.indices.resize((size_t)destSize * 4);
+	axis.fracs.resize(destSize);
+	axis.phaseIds.resize(destSize);
+
+	bool usePhases = true;
+	const float scale = (float)srcSize / destSize;
+	for (uint32_t i = 0; i < destSize; ++i) {
+		const float pc = (i + 0.5f) * scale;
+		const float floorPc = std::floor(pc - 0.5f);
+		const float f = pc - (floorPc + 0.5f);
+		axis.fracs[i] = f;
+
+		// 采样 tc - 1 到 tc + 2
+		for (int t = 0; t < 4; ++t) {
+			axis.indices[(size_t)i * 4 + t] = (uint32_t)std::clamp((int)floorPc - 1 + t, 0, (int)srcSize - 1);
+		}
+
+		if (!usePhases) {
+			continue;
+		}
+
+		auto it = std::find(axis.phases.begin(), axis.phases.end(), f);
+		if (it != axis.phases.end()) {
+			axis.phaseIds[i] = uint32_t(it - axis.phases.begin());
+		} else if (axis.phases.size() < MAX_JINC_PHASES) {
+			axis.phaseIds[i] = (uint32_t)axis.phases.size();
+			axis.phases.push_back(f);
+		} else {
+			usePhases = false;
+		}
+	}
+
+	if (!usePhases) {
+		axis.phaseIds.clear();
+		axis.phases.clear();
+	}
+}
+
+// 抗振铃，将 color 向距离最近的 2x2 个纹素的范围内收缩
+static float4 AntiRinging(
+	const float4& color,
+	const float4& texel1,
+	const float4& texel2,
+	const float4& texel3,
+	const float4& texel4,
+	float strength
+) noexcept {
+	const float4 minSample = Min(Min(texel1, texel2), Min(texel3, texel4));
+	const float4 maxSample = Max(Max(texel1, texel2), Max(texel3, texel4));
+	return Lerp(color, Clamp(color, minSample, maxSample), strength);
+}
+
+static void ScaleNearest(
+	const WeightTable& colTable,
+	const WeightTable& rowTable,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	const uint32_t bandCount = (destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float4* srcRow = src.data() + (size_t)rowTable.indices[y] * srcWidth;
+			float4* destRow = dest.data() + (size_t)y * destWidth;
+
+			for (uint32_t x = 0; x < destWidth; ++x) {
+				destRow[x] = srcRow[colTable.indices[x]];
+			}
+		}
+	});
+}
+
+// 先水平再竖直分两遍执行可分离的卷积
+static bool ScaleSeparable(
+	ResampleFilter filter,
+	const ResampleParameters& params,
+	const WeightTable& colTable,
+	const WeightTable& rowTable,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	// 只有这些源图像行会被竖直方向的卷积使用，缩小时可以跳过一部分
+	const uint32_t firstSrcRow = rowTable.indices.front();
+	const uint32_t srcRowCount = rowTable.indices.back() - firstSrcRow + 1;
+
+	// 水平方向卷积的结果，尺寸为 destWidth x srcRowCount
+	std::vector<float4> intermediate;
+	try {
+		intermediate.resize((size_t)destWidth * srcRowCount);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+	const uint32_t colTaps = colTable.taps;
+	ThreadPool::Get().ParallelFor((srcRowCount + ROWS_PER_BAND - 1) / ROWS_PER_BAND, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, srcRowCount);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float4* srcRow = src.data() + (size_t)(firstSrcRow + y) * srcWidth;
+			float4* destRow = intermediate.data() + (size_t)y * destWidth;
+
+			if (useAvx2) {
+				ResampleRowAvx2(&srcRow->x, colTable.indices.data(), colTable.weights.data(),
+					colTaps, &destRow->x, destWidth);
+				continue;
+			}
+
+			const uint32_t* indices = colTable.indices.data();
+			const float* weights = colTable.weights.data();
+			for (uint32_t x = 0; x < destWidth; ++x) {
+				float4 sum = srcRow[indices[0]] * weights[0];
+				for (uint32_t t = 1; t < colTaps; ++t) {
+					sum += srcRow[indices[t]] * weights[t];
+				}
+				destRow[x] = sum;
+
+				indices += colTaps;
+				weights += colTaps;
+			}
+		}
+	});
+
+	const uint32_t rowTaps = rowTable.taps;
+	const bool antiRinging = filter == ResampleFilter::Lanczos && params.lanczosARStrength > 0.0f;
+	const bool keepAlpha = filter == ResampleFilter::Bilinear;
+	ThreadPool::Get().ParallelFor((destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const uint32_t* rowIndices = rowTable.indices.data() + (size_t)y * rowTaps;
+			const float* rowWeights = rowTable.weights.data() + (size_t)y * rowTaps;
+
+			const float4* srcRows[6];
+			for (uint32_t t = 0; t < rowTaps; ++t) {
+				srcRows[t] = intermediate.data() + (size_t)(rowIndices[t] - firstSrcRow) * destWidth;
+			}
+
+			float4* destRow = dest.data() + (size_t)y * destWidth;
+			if (useAvx2) {
+				const float* srcRowData[6];
+				for (uint32_t t = 0; t < rowTaps; ++t) {
+					srcRowData[t] = &srcRows[t]->x;
+				}
+				ResampleColumnAvx2(srcRowData, rowWeights, rowTaps, !keepAlpha, &destRow->x, destWidth);
+
+				if (antiRinging) {
+					ResampleAntiRingingAvx2(
+						&src[(size_t)rowIndices[2] * srcWidth].x,
+						&src[(size_t)rowIndices[3] * srcWidth].x,
+						colTable.indices.data(),
+						colTaps,
+						params.lanczosARStrength,
+						&destRow->x,
+						destWidth
+					);
+				}
+				continue;
+			}
+
+			for (uint32_t x = 0; x < destWidth; ++x) {
+				float4 color = srcRows[0][x] * rowWeights[0];
+				for (uint32_t t = 1; t < rowTaps; ++t) {
+					color += srcRows[t][x] * rowWeights[t];
+				}
+
+				if (antiRinging) {
+					// 距离最近的 2x2 个纹素是第 2 和第 3 个
+					const uint32_t* colIndices = colTable.indices.data() + (size_t)x * colTaps;
+					const float4* srcRow1 = src.data() + (size_t)rowIndices[2] * srcWidth;
+					const float4* srcRow2 = src.data() + (size_t)rowIndices[3] * srcWidth;
+					color = AntiRinging(
+						color,
+						srcRow1[colIndices[2]],
+						srcRow1[colIndices[3]],
+						srcRow2[colIndices[2]],
+						srcRow2[colIndices[3]],
+						params.lanczosARStrength
+					);
+				}
+
+				destRow[x] = keepAlpha ? color : WithAlpha(color, 1.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+static bool ScaleJinc(
+	const ResampleParameters& params,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	const float wa = params.jincWindowSinc * std::numbers::pi_v<float>;
+	const float wb = params.jincSinc * std::numbers::pi_v<float>;
+
+	JincAxis colAxis;
+	JincAxis rowAxis;
+	// 每个相位组合的 4x4 个权重，按 [rowPhase][colPhase] 排列
+	std::vector<std::array<std::array<float, 4>, 4>> weightTable;
+	try {
+		BuildJincAxis(srcWidth, destWidth, colAxis);
+		BuildJincAxis(srcHeight, destHeight, rowAxis);
+
+		if (!colAxis.phases.empty() && !rowAxis.phases.empty()) {
+			weightTable.resize(rowAxis.phases.size() * colAxis.phases.size());
+
+			for (size_t j = 0; j < rowAxis.phases.size(); ++j) {
+				for (size_t i = 0; i < colAxis.phases.size(); ++i) {
+					float weights[4][4];
+					JincWeights(colAxis.phases[i], rowAxis.phases[j], wa, wb, weights);
+					std::memcpy(weightTable[j * colAxis.phases.size() + i].data(), weights, sizeof(weights));
+				}
+			}
+		}
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	// 权重需要逐像素计算时 sin 占了大部分时间，只使用可移植的实现
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled() && !weightTable.empty();
+	const uint32_t bandCount = (destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			const float4* srcRows[4];
+			for (uint32_t j = 0; j < 4; ++j) {
+				srcRows[j] = src.data() + (size_t)rowAxis.indices[(size_t)y * 4 + j] * srcWidth;
+			}
+
+			float4* destRow = dest.data() + (size_t)y * destWidth;
+			if (useAvx2) {
+				const float* srcRowData[4] = { &srcRows[0]->x, &srcRows[1]->x, &srcRows[2]->x, &srcRows[3]->x };
+				const float* rowWeights = &weightTable[rowAxis.phaseIds[y] * colAxis.phases.size()][0][0];
+				ResampleJincRowAvx2(srcRowData, colAxis.indices.data(), rowWeights,
+					colAxis.phaseIds.data(), params.jincARStrength, &destRow->x, destWidth);
+				continue;
+			}
+
+			for (uint32_t x = 0; x < destWidth; ++x) {
+				float computedWeights[4][4];
+				const float(*weights)[4];
+				if (weightTable.empty()) {
+					JincWeights(colAxis.fracs[x], rowAxis.fracs[y], wa, wb, computedWeights);
+					weights = computedWeights;
+				} else {
+					weights = (const float(*)[4])weightTable[
+						rowAxis.phaseIds[y] * colAxis.phases.size() + colAxis.phaseIds[x]].data();
+				}
+
+				const uint32_t* colIndices = colAxis.indices.data() + (size_t)x * 4;
+
+				float4 color = float4();
+				for (uint32_t j = 0; j < 4; ++j) {
+					for (uint32_t i = 0; i < 4; ++i) {
+						// 和 Jinc.hlsl 相同，最后一行的第二个纹素使用的是第三列
+						const uint32_t colIdx = colIndices[j == 3 && i == 1 ? 2 : i];
+						color += srcRows[j][colIdx] * weights[j][i];
+					}
+				}
+
+				if (params.jincARStrength > 0.0f) {
+					color = AntiRinging(
+						color,
+						srcRows[1][colIndices[1]],
+						srcRows[1][colIndices[2]],
+						srcRows[2][colIndices[1]],
+						srcRows[2][colIndices[2]],
+						params.jincARStrength
+					);
+				}
+
+				destRow[x] = WithAlpha(color, 1.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+bool ResamplerCpu::Scale(
+	ResampleFilter filter,
+	const ResampleParameters& params,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	if (srcWidth == 0 || srcHeight == 0 || destWidth == 0 || destHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	if (filter == ResampleFilter::Jinc) {
+		return ScaleJinc(params, src, srcWidth, srcHeight, dest, destWidth, destHeight);
+	}
+
+	WeightTable colTable;
+	WeightTable rowTable;
+	try {
+		BuildWeightTable(filter, params, srcWidth, destWidth, colTable);
+		BuildWeightTable(filter, params, srcHeight, destHeight, rowTable);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	if (filter == ResampleFilter::Nearest) {
+		ScaleNearest(colTable, rowTable, src, srcWidth, dest, destWidth, destHeight);
+		return true;
+	}
+
+	return ScaleSeparable(filter, params, colTable, rowTable, src, srcWidth, dest, destWidth, destHeight);
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Float4.h"
+#include <span>
+
+namespace Magpie {
+
+enum class ResampleFilter {
+	// Nearest.hlsl
+	Nearest,
+	// Bilinear.hlsl
+	Bilinear,
+	// Bicubic.hlsl
+	Bicubic,
+	// Lanczos.hlsl
+	Lanczos,
+	// Jinc.hlsl
+	Jinc
+};
+
+// 和各效果的参数一一对应，默认值也相同
+struct ResampleParameters {
+	float bicubicB = 0.33f;
+	float bicubicC = 0.33f;
+	float lanczosARStrength = 0.5f;
+	float jincWindowSinc = 0.5f;
+	float jincSinc = 0.825f;
+	float jincARStrength = 0.5f;
+};
+
+// 传统插值算法的 CPU 实现，结果和对应的效果相同，可用于在没有 GPU 时缩放图像，也可作为着色器输出的参考。
+// 每个输出行和列的采样位置和权重是预先计算的，可分离的算法先水平再竖直分两遍执行。
+// Nearest 和 Bilinear 保留 Alpha 通道，其他算法和着色器一样输出的 Alpha 始终为 1。
+// 支持 AVX2 时每次计算两个像素，结果和可移植的实现完全相同。
+struct ResamplerCpu {
+	static bool Scale(
+		ResampleFilter filter,
+		const ResampleParameters& params,
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest,
+		uint32_t destWidth,
+		uint32_t destHeight
+	) noexcept;
+};
+
+}
@@ -0,0 +1,225 @@
+#include "ResamplerCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+namespace Magpie {
+
+// 和 float4 的 w 分量对应的位
+static constexpr int ALPHA_MASK = 0x88;
+
+// 低半部分为第一个像素，高半部分为第二个像素
+static __m256 LoadPair(const float* first, const float* second) noexcept {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(first)), _mm_loadu_ps(second), 1);
+}
+
+static __m256 BroadcastPair(float first, float second) noexcept {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(first)), _mm_set1_ps(second), 1);
+}
+
+// 和 ResamplerCpu.cpp 中的 AntiRinging 相同。min 和 max 的参数顺序使相等和 NaN 时的结果和
+// std::min、std::max 相同
+static __m256 AntiRinging(__m256 color, __m256 texel1, __m256 texel2, __m256 texel3, __m256 texel4, __m256 strength) noexcept {
+	const __m256 minSample = _mm256_min_ps(_mm256_min_ps(texel4, texel3), _mm256_min_ps(texel2, texel1));
+	const __m256 maxSample = _mm256_max_ps(_mm256_max_ps(texel4, texel3), _mm256_max_ps(texel2, texel1));
+	const __m256 clamped = _mm256_min_ps(maxSample, _mm256_max_ps(minSample, color));
+	return _mm256_add_ps(color, _mm256_mul_ps(_mm256_sub_ps(clamped, color), strength));
+}
+
+static __m128 AntiRinging(__m128 color, __m128 texel1, __m128 texel2, __m128 texel3, __m128 texel4, __m128 strength) noexcept {
+	const __m128 minSample = _mm_min_ps(_mm_min_ps(texel4, texel3), _mm_min_ps(texel2, texel1));
+	const __m128 maxSample = _mm_max_ps(_mm_max_ps(texel4, texel3), _mm_max_ps(texel2, texel1));
+	const __m128 clamped = _mm_min_ps(maxSample, _mm_max_ps(minSample, color));
+	return _mm_add_ps(color, _mm_mul_ps(_mm_sub_ps(clamped, color), strength));
+}
+
+void ResampleRowAvx2(
+	const float* srcRow,
+	const uint32_t* indices,
+	const float* weights,
+	uint32_t taps,
+	float* destRow,
+	uint32_t destWidth
+) noexcept {
+	uint32_t x = 0;
+	for (; x + 2 <= destWidth; x += 2) {
+		const uint32_t* indices1 = indices + (size_t)x * taps;
+		const uint32_t* indices2 = indices1 + taps;
+		const float* weights1 = weights + (size_t)x * taps;
+		const float* weights2 = weights1 + taps;
+
+		__m256 sum = _mm256_mul_ps(LoadPair(srcRow + (size_t)indices1[0] * 4, srcRow + (size_t)indices2[0] * 4),
+			BroadcastPair(weights1[0], weights2[0]));
+		for (uint32_t t = 1; t < taps; ++t) {
+			const __m256 texels = LoadPair(srcRow + (size_t)indices1[t] * 4, srcRow + (size_t)indices2[t] * 4);
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(texels, BroadcastPair(weights1[t], weights2[t])));
+		}
+		_mm256_storeu_ps(destRow + (size_t)x * 4, sum);
+	}
+
+	if (x < destWidth) {
+		const uint32_t* lastIndices = indices + (size_t)x * taps;
+		const float* lastWeights = weights + (size_t)x * taps;
+
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(srcRow + (size_t)lastIndices[0] * 4), _mm_set1_ps(lastWeights[0]));
+		for (uint32_t t = 1; t < taps; ++t) {
+			const __m128 texels = _mm_loadu_ps(srcRow + (size_t)lastIndices[t] * 4);
+			sum = _mm_add_ps(sum, _mm_mul_ps(texels, _mm_set1_ps(lastWeights[t])));
+		}
+		_mm_storeu_ps(destRow + (size_t)x * 4, sum);
+	}
+}
+
+void ResampleColumnAvx2(
+	const float* const* srcRows,
+	const float* weights,
+	uint32_t taps,
+	bool opaque,
+	float* destRow,
+	uint32_t width
+) noexcept {
+	const size_t floatCount = (size_t)width * 4;
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= floatCount; i += 8) {
+		__m256 sum = _mm256_mul_ps(_mm256_loadu_ps(srcRows[0] + i), _mm256_set1_ps(weights[0]));
+		for (uint32_t t = 1; t < taps; ++t) {
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(srcRows[t] + i), _mm256_set1_ps(weights[t])));
+		}
+		if (opaque) {
+			sum = _mm256_blend_ps(sum, one, ALPHA_MASK);
+		}
+		_mm256_storeu_ps(destRow + i, sum);
+	}
+
+	if (i < floatCount) {
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(srcRows[0] + i), _mm_set1_ps(weights[0]));
+		for (uint32_t t = 1; t < taps; ++t) {
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(srcRows[t] + i), _mm_set1_ps(weights[t])));
+		}
+		if (opaque) {
+			sum = _mm_blend_ps(sum, _mm256_castps256_ps128(one), ALPHA_MASK & 0xF);
+		}
+		_mm_storeu_ps(destRow + i, sum);
+	}
+}
+
+void ResampleAntiRingingAvx2(
+	const float* srcRow1,
+	const float* srcRow2,
+	const uint32_t* colIndices,
+	uint32_t colTaps,
+	float strength,
+	float* destRow,
+	uint32_t destWidth
+) noexcept {
+	const __m256 strengthv = _mm256_set1_ps(strength);
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	uint32_t x = 0;
+	for (; x + 2 <= destWidth; x += 2) {
+		const uint32_t* indices1 = colIndices + (size_t)x * colTaps;
+		const uint32_t* indices2 = indices1 + colTaps;
+
+		const __m256 color = AntiRinging(
+			_mm256_loadu_ps(destRow + (size_t)x * 4),
+			LoadPair(srcRow1 + (size_t)indices1[2] * 4, srcRow1 + (size_t)indices2[2] * 4),
+			LoadPair(srcRow1 + (size_t)indices1[3] * 4, srcRow1 + (size_t)indices2[3] * 4),
+			LoadPair(srcRow2 + (size_t)indices1[2] * 4, srcRow2 + (size_t)indices2[2] * 4),
+			LoadPair(srcRow2 + (size_t)indices1[3] * 4, srcRow2 + (size_t)indices2[3] * 4),
+			strengthv
+		);
+		_mm256_storeu_ps(destRow + (size_t)x * 4, _mm256_blend_ps(color, one, ALPHA_MASK));
+	}
+
+	if (x < destWidth) {
+		const uint32_t* lastIndices = colIndices + (size_t)x * colTaps;
+
+		const __m128 color = AntiRinging(
+			_mm_loadu_ps(destRow + (size_t)x * 4),
+			_mm_loadu_ps(srcRow1 + (size_t)lastIndices[2] * 4),
+			_mm_loadu_ps(srcRow1 + (size_t)lastIndices[3] * 4),
+			_mm_loadu_ps(srcRow2 + (size_t)lastIndices[2] * 4),
+			_mm_loadu_ps(srcRow2 + (size_t)lastIndices[3] * 4),
+			_mm256_castps256_ps128(strengthv)
+		);
+		_mm_storeu_ps(destRow + (size_t)x * 4, _mm_blend_ps(color, _mm256_castps256_ps128(one), ALPHA_MASK & 0xF));
+	}
+}
+
+void ResampleJincRowAvx2(
+	const float* const* srcRows,
+	const uint32_t* colIndices,
+	const float* weights,
+	const uint32_t* colPhaseIds,
+	float arStrength,
+	float* destRow,
+	uint32_t destWidth
+) noexcept {
+	const __m256 strength = _mm256_set1_ps(arStrength);
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	uint32_t x = 0;
+	for (; x + 2 <= destWidth; x += 2) {
+		const uint32_t* indices1 = colIndices + (size_t)x * 4;
+		const uint32_t* indices2 = indices1 + 4;
+		const float* weights1 = weights + (size_t)colPhaseIds[x] * 16;
+		const float* weights2 = weights + (size_t)colPhaseIds[x + 1] * 16;
+
+		__m256 texels[4][4];
+		__m256 sum = _mm256_setzero_ps();
+		for (uint32_t j = 0; j < 4; ++j) {
+			for (uint32_t i = 0; i < 4; ++i) {
+				// 和 Jinc.hlsl 相同，最后一行的第二个纹素使用的是第三列
+				const uint32_t col = j == 3 && i == 1 ? 2 : i;
+				texels[j][i] = LoadPair(srcRows[j] + (size_t)indices1[col] * 4, srcRows[j] + (size_t)indices2[col] * 4);
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(texels[j][i], BroadcastPair(weights1[j * 4 + i], weights2[j * 4 + i])));
+			}
+		}
+
+		if (arStrength > 0.0f) {
+			sum = AntiRinging(sum, texels[1][1], texels[1][2], texels[2][1], texels[2][2], strength);
+		}
+		_mm256_storeu_ps(destRow + (size_t)x * 4, _mm256_blend_ps(sum, one, ALPHA_MASK));
+	}
+
+	if (x < destWidth) {
+		const uint32_t* lastIndices = colIndices + (size_t)x * 4;
+		const float* lastWeights = weights + (size_t)colPhaseIds[x] * 16;
+
+		__m128 texels[4][4];
+		__m128 sum = _mm_setzero_ps();
+		for (uint32_t j = 0; j < 4; ++j) {
+			for (uint32_t i = 0; i < 4; ++i) {
+				const uint32_t col = j == 3 && i == 1 ? 2 : i;
+				texels[j][i] = _mm_loadu_ps(srcRows[j] + (size_t)lastIndices[col] * 4);
+				sum = _mm_add_ps(sum, _mm_mul_ps(texels[j][i], _mm_set1_ps(lastWeights[j * 4 + i])));
+			}
+		}
+
+		if (arStrength > 0.0f) {
+			sum = AntiRinging(sum, texels[1][1], texels[1][2], texels[2][1], texels[2][2], _mm256_castps256_ps128(strength));
+		}
+		_mm_storeu_ps(destRow + (size_t)x * 4, _mm_blend_ps(sum, _mm256_castps256_ps128(one), ALPHA_MASK & 0xF));
+	}
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void ResampleRowAvx2(const float*, const uint32_t*, const float*, uint32_t, float*, uint32_t) noexcept {}
+
+void ResampleColumnAvx2(const float* const*, const float*, uint32_t, bool, float*, uint32_t) noexcept {}
+
+void ResampleAntiRingingAvx2(const float*, const float*, const uint32_t*, uint32_t, float, float*, uint32_t) noexcept {}
+
+void ResampleJincRowAvx2(const float* const*, const uint32_t*, const float*, const uint32_t*, float, float*, uint32_t) noexcept {}
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+namespace Magpie {
+
+// ResamplerCpu 的 AVX2 核。像素以 4 个 float 表示，每个寄存器保存两个像素。乘法和加法不合并为 FMA，
+// 累加顺序也和可移植的实现相同，因此结果完全相同。
+
+// 水平方向的卷积：destRow[x] = Σ srcRow[indices[x * taps + t]] * weights[x * taps + t]
+void ResampleRowAvx2(
+	const float* srcRow,
+	const uint32_t* indices,
+	const float* weights,
+	uint32_t taps,
+	float* destRow,
+	uint32_t destWidth
+) noexcept;
+
+// 竖直方向的卷积：destRow[x] = Σ srcRows[t][x] * weights[t]。opaque 为 true 时 Alpha 通道写入 1
+void ResampleColumnAvx2(
+	const float* const* srcRows,
+	const float* weights,
+	uint32_t taps,
+	bool opaque,
+	float* destRow,
+	uint32_t width
+) noexcept;
+
+// Lanczos 的抗振铃，将 destRow 中的每个像素向距离最近的 2x2 个纹素的范围内收缩，Alpha 通道写入 1。
+// 这些纹素位于 srcRow1 和 srcRow2 的 colIndices[x * colTaps + 2] 和 colIndices[x * colTaps + 3] 列
+void ResampleAntiRingingAvx2(
+	const float* srcRow1,
+	const float* srcRow2,
+	const uint32_t* colIndices,
+	uint32_t colTaps,
+	float strength,
+	float* destRow,
+	uint32_t destWidth
+) noexcept;
+
+// Jinc 的 4x4 卷积，srcRows 为 4 个源图像行，colIndices 为每个输出像素的 4 个列索引。
+// 第 x 个输出像素使用 weights + colPhaseIds[x] * 16 处的 4x4 个权重。arStrength 大于 0 时执行抗振铃，
+// Alpha 通道写入 1
+void ResampleJincRowAvx2(
+	const float* const* srcRows,
+	const uint32_t* colIndices,
+	const float* weights,
+	const uint32_t* colPhaseIds,
+	float arStrength,
+	float* destRow,
+	uint32_t destWidth
+) noexcept;
+
+}
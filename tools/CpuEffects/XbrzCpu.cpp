@@ -0,0 +1,643 @@
+#include "XbrzCpu.h"
+#include "CpuFeatures.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+#include "XbrzCpuKernels.h"
+
+namespace Magpie {
+
+// 每个任务处理的行数
+static constexpr uint32_t ROWS_PER_BAND = 16;
+// AVX2 核一次计算的像素数
+static constexpr uint32_t AVX2_BATCH_SIZE = 8;
+
+static constexpr XbrzBlendOp SCALE2X_OPS[] = {
+	{ 0, 1, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } },
+	{ 1, 1, { 1.0f - std::numbers::pi_v<float> / 4.0f, 0.5f, 0.75f, 0.75f, 5.0f / 6.0f } },
+	{ 1, 0, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } }
+};
+
+static constexpr XbrzBlendOp SCALE3X_OPS[] = {
+	{ 1, 2, { 0.0f, 0.125f, 0.25f, 0.75f, 0.75f } },
+	{ 2, 2, { 0.4545939598f, 0.875f, 1.0f, 1.0f, 1.0f } },
+	{ 2, 1, { 0.0f, 0.125f, 0.75f, 0.25f, 0.75f } },
+	{ 2, 0, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } },
+	{ 0, 2, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } }
+};
+
+static constexpr XbrzBlendOp SCALE4X_OPS[] = {
+	{ 2, 2, { 0.0f, 0.0f, 0.25f, 0.25f, 1.0f / 3.0f } },
+	{ 0, 3, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } },
+	{ 1, 3, { 0.0f, 0.0f, 0.0f, 0.75f, 0.75f } },
+	{ 2, 3, { 0.08677704501f, 0.5f, 0.75f, 1.0f, 1.0f } },
+	{ 3, 3, { 0.6848532563f, 1.0f, 1.0f, 1.0f, 1.0f } },
+	{ 3, 2, { 0.08677704501f, 0.5f, 1.0f, 0.75f, 1.0f } },
+	{ 3, 1, { 0.0f, 0.0f, 0.75f, 0.0f, 0.75f } },
+	{ 3, 0, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } }
+};
+
+static constexpr XbrzBlendOp SCALE5X_OPS[] = {
+	{ 2, 3, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } },
+	{ 3, 3, { 0.0f, 0.125f, 0.75f, 0.75f, 2.0f / 3.0f } },
+	{ 3, 2, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } },
+	{ 1, 4, { 0.0f, 0.0f, 0.0f, 0.75f, 0.75f } },
+	{ 2, 4, { 0.0f, 0.125f, 0.25f, 1.0f, 1.0f } },
+	{ 3, 4, { 0.2306749731f, 0.875f, 1.0f, 1.0f, 1.0f } },
+	{ 4, 4, { 0.8631434088f, 1.0f, 1.0f, 1.0f, 1.0f } },
+	{ 4, 3, { 0.2306749731f, 0.875f, 1.0f, 1.0f, 1.0f } },
+	{ 4, 2, { 0.0f, 0.125f, 1.0f, 0.25f, 1.0f } },
+	{ 4, 1, { 0.0f, 0.0f, 0.75f, 0.0f, 0.75f } },
+	{ 4, 0, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } },
+	{ 0, 4, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } }
+};
+
+static constexpr XbrzBlendOp SCALE6X_OPS[] = {
+	{ 2, 4, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } },
+	{ 3, 4, { 0.0f, 0.0f, 0.25f, 0.75f, 0.75f } },
+	{ 4, 4, { 0.0f, 0.5f, 1.0f, 1.0f, 1.0f } },
+	{ 4, 3, { 0.0f, 0.0f, 0.75f, 0.25f, 0.75f } },
+	{ 4, 2, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } },
+	{ 0, 5, { 0.0f, 0.0f, 0.0f, 0.25f, 0.25f } },
+	{ 1, 5, { 0.0f, 0.0f, 0.0f, 0.75f, 0.75f } },
+	{ 2, 5, { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f } },
+	{ 3, 5, { 0.05652034508f, 0.5f, 0.75f, 1.0f, 1.0f } },
+	{ 4, 5, { 0.4236372243f, 1.0f, 1.0f, 1.0f, 1.0f } },
+	{ 5, 5, { 0.9711013910f, 1.0f, 1.0f, 1.0f, 1.0f } },
+	{ 5, 4, { 0.4236372243f, 1.0f, 1.0f, 1.0f, 1.0f } },
+	{ 5, 3, { 0.05652034508f, 0.5f, 1.0f, 0.75f, 1.0f } },
+	{ 5, 2, { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f } },
+	{ 5, 1, { 0.0f, 0.0f, 0.75f, 0.0f, 0.75f } },
+	{ 5, 0, { 0.0f, 0.0f, 0.25f, 0.0f, 0.25f } }
+};
+
+// 按缩放倍数索引，从 2 倍开始
+static constexpr std::span<const XbrzBlendOp> BLEND_OPS[] = {
+	SCALE2X_OPS, SCALE3X_OPS, SCALE4X_OPS, SCALE5X_OPS, SCALE6X_OPS
+};
+
+static constexpr uint32_t MAX_SCALE = 6;
+
+static float DistYCbCr(const float4& pixA, const float4& pixB) noexcept {
+	static constexpr float4 W(0.2627f, 0.6780f, 0.0593f, 0.0f);
+	constexpr float SCALE_B = 0.5f / (1.0f - 0.0593f);
+	constexpr float SCALE_R = 0.5f / (1.0f - 0.2627f);
+
+	const float4 diff = pixA - pixB;
+	const float y = Dot3(diff, W);
+	const float cb = SCALE_B * (diff.z - y);
+	const float cr = SCALE_R * (diff.x - y);
+	return std::sqrt(y * y + cb * cb + cr * cr);
+}
+
+static bool IsPixEqual(const float4& pixA, const float4& pixB) noexcept {
+	return DistYCbCr(pixA, pixB) < XBRZ_EQUAL_COLOR_TOLERANCE;
+}
+
+// 判断像素是否相同。xBRZ_Freescale 直接比较颜色，其他效果比较着色器中 reduce 的结果
+class XbrzSource {
+public:
+	bool Initialize(std::span<const float4> src, uint32_t width, uint32_t height, bool exactEqual) noexcept {
+		if (!_image.Initialize(src, width, height)) {
+			return false;
+		}
+
+		if (exactEqual) {
+			return true;
+		}
+
+		// 四周各复制一个像素，足以覆盖所有比较
+		_keyStride = (int)width + 2;
+		try {
+			_keys.resize((size_t)_keyStride * (height + 2));
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		static constexpr float4 REDUCE_WEIGHTS(65536.0f, 256.0f, 1.0f, 0.0f);
+		for (int y = -1; y <= (int)height; ++y) {
+			float* keyRow = _keys.data() + (size_t)(y + 1) * _keyStride;
+			for (int x = -1; x <= (int)width; ++x) {
+				keyRow[x + 1] = Dot3(_image.Texel(x, y), REDUCE_WEIGHTS);
+			}
+		}
+
+		return true;
+	}
+
+	float4 Texel(int x, int y) const noexcept {
+		return _image.Texel(x, y);
+	}
+
+	// 供 AVX2 核使用，(x, y) 为第一个像素
+	XbrzSourceRow Row(int x, int y) const noexcept {
+		return {
+			&_image.Texel(x, y).x,
+			(size_t)_image.Stride(),
+			_keys.empty() ? nullptr : &_keys[(size_t)(y + 1) * _keyStride + x + 1],
+			(size_t)_keyStride
+		};
+	}
+
+	template <bool EXACT>
+	bool IsSame(int x0, int y0, int x1, int y1) const noexcept {
+		if constexpr (EXACT) {
+			const float4& a = _image.Texel(x0, y0);
+			const float4& b = _image.Texel(x1, y1);
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		} else {
+			return _keys[(size_t)(y0 + 1) * _keyStride + x0 + 1] == _keys[(size_t)(y1 + 1) * _keyStride + x1 + 1];
+		}
+	}
+
+private:
+	PaddedImage _image;
+	std::vector<float> _keys;
+	int _keyStride = 0;
+};
+
+// 以 (x, y) 为左上角的 2x2 像素块的分类，和着色器中的角 (1, 1) 相同。
+// 着色器对每个像素的四个角都计算一次，其实每个像素块被相邻的四个像素共用
+template <bool EXACT>
+static uint8_t ClassifyQuad(const XbrzSource& source, int x, int y) noexcept {
+	// E F
+	// H I
+	if ((source.IsSame<EXACT>(x, y, x + 1, y) && source.IsSame<EXACT>(x, y + 1, x + 1, y + 1)) ||
+		(source.IsSame<EXACT>(x, y, x, y + 1) && source.IsSame<EXACT>(x + 1, y, x + 1, y + 1))) {
+		return 0;
+	}
+
+	auto dist = [&](int x0, int y0, int x1, int y1) {
+		return DistYCbCr(source.Texel(x + x0, y + y0), source.Texel(x + x1, y + y1));
+	};
+
+	const float distHF = dist(-1, 1, 0, 0) + dist(0, 0, 1, -1) + dist(0, 2, 1, 1) + dist(1, 1, 2, 0) + 4.0f * dist(0, 1, 1, 0);
+	const float distEI = dist(-1, 0, 0, 1) + dist(0, 1, 1, 2) + dist(0, -1, 1, 0) + dist(1, 0, 2, 1) + 4.0f * dist(0, 0, 1, 1);
+
+	if (distHF < distEI) {
+		return uint8_t(XBRZ_QUAD_BLEND_EI | (XBRZ_DOMINANT_DIRECTION_THRESHOLD * distHF < distEI ? XBRZ_QUAD_DOMINANT : 0));
+	} else if (distHF > distEI) {
+		return uint8_t(XBRZ_QUAD_BLEND_FH | (XBRZ_DOMINANT_DIRECTION_THRESHOLD * distEI < distHF ? XBRZ_QUAD_DOMINANT : 0));
+	} else {
+		return 0;
+	}
+}
+
+// 计算所有 2x2 像素块的分类，左上角的范围为 [-1, width) x [-1, height)。可能抛出 std::bad_alloc
+template <bool EXACT>
+static std::vector<uint8_t> ClassifyQuads(const XbrzSource& source, uint32_t width, uint32_t height) {
+	const uint32_t stride = width + 1;
+	std::vector<uint8_t> quads((size_t)stride * (height + 1));
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+
+	const uint32_t bandCount = (height + 1 + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, height + 1);
+
+		for (uint32_t row = beginRow; row < endRow; ++row) {
+			uint8_t* quadRow = quads.data() + (size_t)row * stride;
+
+			uint32_t col = 0;
+			if (useAvx2) {
+				for (; col + AVX2_BATCH_SIZE <= stride; col += AVX2_BATCH_SIZE) {
+					XbrzClassifyQuadsAvx2(source.Row((int)col - 1, (int)row - 1), quadRow + col);
+				}
+			}
+
+			for (; col < stride; ++col) {
+				quadRow[col] = ClassifyQuad<EXACT>(source, (int)col - 1, (int)row - 1);
+			}
+		}
+	});
+
+	return quads;
+}
+
+// 由相邻的四个像素块得到像素 (x, y) 四个角的混合类型，按左上、右上、右下、左下排列，和着色器中的 blendResult 相同
+template <bool EXACT>
+static std::array<uint8_t, 4> GetBlendResult(
+	const XbrzSource& source,
+	const uint8_t* quads,
+	uint32_t width,
+	int x,
+	int y
+) noexcept {
+	const size_t stride = (size_t)width + 1;
+	const uint8_t* topQuads = quads + (size_t)y * stride + x;
+	const uint8_t* bottomQuads = topQuads + stride;
+
+	auto blendType = [](uint8_t quad) {
+		return (quad & XBRZ_QUAD_DOMINANT) ? XBRZ_BLEND_DOMINANT : XBRZ_BLEND_NORMAL;
+	};
+
+	std::array<uint8_t, 4> result{};
+	if ((topQuads[0] & XBRZ_QUAD_BLEND_EI) && !source.IsSame<EXACT>(x, y, x - 1, y) && !source.IsSame<EXACT>(x, y, x, y - 1)) {
+		result[0] = blendType(topQuads[0]);
+	}
+	if ((topQuads[1] & XBRZ_QUAD_BLEND_FH) && !source.IsSame<EXACT>(x, y, x, y - 1) && !source.IsSame<EXACT>(x, y, x + 1, y)) {
+		result[1] = blendType(topQuads[1]);
+	}
+	if ((bottomQuads[1] & XBRZ_QUAD_BLEND_EI) && !source.IsSame<EXACT>(x, y, x + 1, y) && !source.IsSame<EXACT>(x, y, x, y + 1)) {
+		result[2] = blendType(bottomQuads[1]);
+	}
+	if ((bottomQuads[0] & XBRZ_QUAD_BLEND_FH) && !source.IsSame<EXACT>(x, y, x - 1, y) && !source.IsSame<EXACT>(x, y, x, y + 1)) {
+		result[3] = blendType(bottomQuads[0]);
+	}
+	return result;
+}
+
+struct CornerLines {
+	bool doLineBlend;
+	bool haveShallowLine;
+	bool haveSteepLine;
+};
+
+// 和着色器中的 ScalePixel 相同，分析旋转后的右下角。调用者应确保该角需要混合
+template <bool EXACT>
+static CornerLines AnalyzeCorner(
+	const XbrzSource& source,
+	int x,
+	int y,
+	const float4(&kernel)[9],
+	const std::array<uint8_t, 4>& blend,
+	int rotation
+) noexcept {
+	int idx[9];
+	for (int i = 0; i < 9; ++i) {
+		idx[i] = XbrzRotateKernelIndex(i, rotation);
+	}
+
+	auto k = [&](int i) {
+		return kernel[idx[i]];
+	};
+	auto isSame = [&](int i, int j) {
+		return source.IsSame<EXACT>(
+			x + XBRZ_KERNEL_OFFSETS[idx[i]][0], y + XBRZ_KERNEL_OFFSETS[idx[i]][1],
+			x + XBRZ_KERNEL_OFFSETS[idx[j]][0], y + XBRZ_KERNEL_OFFSETS[idx[j]][1]
+		);
+	};
+
+	const uint8_t blend1 = blend[(1 - rotation) & 3];
+	const uint8_t blend2 = blend[(2 - rotation) & 3];
+	const uint8_t blend3 = blend[(3 - rotation) & 3];
+
+	CornerLines result;
+	result.doLineBlend = blend2 >= XBRZ_BLEND_DOMINANT ||
+		!((blend1 != XBRZ_BLEND_NONE && !IsPixEqual(k(0), k(4))) ||
+			(blend3 != XBRZ_BLEND_NONE && !IsPixEqual(k(0), k(8))) ||
+			(IsPixEqual(k(4), k(3)) && IsPixEqual(k(3), k(2)) && IsPixEqual(k(2), k(1)) &&
+				IsPixEqual(k(1), k(8)) && !IsPixEqual(k(0), k(2))));
+
+	const float dist14 = DistYCbCr(k(1), k(4));
+	const float dist38 = DistYCbCr(k(3), k(8));
+	result.haveShallowLine = XBRZ_STEEP_DIRECTION_THRESHOLD * dist14 <= dist38 && !isSame(0, 4) && !isSame(5, 4);
+	result.haveSteepLine = XBRZ_STEEP_DIRECTION_THRESHOLD * dist38 <= dist14 && !isSame(0, 8) && !isSame(7, 8);
+	return result;
+}
+
+static void LoadKernel(const XbrzSource& source, int x, int y, float4(&kernel)[9]) noexcept {
+	for (int i = 0; i < 9; ++i) {
+		kernel[i] = source.Texel(x + XBRZ_KERNEL_OFFSETS[i][0], y + XBRZ_KERNEL_OFFSETS[i][1]);
+	}
+}
+
+bool XbrzCpu::Scale(
+	uint32_t scale,
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest
+) noexcept {
+	if (scale < 2 || scale > MAX_SCALE || srcWidth == 0 || srcHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)srcWidth * srcHeight * scale * scale) {
+		return false;
+	}
+
+	XbrzSource source;
+	if (!source.Initialize(src, srcWidth, srcHeight, false)) {
+		return false;
+	}
+
+	std::vector<uint8_t> quads;
+	try {
+		quads = ClassifyQuads<false>(source, srcWidth, srcHeight);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	const std::span<const XbrzBlendOp> ops = BLEND_OPS[scale - 2];
+	const uint32_t destWidth = srcWidth * scale;
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+
+	const uint32_t bandCount = (srcHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, srcHeight);
+
+		float4 block[MAX_SCALE][MAX_SCALE];
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			uint32_t x = 0;
+			if (useAvx2) {
+				for (; x + AVX2_BATCH_SIZE <= srcWidth; x += AVX2_BATCH_SIZE) {
+					const XbrzSourceRow sourceRow = source.Row((int)x, (int)y);
+					uint8_t cornerInfos[AVX2_BATCH_SIZE * 4];
+					XbrzAnalyzeCornersAvx2(sourceRow, quads.data() + (size_t)y * (srcWidth + 1) + x, srcWidth + 1, cornerInfos);
+					XbrzBlendAvx2(sourceRow, cornerInfos, ops.data(), ops.size(), scale,
+						&dest[(size_t)y * scale * destWidth + x * scale].x, destWidth);
+				}
+			}
+
+			// 剩余的像素使用可移植的实现
+			for (; x < srcWidth; ++x) {
+				float4 kernel[9];
+				LoadKernel(source, (int)x, (int)y, kernel);
+
+				for (uint32_t row = 0; row < scale; ++row) {
+					for (uint32_t col = 0; col < scale; ++col) {
+						block[row][col] = kernel[0];
+					}
+				}
+
+				const std::array<uint8_t, 4> blend = GetBlendResult<false>(source, quads.data(), srcWidth, (int)x, (int)y);
+
+				// 依次混合右下、右上、左上和左下角，和着色器的顺序相同
+				for (int rotation = 0; rotation < 4; ++rotation) {
+					if (blend[(2 - rotation) & 3] == XBRZ_BLEND_NONE) {
+						continue;
+					}
+
+					const CornerLines lines = AnalyzeCorner<false>(source, (int)x, (int)y, kernel, blend, rotation);
+
+					const float4 k1 = kernel[XbrzRotateKernelIndex(1, rotation)];
+					const float4 k3 = kernel[XbrzRotateKernelIndex(3, rotation)];
+					const float4 blendPix = DistYCbCr(kernel[0], k1) <= DistYCbCr(kernel[0], k3) ? k1 : k3;
+
+					const uint32_t weightIdx = lines.doLineBlend
+						? 1 + (uint32_t)lines.haveShallowLine + 2 * (uint32_t)lines.haveSteepLine : 0;
+
+					for (const XbrzBlendOp& op : ops) {
+						const float weight = op.weights[weightIdx];
+						if (weight == 0.0f) {
+							continue;
+						}
+
+						uint32_t row = op.row;
+						uint32_t col = op.col;
+						for (int i = 0; i < rotation; ++i) {
+							const uint32_t t = row;
+							row = scale - 1 - col;
+							col = t;
+						}
+
+						block[row][col] = Lerp(block[row][col], blendPix, weight);
+					}
+				}
+
+				for (uint32_t row = 0; row < scale; ++row) {
+					float4* destRow = dest.data() + (size_t)(y * scale + row) * destWidth + x * scale;
+					for (uint32_t col = 0; col < scale; ++col) {
+						destRow[col] = WithAlpha(block[row][col], 1.0f);
+					}
+				}
+			}
+		}
+	});
+
+	return true;
+}
+
+static constexpr XbrzFreescaleCorner FREESCALE_CORNERS[] = {
+	// 右下
+	{ 2, { 0.0f, XBRZ_RCP_SQRT2 }, { 0.0f, 0.5f }, { 0.0f, 0.25f }, { 1.0f, -1.0f }, { 1.0f, 0.0f }, { 0.0f, -1.0f }, 2, 3 },
+	// 左下
+	{ 3, { -XBRZ_RCP_SQRT2, 0.0f }, { -0.5f, 0.0f }, { -0.25f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f }, { 1.0f, 0.0f }, 1, 3 },
+	// 右上
+	{ 1, { XBRZ_RCP_SQRT2, 0.0f }, { 0.5f, 0.0f }, { 0.25f, 0.0f }, { -1.0f, -1.0f }, { 0.0f, -1.0f }, { -1.0f, 0.0f }, 0, 2 },
+	// 左上
+	{ 0, { 0.0f, -XBRZ_RCP_SQRT2 }, { 0.0f, -0.5f }, { 0.0f, -0.25f }, { -1.0f, 1.0f }, { -1.0f, 0.0f }, { 0.0f, 1.0f }, 0, 1 }
+};
+
+// 和着色器中的 get_left_ratio 相同
+static float GetLeftRatio(
+	float centerX,
+	float centerY,
+	const XbrzFloat2& origin,
+	const XbrzFloat2& direction,
+	float scaleX,
+	float scaleY
+) noexcept {
+	const float p0X = centerX - origin.x;
+	const float p0Y = centerY - origin.y;
+	const float t = (p0X * direction.x + p0Y * direction.y) / (direction.x * direction.x + direction.y * direction.y);
+	const float distX = (p0X - direction.x * t) * scaleX;
+	const float distY = (p0Y - direction.y * t) * scaleY;
+
+	const float orth = p0X * -direction.y + p0Y * direction.x;
+	const float side = orth > 0.0f ? 1.0f : (orth < 0.0f ? -1.0f : 0.0f);
+	const float v = side * std::sqrt(distX * distX + distY * distY);
+
+	// smoothstep(-sqrt(2) / 2, sqrt(2) / 2, v)
+	const float s = std::clamp((v + XBRZ_RCP_SQRT2) / (2.0f * XBRZ_RCP_SQRT2), 0.0f, 1.0f);
+	return s * s * (3.0f - 2.0f * s);
+}
+
+bool XbrzCpu::ScaleFree(
+	std::span<const float4> src,
+	uint32_t srcWidth,
+	uint32_t srcHeight,
+	std::span<float4> dest,
+	uint32_t destWidth,
+	uint32_t destHeight
+) noexcept {
+	if (srcWidth == 0 || srcHeight == 0 || destWidth == 0 || destHeight == 0 ||
+		src.size() < (size_t)srcWidth * srcHeight || dest.size() < (size_t)destWidth * destHeight) {
+		return false;
+	}
+
+	XbrzSource source;
+	if (!source.Initialize(src, srcWidth, srcHeight, true)) {
+		return false;
+	}
+
+	std::vector<uint8_t> quads;
+	// 每个源像素四个角的信息，和着色器中的 tex1 相同。AVX2 核以每个像素 4 个字节访问
+	std::vector<std::array<uint8_t, 4>> cornerInfos;
+	static_assert(sizeof(cornerInfos[0]) == 4);
+	try {
+		quads = ClassifyQuads<true>(source, srcWidth, srcHeight);
+		cornerInfos.resize((size_t)srcWidth * srcHeight);
+	} catch (const std::bad_alloc&) {
+		return false;
+	}
+
+	const bool useAvx2 = CpuFeatures::IsAvx2Enabled();
+
+	// 第一个通道
+	uint32_t bandCount = (srcHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, srcHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			uint32_t x = 0;
+			if (useAvx2) {
+				for (; x + AVX2_BATCH_SIZE <= srcWidth; x += AVX2_BATCH_SIZE) {
+					XbrzAnalyzeCornersAvx2(source.Row((int)x, (int)y), quads.data() + (size_t)y * (srcWidth + 1) + x,
+						srcWidth + 1, cornerInfos[(size_t)y * srcWidth + x].data());
+				}
+			}
+
+			for (; x < srcWidth; ++x) {
+				const std::array<uint8_t, 4> blend = GetBlendResult<true>(source, quads.data(), srcWidth, (int)x, (int)y);
+				std::array<uint8_t, 4>& info = cornerInfos[(size_t)y * srcWidth + x];
+
+				float4 kernel[9];
+				bool isKernelLoaded = false;
+
+				for (int rotation = 0; rotation < 4; ++rotation) {
+					const uint32_t cornerIdx = (2 - rotation) & 3;
+					info[cornerIdx] = blend[cornerIdx];
+					if (blend[cornerIdx] == XBRZ_BLEND_NONE) {
+						continue;
+					}
+
+					if (!isKernelLoaded) {
+						LoadKernel(source, (int)x, (int)y, kernel);
+						isKernelLoaded = true;
+					}
+
+					const CornerLines lines = AnalyzeCorner<true>(source, (int)x, (int)y, kernel, blend, rotation);
+					if (lines.doLineBlend) {
+						info[cornerIdx] |= XBRZ_CORNER_LINE_BLEND;
+						if (lines.haveShallowLine) {
+							info[cornerIdx] |= XBRZ_CORNER_SHALLOW_LINE;
+						}
+						if (lines.haveSteepLine) {
+							info[cornerIdx] |= XBRZ_CORNER_STEEP_LINE;
+						}
+					}
+				}
+			}
+		}
+	});
+
+	// 第二个通道
+	const float outputPtX = 1.0f / destWidth;
+	const float outputPtY = 1.0f / destHeight;
+	// 和着色器中的 GetScale() 相同
+	const float outputScaleX = (float)destWidth / srcWidth;
+	const float outputScaleY = (float)destHeight / srcHeight;
+
+	// AVX2 核使用的每个输出列的源像素和偏移，所有行相同
+	std::vector<int32_t> columnSrcX;
+	std::vector<float> columnFx;
+	if (useAvx2) {
+		try {
+			columnSrcX.resize(destWidth);
+			columnFx.resize(destWidth);
+		} catch (const std::bad_alloc&) {
+			return false;
+		}
+
+		for (uint32_t x = 0; x < destWidth; ++x) {
+			const float posX = (x + 0.5f) * outputPtX * srcWidth;
+			const float floorX = std::floor(posX);
+			columnFx[x] = posX - floorX - 0.5f;
+			columnSrcX[x] = std::min((int)floorX, (int)srcWidth - 1);
+		}
+	}
+
+	bandCount = (destHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ThreadPool::Get().ParallelFor(bandCount, [&](uint32_t bandIdx) {
+		const uint32_t beginRow = bandIdx * ROWS_PER_BAND;
+		const uint32_t endRow = std::min(beginRow + ROWS_PER_BAND, destHeight);
+
+		for (uint32_t y = beginRow; y < endRow; ++y) {
+			// 和着色器中的 pos * GetInputSize() 相同
+			const float posY = (y + 0.5f) * outputPtY * srcHeight;
+			const float floorY = std::floor(posY);
+			const float fy = posY - floorY - 0.5f;
+			const int srcY = std::min((int)floorY, (int)srcHeight - 1);
+
+			float4* destRow = dest.data() + (size_t)y * destWidth;
+
+			uint32_t x = 0;
+			if (useAvx2) {
+				XbrzFreescaleBatch batch;
+				batch.corners = FREESCALE_CORNERS;
+				const XbrzSourceRow sourceRow = source.Row(0, srcY);
+				batch.texelRow = sourceRow.texel;
+				batch.texelStride = sourceRow.texelStride;
+				batch.cornerInfoRow = cornerInfos[(size_t)srcY * srcWidth].data();
+				batch.fy = fy;
+				batch.scaleX = outputScaleX;
+				batch.scaleY = outputScaleY;
+
+				for (; x + AVX2_BATCH_SIZE <= destWidth; x += AVX2_BATCH_SIZE) {
+					batch.srcX = &columnSrcX[x];
+					batch.fx = &columnFx[x];
+					XbrzFreescaleAvx2(batch, &destRow[x].x);
+				}
+			}
+
+			// 剩余的像素使用可移植的实现
+			for (; x < destWidth; ++x) {
+				const float posX = (x + 0.5f) * outputPtX * srcWidth;
+				const float floorX = std::floor(posX);
+				const float fx = posX - floorX - 0.5f;
+				const int srcX = std::min((int)floorX, (int)srcWidth - 1);
+
+				const float4 e = source.Texel(srcX, srcY);
+				float4 res = e;
+
+				const std::array<uint8_t, 4>& info = cornerInfos[(size_t)srcY * srcWidth + srcX];
+				if (info[0] | info[1] | info[2] | info[3]) {
+					// B D F H
+					const float4 neighbors[4] = {
+						source.Texel(srcX, srcY - 1),
+						source.Texel(srcX - 1, srcY),
+						source.Texel(srcX + 1, srcY),
+						source.Texel(srcX, srcY + 1)
+					};
+
+					for (const XbrzFreescaleCorner& corner : FREESCALE_CORNERS) {
+						const uint8_t cornerInfo = info[corner.cornerIdx];
+						if ((cornerInfo & XBRZ_CORNER_BLEND_MASK) == XBRZ_BLEND_NONE) {
+							continue;
+						}
+
+						XbrzFloat2 origin = corner.origin;
+						XbrzFloat2 direction = corner.direction;
+						if (cornerInfo & XBRZ_CORNER_LINE_BLEND) {
+							if (cornerInfo & XBRZ_CORNER_SHALLOW_LINE) {
+								origin = corner.shallowLineOrigin;
+								direction.x += corner.shallowDelta.x;
+								direction.y += corner.shallowDelta.y;
+							} else {
+								origin = corner.lineOrigin;
+							}
+
+							if (cornerInfo & XBRZ_CORNER_STEEP_LINE) {
+								direction.x += corner.steepDelta.x;
+								direction.y += corner.steepDelta.y;
+							}
+						}
+
+						const float4 preferredPix = neighbors[corner.preferredPix];
+						const float4 otherPix = neighbors[corner.otherPix];
+						const float4 blendPix =
+							DistYCbCr(e, preferredPix) <= DistYCbCr(e, otherPix) ? preferredPix : otherPix;
+						res = Lerp(res, blendPix, GetLeftRatio(fx, fy, origin, direction, outputScaleX, outputScaleY));
+					}
+				}
+
+				destRow[x] = WithAlpha(res, 1.0f);
+			}
+		}
+	});
+
+	return true;
+}
+
+}
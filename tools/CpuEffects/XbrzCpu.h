@@ -0,0 +1,32 @@
+#pragma once
+#include "Float4.h"
+#include <span>
+
+namespace Magpie {
+
+// xBRZ 系列效果的 CPU 实现，复现 xBRZ/xBRZ_2x.hlsl 到 xBRZ_6x.hlsl 以及 xBRZ_Freescale.hlsl。
+// 着色器为每个输出像素重新计算四个角的混合类型，这里对每个 2x2 像素块只计算一次，
+// 再由相邻的四个块推导出每个源像素的混合类型。输出的 Alpha 通道始终为 1。
+// 支持 AVX2 时每次处理一行中相邻的 8 个像素，结果和可移植的实现完全相同。
+struct XbrzCpu {
+	// scale 为 2 到 6，输出尺寸为输入的 scale 倍
+	static bool Scale(
+		uint32_t scale,
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest
+	) noexcept;
+
+	// xBRZ_Freescale.hlsl，支持任意输出尺寸
+	static bool ScaleFree(
+		std::span<const float4> src,
+		uint32_t srcWidth,
+		uint32_t srcHeight,
+		std::span<float4> dest,
+		uint32_t destWidth,
+		uint32_t destHeight
+	) noexcept;
+};
+
+}
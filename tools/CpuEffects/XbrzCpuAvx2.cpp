@@ -0,0 +1,452 @@
+#include "XbrzCpuKernels.h"
+
+// 其他平台上 CpuFeatures::IsAvx2Enabled 始终返回 false，不会调用这里的函数
+#if defined(_M_X64) || defined(__x86_64__)
+#include "Avx2Helper.h"
+#include <cstring>
+
+namespace Magpie {
+
+using namespace Avx2Helper;
+
+static Color8 LoadTexel(const XbrzSourceRow& source, int offsetX, int offsetY) noexcept {
+	return Load8(source.texel + ((ptrdiff_t)offsetY * (ptrdiff_t)source.texelStride + offsetX) * 4);
+}
+
+static __m256 LoadKey(const XbrzSourceRow& source, int offsetX, int offsetY) noexcept {
+	return _mm256_loadu_ps(source.key + (ptrdiff_t)offsetY * (ptrdiff_t)source.keyStride + offsetX);
+}
+
+// 和 XbrzCpu.cpp 中的 DistYCbCr 相同
+static __m256 DistYCbCr(const Color8& pixA, const Color8& pixB) noexcept {
+	constexpr float SCALE_B = 0.5f / (1.0f - 0.0593f);
+	constexpr float SCALE_R = 0.5f / (1.0f - 0.2627f);
+
+	const __m256 diffR = Sub(pixA.r, pixB.r);
+	const __m256 diffG = Sub(pixA.g, pixB.g);
+	const __m256 diffB = Sub(pixA.b, pixB.b);
+	const __m256 y = Add(Add(Mul(diffR, Set(0.2627f)), Mul(diffG, Set(0.6780f))), Mul(diffB, Set(0.0593f)));
+	const __m256 cb = Mul(Set(SCALE_B), Sub(diffB, y));
+	const __m256 cr = Mul(Set(SCALE_R), Sub(diffR, y));
+	return _mm256_sqrt_ps(Add(Add(Mul(y, y), Mul(cb, cb)), Mul(cr, cr)));
+}
+
+static __m256 IsPixEqual(const Color8& pixA, const Color8& pixB) noexcept {
+	return Less(DistYCbCr(pixA, pixB), Set(XBRZ_EQUAL_COLOR_TOLERANCE));
+}
+
+// 和 XbrzSource::IsSame 相同，keys 为 nullptr 时直接比较颜色
+static __m256 IsSame(const Color8& pixA, const Color8& pixB, const __m256* keyA, const __m256* keyB) noexcept {
+	if (keyA) {
+		return Equal(*keyA, *keyB);
+	} else {
+		return And(And(Equal(pixA.r, pixB.r), Equal(pixA.g, pixB.g)), Equal(pixA.b, pixB.b));
+	}
+}
+
+static __m256i ToInt(__m256 mask) noexcept {
+	return _mm256_castps_si256(mask);
+}
+
+// mask 为 true 时为 value，否则为 0
+static __m256i MaskedValue(__m256 mask, int value) noexcept {
+	return _mm256_and_si256(ToInt(mask), _mm256_set1_epi32(value));
+}
+
+static __m256 IsNonZero(__m256i value) noexcept {
+	return Not(_mm256_castsi256_ps(_mm256_cmpeq_epi32(value, _mm256_setzero_si256())));
+}
+
+// 每个 32 位整数的低 8 位按 step 的间隔写入 dest
+static void StoreBytes(__m256i value, uint8_t* dest, size_t step) noexcept {
+	alignas(32) int32_t values[8];
+	_mm256_store_si256((__m256i*)values, value);
+	for (int i = 0; i < 8; ++i) {
+		dest[i * step] = (uint8_t)values[i];
+	}
+}
+
+// 每个像素的 4 个字节中的第 idx 个
+static __m256i ExtractByte(__m256i value, uint32_t idx) noexcept {
+	return _mm256_and_si256(_mm256_srlv_epi32(value, _mm256_set1_epi32(idx * 8)), _mm256_set1_epi32(0xFF));
+}
+
+void XbrzClassifyQuadsAvx2(const XbrzSourceRow& source, uint8_t* dest) noexcept {
+	// E F
+	// H I
+	Color8 texels[4][4];
+	auto texel = [&](int x, int y) -> const Color8& {
+		return texels[y + 1][x + 1];
+	};
+	for (int y = -1; y <= 2; ++y) {
+		for (int x = -1; x <= 2; ++x) {
+			// 四个角不需要
+			if ((x == -1 || x == 2) && (y == -1 || y == 2)) {
+				continue;
+			}
+			texels[y + 1][x + 1] = LoadTexel(source, x, y);
+		}
+	}
+
+	__m256 keys[2][2];
+	if (source.key) {
+		for (int y = 0; y < 2; ++y) {
+			for (int x = 0; x < 2; ++x) {
+				keys[y][x] = LoadKey(source, x, y);
+			}
+		}
+	}
+	auto isSame = [&](int x0, int y0, int x1, int y1) {
+		return IsSame(texel(x0, y0), texel(x1, y1),
+			source.key ? &keys[y0][x0] : nullptr, source.key ? &keys[y1][x1] : nullptr);
+	};
+
+	const __m256 noBlend = Or(
+		And(isSame(0, 0, 1, 0), isSame(0, 1, 1, 1)),
+		And(isSame(0, 0, 0, 1), isSame(1, 0, 1, 1))
+	);
+
+	auto dist = [&](int x0, int y0, int x1, int y1) {
+		return DistYCbCr(texel(x0, y0), texel(x1, y1));
+	};
+
+	const __m256 four = Set(4.0f);
+	const __m256 distHF = Add(Add(Add(Add(dist(-1, 1, 0, 0), dist(0, 0, 1, -1)), dist(0, 2, 1, 1)),
+		dist(1, 1, 2, 0)), Mul(four, dist(0, 1, 1, 0)));
+	const __m256 distEI = Add(Add(Add(Add(dist(-1, 0, 0, 1), dist(0, 1, 1, 2)), dist(0, -1, 1, 0)),
+		dist(1, 0, 2, 1)), Mul(four, dist(0, 0, 1, 1)));
+
+	const __m256 threshold = Set(XBRZ_DOMINANT_DIRECTION_THRESHOLD);
+	const __m256 blendEI = Less(distHF, distEI);
+	const __m256 blendFH = Greater(distHF, distEI);
+	const __m256 dominantEI = And(blendEI, Less(Mul(threshold, distHF), distEI));
+	const __m256 dominantFH = And(blendFH, Less(Mul(threshold, distEI), distHF));
+
+	__m256i result = _mm256_or_si256(
+		_mm256_or_si256(MaskedValue(blendEI, XBRZ_QUAD_BLEND_EI), MaskedValue(blendFH, XBRZ_QUAD_BLEND_FH)),
+		MaskedValue(Or(dominantEI, dominantFH), XBRZ_QUAD_DOMINANT)
+	);
+	result = _mm256_andnot_si256(ToInt(noBlend), result);
+	StoreBytes(result, dest, 1);
+}
+
+namespace {
+
+// 8 个像素的 3x3 邻域，顺序和 XBRZ_KERNEL_OFFSETS 相同
+struct Kernel8 {
+	Color8 texels[9];
+	__m256 keys[9];
+	bool hasKeys;
+
+	Kernel8(const XbrzSourceRow& source) noexcept : hasKeys(source.key != nullptr) {
+		for (int i = 0; i < 9; ++i) {
+			texels[i] = LoadTexel(source, XBRZ_KERNEL_OFFSETS[i][0], XBRZ_KERNEL_OFFSETS[i][1]);
+			if (hasKeys) {
+				keys[i] = LoadKey(source, XBRZ_KERNEL_OFFSETS[i][0], XBRZ_KERNEL_OFFSETS[i][1]);
+			}
+		}
+	}
+
+	__m256 IsSame(int i, int j) const noexcept {
+		return Magpie::IsSame(texels[i], texels[j], hasKeys ? &keys[i] : nullptr, hasKeys ? &keys[j] : nullptr);
+	}
+};
+
+}
+
+static __m256i LoadQuads(const uint8_t* quads) noexcept {
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)quads));
+}
+
+// 和 XbrzCpu.cpp 中的 GetBlendResult 相同
+static void GetBlendResult(const Kernel8& kernel, const uint8_t* quads, size_t quadStride, __m256i(&result)[4]) noexcept {
+	const __m256i topQuads[2] = { LoadQuads(quads), LoadQuads(quads + 1) };
+	const __m256i bottomQuads[2] = { LoadQuads(quads + quadStride), LoadQuads(quads + quadStride + 1) };
+
+	auto blendType = [](__m256i quad, uint8_t flag, __m256 condition) {
+		const __m256 hasFlag = IsNonZero(_mm256_and_si256(quad, _mm256_set1_epi32(flag)));
+		const __m256 isDominant = IsNonZero(_mm256_and_si256(quad, _mm256_set1_epi32(XBRZ_QUAD_DOMINANT)));
+		const __m256 mask = And(hasFlag, condition);
+		return _mm256_or_si256(MaskedValue(And(mask, isDominant), XBRZ_BLEND_DOMINANT),
+			MaskedValue(_mm256_andnot_ps(isDominant, mask), XBRZ_BLEND_NORMAL));
+	};
+
+	// 中心和右、下、左、上的像素是否相同
+	const __m256 notSameRight = Not(kernel.IsSame(0, 1));
+	const __m256 notSameDown = Not(kernel.IsSame(0, 3));
+	const __m256 notSameLeft = Not(kernel.IsSame(0, 5));
+	const __m256 notSameUp = Not(kernel.IsSame(0, 7));
+
+	result[0] = blendType(topQuads[0], XBRZ_QUAD_BLEND_EI, And(notSameLeft, notSameUp));
+	result[1] = blendType(topQuads[1], XBRZ_QUAD_BLEND_FH, And(notSameUp, notSameRight));
+	result[2] = blendType(bottomQuads[1], XBRZ_QUAD_BLEND_EI, And(notSameRight, notSameDown));
+	result[3] = blendType(bottomQuads[0], XBRZ_QUAD_BLEND_FH, And(notSameLeft, notSameDown));
+}
+
+void XbrzAnalyzeCornersAvx2(
+	const XbrzSourceRow& source,
+	const uint8_t* quads,
+	size_t quadStride,
+	uint8_t* cornerInfos
+) noexcept {
+	const Kernel8 kernel(source);
+
+	__m256i blend[4];
+	GetBlendResult(kernel, quads, quadStride, blend);
+
+	// 和 XbrzCpu.cpp 中的 AnalyzeCorner 相同，依次处理旋转后的右下角
+	for (int rotation = 0; rotation < 4; ++rotation) {
+		const uint32_t cornerIdx = (2 - rotation) & 3;
+		const __m256i cornerBlend = blend[cornerIdx];
+		const __m256 needBlend = IsNonZero(cornerBlend);
+		if (!Any(needBlend)) {
+			StoreBytes(cornerBlend, cornerInfos + cornerIdx, 4);
+			continue;
+		}
+
+		int idx[9];
+		for (int i = 0; i < 9; ++i) {
+			idx[i] = XbrzRotateKernelIndex(i, rotation);
+		}
+
+		auto k = [&](int i) -> const Color8& {
+			return kernel.texels[idx[i]];
+		};
+		auto eq = [&](int i, int j) {
+			return IsPixEqual(k(i), k(j));
+		};
+		auto isSame = [&](int i, int j) {
+			return kernel.IsSame(idx[i], idx[j]);
+		};
+
+		const __m256 blend1 = IsNonZero(blend[(1 - rotation) & 3]);
+		const __m256 blend3 = IsNonZero(blend[(3 - rotation) & 3]);
+		const __m256 blend2Dominant = _mm256_castsi256_ps(
+			_mm256_cmpgt_epi32(cornerBlend, _mm256_set1_epi32(XBRZ_BLEND_DOMINANT - 1)));
+
+		const __m256 doLineBlend = Or(blend2Dominant, Not(Or(Or(
+			And(blend1, Not(eq(0, 4))),
+			And(blend3, Not(eq(0, 8)))),
+			And(And(And(eq(4, 3), eq(3, 2)), And(eq(2, 1), eq(1, 8))), Not(eq(0, 2)))
+		)));
+
+		const __m256 dist14 = DistYCbCr(k(1), k(4));
+		const __m256 dist38 = DistYCbCr(k(3), k(8));
+		const __m256 threshold = Set(XBRZ_STEEP_DIRECTION_THRESHOLD);
+		const __m256 haveShallowLine = And(LessEqual(Mul(threshold, dist14), dist38),
+			Not(Or(isSame(0, 4), isSame(5, 4))));
+		const __m256 haveSteepLine = And(LessEqual(Mul(threshold, dist38), dist14),
+			Not(Or(isSame(0, 8), isSame(7, 8))));
+
+		const __m256 lineBlend = And(needBlend, doLineBlend);
+		const __m256i info = _mm256_or_si256(_mm256_or_si256(cornerBlend, MaskedValue(lineBlend, XBRZ_CORNER_LINE_BLEND)),
+			_mm256_or_si256(MaskedValue(And(lineBlend, haveShallowLine), XBRZ_CORNER_SHALLOW_LINE),
+				MaskedValue(And(lineBlend, haveSteepLine), XBRZ_CORNER_STEEP_LINE)));
+		StoreBytes(info, cornerInfos + cornerIdx, 4);
+	}
+}
+
+void XbrzBlendAvx2(
+	const XbrzSourceRow& source,
+	const uint8_t* cornerInfos,
+	const XbrzBlendOp* ops,
+	size_t opCount,
+	uint32_t scale,
+	float* dest,
+	size_t destStride
+) noexcept {
+	Color8 kernel[9];
+	for (int i = 0; i < 9; ++i) {
+		kernel[i] = LoadTexel(source, XBRZ_KERNEL_OFFSETS[i][0], XBRZ_KERNEL_OFFSETS[i][1]);
+	}
+
+	// 最大为 6 倍
+	Color8 block[6][6];
+	for (uint32_t row = 0; row < scale; ++row) {
+		for (uint32_t col = 0; col < scale; ++col) {
+			block[row][col] = kernel[0];
+		}
+	}
+
+	const __m256i infos = _mm256_loadu_si256((const __m256i*)cornerInfos);
+
+	// 和 XbrzCpu.cpp 中的 Scale 相同，依次混合右下、右上、左上和左下角
+	for (int rotation = 0; rotation < 4; ++rotation) {
+		const __m256i info = ExtractByte(infos, (2 - rotation) & 3);
+		const __m256 needBlend = IsNonZero(_mm256_and_si256(info, _mm256_set1_epi32(XBRZ_CORNER_BLEND_MASK)));
+		if (!Any(needBlend)) {
+			continue;
+		}
+
+		const Color8& k0 = kernel[0];
+		const Color8& k1 = kernel[XbrzRotateKernelIndex(1, rotation)];
+		const Color8& k3 = kernel[XbrzRotateKernelIndex(3, rotation)];
+		const __m256 useK1 = LessEqual(DistYCbCr(k0, k1), DistYCbCr(k0, k3));
+		const Color8 blendPix{
+			Select(useK1, k1.r, k3.r), Select(useK1, k1.g, k3.g), Select(useK1, k1.b, k3.b), Select(useK1, k1.a, k3.a)
+		};
+
+		// 不混合线条时为 0，否则为 1 + haveShallowLine + 2 * haveSteepLine
+		const __m256 doLineBlend = IsNonZero(_mm256_and_si256(info, _mm256_set1_epi32(XBRZ_CORNER_LINE_BLEND)));
+		const __m256i lineIdx = _mm256_add_epi32(_mm256_set1_epi32(1), _mm256_add_epi32(
+			_mm256_and_si256(_mm256_srli_epi32(info, 3), _mm256_set1_epi32(1)),
+			_mm256_and_si256(_mm256_srli_epi32(info, 3), _mm256_set1_epi32(2))));
+		const __m256i weightIdx = _mm256_and_si256(ToInt(doLineBlend), lineIdx);
+
+		for (size_t i = 0; i < opCount; ++i) {
+			const XbrzBlendOp& op = ops[i];
+			const __m256 weight = _mm256_i32gather_ps(op.weights, weightIdx, 4);
+			// 权重为 0 表示不修改
+			const __m256 mask = And(needBlend, NotEqual(weight, _mm256_setzero_ps()));
+			if (!Any(mask)) {
+				continue;
+			}
+
+			uint32_t row = op.row;
+			uint32_t col = op.col;
+			for (int j = 0; j < rotation; ++j) {
+				const uint32_t t = row;
+				row = scale - 1 - col;
+				col = t;
+			}
+
+			Color8& target = block[row][col];
+			target.r = Select(mask, Lerp(target.r, blendPix.r, weight), target.r);
+			target.g = Select(mask, Lerp(target.g, blendPix.g, weight), target.g);
+			target.b = Select(mask, Lerp(target.b, blendPix.b, weight), target.b);
+		}
+	}
+
+	// 每个像素的输出块为 scale x scale 个像素，相邻的像素的输出块在水平方向相邻
+	const __m256 one = Set(1.0f);
+	alignas(32) float pixels[6][8 * 4];
+	for (uint32_t row = 0; row < scale; ++row) {
+		for (uint32_t col = 0; col < scale; ++col) {
+			block[row][col].a = one;
+			Store8(block[row][col], pixels[col]);
+		}
+
+		float* destRow = dest + row * destStride * 4;
+		for (uint32_t i = 0; i < 8; ++i) {
+			for (uint32_t col = 0; col < scale; ++col) {
+				std::memcpy(destRow + (i * scale + col) * 4, pixels[col] + i * 4, 4 * sizeof(float));
+			}
+		}
+	}
+}
+
+// 和 XbrzCpu.cpp 中的 GetLeftRatio 相同
+static __m256 GetLeftRatio(
+	__m256 centerX,
+	__m256 centerY,
+	__m256 originX,
+	__m256 originY,
+	__m256 directionX,
+	__m256 directionY,
+	__m256 scaleX,
+	__m256 scaleY
+) noexcept {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = Set(1.0f);
+
+	const __m256 p0X = Sub(centerX, originX);
+	const __m256 p0Y = Sub(centerY, originY);
+	const __m256 t = Div(Add(Mul(p0X, directionX), Mul(p0Y, directionY)),
+		Add(Mul(directionX, directionX), Mul(directionY, directionY)));
+	const __m256 distX = Mul(Sub(p0X, Mul(directionX, t)), scaleX);
+	const __m256 distY = Mul(Sub(p0Y, Mul(directionY, t)), scaleY);
+
+	const __m256 orth = Add(Mul(p0X, Neg(directionY)), Mul(p0Y, directionX));
+	const __m256 side = Select(Greater(orth, zero), one, Select(Less(orth, zero), Set(-1.0f), zero));
+	const __m256 v = Mul(side, _mm256_sqrt_ps(Add(Mul(distX, distX), Mul(distY, distY))));
+
+	// 和 std::clamp 相同，NaN 保持不变
+	__m256 s = Div(Add(v, Set(XBRZ_RCP_SQRT2)), Set(2.0f * XBRZ_RCP_SQRT2));
+	s = Select(Less(s, zero), zero, Select(Less(one, s), one, s));
+	return Mul(Mul(s, s), Sub(Set(3.0f), Mul(Set(2.0f), s)));
+}
+
+void XbrzFreescaleAvx2(const XbrzFreescaleBatch& batch, float* dest) noexcept {
+	const __m256i srcX = _mm256_loadu_si256((const __m256i*)batch.srcX);
+	const __m256i infos = _mm256_i32gather_epi32((const int*)batch.cornerInfoRow, srcX, 4);
+
+	auto loadTexels = [&](int offsetX, int offsetY) {
+		const float* row = batch.texelRow + (ptrdiff_t)offsetY * (ptrdiff_t)batch.texelStride * 4;
+		const float* pixels[8];
+		for (int i = 0; i < 8; ++i) {
+			pixels[i] = row + (ptrdiff_t)(batch.srcX[i] + offsetX) * 4;
+		}
+		return Load8(pixels);
+	};
+
+	const Color8 e = loadTexels(0, 0);
+	Color8 res = e;
+
+	if (Any(IsNonZero(infos))) {
+		// B D F H
+		const Color8 neighbors[4] = { loadTexels(0, -1), loadTexels(-1, 0), loadTexels(1, 0), loadTexels(0, 1) };
+
+		const __m256 fx = _mm256_loadu_ps(batch.fx);
+		const __m256 fy = Set(batch.fy);
+		const __m256 scaleX = Set(batch.scaleX);
+		const __m256 scaleY = Set(batch.scaleY);
+
+		for (int c = 0; c < 4; ++c) {
+			const XbrzFreescaleCorner& corner = batch.corners[c];
+			const __m256i info = ExtractByte(infos, corner.cornerIdx);
+			const __m256 needBlend = IsNonZero(_mm256_and_si256(info, _mm256_set1_epi32(XBRZ_CORNER_BLEND_MASK)));
+			if (!Any(needBlend)) {
+				continue;
+			}
+
+			const __m256 lineBlend = IsNonZero(_mm256_and_si256(info, _mm256_set1_epi32(XBRZ_CORNER_LINE_BLEND)));
+			const __m256 shallowLine = And(lineBlend,
+				IsNonZero(_mm256_and_si256(info, _mm256_set1_epi32(XBRZ_CORNER_SHALLOW_LINE))));
+			const __m256 steepLine = And(lineBlend,
+				IsNonZero(_mm256_and_si256(info, _mm256_set1_epi32(XBRZ_CORNER_STEEP_LINE))));
+
+			const __m256 originX = Select(lineBlend,
+				Select(shallowLine, Set(corner.shallowLineOrigin.x), Set(corner.lineOrigin.x)), Set(corner.origin.x));
+			const __m256 originY = Select(lineBlend,
+				Select(shallowLine, Set(corner.shallowLineOrigin.y), Set(corner.lineOrigin.y)), Set(corner.origin.y));
+
+			__m256 directionX = Set(corner.direction.x);
+			__m256 directionY = Set(corner.direction.y);
+			directionX = Select(shallowLine, Add(directionX, Set(corner.shallowDelta.x)), directionX);
+			directionY = Select(shallowLine, Add(directionY, Set(corner.shallowDelta.y)), directionY);
+			directionX = Select(steepLine, Add(directionX, Set(corner.steepDelta.x)), directionX);
+			directionY = Select(steepLine, Add(directionY, Set(corner.steepDelta.y)), directionY);
+
+			const Color8& preferredPix = neighbors[corner.preferredPix];
+			const Color8& otherPix = neighbors[corner.otherPix];
+			const __m256 usePreferred = LessEqual(DistYCbCr(e, preferredPix), DistYCbCr(e, otherPix));
+
+			const __m256 ratio = GetLeftRatio(fx, fy, originX, originY, directionX, directionY, scaleX, scaleY);
+			res.r = Select(needBlend, Lerp(res.r, Select(usePreferred, preferredPix.r, otherPix.r), ratio), res.r);
+			res.g = Select(needBlend, Lerp(res.g, Select(usePreferred, preferredPix.g, otherPix.g), ratio), res.g);
+			res.b = Select(needBlend, Lerp(res.b, Select(usePreferred, preferredPix.b, otherPix.b), ratio), res.b);
+		}
+	}
+
+	// 输出的 Alpha 通道始终为 1
+	res.a = Set(1.0f);
+	Store8(res, dest);
+}
+
+}
+
+#else
+
+namespace Magpie {
+
+void XbrzClassifyQuadsAvx2(const XbrzSourceRow&, uint8_t*) noexcept {}
+
+void XbrzAnalyzeCornersAvx2(const XbrzSourceRow&, const uint8_t*, size_t, uint8_t*) noexcept {}
+
+void XbrzBlendAvx2(const XbrzSourceRow&, const uint8_t*, const XbrzBlendOp*, size_t, uint32_t, float*, size_t) noexcept {}
+
+void XbrzFreescaleAvx2(const XbrzFreescaleBatch&, float*) noexcept {}
+
+}
+
+#endif
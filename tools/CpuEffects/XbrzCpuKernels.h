@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Magpie {
+
+// XbrzCpu 的 AVX2 核，每次处理一行中相邻的 8 个像素，每个寄存器保存 8 个像素的同一个分量。乘法和加法
+// 不合并为 FMA，分支改为逐像素选择，结果和可移植的实现完全相同。图像以 float4 为单位。
+
+inline constexpr uint8_t XBRZ_BLEND_NONE = 0;
+inline constexpr uint8_t XBRZ_BLEND_NORMAL = 1;
+inline constexpr uint8_t XBRZ_BLEND_DOMINANT = 2;
+
+inline constexpr float XBRZ_EQUAL_COLOR_TOLERANCE = 30.0f / 255.0f;
+inline constexpr float XBRZ_STEEP_DIRECTION_THRESHOLD = 2.2f;
+inline constexpr float XBRZ_DOMINANT_DIRECTION_THRESHOLD = 3.6f;
+
+// 2x2 像素块 E F / H I 的分类结果。F-H 更接近时 E 和 I 需要混合，反之 F 和 H 需要混合
+inline constexpr uint8_t XBRZ_QUAD_BLEND_EI = 1;
+inline constexpr uint8_t XBRZ_QUAD_BLEND_FH = 2;
+inline constexpr uint8_t XBRZ_QUAD_DOMINANT = 4;
+
+// 每个角的混合类型和线条信息，和 Freescale 着色器中 tex1 保存的内容相同
+inline constexpr uint8_t XBRZ_CORNER_BLEND_MASK = 3;
+inline constexpr uint8_t XBRZ_CORNER_LINE_BLEND = 4;
+inline constexpr uint8_t XBRZ_CORNER_SHALLOW_LINE = 8;
+inline constexpr uint8_t XBRZ_CORNER_STEEP_LINE = 16;
+
+// 3x3 邻域的偏移，和着色器中 src[0] 到 src[8] 的顺序相同：中心、右、右下、下、左下、左、左上、上、右上
+inline constexpr int XBRZ_KERNEL_OFFSETS[9][2] = {
+	{ 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+};
+
+// 旋转 rotation 次后 k[i] 对应的邻域索引。每次逆时针旋转 90°，即 rotation 为 1 时处理右上角
+inline int XbrzRotateKernelIndex(int i, int rotation) noexcept {
+	return i == 0 ? 0 : 1 + (i - 1 + 6 * rotation) % 8;
+}
+
+// 混合一个角时对输出块中一个像素的操作，row 和 col 为混合右下角时的位置，其他角旋转得到。
+// 不混合线条时使用 weights[0]，否则使用 weights[1 + haveShallowLine + 2 * haveSteepLine]。
+// 权重取自着色器，为 0 表示不修改
+struct XbrzBlendOp {
+	uint8_t row;
+	uint8_t col;
+	float weights[5];
+};
+
+// 源图像中一行相邻的 8 个像素。texel 指向第一个像素，四周至少有 3 个可读取的像素。key 为着色器中
+// reduce 的结果，四周至少有 1 个可读取的像素，为 nullptr 时直接比较颜色。stride 均为每行的像素数
+struct XbrzSourceRow {
+	const float* texel;
+	size_t texelStride;
+	const float* key;
+	size_t keyStride;
+};
+
+// 以这 8 个像素为左上角的 2x2 像素块的分类，结果为 XBRZ_QUAD_* 的组合
+void XbrzClassifyQuadsAvx2(const XbrzSourceRow& source, uint8_t* dest) noexcept;
+
+// 这 8 个像素的四个角的信息，按左上、右上、右下、左下排列，每个像素 4 个字节。quads 为第一个像素
+// 左上方的像素块，quadStride 为每行的像素块数
+void XbrzAnalyzeCornersAvx2(
+	const XbrzSourceRow& source,
+	const uint8_t* quads,
+	size_t quadStride,
+	uint8_t* cornerInfos
+) noexcept;
+
+// 由 XbrzAnalyzeCornersAvx2 的结果输出这 8 个像素的 scale x scale 个像素。dest 为第一个像素的输出块的
+// 左上角，destStride 为输出的每行的像素数
+void XbrzBlendAvx2(
+	const XbrzSourceRow& source,
+	const uint8_t* cornerInfos,
+	const XbrzBlendOp* ops,
+	size_t opCount,
+	uint32_t scale,
+	float* dest,
+	size_t destStride
+) noexcept;
+
+inline constexpr float XBRZ_RCP_SQRT2 = 0.70710678f;
+
+struct XbrzFloat2 {
+	float x;
+	float y;
+};
+
+// Freescale 第二个通道中一个角的参数，按着色器中的处理顺序排列
+struct XbrzFreescaleCorner {
+	// 在角的信息中的索引
+	uint32_t cornerIdx;
+	XbrzFloat2 origin;
+	XbrzFloat2 lineOrigin;
+	XbrzFloat2 shallowLineOrigin;
+	XbrzFloat2 direction;
+	// 存在平缓或陡峭的线条时 direction 的变化
+	XbrzFloat2 shallowDelta;
+	XbrzFloat2 steepDelta;
+	// 混合的像素在 B D F H 中的索引，距离相同时使用 preferredPix
+	uint32_t preferredPix;
+	uint32_t otherPix;
+};
+
+// Freescale 第二个通道中同一行的 8 个输出像素需要的数据。srcX 和 fx 指向每个输出列一项的表，
+// 已偏移到这 8 个像素中的第一个
+struct XbrzFreescaleBatch {
+	// 4 个角，顺序和着色器相同
+	const XbrzFreescaleCorner* corners;
+	// 源图像中这一行的第 0 个像素，四周至少有 1 个可读取的像素
+	const float* texelRow;
+	size_t texelStride;
+	// 每个源像素 4 个字节的角的信息
+	const uint8_t* cornerInfoRow;
+	const int32_t* srcX;
+	const float* fx;
+	float fy;
+	// 和着色器中的 GetScale() 相同
+	float scaleX;
+	float scaleY;
+};
+
+void XbrzFreescaleAvx2(const XbrzFreescaleBatch& batch, float* dest) noexcept;
+
+}
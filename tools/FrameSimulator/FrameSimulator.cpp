@@ -0,0 +1,569 @@
+// FrameSimulator.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 用离散事件模拟缩放后端的主循环，回放录制的帧轨迹（.mpft）或合成的帧序列，评估 StepTimer 和
+// 重复帧检测的策略。使用的 StepTimerPolicy 和 DuplicateFramePolicy 和 Magpie 中的完全相同。
+// 不依赖 Windows，可在 Linux 上用 g++ 或 clang++ 编译，见 README.md。
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "StepTimerPolicy.h"
+#include "DuplicateFramePolicy.h"
+
+using namespace std::chrono;
+using namespace Magpie;
+
+// 和 FrameSourceWaitType 对应
+enum class SourceType {
+	// GDI、DwmSharedSurface：每次更新都捕获一帧，帧率限制为屏幕刷新率
+	NoWait,
+	// GraphicsCapture：新帧到达时有消息
+	WaitForMessage,
+	// DesktopDuplication：每次更新最多等待 1ms
+	WaitForFrame
+};
+
+// 和 DuplicateFrameDetectionMode 对应
+enum class DetectionMode {
+	Always,
+	Dynamic,
+	Never
+};
+
+struct Arrival {
+	nanoseconds time;
+	// 内容的序号，重复帧和上一帧相同
+	uint32_t content;
+};
+
+struct Trace {
+	std::string name;
+	std::vector<Arrival> arrivals;
+	SourceType source = SourceType::WaitForMessage;
+	DetectionMode detection = DetectionMode::Dynamic;
+	float minFrameRate = 0.0f;
+	std::optional<float> maxFrameRate;
+	// 录制时检查一帧的平均用时，为 0 表示未知
+	nanoseconds checkTime{};
+};
+
+struct Config {
+	std::optional<SourceType> source;
+	std::optional<DetectionMode> detection;
+	std::optional<float> minFrameRate;
+	// 0 表示不限制
+	std::optional<float> maxFrameRate;
+	std::optional<nanoseconds> checkTime;
+	nanoseconds renderTime = microseconds(3000);
+	nanoseconds refreshPeriod = nanoseconds(1'000'000'000 / 60);
+	bool pacing = false;
+	bool csv = false;
+};
+
+struct Result {
+	uint32_t renders = 0;
+	// 重复渲染同一内容的次数，来自强制帧或未检测出的重复帧
+	uint32_t wastedRenders = 0;
+	// 从未被渲染的内容数
+	uint32_t missedFrames = 0;
+	uint32_t checks = 0;
+	nanoseconds duration{};
+	// 每个被渲染的内容从到达到显示的用时
+	std::vector<nanoseconds> latencies;
+	// 每次渲染从捕获到显示的用时。低延迟帧调度缩短的是这个时长，只有推迟捕获期间有更新的帧到达时
+	// 从到达到显示的用时才会缩短
+	std::vector<nanoseconds> captureLatencies;
+};
+
+// 文件格式见 Magpie.Core/FrameTraceFormat.h
+static bool LoadTrace(const char* fileName, Trace& trace) {
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file) {
+		std::fprintf(stderr, "无法打开 %s\n", fileName);
+		return false;
+	}
+
+	const std::vector<uint8_t> data(
+		(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	FrameTraceHeader header;
+	if (!FrameTraceFormat::ReadHeader(data.data(), data.size(), header)) {
+		std::fprintf(stderr, "%s 不是有效的帧轨迹文件\n", fileName);
+		return false;
+	}
+
+	trace.name = fileName;
+	switch (header.captureMethod) {
+	case 0:
+		trace.source = SourceType::WaitForMessage;
+		break;
+	case 1:
+		trace.source = SourceType::WaitForFrame;
+		break;
+	default:
+		trace.source = SourceType::NoWait;
+		break;
+	}
+	trace.detection = (DetectionMode)std::min(header.duplicateFrameDetectionMode, 2u);
+	trace.minFrameRate = header.minFrameRate;
+	if (header.maxFrameRate > 0) {
+		trace.maxFrameRate = header.maxFrameRate;
+	}
+
+	uint64_t totalCheckTime = 0;
+	uint32_t checkCount = 0;
+	uint32_t content = 0;
+
+	const size_t recordCount = FrameTraceFormat::GetRecordCount(data.size());
+	trace.arrivals.reserve(recordCount);
+	for (size_t i = 0; i < recordCount; ++i) {
+		FrameTraceRecord record;
+		FrameTraceFormat::ReadRecord(
+			data.data() + FrameTraceFormat::HEADER_SIZE + i * FrameTraceFormat::RECORD_SIZE, record);
+
+		// 未检查的帧无法确定是否重复，以录制时的预测为准
+		const bool isNew = record.decision == FrameTraceDecision::New ||
+			record.decision == FrameTraceDecision::NotChecked ||
+			record.decision == FrameTraceDecision::MispredictedDuplicate;
+		if (isNew && !trace.arrivals.empty()) {
+			++content;
+		}
+		trace.arrivals.push_back({ nanoseconds(record.arrivalTime), content });
+
+		if (record.checkDuration > 0) {
+			totalCheckTime += record.checkDuration;
+			++checkCount;
+		}
+	}
+
+	if (checkCount > 0) {
+		trace.checkTime = microseconds(totalCheckTime / checkCount);
+	}
+
+	return true;
+}
+
+// 格式为 synthetic:source=60,content=24,seconds=10,jitter=1,seed=1。source 为捕获帧率，content 为
+// 内容的帧率，jitter 为到达时间的标准差（毫秒）
+static bool GenerateTrace(std::string_view spec, Trace& trace) {
+	double sourceFps = 60;
+	double contentFps = 0;
+	double seconds = 10;
+	double jitterMs = 0;
+	uint32_t seed = 1;
+
+	spec.remove_prefix(std::strlen("synthetic:"));
+	while (!spec.empty()) {
+		const size_t end = std::min(spec.find(','), spec.size());
+		const std::string_view item = spec.substr(0, end);
+		spec.remove_prefix(std::min(end + 1, spec.size()));
+
+		const size_t eq = item.find('=');
+		if (eq == std::string_view::npos) {
+			std::fprintf(stderr, "非法参数: %.*s\n", (int)item.size(), item.data());
+			return false;
+		}
+
+		const std::string_view key = item.substr(0, eq);
+		const double value = std::atof(std::string(item.substr(eq + 1)).c_str());
+		if (key == "source") {
+			sourceFps = value;
+		} else if (key == "content") {
+			contentFps = value;
+		} else if (key == "seconds") {
+			seconds = value;
+		} else if (key == "jitter") {
+			jitterMs = value;
+		} else if (key == "seed") {
+			seed = (uint32_t)value;
+		} else {
+			std::fprintf(stderr, "未知的参数: %.*s\n", (int)key.size(), key.data());
+			return false;
+		}
+	}
+
+	if (sourceFps <= 0 || seconds <= 0) {
+		std::fprintf(stderr, "非法参数\n");
+		return false;
+	}
+	if (contentFps <= 0 || contentFps > sourceFps) {
+		contentFps = sourceFps;
+	}
+
+	std::mt19937 rng(seed);
+	std::normal_distribution<double> jitter(0.0, jitterMs * 1e6);
+
+	const uint32_t count = (uint32_t)std::llround(sourceFps * seconds);
+	const double interval = 1e9 / sourceFps;
+	nanoseconds lastTime{ -1 };
+	int64_t lastContentIdx = -1;
+	uint32_t content = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		double t = i * interval + (jitterMs > 0 ? jitter(rng) : 0);
+		// 保持到达顺序
+		nanoseconds time((int64_t)std::max(t, 0.0));
+		if (time <= lastTime) {
+			time = lastTime + nanoseconds(1);
+		}
+		lastTime = time;
+
+		// 内容按自己的帧率变化，和到达时间无关
+		const int64_t contentIdx = (int64_t)std::floor(i * contentFps / sourceFps + 1e-9);
+		if (lastContentIdx >= 0 && contentIdx != lastContentIdx) {
+			++content;
+		}
+		lastContentIdx = contentIdx;
+
+		trace.arrivals.push_back({ time, content });
+	}
+
+	return true;
+}
+
+// 模拟 Renderer::_BackendThreadProc 的主循环以及 StepTimer 和 FrameSourceBase 的等待
+class Simulator {
+public:
+	Simulator(const Trace& trace, const Config& config) : _trace(trace), _config(config) {
+		_source = config.source.value_or(trace.source);
+		_detection = config.detection.value_or(trace.detection);
+		_checkTime = config.checkTime.value_or(
+			trace.checkTime.count() > 0 ? trace.checkTime : microseconds(200));
+
+		// 和 Renderer 相同，NoWait 的捕获方式将帧率限制为屏幕刷新率
+		std::optional<float> maxFrameRate = trace.maxFrameRate;
+		if (config.maxFrameRate) {
+			maxFrameRate = *config.maxFrameRate > 0 ? config.maxFrameRate : std::nullopt;
+		}
+		if (_source == SourceType::NoWait) {
+			const float refreshRate = 1e9f / config.refreshPeriod.count();
+			if (!maxFrameRate || *maxFrameRate > refreshRate) {
+				maxFrameRate = refreshRate;
+			}
+		}
+
+		_policy.Initialize(config.minFrameRate.value_or(trace.minFrameRate), maxFrameRate, config.pacing);
+		_duplicateFramePolicy.Initialize(_detection == DetectionMode::Always, false);
+
+		_endTime = trace.arrivals.back().time + seconds(1);
+	}
+
+	Result Run() {
+		StepTimerStatus status = StepTimerStatus::WaitForNewFrame;
+		const bool waitMsgForNewFrame = _source == SourceType::WaitForMessage;
+
+		while (_now < _endTime) {
+			const bool waitMsg = waitMsgForNewFrame && status != StepTimerStatus::WaitForFPSLimiter;
+
+			if (_policy.IsCompositionTimingNeeded()) {
+				// 从 0 开始每个刷新间隔合成一次
+				_policy.Pacer().SetCompositionTiming(nanoseconds(0), _config.refreshPeriod);
+			}
+
+			const StepTimerPolicy::Decision decision = _policy.Decide(_now);
+			status = decision.status;
+
+			if (_result.renders == 0) {
+				if (waitMsg) {
+					_Wait(StepTimerPolicy::INFINITE_WAIT, true);
+				}
+			} else if (status == StepTimerStatus::WaitForFPSLimiter) {
+				_Wait(decision.waitTime, waitMsgForNewFrame);
+			} else if (status == StepTimerStatus::WaitForNewFrame && waitMsg) {
+				_Wait(decision.waitTime == StepTimerPolicy::INFINITE_WAIT
+					? milliseconds(500) : decision.waitTime, true);
+			}
+
+			// PeekMessage 取出所有消息
+			_peekedCount = _ArrivedCount();
+
+			if (status == StepTimerStatus::WaitForFPSLimiter) {
+				continue;
+			}
+
+			if (_Update() || status == StepTimerStatus::ForceNewFrame) {
+				_Render();
+			}
+		}
+
+		// 内容的序号是连续的，因此被渲染的内容数等于不重复的渲染次数
+		const uint32_t contentCount = _trace.arrivals.back().content + 1;
+		_result.missedFrames = contentCount - (_result.renders - _result.wastedRenders);
+		// 模拟在最后一帧到达后继续一段时间，但 FPS 只统计帧到达的时间段
+		_result.duration = std::max(_trace.arrivals.back().time - _trace.arrivals.front().time,
+			nanoseconds(_config.refreshPeriod));
+		return std::move(_result);
+	}
+
+private:
+	// 已到达的帧数
+	size_t _ArrivedCount() const {
+		return std::upper_bound(_trace.arrivals.begin(), _trace.arrivals.end(), _now,
+			[](nanoseconds now, const Arrival& arrival) { return now < arrival.time; }) - _trace.arrivals.begin();
+	}
+
+	nanoseconds _NextArrivalTime() const {
+		const size_t arrived = _ArrivedCount();
+		return arrived < _trace.arrivals.size() ? _trace.arrivals[arrived].time : _endTime;
+	}
+
+	// 等待 time 或直到新帧消息到达
+	void _Wait(nanoseconds time, bool wakeOnMessage) {
+		if (wakeOnMessage && _ArrivedCount() > _peekedCount) {
+			// 有未取出的消息
+			return;
+		}
+
+		nanoseconds deadline = time == StepTimerPolicy::INFINITE_WAIT ? _endTime : _now + time;
+		if (wakeOnMessage) {
+			deadline = std::min(deadline, _NextArrivalTime());
+		}
+		_now = std::min(deadline, _endTime);
+	}
+
+	// 和 FrameSourceBase::Update 对应，返回是否得到新帧
+	bool _Update() {
+		const size_t arrived = _ArrivedCount();
+
+		switch (_source) {
+		case SourceType::WaitForMessage:
+			if (arrived == 0 || arrived == _capturedCount) {
+				return _OnIdle();
+			}
+			break;
+		case SourceType::WaitForFrame:
+			if (arrived == 0 || arrived == _capturedCount) {
+				const nanoseconds next = _NextArrivalTime();
+				if (next > _now + milliseconds(1)) {
+					_now += milliseconds(1);
+					return _OnIdle();
+				}
+
+				_now = next;
+				if (_ArrivedCount() == arrived) {
+					return _OnIdle();
+				}
+			}
+			break;
+		case SourceType::NoWait:
+			if (arrived == 0) {
+				_now = _NextArrivalTime();
+				return false;
+			}
+			break;
+		}
+
+		_capturedCount = _ArrivedCount();
+		_capturedContent = _trace.arrivals[_capturedCount - 1].content;
+		_captureTime = _now;
+
+		if (_detection == DetectionMode::Never) {
+			return true;
+		}
+
+		if (!_hasPrevFrame) {
+			_hasPrevFrame = true;
+			_prevContent = _capturedContent;
+			return true;
+		}
+
+		FrameTraceDecision decision = FrameTraceDecision::NotChecked;
+		const bool isDuplicate = _duplicateFramePolicy.OnNewFrame(
+			_now,
+			[&]() { return _IsDuplicate(); },
+			[&]() { _prevContent = _capturedContent; },
+			decision
+		);
+		return !isDuplicate;
+	}
+
+	// 和 FrameSourceBase::_CheckForUncheckedFrame 对应
+	bool _OnIdle() {
+		if (!_hasPrevFrame) {
+			return false;
+		}
+
+		FrameTraceDecision decision = FrameTraceDecision::NotChecked;
+		return _duplicateFramePolicy.OnIdle(
+			_now,
+			[&]() { return _IsDuplicate(); },
+			[&]() { _prevContent = _capturedContent; },
+			decision
+		);
+	}
+
+	bool _IsDuplicate() {
+		_now += _checkTime;
+		++_result.checks;
+		return _capturedContent == _prevContent;
+	}
+
+	void _Render() {
+		_policy.OnRender();
+		_now += _config.renderTime;
+
+		// 渲染完成后的下一次合成时显示
+		const nanoseconds period = _config.refreshPeriod;
+		const nanoseconds displayTime = (_now + period - nanoseconds(1)) / period * period;
+		_result.captureLatencies.push_back(displayTime - _captureTime);
+
+		if (_result.renders > 0 && _capturedContent == _renderedContent) {
+			++_result.wastedRenders;
+		} else {
+			const auto firstArrival = std::lower_bound(_trace.arrivals.begin(), _trace.arrivals.end(),
+				_capturedContent, [](const Arrival& arrival, uint32_t content) { return arrival.content < content; });
+			_result.latencies.push_back(displayTime - firstArrival->time);
+		}
+
+		_renderedContent = _capturedContent;
+		++_result.renders;
+	}
+
+	const Trace& _trace;
+	const Config& _config;
+
+	SourceType _source;
+	DetectionMode _detection;
+	nanoseconds _checkTime;
+
+	StepTimerPolicy _policy;
+	DuplicateFramePolicy _duplicateFramePolicy;
+
+	nanoseconds _now{};
+	nanoseconds _endTime{};
+
+	// 上一次取出消息时已到达的帧数
+	size_t _peekedCount = 0;
+	size_t _capturedCount = 0;
+	uint32_t _capturedContent = 0;
+	nanoseconds _captureTime{};
+	uint32_t _prevContent = 0;
+	bool _hasPrevFrame = false;
+	uint32_t _renderedContent = 0;
+
+	Result _result;
+};
+
+// 返回平均值和 95 分位值，单位为毫秒
+static std::pair<double, double> Summarize(std::vector<nanoseconds> latencies) {
+	if (latencies.empty()) {
+		return {};
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	nanoseconds total{};
+	for (nanoseconds latency : latencies) {
+		total += latency;
+	}
+	return {
+		duration<double, std::milli>(total).count() / latencies.size(),
+		duration<double, std::milli>(latencies[(latencies.size() - 1) * 95 / 100]).count()
+	};
+}
+
+static void PrintResult(const Trace& trace, const Result& result, bool csv) {
+	const auto [meanMs, p95Ms] = Summarize(result.latencies);
+	const auto [captureMeanMs, captureP95Ms] = Summarize(result.captureLatencies);
+
+	const double fps = result.renders / duration<double>(result.duration).count();
+
+	std::printf(csv ? "%s,%zu,%u,%.2f,%u,%u,%u,%.3f,%.3f,%.3f,%.3f\n"
+		: "%-40s %8zu %8u %8.2f %8u %8u %8u %10.3f %10.3f %10.3f %10.3f\n",
+		trace.name.c_str(), trace.arrivals.size(), trace.arrivals.back().content + 1, fps,
+		result.missedFrames, result.wastedRenders, result.checks, meanMs, p95Ms, captureMeanMs, captureP95Ms);
+}
+
+static void PrintUsage() {
+	std::puts(
+		"用法: FrameSimulator [选项] <轨迹文件.mpft | synthetic:source=60,content=24,seconds=10,jitter=0,seed=1>...\n"
+		"  --source message|frame|nowait  捕获方式的等待类型，默认由轨迹文件决定\n"
+		"  --detection always|dynamic|never  重复帧检测模式，默认由轨迹文件决定\n"
+		"  --min-fps <n>                  最小帧率，0 表示不限制\n"
+		"  --max-fps <n>                  最大帧率，0 表示不限制\n"
+		"  --refresh <hz>                 屏幕刷新率，默认 60\n"
+		"  --render-ms <ms>               每帧捕获和渲染的耗时，默认 3\n"
+		"  --check-us <us>                检查一帧的耗时，默认使用录制时的平均值或 200\n"
+		"  --pacing                       启用低延迟帧调度\n"
+		"  --csv                          以 CSV 格式输出"
+	);
+}
+
+int main(int argc, char* argv[]) {
+	Config config;
+	std::vector<Trace> traces;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "--pacing") {
+			config.pacing = true;
+		} else if (arg == "--csv") {
+			config.csv = true;
+		} else if (arg == "--source" && hasValue) {
+			const std::string_view value = argv[++i];
+			config.source = value == "message" ? SourceType::WaitForMessage
+				: value == "frame" ? SourceType::WaitForFrame : SourceType::NoWait;
+		} else if (arg == "--detection" && hasValue) {
+			const std::string_view value = argv[++i];
+			config.detection = value == "always" ? DetectionMode::Always
+				: value == "never" ? DetectionMode::Never : DetectionMode::Dynamic;
+		} else if (arg == "--min-fps" && hasValue) {
+			config.minFrameRate = (float)std::atof(argv[++i]);
+		} else if (arg == "--max-fps" && hasValue) {
+			config.maxFrameRate = (float)std::atof(argv[++i]);
+		} else if (arg == "--refresh" && hasValue) {
+			config.refreshPeriod = nanoseconds((int64_t)(1e9 / std::atof(argv[++i])));
+		} else if (arg == "--render-ms" && hasValue) {
+			config.renderTime = nanoseconds((int64_t)(std::atof(argv[++i]) * 1e6));
+		} else if (arg == "--check-us" && hasValue) {
+			config.checkTime = nanoseconds((int64_t)(std::atof(argv[++i]) * 1e3));
+		} else if (arg.starts_with("--")) {
+			PrintUsage();
+			return 1;
+		} else {
+			Trace& trace = traces.emplace_back();
+			const bool success = arg.starts_with("synthetic:")
+				? GenerateTrace(arg, trace) : LoadTrace(argv[i], trace);
+			if (!success) {
+				return 1;
+			}
+			if (trace.name.empty()) {
+				trace.name = arg;
+			}
+			if (trace.arrivals.empty()) {
+				std::fprintf(stderr, "%s 中没有帧\n", argv[i]);
+				return 1;
+			}
+		}
+	}
+
+	if (traces.empty() || config.refreshPeriod.count() <= 0) {
+		PrintUsage();
+		return 1;
+	}
+
+	std::printf(config.csv ? "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n"
+		: "%-40s %8s %8s %8s %8s %8s %8s %10s %10s %10s %10s\n",
+		"trace", "arrivals", "contents", "fps", "missed", "wasted", "checks", "latency", "p95", "capture", "capture95");
+
+	for (const Trace& trace : traces) {
+		const Result result = Simulator(trace, config).Run();
+		PrintResult(trace, result, config.csv);
+	}
+
+	return 0;
+}
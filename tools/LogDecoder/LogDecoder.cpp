@@ -0,0 +1,209 @@
+// LogDecoder.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 将 Magpie 的二进制日志（.binlog）解码为文本，格式和文本日志相同。二进制日志只保存格式字符串和参数，
+// 格式化在这里完成。不依赖 Windows，可在 Linux 上用 g++ 或 clang++ 编译，见 README.md。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/args.h>
+#include "LogRecordFormat.h"
+
+// 和 spdlog 相同
+static constexpr const char* LOG_LEVELS[7] = {
+	"trace", "debug", "info", "warning", "error", "critical", "off"
+};
+
+class Decoder {
+public:
+	Decoder(const uint8_t* data, const uint8_t* end) noexcept : _cur(data), _end(end) {}
+
+	// 返回 false 表示文件不完整，之前的日志已输出
+	bool Run() {
+		while (_cur != _end) {
+			uint8_t type;
+			if (!_Read(type)) {
+				return false;
+			}
+
+			bool success;
+			switch ((LogEntryType)type) {
+			case LogEntryType::String:
+				success = _ReadString();
+				break;
+			case LogEntryType::Record:
+				success = _ReadRecord();
+				break;
+			case LogEntryType::Dropped:
+				success = _ReadDropped();
+				break;
+			default:
+				success = false;
+				break;
+			}
+
+			if (!success) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+	template <typename T>
+	bool _Read(T& value) noexcept {
+		_cur = LogRecordFormat::ReadValue(_cur, _end, value);
+		return _cur;
+	}
+
+	bool _ReadString() {
+		uint32_t id;
+		uint32_t size;
+		if (!_Read(id) || !_Read(size) || (size_t)(_end - _cur) < size) {
+			return false;
+		}
+
+		// 追加写入时编号会被重新定义
+		_strings[id].assign((const char*)_cur, size);
+		_cur += size;
+		return true;
+	}
+
+	bool _ReadRecord() {
+		int64_t time;
+		uint8_t level;
+		uint32_t fileId;
+		uint32_t functionId;
+		uint32_t line;
+		uint32_t formatId;
+		uint8_t argCount;
+		if (!_Read(time) || !_Read(level) || !_Read(fileId) || !_Read(functionId) ||
+			!_Read(line) || !_Read(formatId) || !_Read(argCount)) {
+			return false;
+		}
+
+		_args.clear();
+		LogArg arg;
+		for (uint32_t i = 0; i < argCount; ++i) {
+			_cur = LogRecordFormat::ReadArg(_cur, _end, arg);
+			if (!_cur) {
+				return false;
+			}
+
+			LogRecordFormat::PushArg(arg, _args);
+		}
+
+		std::string msg;
+		try {
+			msg = fmt::vformat(_GetString(formatId), _args);
+		} catch (const fmt::format_error& e) {
+			msg = fmt::format("<格式化失败: {}> {}", e.what(), _GetString(formatId));
+		}
+
+		_PrintLine(time, level < std::size(LOG_LEVELS) ? LOG_LEVELS[level] : "?",
+			_GetFileName(fileId), line, _GetString(functionId), msg);
+		return true;
+	}
+
+	bool _ReadDropped() {
+		uint32_t count;
+		if (!_Read(count)) {
+			return false;
+		}
+
+		std::printf("<%u 条日志因缓冲区已满被丢弃>\n", count);
+		return true;
+	}
+
+	std::string_view _GetString(uint32_t id) const noexcept {
+		auto it = _strings.find(id);
+		return it == _strings.end() ? std::string_view() : std::string_view(it->second);
+	}
+
+	// 和 spdlog 的 %s 相同，只保留文件名
+	std::string_view _GetFileName(uint32_t id) const noexcept {
+		std::string_view path = _GetString(id);
+		const size_t pos = path.find_last_of("\\/");
+		return pos == std::string_view::npos ? path : path.substr(pos + 1);
+	}
+
+	// 和文本日志的格式 "%Y-%m-%d %H:%M:%S.%e|%l|%s:%#|%!|%v" 相同
+	static void _PrintLine(
+		int64_t time,
+		const char* level,
+		std::string_view file,
+		uint32_t line,
+		std::string_view function,
+		std::string_view msg
+	) {
+		const std::time_t seconds = (std::time_t)(time / 1000000000);
+		const int milliseconds = int(time % 1000000000 / 1000000);
+
+		char timeStr[32]{};
+		if (const std::tm* tm = std::localtime(&seconds)) {
+			std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", tm);
+		}
+
+		fmt::print("{}.{:03}|{}|{}:{}|{}|{}\n", timeStr, milliseconds, level, file, line, function, msg);
+	}
+
+	const uint8_t* _cur;
+	const uint8_t* _end;
+	std::unordered_map<uint32_t, std::string> _strings;
+	fmt::dynamic_format_arg_store<fmt::format_context> _args;
+};
+
+static bool DecodeFile(const char* fileName) {
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file) {
+		std::fprintf(stderr, "无法打开 %s\n", fileName);
+		return false;
+	}
+
+	const std::vector<uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	LogFileHeader header;
+	if (data.size() < sizeof(header)) {
+		std::fprintf(stderr, "%s 不是有效的二进制日志\n", fileName);
+		return false;
+	}
+
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != LogRecordFormat::MAGIC || header.version == 0 || header.version > LogRecordFormat::VERSION) {
+		std::fprintf(stderr, "%s 不是有效的二进制日志\n", fileName);
+		return false;
+	}
+
+	Decoder decoder(data.data() + sizeof(header), data.data() + data.size());
+	if (!decoder.Run()) {
+		// 程序崩溃时最后一条日志可能不完整
+		std::fprintf(stderr, "%s 的末尾不完整\n", fileName);
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::puts("用法: LogDecoder <日志文件.binlog>...\n"
+			"  按顺序解码每个文件并输出到标准输出，存档的日志文件（如 magpie.1.binlog）应放在前面");
+		return 1;
+	}
+
+	for (int i = 1; i < argc; ++i) {
+		if (!DecodeFile(argv[i])) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+// PngEncoderBench.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 比较 PngEncoder 的多线程编码和单线程编码的耗时以及文件大小。单线程编码只使用一个条带，在调用线程中
+// 执行，和普通的单线程编码器相同，作为参照。默认编码 3840x2160 的截图，条带数由 PngEncoder 决定。
+// PngEncoderBench [--size <宽>x<高>] [--iterations <次数>] [--stripes <条带数>]
+
+#include "PngEncoder.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Magpie;
+
+namespace {
+
+struct BenchCase {
+	const char* name;
+	DXGI_FORMAT format;
+	uint32_t bytesPerPixel;
+};
+
+}
+
+// 类似截图的内容：大面积的渐变和纯色，以及一块噪声
+static std::vector<float> MakeImage(uint32_t width, uint32_t height) {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+
+	std::vector<float> image((size_t)width * height * 4);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			float* pixel = &image[((size_t)y * width + x) * 4];
+			if (x > width / 2 && y > height / 2 && x < width * 3 / 4 && y < height * 3 / 4) {
+				pixel[0] = noise(rng);
+				pixel[1] = noise(rng);
+				pixel[2] = noise(rng);
+			} else if (y < height / 8) {
+				pixel[0] = pixel[1] = pixel[2] = 0.2f;
+			} else {
+				pixel[0] = float(x) / width;
+				pixel[1] = float(y) / height;
+				pixel[2] = float((x / 64 + y / 64) % 2) * 0.5f;
+			}
+			pixel[3] = 1.0f;
+		}
+	}
+	return image;
+}
+
+// 将 float 转换为编码器的输入格式
+static std::vector<uint8_t> ToFormat(const std::vector<float>& image, DXGI_FORMAT format) {
+	std::vector<uint8_t> result;
+	if (format == DXGI_FORMAT_R8G8B8A8_UNORM) {
+		result.resize(image.size());
+		for (size_t i = 0; i < image.size(); ++i) {
+			result[i] = uint8_t(image[i] * 255.0f + 0.5f);
+		}
+	} else if (format == DXGI_FORMAT_R16G16B16A16_FLOAT) {
+		// 只有 [0, 1] 中的规格化数和 0
+		result.resize(image.size() * 2);
+		for (size_t i = 0; i < image.size(); ++i) {
+			uint32_t bits;
+			std::memcpy(&bits, &image[i], 4);
+			const uint16_t half = bits < 0x38800000 ? 0 : uint16_t(((bits - 0x38000000) + 0x1000) >> 13);
+			std::memcpy(&result[i * 2], &half, 2);
+		}
+	} else {
+		result.resize(image.size() * 4);
+		std::memcpy(result.data(), image.data(), result.size());
+	}
+	return result;
+}
+
+// 返回每次编码的平均毫秒数，失败时返回负数
+static double Measure(
+	const BenchCase& benchCase,
+	uint32_t width,
+	uint32_t height,
+	const std::vector<uint8_t>& pixelData,
+	uint32_t stripeCount,
+	uint32_t iterations,
+	size_t& fileSize
+) {
+	std::vector<uint8_t> png;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		if (!PngEncoder::Encode(width, height, benchCase.format, pixelData,
+			width * benchCase.bytesPerPixel, png, stripeCount)) {
+			return -1.0;
+		}
+	}
+	const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+	fileSize = png.size();
+	return duration.count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t width = 3840;
+	uint32_t height = 2160;
+	uint32_t iterations = 5;
+	uint32_t stripeCount = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+				std::fprintf(stderr, "尺寸无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%u", &iterations) != 1 || iterations == 0) {
+				std::fprintf(stderr, "次数无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--stripes") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%u", &stripeCount) != 1) {
+				std::fprintf(stderr, "条带数无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else {
+			std::fprintf(stderr, "用法: %s [--size <宽>x<高>] [--iterations <次数>] [--stripes <条带数>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	static constexpr BenchCase BENCH_CASES[] = {
+		{ "R8G8B8A8_UNORM", DXGI_FORMAT_R8G8B8A8_UNORM, 4 },
+		{ "R16G16B16A16_FLOAT", DXGI_FORMAT_R16G16B16A16_FLOAT, 8 },
+		{ "R32G32B32A32_FLOAT", DXGI_FORMAT_R32G32B32A32_FLOAT, 16 }
+	};
+
+	std::printf("%ux%u，%u 个线程\n", width, height, ThreadPool::Get().ThreadCount());
+	std::printf("%-20s %14s %14s %8s %12s %12s\n",
+		"格式", "单线程 (ms)", "多线程 (ms)", "加速比", "单线程 (KB)", "多线程 (KB)");
+
+	const std::vector<float> image = MakeImage(width, height);
+	for (const BenchCase& benchCase : BENCH_CASES) {
+		const std::vector<uint8_t> pixelData = ToFormat(image, benchCase.format);
+
+		size_t singleSize = 0;
+		size_t parallelSize = 0;
+		const double single = Measure(benchCase, width, height, pixelData, 1, iterations, singleSize);
+		const double parallel = Measure(benchCase, width, height, pixelData, stripeCount, iterations, parallelSize);
+		if (single < 0 || parallel < 0) {
+			std::fprintf(stderr, "%s 编码失败\n", benchCase.name);
+			return 1;
+		}
+
+		std::printf("%-20s %14.1f %14.1f %7.1fx %12zu %12zu\n", benchCase.name, single, parallel,
+			single / parallel, singleSize / 1024, parallelSize / 1024);
+	}
+
+	return 0;
+}
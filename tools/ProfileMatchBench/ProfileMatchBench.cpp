@@ -0,0 +1,164 @@
+// ProfileMatchBench.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 比较 ProfileService::GetProfileForWindow 中逐个检查配置文件和使用索引查找的耗时。只测量匹配本身，
+// 不包括获取类名、路径和 AUMID 的 Win32 调用，ProfileService 会缓存它们的结果。
+// ProfileMatchBench [--iterations <次数>]
+//
+// 索引使用和 ProfileService 相同的 ProfileIndex，配置文件只保留匹配用到的字段。没有 phmap 时
+// ProfileIndex 使用标准库的容器，结果略慢。
+
+#include "ProfileIndex.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Magpie;
+
+namespace {
+
+struct Profile {
+	std::wstring pathRule;
+	std::wstring classNameRule;
+	bool isPackaged = false;
+	bool isAutoScaleEnabled = true;
+};
+
+struct Window {
+	const char* name;
+	std::wstring className;
+	std::wstring path;
+};
+
+}
+
+// 和使用索引前的 GetProfileForWindow 相同，窗口是桌面应用
+static const Profile* FindLinear(const std::vector<Profile>& profiles, const Window& window, bool forAutoScale) noexcept {
+	for (const Profile& profile : profiles) {
+		if (forAutoScale && !profile.isAutoScaleEnabled) {
+			continue;
+		}
+
+		if (profile.classNameRule != window.className || profile.isPackaged) {
+			continue;
+		}
+
+		if (profile.pathRule == window.path) {
+			return &profile;
+		}
+	}
+
+	return nullptr;
+}
+
+// 和 GetProfileForWindow 相同。ProfileService 为每个窗口缓存键，因此键不计入耗时
+static const Profile* FindIndexed(
+	const std::vector<Profile>& profiles,
+	const ProfileIndex& index,
+	const Window& window,
+	const std::wstring& profileKey,
+	bool forAutoScale
+) noexcept {
+	if (!index.ContainsClassName(window.className)) {
+		return nullptr;
+	}
+
+	const std::optional<uint32_t> profileIdx = index.Find(profileKey, forAutoScale);
+	return profileIdx ? &profiles[*profileIdx] : nullptr;
+}
+
+static std::wstring GamePath(uint32_t i) {
+	return L"C:\\Games\\Game" + std::to_wstring(i) + L"\\bin\\game.exe";
+}
+
+// 常见的几种类名，部分配置文件是打包应用或未启用自动缩放
+static std::vector<Profile> MakeProfiles(uint32_t count) {
+	static constexpr const wchar_t* CLASS_NAMES[] = {
+		L"UnityWndClass", L"UnrealWindow", L"Chrome_WidgetWin_1", L"SDL_app"
+	};
+
+	std::vector<Profile> profiles(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		Profile& profile = profiles[i];
+		profile.pathRule = GamePath(i);
+		profile.classNameRule = CLASS_NAMES[i % std::size(CLASS_NAMES)];
+		profile.isPackaged = i % 17 == 5;
+		profile.isAutoScaleEnabled = i % 5 != 0;
+	}
+	return profiles;
+}
+
+// 返回每次查找的平均纳秒数
+template <typename FN>
+static double Measure(FN&& fn, uint32_t iterations) {
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		fn();
+	}
+	const std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+	return duration.count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t iterations = 200000;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%u", &iterations) != 1 || iterations == 0) {
+				std::fprintf(stderr, "次数无效: %s\n", argv[i]);
+				return 1;
+			}
+		} else {
+			std::fprintf(stderr, "用法: %s [--iterations <次数>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::printf("%-10s %-12s %14s %14s %8s\n", "配置文件", "窗口", "逐个检查 (ns)", "索引 (ns)", "加速比");
+
+	// 防止查找被优化掉
+	volatile uintptr_t sink = 0;
+
+	for (uint32_t profileCount : { 10u, 100u, 1000u, 10000u }) {
+		const std::vector<Profile> profiles = MakeProfiles(profileCount);
+		ProfileIndex index;
+		index.Build(profiles, [](const Profile& profile) { return profile.isAutoScaleEnabled; });
+
+		// 最后一个配置文件匹配时逐个检查最慢
+		const uint32_t last = profileCount - 1;
+		const Window windows[] = {
+			{ "匹配最后一个", profiles[last].classNameRule, GamePath(last) },
+			{ "类名相同", profiles[last].classNameRule, L"C:\\Windows\\notepad.exe" },
+			{ "类名不同", L"Notepad", L"C:\\Windows\\notepad.exe" }
+		};
+
+		for (const Window& window : windows) {
+			const std::wstring profileKey = ProfileIndex::MakeKey(false, window.path, window.className);
+
+			if (FindLinear(profiles, window, true) != FindIndexed(profiles, index, window, profileKey, true)) {
+				std::fprintf(stderr, "结果不同: %u 个配置文件，%s\n", profileCount, window.name);
+				return 1;
+			}
+
+			// 检查次数和配置文件数成反比，使每项的耗时接近
+			const uint32_t linearIterations = std::max(iterations / profileCount * 10, 1u);
+			const double linear = Measure([&]() {
+				sink = (uintptr_t)FindLinear(profiles, window, true);
+			}, linearIterations);
+			const double indexed = Measure([&]() {
+				sink = (uintptr_t)FindIndexed(profiles, index, window, profileKey, true);
+			}, iterations);
+
+			std::printf("%-10u %-12s %14.1f %14.1f %7.1fx\n", profileCount, window.name, linear, indexed, linear / indexed);
+		}
+	}
+
+	(void)sink;
+	return 0;
+}
@@ -0,0 +1,121 @@
+// UTFTranscoderBench.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+// 测量 UTFTranscoder 转换典型字符串的耗时。CMakeLists.txt 在 x64 上还以 MP_UTF_TRANSCODER_NO_SSE2
+// 构建 UTFTranscoderBenchPortable，用于比较 SSE2 和可移植的实现。
+// UTFTranscoderBench [名称过滤] [--megabytes <每项转换的 MB 数>]
+
+#include "UTFTranscoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchCase {
+	const char* name;
+	std::string utf8;
+	std::u16string utf16;
+};
+
+}
+
+static std::string Repeat(std::string_view str, size_t minSize) {
+	std::string result;
+	while (result.size() < minSize) {
+		result += str;
+	}
+	return result;
+}
+
+static std::vector<BenchCase> GetBenchCases() {
+	// 实际使用中最常见的是较短的路径、效果名和日志
+	std::vector<BenchCase> cases = {
+		{ "短 ASCII", "C:\\Program Files\\Magpie\\effects\\FSR\\FSR_EASU.hlsl", {} },
+		{ "短中文路径", "D:\\游戏\\某个游戏\\截图\\2024-01-01 12-00-00.png", {} },
+		{ "长 ASCII", Repeat("[2024-01-01 12:00:00.000] [info] FrameSourceBase.cpp:45 capture method: Graphics Capture\n", 64 * 1024), {} },
+		{ "长中文", Repeat("缩放时后端线程也会记录日志，因此在后台线程中写入。", 64 * 1024), {} },
+		{ "长混合", Repeat("Magpie 是一个轻量级的窗口缩放工具，内置了多种 effects and upscalers。", 64 * 1024), {} },
+		{ "表情", Repeat("\xF0\x9F\x98\x80\xF0\x9F\x8E\xAE\xF0\x9F\x96\xBC", 64 * 1024), {} }
+	};
+	for (BenchCase& benchCase : cases) {
+		benchCase.utf16.resize(benchCase.utf8.size());
+		benchCase.utf16.resize(UTFTranscoder::UTF8ToUTF16(benchCase.utf8, benchCase.utf16.data()));
+	}
+	return cases;
+}
+
+// 返回每次转换的平均纳秒数
+template <typename FN>
+static double Measure(FN&& fn, uint32_t iterations) {
+	// 预热缓存
+	fn();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		fn();
+	}
+	const std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+	return duration.count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+	std::string_view filter;
+	// 每项总共转换约这么多字节，短字符串因此执行更多次
+	uint64_t totalBytes = 256 * 1024 * 1024;
+
+	for (int i = 1; i < argc; ++i) {
+		uint32_t megabytes = 0;
+		if (std::strcmp(argv[i], "--megabytes") == 0 && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%u", &megabytes) != 1 || megabytes == 0) {
+				std::fprintf(stderr, "大小无效: %s\n", argv[i]);
+				return 1;
+			}
+			totalBytes = (uint64_t)megabytes * 1024 * 1024;
+		} else if (argv[i][0] != '-') {
+			filter = argv[i];
+		} else {
+			std::fprintf(stderr, "用法: %s [名称过滤] [--megabytes <每项转换的 MB 数>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+#ifdef MP_UTF_TRANSCODER_SSE2
+	std::printf("SSE2 实现\n");
+#else
+	std::printf("可移植的实现\n");
+#endif
+	std::printf("%-12s %10s %14s %14s %14s %14s\n", "输入", "字节数",
+		"8->16 (ns)", "8->16 (GB/s)", "16->8 (ns)", "16->8 (GB/s)");
+
+	// 防止转换被优化掉
+	volatile size_t sink = 0;
+
+	for (const BenchCase& benchCase : GetBenchCases()) {
+		if (!filter.empty() && std::string(benchCase.name).find(filter) == std::string::npos) {
+			continue;
+		}
+
+		const size_t size = benchCase.utf8.size();
+		const uint32_t iterations = (uint32_t)std::max<uint64_t>(totalBytes / size, 1);
+
+		std::u16string utf16(size, u'\0');
+		const double toUTF16 = Measure([&]() {
+			sink = UTFTranscoder::UTF8ToUTF16(benchCase.utf8, utf16.data());
+		}, iterations);
+
+		std::string utf8(benchCase.utf16.size() * 3, '\0');
+		const double toUTF8 = Measure([&]() {
+			sink = UTFTranscoder::UTF16ToUTF8(std::u16string_view(benchCase.utf16), utf8.data());
+		}, iterations);
+
+		// 吞吐量以 UTF-8 的字节数计算
+		std::printf("%-12s %10zu %14.1f %14.2f %14.1f %14.2f\n", benchCase.name, size,
+			toUTF16, size / toUTF16, toUTF8, size / toUTF8);
+	}
+
+	(void)sink;
+	return 0;
+}